@@ -0,0 +1,716 @@
+#include "BSP_Bit_Bang.h"
+#include "PSP_GPIO.h"
+#include "PSP_IRQ.h"
+#include "PSP_Time.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Bit_Bang Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BB_NUM_GPIO_PINS            54u
+
+#define BB_DRY_RUN_BYTES            256u        // bytes clocked with every mask 0 to time a bus's bit loop
+
+#define BB_I2C_FAST_POLLS           16u         // SCL reads before a slow rise counts as stretching
+
+// 1-Wire standard speed timings, in uSec
+#define BB_ONE_WIRE_RESET_LOW       480u
+#define BB_ONE_WIRE_PRESENCE_WAIT   70u
+#define BB_ONE_WIRE_RESET_REST      410u
+#define BB_ONE_WIRE_WRITE_1_LOW     6u
+#define BB_ONE_WIRE_WRITE_1_REST    64u
+#define BB_ONE_WIRE_WRITE_0_LOW     60u
+#define BB_ONE_WIRE_WRITE_0_REST    10u
+#define BB_ONE_WIRE_READ_LOW        6u
+#define BB_ONE_WIRE_READ_SAMPLE     9u
+#define BB_ONE_WIRE_READ_REST       55u
+
+#define BB_ONE_WIRE_CRC8_POLY       0x8Cu       // x^8 + x^5 + x^4 + 1, reflected
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_Bit_Bang Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * The dry runs must be timed the way the buses will run, from the instruction cache, which
+ * the calibration turns on.
+ */
+static void BB_Calibrate(void)
+{
+    if (PSP_Time_Get_Loops_Per_Millisecond() == 0u)
+    {
+        PSP_Time_Calibrate_Delay();
+    }
+}
+
+
+
+static volatile uint32_t * BB_Fsel_Register(uint32_t pin_num)
+{
+    return (volatile uint32_t *)PSP_GPIO_GPFSEL_BANK_A + (pin_num / 10u);
+}
+
+
+
+static uint32_t BB_Fsel_Output(uint32_t pin_num)
+{
+    return PSP_GPIO_PINMODE_OUTPUT << ((pin_num % 10u) * 3u);
+}
+
+
+
+/**
+ * Work out the delay loops for each half of a bit, given how long the bus's register accesses
+ * take per bit (from a dry run of num_bits bits in elapsed_uSec), and the speed that gives.
+ */
+static uint32_t BB_Half_Bit_Loops(uint32_t speed_hz, uint32_t elapsed_uSec, uint32_t num_bits,
+                                  uint32_t * p_achieved_hz)
+{
+    const uint32_t OVERHEAD_nSec = (uint32_t)(((uint64_t)elapsed_uSec * 1000u) / num_bits);
+    const uint32_t HALF_BIT_nSec = 500000000u / speed_hz;
+    const uint32_t LOOPS_PER_MS = PSP_Time_Get_Loops_Per_Millisecond();
+
+    uint32_t loops = 0u;
+
+    if (HALF_BIT_nSec > (OVERHEAD_nSec / 2u))
+    {
+        loops = PSP_Time_Nanoseconds_To_Loops(HALF_BIT_nSec - (OVERHEAD_nSec / 2u));
+    }
+
+    const uint64_t BIT_nSec = OVERHEAD_nSec + (((uint64_t)2u * loops * 1000000u) / LOOPS_PER_MS);
+
+    *p_achieved_hz = (BIT_nSec == 0u) ? speed_hz : (uint32_t)(1000000000u / BIT_nSec);
+
+    if (*p_achieved_hz > speed_hz)
+    {
+        *p_achieved_hz = speed_hz; // rounding of the loops, not a real gain
+    }
+
+    return loops;
+}
+
+
+
+/**
+ * Open drain for I2C and 1-Wire: a line is driven low by making it an output, its output latch
+ * is always low, and let go by making it an input.
+ */
+static inline void BB_Pull_Low(volatile uint32_t * p_fsel, uint32_t output)
+{
+    *p_fsel |= output;
+}
+
+
+
+static inline void BB_Release(volatile uint32_t * p_fsel, uint32_t output)
+{
+    *p_fsel &= ~output;
+}
+
+
+
+/**
+ * Let SCL go and wait for it to be high, as slow as the pull-up or a stretching slave makes
+ * it. Returns 0 on a clock stretch timeout.
+ */
+static uint32_t BB_I2C_Release_SCL(const BSP_Bit_Bang_I2C_t * p_bus)
+{
+    uint32_t num_polls = 0u;
+    uint64_t start_time = 0u;
+
+    BB_Release(p_bus->p_scl_fsel, p_bus->scl_output);
+
+    while ((*p_bus->p_level & p_bus->scl_mask) != p_bus->scl_mask)
+    {
+        num_polls++;
+
+        if (num_polls == BB_I2C_FAST_POLLS)
+        {
+            start_time = PSP_Time_Get_Ticks();
+        }
+        else if ((num_polls > BB_I2C_FAST_POLLS) &&
+                 ((PSP_Time_Get_Ticks() - start_time) > BSP_BIT_BANG_I2C_STRETCH_TIMEOUT_uSec))
+        {
+            return 0u;
+        }
+    }
+
+    return 1u;
+}
+
+
+
+/**
+ * Clock one bit out, SCL is low before and after.
+ */
+static uint32_t BB_I2C_Write_Bit(const BSP_Bit_Bang_I2C_t * p_bus, uint32_t bit)
+{
+    if (bit)
+    {
+        BB_Release(p_bus->p_sda_fsel, p_bus->sda_output);
+    }
+    else
+    {
+        BB_Pull_Low(p_bus->p_sda_fsel, p_bus->sda_output);
+    }
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    if (!BB_I2C_Release_SCL(p_bus))
+    {
+        return 0u;
+    }
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    BB_Pull_Low(p_bus->p_scl_fsel, p_bus->scl_output);
+
+    return 1u;
+}
+
+
+
+/**
+ * Clock one bit in, sampled at the end of SCL high. SCL is low before and after.
+ */
+static uint32_t BB_I2C_Read_Bit(const BSP_Bit_Bang_I2C_t * p_bus, uint32_t * p_bit)
+{
+    BB_Release(p_bus->p_sda_fsel, p_bus->sda_output);
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    if (!BB_I2C_Release_SCL(p_bus))
+    {
+        return 0u;
+    }
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    *p_bit = (*p_bus->p_level & p_bus->sda_mask) ? 1u : 0u;
+
+    BB_Pull_Low(p_bus->p_scl_fsel, p_bus->scl_output);
+
+    return 1u;
+}
+
+
+
+static PSP_I2C_Result_t BB_I2C_Write_Byte(const BSP_Bit_Bang_I2C_t * p_bus, uint32_t byte)
+{
+    uint32_t nack = 1u;
+
+    for (uint32_t bit = 0u; bit < 8u; bit++)
+    {
+        if (!BB_I2C_Write_Bit(p_bus, byte & 0x80u))
+        {
+            return PSP_I2C_Result_Clock_Timeout;
+        }
+
+        byte <<= 1u;
+    }
+
+    if (!BB_I2C_Read_Bit(p_bus, &nack))
+    {
+        return PSP_I2C_Result_Clock_Timeout;
+    }
+
+    return nack ? PSP_I2C_Result_Nack : PSP_I2C_Result_OK;
+}
+
+
+
+/**
+ * Read a byte and acknowledge it, or not for the last byte of a read.
+ */
+static PSP_I2C_Result_t BB_I2C_Read_Byte(const BSP_Bit_Bang_I2C_t * p_bus, uint8_t * p_byte, uint32_t last)
+{
+    uint32_t byte = 0u;
+
+    for (uint32_t bit = 0u; bit < 8u; bit++)
+    {
+        uint32_t value = 0u;
+
+        if (!BB_I2C_Read_Bit(p_bus, &value))
+        {
+            return PSP_I2C_Result_Clock_Timeout;
+        }
+
+        byte = (byte << 1u) | value;
+    }
+
+    *p_byte = (uint8_t)byte;
+
+    return BB_I2C_Write_Bit(p_bus, last) ? PSP_I2C_Result_OK : PSP_I2C_Result_Clock_Timeout;
+}
+
+
+
+/**
+ * A start from an idle bus, or a repeated start with SCL low: SDA falls while SCL is high.
+ */
+static uint32_t BB_I2C_Start(const BSP_Bit_Bang_I2C_t * p_bus)
+{
+    BB_Release(p_bus->p_sda_fsel, p_bus->sda_output);
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    if (!BB_I2C_Release_SCL(p_bus))
+    {
+        return 0u;
+    }
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    BB_Pull_Low(p_bus->p_sda_fsel, p_bus->sda_output);
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    BB_Pull_Low(p_bus->p_scl_fsel, p_bus->scl_output);
+
+    return 1u;
+}
+
+
+
+/**
+ * SDA rises while SCL is high, then a bus free time before the next start.
+ */
+static uint32_t BB_I2C_Stop(const BSP_Bit_Bang_I2C_t * p_bus)
+{
+    BB_Pull_Low(p_bus->p_sda_fsel, p_bus->sda_output);
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    if (!BB_I2C_Release_SCL(p_bus))
+    {
+        return 0u;
+    }
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    BB_Release(p_bus->p_sda_fsel, p_bus->sda_output);
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_Bit_Bang_I2C_Init(BSP_Bit_Bang_I2C_t * p_bus, uint32_t sda_pin, uint32_t scl_pin, uint32_t speed_hz)
+{
+    if ((sda_pin >= BB_NUM_GPIO_PINS) || (scl_pin >= BB_NUM_GPIO_PINS) || (sda_pin == scl_pin) ||
+        (PSP_GPIO_PIN_BANK(sda_pin) != PSP_GPIO_PIN_BANK(scl_pin)) || (speed_hz == 0u))
+    {
+        return 0u;
+    }
+
+    BB_Calibrate();
+
+    // time the bit loop with nothing connected to it: writing the GPFSEL registers back
+    // unchanged and reading GPLEV costs the same as the real thing, and SCL always reads high
+    BSP_Bit_Bang_I2C_t dry_run;
+
+    dry_run.p_sda_fsel = BB_Fsel_Register(sda_pin);
+    dry_run.p_scl_fsel = BB_Fsel_Register(scl_pin);
+    dry_run.sda_output = 0u;
+    dry_run.scl_output = 0u;
+    dry_run.p_level = (volatile uint32_t *)PSP_GPIO_GPLEV_BANK_A + PSP_GPIO_PIN_BANK(sda_pin);
+    dry_run.sda_mask = 0u;
+    dry_run.scl_mask = 0u;
+    dry_run.half_bit_loops = 0u;
+
+    const uint64_t START_TIME = PSP_Time_Get_Ticks();
+
+    for (uint32_t byte = 0u; byte < BB_DRY_RUN_BYTES; byte++)
+    {
+        BB_I2C_Write_Byte(&dry_run, byte);
+    }
+
+    const uint32_t ELAPSED_uSec = (uint32_t)(PSP_Time_Get_Ticks() - START_TIME);
+
+    uint32_t achieved_hz = 0u;
+
+    *p_bus = dry_run;
+    p_bus->sda_output = BB_Fsel_Output(sda_pin);
+    p_bus->scl_output = BB_Fsel_Output(scl_pin);
+    p_bus->sda_mask = PSP_GPIO_PIN_MASK(sda_pin);
+    p_bus->scl_mask = PSP_GPIO_PIN_MASK(scl_pin);
+    p_bus->half_bit_loops = BB_Half_Bit_Loops(speed_hz, ELAPSED_uSec, BB_DRY_RUN_BYTES * 9u, &achieved_hz);
+
+    // released, with the output latches low for when the lines are pulled
+    PSP_GPIO_Pin_Set_Mode(sda_pin, PSP_GPIO_PINMODE_INPUT);
+    PSP_GPIO_Pin_Set_Mode(scl_pin, PSP_GPIO_PINMODE_INPUT);
+    PSP_GPIO_Pin_Low(sda_pin);
+    PSP_GPIO_Pin_Low(scl_pin);
+    PSP_GPIO_Set_Pin_Pull(sda_pin, PSP_GPIO_Pull_Up);
+    PSP_GPIO_Set_Pin_Pull(scl_pin, PSP_GPIO_Pull_Up);
+
+    return achieved_hz;
+}
+
+
+
+PSP_I2C_Result_t BSP_Bit_Bang_I2C_Transfer(const BSP_Bit_Bang_I2C_t * p_bus, uint32_t address,
+                                           const uint8_t * p_write, uint32_t num_write,
+                                           uint8_t * p_read, uint32_t num_read)
+{
+    if ((num_write == 0u) && (num_read == 0u))
+    {
+        return PSP_I2C_Result_Bad_Request;
+    }
+
+    PSP_I2C_Result_t result = BB_I2C_Start(p_bus) ? PSP_I2C_Result_OK : PSP_I2C_Result_Clock_Timeout;
+
+    if ((result == PSP_I2C_Result_OK) && (num_write != 0u))
+    {
+        result = BB_I2C_Write_Byte(p_bus, (address & 0x7Fu) << 1u);
+
+        for (uint32_t i = 0u; (i < num_write) && (result == PSP_I2C_Result_OK); i++)
+        {
+            result = BB_I2C_Write_Byte(p_bus, p_write[i]);
+        }
+
+        if ((result == PSP_I2C_Result_OK) && (num_read != 0u) && !BB_I2C_Start(p_bus))
+        {
+            result = PSP_I2C_Result_Clock_Timeout;
+        }
+    }
+
+    if ((result == PSP_I2C_Result_OK) && (num_read != 0u))
+    {
+        result = BB_I2C_Write_Byte(p_bus, ((address & 0x7Fu) << 1u) | 1u);
+
+        for (uint32_t i = 0u; (i < num_read) && (result == PSP_I2C_Result_OK); i++)
+        {
+            result = BB_I2C_Read_Byte(p_bus, &p_read[i], i == (num_read - 1u));
+        }
+    }
+
+    if ((result != PSP_I2C_Result_Clock_Timeout) && !BB_I2C_Stop(p_bus))
+    {
+        result = PSP_I2C_Result_Clock_Timeout;
+    }
+
+    if (result == PSP_I2C_Result_Clock_Timeout)
+    {
+        // don't fight the slave holding SCL
+        BB_Release(p_bus->p_sda_fsel, p_bus->sda_output);
+        BB_Release(p_bus->p_scl_fsel, p_bus->scl_output);
+    }
+
+    return result;
+}
+
+
+
+/**
+ * Clock one SPI byte out (and in, when reading), MSB first. The first half of each bit writes
+ * its SCK edge and the data together, GPCLR then GPSET, the second half is the other SCK edge
+ * and the MISO sample. Inline so that each caller gets a copy with reading folded away.
+ */
+static inline uint32_t BB_SPI_Byte(const BSP_Bit_Bang_SPI_t * p_bus, uint32_t byte, uint32_t half_bit_loops,
+                                   uint32_t reading)
+{
+    uint32_t byte_in = 0u;
+
+    for (uint32_t bit = 0u; bit < 8u; bit++)
+    {
+        // 0 or the MOSI mask without a branch, so a 1 takes as long as a 0
+        const uint32_t MOSI = (0u - ((byte >> 7u) & 1u)) & p_bus->mosi_mask;
+
+        *p_bus->p_clear = p_bus->first_clear | (p_bus->mosi_mask ^ MOSI);
+        *p_bus->p_set = p_bus->first_set | MOSI;
+
+        PSP_Time_Delay_Loops(half_bit_loops);
+
+        *p_bus->p_second_edge = p_bus->sck_mask;
+
+        if (reading)
+        {
+            byte_in = (byte_in << 1u) | ((*p_bus->p_level & p_bus->miso_mask) ? 1u : 0u);
+        }
+
+        PSP_Time_Delay_Loops(half_bit_loops);
+
+        byte <<= 1u;
+    }
+
+    return byte_in;
+}
+
+
+
+/**
+ * Time a dry run of BB_SPI_Byte on a bus with every mask 0, so no pin moves, in uSec.
+ */
+static uint32_t BB_SPI_Dry_Run(const BSP_Bit_Bang_SPI_t * p_dry_run, uint32_t reading)
+{
+    uint32_t sink = 0u;
+
+    const uint64_t START_TIME = PSP_Time_Get_Ticks();
+
+    for (uint32_t byte = 0u; byte < BB_DRY_RUN_BYTES; byte++)
+    {
+        if (reading)
+        {
+            sink += BB_SPI_Byte(p_dry_run, byte, 0u, 1u);
+        }
+        else
+        {
+            BB_SPI_Byte(p_dry_run, byte, 0u, 0u);
+        }
+    }
+
+    const uint32_t ELAPSED_uSec = (uint32_t)(PSP_Time_Get_Ticks() - START_TIME);
+
+    (void)sink;
+
+    return ELAPSED_uSec;
+}
+
+
+
+uint32_t BSP_Bit_Bang_SPI_Init(BSP_Bit_Bang_SPI_t * p_bus, uint32_t sck_pin, uint32_t mosi_pin, uint32_t miso_pin,
+                               uint32_t cs_pin, PSP_SPI_0_Mode_t mode, uint32_t speed_hz)
+{
+    const uint32_t BANK = PSP_GPIO_PIN_BANK(sck_pin);
+
+    if ((sck_pin >= BB_NUM_GPIO_PINS) || (mosi_pin >= BB_NUM_GPIO_PINS) || (PSP_GPIO_PIN_BANK(mosi_pin) != BANK) ||
+        ((miso_pin != BSP_BIT_BANG_NO_PIN) && ((miso_pin >= BB_NUM_GPIO_PINS) || (PSP_GPIO_PIN_BANK(miso_pin) != BANK))) ||
+        ((cs_pin != BSP_BIT_BANG_NO_PIN) && ((cs_pin >= BB_NUM_GPIO_PINS) || (PSP_GPIO_PIN_BANK(cs_pin) != BANK))) ||
+        (mode > PSP_SPI_0_Mode_3) || (speed_hz == 0u))
+    {
+        return 0u;
+    }
+
+    BB_Calibrate();
+
+    const uint32_t CPOL = ((uint32_t)mode >> 1u) & 1u;
+    const uint32_t CPHA = (uint32_t)mode & 1u;
+
+    BSP_Bit_Bang_SPI_t dry_run;
+
+    dry_run.p_set = (volatile uint32_t *)PSP_GPIO_GPSET_BANK_A + BANK;
+    dry_run.p_clear = (volatile uint32_t *)PSP_GPIO_GPCLR_BANK_A + BANK;
+    dry_run.p_level = (volatile uint32_t *)PSP_GPIO_GPLEV_BANK_A + BANK;
+    dry_run.sck_mask = 0u;
+    dry_run.mosi_mask = 0u;
+    dry_run.miso_mask = 0u;
+    dry_run.cs_mask = 0u;
+    dry_run.first_set = 0u;
+    dry_run.first_clear = 0u;
+    dry_run.p_idle = CPOL ? dry_run.p_set : dry_run.p_clear;
+    dry_run.half_bit_loops = 0u;
+    dry_run.half_bit_read_loops = 0u;
+
+    // mode 0 and 2 change data as SCK goes idle and sample as it goes active, 1 and 3 the other way round
+    volatile uint32_t * const P_ACTIVE = CPOL ? dry_run.p_clear : dry_run.p_set;
+
+    dry_run.p_second_edge = CPHA ? dry_run.p_idle : P_ACTIVE;
+
+    const uint32_t WRITE_uSec = BB_SPI_Dry_Run(&dry_run, 0u);
+    const uint32_t READ_uSec = BB_SPI_Dry_Run(&dry_run, 1u);
+
+    uint32_t achieved_hz = 0u;
+    uint32_t read_hz = 0u;
+
+    *p_bus = dry_run;
+    p_bus->sck_mask = PSP_GPIO_PIN_MASK(sck_pin);
+    p_bus->mosi_mask = PSP_GPIO_PIN_MASK(mosi_pin);
+    p_bus->miso_mask = (miso_pin != BSP_BIT_BANG_NO_PIN) ? PSP_GPIO_PIN_MASK(miso_pin) : 0u;
+    p_bus->cs_mask = (cs_pin != BSP_BIT_BANG_NO_PIN) ? PSP_GPIO_PIN_MASK(cs_pin) : 0u;
+
+    // the first edge of a bit is SCK going high in modes 1 and 2, low in modes 0 and 3
+    const uint32_t FIRST_EDGE_HIGH = CPOL ^ CPHA;
+
+    p_bus->first_set = FIRST_EDGE_HIGH ? p_bus->sck_mask : 0u;
+    p_bus->first_clear = FIRST_EDGE_HIGH ? 0u : p_bus->sck_mask;
+
+    p_bus->half_bit_loops = BB_Half_Bit_Loops(speed_hz, WRITE_uSec, BB_DRY_RUN_BYTES * 8u, &achieved_hz);
+    p_bus->half_bit_read_loops = BB_Half_Bit_Loops(speed_hz, READ_uSec, BB_DRY_RUN_BYTES * 8u, &read_hz);
+
+    // idle levels before the pins become outputs, so nothing glitches
+    *p_bus->p_set = p_bus->cs_mask;
+    *p_bus->p_idle = p_bus->sck_mask;
+    PSP_GPIO_Pin_Low(mosi_pin);
+
+    if (cs_pin != BSP_BIT_BANG_NO_PIN)
+    {
+        PSP_GPIO_Pin_Set_Mode(cs_pin, PSP_GPIO_PINMODE_OUTPUT);
+    }
+
+    PSP_GPIO_Pin_Set_Mode(sck_pin, PSP_GPIO_PINMODE_OUTPUT);
+    PSP_GPIO_Pin_Set_Mode(mosi_pin, PSP_GPIO_PINMODE_OUTPUT);
+
+    if (miso_pin != BSP_BIT_BANG_NO_PIN)
+    {
+        PSP_GPIO_Pin_Set_Mode(miso_pin, PSP_GPIO_PINMODE_INPUT);
+    }
+
+    return achieved_hz;
+}
+
+
+
+void BSP_Bit_Bang_SPI_Transfer(const BSP_Bit_Bang_SPI_t * p_bus, const uint8_t * p_write, uint8_t * p_read,
+                               uint32_t num_bytes)
+{
+    *p_bus->p_clear = p_bus->cs_mask;
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        const uint32_t BYTE_OUT = p_write ? p_write[i] : 0u;
+
+        if (p_read)
+        {
+            p_read[i] = (uint8_t)BB_SPI_Byte(p_bus, BYTE_OUT, p_bus->half_bit_read_loops, 1u);
+        }
+        else
+        {
+            BB_SPI_Byte(p_bus, BYTE_OUT, p_bus->half_bit_loops, 0u);
+        }
+    }
+
+    // modes 0 and 2 end with SCK active
+    *p_bus->p_idle = p_bus->sck_mask;
+
+    PSP_Time_Delay_Loops(p_bus->half_bit_loops);
+
+    *p_bus->p_set = p_bus->cs_mask;
+}
+
+
+
+uint32_t BSP_Bit_Bang_One_Wire_Init(BSP_Bit_Bang_One_Wire_t * p_bus, uint32_t pin)
+{
+    if (pin >= BB_NUM_GPIO_PINS)
+    {
+        return 0u;
+    }
+
+    p_bus->p_fsel = BB_Fsel_Register(pin);
+    p_bus->output = BB_Fsel_Output(pin);
+    p_bus->p_level = (volatile uint32_t *)PSP_GPIO_GPLEV_BANK_A + PSP_GPIO_PIN_BANK(pin);
+    p_bus->mask = PSP_GPIO_PIN_MASK(pin);
+    p_bus->loops_per_uSec = PSP_Time_Nanoseconds_To_Loops(1000u);
+
+    PSP_GPIO_Pin_Set_Mode(pin, PSP_GPIO_PINMODE_INPUT);
+    PSP_GPIO_Pin_Low(pin);
+    PSP_GPIO_Set_Pin_Pull(pin, PSP_GPIO_Pull_Up);
+
+    return 1u;
+}
+
+
+
+static inline void BB_One_Wire_Delay(const BSP_Bit_Bang_One_Wire_t * p_bus, uint32_t delay_time_uSec)
+{
+    PSP_Time_Delay_Loops(delay_time_uSec * p_bus->loops_per_uSec);
+}
+
+
+
+uint32_t BSP_Bit_Bang_One_Wire_Reset(const BSP_Bit_Bang_One_Wire_t * p_bus)
+{
+    // a bus that is already low can't show a presence pulse
+    if (!(*p_bus->p_level & p_bus->mask))
+    {
+        return 0u;
+    }
+
+    // an interrupt could stretch the pulse past 960 uSec or miss the presence pulse
+    const uint32_t STATE = PSP_IRQ_Disable();
+
+    BB_Pull_Low(p_bus->p_fsel, p_bus->output);
+    BB_One_Wire_Delay(p_bus, BB_ONE_WIRE_RESET_LOW);
+    BB_Release(p_bus->p_fsel, p_bus->output);
+    BB_One_Wire_Delay(p_bus, BB_ONE_WIRE_PRESENCE_WAIT);
+
+    const uint32_t PRESENT = (*p_bus->p_level & p_bus->mask) ? 0u : 1u;
+
+    PSP_IRQ_Restore(STATE);
+
+    // the rest only has a minimum, it can stretch
+    BB_One_Wire_Delay(p_bus, BB_ONE_WIRE_RESET_REST);
+
+    return PRESENT;
+}
+
+
+
+void BSP_Bit_Bang_One_Wire_Write(const BSP_Bit_Bang_One_Wire_t * p_bus, const uint8_t * p_data, uint32_t num_bytes)
+{
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            const uint32_t ONE = (p_data[i] >> bit) & 1u;
+
+            // a 1 held low for more than 15 uSec reads as a 0, interrupts wait for the slot
+            const uint32_t STATE = PSP_IRQ_Disable();
+
+            BB_Pull_Low(p_bus->p_fsel, p_bus->output);
+            BB_One_Wire_Delay(p_bus, ONE ? BB_ONE_WIRE_WRITE_1_LOW : BB_ONE_WIRE_WRITE_0_LOW);
+            BB_Release(p_bus->p_fsel, p_bus->output);
+            BB_One_Wire_Delay(p_bus, ONE ? BB_ONE_WIRE_WRITE_1_REST : BB_ONE_WIRE_WRITE_0_REST);
+
+            PSP_IRQ_Restore(STATE);
+        }
+    }
+}
+
+
+
+void BSP_Bit_Bang_One_Wire_Read(const BSP_Bit_Bang_One_Wire_t * p_bus, uint8_t * p_data, uint32_t num_bytes)
+{
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        uint32_t byte = 0u;
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            // the sample has to land within 15 uSec of the falling edge
+            const uint32_t STATE = PSP_IRQ_Disable();
+
+            BB_Pull_Low(p_bus->p_fsel, p_bus->output);
+            BB_One_Wire_Delay(p_bus, BB_ONE_WIRE_READ_LOW);
+            BB_Release(p_bus->p_fsel, p_bus->output);
+            BB_One_Wire_Delay(p_bus, BB_ONE_WIRE_READ_SAMPLE);
+
+            if (*p_bus->p_level & p_bus->mask)
+            {
+                byte |= 1u << bit;
+            }
+
+            BB_One_Wire_Delay(p_bus, BB_ONE_WIRE_READ_REST);
+
+            PSP_IRQ_Restore(STATE);
+        }
+
+        p_data[i] = (uint8_t)byte;
+    }
+}
+
+
+
+uint8_t BSP_Bit_Bang_One_Wire_CRC8(const uint8_t * p_data, uint32_t num_bytes)
+{
+    uint32_t crc = 0u;
+
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        crc ^= p_data[i];
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc & 1u) ? ((crc >> 1u) ^ BB_ONE_WIRE_CRC8_POLY) : (crc >> 1u);
+        }
+    }
+
+    return (uint8_t)crc;
+}
@@ -0,0 +1,352 @@
+/**
+ * DESCRIPTION:
+ *      BSP_Bit_Bang runs extra I2C, SPI and 1-Wire buses on any GPIO pins, with the CPU
+ *      toggling the pins. For when the hardware controllers' pins are taken, or there aren't
+ *      enough controllers.
+ *
+ * NOTES:
+ *      Each bus is a struct owned by the caller, so there can be as many as there are pins.
+ *      The Init functions work everything out once: which GPSET/GPCLR/GPLEV/GPFSEL registers
+ *      and bit masks the pins use, and how many PSP_Time_Delay_Loops loops each half bit
+ *      needs. A bit is then only register writes with precomputed masks and calibrated
+ *      delays, nothing is looked up or divided per bit.
+ *
+ *      The delays are the half bit time minus what the register accesses of a bit take. Init
+ *      measures that by timing a dry run of the bus's own bit loop with every mask 0 (so no
+ *      pin moves), and returns the speed it really gets. At high speeds the register accesses
+ *      are all there is, so the speed tops out below the one asked for. bench_Bit_Bang
+ *      measures what the buses achieve on the wire side of the CPU.
+ *
+ *      I2C is open drain on both lines: a line is pulled low by making it an output (its
+ *      output latch is kept low) and let go by making it an input. Clock stretching is
+ *      honoured, SCL is read back after every release and the next half bit starts only once
+ *      it's high, which also absorbs slow rise times. The internal ~50k pull-ups are turned
+ *      on, enough for 100kHz on short wires. For 400kHz or more use 2.2k (1MHz: 1k) to 3.3V.
+ *      Results are the PSP_I2C ones, so code can move between the hardware and bit-banged
+ *      buses.
+ *
+ *      SPI is push-pull, MSB first, any of the 4 modes, with an optional active low CS. Data
+ *      and the clock edge that goes with it are written together: GPCLR then GPSET, each
+ *      holding the SCK bit and/or the MOSI bit, always both writes whatever the data, so every
+ *      bit takes the same time. SCK, MOSI, MISO and CS must be in the same GPIO bank (the 40
+ *      pin header is all bank 0), as must SDA and SCL.
+ *
+ *      1-Wire is open drain like I2C, standard speed, and needs a 4.7k pull-up to 3.3V. Its
+ *      timings are slow (6...480 uSec) and come straight from the calibrated delay.
+ *
+ *      1-Wire slots have maximum times, so each reset (up to the presence sample) and each
+ *      read and write slot runs with interrupts masked (PSP_IRQ_Disable), about 550 uSec for
+ *      a reset and 70 uSec for a slot. Interrupts are taken between slots. I2C and SPI bits
+ *      aren't masked, an interrupt only stretches a bit, which the master may do; for an SPI
+ *      device with a timeout, wrap the transfer in PSP_IRQ_Disable/PSP_IRQ_Restore. All three
+ *      calibrate the delay first if main hasn't.
+ *
+ * REFERENCES:
+ *      UM10204 I2C-bus specification, NXP, section 6 (timing)
+ *      Maxim application note 126, 1-Wire Communication Through Software
+ *      BCM2837-ARM-Peripherals.pdf page 90 (GPSET/GPCLR/GPLEV)
+ */
+
+#ifndef BSP_BIT_BANG_H_INCLUDED
+#define BSP_BIT_BANG_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+#include "PSP_I2C.h"
+#include "PSP_SPI_0.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Bit_Bang Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_BIT_BANG_NO_PIN                 0xFFFFFFFFu // for an SPI bus without MISO or CS
+#define BSP_BIT_BANG_I2C_STRETCH_TIMEOUT_uSec 25000u     // longest a slave may hold SCL low
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Bit_Bang Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Bit_Bang_I2C_Type
+{
+    volatile uint32_t * p_sda_fsel;     // GPFSEL register holding SDA's mode
+    volatile uint32_t * p_scl_fsel;
+    uint32_t sda_output;                // the bit that makes SDA an output in its GPFSEL register
+    uint32_t scl_output;
+    volatile uint32_t * p_level;        // GPLEV of the pins' bank
+    uint32_t sda_mask;
+    uint32_t scl_mask;
+    uint32_t half_bit_loops;            // delay loops in each half bit
+} BSP_Bit_Bang_I2C_t;
+
+
+
+typedef struct Bit_Bang_SPI_Type
+{
+    volatile uint32_t * p_set;          // GPSET, GPCLR and GPLEV of the pins' bank
+    volatile uint32_t * p_clear;
+    volatile uint32_t * p_level;
+    uint32_t sck_mask;
+    uint32_t mosi_mask;
+    uint32_t miso_mask;
+    uint32_t cs_mask;                   // 0 without a CS pin
+    uint32_t first_set;                 // SCK bits for the first half of a bit, written with the data
+    uint32_t first_clear;
+    volatile uint32_t * p_second_edge;  // GPSET or GPCLR, for the SCK edge in the middle of a bit
+    volatile uint32_t * p_idle;         // GPSET or GPCLR, to leave SCK idle
+    uint32_t half_bit_loops;            // delay loops in each half bit, sending only
+    uint32_t half_bit_read_loops;       // the same when reading MISO too, which takes longer
+} BSP_Bit_Bang_SPI_t;
+
+
+
+typedef struct Bit_Bang_One_Wire_Type
+{
+    volatile uint32_t * p_fsel;
+    uint32_t output;
+    volatile uint32_t * p_level;
+    uint32_t mask;
+    uint32_t loops_per_uSec;
+} BSP_Bit_Bang_One_Wire_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Bit_Bang Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_I2C_Init
+
+Function Description:
+    Set up an I2C bus on two pins: both released (inputs) with pull-ups and their output
+    latches low, and the bit timing for the speed.
+
+Inputs:
+    p_bus: the bus to set up
+    sda_pin: any GPIO
+    scl_pin: any GPIO in the same bank as sda_pin
+    speed_hz: SCL frequency, e.g. PSP_I2C_FAST_PLUS_HZ
+
+Returns:
+    uint32_t: the SCL frequency actually reached with fast enough edges, in Hz, no more than
+              speed_hz. 0 if the pins are no good.
+
+Error Handling:
+    On 0 nothing is changed.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Bit_Bang_I2C_Init(BSP_Bit_Bang_I2C_t * p_bus, uint32_t sda_pin, uint32_t scl_pin, uint32_t speed_hz);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_I2C_Transfer
+
+Function Description:
+    Write and/or read on the bus, like PSP_I2C_Transfer: start, the address, num_write bytes,
+    then a repeated start, the address again and num_read bytes, then a stop.
+
+Inputs:
+    p_bus: the bus
+    address: the 7 bit slave address
+    p_write: the bytes to write
+    num_write: the number of bytes to write, 0 for a read only
+    p_read: where the bytes read go
+    num_read: the number of bytes to read, 0 for a write only
+
+Returns:
+    PSP_I2C_Result_t: PSP_I2C_Result_OK if every byte written was acknowledged
+
+Error Handling:
+    A byte that isn't acknowledged ends the transfer with a stop and PSP_I2C_Result_Nack.
+    SCL held low for BSP_BIT_BANG_I2C_STRETCH_TIMEOUT_uSec gives
+    PSP_I2C_Result_Clock_Timeout, the bus is let go of. PSP_I2C_Result_Bad_Request for a
+    transfer of nothing.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_I2C_Result_t BSP_Bit_Bang_I2C_Transfer(const BSP_Bit_Bang_I2C_t * p_bus, uint32_t address,
+                                           const uint8_t * p_write, uint32_t num_write,
+                                           uint8_t * p_read, uint32_t num_read);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_SPI_Init
+
+Function Description:
+    Set up an SPI bus: SCK, MOSI and CS outputs at their idle levels, MISO an input, and the
+    bit timing for the speed.
+
+Inputs:
+    p_bus: the bus to set up
+    sck_pin, mosi_pin: any GPIO
+    miso_pin, cs_pin: any GPIO, or BSP_BIT_BANG_NO_PIN
+    mode: clock polarity and phase, as for SPI 0
+    speed_hz: SCK frequency
+
+Returns:
+    uint32_t: the SCK frequency actually reached when sending, in Hz, no more than speed_hz.
+              0 if the pins are no good.
+
+Error Handling:
+    On 0 nothing is changed. Every pin must be in the same bank.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Bit_Bang_SPI_Init(BSP_Bit_Bang_SPI_t * p_bus, uint32_t sck_pin, uint32_t mosi_pin, uint32_t miso_pin,
+                               uint32_t cs_pin, PSP_SPI_0_Mode_t mode, uint32_t speed_hz);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_SPI_Transfer
+
+Function Description:
+    CS low, clock num_bytes bytes out and in, CS high.
+
+Inputs:
+    p_bus: the bus
+    p_write: the bytes to send, or 0 to send 0x00s
+    p_read: where the bytes received go, or 0 to only send (which is faster)
+    num_bytes: the number of bytes
+
+Returns:
+    None
+
+Error Handling:
+    Without a MISO pin the bytes received are all 0.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Bit_Bang_SPI_Transfer(const BSP_Bit_Bang_SPI_t * p_bus, const uint8_t * p_write, uint8_t * p_read,
+                               uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_One_Wire_Init
+
+Function Description:
+    Set up a 1-Wire bus on a pin: released, with the pull-up on and the output latch low.
+
+Inputs:
+    p_bus: the bus to set up
+    pin: any GPIO
+
+Returns:
+    uint32_t: 1 on success, 0 if the pin is no good
+
+Error Handling:
+    On 0 nothing is changed.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Bit_Bang_One_Wire_Init(BSP_Bit_Bang_One_Wire_t * p_bus, uint32_t pin);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_One_Wire_Reset
+
+Function Description:
+    Send a reset pulse and listen for presence pulses. Takes about 1 mSec, the first
+    550 uSec with interrupts masked.
+
+Inputs:
+    p_bus: the bus
+
+Returns:
+    uint32_t: 1 if at least one device answered, 0 if none
+
+Error Handling:
+    A bus shorted low reads as no devices.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Bit_Bang_One_Wire_Reset(const BSP_Bit_Bang_One_Wire_t * p_bus);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_One_Wire_Write
+
+Function Description:
+    Send bytes, least significant bit first. Interrupts are masked for each 70 uSec bit
+    slot.
+
+Inputs:
+    p_bus: the bus
+    p_data: the bytes
+    num_bytes: the number of bytes
+
+Returns:
+    None
+
+Error Handling:
+    None, 1-Wire writes aren't acknowledged.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Bit_Bang_One_Wire_Write(const BSP_Bit_Bang_One_Wire_t * p_bus, const uint8_t * p_data, uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_One_Wire_Read
+
+Function Description:
+    Read bytes, least significant bit first. Interrupts are masked for each 70 uSec bit
+    slot.
+
+Inputs:
+    p_bus: the bus
+    p_data: where the bytes go
+    num_bytes: the number of bytes
+
+Returns:
+    None
+
+Error Handling:
+    With nothing answering every byte reads 0xFF, check the data's CRC with
+    BSP_Bit_Bang_One_Wire_CRC8.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Bit_Bang_One_Wire_Read(const BSP_Bit_Bang_One_Wire_t * p_bus, uint8_t * p_data, uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Bit_Bang_One_Wire_CRC8
+
+Function Description:
+    The Dallas/Maxim CRC8 (polynomial x^8 + x^5 + x^4 + 1) used by ROM codes and scratchpads.
+
+Inputs:
+    p_data: the bytes
+    num_bytes: the number of bytes
+
+Returns:
+    uint8_t: the CRC, 0 when run over data that ends in its own CRC byte and is intact
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint8_t BSP_Bit_Bang_One_Wire_CRC8(const uint8_t * p_data, uint32_t num_bytes);
+
+#endif
@@ -0,0 +1,1090 @@
+#include "BSP_DSP.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_DSP Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define DSP_LANES                   4u              // samples per vector
+
+#define DSP_Q15_ROUND               0x00004000      // half of the last bit kept, for round to nearest
+#define DSP_Q30_ROUND               0x20000000
+#define DSP_Q31_ROUND               0x40000000
+
+#define DSP_MAX_AVERAGE_LENGTH      65536u          // keeps a Q15 running sum inside 32 bits
+
+// 2^31 / length, rounded, as the Q15 moving averages scale by it
+#define DSP_RECIPROCAL(length)      ((0x80000000u + ((length) / 2u)) / (length))
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_DSP Types
+ -------------------------------------------------------------------------------------------------*/
+
+// 4 samples, only aligned to the sample size, so a vector can start at any sample
+typedef int16_t DSP_Int16_Lanes_t __attribute__((vector_size(8), aligned(2)));
+typedef int32_t DSP_Int32_Lanes_t __attribute__((vector_size(16), aligned(4)));
+typedef float DSP_Float_Lanes_t __attribute__((vector_size(16), aligned(4)));
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_DSP Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+static inline int16_t DSP_Saturate_Q15(int32_t value)
+{
+    if (value > 32767)
+    {
+        return 32767;
+    }
+
+    if (value < -32768)
+    {
+        return -32768;
+    }
+
+    return (int16_t)value;
+}
+
+
+
+static inline int32_t DSP_Saturate_Q31(int64_t value)
+{
+    if (value > 2147483647LL)
+    {
+        return 2147483647;
+    }
+
+    if (value < -2147483648LL)
+    {
+        return (int32_t)0x80000000u;
+    }
+
+    return (int32_t)value;
+}
+
+
+
+/**
+ * A Q30 sum of Q15 products back to Q15.
+ */
+static inline int16_t DSP_Round_Q15(int32_t sum)
+{
+    return DSP_Saturate_Q15((sum + DSP_Q15_ROUND) >> 15);
+}
+
+
+
+/**
+ * A Q62 sum of Q31 products back to Q31.
+ */
+static inline int32_t DSP_Round_Q31(int64_t sum)
+{
+    return DSP_Saturate_Q31((sum + DSP_Q31_ROUND) >> 31);
+}
+
+
+
+/**
+ * 4 Q15 samples, widened to 32 bit lanes.
+ */
+static inline DSP_Int32_Lanes_t DSP_Load_Q15(const int16_t * p_samples)
+{
+    return __builtin_convertvector(*(const DSP_Int16_Lanes_t *)p_samples, DSP_Int32_Lanes_t);
+}
+
+
+
+/**
+ * The sum of p_a[i] * p_b[i], 4 products at a time.
+ */
+static int32_t DSP_Dot_Q15(const int16_t * p_a, const int16_t * p_b, uint32_t num_samples)
+{
+    DSP_Int32_Lanes_t sums = { 0, 0, 0, 0 };
+    uint32_t i = 0u;
+
+    for (; (i + DSP_LANES) <= num_samples; i += DSP_LANES)
+    {
+        sums += DSP_Load_Q15(&p_a[i]) * DSP_Load_Q15(&p_b[i]);
+    }
+
+    int32_t sum = sums[0] + sums[1] + sums[2] + sums[3];
+
+    for (; i < num_samples; i++)
+    {
+        sum += (int32_t)p_a[i] * p_b[i];
+    }
+
+    return sum;
+}
+
+
+
+static int64_t DSP_Dot_Q31(const int32_t * p_a, const int32_t * p_b, uint32_t num_samples)
+{
+    int64_t sum = 0;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        sum += (int64_t)p_a[i] * p_b[i];
+    }
+
+    return sum;
+}
+
+
+
+static float DSP_Dot_F32(const float * p_a, const float * p_b, uint32_t num_samples)
+{
+    DSP_Float_Lanes_t sums = { 0.0f, 0.0f, 0.0f, 0.0f };
+    uint32_t i = 0u;
+
+    for (; (i + DSP_LANES) <= num_samples; i += DSP_LANES)
+    {
+        sums += *(const DSP_Float_Lanes_t *)&p_a[i] * *(const DSP_Float_Lanes_t *)&p_b[i];
+    }
+
+    float sum = (sums[0] + sums[1]) + (sums[2] + sums[3]);
+
+    for (; i < num_samples; i++)
+    {
+        sum += p_a[i] * p_b[i];
+    }
+
+    return sum;
+}
+
+
+
+uint32_t BSP_DSP_FIR_Q15_Init(BSP_DSP_FIR_Q15_t * p_fir, const int16_t * p_coefficients, uint32_t num_taps, int16_t * p_state, uint32_t max_block)
+{
+    if ((num_taps == 0u) || (max_block == 0u))
+    {
+        return 0u;
+    }
+
+    p_fir->p_coefficients = p_coefficients;
+    p_fir->p_state = p_state;
+    p_fir->num_taps = num_taps;
+    p_fir->max_block = max_block;
+
+    memset(p_state, 0, BSP_DSP_FIR_STATE_SIZE(num_taps, max_block) * sizeof(int16_t));
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_DSP_FIR_Q31_Init(BSP_DSP_FIR_Q31_t * p_fir, const int32_t * p_coefficients, uint32_t num_taps, int32_t * p_state, uint32_t max_block)
+{
+    if ((num_taps == 0u) || (max_block == 0u))
+    {
+        return 0u;
+    }
+
+    p_fir->p_coefficients = p_coefficients;
+    p_fir->p_state = p_state;
+    p_fir->num_taps = num_taps;
+    p_fir->max_block = max_block;
+
+    memset(p_state, 0, BSP_DSP_FIR_STATE_SIZE(num_taps, max_block) * sizeof(int32_t));
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_DSP_FIR_F32_Init(BSP_DSP_FIR_F32_t * p_fir, const float * p_coefficients, uint32_t num_taps, float * p_state, uint32_t max_block)
+{
+    if ((num_taps == 0u) || (max_block == 0u))
+    {
+        return 0u;
+    }
+
+    p_fir->p_coefficients = p_coefficients;
+    p_fir->p_state = p_state;
+    p_fir->num_taps = num_taps;
+    p_fir->max_block = max_block;
+
+    for (uint32_t i = 0u; i < BSP_DSP_FIR_STATE_SIZE(num_taps, max_block); i++)
+    {
+        p_state[i] = 0.0f;
+    }
+
+    return 1u;
+}
+
+
+
+/*
+ * The FIR kernels copy the block in after the last num_taps - 1 inputs, so output i is the
+ * dot product of the taps with state[i...i + num_taps - 1], then move the newest
+ * num_taps - 1 inputs back to the start for the next block. They work out 4 outputs at a
+ * time, one lane each, so every tap is a broadcast multiply of 4 neighbouring samples.
+ */
+void BSP_DSP_FIR_Q15(BSP_DSP_FIR_Q15_t * p_fir, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    const int16_t * const P_COEFFICIENTS = p_fir->p_coefficients;
+    int16_t * const P_STATE = p_fir->p_state;
+    const uint32_t NUM_TAPS = p_fir->num_taps;
+    const uint32_t NUM_SAMPLES = (num_samples < p_fir->max_block) ? num_samples : p_fir->max_block;
+    uint32_t i = 0u;
+
+    memcpy(&P_STATE[NUM_TAPS - 1u], p_in, NUM_SAMPLES * sizeof(int16_t));
+
+    for (; (i + DSP_LANES) <= NUM_SAMPLES; i += DSP_LANES)
+    {
+        DSP_Int32_Lanes_t sums = { 0, 0, 0, 0 };
+
+        for (uint32_t tap = 0u; tap < NUM_TAPS; tap++)
+        {
+            sums += (int32_t)P_COEFFICIENTS[tap] * DSP_Load_Q15(&P_STATE[i + tap]);
+        }
+
+        for (uint32_t lane = 0u; lane < DSP_LANES; lane++)
+        {
+            p_out[i + lane] = DSP_Round_Q15(sums[lane]);
+        }
+    }
+
+    for (; i < NUM_SAMPLES; i++)
+    {
+        p_out[i] = DSP_Round_Q15(DSP_Dot_Q15(P_COEFFICIENTS, &P_STATE[i], NUM_TAPS));
+    }
+
+    memmove(P_STATE, &P_STATE[NUM_SAMPLES], (NUM_TAPS - 1u) * sizeof(int16_t));
+}
+
+
+
+void BSP_DSP_FIR_Q31(BSP_DSP_FIR_Q31_t * p_fir, const int32_t * p_in, int32_t * p_out, uint32_t num_samples)
+{
+    const int32_t * const P_COEFFICIENTS = p_fir->p_coefficients;
+    int32_t * const P_STATE = p_fir->p_state;
+    const uint32_t NUM_TAPS = p_fir->num_taps;
+    const uint32_t NUM_SAMPLES = (num_samples < p_fir->max_block) ? num_samples : p_fir->max_block;
+    uint32_t i = 0u;
+
+    memcpy(&P_STATE[NUM_TAPS - 1u], p_in, NUM_SAMPLES * sizeof(int32_t));
+
+    // 4 outputs at a time in scalar registers, each tap loaded once for all 4
+    for (; (i + DSP_LANES) <= NUM_SAMPLES; i += DSP_LANES)
+    {
+        const int32_t * const P_SAMPLES = &P_STATE[i];
+        int64_t sum_0 = 0;
+        int64_t sum_1 = 0;
+        int64_t sum_2 = 0;
+        int64_t sum_3 = 0;
+
+        for (uint32_t tap = 0u; tap < NUM_TAPS; tap++)
+        {
+            const int32_t COEFFICIENT = P_COEFFICIENTS[tap];
+
+            sum_0 += (int64_t)COEFFICIENT * P_SAMPLES[tap];
+            sum_1 += (int64_t)COEFFICIENT * P_SAMPLES[tap + 1u];
+            sum_2 += (int64_t)COEFFICIENT * P_SAMPLES[tap + 2u];
+            sum_3 += (int64_t)COEFFICIENT * P_SAMPLES[tap + 3u];
+        }
+
+        p_out[i] = DSP_Round_Q31(sum_0);
+        p_out[i + 1u] = DSP_Round_Q31(sum_1);
+        p_out[i + 2u] = DSP_Round_Q31(sum_2);
+        p_out[i + 3u] = DSP_Round_Q31(sum_3);
+    }
+
+    for (; i < NUM_SAMPLES; i++)
+    {
+        p_out[i] = DSP_Round_Q31(DSP_Dot_Q31(P_COEFFICIENTS, &P_STATE[i], NUM_TAPS));
+    }
+
+    memmove(P_STATE, &P_STATE[NUM_SAMPLES], (NUM_TAPS - 1u) * sizeof(int32_t));
+}
+
+
+
+void BSP_DSP_FIR_F32(BSP_DSP_FIR_F32_t * p_fir, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    const float * const P_COEFFICIENTS = p_fir->p_coefficients;
+    float * const P_STATE = p_fir->p_state;
+    const uint32_t NUM_TAPS = p_fir->num_taps;
+    const uint32_t NUM_SAMPLES = (num_samples < p_fir->max_block) ? num_samples : p_fir->max_block;
+    uint32_t i = 0u;
+
+    memcpy(&P_STATE[NUM_TAPS - 1u], p_in, NUM_SAMPLES * sizeof(float));
+
+    for (; (i + DSP_LANES) <= NUM_SAMPLES; i += DSP_LANES)
+    {
+        DSP_Float_Lanes_t sums = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+        for (uint32_t tap = 0u; tap < NUM_TAPS; tap++)
+        {
+            sums += P_COEFFICIENTS[tap] * *(const DSP_Float_Lanes_t *)&P_STATE[i + tap];
+        }
+
+        *(DSP_Float_Lanes_t *)&p_out[i] = sums;
+    }
+
+    for (; i < NUM_SAMPLES; i++)
+    {
+        float sum = 0.0f;
+
+        for (uint32_t tap = 0u; tap < NUM_TAPS; tap++)
+        {
+            sum += P_COEFFICIENTS[tap] * P_STATE[i + tap];
+        }
+
+        p_out[i] = sum;
+    }
+
+    memmove(P_STATE, &P_STATE[NUM_SAMPLES], (NUM_TAPS - 1u) * sizeof(float));
+}
+
+
+
+uint32_t BSP_DSP_Decimate_Q15_Init(BSP_DSP_Decimate_Q15_t * p_decimate, const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, int16_t * p_state, uint32_t max_block)
+{
+    p_decimate->factor = factor;
+
+    return (factor != 0u) ? BSP_DSP_FIR_Q15_Init(&p_decimate->fir, p_coefficients, num_taps, p_state, max_block) : 0u;
+}
+
+
+
+uint32_t BSP_DSP_Decimate_F32_Init(BSP_DSP_Decimate_F32_t * p_decimate, const float * p_coefficients, uint32_t num_taps, uint32_t factor, float * p_state, uint32_t max_block)
+{
+    p_decimate->factor = factor;
+
+    return (factor != 0u) ? BSP_DSP_FIR_F32_Init(&p_decimate->fir, p_coefficients, num_taps, p_state, max_block) : 0u;
+}
+
+
+
+/*
+ * Decimators are laid out like the FIR filters, but with outputs factor samples apart the
+ * lanes run along the taps instead, each output a vector dot product.
+ */
+uint32_t BSP_DSP_Decimate_Q15(BSP_DSP_Decimate_Q15_t * p_decimate, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    const int16_t * const P_COEFFICIENTS = p_decimate->fir.p_coefficients;
+    int16_t * const P_STATE = p_decimate->fir.p_state;
+    const uint32_t NUM_TAPS = p_decimate->fir.num_taps;
+    const uint32_t FACTOR = p_decimate->factor;
+
+    if ((num_samples > p_decimate->fir.max_block) || ((num_samples % FACTOR) != 0u))
+    {
+        return 0u;
+    }
+
+    const uint32_t NUM_OUTPUTS = num_samples / FACTOR;
+
+    memcpy(&P_STATE[NUM_TAPS - 1u], p_in, num_samples * sizeof(int16_t));
+
+    for (uint32_t i = 0u; i < NUM_OUTPUTS; i++)
+    {
+        p_out[i] = DSP_Round_Q15(DSP_Dot_Q15(P_COEFFICIENTS, &P_STATE[i * FACTOR], NUM_TAPS));
+    }
+
+    memmove(P_STATE, &P_STATE[num_samples], (NUM_TAPS - 1u) * sizeof(int16_t));
+
+    return NUM_OUTPUTS;
+}
+
+
+
+uint32_t BSP_DSP_Decimate_F32(BSP_DSP_Decimate_F32_t * p_decimate, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    const float * const P_COEFFICIENTS = p_decimate->fir.p_coefficients;
+    float * const P_STATE = p_decimate->fir.p_state;
+    const uint32_t NUM_TAPS = p_decimate->fir.num_taps;
+    const uint32_t FACTOR = p_decimate->factor;
+
+    if ((num_samples > p_decimate->fir.max_block) || ((num_samples % FACTOR) != 0u))
+    {
+        return 0u;
+    }
+
+    const uint32_t NUM_OUTPUTS = num_samples / FACTOR;
+
+    memcpy(&P_STATE[NUM_TAPS - 1u], p_in, num_samples * sizeof(float));
+
+    for (uint32_t i = 0u; i < NUM_OUTPUTS; i++)
+    {
+        p_out[i] = DSP_Dot_F32(P_COEFFICIENTS, &P_STATE[i * FACTOR], NUM_TAPS);
+    }
+
+    memmove(P_STATE, &P_STATE[num_samples], (NUM_TAPS - 1u) * sizeof(float));
+
+    return NUM_OUTPUTS;
+}
+
+
+
+uint32_t BSP_DSP_Interpolate_Q15_Init(BSP_DSP_Interpolate_Q15_t * p_interpolate, const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, int16_t * p_state, uint32_t max_block)
+{
+    p_interpolate->factor = factor;
+
+    if ((factor == 0u) || ((num_taps % factor) != 0u))
+    {
+        return 0u;
+    }
+
+    // the state only holds inputs, a phase's worth of taps
+    if (!BSP_DSP_FIR_Q15_Init(&p_interpolate->fir, p_coefficients, num_taps / factor, p_state, max_block))
+    {
+        return 0u;
+    }
+
+    p_interpolate->fir.num_taps = num_taps;
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_DSP_Interpolate_F32_Init(BSP_DSP_Interpolate_F32_t * p_interpolate, const float * p_coefficients, uint32_t num_taps, uint32_t factor, float * p_state, uint32_t max_block)
+{
+    p_interpolate->factor = factor;
+
+    if ((factor == 0u) || ((num_taps % factor) != 0u))
+    {
+        return 0u;
+    }
+
+    if (!BSP_DSP_FIR_F32_Init(&p_interpolate->fir, p_coefficients, num_taps / factor, p_state, max_block))
+    {
+        return 0u;
+    }
+
+    p_interpolate->fir.num_taps = num_taps;
+
+    return 1u;
+}
+
+
+
+/*
+ * Of every factor taps only one lands on an input rather than a stuffed zero, so output
+ * phase p of input i is the dot product of taps factor - 1 - p, factor - 1 - p + factor, ...
+ * with state[i...i + num_taps / factor - 1]. Like the FIR filters, 4 inputs are done at a
+ * time, one per lane, for each phase.
+ */
+uint32_t BSP_DSP_Interpolate_Q15(BSP_DSP_Interpolate_Q15_t * p_interpolate, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    int16_t * const P_STATE = p_interpolate->fir.p_state;
+    const uint32_t FACTOR = p_interpolate->factor;
+    const uint32_t PHASE_TAPS = p_interpolate->fir.num_taps / FACTOR;
+
+    if (num_samples > p_interpolate->fir.max_block)
+    {
+        return 0u;
+    }
+
+    memcpy(&P_STATE[PHASE_TAPS - 1u], p_in, num_samples * sizeof(int16_t));
+
+    for (uint32_t phase = 0u; phase < FACTOR; phase++)
+    {
+        const int16_t * const P_TAPS = &p_interpolate->fir.p_coefficients[FACTOR - 1u - phase];
+        uint32_t i = 0u;
+
+        for (; (i + DSP_LANES) <= num_samples; i += DSP_LANES)
+        {
+            DSP_Int32_Lanes_t sums = { 0, 0, 0, 0 };
+
+            for (uint32_t tap = 0u; tap < PHASE_TAPS; tap++)
+            {
+                sums += (int32_t)P_TAPS[tap * FACTOR] * DSP_Load_Q15(&P_STATE[i + tap]);
+            }
+
+            for (uint32_t lane = 0u; lane < DSP_LANES; lane++)
+            {
+                p_out[((i + lane) * FACTOR) + phase] = DSP_Round_Q15(sums[lane]);
+            }
+        }
+
+        for (; i < num_samples; i++)
+        {
+            int32_t sum = 0;
+
+            for (uint32_t tap = 0u; tap < PHASE_TAPS; tap++)
+            {
+                sum += (int32_t)P_TAPS[tap * FACTOR] * P_STATE[i + tap];
+            }
+
+            p_out[(i * FACTOR) + phase] = DSP_Round_Q15(sum);
+        }
+    }
+
+    memmove(P_STATE, &P_STATE[num_samples], (PHASE_TAPS - 1u) * sizeof(int16_t));
+
+    return num_samples * FACTOR;
+}
+
+
+
+uint32_t BSP_DSP_Interpolate_F32(BSP_DSP_Interpolate_F32_t * p_interpolate, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    float * const P_STATE = p_interpolate->fir.p_state;
+    const uint32_t FACTOR = p_interpolate->factor;
+    const uint32_t PHASE_TAPS = p_interpolate->fir.num_taps / FACTOR;
+
+    if (num_samples > p_interpolate->fir.max_block)
+    {
+        return 0u;
+    }
+
+    memcpy(&P_STATE[PHASE_TAPS - 1u], p_in, num_samples * sizeof(float));
+
+    for (uint32_t phase = 0u; phase < FACTOR; phase++)
+    {
+        const float * const P_TAPS = &p_interpolate->fir.p_coefficients[FACTOR - 1u - phase];
+        uint32_t i = 0u;
+
+        for (; (i + DSP_LANES) <= num_samples; i += DSP_LANES)
+        {
+            DSP_Float_Lanes_t sums = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+            for (uint32_t tap = 0u; tap < PHASE_TAPS; tap++)
+            {
+                sums += P_TAPS[tap * FACTOR] * *(const DSP_Float_Lanes_t *)&P_STATE[i + tap];
+            }
+
+            for (uint32_t lane = 0u; lane < DSP_LANES; lane++)
+            {
+                p_out[((i + lane) * FACTOR) + phase] = sums[lane];
+            }
+        }
+
+        for (; i < num_samples; i++)
+        {
+            float sum = 0.0f;
+
+            for (uint32_t tap = 0u; tap < PHASE_TAPS; tap++)
+            {
+                sum += P_TAPS[tap * FACTOR] * P_STATE[i + tap];
+            }
+
+            p_out[(i * FACTOR) + phase] = sum;
+        }
+    }
+
+    memmove(P_STATE, &P_STATE[num_samples], (PHASE_TAPS - 1u) * sizeof(float));
+
+    return num_samples * FACTOR;
+}
+
+
+
+uint32_t BSP_DSP_Biquad_Q31_Init(BSP_DSP_Biquad_Q31_t * p_biquad, const int32_t * p_coefficients, uint32_t num_stages, int32_t * p_state)
+{
+    if (num_stages == 0u)
+    {
+        return 0u;
+    }
+
+    p_biquad->p_coefficients = p_coefficients;
+    p_biquad->p_state = p_state;
+    p_biquad->num_stages = num_stages;
+
+    memset(p_state, 0, BSP_DSP_BIQUAD_Q31_STATE_SIZE(num_stages) * sizeof(int32_t));
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_DSP_Biquad_F32_Init(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_coefficients, uint32_t num_stages, float * p_state)
+{
+    if (num_stages == 0u)
+    {
+        return 0u;
+    }
+
+    p_biquad->p_coefficients = p_coefficients;
+    p_biquad->p_state = p_state;
+    p_biquad->num_stages = num_stages;
+
+    for (uint32_t i = 0u; i < BSP_DSP_BIQUAD_F32_STATE_SIZE(num_stages); i++)
+    {
+        p_state[i] = 0.0f;
+    }
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_DSP_Biquad_F32x4_Init(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_coefficients, uint32_t num_stages, float * p_state)
+{
+    if (num_stages == 0u)
+    {
+        return 0u;
+    }
+
+    p_biquad->p_coefficients = p_coefficients;
+    p_biquad->p_state = p_state;
+    p_biquad->num_stages = num_stages;
+
+    for (uint32_t i = 0u; i < BSP_DSP_BIQUAD_F32X4_STATE_SIZE(num_stages); i++)
+    {
+        p_state[i] = 0.0f;
+    }
+
+    return 1u;
+}
+
+
+
+void BSP_DSP_Biquad_Q31(BSP_DSP_Biquad_Q31_t * p_biquad, const int32_t * p_in, int32_t * p_out, uint32_t num_samples)
+{
+    const int32_t * p_stage_in = p_in;
+
+    // a stage at a time over the whole block, so its coefficients and history stay in registers
+    for (uint32_t stage = 0u; stage < p_biquad->num_stages; stage++)
+    {
+        const int32_t * const P_COEFFICIENTS = &p_biquad->p_coefficients[stage * BSP_DSP_BIQUAD_COEFFICIENTS];
+        int32_t * const P_STATE = &p_biquad->p_state[stage * 4u];
+
+        const int32_t B0 = P_COEFFICIENTS[0];
+        const int32_t B1 = P_COEFFICIENTS[1];
+        const int32_t B2 = P_COEFFICIENTS[2];
+        const int32_t A1 = P_COEFFICIENTS[3];
+        const int32_t A2 = P_COEFFICIENTS[4];
+
+        int32_t x_1 = P_STATE[0];
+        int32_t x_2 = P_STATE[1];
+        int32_t y_1 = P_STATE[2];
+        int32_t y_2 = P_STATE[3];
+
+        for (uint32_t i = 0u; i < num_samples; i++)
+        {
+            const int32_t X = p_stage_in[i];
+            const int64_t SUM = ((int64_t)B0 * X) + ((int64_t)B1 * x_1) + ((int64_t)B2 * x_2) - ((int64_t)A1 * y_1) - ((int64_t)A2 * y_2);
+            const int32_t Y = DSP_Saturate_Q31((SUM + DSP_Q30_ROUND) >> 30);
+
+            x_2 = x_1;
+            x_1 = X;
+            y_2 = y_1;
+            y_1 = Y;
+            p_out[i] = Y;
+        }
+
+        P_STATE[0] = x_1;
+        P_STATE[1] = x_2;
+        P_STATE[2] = y_1;
+        P_STATE[3] = y_2;
+
+        p_stage_in = p_out;
+    }
+}
+
+
+
+void BSP_DSP_Biquad_F32(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    const float * p_stage_in = p_in;
+
+    for (uint32_t stage = 0u; stage < p_biquad->num_stages; stage++)
+    {
+        const float * const P_COEFFICIENTS = &p_biquad->p_coefficients[stage * BSP_DSP_BIQUAD_COEFFICIENTS];
+        float * const P_STATE = &p_biquad->p_state[stage * 2u];
+
+        const float B0 = P_COEFFICIENTS[0];
+        const float B1 = P_COEFFICIENTS[1];
+        const float B2 = P_COEFFICIENTS[2];
+        const float A1 = P_COEFFICIENTS[3];
+        const float A2 = P_COEFFICIENTS[4];
+
+        float d_1 = P_STATE[0];
+        float d_2 = P_STATE[1];
+
+        // transposed direct form II, two delays per stage rather than four
+        for (uint32_t i = 0u; i < num_samples; i++)
+        {
+            const float X = p_stage_in[i];
+            const float Y = (B0 * X) + d_1;
+
+            d_1 = (B1 * X) - (A1 * Y) + d_2;
+            d_2 = (B2 * X) - (A2 * Y);
+            p_out[i] = Y;
+        }
+
+        P_STATE[0] = d_1;
+        P_STATE[1] = d_2;
+
+        p_stage_in = p_out;
+    }
+}
+
+
+
+void BSP_DSP_Biquad_F32x4(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    const float * p_stage_in = p_in;
+
+    for (uint32_t stage = 0u; stage < p_biquad->num_stages; stage++)
+    {
+        const float * const P_COEFFICIENTS = &p_biquad->p_coefficients[stage * BSP_DSP_BIQUAD_COEFFICIENTS];
+        DSP_Float_Lanes_t * const P_STATE = (DSP_Float_Lanes_t *)&p_biquad->p_state[stage * 8u];
+
+        const float B0 = P_COEFFICIENTS[0];
+        const float B1 = P_COEFFICIENTS[1];
+        const float B2 = P_COEFFICIENTS[2];
+        const float A1 = P_COEFFICIENTS[3];
+        const float A2 = P_COEFFICIENTS[4];
+
+        DSP_Float_Lanes_t d_1 = P_STATE[0];
+        DSP_Float_Lanes_t d_2 = P_STATE[1];
+
+        // as BSP_DSP_Biquad_F32, with one stream per lane
+        for (uint32_t i = 0u; i < num_samples; i++)
+        {
+            const DSP_Float_Lanes_t X = *(const DSP_Float_Lanes_t *)&p_stage_in[i * DSP_LANES];
+            const DSP_Float_Lanes_t Y = (B0 * X) + d_1;
+
+            d_1 = (B1 * X) - (A1 * Y) + d_2;
+            d_2 = (B2 * X) - (A2 * Y);
+            *(DSP_Float_Lanes_t *)&p_out[i * DSP_LANES] = Y;
+        }
+
+        P_STATE[0] = d_1;
+        P_STATE[1] = d_2;
+
+        p_stage_in = p_out;
+    }
+}
+
+
+
+static inline int16_t DSP_Average_Q15(int32_t sum, uint32_t reciprocal)
+{
+    return DSP_Saturate_Q15((int32_t)((((int64_t)sum * reciprocal) + DSP_Q31_ROUND) >> 31));
+}
+
+
+
+uint32_t BSP_DSP_Moving_Average_Q15_Init(BSP_DSP_Moving_Average_Q15_t * p_average, int16_t * p_history, uint32_t length)
+{
+    if ((length == 0u) || (length > DSP_MAX_AVERAGE_LENGTH))
+    {
+        return 0u;
+    }
+
+    p_average->p_history = p_history;
+    p_average->length = length;
+    p_average->index = 0u;
+    p_average->sum = 0;
+    p_average->reciprocal = DSP_RECIPROCAL(length);
+
+    memset(p_history, 0, length * sizeof(int16_t));
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_DSP_Moving_Average_F32_Init(BSP_DSP_Moving_Average_F32_t * p_average, float * p_history, uint32_t length)
+{
+    if ((length == 0u) || (length > DSP_MAX_AVERAGE_LENGTH))
+    {
+        return 0u;
+    }
+
+    p_average->p_history = p_history;
+    p_average->length = length;
+    p_average->index = 0u;
+    p_average->sum = 0.0f;
+    p_average->reciprocal = 1.0f / (float)length;
+
+    for (uint32_t i = 0u; i < length; i++)
+    {
+        p_history[i] = 0.0f;
+    }
+
+    return 1u;
+}
+
+
+
+void BSP_DSP_Moving_Average_Q15(BSP_DSP_Moving_Average_Q15_t * p_average, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    int16_t * const P_HISTORY = p_average->p_history;
+    const uint32_t LENGTH = p_average->length;
+    const uint32_t RECIPROCAL = p_average->reciprocal;
+    uint32_t index = p_average->index;
+    int32_t sum = p_average->sum;
+
+    // the newest input in, the oldest out, the sum is exact so it never drifts
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        const int16_t X = p_in[i];
+
+        sum += (int32_t)X - P_HISTORY[index];
+        P_HISTORY[index] = X;
+        index = ((index + 1u) == LENGTH) ? 0u : (index + 1u);
+
+        p_out[i] = DSP_Average_Q15(sum, RECIPROCAL);
+    }
+
+    p_average->index = index;
+    p_average->sum = sum;
+}
+
+
+
+void BSP_DSP_Moving_Average_F32(BSP_DSP_Moving_Average_F32_t * p_average, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    float * const P_HISTORY = p_average->p_history;
+    const uint32_t LENGTH = p_average->length;
+    const float RECIPROCAL = p_average->reciprocal;
+    uint32_t index = p_average->index;
+    float sum = p_average->sum;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        const float X = p_in[i];
+
+        sum += X - P_HISTORY[index];
+        P_HISTORY[index] = X;
+        index++;
+
+        if (index == LENGTH)
+        {
+            index = 0u;
+
+            // start the sum afresh once per pass through the history
+            sum = 0.0f;
+
+            for (uint32_t j = 0u; j < LENGTH; j++)
+            {
+                sum += P_HISTORY[j];
+            }
+        }
+
+        p_out[i] = sum * RECIPROCAL;
+    }
+
+    p_average->index = index;
+    p_average->sum = sum;
+}
+
+
+
+void BSP_DSP_Reference_FIR_Q15(const int16_t * p_coefficients, uint32_t num_taps, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < num_samples; n++)
+    {
+        int32_t sum = 0;
+
+        // p_coefficients[num_taps - 1] is h[0], for the newest input
+        for (uint32_t k = 0u; (k < num_taps) && (k <= n); k++)
+        {
+            sum += (int32_t)p_coefficients[num_taps - 1u - k] * p_in[n - k];
+        }
+
+        p_out[n] = DSP_Round_Q15(sum);
+    }
+}
+
+
+
+void BSP_DSP_Reference_FIR_Q31(const int32_t * p_coefficients, uint32_t num_taps, const int32_t * p_in, int32_t * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < num_samples; n++)
+    {
+        int64_t sum = 0;
+
+        for (uint32_t k = 0u; (k < num_taps) && (k <= n); k++)
+        {
+            sum += (int64_t)p_coefficients[num_taps - 1u - k] * p_in[n - k];
+        }
+
+        p_out[n] = DSP_Round_Q31(sum);
+    }
+}
+
+
+
+void BSP_DSP_Reference_FIR_F32(const float * p_coefficients, uint32_t num_taps, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < num_samples; n++)
+    {
+        float sum = 0.0f;
+
+        for (uint32_t k = 0u; (k < num_taps) && (k <= n); k++)
+        {
+            sum += p_coefficients[num_taps - 1u - k] * p_in[n - k];
+        }
+
+        p_out[n] = sum;
+    }
+}
+
+
+
+void BSP_DSP_Reference_Decimate_Q15(const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < num_samples; n += factor)
+    {
+        int32_t sum = 0;
+
+        for (uint32_t k = 0u; (k < num_taps) && (k <= n); k++)
+        {
+            sum += (int32_t)p_coefficients[num_taps - 1u - k] * p_in[n - k];
+        }
+
+        p_out[n / factor] = DSP_Round_Q15(sum);
+    }
+}
+
+
+
+void BSP_DSP_Reference_Decimate_F32(const float * p_coefficients, uint32_t num_taps, uint32_t factor, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < num_samples; n += factor)
+    {
+        float sum = 0.0f;
+
+        for (uint32_t k = 0u; (k < num_taps) && (k <= n); k++)
+        {
+            sum += p_coefficients[num_taps - 1u - k] * p_in[n - k];
+        }
+
+        p_out[n / factor] = sum;
+    }
+}
+
+
+
+void BSP_DSP_Reference_Interpolate_Q15(const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < (num_samples * factor); n++)
+    {
+        int32_t sum = 0;
+
+        // the zero stuffed input is p_in[n / factor] where n is a multiple of factor, else 0
+        for (uint32_t k = 0u; (k < num_taps) && (k <= n); k++)
+        {
+            if (((n - k) % factor) == 0u)
+            {
+                sum += (int32_t)p_coefficients[num_taps - 1u - k] * p_in[(n - k) / factor];
+            }
+        }
+
+        p_out[n] = DSP_Round_Q15(sum);
+    }
+}
+
+
+
+void BSP_DSP_Reference_Interpolate_F32(const float * p_coefficients, uint32_t num_taps, uint32_t factor, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < (num_samples * factor); n++)
+    {
+        float sum = 0.0f;
+
+        for (uint32_t k = 0u; (k < num_taps) && (k <= n); k++)
+        {
+            if (((n - k) % factor) == 0u)
+            {
+                sum += p_coefficients[num_taps - 1u - k] * p_in[(n - k) / factor];
+            }
+        }
+
+        p_out[n] = sum;
+    }
+}
+
+
+
+void BSP_DSP_Reference_Biquad_Q31(const int32_t * p_coefficients, uint32_t num_stages, const int32_t * p_in, int32_t * p_out, uint32_t num_samples)
+{
+    for (uint32_t stage = 0u; stage < num_stages; stage++)
+    {
+        const int32_t * const P_B_A = &p_coefficients[stage * BSP_DSP_BIQUAD_COEFFICIENTS];
+        const int32_t * const P_X = (stage == 0u) ? p_in : p_out;
+        int32_t x_1 = 0;
+        int32_t x_2 = 0;
+
+        // straight from the difference equation, y[n-1] and y[n-2] read back from p_out, the
+        // inputs kept aside as later stages overwrite them
+        for (uint32_t n = 0u; n < num_samples; n++)
+        {
+            const int32_t X = P_X[n];
+            const int32_t Y_1 = (n >= 1u) ? p_out[n - 1u] : 0;
+            const int32_t Y_2 = (n >= 2u) ? p_out[n - 2u] : 0;
+
+            int64_t sum = (int64_t)P_B_A[0] * X;
+            sum += (int64_t)P_B_A[1] * x_1;
+            sum += (int64_t)P_B_A[2] * x_2;
+            sum -= (int64_t)P_B_A[3] * Y_1;
+            sum -= (int64_t)P_B_A[4] * Y_2;
+
+            x_2 = x_1;
+            x_1 = X;
+            p_out[n] = DSP_Saturate_Q31((sum + DSP_Q30_ROUND) >> 30);
+        }
+    }
+}
+
+
+
+void BSP_DSP_Reference_Biquad_F32(const float * p_coefficients, uint32_t num_stages, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    for (uint32_t stage = 0u; stage < num_stages; stage++)
+    {
+        const float * const P_B_A = &p_coefficients[stage * BSP_DSP_BIQUAD_COEFFICIENTS];
+        const float * const P_X = (stage == 0u) ? p_in : p_out;
+        float x_1 = 0.0f;
+        float x_2 = 0.0f;
+
+        // direct form I, a different rounding path from the kernels' transposed form II
+        for (uint32_t n = 0u; n < num_samples; n++)
+        {
+            const float X = P_X[n];
+            const float Y_1 = (n >= 1u) ? p_out[n - 1u] : 0.0f;
+            const float Y_2 = (n >= 2u) ? p_out[n - 2u] : 0.0f;
+
+            const float Y = (P_B_A[0] * X) + (P_B_A[1] * x_1) + (P_B_A[2] * x_2) - (P_B_A[3] * Y_1) - (P_B_A[4] * Y_2);
+
+            x_2 = x_1;
+            x_1 = X;
+            p_out[n] = Y;
+        }
+    }
+}
+
+
+
+void BSP_DSP_Reference_Moving_Average_Q15(uint32_t length, const int16_t * p_in, int16_t * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < num_samples; n++)
+    {
+        int32_t sum = 0;
+
+        for (uint32_t k = 0u; (k < length) && (k <= n); k++)
+        {
+            sum += p_in[n - k];
+        }
+
+        p_out[n] = DSP_Average_Q15(sum, DSP_RECIPROCAL(length));
+    }
+}
+
+
+
+void BSP_DSP_Reference_Moving_Average_F32(uint32_t length, const float * p_in, float * p_out, uint32_t num_samples)
+{
+    for (uint32_t n = 0u; n < num_samples; n++)
+    {
+        float sum = 0.0f;
+
+        for (uint32_t k = 0u; (k < length) && (k <= n); k++)
+        {
+            sum += p_in[n - k];
+        }
+
+        p_out[n] = sum / (float)length;
+    }
+}
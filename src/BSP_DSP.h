@@ -0,0 +1,489 @@
+/**
+ * DESCRIPTION:
+ *      BSP_DSP filters streams of samples, such as ADC and IMU readings from PSP_SPI_0 and
+ *      PSP_I2C: FIR filters, cascaded biquads, moving averages, decimation and interpolation,
+ *      in Q15, Q31 and float. Every kernel keeps its own state between calls, so a stream can
+ *      be fed in blocks of any size up to the one it was set up for. Each has a plain scalar
+ *      reference version, BSP_DSP_Reference_*, to check it against.
+ *
+ * NOTES:
+ *      Formats: Q15 is int16_t over 2^15 (-1.0 to just under 1.0) and Q31 int32_t over 2^31.
+ *      Biquad Q31 coefficients are Q30 (over 2^30), as a1 is up to +-2 for any low cutoff.
+ *      Results are rounded to nearest and saturated.
+ *
+ *      FIR coefficients are stored in time reversed order, the oldest sample's tap first:
+ *      {h[N-1], ..., h[1], h[0]}. That's the order they're used in, and for the usual
+ *      symmetric (linear phase) filters it's the same thing anyway.
+ *
+ *      The FIR, decimation and interpolation loops work on 4 samples at a time with GCC
+ *      vector types, so they compile to NEON when NEON is enabled (make NEON=1) and to plain
+ *      ARM code otherwise. NEON's float unit flushes denormals to zero, so GCC only uses it
+ *      for float vectors with -funsafe-math-optimizations, which the Makefile gives this file
+ *      alone in NEON builds. The Q31 FIR is scalar, 4 outputs at a time with 64 bit
+ *      accumulators (one SMLAL per tap and output), since GCC's vector types have no widening
+ *      multiply.
+ *
+ *      Q15 FIR, decimation and interpolation accumulate in 32 bits, a whole output's worth
+ *      before rounding, so the magnitudes of the taps that make up one output must add up to
+ *      under 2.0. Any filter with a gain of 1 is well inside that.
+ *
+ *      Biquads and moving averages feed each output back into the next, so a single stream
+ *      can't be split across lanes. The moving averages keep a running sum instead, a few
+ *      cycles per sample whatever the length. BSP_DSP_Biquad_F32x4 runs the same filter on
+ *      4 interleaved streams (e.g. the axes of an IMU), one per lane.
+ *
+ *      Decimation by M keeps every Mth output of the FIR, starting with the first, and only
+ *      computes those. Interpolation by L puts L-1 zeros after each input and filters, as a
+ *      polyphase filter that skips the zeros: the taps must be a multiple of L, and should
+ *      carry a gain of L to make up for the zeros.
+ *
+ * REFERENCES:
+ *      CMSIS-DSP: https://arm-software.github.io/CMSIS-DSP/latest/
+ *      R. Lyons, Understanding Digital Signal Processing, chapters 5, 6 and 10
+ */
+
+#ifndef BSP_DSP_H_INCLUDED
+#define BSP_DSP_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_DSP Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// state buffer sizes, in samples (FIR, decimation) or words of the state's type (biquads)
+#define BSP_DSP_FIR_STATE_SIZE(num_taps, max_block)                     ((num_taps) + (max_block) - 1u)
+#define BSP_DSP_INTERPOLATE_STATE_SIZE(num_taps, factor, max_block)     (((num_taps) / (factor)) + (max_block) - 1u)
+#define BSP_DSP_BIQUAD_Q31_STATE_SIZE(num_stages)                       (4u * (num_stages))
+#define BSP_DSP_BIQUAD_F32_STATE_SIZE(num_stages)                       (2u * (num_stages))
+#define BSP_DSP_BIQUAD_F32X4_STATE_SIZE(num_stages)                     (8u * (num_stages))
+
+#define BSP_DSP_BIQUAD_COEFFICIENTS     5u      // per stage: b0, b1, b2, a1, a2 (a0 is 1)
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_DSP Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct DSP_FIR_Q15_Type
+{
+    const int16_t * p_coefficients;     // num_taps, time reversed
+    int16_t * p_state;                  // BSP_DSP_FIR_STATE_SIZE
+    uint32_t num_taps;
+    uint32_t max_block;
+} BSP_DSP_FIR_Q15_t;
+
+
+
+typedef struct DSP_FIR_Q31_Type
+{
+    const int32_t * p_coefficients;
+    int32_t * p_state;
+    uint32_t num_taps;
+    uint32_t max_block;
+} BSP_DSP_FIR_Q31_t;
+
+
+
+typedef struct DSP_FIR_F32_Type
+{
+    const float * p_coefficients;
+    float * p_state;
+    uint32_t num_taps;
+    uint32_t max_block;
+} BSP_DSP_FIR_F32_t;
+
+
+
+// FIR filters that keep every factor-th output
+typedef struct DSP_Decimate_Q15_Type
+{
+    BSP_DSP_FIR_Q15_t fir;
+    uint32_t factor;
+} BSP_DSP_Decimate_Q15_t;
+
+
+
+typedef struct DSP_Decimate_F32_Type
+{
+    BSP_DSP_FIR_F32_t fir;
+    uint32_t factor;
+} BSP_DSP_Decimate_F32_t;
+
+
+
+// polyphase FIR filters, p_state holds num_taps / factor + max_block - 1 inputs
+typedef struct DSP_Interpolate_Q15_Type
+{
+    BSP_DSP_FIR_Q15_t fir;
+    uint32_t factor;
+} BSP_DSP_Interpolate_Q15_t;
+
+
+
+typedef struct DSP_Interpolate_F32_Type
+{
+    BSP_DSP_FIR_F32_t fir;
+    uint32_t factor;
+} BSP_DSP_Interpolate_F32_t;
+
+
+
+typedef struct DSP_Biquad_Q31_Type
+{
+    const int32_t * p_coefficients;     // 5 per stage, Q30
+    int32_t * p_state;                  // x[n-1], x[n-2], y[n-1], y[n-2] per stage
+    uint32_t num_stages;
+} BSP_DSP_Biquad_Q31_t;
+
+
+
+typedef struct DSP_Biquad_F32_Type
+{
+    const float * p_coefficients;       // 5 per stage
+    float * p_state;                    // transposed direct form II, 2 per stage (4 lanes each for F32x4)
+    uint32_t num_stages;
+} BSP_DSP_Biquad_F32_t;
+
+
+
+typedef struct DSP_Moving_Average_Q15_Type
+{
+    int16_t * p_history;                // the last length inputs
+    uint32_t length;
+    uint32_t index;                     // oldest input
+    int32_t sum;
+    uint32_t reciprocal;                // 2^31 / length, rounded
+} BSP_DSP_Moving_Average_Q15_t;
+
+
+
+typedef struct DSP_Moving_Average_F32_Type
+{
+    float * p_history;
+    uint32_t length;
+    uint32_t index;
+    float sum;
+    float reciprocal;
+} BSP_DSP_Moving_Average_F32_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_DSP Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_FIR_Q15_Init, BSP_DSP_FIR_Q31_Init, BSP_DSP_FIR_F32_Init
+
+Function Description:
+    Set up an FIR filter with empty (all 0) history.
+
+Inputs:
+    p_fir: the filter
+    p_coefficients: num_taps taps, time reversed, kept by reference
+    num_taps: at least 1
+    p_state: BSP_DSP_FIR_STATE_SIZE(num_taps, max_block) samples
+    max_block: most samples per BSP_DSP_FIR_*
+
+Returns:
+    uint32_t: 1 on success, 0 if num_taps or max_block is 0
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_DSP_FIR_Q15_Init(BSP_DSP_FIR_Q15_t * p_fir, const int16_t * p_coefficients, uint32_t num_taps, int16_t * p_state, uint32_t max_block);
+uint32_t BSP_DSP_FIR_Q31_Init(BSP_DSP_FIR_Q31_t * p_fir, const int32_t * p_coefficients, uint32_t num_taps, int32_t * p_state, uint32_t max_block);
+uint32_t BSP_DSP_FIR_F32_Init(BSP_DSP_FIR_F32_t * p_fir, const float * p_coefficients, uint32_t num_taps, float * p_state, uint32_t max_block);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_FIR_Q15, BSP_DSP_FIR_Q31, BSP_DSP_FIR_F32
+
+Function Description:
+    Filter the next block of a stream, one output per input.
+
+Inputs:
+    p_fir: the filter
+    p_in: num_samples inputs
+    p_out: where to put num_samples outputs, may be p_in
+    num_samples: up to max_block
+
+Returns:
+    None
+
+Error Handling:
+    Anything past max_block samples is left alone.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_DSP_FIR_Q15(BSP_DSP_FIR_Q15_t * p_fir, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+void BSP_DSP_FIR_Q31(BSP_DSP_FIR_Q31_t * p_fir, const int32_t * p_in, int32_t * p_out, uint32_t num_samples);
+void BSP_DSP_FIR_F32(BSP_DSP_FIR_F32_t * p_fir, const float * p_in, float * p_out, uint32_t num_samples);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Decimate_Q15_Init, BSP_DSP_Decimate_F32_Init
+
+Function Description:
+    Set up a decimator: an FIR filter (the anti-aliasing filter) that keeps every factor-th
+    output.
+
+Inputs:
+    p_decimate: the decimator
+    p_coefficients: num_taps taps, time reversed, kept by reference
+    num_taps: at least 1
+    factor: at least 1
+    p_state: BSP_DSP_FIR_STATE_SIZE(num_taps, max_block) samples
+    max_block: most inputs per BSP_DSP_Decimate_*
+
+Returns:
+    uint32_t: 1 on success, 0 if num_taps, factor or max_block is 0
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_DSP_Decimate_Q15_Init(BSP_DSP_Decimate_Q15_t * p_decimate, const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, int16_t * p_state, uint32_t max_block);
+uint32_t BSP_DSP_Decimate_F32_Init(BSP_DSP_Decimate_F32_t * p_decimate, const float * p_coefficients, uint32_t num_taps, uint32_t factor, float * p_state, uint32_t max_block);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Decimate_Q15, BSP_DSP_Decimate_F32
+
+Function Description:
+    Filter and decimate the next block of a stream.
+
+Inputs:
+    p_decimate: the decimator
+    p_in: num_samples inputs
+    p_out: where to put num_samples / factor outputs, may be p_in
+    num_samples: a multiple of factor, up to max_block
+
+Returns:
+    uint32_t: the number of outputs
+
+Error Handling:
+    Nothing is done, and 0 returned, if num_samples isn't a multiple of factor or is over
+    max_block.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_DSP_Decimate_Q15(BSP_DSP_Decimate_Q15_t * p_decimate, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+uint32_t BSP_DSP_Decimate_F32(BSP_DSP_Decimate_F32_t * p_decimate, const float * p_in, float * p_out, uint32_t num_samples);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Interpolate_Q15_Init, BSP_DSP_Interpolate_F32_Init
+
+Function Description:
+    Set up an interpolator: L-1 zeros after each input, then an FIR filter (the anti-imaging
+    filter), done as a polyphase filter.
+
+Inputs:
+    p_interpolate: the interpolator
+    p_coefficients: num_taps taps, time reversed, with a gain of factor, kept by reference
+    num_taps: a multiple of factor
+    factor: at least 1
+    p_state: BSP_DSP_INTERPOLATE_STATE_SIZE(num_taps, factor, max_block) samples
+    max_block: most inputs per BSP_DSP_Interpolate_*
+
+Returns:
+    uint32_t: 1 on success, 0 for a bad num_taps, factor or max_block
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_DSP_Interpolate_Q15_Init(BSP_DSP_Interpolate_Q15_t * p_interpolate, const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, int16_t * p_state, uint32_t max_block);
+uint32_t BSP_DSP_Interpolate_F32_Init(BSP_DSP_Interpolate_F32_t * p_interpolate, const float * p_coefficients, uint32_t num_taps, uint32_t factor, float * p_state, uint32_t max_block);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Interpolate_Q15, BSP_DSP_Interpolate_F32
+
+Function Description:
+    Interpolate the next block of a stream.
+
+Inputs:
+    p_interpolate: the interpolator
+    p_in: num_samples inputs
+    p_out: where to put num_samples * factor outputs, not overlapping p_in
+    num_samples: up to max_block
+
+Returns:
+    uint32_t: the number of outputs
+
+Error Handling:
+    Nothing is done, and 0 returned, if num_samples is over max_block.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_DSP_Interpolate_Q15(BSP_DSP_Interpolate_Q15_t * p_interpolate, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+uint32_t BSP_DSP_Interpolate_F32(BSP_DSP_Interpolate_F32_t * p_interpolate, const float * p_in, float * p_out, uint32_t num_samples);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Biquad_Q31_Init, BSP_DSP_Biquad_F32_Init, BSP_DSP_Biquad_F32x4_Init
+
+Function Description:
+    Set up a cascade of biquads with empty (all 0) history. Each stage is
+    y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2], and feeds the next.
+
+Inputs:
+    p_biquad: the cascade
+    p_coefficients: BSP_DSP_BIQUAD_COEFFICIENTS per stage, kept by reference
+    num_stages: at least 1
+    p_state: BSP_DSP_BIQUAD_*_STATE_SIZE(num_stages) words
+
+Returns:
+    uint32_t: 1 on success, 0 if num_stages is 0
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_DSP_Biquad_Q31_Init(BSP_DSP_Biquad_Q31_t * p_biquad, const int32_t * p_coefficients, uint32_t num_stages, int32_t * p_state);
+uint32_t BSP_DSP_Biquad_F32_Init(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_coefficients, uint32_t num_stages, float * p_state);
+uint32_t BSP_DSP_Biquad_F32x4_Init(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_coefficients, uint32_t num_stages, float * p_state);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Biquad_Q31, BSP_DSP_Biquad_F32, BSP_DSP_Biquad_F32x4
+
+Function Description:
+    Filter the next block of a stream through the cascade, a stage at a time. The F32x4
+    version filters 4 streams interleaved sample by sample ({a0, b0, c0, d0, a1, b1, ...}).
+
+Inputs:
+    p_biquad: the cascade
+    p_in: num_samples inputs (num_samples * 4 for F32x4)
+    p_out: where to put as many outputs, may be p_in
+    num_samples: any number, per stream for F32x4
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_DSP_Biquad_Q31(BSP_DSP_Biquad_Q31_t * p_biquad, const int32_t * p_in, int32_t * p_out, uint32_t num_samples);
+void BSP_DSP_Biquad_F32(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_in, float * p_out, uint32_t num_samples);
+void BSP_DSP_Biquad_F32x4(BSP_DSP_Biquad_F32_t * p_biquad, const float * p_in, float * p_out, uint32_t num_samples);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Moving_Average_Q15_Init, BSP_DSP_Moving_Average_F32_Init
+
+Function Description:
+    Set up a moving average (boxcar filter) with empty (all 0) history.
+
+Inputs:
+    p_average: the moving average
+    p_history: length samples
+    length: samples averaged, 1...65536
+
+Returns:
+    uint32_t: 1 on success, 0 for a bad length
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_DSP_Moving_Average_Q15_Init(BSP_DSP_Moving_Average_Q15_t * p_average, int16_t * p_history, uint32_t length);
+uint32_t BSP_DSP_Moving_Average_F32_Init(BSP_DSP_Moving_Average_F32_t * p_average, float * p_history, uint32_t length);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Moving_Average_Q15, BSP_DSP_Moving_Average_F32
+
+Function Description:
+    Average the next block of a stream, each output the mean of its input and the
+    length - 1 before it. The float sum is recomputed once per length samples so rounding
+    can't build up.
+
+Inputs:
+    p_average: the moving average
+    p_in: num_samples inputs
+    p_out: where to put num_samples outputs, may be p_in
+    num_samples: any number
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_DSP_Moving_Average_Q15(BSP_DSP_Moving_Average_Q15_t * p_average, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+void BSP_DSP_Moving_Average_F32(BSP_DSP_Moving_Average_F32_t * p_average, const float * p_in, float * p_out, uint32_t num_samples);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_DSP_Reference_*
+
+Function Description:
+    Straightforward scalar versions of the kernels above, for checking them. Each filters a
+    whole signal in one go from empty history, written for clarity rather than speed:
+    the FIR is the convolution sum, decimation the full FIR output with every factor-th
+    kept, interpolation the zero stuffed signal through the full FIR, the biquads straight
+    from the difference equation (direct form I) and the moving average a fresh sum per
+    output. The results match the kernels' exactly for Q15 and Q31, and to within rounding
+    for float.
+
+Inputs:
+    As the kernels, with the filter's parameters in place of its state.
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_DSP_Reference_FIR_Q15(const int16_t * p_coefficients, uint32_t num_taps, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_FIR_Q31(const int32_t * p_coefficients, uint32_t num_taps, const int32_t * p_in, int32_t * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_FIR_F32(const float * p_coefficients, uint32_t num_taps, const float * p_in, float * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Decimate_Q15(const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Decimate_F32(const float * p_coefficients, uint32_t num_taps, uint32_t factor, const float * p_in, float * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Interpolate_Q15(const int16_t * p_coefficients, uint32_t num_taps, uint32_t factor, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Interpolate_F32(const float * p_coefficients, uint32_t num_taps, uint32_t factor, const float * p_in, float * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Biquad_Q31(const int32_t * p_coefficients, uint32_t num_stages, const int32_t * p_in, int32_t * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Biquad_F32(const float * p_coefficients, uint32_t num_stages, const float * p_in, float * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Moving_Average_Q15(uint32_t length, const int16_t * p_in, int16_t * p_out, uint32_t num_samples);
+void BSP_DSP_Reference_Moving_Average_F32(uint32_t length, const float * p_in, float * p_out, uint32_t num_samples);
+
+#endif
@@ -0,0 +1,1550 @@
+
+#include "BSP_FAT32.h"
+#include "PSP_EMMC.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_FAT32 Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define FAT32_LINE_BYTES            (BSP_FAT32_LINE_SECTORS * BSP_FAT32_SECTOR_SIZE)
+
+// Boot Sector (BPB) Offsets
+#define BPB_BYTES_PER_SECTOR        0x0Bu   // 16 bit
+#define BPB_SECTORS_PER_CLUSTER     0x0Du   // 8 bit
+#define BPB_RESERVED_SECTORS        0x0Eu   // 16 bit
+#define BPB_NUM_FATS                0x10u   // 8 bit
+#define BPB_ROOT_ENTRIES            0x11u   // 16 bit, 0 on FAT32
+#define BPB_TOTAL_SECTORS_16        0x13u   // 16 bit
+#define BPB_SECTORS_PER_FAT_16      0x16u   // 16 bit, 0 on FAT32
+#define BPB_TOTAL_SECTORS_32        0x20u   // 32 bit
+#define BPB_SECTORS_PER_FAT_32      0x24u   // 32 bit
+#define BPB_ROOT_CLUSTER            0x2Cu   // 32 bit
+#define BPB_FSINFO_SECTOR           0x30u   // 16 bit
+#define BOOT_SIGNATURE              0x1FEu  // 0x55, 0xAA
+
+// Master Boot Record
+#define MBR_PARTITION_TABLE         0x1BEu  // 4 entries of 16 bytes
+#define MBR_PARTITION_TYPE          0x04u   // offset in an entry
+#define MBR_PARTITION_FIRST_SECTOR  0x08u   // offset in an entry
+#define MBR_TYPE_FAT32_CHS          0x0Bu
+#define MBR_TYPE_FAT32_LBA          0x0Cu
+
+// FSInfo Sector Offsets
+#define FSINFO_LEAD_SIGNATURE       0x000u  // 0x41615252
+#define FSINFO_STRUCT_SIGNATURE     0x1E4u  // 0x61417272
+#define FSINFO_FREE_COUNT           0x1E8u  // 0xFFFFFFFF is unknown
+#define FSINFO_NEXT_FREE            0x1ECu  // where to start looking for a free cluster
+
+// Directory Entries
+#define DIR_ENTRY_SIZE              32u
+#define DIR_MAX_SIZE                (65536u * DIR_ENTRY_SIZE)   // the spec's limit on entries per directory
+#define DIR_NAME                    0x00u   // 11 bytes, 8 name and 3 extension, space padded
+#define DIR_ATTRIBUTES              0x0Bu
+#define DIR_CREATE_DATE             0x10u
+#define DIR_ACCESS_DATE             0x12u
+#define DIR_CLUSTER_HIGH            0x14u
+#define DIR_WRITE_DATE              0x18u
+#define DIR_CLUSTER_LOW             0x1Au
+#define DIR_FILE_SIZE               0x1Cu
+#define DIR_NAME_END                0x00u   // first name byte of the entry after the last one
+#define DIR_NAME_DELETED            0xE5u   // first name byte of a free entry
+
+#define ATTRIBUTE_VOLUME_ID         0x08u
+#define ATTRIBUTE_DIRECTORY         0x10u
+#define ATTRIBUTE_ARCHIVE           0x20u
+#define ATTRIBUTE_LONG_NAME         0x0Fu   // all of read only, hidden, system and volume id
+
+#define DIR_DEFAULT_DATE            0x2821u // 2000-01-01, there is no real time clock
+
+// FAT Entries
+#define FAT_ENTRY_MASK              0x0FFFFFFFu  // the top 4 bits are reserved
+#define FAT_ENTRIES_PER_SECTOR      (BSP_FAT32_SECTOR_SIZE / 4u)
+#define FAT_FREE                    0x00000000u
+#define FAT_END_OF_CHAIN            0x0FFFFFF8u  // this and above end a chain
+#define FAT_FIRST_CLUSTER           2u           // clusters 0 and 1 don't exist
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_FAT32 Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum FAT32_Line_State_Type
+{
+    FAT32_Line_State_Empty,
+    FAT32_Line_State_Loading,       // read-ahead request queued or in progress
+    FAT32_Line_State_Valid
+} FAT32_Line_State_t;
+
+
+
+typedef struct FAT32_Line_Type
+{
+    uint32_t first_sector;
+    uint32_t num_sectors;
+    FAT32_Line_State_t state;
+    uint32_t dirty_mask;            // bit n set if sector n of the line needs writing back
+    uint32_t last_used;             // fat32_use_count when last used, the lowest is evicted first
+    PSP_EMMC_Request_t request;     // for read-ahead
+} FAT32_Line_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_FAT32 Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static FAT32_Line_t fat32_lines[BSP_FAT32_CACHE_LINES];
+static uint8_t fat32_line_data[BSP_FAT32_CACHE_LINES][FAT32_LINE_BYTES] __attribute__((aligned(4)));
+
+static uint32_t fat32_line_sectors;         // sectors per line, the cluster size if smaller than BSP_FAT32_LINE_SECTORS
+static uint32_t fat32_line_origin;          // lines are aligned to the first data sector so they don't cross clusters
+static uint32_t fat32_use_count;
+static BSP_FAT32_Cache_Stats_t fat32_stats;
+
+static uint32_t fat32_mounted;
+static uint32_t fat32_volume_sector;        // first sector of the volume on the card
+static uint32_t fat32_fat_sector;           // first sector of the first FAT
+static uint32_t fat32_sectors_per_fat;
+static uint32_t fat32_num_fats;
+static uint32_t fat32_data_sector;          // first sector of cluster 2
+static uint32_t fat32_sectors_per_cluster;
+static uint32_t fat32_cluster_shift;        // log2 of bytes per cluster
+static uint32_t fat32_num_clusters;
+static uint32_t fat32_root_cluster;
+static uint32_t fat32_fsinfo_sector;        // 0 if there isn't one
+static uint32_t fat32_fsinfo_stale;         // the free count has been marked unknown
+static uint32_t fat32_next_free;            // where the search for a free cluster starts
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_FAT32 Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+// FAT structures are little endian and not always aligned
+static uint32_t FAT32_Read_16(const uint8_t * p_bytes)
+{
+    return (uint32_t)p_bytes[0] | ((uint32_t)p_bytes[1] << 8u);
+}
+
+
+
+static uint32_t FAT32_Read_32(const uint8_t * p_bytes)
+{
+    return FAT32_Read_16(p_bytes) | (FAT32_Read_16(p_bytes + 2u) << 16u);
+}
+
+
+
+static void FAT32_Write_16(uint8_t * p_bytes, uint32_t value)
+{
+    p_bytes[0] = (uint8_t)value;
+    p_bytes[1] = (uint8_t)(value >> 8u);
+}
+
+
+
+static void FAT32_Write_32(uint8_t * p_bytes, uint32_t value)
+{
+    FAT32_Write_16(p_bytes, value);
+    FAT32_Write_16(p_bytes + 2u, value >> 16u);
+}
+
+
+
+static uint32_t FAT32_Is_Valid_Cluster(uint32_t cluster)
+{
+    return ((cluster >= FAT_FIRST_CLUSTER) && (cluster < (fat32_num_clusters + FAT_FIRST_CLUSTER))) ? 1u : 0u;
+}
+
+
+
+static uint32_t FAT32_Cluster_To_Sector(uint32_t cluster)
+{
+    return fat32_data_sector + ((cluster - FAT_FIRST_CLUSTER) * fat32_sectors_per_cluster);
+}
+
+
+
+static uint32_t FAT32_Line_Start(uint32_t sector)
+{
+    // unsigned wrap around keeps this right for sectors before the origin too
+    return sector - ((sector - fat32_line_origin) & (fat32_line_sectors - 1u));
+}
+
+
+
+static uint8_t * FAT32_Line_Data(FAT32_Line_t * p_line)
+{
+    return fat32_line_data[p_line - fat32_lines];
+}
+
+
+
+/**
+ * A finished read-ahead becomes a valid line, or an empty one if it failed.
+ */
+static void FAT32_Line_Settle(FAT32_Line_t * p_line)
+{
+    if ((p_line->state == FAT32_Line_State_Loading) && (p_line->request.result != PSP_EMMC_Result_Pending))
+    {
+        p_line->state = (p_line->request.result == PSP_EMMC_Result_OK) ? FAT32_Line_State_Valid : FAT32_Line_State_Empty;
+    }
+}
+
+
+
+static FAT32_Line_t * FAT32_Find_Line(uint32_t first_sector)
+{
+    for (uint32_t i = 0u; i < BSP_FAT32_CACHE_LINES; i++)
+    {
+        FAT32_Line_t * p_line = &fat32_lines[i];
+
+        FAT32_Line_Settle(p_line);
+
+        if ((p_line->state != FAT32_Line_State_Empty) && (p_line->first_sector == first_sector))
+        {
+            return p_line;
+        }
+    }
+
+    return 0;
+}
+
+
+
+/**
+ * Pick the line to reuse: an empty one, or else the least recently used one that isn't being
+ * loaded. The line used last is never picked, so a caller can hold on to one line while getting
+ * another. Dirty lines are only picked if allow_dirty is set, read-ahead doesn't write back.
+ */
+static FAT32_Line_t * FAT32_Choose_Victim(uint32_t allow_dirty)
+{
+    FAT32_Line_t * p_victim = 0;
+
+    for (uint32_t i = 0u; i < BSP_FAT32_CACHE_LINES; i++)
+    {
+        FAT32_Line_t * p_line = &fat32_lines[i];
+
+        FAT32_Line_Settle(p_line);
+
+        if (p_line->state == FAT32_Line_State_Empty)
+        {
+            return p_line;
+        }
+
+        if ((p_line->state == FAT32_Line_State_Loading) || (p_line->last_used == fat32_use_count) ||
+            (!allow_dirty && p_line->dirty_mask))
+        {
+            continue;
+        }
+
+        if ((p_victim == 0) || (p_line->last_used < p_victim->last_used))
+        {
+            p_victim = p_line;
+        }
+    }
+
+    return p_victim;
+}
+
+
+
+/**
+ * Write the dirty sectors of a line to the card, a run of dirty sectors at a time. Sectors in
+ * the first FAT are written to the other FATs too.
+ */
+static BSP_FAT32_Result_t FAT32_Write_Back(FAT32_Line_t * p_line)
+{
+    const uint32_t FAT_END = fat32_fat_sector + fat32_sectors_per_fat;
+    uint8_t * p_data = FAT32_Line_Data(p_line);
+    uint32_t first = 0u;
+
+    while (first < p_line->num_sectors)
+    {
+        if (!(p_line->dirty_mask & (1u << first)))
+        {
+            first++;
+            continue;
+        }
+
+        uint32_t end = first + 1u;
+
+        while ((end < p_line->num_sectors) && (p_line->dirty_mask & (1u << end)))
+        {
+            end++;
+        }
+
+        const uint32_t RUN_START = p_line->first_sector + first;
+        const uint32_t RUN_END = p_line->first_sector + end;
+
+        if (PSP_EMMC_Write_Blocks(RUN_START, end - first, p_data + (first * BSP_FAT32_SECTOR_SIZE)) != PSP_EMMC_Result_OK)
+        {
+            return BSP_FAT32_Result_Disk_Error;
+        }
+
+        const uint32_t FAT_RUN_START = (RUN_START > fat32_fat_sector) ? RUN_START : fat32_fat_sector;
+        const uint32_t FAT_RUN_END = (RUN_END < FAT_END) ? RUN_END : FAT_END;
+
+        for (uint32_t copy = 1u; (copy < fat32_num_fats) && (FAT_RUN_START < FAT_RUN_END); copy++)
+        {
+            if (PSP_EMMC_Write_Blocks(FAT_RUN_START + (copy * fat32_sectors_per_fat), FAT_RUN_END - FAT_RUN_START,
+                                      p_data + ((FAT_RUN_START - p_line->first_sector) * BSP_FAT32_SECTOR_SIZE)) != PSP_EMMC_Result_OK)
+            {
+                return BSP_FAT32_Result_Disk_Error;
+            }
+        }
+
+        first = end;
+    }
+
+    p_line->dirty_mask = 0u;
+    fat32_stats.write_backs++;
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+static BSP_FAT32_Result_t FAT32_Flush_All(void)
+{
+    for (uint32_t i = 0u; i < BSP_FAT32_CACHE_LINES; i++)
+    {
+        if ((fat32_lines[i].state == FAT32_Line_State_Valid) && fat32_lines[i].dirty_mask)
+        {
+            BSP_FAT32_Result_t result = FAT32_Write_Back(&fat32_lines[i]);
+
+            if (result != BSP_FAT32_Result_OK)
+            {
+                return result;
+            }
+        }
+    }
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+static uint32_t FAT32_Line_Size(uint32_t first_sector)
+{
+    const uint32_t NUM_BLOCKS = PSP_EMMC_Get_Num_Blocks();
+
+    if (first_sector >= NUM_BLOCKS)
+    {
+        return 0u;
+    }
+
+    return ((NUM_BLOCKS - first_sector) < fat32_line_sectors) ? (NUM_BLOCKS - first_sector) : fat32_line_sectors;
+}
+
+
+
+/**
+ * Get the line starting at first_sector, from the cache or from the card. If load is 0 a line
+ * that isn't cached is zero filled instead of read, for data that is about to be overwritten.
+ */
+static BSP_FAT32_Result_t FAT32_Get_Line(uint32_t first_sector, uint32_t load, FAT32_Line_t ** pp_line)
+{
+    FAT32_Line_t * p_line = FAT32_Find_Line(first_sector);
+
+    if (p_line != 0)
+    {
+        while (p_line->request.result == PSP_EMMC_Result_Pending)
+        {
+            PSP_EMMC_Service(); // read-ahead still on its way
+        }
+
+        FAT32_Line_Settle(p_line);
+
+        if (p_line->state != FAT32_Line_State_Valid)
+        {
+            return BSP_FAT32_Result_Disk_Error;
+        }
+
+        fat32_stats.hits++;
+        p_line->last_used = ++fat32_use_count;
+        *pp_line = p_line;
+
+        return BSP_FAT32_Result_OK;
+    }
+
+    const uint32_t NUM_SECTORS = FAT32_Line_Size(first_sector);
+
+    if (NUM_SECTORS == 0u)
+    {
+        return BSP_FAT32_Result_Corrupt;
+    }
+
+    p_line = FAT32_Choose_Victim(1u);
+
+    while (p_line == 0)
+    {
+        // every other line is loading, let them finish
+        PSP_EMMC_Service();
+        p_line = FAT32_Choose_Victim(1u);
+    }
+
+    if (p_line->dirty_mask)
+    {
+        BSP_FAT32_Result_t result = FAT32_Write_Back(p_line);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+    }
+
+    p_line->state = FAT32_Line_State_Empty;
+    p_line->first_sector = first_sector;
+    p_line->num_sectors = NUM_SECTORS;
+    p_line->request.result = PSP_EMMC_Result_OK;
+
+    if (load)
+    {
+        if (PSP_EMMC_Read_Blocks(first_sector, NUM_SECTORS, FAT32_Line_Data(p_line)) != PSP_EMMC_Result_OK)
+        {
+            return BSP_FAT32_Result_Disk_Error;
+        }
+
+        fat32_stats.misses++;
+    }
+    else
+    {
+        memset(FAT32_Line_Data(p_line), 0, FAT32_LINE_BYTES);
+    }
+
+    p_line->state = FAT32_Line_State_Valid;
+    p_line->last_used = ++fat32_use_count;
+    *pp_line = p_line;
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+/**
+ * Queue the line starting at first_sector on PSP_EMMC without waiting for it, unless it is
+ * already cached or every line that could be reused is busy or dirty.
+ */
+static void FAT32_Start_Read_Ahead(uint32_t first_sector)
+{
+    if (FAT32_Find_Line(first_sector) != 0)
+    {
+        return;
+    }
+
+    const uint32_t NUM_SECTORS = FAT32_Line_Size(first_sector);
+    FAT32_Line_t * p_line = FAT32_Choose_Victim(0u);
+
+    if ((NUM_SECTORS == 0u) || (p_line == 0))
+    {
+        return;
+    }
+
+    p_line->first_sector = first_sector;
+    p_line->num_sectors = NUM_SECTORS;
+    p_line->request.direction = PSP_EMMC_Direction_Read;
+    p_line->request.first_block = first_sector;
+    p_line->request.num_blocks = NUM_SECTORS;
+    p_line->request.p_buffer = FAT32_Line_Data(p_line);
+
+    // newest, so the next read-ahead doesn't pick it, but still older than the line in use
+    p_line->last_used = fat32_use_count - 1u;
+    p_line->state = (PSP_EMMC_Submit(&p_line->request) == PSP_EMMC_Result_Pending) ? FAT32_Line_State_Loading
+                                                                                    : FAT32_Line_State_Empty;
+
+    fat32_stats.read_aheads++;
+}
+
+
+
+/**
+ * Get the cache line holding a sector, and a pointer to the sector in it.
+ */
+static BSP_FAT32_Result_t FAT32_Get_Sector(uint32_t sector, FAT32_Line_t ** pp_line, uint8_t ** pp_sector)
+{
+    const uint32_t FIRST_SECTOR = FAT32_Line_Start(sector);
+    BSP_FAT32_Result_t result = FAT32_Get_Line(FIRST_SECTOR, 1u, pp_line);
+
+    *pp_sector = FAT32_Line_Data(*pp_line) + ((sector - FIRST_SECTOR) * BSP_FAT32_SECTOR_SIZE);
+
+    return result;
+}
+
+
+
+static void FAT32_Mark_Dirty(FAT32_Line_t * p_line, uint32_t sector)
+{
+    p_line->dirty_mask |= 1u << (sector - p_line->first_sector);
+}
+
+
+
+static BSP_FAT32_Result_t FAT32_Get_FAT_Entry(uint32_t cluster, uint32_t * p_value)
+{
+    FAT32_Line_t * p_line;
+    uint8_t * p_sector;
+    BSP_FAT32_Result_t result = FAT32_Get_Sector(fat32_fat_sector + (cluster / FAT_ENTRIES_PER_SECTOR), &p_line, &p_sector);
+
+    if (result == BSP_FAT32_Result_OK)
+    {
+        *p_value = FAT32_Read_32(p_sector + ((cluster % FAT_ENTRIES_PER_SECTOR) * 4u)) & FAT_ENTRY_MASK;
+    }
+
+    return result;
+}
+
+
+
+static BSP_FAT32_Result_t FAT32_Set_FAT_Entry(uint32_t cluster, uint32_t value)
+{
+    const uint32_t SECTOR = fat32_fat_sector + (cluster / FAT_ENTRIES_PER_SECTOR);
+    FAT32_Line_t * p_line;
+    uint8_t * p_sector;
+    BSP_FAT32_Result_t result = FAT32_Get_Sector(SECTOR, &p_line, &p_sector);
+
+    if (result == BSP_FAT32_Result_OK)
+    {
+        uint8_t * p_entry = p_sector + ((cluster % FAT_ENTRIES_PER_SECTOR) * 4u);
+
+        FAT32_Write_32(p_entry, (FAT32_Read_32(p_entry) & ~FAT_ENTRY_MASK) | (value & FAT_ENTRY_MASK));
+        FAT32_Mark_Dirty(p_line, SECTOR);
+    }
+
+    return result;
+}
+
+
+
+/**
+ * Find a free cluster, starting where the last search left off, and mark it as the end of a
+ * chain.
+ */
+static BSP_FAT32_Result_t FAT32_Allocate_Cluster(uint32_t * p_cluster)
+{
+    for (uint32_t i = 0u; i < fat32_num_clusters; i++)
+    {
+        const uint32_t CLUSTER = fat32_next_free;
+        uint32_t value;
+
+        fat32_next_free = FAT32_Is_Valid_Cluster(CLUSTER + 1u) ? (CLUSTER + 1u) : FAT_FIRST_CLUSTER;
+
+        BSP_FAT32_Result_t result = FAT32_Get_FAT_Entry(CLUSTER, &value);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        if (value == FAT_FREE)
+        {
+            result = FAT32_Set_FAT_Entry(CLUSTER, FAT_END_OF_CHAIN | 0x7u);
+
+            if ((result == BSP_FAT32_Result_OK) && !fat32_fsinfo_stale && (fat32_fsinfo_sector != 0u))
+            {
+                FAT32_Line_t * p_line;
+                uint8_t * p_sector;
+
+                result = FAT32_Get_Sector(fat32_fsinfo_sector, &p_line, &p_sector);
+
+                if (result == BSP_FAT32_Result_OK)
+                {
+                    FAT32_Write_32(p_sector + FSINFO_FREE_COUNT, 0xFFFFFFFFu);
+                    FAT32_Mark_Dirty(p_line, fat32_fsinfo_sector);
+                    fat32_fsinfo_stale = 1u;
+                }
+            }
+
+            *p_cluster = CLUSTER;
+
+            return result;
+        }
+    }
+
+    return BSP_FAT32_Result_Disk_Full;
+}
+
+
+
+/**
+ * Fill a file's extent table by walking its cluster chain, starting from a cluster already
+ * known to be in the chain. Stops at the end of the chain or when the table is full.
+ */
+static BSP_FAT32_Result_t FAT32_Load_Extents(BSP_FAT32_File_t * p_file, uint32_t file_cluster, uint32_t cluster)
+{
+    if (!FAT32_Is_Valid_Cluster(cluster))
+    {
+        return BSP_FAT32_Result_Corrupt;
+    }
+
+    BSP_FAT32_Extent_t * p_extent = &p_file->extents[0];
+
+    p_extent->file_cluster = file_cluster;
+    p_extent->first_cluster = cluster;
+    p_extent->num_clusters = 1u;
+    p_file->num_extents = 1u;
+
+    // a chain can't be longer than the volume, anything longer is a loop
+    for (uint32_t i = 0u; i < fat32_num_clusters; i++)
+    {
+        const uint32_t LAST = p_extent->first_cluster + p_extent->num_clusters - 1u;
+        uint32_t next;
+
+        BSP_FAT32_Result_t result = FAT32_Get_FAT_Entry(LAST, &next);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        if (next >= FAT_END_OF_CHAIN)
+        {
+            return BSP_FAT32_Result_OK;
+        }
+
+        if (!FAT32_Is_Valid_Cluster(next))
+        {
+            return BSP_FAT32_Result_Corrupt;
+        }
+
+        if (next == (LAST + 1u))
+        {
+            p_extent->num_clusters++;
+        }
+        else if (p_file->num_extents < BSP_FAT32_MAX_EXTENTS)
+        {
+            p_extent[1].file_cluster = p_extent->file_cluster + p_extent->num_clusters;
+            p_extent[1].first_cluster = next;
+            p_extent[1].num_clusters = 1u;
+            p_extent++;
+            p_file->num_extents++;
+        }
+        else
+        {
+            return BSP_FAT32_Result_OK; // the rest is loaded when it is needed
+        }
+    }
+
+    return BSP_FAT32_Result_Corrupt;
+}
+
+
+
+/**
+ * Find the sector holding a byte of a file, and the number of sectors from there to the end
+ * of its extent, all of which are adjacent on the card.
+ *
+ * Returns BSP_FAT32_Result_Not_Found if the chain ends before the byte.
+ */
+static BSP_FAT32_Result_t FAT32_Locate(BSP_FAT32_File_t * p_file, uint32_t position, uint32_t * p_sector,
+                                       uint32_t * p_num_sectors)
+{
+    const uint32_t FILE_CLUSTER = position >> fat32_cluster_shift;
+    BSP_FAT32_Result_t result;
+
+    if (p_file->first_cluster == 0u)
+    {
+        return BSP_FAT32_Result_Not_Found;
+    }
+
+    if ((p_file->num_extents == 0u) || (FILE_CLUSTER < p_file->extents[0].file_cluster))
+    {
+        // behind the window, start again from the beginning of the chain
+        result = FAT32_Load_Extents(p_file, 0u, p_file->first_cluster);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+    }
+
+    while (1)
+    {
+        for (uint32_t i = 0u; i < p_file->num_extents; i++)
+        {
+            const BSP_FAT32_Extent_t * p_extent = &p_file->extents[i];
+
+            if (FILE_CLUSTER < (p_extent->file_cluster + p_extent->num_clusters))
+            {
+                const uint32_t CLUSTER_OFFSET = FILE_CLUSTER - p_extent->file_cluster;
+                const uint32_t SECTOR_OFFSET = (position / BSP_FAT32_SECTOR_SIZE) & (fat32_sectors_per_cluster - 1u);
+
+                *p_sector = FAT32_Cluster_To_Sector(p_extent->first_cluster + CLUSTER_OFFSET) + SECTOR_OFFSET;
+                *p_num_sectors = ((p_extent->num_clusters - CLUSTER_OFFSET) * fat32_sectors_per_cluster) - SECTOR_OFFSET;
+
+                return BSP_FAT32_Result_OK;
+            }
+        }
+
+        // past the window, slide it along the chain
+        const BSP_FAT32_Extent_t * p_last = &p_file->extents[p_file->num_extents - 1u];
+        uint32_t next;
+
+        result = FAT32_Get_FAT_Entry(p_last->first_cluster + p_last->num_clusters - 1u, &next);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        if (next >= FAT_END_OF_CHAIN)
+        {
+            return BSP_FAT32_Result_Not_Found;
+        }
+
+        result = FAT32_Load_Extents(p_file, p_last->file_cluster + p_last->num_clusters, next);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+    }
+}
+
+
+
+/**
+ * Add a cluster to the end of a file's chain, the file's extents must reach the end of the
+ * chain (any FAT32_Locate that returned BSP_FAT32_Result_Not_Found leaves them that way).
+ */
+static BSP_FAT32_Result_t FAT32_Extend_Chain(BSP_FAT32_File_t * p_file, uint32_t * p_cluster)
+{
+    uint32_t cluster;
+    BSP_FAT32_Result_t result = FAT32_Allocate_Cluster(&cluster);
+
+    if (result != BSP_FAT32_Result_OK)
+    {
+        return result;
+    }
+
+    if (p_file->first_cluster == 0u)
+    {
+        p_file->first_cluster = cluster;
+        p_file->extents[0].file_cluster = 0u;
+        p_file->extents[0].first_cluster = cluster;
+        p_file->extents[0].num_clusters = 1u;
+        p_file->num_extents = 1u;
+    }
+    else
+    {
+        BSP_FAT32_Extent_t * p_last = &p_file->extents[p_file->num_extents - 1u];
+        const uint32_t LAST = p_last->first_cluster + p_last->num_clusters - 1u;
+        const uint32_t FILE_CLUSTER = p_last->file_cluster + p_last->num_clusters;
+
+        result = FAT32_Set_FAT_Entry(LAST, cluster);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        if (cluster == (LAST + 1u))
+        {
+            p_last->num_clusters++;
+        }
+        else
+        {
+            if (p_file->num_extents == BSP_FAT32_MAX_EXTENTS)
+            {
+                p_file->num_extents = 0u; // start a new window
+            }
+
+            p_last = &p_file->extents[p_file->num_extents++];
+            p_last->file_cluster = FILE_CLUSTER;
+            p_last->first_cluster = cluster;
+            p_last->num_clusters = 1u;
+        }
+    }
+
+    *p_cluster = cluster;
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+/**
+ * Turn the next part of a path into a space padded 8.3 name, and move the path past it.
+ *
+ * example:
+ *      "logs/boot.txt" gives "LOGS       " and leaves "boot.txt"
+ *      "boot.txt" gives "BOOT    TXT" and leaves ""
+ *
+ * Returns 0 if the part isn't a valid short name, which then can't match anything.
+ */
+static uint32_t FAT32_Next_Short_Name(const char ** pp_path, uint8_t name[11])
+{
+    const char * p_path = *pp_path;
+    uint32_t length = 0u;
+    uint32_t limit = 8u;
+    uint32_t valid = 1u;
+
+    memset(name, ' ', 11u);
+
+    while ((*p_path != '\0') && (*p_path != '/'))
+    {
+        char c = *p_path++;
+
+        if ((c == '.') && (limit == 8u) && (length != 0u))
+        {
+            length = 8u;
+            limit = 11u;
+            continue;
+        }
+
+        if ((length == limit) || (c == '.') || (c == ' '))
+        {
+            valid = 0u;
+            continue;
+        }
+
+        name[length++] = ((c >= 'a') && (c <= 'z')) ? (uint8_t)(c - 'a' + 'A') : (uint8_t)c;
+    }
+
+    if (length == 0u)
+    {
+        valid = 0u;
+    }
+
+    while (*p_path == '/')
+    {
+        p_path++;
+    }
+
+    *pp_path = p_path;
+
+    return valid;
+}
+
+
+
+/**
+ * Look for a name in a directory. On BSP_FAT32_Result_Not_Found, *p_free_sector is the first
+ * free entry seen, or 0 if the directory is full.
+ */
+static BSP_FAT32_Result_t FAT32_Find_Entry(uint32_t dir_cluster, const uint8_t name[11], uint32_t * p_sector,
+                                           uint32_t * p_offset, uint32_t * p_free_sector, uint32_t * p_free_offset)
+{
+    BSP_FAT32_File_t dir;
+
+    dir.first_cluster = dir_cluster;
+    dir.num_extents = 0u;
+    *p_free_sector = 0u;
+
+    for (uint32_t position = 0u; position < DIR_MAX_SIZE; position += DIR_ENTRY_SIZE)
+    {
+        FAT32_Line_t * p_line;
+        uint8_t * p_entry;
+        uint32_t sector;
+        uint32_t num_sectors;
+
+        BSP_FAT32_Result_t result = FAT32_Locate(&dir, position, &sector, &num_sectors);
+
+        if (result == BSP_FAT32_Result_OK)
+        {
+            result = FAT32_Get_Sector(sector, &p_line, &p_entry);
+        }
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        p_entry += position % BSP_FAT32_SECTOR_SIZE;
+
+        if ((p_entry[DIR_NAME] == DIR_NAME_END) || (p_entry[DIR_NAME] == DIR_NAME_DELETED))
+        {
+            if (*p_free_sector == 0u)
+            {
+                *p_free_sector = sector;
+                *p_free_offset = position % BSP_FAT32_SECTOR_SIZE;
+            }
+
+            if (p_entry[DIR_NAME] == DIR_NAME_END)
+            {
+                return BSP_FAT32_Result_Not_Found;
+            }
+
+            continue;
+        }
+
+        if (((p_entry[DIR_ATTRIBUTES] & ATTRIBUTE_LONG_NAME) == ATTRIBUTE_LONG_NAME) ||
+            (p_entry[DIR_ATTRIBUTES] & ATTRIBUTE_VOLUME_ID))
+        {
+            continue;
+        }
+
+        if (memcmp(p_entry, name, 11u) == 0)
+        {
+            *p_sector = sector;
+            *p_offset = position % BSP_FAT32_SECTOR_SIZE;
+
+            return BSP_FAT32_Result_OK;
+        }
+    }
+
+    return BSP_FAT32_Result_Corrupt;
+}
+
+
+
+/**
+ * Walk a path to its last part. On BSP_FAT32_Result_Not_Found, *p_dir_cluster is the
+ * directory the last part would go in, or 0 if a directory on the way doesn't exist.
+ */
+static BSP_FAT32_Result_t FAT32_Find_Path(const char * p_path, uint32_t * p_dir_cluster, uint8_t name[11],
+                                          uint32_t * p_sector, uint32_t * p_offset,
+                                          uint32_t * p_free_sector, uint32_t * p_free_offset)
+{
+    uint32_t dir_cluster = fat32_root_cluster;
+
+    while (*p_path == '/')
+    {
+        p_path++;
+    }
+
+    *p_dir_cluster = 0u;
+
+    while (1)
+    {
+        const uint32_t VALID = FAT32_Next_Short_Name(&p_path, name);
+        BSP_FAT32_Result_t result = FAT32_Find_Entry(dir_cluster, name, p_sector, p_offset, p_free_sector, p_free_offset);
+
+        if (!VALID && (result == BSP_FAT32_Result_OK))
+        {
+            result = BSP_FAT32_Result_Not_Found;
+        }
+
+        if (*p_path == '\0')
+        {
+            if (VALID)
+            {
+                *p_dir_cluster = dir_cluster;
+            }
+
+            return result;
+        }
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        FAT32_Line_t * p_line;
+        uint8_t * p_entry;
+
+        result = FAT32_Get_Sector(*p_sector, &p_line, &p_entry);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        p_entry += *p_offset;
+
+        if (!(p_entry[DIR_ATTRIBUTES] & ATTRIBUTE_DIRECTORY))
+        {
+            return BSP_FAT32_Result_Not_Found;
+        }
+
+        dir_cluster = (FAT32_Read_16(p_entry + DIR_CLUSTER_HIGH) << 16u) | FAT32_Read_16(p_entry + DIR_CLUSTER_LOW);
+
+        if (dir_cluster == 0u)
+        {
+            dir_cluster = fat32_root_cluster; // ".." of a directory in the root
+        }
+    }
+}
+
+
+
+/**
+ * Fill in a file from its directory entry, and walk its cluster chain into the extent table.
+ */
+static BSP_FAT32_Result_t FAT32_Open_Entry(BSP_FAT32_File_t * p_file, uint32_t sector, uint32_t offset)
+{
+    FAT32_Line_t * p_line;
+    uint8_t * p_entry;
+    BSP_FAT32_Result_t result = FAT32_Get_Sector(sector, &p_line, &p_entry);
+
+    if (result != BSP_FAT32_Result_OK)
+    {
+        return result;
+    }
+
+    p_entry += offset;
+
+    if (p_entry[DIR_ATTRIBUTES] & ATTRIBUTE_DIRECTORY)
+    {
+        return BSP_FAT32_Result_Bad_Request;
+    }
+
+    p_file->size = FAT32_Read_32(p_entry + DIR_FILE_SIZE);
+    p_file->position = 0u;
+    p_file->first_cluster = (FAT32_Read_16(p_entry + DIR_CLUSTER_HIGH) << 16u) | FAT32_Read_16(p_entry + DIR_CLUSTER_LOW);
+    p_file->num_extents = 0u;
+    p_file->sequential_position = 0u;
+    p_file->read_ahead_line = 0xFFFFFFFFu;
+    p_file->is_log = 0u;
+    p_file->entry_sector = sector;
+    p_file->entry_offset = offset;
+
+    if (p_file->first_cluster == 0u)
+    {
+        return BSP_FAT32_Result_OK;
+    }
+
+    return FAT32_Load_Extents(p_file, 0u, p_file->first_cluster);
+}
+
+
+
+/**
+ * Check for a FAT32 boot sector with 512 byte sectors.
+ */
+static uint32_t FAT32_Is_Boot_Sector(const uint8_t * p_sector)
+{
+    const uint32_t SECTORS_PER_CLUSTER = p_sector[BPB_SECTORS_PER_CLUSTER];
+
+    return ((p_sector[0] == 0xEBu || p_sector[0] == 0xE9u) &&
+            (p_sector[BOOT_SIGNATURE] == 0x55u) && (p_sector[BOOT_SIGNATURE + 1u] == 0xAAu) &&
+            (FAT32_Read_16(p_sector + BPB_BYTES_PER_SECTOR) == BSP_FAT32_SECTOR_SIZE) &&
+            (SECTORS_PER_CLUSTER != 0u) && ((SECTORS_PER_CLUSTER & (SECTORS_PER_CLUSTER - 1u)) == 0u) &&
+            (FAT32_Read_16(p_sector + BPB_RESERVED_SECTORS) != 0u) &&
+            (p_sector[BPB_NUM_FATS] != 0u) &&
+            (FAT32_Read_16(p_sector + BPB_ROOT_ENTRIES) == 0u) &&
+            (FAT32_Read_16(p_sector + BPB_SECTORS_PER_FAT_16) == 0u) &&
+            (FAT32_Read_32(p_sector + BPB_SECTORS_PER_FAT_32) != 0u)) ? 1u : 0u;
+}
+
+
+
+static void FAT32_Reset_Cache(uint32_t line_sectors, uint32_t line_origin)
+{
+    for (uint32_t i = 0u; i < BSP_FAT32_CACHE_LINES; i++)
+    {
+        fat32_lines[i].state = FAT32_Line_State_Empty;
+        fat32_lines[i].dirty_mask = 0u;
+        fat32_lines[i].request.result = PSP_EMMC_Result_OK;
+    }
+
+    fat32_line_sectors = line_sectors;
+    fat32_line_origin = line_origin;
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Mount(void)
+{
+    FAT32_Line_t * p_line;
+    uint8_t * p_sector;
+
+    fat32_mounted = 0u;
+
+    if (PSP_EMMC_Get_Num_Blocks() == 0u)
+    {
+        return BSP_FAT32_Result_Disk_Error;
+    }
+
+    while (!PSP_EMMC_Is_Idle())
+    {
+        PSP_EMMC_Service(); // read-ahead may still be writing into the cache
+    }
+
+    memset(&fat32_stats, 0, sizeof(fat32_stats));
+    fat32_use_count = 0u;
+
+    // one sector lines until the cluster size is known
+    FAT32_Reset_Cache(1u, 0u);
+
+    if (FAT32_Get_Sector(0u, &p_line, &p_sector) != BSP_FAT32_Result_OK)
+    {
+        return BSP_FAT32_Result_Disk_Error;
+    }
+
+    fat32_volume_sector = 0u;
+
+    if (!FAT32_Is_Boot_Sector(p_sector))
+    {
+        // not a volume without a partition table, look for the first FAT32 partition
+        if ((p_sector[BOOT_SIGNATURE] != 0x55u) || (p_sector[BOOT_SIGNATURE + 1u] != 0xAAu))
+        {
+            return BSP_FAT32_Result_No_Filesystem;
+        }
+
+        for (uint32_t i = 0u; i < 4u; i++)
+        {
+            const uint8_t * p_partition = p_sector + MBR_PARTITION_TABLE + (i * 16u);
+
+            if ((p_partition[MBR_PARTITION_TYPE] == MBR_TYPE_FAT32_CHS) || (p_partition[MBR_PARTITION_TYPE] == MBR_TYPE_FAT32_LBA))
+            {
+                fat32_volume_sector = FAT32_Read_32(p_partition + MBR_PARTITION_FIRST_SECTOR);
+                break;
+            }
+        }
+
+        if ((fat32_volume_sector == 0u) || (FAT32_Get_Sector(fat32_volume_sector, &p_line, &p_sector) != BSP_FAT32_Result_OK))
+        {
+            return BSP_FAT32_Result_No_Filesystem;
+        }
+
+        if (!FAT32_Is_Boot_Sector(p_sector))
+        {
+            return BSP_FAT32_Result_No_Filesystem;
+        }
+    }
+
+    const uint32_t TOTAL_SECTORS = (FAT32_Read_16(p_sector + BPB_TOTAL_SECTORS_16) != 0u) ? FAT32_Read_16(p_sector + BPB_TOTAL_SECTORS_16)
+                                                                                         : FAT32_Read_32(p_sector + BPB_TOTAL_SECTORS_32);
+    const uint32_t FSINFO_SECTOR = FAT32_Read_16(p_sector + BPB_FSINFO_SECTOR);
+
+    fat32_sectors_per_cluster = p_sector[BPB_SECTORS_PER_CLUSTER];
+    fat32_fat_sector = fat32_volume_sector + FAT32_Read_16(p_sector + BPB_RESERVED_SECTORS);
+    fat32_num_fats = p_sector[BPB_NUM_FATS];
+    fat32_sectors_per_fat = FAT32_Read_32(p_sector + BPB_SECTORS_PER_FAT_32);
+    fat32_data_sector = fat32_fat_sector + (fat32_num_fats * fat32_sectors_per_fat);
+    fat32_root_cluster = FAT32_Read_32(p_sector + BPB_ROOT_CLUSTER);
+
+    fat32_cluster_shift = 9u;
+
+    while ((1u << (fat32_cluster_shift - 9u)) < fat32_sectors_per_cluster)
+    {
+        fat32_cluster_shift++;
+    }
+
+    if ((fat32_volume_sector + TOTAL_SECTORS) <= fat32_data_sector)
+    {
+        return BSP_FAT32_Result_No_Filesystem;
+    }
+
+    // the FAT may have room for more clusters than the volume, but not the other way round
+    fat32_num_clusters = (fat32_volume_sector + TOTAL_SECTORS - fat32_data_sector) / fat32_sectors_per_cluster;
+
+    if (fat32_num_clusters > ((fat32_sectors_per_fat * FAT_ENTRIES_PER_SECTOR) - FAT_FIRST_CLUSTER))
+    {
+        fat32_num_clusters = (fat32_sectors_per_fat * FAT_ENTRIES_PER_SECTOR) - FAT_FIRST_CLUSTER;
+    }
+
+    if (!FAT32_Is_Valid_Cluster(fat32_root_cluster))
+    {
+        return BSP_FAT32_Result_No_Filesystem;
+    }
+
+    fat32_fsinfo_sector = 0u;
+    fat32_fsinfo_stale = 0u;
+    fat32_next_free = FAT_FIRST_CLUSTER;
+
+    if ((FSINFO_SECTOR != 0u) && (FSINFO_SECTOR != 0xFFFFu) &&
+        (FAT32_Get_Sector(fat32_volume_sector + FSINFO_SECTOR, &p_line, &p_sector) == BSP_FAT32_Result_OK) &&
+        (FAT32_Read_32(p_sector + FSINFO_LEAD_SIGNATURE) == 0x41615252u) &&
+        (FAT32_Read_32(p_sector + FSINFO_STRUCT_SIGNATURE) == 0x61417272u))
+    {
+        fat32_fsinfo_sector = fat32_volume_sector + FSINFO_SECTOR;
+
+        if (FAT32_Is_Valid_Cluster(FAT32_Read_32(p_sector + FSINFO_NEXT_FREE)))
+        {
+            fat32_next_free = FAT32_Read_32(p_sector + FSINFO_NEXT_FREE);
+        }
+    }
+
+    FAT32_Reset_Cache((fat32_sectors_per_cluster < BSP_FAT32_LINE_SECTORS) ? fat32_sectors_per_cluster : BSP_FAT32_LINE_SECTORS,
+                      fat32_data_sector);
+
+    fat32_mounted = 1u;
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Open(BSP_FAT32_File_t * p_file, const char * p_path)
+{
+    uint8_t name[11];
+    uint32_t dir_cluster;
+    uint32_t sector;
+    uint32_t offset;
+    uint32_t free_sector;
+    uint32_t free_offset;
+
+    if (!fat32_mounted)
+    {
+        return BSP_FAT32_Result_Bad_Request;
+    }
+
+    BSP_FAT32_Result_t result = FAT32_Find_Path(p_path, &dir_cluster, name, &sector, &offset, &free_sector, &free_offset);
+
+    if (result != BSP_FAT32_Result_OK)
+    {
+        return result;
+    }
+
+    return FAT32_Open_Entry(p_file, sector, offset);
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Read_Direct(BSP_FAT32_File_t * p_file, const uint8_t ** pp_data,
+                                         uint32_t max_bytes, uint32_t * p_num_bytes)
+{
+    uint32_t sector;
+    uint32_t num_sectors;
+    FAT32_Line_t * p_line;
+
+    *p_num_bytes = 0u;
+
+    if (!fat32_mounted)
+    {
+        return BSP_FAT32_Result_Bad_Request;
+    }
+
+    if ((p_file->position >= p_file->size) || (max_bytes == 0u))
+    {
+        return BSP_FAT32_Result_OK;
+    }
+
+    PSP_EMMC_Service(); // move any read-ahead along
+
+    BSP_FAT32_Result_t result = FAT32_Locate(p_file, p_file->position, &sector, &num_sectors);
+
+    if (result == BSP_FAT32_Result_Not_Found)
+    {
+        return BSP_FAT32_Result_Corrupt; // the chain is shorter than the file
+    }
+
+    const uint32_t FIRST_SECTOR = FAT32_Line_Start(sector);
+
+    if (result == BSP_FAT32_Result_OK)
+    {
+        result = FAT32_Get_Line(FIRST_SECTOR, 1u, &p_line);
+    }
+
+    if (result != BSP_FAT32_Result_OK)
+    {
+        return result;
+    }
+
+    const uint32_t OFFSET = ((sector - FIRST_SECTOR) * BSP_FAT32_SECTOR_SIZE) + (p_file->position % BSP_FAT32_SECTOR_SIZE);
+    uint32_t num_bytes = (p_line->num_sectors * BSP_FAT32_SECTOR_SIZE) - OFFSET;
+
+    if (num_bytes > (p_file->size - p_file->position))
+    {
+        num_bytes = p_file->size - p_file->position;
+    }
+
+    if (num_bytes > max_bytes)
+    {
+        num_bytes = max_bytes;
+    }
+
+    // a sequential reader just got to a new line, queue the lines after it
+    if ((p_file->position == p_file->sequential_position) && (FIRST_SECTOR != p_file->read_ahead_line))
+    {
+        const uint32_t LINE_POSITION = p_file->position - OFFSET;
+
+        p_file->read_ahead_line = FIRST_SECTOR;
+
+        for (uint32_t i = 1u; i <= BSP_FAT32_READ_AHEAD_LINES; i++)
+        {
+            const uint32_t POSITION = LINE_POSITION + (i * fat32_line_sectors * BSP_FAT32_SECTOR_SIZE);
+            uint32_t ahead_sector;
+
+            if ((POSITION >= p_file->size) ||
+                (FAT32_Locate(p_file, POSITION, &ahead_sector, &num_sectors) != BSP_FAT32_Result_OK))
+            {
+                break;
+            }
+
+            FAT32_Start_Read_Ahead(FAT32_Line_Start(ahead_sector));
+        }
+
+        // walking the chain may have used other lines since, make sure this one is still here
+        p_line = FAT32_Find_Line(FIRST_SECTOR);
+
+        if (((p_line == 0) || (p_line->state != FAT32_Line_State_Valid)) &&
+            ((result = FAT32_Get_Line(FIRST_SECTOR, 1u, &p_line)) != BSP_FAT32_Result_OK))
+        {
+            return result;
+        }
+
+        p_line->last_used = ++fat32_use_count;
+    }
+
+    *pp_data = FAT32_Line_Data(p_line) + OFFSET;
+    *p_num_bytes = num_bytes;
+    p_file->position += num_bytes;
+    p_file->sequential_position = p_file->position;
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Read(BSP_FAT32_File_t * p_file, void * p_dest, uint32_t num_bytes,
+                                  uint32_t * p_num_read)
+{
+    uint8_t * p_bytes = (uint8_t *)p_dest;
+
+    *p_num_read = 0u;
+
+    while (*p_num_read < num_bytes)
+    {
+        const uint8_t * p_data;
+        uint32_t chunk;
+
+        BSP_FAT32_Result_t result = BSP_FAT32_Read_Direct(p_file, &p_data, num_bytes - *p_num_read, &chunk);
+
+        if ((result != BSP_FAT32_Result_OK) || (chunk == 0u))
+        {
+            return result;
+        }
+
+        memcpy(p_bytes + *p_num_read, p_data, chunk);
+        *p_num_read += chunk;
+    }
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Seek(BSP_FAT32_File_t * p_file, uint32_t position)
+{
+    if (p_file->is_log || (position > p_file->size))
+    {
+        return BSP_FAT32_Result_Bad_Request;
+    }
+
+    p_file->position = position;
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Log_Open(BSP_FAT32_File_t * p_file, const char * p_path)
+{
+    uint8_t name[11];
+    uint32_t dir_cluster;
+    uint32_t sector;
+    uint32_t offset;
+    uint32_t free_sector;
+    uint32_t free_offset;
+    FAT32_Line_t * p_line;
+    uint8_t * p_entry;
+
+    if (!fat32_mounted)
+    {
+        return BSP_FAT32_Result_Bad_Request;
+    }
+
+    BSP_FAT32_Result_t result = FAT32_Find_Path(p_path, &dir_cluster, name, &sector, &offset, &free_sector, &free_offset);
+
+    if (result == BSP_FAT32_Result_OK)
+    {
+        result = FAT32_Open_Entry(p_file, sector, offset);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        p_file->position = p_file->size;
+        p_file->is_log = 1u;
+
+        return BSP_FAT32_Result_OK;
+    }
+
+    if ((result != BSP_FAT32_Result_Not_Found) || (dir_cluster == 0u))
+    {
+        return result;
+    }
+
+    if (free_sector == 0u)
+    {
+        // the directory is full, give it another cluster of free entries
+        BSP_FAT32_File_t dir;
+        uint32_t num_sectors;
+        uint32_t cluster;
+
+        dir.first_cluster = dir_cluster;
+        dir.num_extents = 0u;
+
+        result = FAT32_Locate(&dir, DIR_MAX_SIZE, &sector, &num_sectors);
+
+        if (result == BSP_FAT32_Result_Not_Found)
+        {
+            result = FAT32_Extend_Chain(&dir, &cluster);
+        }
+        else if (result == BSP_FAT32_Result_OK)
+        {
+            result = BSP_FAT32_Result_Disk_Full; // at the limit of entries per directory
+        }
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        for (uint32_t i = 0u; i < fat32_sectors_per_cluster; i += fat32_line_sectors)
+        {
+            result = FAT32_Get_Line(FAT32_Cluster_To_Sector(cluster) + i, 0u, &p_line);
+
+            if (result != BSP_FAT32_Result_OK)
+            {
+                return result;
+            }
+
+            p_line->dirty_mask = (1u << p_line->num_sectors) - 1u;
+        }
+
+        free_sector = FAT32_Cluster_To_Sector(cluster);
+        free_offset = 0u;
+    }
+
+    result = FAT32_Get_Sector(free_sector, &p_line, &p_entry);
+
+    if (result != BSP_FAT32_Result_OK)
+    {
+        return result;
+    }
+
+    p_entry += free_offset;
+
+    memset(p_entry, 0, DIR_ENTRY_SIZE);
+    memcpy(p_entry + DIR_NAME, name, 11u);
+    p_entry[DIR_ATTRIBUTES] = ATTRIBUTE_ARCHIVE;
+    FAT32_Write_16(p_entry + DIR_CREATE_DATE, DIR_DEFAULT_DATE);
+    FAT32_Write_16(p_entry + DIR_ACCESS_DATE, DIR_DEFAULT_DATE);
+    FAT32_Write_16(p_entry + DIR_WRITE_DATE, DIR_DEFAULT_DATE);
+    FAT32_Mark_Dirty(p_line, free_sector);
+
+    p_file->size = 0u;
+    p_file->position = 0u;
+    p_file->first_cluster = 0u;
+    p_file->num_extents = 0u;
+    p_file->sequential_position = 0u;
+    p_file->read_ahead_line = 0xFFFFFFFFu;
+    p_file->is_log = 1u;
+    p_file->entry_sector = free_sector;
+    p_file->entry_offset = free_offset;
+
+    // get the new entry on the card straight away
+    return FAT32_Flush_All();
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Log_Append(BSP_FAT32_File_t * p_file, const void * p_src, uint32_t num_bytes)
+{
+    const uint8_t * p_bytes = (const uint8_t *)p_src;
+
+    if (!fat32_mounted || !p_file->is_log)
+    {
+        return BSP_FAT32_Result_Bad_Request;
+    }
+
+    while (num_bytes != 0u)
+    {
+        uint32_t sector;
+        uint32_t num_sectors;
+        FAT32_Line_t * p_line;
+
+        BSP_FAT32_Result_t result = FAT32_Locate(p_file, p_file->position, &sector, &num_sectors);
+
+        if (result == BSP_FAT32_Result_Not_Found)
+        {
+            uint32_t cluster;
+
+            result = FAT32_Extend_Chain(p_file, &cluster);
+
+            if (result != BSP_FAT32_Result_OK)
+            {
+                return result;
+            }
+
+            continue;
+        }
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        const uint32_t FIRST_SECTOR = FAT32_Line_Start(sector);
+        const uint32_t OFFSET = ((sector - FIRST_SECTOR) * BSP_FAT32_SECTOR_SIZE) + (p_file->position % BSP_FAT32_SECTOR_SIZE);
+
+        // nothing in a line that starts at the end of the file is worth reading
+        result = FAT32_Get_Line(FIRST_SECTOR, (OFFSET != 0u) ? 1u : 0u, &p_line);
+
+        if (result != BSP_FAT32_Result_OK)
+        {
+            return result;
+        }
+
+        uint32_t chunk = (p_line->num_sectors * BSP_FAT32_SECTOR_SIZE) - OFFSET;
+
+        if (chunk > num_bytes)
+        {
+            chunk = num_bytes;
+        }
+
+        memcpy(FAT32_Line_Data(p_line) + OFFSET, p_bytes, chunk);
+
+        for (uint32_t i = OFFSET / BSP_FAT32_SECTOR_SIZE; i <= ((OFFSET + chunk - 1u) / BSP_FAT32_SECTOR_SIZE); i++)
+        {
+            p_line->dirty_mask |= 1u << i;
+        }
+
+        p_bytes += chunk;
+        num_bytes -= chunk;
+        p_file->position += chunk;
+        p_file->size = p_file->position;
+    }
+
+    return BSP_FAT32_Result_OK;
+}
+
+
+
+BSP_FAT32_Result_t BSP_FAT32_Log_Sync(BSP_FAT32_File_t * p_file)
+{
+    FAT32_Line_t * p_line;
+    uint8_t * p_entry;
+
+    if (!fat32_mounted || !p_file->is_log)
+    {
+        return BSP_FAT32_Result_Bad_Request;
+    }
+
+    // data and FAT first, so the entry never claims more than is on the card
+    BSP_FAT32_Result_t result = FAT32_Flush_All();
+
+    if (result == BSP_FAT32_Result_OK)
+    {
+        result = FAT32_Get_Sector(p_file->entry_sector, &p_line, &p_entry);
+    }
+
+    if (result != BSP_FAT32_Result_OK)
+    {
+        return result;
+    }
+
+    p_entry += p_file->entry_offset;
+
+    FAT32_Write_16(p_entry + DIR_CLUSTER_HIGH, p_file->first_cluster >> 16u);
+    FAT32_Write_16(p_entry + DIR_CLUSTER_LOW, p_file->first_cluster);
+    FAT32_Write_32(p_entry + DIR_FILE_SIZE, p_file->size);
+    FAT32_Mark_Dirty(p_line, p_file->entry_sector);
+
+    return FAT32_Flush_All();
+}
+
+
+
+void BSP_FAT32_Get_Cache_Stats(BSP_FAT32_Cache_Stats_t * p_stats)
+{
+    *p_stats = fat32_stats;
+}
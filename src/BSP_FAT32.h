@@ -0,0 +1,340 @@
+/**
+ * DESCRIPTION:
+ *      BSP_FAT32 reads files from a FAT32 volume on the SD card (the boot partition next to
+ *      kernel.img, or any other FAT32 partition), and appends to log files on it.
+ *
+ * NOTES:
+ *      The card is read through an LRU cache of BSP_FAT32_CACHE_LINES lines, each line is up to
+ *      BSP_FAT32_LINE_SECTORS sectors (4kB) read with one multi-block request, and never crosses
+ *      a cluster boundary. FAT sectors go through the same cache, so walking a cluster chain
+ *      reads 1024 FAT entries per miss.
+ *
+ *      A file's cluster chain is walked once when it is opened and kept as a short table of
+ *      extents (runs of adjacent clusters), so reading a file that isn't fragmented never looks
+ *      at the FAT again. Files with more than BSP_FAT32_MAX_EXTENTS fragments keep a sliding
+ *      window of extents and walk the FAT again when reading past it.
+ *
+ *      While a file is read sequentially, the next BSP_FAT32_READ_AHEAD_LINES lines of it are
+ *      queued on PSP_EMMC without waiting, so the card is busy while the caller works on the
+ *      data it already has. BSP_FAT32_Read_Direct hands out a pointer straight into the cache
+ *      instead of copying, the pointer is good until the next call into BSP_FAT32.
+ *
+ *      Writing is limited to appending to log files. Appended data sits in the cache until
+ *      BSP_FAT32_Log_Sync (or until its line is evicted), Log_Sync writes it, the FAT and the
+ *      file's directory entry. Both FAT copies are kept up to date. The FSInfo free cluster
+ *      count is marked unknown the first time a cluster is allocated, which is what the spec
+ *      asks of a driver that doesn't keep count.
+ *
+ *      Paths are '/' separated, relative to the root directory, and each part must be a
+ *      short (8.3) name, matched without regard to case. Long file names are ignored, the
+ *      short name of a file can be found with dir /x on Windows or with
+ *      tools/fat32_image.py ls.
+ *
+ *      Only one volume can be mounted at a time. PSP_EMMC_Init must be called first.
+ *
+ *      tools/fat32_image.py builds FAT32 disk images on the host for testing under QEMU (see
+ *      bench_FAT32), and reads files back out of them.
+ *
+ * REFERENCES:
+ *      Microsoft Extensible Firmware Initiative FAT32 File System Specification (fatgen103)
+ */
+
+#ifndef BSP_FAT32_H_INCLUDED
+#define BSP_FAT32_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_FAT32 Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_FAT32_SECTOR_SIZE          512u   // the only sector size supported
+#define BSP_FAT32_LINE_SECTORS         8u     // sectors per cache line, less if the clusters are smaller
+#define BSP_FAT32_CACHE_LINES          32u    // 128kB of cache
+#define BSP_FAT32_READ_AHEAD_LINES     4u     // lines queued ahead of a sequential reader, less than BSP_FAT32_CACHE_LINES
+#define BSP_FAT32_MAX_EXTENTS          8u     // extents kept per open file
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_FAT32 Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum FAT32_Result_Type
+{
+    BSP_FAT32_Result_OK = 0u,
+    BSP_FAT32_Result_Disk_Error,        // a PSP_EMMC request failed, or the card isn't initialized
+    BSP_FAT32_Result_No_Filesystem,     // no FAT32 volume on the card
+    BSP_FAT32_Result_Corrupt,           // a cluster chain points somewhere it shouldn't
+    BSP_FAT32_Result_Not_Found,         // no such file or directory
+    BSP_FAT32_Result_Disk_Full,         // no free clusters left
+    BSP_FAT32_Result_Bad_Request        // not mounted, a directory where a file is needed, or past the end of the file
+} BSP_FAT32_Result_t;
+
+
+
+typedef struct FAT32_Extent_Type
+{
+    uint32_t file_cluster;      // cluster index within the file
+    uint32_t first_cluster;     // cluster number on the volume
+    uint32_t num_clusters;      // adjacent clusters in the run
+} BSP_FAT32_Extent_t;
+
+
+
+typedef struct FAT32_File_Type
+{
+    uint32_t size;                  // bytes
+    uint32_t position;              // next byte to read, or where the next append goes
+    uint32_t first_cluster;         // 0 for an empty file
+
+    uint32_t num_extents;
+    BSP_FAT32_Extent_t extents[BSP_FAT32_MAX_EXTENTS];
+
+    uint32_t sequential_position;   // where the last read ended, reads from here get read-ahead
+    uint32_t read_ahead_line;       // the line read-ahead was last started from
+
+    uint32_t is_log;                // opened with BSP_FAT32_Log_Open
+    uint32_t entry_sector;          // where the directory entry is, for BSP_FAT32_Log_Sync
+    uint32_t entry_offset;
+} BSP_FAT32_File_t;
+
+
+
+typedef struct FAT32_Cache_Stats_Type
+{
+    uint32_t hits;                  // lines found in the cache, including read-ahead lines still on their way
+    uint32_t misses;                // lines read while the caller waited
+    uint32_t read_aheads;           // lines queued by read-ahead
+    uint32_t write_backs;           // lines written back to the card
+} BSP_FAT32_Cache_Stats_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_FAT32 Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Mount
+
+Function Description:
+    Find the first FAT32 partition on the card (or a volume without a partition table) and
+    get ready to use it. Empties the cache, unsynced log data is lost.
+
+Inputs:
+    None
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK if mounted
+
+Error Handling:
+    Returns BSP_FAT32_Result_No_Filesystem if there is no FAT32 volume with 512 byte sectors,
+    or BSP_FAT32_Result_Disk_Error if it can't be read.
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Mount(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Open
+
+Function Description:
+    Open a file for reading, at position 0.
+
+Inputs:
+    p_file: the file to fill in, owned by the caller, there is no close
+    p_path: e.g. "config.txt" or "assets/font.bin"
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK if opened
+
+Error Handling:
+    Returns BSP_FAT32_Result_Not_Found if any part of the path doesn't exist, and
+    BSP_FAT32_Result_Bad_Request if the path is a directory or nothing is mounted.
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Open(BSP_FAT32_File_t * p_file, const char * p_path);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Read_Direct
+
+Function Description:
+    Read from the current position without copying: get a pointer into the cache and the
+    number of bytes there, then move the position past them. Reads stop at the end of a cache
+    line, so a large read takes a few calls.
+
+Inputs:
+    p_file: an open file
+    pp_data: where to put the pointer, which is good until the next call into BSP_FAT32
+    max_bytes: the most bytes wanted
+    p_num_bytes: where to put the number of bytes at *pp_data, 0 at the end of the file
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK on success, including at the end of the file
+
+Error Handling:
+    *p_num_bytes is 0 and the position doesn't move on error.
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Read_Direct(BSP_FAT32_File_t * p_file, const uint8_t ** pp_data,
+                                         uint32_t max_bytes, uint32_t * p_num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Read
+
+Function Description:
+    Copy bytes from the current position into a buffer, and move the position past them.
+
+Inputs:
+    p_file: an open file
+    p_dest: where to put the bytes
+    num_bytes: the number of bytes wanted
+    p_num_read: where to put the number of bytes read, less than num_bytes at the end of the file
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK on success, including at the end of the file
+
+Error Handling:
+    *p_num_read has the bytes read before the error.
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Read(BSP_FAT32_File_t * p_file, void * p_dest, uint32_t num_bytes,
+                                  uint32_t * p_num_read);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Seek
+
+Function Description:
+    Move the position of a file opened for reading.
+
+Inputs:
+    p_file: an open file
+    position: the byte to read next, up to the size of the file
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK on success
+
+Error Handling:
+    Returns BSP_FAT32_Result_Bad_Request and leaves the position alone if position is past the
+    end of the file or the file is a log.
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Seek(BSP_FAT32_File_t * p_file, uint32_t position);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Log_Open
+
+Function Description:
+    Open a file for appending, creating it if it doesn't exist. The directory it goes in must
+    exist. The position is the end of the file.
+
+Inputs:
+    p_file: the file to fill in, owned by the caller
+    p_path: e.g. "boot.log" or "logs/sensor.log"
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK if opened
+
+Error Handling:
+    Same as BSP_FAT32_Open, plus BSP_FAT32_Result_Disk_Full if the directory needs another
+    cluster for the new entry and there isn't one.
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Log_Open(BSP_FAT32_File_t * p_file, const char * p_path);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Log_Append
+
+Function Description:
+    Add bytes to the end of a log file. They are in the cache, not on the card, until
+    BSP_FAT32_Log_Sync.
+
+Inputs:
+    p_file: a file opened with BSP_FAT32_Log_Open
+    p_src: the bytes to add
+    num_bytes: how many
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK on success
+
+Error Handling:
+    Returns BSP_FAT32_Result_Bad_Request if the file isn't a log, BSP_FAT32_Result_Disk_Full
+    if the volume fills up part way through (the bytes that fit are kept).
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Log_Append(BSP_FAT32_File_t * p_file, const void * p_src, uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Log_Sync
+
+Function Description:
+    Write everything appended so far to the card: the data, the FAT and the file's size in
+    its directory entry.
+
+Inputs:
+    p_file: a file opened with BSP_FAT32_Log_Open
+
+Returns:
+    BSP_FAT32_Result_t: BSP_FAT32_Result_OK once it is all on the card
+
+Error Handling:
+    Returns BSP_FAT32_Result_Bad_Request if the file isn't a log, BSP_FAT32_Result_Disk_Error if
+    a write fails.
+
+-------------------------------------------------------------------------------------------------*/
+BSP_FAT32_Result_t BSP_FAT32_Log_Sync(BSP_FAT32_File_t * p_file);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FAT32_Get_Cache_Stats
+
+Function Description:
+    Get the cache counters, which count from BSP_FAT32_Mount.
+
+Inputs:
+    p_stats: where to put them
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_FAT32_Get_Cache_Stats(BSP_FAT32_Cache_Stats_t * p_stats);
+
+#endif
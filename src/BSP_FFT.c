@@ -0,0 +1,800 @@
+#include "BSP_FFT.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_FFT Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define FFT_LANES                   4u              // floats or int16_ts per vector, 2 complex points
+
+#define FFT_PI                      3.14159265358979323846
+#define FFT_TAYLOR_TERMS            7u              // plenty for double precision over +-pi/4
+
+#define FFT_Q15_ONE                 32768.0
+#define FFT_Q15_ROUND               0x00004000      // half of the last bit kept, for round to nearest
+
+#define FFT_ODD_POWERS_OF_2         0xAAAAAAAAu     // 2^1, 2^3, ... need a radix-2 pass
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_FFT Types
+ -------------------------------------------------------------------------------------------------*/
+
+// 2 complex points, {re, im, re, im}, only aligned to the sample size like BSP_DSP's
+typedef float FFT_Float_Lanes_t __attribute__((vector_size(16), aligned(4)));
+typedef int16_t FFT_Int16_Lanes_t __attribute__((vector_size(8), aligned(2)));
+typedef int32_t FFT_Int32_Lanes_t __attribute__((vector_size(16), aligned(4)));
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_FFT Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * The cosine and sine of 2 pi k / n, for 0 <= k < n: the nearest multiple of pi / 2 is taken
+ * out, which leaves at most pi / 4 for a short Taylor series.
+ */
+static void FFT_Cos_Sin(uint32_t k, uint32_t n, double * p_cos, double * p_sin)
+{
+    const uint32_t QUADRANT = ((4u * k) + (n / 2u)) / n;
+    const double ANGLE = (FFT_PI / 2.0) * (double)((int32_t)(4u * k) - (int32_t)(QUADRANT * n)) / (double)n;
+    const double SQUARED = ANGLE * ANGLE;
+    double sin_series = 1.0;
+    double cos_series = 1.0;
+
+    for (uint32_t term = FFT_TAYLOR_TERMS; term > 0u; term--)
+    {
+        sin_series = 1.0 - ((SQUARED / (double)((2u * term) * ((2u * term) + 1u))) * sin_series);
+        cos_series = 1.0 - ((SQUARED / (double)(((2u * term) - 1u) * (2u * term))) * cos_series);
+    }
+
+    const double SIN = ANGLE * sin_series;
+    const double COS = cos_series;
+
+    switch (QUADRANT & 0x3u)
+    {
+        case 0u:
+            *p_cos = COS;
+            *p_sin = SIN;
+            break;
+
+        case 1u:
+            *p_cos = -SIN;
+            *p_sin = COS;
+            break;
+
+        case 2u:
+            *p_cos = -COS;
+            *p_sin = -SIN;
+            break;
+
+        default:
+            *p_cos = SIN;
+            *p_sin = -COS;
+            break;
+    }
+}
+
+
+
+/**
+ * A value from -1.0 to 1.0 in Q15, rounded, with 1.0 taken as the largest Q15 value.
+ */
+static int16_t FFT_To_Q15(double value)
+{
+    const double SCALED = value * FFT_Q15_ONE;
+    const int32_t ROUNDED = (int32_t)((SCALED < 0.0) ? (SCALED - 0.5) : (SCALED + 0.5));
+
+    if (ROUNDED > 32767)
+    {
+        return 32767;
+    }
+
+    return (int16_t)((ROUNDED < -32767) ? -32767 : ROUNDED);
+}
+
+
+
+static inline int16_t FFT_Saturate_Q15(int32_t value)
+{
+    if (value > 32767)
+    {
+        return 32767;
+    }
+
+    if (value < -32768)
+    {
+        return -32768;
+    }
+
+    return (int16_t)value;
+}
+
+
+
+/**
+ * Window coefficient n of num_points, a0 - a1 cos(2 pi n / N) + a2 cos(4 pi n / N).
+ */
+static double FFT_Window_Coefficient(uint32_t n, uint32_t num_points, BSP_FFT_Window_t window)
+{
+    double cos_1;
+    double cos_2;
+    double unused_sin;
+
+    FFT_Cos_Sin(n, num_points, &cos_1, &unused_sin);
+    FFT_Cos_Sin((2u * n) % num_points, num_points, &cos_2, &unused_sin);
+
+    switch (window)
+    {
+        case BSP_FFT_Window_Hamming:
+            return 0.54 - (0.46 * cos_1);
+
+        case BSP_FFT_Window_Blackman:
+            return 0.42 - (0.5 * cos_1) + (0.08 * cos_2);
+
+        default:
+            return 0.5 - (0.5 * cos_1);
+    }
+}
+
+
+
+static uint32_t FFT_Is_Supported(uint32_t num_points)
+{
+    return (num_points >= BSP_FFT_MIN_POINTS) && (num_points <= BSP_FFT_MAX_POINTS) && !(num_points & (num_points - 1u));
+}
+
+
+
+/**
+ * Swap each complex point with the one at its bit reversed index.
+ */
+static void FFT_F32_Bit_Reverse(float * p_data, uint32_t num_points)
+{
+    uint32_t reversed = 0u;
+
+    for (uint32_t i = 0u; i < num_points; i++)
+    {
+        if (i < reversed)
+        {
+            const float RE = p_data[2u * i];
+            const float IM = p_data[(2u * i) + 1u];
+
+            p_data[2u * i] = p_data[2u * reversed];
+            p_data[(2u * i) + 1u] = p_data[(2u * reversed) + 1u];
+            p_data[2u * reversed] = RE;
+            p_data[(2u * reversed) + 1u] = IM;
+        }
+
+        // add 1 to reversed, from the top bit down
+        uint32_t bit = num_points >> 1;
+
+        while (reversed & bit)
+        {
+            reversed ^= bit;
+            bit >>= 1;
+        }
+
+        reversed |= bit;
+    }
+}
+
+
+
+static void FFT_Q15_Bit_Reverse(int16_t * p_data, uint32_t num_points)
+{
+    uint32_t reversed = 0u;
+
+    for (uint32_t i = 0u; i < num_points; i++)
+    {
+        if (i < reversed)
+        {
+            const int16_t RE = p_data[2u * i];
+            const int16_t IM = p_data[(2u * i) + 1u];
+
+            p_data[2u * i] = p_data[2u * reversed];
+            p_data[(2u * i) + 1u] = p_data[(2u * reversed) + 1u];
+            p_data[2u * reversed] = RE;
+            p_data[(2u * reversed) + 1u] = IM;
+        }
+
+        uint32_t bit = num_points >> 1;
+
+        while (reversed & bit)
+        {
+            reversed ^= bit;
+            bit >>= 1;
+        }
+
+        reversed |= bit;
+    }
+}
+
+
+
+/**
+ * {im, re, im, re} from {re, im, re, im}.
+ */
+static inline FFT_Float_Lanes_t FFT_F32_Swap(FFT_Float_Lanes_t points)
+{
+    return __builtin_shuffle(points, (FFT_Int32_Lanes_t){ 1, 0, 3, 2 });
+}
+
+
+
+static inline FFT_Int32_Lanes_t FFT_Q15_Swap(FFT_Int32_Lanes_t points)
+{
+    return __builtin_shuffle(points, (FFT_Int32_Lanes_t){ 1, 0, 3, 2 });
+}
+
+
+
+/**
+ * Twiddles index and index + step as {wr, wr, wr', wr'} and {-wi, wi, -wi', wi'}, so that
+ * a complex multiply is points * re + swapped points * im.
+ */
+static inline void FFT_F32_Twiddle_Lanes(const float * p_twiddles, uint32_t index, uint32_t step, FFT_Float_Lanes_t * p_re, FFT_Float_Lanes_t * p_im)
+{
+    const float * const P_FIRST = &p_twiddles[2u * index];
+    const float * const P_SECOND = &p_twiddles[2u * (index + step)];
+
+    *p_re = (FFT_Float_Lanes_t){ P_FIRST[0], P_FIRST[0], P_SECOND[0], P_SECOND[0] };
+    *p_im = (FFT_Float_Lanes_t){ -P_FIRST[1], P_FIRST[1], -P_SECOND[1], P_SECOND[1] };
+}
+
+
+
+static inline void FFT_Q15_Twiddle_Lanes(const int16_t * p_twiddles, uint32_t index, uint32_t step, FFT_Int32_Lanes_t * p_re, FFT_Int32_Lanes_t * p_im)
+{
+    const int16_t * const P_FIRST = &p_twiddles[2u * index];
+    const int16_t * const P_SECOND = &p_twiddles[2u * (index + step)];
+
+    *p_re = (FFT_Int32_Lanes_t){ P_FIRST[0], P_FIRST[0], P_SECOND[0], P_SECOND[0] };
+    *p_im = (FFT_Int32_Lanes_t){ -P_FIRST[1], P_FIRST[1], -P_SECOND[1], P_SECOND[1] };
+}
+
+
+
+static inline FFT_Float_Lanes_t FFT_F32_Multiply(FFT_Float_Lanes_t points, FFT_Float_Lanes_t re, FFT_Float_Lanes_t im)
+{
+    return (points * re) + (FFT_F32_Swap(points) * im);
+}
+
+
+
+/**
+ * Q15 points times Q15 twiddles, rounded back to Q15. With the points inside the unit circle
+ * neither sum of products can reach 2^31.
+ */
+static inline FFT_Int32_Lanes_t FFT_Q15_Multiply(FFT_Int32_Lanes_t points, FFT_Int32_Lanes_t re, FFT_Int32_Lanes_t im)
+{
+    return ((points * re) + (FFT_Q15_Swap(points) * im) + FFT_Q15_ROUND) >> 15;
+}
+
+
+
+static inline FFT_Int32_Lanes_t FFT_Q15_Load(const int16_t * p_points)
+{
+    return __builtin_convertvector(*(const FFT_Int16_Lanes_t *)p_points, FFT_Int32_Lanes_t);
+}
+
+
+
+/**
+ * Store 2 points, divided by 4 with rounding, and saturated.
+ */
+static inline void FFT_Q15_Store_Quarter(int16_t * p_points, FFT_Int32_Lanes_t points)
+{
+    const FFT_Int32_Lanes_t MAX = { 32767, 32767, 32767, 32767 };
+    const FFT_Int32_Lanes_t MIN = { -32768, -32768, -32768, -32768 };
+
+    points = (points + 2) >> 2;
+
+    // the compares give all 1s where true
+    const FFT_Int32_Lanes_t ABOVE = points > MAX;
+    const FFT_Int32_Lanes_t BELOW = points < MIN;
+
+    points = (points & ~(ABOVE | BELOW)) | (MAX & ABOVE) | (MIN & BELOW);
+
+    *(FFT_Int16_Lanes_t *)p_points = __builtin_convertvector(points, FFT_Int16_Lanes_t);
+}
+
+
+
+/**
+ * The first pass, 2 or 4 points at a time, none of which need twiddles.
+ */
+static void FFT_F32_First_Pass(float * p_data, uint32_t num_points)
+{
+    if (num_points & FFT_ODD_POWERS_OF_2)
+    {
+        for (uint32_t i = 0u; i < (2u * num_points); i += 4u)
+        {
+            const float A_RE = p_data[i];
+            const float A_IM = p_data[i + 1u];
+            const float B_RE = p_data[i + 2u];
+            const float B_IM = p_data[i + 3u];
+
+            p_data[i] = A_RE + B_RE;
+            p_data[i + 1u] = A_IM + B_IM;
+            p_data[i + 2u] = A_RE - B_RE;
+            p_data[i + 3u] = A_IM - B_IM;
+        }
+
+        return;
+    }
+
+    for (uint32_t i = 0u; i < (2u * num_points); i += 8u)
+    {
+        const float T0_RE = p_data[i] + p_data[i + 2u];
+        const float T0_IM = p_data[i + 1u] + p_data[i + 3u];
+        const float T1_RE = p_data[i] - p_data[i + 2u];
+        const float T1_IM = p_data[i + 1u] - p_data[i + 3u];
+        const float T2_RE = p_data[i + 4u] + p_data[i + 6u];
+        const float T2_IM = p_data[i + 5u] + p_data[i + 7u];
+        const float T3_RE = p_data[i + 4u] - p_data[i + 6u];
+        const float T3_IM = p_data[i + 5u] - p_data[i + 7u];
+
+        // T1 -/+ i * T3
+        p_data[i] = T0_RE + T2_RE;
+        p_data[i + 1u] = T0_IM + T2_IM;
+        p_data[i + 2u] = T1_RE + T3_IM;
+        p_data[i + 3u] = T1_IM - T3_RE;
+        p_data[i + 4u] = T0_RE - T2_RE;
+        p_data[i + 5u] = T0_IM - T2_IM;
+        p_data[i + 6u] = T1_RE - T3_IM;
+        p_data[i + 7u] = T1_IM + T3_RE;
+    }
+}
+
+
+
+/**
+ * As FFT_F32_First_Pass, dividing by 2 (radix-2) or 4 (radix-4) and then by 2^extra_shift.
+ */
+static void FFT_Q15_First_Pass(int16_t * p_data, uint32_t num_points, uint32_t extra_shift)
+{
+    if (num_points & FFT_ODD_POWERS_OF_2)
+    {
+        const uint32_t SHIFT = 1u + extra_shift;
+        const int32_t ROUND = 1 << (SHIFT - 1u);
+
+        for (uint32_t i = 0u; i < (2u * num_points); i += 4u)
+        {
+            const int32_t A_RE = p_data[i];
+            const int32_t A_IM = p_data[i + 1u];
+            const int32_t B_RE = p_data[i + 2u];
+            const int32_t B_IM = p_data[i + 3u];
+
+            p_data[i] = FFT_Saturate_Q15((A_RE + B_RE + ROUND) >> SHIFT);
+            p_data[i + 1u] = FFT_Saturate_Q15((A_IM + B_IM + ROUND) >> SHIFT);
+            p_data[i + 2u] = FFT_Saturate_Q15((A_RE - B_RE + ROUND) >> SHIFT);
+            p_data[i + 3u] = FFT_Saturate_Q15((A_IM - B_IM + ROUND) >> SHIFT);
+        }
+
+        return;
+    }
+
+    const uint32_t SHIFT = 2u + extra_shift;
+    const int32_t ROUND = 1 << (SHIFT - 1u);
+
+    for (uint32_t i = 0u; i < (2u * num_points); i += 8u)
+    {
+        const int32_t T0_RE = (int32_t)p_data[i] + p_data[i + 2u];
+        const int32_t T0_IM = (int32_t)p_data[i + 1u] + p_data[i + 3u];
+        const int32_t T1_RE = (int32_t)p_data[i] - p_data[i + 2u];
+        const int32_t T1_IM = (int32_t)p_data[i + 1u] - p_data[i + 3u];
+        const int32_t T2_RE = (int32_t)p_data[i + 4u] + p_data[i + 6u];
+        const int32_t T2_IM = (int32_t)p_data[i + 5u] + p_data[i + 7u];
+        const int32_t T3_RE = (int32_t)p_data[i + 4u] - p_data[i + 6u];
+        const int32_t T3_IM = (int32_t)p_data[i + 5u] - p_data[i + 7u];
+
+        p_data[i] = FFT_Saturate_Q15((T0_RE + T2_RE + ROUND) >> SHIFT);
+        p_data[i + 1u] = FFT_Saturate_Q15((T0_IM + T2_IM + ROUND) >> SHIFT);
+        p_data[i + 2u] = FFT_Saturate_Q15((T1_RE + T3_IM + ROUND) >> SHIFT);
+        p_data[i + 3u] = FFT_Saturate_Q15((T1_IM - T3_RE + ROUND) >> SHIFT);
+        p_data[i + 4u] = FFT_Saturate_Q15((T0_RE - T2_RE + ROUND) >> SHIFT);
+        p_data[i + 5u] = FFT_Saturate_Q15((T0_IM - T2_IM + ROUND) >> SHIFT);
+        p_data[i + 6u] = FFT_Saturate_Q15((T1_RE - T3_IM + ROUND) >> SHIFT);
+        p_data[i + 7u] = FFT_Saturate_Q15((T1_IM + T3_RE + ROUND) >> SHIFT);
+    }
+}
+
+
+
+/**
+ * One radix-4 pass over groups of 4 * quarter points, quarter at least 2. Point j of each
+ * quarter (a, b, c, d) becomes, with W = e^(-2 pi i j / (4 * quarter)):
+ *      t0 = a + W^2j b,    t1 = a - W^2j b,    t2 = W^j c + W^3j d,    t3 = W^j c - W^3j d
+ *      a = t0 + t2,        b = t1 - i t3,      c = t0 - t2,            d = t1 + i t3
+ * which is two radix-2 passes at once on bit reversed input. j is the outer loop so each
+ * twiddle is loaded once per pass.
+ */
+static void FFT_F32_Radix_4_Pass(float * p_data, uint32_t num_points, uint32_t quarter, const float * p_twiddles, uint32_t step)
+{
+    const FFT_Float_Lanes_t MINUS_I = { 1.0f, -1.0f, 1.0f, -1.0f }; // times swapped points
+    const uint32_t QUARTER = 2u * quarter;                            // in floats
+
+    for (uint32_t j = 0u; j < quarter; j += 2u)
+    {
+        FFT_Float_Lanes_t w1_re, w1_im, w2_re, w2_im, w3_re, w3_im;
+
+        FFT_F32_Twiddle_Lanes(p_twiddles, j * step, step, &w1_re, &w1_im);
+        FFT_F32_Twiddle_Lanes(p_twiddles, 2u * j * step, 2u * step, &w2_re, &w2_im);
+        FFT_F32_Twiddle_Lanes(p_twiddles, 3u * j * step, 3u * step, &w3_re, &w3_im);
+
+        for (uint32_t group = 0u; group < num_points; group += 4u * quarter)
+        {
+            float * const P_A = &p_data[2u * (group + j)];
+            FFT_Float_Lanes_t * const P_B = (FFT_Float_Lanes_t *)(P_A + QUARTER);
+            FFT_Float_Lanes_t * const P_C = (FFT_Float_Lanes_t *)(P_A + (2u * QUARTER));
+            FFT_Float_Lanes_t * const P_D = (FFT_Float_Lanes_t *)(P_A + (3u * QUARTER));
+
+            const FFT_Float_Lanes_t A = *(FFT_Float_Lanes_t *)P_A;
+            const FFT_Float_Lanes_t B = FFT_F32_Multiply(*P_B, w2_re, w2_im);
+            const FFT_Float_Lanes_t C = FFT_F32_Multiply(*P_C, w1_re, w1_im);
+            const FFT_Float_Lanes_t D = FFT_F32_Multiply(*P_D, w3_re, w3_im);
+
+            const FFT_Float_Lanes_t T0 = A + B;
+            const FFT_Float_Lanes_t T1 = A - B;
+            const FFT_Float_Lanes_t T2 = C + D;
+            const FFT_Float_Lanes_t T3 = FFT_F32_Swap(C - D) * MINUS_I; // -i t3
+
+            *(FFT_Float_Lanes_t *)P_A = T0 + T2;
+            *P_B = T1 + T3;
+            *P_C = T0 - T2;
+            *P_D = T1 - T3;
+        }
+    }
+}
+
+
+
+/**
+ * As FFT_F32_Radix_4_Pass, dividing by 4.
+ */
+static void FFT_Q15_Radix_4_Pass(int16_t * p_data, uint32_t num_points, uint32_t quarter, const int16_t * p_twiddles, uint32_t step)
+{
+    const FFT_Int32_Lanes_t MINUS_I = { 1, -1, 1, -1 };
+    const uint32_t QUARTER = 2u * quarter;
+
+    for (uint32_t j = 0u; j < quarter; j += 2u)
+    {
+        FFT_Int32_Lanes_t w1_re, w1_im, w2_re, w2_im, w3_re, w3_im;
+
+        FFT_Q15_Twiddle_Lanes(p_twiddles, j * step, step, &w1_re, &w1_im);
+        FFT_Q15_Twiddle_Lanes(p_twiddles, 2u * j * step, 2u * step, &w2_re, &w2_im);
+        FFT_Q15_Twiddle_Lanes(p_twiddles, 3u * j * step, 3u * step, &w3_re, &w3_im);
+
+        for (uint32_t group = 0u; group < num_points; group += 4u * quarter)
+        {
+            int16_t * const P_A = &p_data[2u * (group + j)];
+            int16_t * const P_B = P_A + QUARTER;
+            int16_t * const P_C = P_A + (2u * QUARTER);
+            int16_t * const P_D = P_A + (3u * QUARTER);
+
+            const FFT_Int32_Lanes_t A = FFT_Q15_Load(P_A);
+            const FFT_Int32_Lanes_t B = FFT_Q15_Multiply(FFT_Q15_Load(P_B), w2_re, w2_im);
+            const FFT_Int32_Lanes_t C = FFT_Q15_Multiply(FFT_Q15_Load(P_C), w1_re, w1_im);
+            const FFT_Int32_Lanes_t D = FFT_Q15_Multiply(FFT_Q15_Load(P_D), w3_re, w3_im);
+
+            const FFT_Int32_Lanes_t T0 = A + B;
+            const FFT_Int32_Lanes_t T1 = A - B;
+            const FFT_Int32_Lanes_t T2 = C + D;
+            const FFT_Int32_Lanes_t T3 = FFT_Q15_Swap(C - D) * MINUS_I;
+
+            FFT_Q15_Store_Quarter(P_A, T0 + T2);
+            FFT_Q15_Store_Quarter(P_B, T1 + T3);
+            FFT_Q15_Store_Quarter(P_C, T0 - T2);
+            FFT_Q15_Store_Quarter(P_D, T1 - T3);
+        }
+    }
+}
+
+
+
+/**
+ * A complex transform of num_points points in place, with twiddles from a table for
+ * num_points * stride points.
+ */
+static void FFT_F32_Transform(float * p_data, uint32_t num_points, const float * p_twiddles, uint32_t stride)
+{
+    FFT_F32_Bit_Reverse(p_data, num_points);
+    FFT_F32_First_Pass(p_data, num_points);
+
+    for (uint32_t quarter = (num_points & FFT_ODD_POWERS_OF_2) ? 2u : 4u; quarter < num_points; quarter *= 4u)
+    {
+        FFT_F32_Radix_4_Pass(p_data, num_points, quarter, p_twiddles, (num_points * stride) / (4u * quarter));
+    }
+}
+
+
+
+static void FFT_Q15_Transform(int16_t * p_data, uint32_t num_points, const int16_t * p_twiddles, uint32_t stride, uint32_t extra_shift)
+{
+    FFT_Q15_Bit_Reverse(p_data, num_points);
+    FFT_Q15_First_Pass(p_data, num_points, extra_shift);
+
+    for (uint32_t quarter = (num_points & FFT_ODD_POWERS_OF_2) ? 2u : 4u; quarter < num_points; quarter *= 4u)
+    {
+        FFT_Q15_Radix_4_Pass(p_data, num_points, quarter, p_twiddles, (num_points * stride) / (4u * quarter));
+    }
+}
+
+
+
+uint32_t BSP_FFT_F32_Init(BSP_FFT_F32_t * p_fft, uint32_t num_points, float * p_twiddles)
+{
+    if (!FFT_Is_Supported(num_points))
+    {
+        return 0u;
+    }
+
+    for (uint32_t k = 0u; k < (BSP_FFT_TWIDDLE_SIZE(num_points) / 2u); k++)
+    {
+        double cos_k;
+        double sin_k;
+
+        FFT_Cos_Sin(k, num_points, &cos_k, &sin_k);
+
+        p_twiddles[2u * k] = (float)cos_k;
+        p_twiddles[(2u * k) + 1u] = (float)-sin_k;
+    }
+
+    p_fft->p_twiddles = p_twiddles;
+    p_fft->num_points = num_points;
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_FFT_Q15_Init(BSP_FFT_Q15_t * p_fft, uint32_t num_points, int16_t * p_twiddles)
+{
+    if (!FFT_Is_Supported(num_points))
+    {
+        return 0u;
+    }
+
+    for (uint32_t k = 0u; k < (BSP_FFT_TWIDDLE_SIZE(num_points) / 2u); k++)
+    {
+        double cos_k;
+        double sin_k;
+
+        FFT_Cos_Sin(k, num_points, &cos_k, &sin_k);
+
+        p_twiddles[2u * k] = FFT_To_Q15(cos_k);
+        p_twiddles[(2u * k) + 1u] = FFT_To_Q15(-sin_k);
+    }
+
+    p_fft->p_twiddles = p_twiddles;
+    p_fft->num_points = num_points;
+
+    return 1u;
+}
+
+
+
+void BSP_FFT_F32_Complex(const BSP_FFT_F32_t * p_fft, float * p_data)
+{
+    FFT_F32_Transform(p_data, p_fft->num_points, p_fft->p_twiddles, 1u);
+}
+
+
+
+void BSP_FFT_Q15_Complex(const BSP_FFT_Q15_t * p_fft, int16_t * p_data)
+{
+    FFT_Q15_Transform(p_data, p_fft->num_points, p_fft->p_twiddles, 1u, 0u);
+}
+
+
+
+/**
+ * The real transform splits Z, the half size transform of z[n] = x[2n] + i x[2n+1], into X:
+ * with A = Z[k] and B = conj(Z[N/2 - k]),
+ *      E = (A + B) / 2,    O = -i (A - B) / 2,     X[k] = E + W^k O,   X[N/2 - k] = conj(E - W^k O)
+ * and X[0] and X[N/2] are the sum and difference of Z[0]'s real and imaginary parts.
+ */
+void BSP_FFT_F32_Real(const BSP_FFT_F32_t * p_fft, float * p_data)
+{
+    const uint32_t HALF = p_fft->num_points / 2u;
+    const float * const P_TWIDDLES = p_fft->p_twiddles;
+
+    FFT_F32_Transform(p_data, HALF, P_TWIDDLES, 2u);
+
+    const float DC = p_data[0];
+
+    p_data[0] = DC + p_data[1];
+    p_data[1] = DC - p_data[1];
+
+    for (uint32_t k = 1u; k <= (HALF / 2u); k++)
+    {
+        float * const P_K = &p_data[2u * k];
+        float * const P_MIRROR = &p_data[2u * (HALF - k)];
+
+        const float E_RE = 0.5f * (P_K[0] + P_MIRROR[0]);
+        const float E_IM = 0.5f * (P_K[1] - P_MIRROR[1]);
+        const float O_RE = 0.5f * (P_K[1] + P_MIRROR[1]);
+        const float O_IM = -0.5f * (P_K[0] - P_MIRROR[0]);
+
+        const float W_RE = P_TWIDDLES[2u * k];
+        const float W_IM = P_TWIDDLES[(2u * k) + 1u];
+        const float WO_RE = (W_RE * O_RE) - (W_IM * O_IM);
+        const float WO_IM = (W_RE * O_IM) + (W_IM * O_RE);
+
+        P_K[0] = E_RE + WO_RE;
+        P_K[1] = E_IM + WO_IM;
+        P_MIRROR[0] = E_RE - WO_RE;
+        P_MIRROR[1] = WO_IM - E_IM;
+    }
+}
+
+
+
+/**
+ * As BSP_FFT_F32_Real. The half size transform is scaled by 1 / num_points, so that z (up to
+ * sqrt(2) from 0) stays inside the unit circle, and the split then needs no more scaling
+ * than its halves.
+ */
+void BSP_FFT_Q15_Real(const BSP_FFT_Q15_t * p_fft, int16_t * p_data)
+{
+    const uint32_t HALF = p_fft->num_points / 2u;
+    const int16_t * const P_TWIDDLES = p_fft->p_twiddles;
+
+    FFT_Q15_Transform(p_data, HALF, P_TWIDDLES, 2u, 1u);
+
+    const int32_t DC = p_data[0];
+
+    p_data[0] = FFT_Saturate_Q15(DC + p_data[1]);
+    p_data[1] = FFT_Saturate_Q15(DC - p_data[1]);
+
+    for (uint32_t k = 1u; k <= (HALF / 2u); k++)
+    {
+        int16_t * const P_K = &p_data[2u * k];
+        int16_t * const P_MIRROR = &p_data[2u * (HALF - k)];
+
+        // twice E and O, halved with the rounding at the end
+        const int32_t E_RE = (int32_t)P_K[0] + P_MIRROR[0];
+        const int32_t E_IM = (int32_t)P_K[1] - P_MIRROR[1];
+        const int32_t O_RE = (int32_t)P_K[1] + P_MIRROR[1];
+        const int32_t O_IM = (int32_t)P_MIRROR[0] - P_K[0];
+
+        const int32_t W_RE = P_TWIDDLES[2u * k];
+        const int32_t W_IM = P_TWIDDLES[(2u * k) + 1u];
+        const int32_t WO_RE = ((W_RE * O_RE) - (W_IM * O_IM) + FFT_Q15_ROUND) >> 15;
+        const int32_t WO_IM = ((W_RE * O_IM) + (W_IM * O_RE) + FFT_Q15_ROUND) >> 15;
+
+        P_K[0] = FFT_Saturate_Q15((E_RE + WO_RE + 1) >> 1);
+        P_K[1] = FFT_Saturate_Q15((E_IM + WO_IM + 1) >> 1);
+        P_MIRROR[0] = FFT_Saturate_Q15((E_RE - WO_RE + 1) >> 1);
+        P_MIRROR[1] = FFT_Saturate_Q15((WO_IM - E_IM + 1) >> 1);
+    }
+}
+
+
+
+void BSP_FFT_F32_Power_Spectrum(const float * p_spectrum, float * p_power, uint32_t num_points)
+{
+    const uint32_t HALF = num_points / 2u;
+
+    p_power[0] = p_spectrum[0] * p_spectrum[0];
+    p_power[HALF] = p_spectrum[1] * p_spectrum[1];
+
+    for (uint32_t k = 1u; k < HALF; k++)
+    {
+        p_power[k] = (p_spectrum[2u * k] * p_spectrum[2u * k]) + (p_spectrum[(2u * k) + 1u] * p_spectrum[(2u * k) + 1u]);
+    }
+}
+
+
+
+void BSP_FFT_Q15_Power_Spectrum(const int16_t * p_spectrum, uint32_t * p_power, uint32_t num_points)
+{
+    const uint32_t HALF = num_points / 2u;
+
+    p_power[0] = (uint32_t)((int32_t)p_spectrum[0] * p_spectrum[0]);
+    p_power[HALF] = (uint32_t)((int32_t)p_spectrum[1] * p_spectrum[1]);
+
+    // each square is at most 2^30, so the sum fits unsigned
+    for (uint32_t k = 1u; k < HALF; k++)
+    {
+        const int32_t RE = p_spectrum[2u * k];
+        const int32_t IM = p_spectrum[(2u * k) + 1u];
+
+        p_power[k] = (uint32_t)(RE * RE) + (uint32_t)(IM * IM);
+    }
+}
+
+
+
+void BSP_FFT_F32_Make_Window(float * p_window, uint32_t num_points, BSP_FFT_Window_t window)
+{
+    for (uint32_t n = 0u; n < num_points; n++)
+    {
+        p_window[n] = (float)FFT_Window_Coefficient(n, num_points, window);
+    }
+}
+
+
+
+void BSP_FFT_Q15_Make_Window(int16_t * p_window, uint32_t num_points, BSP_FFT_Window_t window)
+{
+    for (uint32_t n = 0u; n < num_points; n++)
+    {
+        p_window[n] = FFT_To_Q15(FFT_Window_Coefficient(n, num_points, window));
+    }
+}
+
+
+
+void BSP_FFT_F32_Apply_Window(float * p_samples, const float * p_window, uint32_t num_points)
+{
+    uint32_t n = 0u;
+
+    for (; (n + FFT_LANES) <= num_points; n += FFT_LANES)
+    {
+        *(FFT_Float_Lanes_t *)&p_samples[n] *= *(const FFT_Float_Lanes_t *)&p_window[n];
+    }
+
+    for (; n < num_points; n++)
+    {
+        p_samples[n] *= p_window[n];
+    }
+}
+
+
+
+void BSP_FFT_Q15_Apply_Window(int16_t * p_samples, const int16_t * p_window, uint32_t num_points)
+{
+    uint32_t n = 0u;
+
+    // the window is at most 32767, so nothing can round up past the Q15 range
+    for (; (n + FFT_LANES) <= num_points; n += FFT_LANES)
+    {
+        const FFT_Int32_Lanes_t PRODUCTS = FFT_Q15_Load(&p_samples[n]) * FFT_Q15_Load(&p_window[n]);
+
+        *(FFT_Int16_Lanes_t *)&p_samples[n] = __builtin_convertvector((PRODUCTS + FFT_Q15_ROUND) >> 15, FFT_Int16_Lanes_t);
+    }
+
+    for (; n < num_points; n++)
+    {
+        p_samples[n] = (int16_t)((((int32_t)p_samples[n] * p_window[n]) + FFT_Q15_ROUND) >> 15);
+    }
+}
+
+
+
+void BSP_FFT_Reference_DFT_F32(const BSP_FFT_F32_t * p_fft, const float * p_in, float * p_out)
+{
+    const uint32_t N = p_fft->num_points;
+
+    for (uint32_t k = 0u; k < N; k++)
+    {
+        double sum_re = 0.0;
+        double sum_im = 0.0;
+
+        for (uint32_t n = 0u; n < N; n++)
+        {
+            // W^(k n), folded into the table with W^(i + N/2) = -W^i
+            uint32_t index = (k * n) & (N - 1u);
+            double sign = 1.0;
+
+            if (index >= (N / 2u))
+            {
+                index -= N / 2u;
+                sign = -1.0;
+            }
+
+            const double W_RE = sign * p_fft->p_twiddles[2u * index];
+            const double W_IM = sign * p_fft->p_twiddles[(2u * index) + 1u];
+
+            sum_re += (p_in[2u * n] * W_RE) - (p_in[(2u * n) + 1u] * W_IM);
+            sum_im += (p_in[2u * n] * W_IM) + (p_in[(2u * n) + 1u] * W_RE);
+        }
+
+        p_out[2u * k] = (float)sum_re;
+        p_out[(2u * k) + 1u] = (float)sum_im;
+    }
+}
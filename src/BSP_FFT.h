@@ -0,0 +1,270 @@
+/**
+ * DESCRIPTION:
+ *      BSP_FFT turns blocks of samples, such as ADC readings from PSP_SPI_0 or edges timed by
+ *      BSP_Logic_Analyzer, into spectra on the Pi itself: in place complex and real input FFTs
+ *      of 64 to 4096 points in Q15 and float, window functions to apply first, and power
+ *      spectra to read the result from. BSP_FFT_Reference_DFT_F32 is a plain O(N^2) DFT to
+ *      check it against.
+ *
+ * NOTES:
+ *      Each transform size gets its own twiddle table, filled in once by the init function,
+ *      in memory the caller hands over: BSP_FFT_TWIDDLE_SIZE(num_points) floats or int16_ts,
+ *      e.g. 24 KB for a 4096 point float transform. The same table serves the complex and
+ *      the real transform of that size.
+ *
+ *      Complex data is interleaved, {re[0], im[0], re[1], im[1], ...}, and the output is in
+ *      natural order. The transforms are forward only, X[k] = sum of x[n] * e^(-2 pi i k n / N).
+ *
+ *      The real transforms take num_points real samples and give back the num_points / 2 + 1
+ *      bins from DC to Nyquist packed into the same num_points words: DC and Nyquist have no
+ *      imaginary part, so they take the first pair as {re[0], re[N/2]}, then {re[1], im[1]}
+ *      and on up to bin N/2 - 1. Inside, that's a complex transform of half the size on the
+ *      even and odd samples as the real and imaginary parts, plus a pass to split the two.
+ *
+ *      The transforms are radix-4, with one radix-2 pass first when the size is an odd power
+ *      of 2, after a bit reversed reordering. Each radix-4 pass does two radix-2 passes' worth
+ *      of work in one read and write of the data, and as data is uncached (see PSP_Cache)
+ *      those passes over memory are most of the cost. The butterflies work on 2 complex
+ *      points at a time with GCC vector types, so they compile to NEON when NEON is enabled
+ *      (make NEON=1) and to plain ARM code otherwise, as in BSP_DSP.
+ *
+ *      Float results are not scaled. Q15 results are scaled by 1 / num_points, a quarter per
+ *      radix-4 pass, which can't overflow as long as complex inputs stay inside the unit
+ *      circle (any real input is fine). Each pass rounds, which leaves complex results within
+ *      2 LSBs of exact at every size, and real results within 3, as splitting the two halves
+ *      apart rounds once more.
+ *
+ *      Windows are periodic (the DFT-even form), the one to use for spectral analysis, and
+ *      applying one is a multiply per sample, so keep the table rather than make it per block.
+ *
+ * REFERENCES:
+ *      CMSIS-DSP transform functions: https://arm-software.github.io/CMSIS-DSP/latest/
+ *      R. Lyons, Understanding Digital Signal Processing, chapters 3, 4 and 13.5
+ *      F. Harris, On the Use of Windows for Harmonic Analysis with the DFT, Proc. IEEE, 1978
+ */
+
+#ifndef BSP_FFT_H_INCLUDED
+#define BSP_FFT_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_FFT Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_FFT_MIN_POINTS      64u
+#define BSP_FFT_MAX_POINTS      4096u
+
+// twiddle table size, in floats or int16_ts: e^(-2 pi i k / N) for k up to 3N/4, the most a radix-4 pass needs
+#define BSP_FFT_TWIDDLE_SIZE(num_points)    ((3u * (num_points)) / 2u)
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_FFT Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum FFT_Window_Type
+{
+    BSP_FFT_Window_Hann = 0u,           // the usual choice, -31 dB side lobes
+    BSP_FFT_Window_Hamming,             // narrower main lobe, -43 dB nearest side lobe
+    BSP_FFT_Window_Blackman             // wider main lobe, -58 dB side lobes
+} BSP_FFT_Window_t;
+
+
+
+typedef struct FFT_F32_Type
+{
+    float * p_twiddles;                 // BSP_FFT_TWIDDLE_SIZE(num_points), {re, im} pairs
+    uint32_t num_points;
+} BSP_FFT_F32_t;
+
+
+
+typedef struct FFT_Q15_Type
+{
+    int16_t * p_twiddles;
+    uint32_t num_points;
+} BSP_FFT_Q15_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_FFT Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FFT_F32_Init, BSP_FFT_Q15_Init
+
+Function Description:
+    Set up a transform size, filling in its twiddle table.
+
+Inputs:
+    p_fft: the transform
+    num_points: a power of 2 from BSP_FFT_MIN_POINTS to BSP_FFT_MAX_POINTS
+    p_twiddles: BSP_FFT_TWIDDLE_SIZE(num_points) floats or int16_ts, kept by reference
+
+Returns:
+    uint32_t: 1 on success, 0 if num_points isn't a supported size
+
+Error Handling:
+    The twiddle table is left alone if the size isn't supported.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_FFT_F32_Init(BSP_FFT_F32_t * p_fft, uint32_t num_points, float * p_twiddles);
+uint32_t BSP_FFT_Q15_Init(BSP_FFT_Q15_t * p_fft, uint32_t num_points, int16_t * p_twiddles);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FFT_F32_Complex, BSP_FFT_Q15_Complex
+
+Function Description:
+    Transform num_points complex samples in place. Q15 results are scaled by 1 / num_points.
+
+Inputs:
+    p_fft: the transform
+    p_data: num_points complex samples, interleaved, replaced by their spectrum
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_FFT_F32_Complex(const BSP_FFT_F32_t * p_fft, float * p_data);
+void BSP_FFT_Q15_Complex(const BSP_FFT_Q15_t * p_fft, int16_t * p_data);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FFT_F32_Real, BSP_FFT_Q15_Real
+
+Function Description:
+    Transform num_points real samples in place, about half the work of a complex transform
+    of the same size. The result is packed: {re[0], re[N/2]}, then {re[k], im[k]} for k from
+    1 to N/2 - 1. Q15 results are scaled by 1 / num_points.
+
+Inputs:
+    p_fft: the transform
+    p_data: num_points real samples, replaced by their packed spectrum
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_FFT_F32_Real(const BSP_FFT_F32_t * p_fft, float * p_data);
+void BSP_FFT_Q15_Real(const BSP_FFT_Q15_t * p_fft, int16_t * p_data);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FFT_F32_Power_Spectrum, BSP_FFT_Q15_Power_Spectrum
+
+Function Description:
+    Get the power (re^2 + im^2) of each bin of a packed real spectrum, from DC to Nyquist.
+
+Inputs:
+    p_spectrum: from BSP_FFT_*_Real
+    p_power: where to put num_points / 2 + 1 powers, Q30 for Q15 spectra
+    num_points: the transform's size
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_FFT_F32_Power_Spectrum(const float * p_spectrum, float * p_power, uint32_t num_points);
+void BSP_FFT_Q15_Power_Spectrum(const int16_t * p_spectrum, uint32_t * p_power, uint32_t num_points);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FFT_F32_Make_Window, BSP_FFT_Q15_Make_Window
+
+Function Description:
+    Fill in a periodic window, to apply with BSP_FFT_*_Apply_Window.
+
+Inputs:
+    p_window: where to put num_points coefficients
+    num_points: the block size, at least 1
+    window: which window
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_FFT_F32_Make_Window(float * p_window, uint32_t num_points, BSP_FFT_Window_t window);
+void BSP_FFT_Q15_Make_Window(int16_t * p_window, uint32_t num_points, BSP_FFT_Window_t window);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FFT_F32_Apply_Window, BSP_FFT_Q15_Apply_Window
+
+Function Description:
+    Multiply a block of real samples by a window, in place.
+
+Inputs:
+    p_samples: num_points samples
+    p_window: from BSP_FFT_*_Make_Window
+    num_points: the block size
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_FFT_F32_Apply_Window(float * p_samples, const float * p_window, uint32_t num_points);
+void BSP_FFT_Q15_Apply_Window(int16_t * p_samples, const int16_t * p_window, uint32_t num_points);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_FFT_Reference_DFT_F32
+
+Function Description:
+    The complex DFT, term by term with the transform's twiddle table, to check the fast
+    versions against. O(num_points^2), about 16 million multiplies at 4096 points.
+
+Inputs:
+    p_fft: the transform
+    p_in: num_points complex samples, interleaved
+    p_out: where to put their spectrum, not p_in
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_FFT_Reference_DFT_F32(const BSP_FFT_F32_t * p_fft, const float * p_in, float * p_out);
+
+#endif
@@ -0,0 +1,606 @@
+
+#include "BSP_Graphics.h"
+#include "PSP_Framebuffer.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Graphics Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define GRAPHICS_LANES              4u              // pixels per vector
+#define GRAPHICS_FIRST_CHAR         ' '
+#define GRAPHICS_LAST_CHAR          '~'
+
+#define GRAPHICS_RED_BLUE_MASK      0x00FF00FFu     // two channels per multiply, with room to spare
+#define GRAPHICS_GREEN_MASK         0x0000FF00u
+#define GRAPHICS_ALPHA_MASK         0xFF000000u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Graphics Types
+ -------------------------------------------------------------------------------------------------*/
+
+// 4 pixels, only word aligned, so pixel rows can start anywhere
+typedef uint32_t Graphics_Lanes_t __attribute__((vector_size(16), aligned(4)));
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Graphics Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// printable ASCII, 5x7 with a blank bottom row, bit 7 is the leftmost pixel
+static const uint8_t graphics_font[GRAPHICS_LAST_CHAR - GRAPHICS_FIRST_CHAR + 1][BSP_GRAPHICS_FONT_HEIGHT] =
+{
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00 },  // space
+    { 0x20, 0x20, 0x20, 0x20, 0x20, 0x00, 0x20, 0x00 },  // !
+    { 0x50, 0x50, 0x50, 0x00, 0x00, 0x00, 0x00, 0x00 },  // "
+    { 0x50, 0x50, 0xF8, 0x50, 0xF8, 0x50, 0x50, 0x00 },  // #
+    { 0x20, 0x78, 0xA0, 0x70, 0x28, 0xF0, 0x20, 0x00 },  // $
+    { 0xC0, 0xC8, 0x10, 0x20, 0x40, 0x98, 0x18, 0x00 },  // %
+    { 0x60, 0x90, 0xA0, 0x40, 0xA8, 0x90, 0x68, 0x00 },  // &
+    { 0x20, 0x20, 0x40, 0x00, 0x00, 0x00, 0x00, 0x00 },  // '
+    { 0x10, 0x20, 0x40, 0x40, 0x40, 0x20, 0x10, 0x00 },  // (
+    { 0x40, 0x20, 0x10, 0x10, 0x10, 0x20, 0x40, 0x00 },  // )
+    { 0x00, 0x20, 0xA8, 0x70, 0xA8, 0x20, 0x00, 0x00 },  // *
+    { 0x00, 0x20, 0x20, 0xF8, 0x20, 0x20, 0x00, 0x00 },  // +
+    { 0x00, 0x00, 0x00, 0x00, 0x60, 0x20, 0x40, 0x00 },  // ,
+    { 0x00, 0x00, 0x00, 0xF8, 0x00, 0x00, 0x00, 0x00 },  // -
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x60, 0x60, 0x00 },  // .
+    { 0x00, 0x08, 0x10, 0x20, 0x40, 0x80, 0x00, 0x00 },  // /
+    { 0x70, 0x88, 0x98, 0xA8, 0xC8, 0x88, 0x70, 0x00 },  // 0
+    { 0x20, 0x60, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00 },  // 1
+    { 0x70, 0x88, 0x08, 0x10, 0x20, 0x40, 0xF8, 0x00 },  // 2
+    { 0xF8, 0x10, 0x20, 0x10, 0x08, 0x88, 0x70, 0x00 },  // 3
+    { 0x10, 0x30, 0x50, 0x90, 0xF8, 0x10, 0x10, 0x00 },  // 4
+    { 0xF8, 0x80, 0xF0, 0x08, 0x08, 0x88, 0x70, 0x00 },  // 5
+    { 0x30, 0x40, 0x80, 0xF0, 0x88, 0x88, 0x70, 0x00 },  // 6
+    { 0xF8, 0x08, 0x10, 0x20, 0x40, 0x40, 0x40, 0x00 },  // 7
+    { 0x70, 0x88, 0x88, 0x70, 0x88, 0x88, 0x70, 0x00 },  // 8
+    { 0x70, 0x88, 0x88, 0x78, 0x08, 0x10, 0x60, 0x00 },  // 9
+    { 0x00, 0x60, 0x60, 0x00, 0x60, 0x60, 0x00, 0x00 },  // :
+    { 0x00, 0x60, 0x60, 0x00, 0x60, 0x20, 0x40, 0x00 },  // ;
+    { 0x10, 0x20, 0x40, 0x80, 0x40, 0x20, 0x10, 0x00 },  // <
+    { 0x00, 0x00, 0xF8, 0x00, 0xF8, 0x00, 0x00, 0x00 },  // =
+    { 0x40, 0x20, 0x10, 0x08, 0x10, 0x20, 0x40, 0x00 },  // >
+    { 0x70, 0x88, 0x08, 0x10, 0x20, 0x00, 0x20, 0x00 },  // ?
+    { 0x70, 0x88, 0x08, 0x68, 0xA8, 0xA8, 0x70, 0x00 },  // @
+    { 0x70, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0x00 },  // A
+    { 0xF0, 0x88, 0x88, 0xF0, 0x88, 0x88, 0xF0, 0x00 },  // B
+    { 0x70, 0x88, 0x80, 0x80, 0x80, 0x88, 0x70, 0x00 },  // C
+    { 0xE0, 0x90, 0x88, 0x88, 0x88, 0x90, 0xE0, 0x00 },  // D
+    { 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0xF8, 0x00 },  // E
+    { 0xF8, 0x80, 0x80, 0xF0, 0x80, 0x80, 0x80, 0x00 },  // F
+    { 0x70, 0x88, 0x80, 0xB8, 0x88, 0x88, 0x78, 0x00 },  // G
+    { 0x88, 0x88, 0x88, 0xF8, 0x88, 0x88, 0x88, 0x00 },  // H
+    { 0x70, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00 },  // I
+    { 0x38, 0x10, 0x10, 0x10, 0x10, 0x90, 0x60, 0x00 },  // J
+    { 0x88, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x88, 0x00 },  // K
+    { 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0xF8, 0x00 },  // L
+    { 0x88, 0xD8, 0xA8, 0xA8, 0x88, 0x88, 0x88, 0x00 },  // M
+    { 0x88, 0x88, 0xC8, 0xA8, 0x98, 0x88, 0x88, 0x00 },  // N
+    { 0x70, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00 },  // O
+    { 0xF0, 0x88, 0x88, 0xF0, 0x80, 0x80, 0x80, 0x00 },  // P
+    { 0x70, 0x88, 0x88, 0x88, 0xA8, 0x90, 0x68, 0x00 },  // Q
+    { 0xF0, 0x88, 0x88, 0xF0, 0xA0, 0x90, 0x88, 0x00 },  // R
+    { 0x78, 0x80, 0x80, 0x70, 0x08, 0x08, 0xF0, 0x00 },  // S
+    { 0xF8, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00 },  // T
+    { 0x88, 0x88, 0x88, 0x88, 0x88, 0x88, 0x70, 0x00 },  // U
+    { 0x88, 0x88, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00 },  // V
+    { 0x88, 0x88, 0x88, 0xA8, 0xA8, 0xA8, 0x50, 0x00 },  // W
+    { 0x88, 0x88, 0x50, 0x20, 0x50, 0x88, 0x88, 0x00 },  // X
+    { 0x88, 0x88, 0x88, 0x50, 0x20, 0x20, 0x20, 0x00 },  // Y
+    { 0xF8, 0x08, 0x10, 0x20, 0x40, 0x80, 0xF8, 0x00 },  // Z
+    { 0x70, 0x40, 0x40, 0x40, 0x40, 0x40, 0x70, 0x00 },  // [
+    { 0x00, 0x80, 0x40, 0x20, 0x10, 0x08, 0x00, 0x00 },  // backslash
+    { 0x70, 0x10, 0x10, 0x10, 0x10, 0x10, 0x70, 0x00 },  // ]
+    { 0x20, 0x50, 0x88, 0x00, 0x00, 0x00, 0x00, 0x00 },  // ^
+    { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xF8, 0x00 },  // _
+    { 0x40, 0x20, 0x10, 0x00, 0x00, 0x00, 0x00, 0x00 },  // `
+    { 0x00, 0x00, 0x70, 0x08, 0x78, 0x88, 0x78, 0x00 },  // a
+    { 0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0xF0, 0x00 },  // b
+    { 0x00, 0x00, 0x70, 0x80, 0x80, 0x88, 0x70, 0x00 },  // c
+    { 0x08, 0x08, 0x68, 0x98, 0x88, 0x88, 0x78, 0x00 },  // d
+    { 0x00, 0x00, 0x70, 0x88, 0xF8, 0x80, 0x70, 0x00 },  // e
+    { 0x30, 0x48, 0x40, 0xE0, 0x40, 0x40, 0x40, 0x00 },  // f
+    { 0x00, 0x78, 0x88, 0x88, 0x78, 0x08, 0x70, 0x00 },  // g
+    { 0x80, 0x80, 0xB0, 0xC8, 0x88, 0x88, 0x88, 0x00 },  // h
+    { 0x20, 0x00, 0x60, 0x20, 0x20, 0x20, 0x70, 0x00 },  // i
+    { 0x10, 0x00, 0x30, 0x10, 0x10, 0x90, 0x60, 0x00 },  // j
+    { 0x80, 0x80, 0x90, 0xA0, 0xC0, 0xA0, 0x90, 0x00 },  // k
+    { 0x60, 0x20, 0x20, 0x20, 0x20, 0x20, 0x70, 0x00 },  // l
+    { 0x00, 0x00, 0xD0, 0xA8, 0xA8, 0x88, 0x88, 0x00 },  // m
+    { 0x00, 0x00, 0xB0, 0xC8, 0x88, 0x88, 0x88, 0x00 },  // n
+    { 0x00, 0x00, 0x70, 0x88, 0x88, 0x88, 0x70, 0x00 },  // o
+    { 0x00, 0x00, 0xF0, 0x88, 0xF0, 0x80, 0x80, 0x00 },  // p
+    { 0x00, 0x00, 0x68, 0x98, 0x78, 0x08, 0x08, 0x00 },  // q
+    { 0x00, 0x00, 0xB0, 0xC8, 0x80, 0x80, 0x80, 0x00 },  // r
+    { 0x00, 0x00, 0x70, 0x80, 0x70, 0x08, 0xF0, 0x00 },  // s
+    { 0x40, 0x40, 0xE0, 0x40, 0x40, 0x48, 0x30, 0x00 },  // t
+    { 0x00, 0x00, 0x88, 0x88, 0x88, 0x98, 0x68, 0x00 },  // u
+    { 0x00, 0x00, 0x88, 0x88, 0x88, 0x50, 0x20, 0x00 },  // v
+    { 0x00, 0x00, 0x88, 0x88, 0xA8, 0xA8, 0x50, 0x00 },  // w
+    { 0x00, 0x00, 0x88, 0x50, 0x20, 0x50, 0x88, 0x00 },  // x
+    { 0x00, 0x00, 0x88, 0x88, 0x78, 0x08, 0x70, 0x00 },  // y
+    { 0x00, 0x00, 0xF8, 0x10, 0x20, 0x40, 0xF8, 0x00 },  // z
+    { 0x10, 0x20, 0x20, 0x40, 0x20, 0x20, 0x10, 0x00 },  // {
+    { 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x20, 0x00 },  // |
+    { 0x40, 0x20, 0x20, 0x10, 0x20, 0x20, 0x40, 0x00 },  // }
+    { 0x00, 0x00, 0x40, 0xA8, 0x10, 0x00, 0x00, 0x00 }   // ~
+};
+
+static BSP_Graphics_Surface_t graphics_pages[2];
+static uint32_t graphics_back_page;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_Graphics Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+static uint32_t * Graphics_Pixel(const BSP_Graphics_Surface_t * p_surface, uint32_t x, uint32_t y)
+{
+    return p_surface->p_pixels + (y * p_surface->pitch) + x;
+}
+
+
+
+/**
+ * Clip a rectangle to a surface, moving a second (source) position along with it if given.
+ * Returns 0 if nothing is left.
+ */
+static uint32_t Graphics_Clip(const BSP_Graphics_Surface_t * p_surface, int32_t * p_x, int32_t * p_y,
+                              uint32_t * p_width, uint32_t * p_height, int32_t * p_src_x, int32_t * p_src_y)
+{
+    int32_t x = *p_x;
+    int32_t y = *p_y;
+    int32_t right = x + (int32_t)*p_width;
+    int32_t bottom = y + (int32_t)*p_height;
+
+    if (x < 0)
+    {
+        x = 0;
+    }
+
+    if (y < 0)
+    {
+        y = 0;
+    }
+
+    if (right > (int32_t)p_surface->width)
+    {
+        right = (int32_t)p_surface->width;
+    }
+
+    if (bottom > (int32_t)p_surface->height)
+    {
+        bottom = (int32_t)p_surface->height;
+    }
+
+    if ((x >= right) || (y >= bottom))
+    {
+        return 0u;
+    }
+
+    if (p_src_x != 0)
+    {
+        *p_src_x += x - *p_x;
+        *p_src_y += y - *p_y;
+    }
+
+    *p_x = x;
+    *p_y = y;
+    *p_width = (uint32_t)(right - x);
+    *p_height = (uint32_t)(bottom - y);
+
+    return 1u;
+}
+
+
+
+/**
+ * Clip a copy or blend to both surfaces, the source is clipped as if it were the destination
+ * and then the result clipped again to the destination.
+ */
+static uint32_t Graphics_Clip_Both(const BSP_Graphics_Surface_t * p_dest, int32_t * p_x, int32_t * p_y,
+                                   const BSP_Graphics_Surface_t * p_src, int32_t * p_src_x, int32_t * p_src_y,
+                                   uint32_t * p_width, uint32_t * p_height)
+{
+    return Graphics_Clip(p_src, p_src_x, p_src_y, p_width, p_height, p_x, p_y) &&
+           Graphics_Clip(p_dest, p_x, p_y, p_width, p_height, p_src_x, p_src_y);
+}
+
+
+
+static void Graphics_Add_Dirty(BSP_Graphics_Surface_t * p_surface, uint32_t x, uint32_t y, uint32_t width, uint32_t height)
+{
+    uint32_t best = 0u;
+    uint32_t best_growth = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0u; i < p_surface->num_dirty; i++)
+    {
+        const BSP_Graphics_Rect_t * p_rect = &p_surface->dirty[i];
+        const uint32_t LEFT = (x < p_rect->x) ? x : p_rect->x;
+        const uint32_t TOP = (y < p_rect->y) ? y : p_rect->y;
+        const uint32_t RIGHT = ((x + width) > (p_rect->x + p_rect->width)) ? (x + width) : (p_rect->x + p_rect->width);
+        const uint32_t BOTTOM = ((y + height) > (p_rect->y + p_rect->height)) ? (y + height) : (p_rect->y + p_rect->height);
+        const uint32_t TOUCHING = (x <= (p_rect->x + p_rect->width)) && (p_rect->x <= (x + width)) &&
+                                  (y <= (p_rect->y + p_rect->height)) && (p_rect->y <= (y + height));
+        const uint32_t GROWTH = ((RIGHT - LEFT) * (BOTTOM - TOP)) - (p_rect->width * p_rect->height);
+
+        if (TOUCHING || (GROWTH < best_growth))
+        {
+            best = i;
+            best_growth = TOUCHING ? 0u : GROWTH;
+
+            if (TOUCHING)
+            {
+                break;
+            }
+        }
+    }
+
+    if ((best_growth != 0u) && (p_surface->num_dirty < BSP_GRAPHICS_MAX_DIRTY))
+    {
+        BSP_Graphics_Rect_t * p_rect = &p_surface->dirty[p_surface->num_dirty++];
+
+        p_rect->x = x;
+        p_rect->y = y;
+        p_rect->width = width;
+        p_rect->height = height;
+
+        return;
+    }
+
+    // merge with the touching rectangle, or the one that grows the least
+    BSP_Graphics_Rect_t * p_rect = &p_surface->dirty[best];
+    const uint32_t RIGHT = ((x + width) > (p_rect->x + p_rect->width)) ? (x + width) : (p_rect->x + p_rect->width);
+    const uint32_t BOTTOM = ((y + height) > (p_rect->y + p_rect->height)) ? (y + height) : (p_rect->y + p_rect->height);
+
+    p_rect->x = (x < p_rect->x) ? x : p_rect->x;
+    p_rect->y = (y < p_rect->y) ? y : p_rect->y;
+    p_rect->width = RIGHT - p_rect->x;
+    p_rect->height = BOTTOM - p_rect->y;
+}
+
+
+
+static void Graphics_Fill_Row(uint32_t * p_dest, uint32_t num_pixels, uint32_t color)
+{
+    const Graphics_Lanes_t COLOR = { color, color, color, color };
+
+    for (; num_pixels >= GRAPHICS_LANES; num_pixels -= GRAPHICS_LANES, p_dest += GRAPHICS_LANES)
+    {
+        *(Graphics_Lanes_t *)p_dest = COLOR;
+    }
+
+    for (; num_pixels != 0u; num_pixels--)
+    {
+        *p_dest++ = color;
+    }
+}
+
+
+
+/**
+ * Safe for overlap when p_dest is before p_src, each vector is loaded before anything it
+ * overlaps is stored.
+ */
+static void Graphics_Copy_Row(uint32_t * p_dest, const uint32_t * p_src, uint32_t num_pixels)
+{
+    for (; num_pixels >= GRAPHICS_LANES; num_pixels -= GRAPHICS_LANES, p_dest += GRAPHICS_LANES, p_src += GRAPHICS_LANES)
+    {
+        *(Graphics_Lanes_t *)p_dest = *(const Graphics_Lanes_t *)p_src;
+    }
+
+    for (; num_pixels != 0u; num_pixels--)
+    {
+        *p_dest++ = *p_src++;
+    }
+}
+
+
+
+/**
+ * dest = (src * a + dest * (256 - a)) / 256 per channel, with a = alpha + (alpha >> 7) so 255
+ * is all source and 0 is all destination.
+ *
+ * Red and blue are done together in one multiply (0x00RR00BB * a can't carry from blue into
+ * red), and green on its own.
+ */
+static Graphics_Lanes_t Graphics_Blend_Lanes(Graphics_Lanes_t src, Graphics_Lanes_t dest)
+{
+    Graphics_Lanes_t alpha = src >> 24u;
+
+    alpha += alpha >> 7u;
+
+    const Graphics_Lanes_t INVERSE = 256u - alpha;
+    const Graphics_Lanes_t RED_BLUE = (((src & GRAPHICS_RED_BLUE_MASK) * alpha) + ((dest & GRAPHICS_RED_BLUE_MASK) * INVERSE)) >> 8u;
+    const Graphics_Lanes_t GREEN = (((src & GRAPHICS_GREEN_MASK) * alpha) + ((dest & GRAPHICS_GREEN_MASK) * INVERSE)) >> 8u;
+
+    return (RED_BLUE & GRAPHICS_RED_BLUE_MASK) | (GREEN & GRAPHICS_GREEN_MASK) | (dest & GRAPHICS_ALPHA_MASK);
+}
+
+
+
+static void Graphics_Blend_Row(uint32_t * p_dest, const uint32_t * p_src, uint32_t num_pixels)
+{
+    for (; num_pixels >= GRAPHICS_LANES; num_pixels -= GRAPHICS_LANES, p_dest += GRAPHICS_LANES, p_src += GRAPHICS_LANES)
+    {
+        *(Graphics_Lanes_t *)p_dest = Graphics_Blend_Lanes(*(const Graphics_Lanes_t *)p_src, *(Graphics_Lanes_t *)p_dest);
+    }
+
+    for (; num_pixels != 0u; num_pixels--, p_dest++, p_src++)
+    {
+        const Graphics_Lanes_t SRC = { *p_src };
+        const Graphics_Lanes_t DEST = { *p_dest };
+
+        *p_dest = Graphics_Blend_Lanes(SRC, DEST)[0];
+    }
+}
+
+
+
+/**
+ * Draw glyph pixels first...first + num_pixels - 1 of a row (bit 7 - first is the first
+ * pixel drawn). 4 bits at a time become a lane mask by comparing against one bit per lane.
+ */
+static void Graphics_Glyph_Row(uint32_t * p_dest, uint32_t bits, uint32_t first, uint32_t num_pixels,
+                               uint32_t foreground, uint32_t background)
+{
+    const Graphics_Lanes_t LANE_BITS = { 0x80u, 0x40u, 0x20u, 0x10u };
+    const Graphics_Lanes_t FOREGROUND = { foreground, foreground, foreground, foreground };
+    const Graphics_Lanes_t BACKGROUND = { background, background, background, background };
+
+    bits = (bits << first) & 0xFFu;
+
+    for (; num_pixels >= GRAPHICS_LANES; num_pixels -= GRAPHICS_LANES, p_dest += GRAPHICS_LANES, bits = (bits << 4u) & 0xFFu)
+    {
+        const Graphics_Lanes_t BITS = { bits, bits, bits, bits };
+        const Graphics_Lanes_t MASK = (Graphics_Lanes_t)((BITS & LANE_BITS) != 0u);
+        const Graphics_Lanes_t BEHIND = (background == BSP_GRAPHICS_TRANSPARENT) ? *(Graphics_Lanes_t *)p_dest : BACKGROUND;
+
+        *(Graphics_Lanes_t *)p_dest = (FOREGROUND & MASK) | (BEHIND & ~MASK);
+    }
+
+    for (; num_pixels != 0u; num_pixels--, p_dest++, bits <<= 1u)
+    {
+        if (bits & 0x80u)
+        {
+            *p_dest = foreground;
+        }
+        else if (background != BSP_GRAPHICS_TRANSPARENT)
+        {
+            *p_dest = background;
+        }
+    }
+}
+
+
+
+void BSP_Graphics_Init_Surface(BSP_Graphics_Surface_t * p_surface, uint32_t * p_pixels,
+                               uint32_t width, uint32_t height, uint32_t pitch)
+{
+    p_surface->p_pixels = p_pixels;
+    p_surface->width = width;
+    p_surface->height = height;
+    p_surface->pitch = pitch;
+    p_surface->num_dirty = 0u;
+}
+
+
+
+void BSP_Graphics_Fill(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                       uint32_t width, uint32_t height, uint32_t color)
+{
+    if (!Graphics_Clip(p_surface, &x, &y, &width, &height, 0, 0))
+    {
+        return;
+    }
+
+    for (uint32_t row = 0u; row < height; row++)
+    {
+        Graphics_Fill_Row(Graphics_Pixel(p_surface, (uint32_t)x, (uint32_t)y + row), width, color);
+    }
+
+    Graphics_Add_Dirty(p_surface, (uint32_t)x, (uint32_t)y, width, height);
+}
+
+
+
+void BSP_Graphics_Copy(BSP_Graphics_Surface_t * p_dest, int32_t x, int32_t y,
+                       const BSP_Graphics_Surface_t * p_src, int32_t src_x, int32_t src_y,
+                       uint32_t width, uint32_t height)
+{
+    if (!Graphics_Clip_Both(p_dest, &x, &y, p_src, &src_x, &src_y, &width, &height))
+    {
+        return;
+    }
+
+    uint32_t * p_dest_pixel = Graphics_Pixel(p_dest, (uint32_t)x, (uint32_t)y);
+    const uint32_t * p_src_pixel = Graphics_Pixel(p_src, (uint32_t)src_x, (uint32_t)src_y);
+
+    if (p_dest_pixel == p_src_pixel)
+    {
+        return;
+    }
+
+    if (p_dest_pixel < p_src_pixel)
+    {
+        // destination before the source, forward copies never overwrite what is still to be read
+        for (uint32_t row = 0u; row < height; row++)
+        {
+            Graphics_Copy_Row(p_dest_pixel + (row * p_dest->pitch), p_src_pixel + (row * p_src->pitch), width);
+        }
+    }
+    else
+    {
+        // destination after the source, copy from the bottom up, and rows backwards if they overlap
+        for (uint32_t row = height; row-- != 0u;)
+        {
+            memmove(p_dest_pixel + (row * p_dest->pitch), p_src_pixel + (row * p_src->pitch), width * sizeof(uint32_t));
+        }
+    }
+
+    Graphics_Add_Dirty(p_dest, (uint32_t)x, (uint32_t)y, width, height);
+}
+
+
+
+void BSP_Graphics_Blend(BSP_Graphics_Surface_t * p_dest, int32_t x, int32_t y,
+                        const BSP_Graphics_Surface_t * p_src, int32_t src_x, int32_t src_y,
+                        uint32_t width, uint32_t height)
+{
+    if (!Graphics_Clip_Both(p_dest, &x, &y, p_src, &src_x, &src_y, &width, &height))
+    {
+        return;
+    }
+
+    for (uint32_t row = 0u; row < height; row++)
+    {
+        Graphics_Blend_Row(Graphics_Pixel(p_dest, (uint32_t)x, (uint32_t)y + row),
+                           Graphics_Pixel(p_src, (uint32_t)src_x, (uint32_t)src_y + row), width);
+    }
+
+    Graphics_Add_Dirty(p_dest, (uint32_t)x, (uint32_t)y, width, height);
+}
+
+
+
+void BSP_Graphics_Draw_Glyph(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                             const uint8_t * p_rows, uint32_t width, uint32_t height,
+                             uint32_t foreground, uint32_t background)
+{
+    const int32_t GLYPH_X = x;
+    const int32_t GLYPH_Y = y;
+
+    if ((width > 8u) || !Graphics_Clip(p_surface, &x, &y, &width, &height, 0, 0))
+    {
+        return;
+    }
+
+    for (uint32_t row = 0u; row < height; row++)
+    {
+        Graphics_Glyph_Row(Graphics_Pixel(p_surface, (uint32_t)x, (uint32_t)y + row), p_rows[(y - GLYPH_Y) + (int32_t)row],
+                           (uint32_t)(x - GLYPH_X), width, foreground, background);
+    }
+
+    Graphics_Add_Dirty(p_surface, (uint32_t)x, (uint32_t)y, width, height);
+}
+
+
+
+int32_t BSP_Graphics_Draw_Text(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                               const char * p_text, uint32_t foreground, uint32_t background)
+{
+    const int32_t LEFT = x;
+
+    for (; *p_text != '\0'; p_text++)
+    {
+        char c = *p_text;
+
+        if (c == '\n')
+        {
+            x = LEFT;
+            y += (int32_t)BSP_GRAPHICS_FONT_HEIGHT;
+            continue;
+        }
+
+        if ((c < GRAPHICS_FIRST_CHAR) || (c > GRAPHICS_LAST_CHAR))
+        {
+            c = '?';
+        }
+
+        BSP_Graphics_Draw_Glyph(p_surface, x, y, graphics_font[c - GRAPHICS_FIRST_CHAR],
+                                BSP_GRAPHICS_FONT_WIDTH, BSP_GRAPHICS_FONT_HEIGHT, foreground, background);
+
+        x += (int32_t)BSP_GRAPHICS_FONT_WIDTH;
+    }
+
+    return x;
+}
+
+
+
+void BSP_Graphics_Mark_Dirty(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                             uint32_t width, uint32_t height)
+{
+    if (Graphics_Clip(p_surface, &x, &y, &width, &height, 0, 0))
+    {
+        Graphics_Add_Dirty(p_surface, (uint32_t)x, (uint32_t)y, width, height);
+    }
+}
+
+
+
+uint32_t BSP_Graphics_Display_Init(uint32_t width, uint32_t height)
+{
+    if (!PSP_Framebuffer_Init(width, height))
+    {
+        return 0u;
+    }
+
+    const uint32_t NUM_PAGES = PSP_Framebuffer_Get_Num_Pages();
+    const uint32_t PITCH = PSP_Framebuffer_Get_Pitch() / sizeof(uint32_t);
+
+    for (uint32_t page = 0u; page < NUM_PAGES; page++)
+    {
+        BSP_Graphics_Init_Surface(&graphics_pages[page], PSP_Framebuffer_Get_Page(page), width, height, PITCH);
+        BSP_Graphics_Fill(&graphics_pages[page], 0, 0, width, height, BSP_GRAPHICS_RGB(0u, 0u, 0u));
+        graphics_pages[page].num_dirty = 0u;
+    }
+
+    // page 0 is on show
+    graphics_back_page = NUM_PAGES - 1u;
+
+    return 1u;
+}
+
+
+
+BSP_Graphics_Surface_t * BSP_Graphics_Display_Get_Back(void)
+{
+    return &graphics_pages[graphics_back_page];
+}
+
+
+
+uint32_t BSP_Graphics_Display_Present(void)
+{
+    BSP_Graphics_Surface_t * p_back = &graphics_pages[graphics_back_page];
+    uint32_t num_copied = 0u;
+
+    if (PSP_Framebuffer_Get_Num_Pages() < 2u)
+    {
+        p_back->num_dirty = 0u; // drawn straight on the display
+        return 0u;
+    }
+
+    if (!PSP_Framebuffer_Show_Page(graphics_back_page))
+    {
+        return 0u;
+    }
+
+    BSP_Graphics_Surface_t * p_front = &graphics_pages[graphics_back_page ^ 1u];
+
+    for (uint32_t i = 0u; i < p_back->num_dirty; i++)
+    {
+        const BSP_Graphics_Rect_t * p_rect = &p_back->dirty[i];
+
+        for (uint32_t row = 0u; row < p_rect->height; row++)
+        {
+            Graphics_Copy_Row(Graphics_Pixel(p_front, p_rect->x, p_rect->y + row),
+                              Graphics_Pixel(p_back, p_rect->x, p_rect->y + row), p_rect->width);
+        }
+
+        num_copied += p_rect->width * p_rect->height;
+    }
+
+    // the front page is now the same as the back, nothing to carry over to the next frame
+    p_back->num_dirty = 0u;
+    p_front->num_dirty = 0u;
+    graphics_back_page ^= 1u;
+
+    return num_copied;
+}
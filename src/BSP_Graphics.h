@@ -0,0 +1,345 @@
+/**
+ * DESCRIPTION:
+ *      BSP_Graphics draws on 32 bit pixel surfaces (fill, copy, alpha blend, 1 bit glyphs and
+ *      text), keeps track of the rectangles that changed, and runs a double buffered display on
+ *      PSP_Framebuffer that only copies those rectangles between pages.
+ *
+ * NOTES:
+ *      A surface is any block of 0xAARRGGBB pixels: a framebuffer page, or an off screen buffer
+ *      for sprites and icons. Everything drawn is clipped to the surfaces involved, so
+ *      positions can be partly (or wholly) off the surface.
+ *
+ *      The fill, copy, blend and glyph loops work on 4 pixels at a time with GCC vector types,
+ *      so they compile to NEON when NEON is enabled (make NEON=1) and to plain ARM code
+ *      otherwise. Blending is the source's alpha over the destination, with alpha 255 fully
+ *      the source and 0 fully the destination, the destination keeps its own alpha.
+ *
+ *      Every draw adds the rectangle it touched to the destination surface's dirty list. The
+ *      list holds BSP_GRAPHICS_MAX_DIRTY rectangles, overlapping and touching ones are merged,
+ *      and when it is full the new rectangle is merged with whichever one grows the least.
+ *
+ *      Double buffering: draw on BSP_Graphics_Display_Get_Back, then call
+ *      BSP_Graphics_Display_Present. That shows the back page, then copies just the dirty
+ *      rectangles into the other page, which becomes the new back page. Each page is then the
+ *      whole picture, so a frame only has to draw what changed since the last one.
+ *
+ *      The built in font is 5x7 in a 6x8 cell, printable ASCII only.
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#ifndef BSP_GRAPHICS_H_INCLUDED
+#define BSP_GRAPHICS_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Graphics Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_GRAPHICS_MAX_DIRTY          16u     // dirty rectangles kept per surface
+#define BSP_GRAPHICS_FONT_WIDTH         6u      // pixels per character cell, including the gap
+#define BSP_GRAPHICS_FONT_HEIGHT        8u
+
+#define BSP_GRAPHICS_ARGB(a, r, g, b)   ((((uint32_t)(a)) << 24u) | (((uint32_t)(r)) << 16u) | (((uint32_t)(g)) << 8u) | ((uint32_t)(b)))
+#define BSP_GRAPHICS_RGB(r, g, b)       BSP_GRAPHICS_ARGB(0xFFu, (r), (g), (b))
+#define BSP_GRAPHICS_TRANSPARENT        0x00000000u     // as a glyph background, leaves the pixels behind alone
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Graphics Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Graphics_Rect_Type
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t width;
+    uint32_t height;
+} BSP_Graphics_Rect_t;
+
+
+
+typedef struct Graphics_Surface_Type
+{
+    uint32_t * p_pixels;        // top left pixel
+    uint32_t width;
+    uint32_t height;
+    uint32_t pitch;             // pixels from the start of one line to the next
+
+    uint32_t num_dirty;
+    BSP_Graphics_Rect_t dirty[BSP_GRAPHICS_MAX_DIRTY];
+} BSP_Graphics_Surface_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Graphics Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Init_Surface
+
+Function Description:
+    Make a surface out of a block of pixels, with nothing dirty.
+
+Inputs:
+    p_surface: the surface to fill in
+    p_pixels: the top left pixel, word aligned
+    width: pixels per line
+    height: lines
+    pitch: pixels from the start of one line to the next, at least width
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Graphics_Init_Surface(BSP_Graphics_Surface_t * p_surface, uint32_t * p_pixels,
+                               uint32_t width, uint32_t height, uint32_t pitch);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Fill
+
+Function Description:
+    Fill a rectangle with one color, alpha included (there is no blending).
+
+Inputs:
+    p_surface: where to draw
+    x, y: top left of the rectangle
+    width, height: size of the rectangle
+    color: 0xAARRGGBB
+
+Returns:
+    None
+
+Error Handling:
+    None, the rectangle is clipped to the surface.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Graphics_Fill(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                       uint32_t width, uint32_t height, uint32_t color);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Copy
+
+Function Description:
+    Copy a rectangle of pixels from one surface to another, or within one surface (to
+    scroll, say, any overlap is handled).
+
+Inputs:
+    p_dest: where to draw
+    x, y: where the top left of the rectangle goes on p_dest
+    p_src: where the pixels come from
+    src_x, src_y: top left of the rectangle on p_src
+    width, height: size of the rectangle
+
+Returns:
+    None
+
+Error Handling:
+    None, the rectangle is clipped to both surfaces.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Graphics_Copy(BSP_Graphics_Surface_t * p_dest, int32_t x, int32_t y,
+                       const BSP_Graphics_Surface_t * p_src, int32_t src_x, int32_t src_y,
+                       uint32_t width, uint32_t height);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Blend
+
+Function Description:
+    Draw a rectangle of pixels from one surface over another, mixed by the source alpha.
+
+Inputs:
+    p_dest: where to draw
+    x, y: where the top left of the rectangle goes on p_dest
+    p_src: where the pixels come from, a different surface than p_dest
+    src_x, src_y: top left of the rectangle on p_src
+    width, height: size of the rectangle
+
+Returns:
+    None
+
+Error Handling:
+    None, the rectangle is clipped to both surfaces.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Graphics_Blend(BSP_Graphics_Surface_t * p_dest, int32_t x, int32_t y,
+                        const BSP_Graphics_Surface_t * p_src, int32_t src_x, int32_t src_y,
+                        uint32_t width, uint32_t height);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Draw_Glyph
+
+Function Description:
+    Draw a 1 bit per pixel glyph, up to 8 pixels wide: set bits in the foreground color and
+    clear bits in the background color.
+
+Inputs:
+    p_surface: where to draw
+    x, y: top left of the glyph
+    p_rows: one byte per row, bit 7 is the leftmost pixel
+    width: pixels per row to draw, 1...8
+    height: rows
+    foreground: color of set bits
+    background: color of clear bits, or BSP_GRAPHICS_TRANSPARENT to leave them alone
+
+Returns:
+    None
+
+Error Handling:
+    None, the glyph is clipped to the surface.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Graphics_Draw_Glyph(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                             const uint8_t * p_rows, uint32_t width, uint32_t height,
+                             uint32_t foreground, uint32_t background);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Draw_Text
+
+Function Description:
+    Draw a string in the built in font, a BSP_GRAPHICS_FONT_WIDTH by BSP_GRAPHICS_FONT_HEIGHT
+    cell per character. '\n' starts a new line back at x.
+
+Inputs:
+    p_surface: where to draw
+    x, y: top left of the first character
+    p_text: nul terminated string, characters outside printable ASCII are drawn as '?'
+    foreground: color of the text
+    background: color of the rest of each cell, or BSP_GRAPHICS_TRANSPARENT
+
+Returns:
+    int32_t: x just after the last character, to carry on from
+
+Error Handling:
+    None, the text is clipped to the surface.
+
+-------------------------------------------------------------------------------------------------*/
+int32_t BSP_Graphics_Draw_Text(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                               const char * p_text, uint32_t foreground, uint32_t background);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Mark_Dirty
+
+Function Description:
+    Add a rectangle to a surface's dirty list, for pixels changed without BSP_Graphics.
+
+Inputs:
+    p_surface: the surface
+    x, y: top left of the rectangle
+    width, height: size of the rectangle
+
+Returns:
+    None
+
+Error Handling:
+    None, the rectangle is clipped to the surface.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Graphics_Mark_Dirty(BSP_Graphics_Surface_t * p_surface, int32_t x, int32_t y,
+                             uint32_t width, uint32_t height);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Display_Init
+
+Function Description:
+    Get a double buffered framebuffer from PSP_Framebuffer, and clear both pages to black.
+
+Inputs:
+    width, height: display size in pixels
+
+Returns:
+    uint32_t: 1 if the display is ready, 0 otherwise
+
+Error Handling:
+    Returns 0 if PSP_Framebuffer_Init fails. With only one page from the firmware the display
+    still works, drawing shows straight away and BSP_Graphics_Display_Present just clears the
+    dirty list.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Graphics_Display_Init(uint32_t width, uint32_t height);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Display_Get_Back
+
+Function Description:
+    Get the surface to draw the next frame on. It changes with every
+    BSP_Graphics_Display_Present.
+
+Inputs:
+    None
+
+Returns:
+    BSP_Graphics_Surface_t *: the back page
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+BSP_Graphics_Surface_t * BSP_Graphics_Display_Get_Back(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Graphics_Display_Present
+
+Function Description:
+    Show the back page, and bring the other page up to date by copying the back page's dirty
+    rectangles into it. The other page is the back page from then on.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: the number of pixels copied between pages
+
+Error Handling:
+    If the firmware doesn't take the flip, nothing is copied and the back page stays the same.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Graphics_Display_Present(void);
+
+#endif
@@ -0,0 +1,220 @@
+
+#include "BSP_Logic_Analyzer.h"
+#include "PSP_GPIO.h"
+#include "PSP_DMA.h"
+#include "PSP_PWM.h"
+#include "PSP_Time.h"
+#include "PSP_Cache.h"
+#include "PSP_Aux_Mini_UART.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Logic_Analyzer Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// Register Addresses
+#define LA_GPLEV0_A          (PSP_GPIO_GPLEV_BANK_A)                   // GPIO Pin Level 0 address
+
+// Register Pointers
+#define LA_GPLEV0_R          (*((volatile uint32_t *)LA_GPLEV0_A))     // GPIO Pin Level 0 register
+
+#define LA_DMA_CHANNEL       5u                                        // see the channel list in PSP_DMA.h
+#define LA_PWM_CLOCK_DIV     5u                                        // PLLD / 5, 100MHz on the Pi 1 and 3
+#define LA_PWM_CLOCK_HZ      (PSP_REGS_PLLD_CLOCK_HZ / LA_PWM_CLOCK_DIV)
+#define LA_PWM_MIN_RANGE     2u
+
+#define LA_REPEAT_FLAG       0x80000000u                               // marks a repeat count in compressed data
+#define LA_LEVELS_MASK       0x7FFFFFFFu                               // GPIO 0...30 in a compressed sample
+
+#define LA_UNROLL            8u                                        // samples per pass of the CPU capture loop
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Logic_Analyzer Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// each sample is a pair of control blocks, one copies GPLEV0 to the buffer and
+// one writes a dummy word to the PWM FIFO, which holds the DMA until the next DREQ
+static PSP_DMA_Control_Block_t la_control_blocks[2u * BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES];
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_Logic_Analyzer Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+static void LA_Wait_For_Trigger(uint32_t trigger_mask, uint32_t trigger_value)
+{
+    trigger_value &= trigger_mask;
+
+    while ((LA_GPLEV0_R & trigger_mask) != trigger_value)
+    {
+        // wait for the trigger pins to reach the trigger levels
+    }
+}
+
+
+
+uint32_t BSP_Logic_Analyzer_Capture_CPU(uint32_t * p_buffer, uint32_t num_samples, 
+                                        uint32_t trigger_mask, uint32_t trigger_value)
+{
+    uint32_t * p_sample = p_buffer;
+    uint32_t * const P_UNROLLED_END = p_buffer + (num_samples - (num_samples % LA_UNROLL));
+    uint32_t * const P_END = p_buffer + num_samples;
+
+    // with the instruction cache off every pass of the loop would refetch the loop from RAM
+    PSP_Cache_Enable_Instruction_Cache();
+
+    LA_Wait_For_Trigger(trigger_mask, trigger_value);
+
+    uint64_t start_time = PSP_Time_Get_Ticks();
+
+    // unrolled so that nearly every cycle goes to reading GPLEV0 rather than loop overhead
+    while (p_sample < P_UNROLLED_END)
+    {
+        p_sample[0] = LA_GPLEV0_R;
+        p_sample[1] = LA_GPLEV0_R;
+        p_sample[2] = LA_GPLEV0_R;
+        p_sample[3] = LA_GPLEV0_R;
+        p_sample[4] = LA_GPLEV0_R;
+        p_sample[5] = LA_GPLEV0_R;
+        p_sample[6] = LA_GPLEV0_R;
+        p_sample[7] = LA_GPLEV0_R;
+        p_sample += LA_UNROLL;
+    }
+
+    while (p_sample < P_END)
+    {
+        *p_sample = LA_GPLEV0_R;
+        p_sample++;
+    }
+
+    uint64_t elapsed_uSec = PSP_Time_Get_Ticks() - start_time;
+
+    if (elapsed_uSec == 0u)
+    {
+        elapsed_uSec = 1u; // faster than the timer can see, call it 1 uSec
+    }
+
+    return (uint32_t)(((uint64_t)num_samples * 1000000u) / elapsed_uSec);
+}
+
+
+
+uint32_t BSP_Logic_Analyzer_Start_DMA(uint32_t * p_buffer, uint32_t num_samples, uint32_t sample_rate_hz,
+                                      uint32_t trigger_mask, uint32_t trigger_value)
+{
+    if ((num_samples == 0u) || (BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES < num_samples) || (sample_rate_hz == 0u))
+    {
+        return 0u; // nothing sensible to capture
+    }
+
+    // pick the PWM range closest to the requested sample rate
+    uint32_t range = (LA_PWM_CLOCK_HZ + (sample_rate_hz / 2u)) / sample_rate_hz;
+
+    if (range < LA_PWM_MIN_RANGE)
+    {
+        range = LA_PWM_MIN_RANGE;
+    }
+
+    const uint32_t GPLEV0_BUS_ADDRESS = PSP_DMA_Peripheral_Bus_Address(LA_GPLEV0_A);
+    const uint32_t SAMPLE_TI = PSP_DMA_TI_NO_WIDE_BURSTS | PSP_DMA_TI_WAIT_RESP;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        PSP_DMA_Control_Block_t * p_sample_block = &la_control_blocks[2u * i];
+        PSP_DMA_Control_Block_t * p_pacer_block = &la_control_blocks[(2u * i) + 1u];
+
+        // copy GPLEV0 into the buffer, then wait for the PWM to ask for another word
+        PSP_DMA_Fill_Control_Block(p_sample_block, SAMPLE_TI, GPLEV0_BUS_ADDRESS, PSP_DMA_Bus_Address(&p_buffer[i]),
+                                   sizeof(uint32_t), p_pacer_block);
+        PSP_PWM_DMA_Pacer_Fill_Control_Block(p_pacer_block, 1u, p_pacer_block + 1);
+    }
+
+    // end the chain after the last sample
+    la_control_blocks[(2u * num_samples) - 1u].next_control_block = 0u;
+
+    PSP_PWM_Clock_Init(PSP_PWM_Clock_Source_PLL_D, LA_PWM_CLOCK_DIV);
+    PSP_PWM_DMA_Pacer_Start(range);
+
+    LA_Wait_For_Trigger(trigger_mask, trigger_value);
+
+    PSP_DMA_Channel_Start(LA_DMA_CHANNEL, &la_control_blocks[0]);
+
+    return LA_PWM_CLOCK_HZ / range;
+}
+
+
+
+void BSP_Logic_Analyzer_Wait_DMA(void)
+{
+    PSP_DMA_Channel_Wait(LA_DMA_CHANNEL);
+    PSP_PWM_DMA_Pacer_Stop();
+}
+
+
+
+/**
+ * the compressed output can never overtake the input: a run of 1 sample becomes 1 word
+ * and a longer run becomes 2 words, so every word is written to a position that has 
+ * already been read
+ */
+uint32_t BSP_Logic_Analyzer_Compress(uint32_t * p_buffer, uint32_t num_samples)
+{
+    uint32_t num_words = 0u;
+    uint32_t sample_index = 0u;
+
+    while (sample_index < num_samples)
+    {
+        const uint32_t LEVELS = p_buffer[sample_index] & LA_LEVELS_MASK;
+        uint32_t run_length = 1u;
+
+        // count how many samples in a row have the same levels
+        while (((sample_index + run_length) < num_samples) && 
+               ((p_buffer[sample_index + run_length] & LA_LEVELS_MASK) == LEVELS))
+        {
+            run_length++;
+        }
+
+        p_buffer[num_words] = LEVELS;
+        num_words++;
+
+        if (run_length > 1u)
+        {
+            p_buffer[num_words] = LA_REPEAT_FLAG | (run_length - 1u);
+            num_words++;
+        }
+
+        sample_index += run_length;
+    }
+
+    return num_words;
+}
+
+
+
+void BSP_Logic_Analyzer_Export(const uint32_t * p_buffer, uint32_t num_words, uint32_t sample_rate_hz, uint32_t pin_mask)
+{
+    PSP_AUX_Mini_Uart_Send_String("LA ");
+    PSP_AUX_Mini_Uart_Send_Decimal(sample_rate_hz);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Hex(pin_mask & LA_LEVELS_MASK);
+    PSP_AUX_Mini_Uart_Send_String("\r\n");
+
+    for (uint32_t i = 0u; i < num_words; i++)
+    {
+        if (p_buffer[i] & LA_REPEAT_FLAG)
+        {
+            PSP_AUX_Mini_Uart_Send_Byte('R');
+            PSP_AUX_Mini_Uart_Send_Decimal(p_buffer[i] & LA_LEVELS_MASK);
+        }
+        else
+        {
+            PSP_AUX_Mini_Uart_Send_Hex(p_buffer[i] & pin_mask);
+        }
+
+        PSP_AUX_Mini_Uart_Send_String("\r\n");
+    }
+
+    PSP_AUX_Mini_Uart_Send_String("END\r\n");
+}
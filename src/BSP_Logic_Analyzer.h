@@ -0,0 +1,193 @@
+/**
+ * DESCRIPTION:
+ *      BSP_Logic_Analyzer turns the Pi into its own logic analyzer. GPIO pins 0...30 are 
+ *      sampled into a RAM buffer by reading the whole GPLEV0 register at once, the buffer can
+ *      be run-length compressed in place, and then dumped via mini uart Tx in a text format that
+ *      tools/la_to_vcd.py turns into a VCD file for GTKWave, PulseView, etc.
+ * 
+ * NOTES:
+ *      There are two ways to capture:
+ * 
+ *      CPU - an unrolled loop reads GPLEV0 as fast as the bus allows with the instruction
+ *            cache on. This is the fastest, but the CPU is busy for the whole capture and the
+ *            sample rate is only known on average (it is measured with the System Timer).
+ * 
+ *      DMA - DMA channel 5 copies GPLEV0 into the buffer, one sample per PWM DREQ, so the
+ *            sample rate is set by the PWM clock (PLLD / 5) and the CPU is free to, say, run 
+ *            the SPI transfer being captured. Uses PWM channel 1 as the pacer, so PWM channel 1 
+ *            can't be used at the same time. Each sample costs two DMA control blocks, which
+ *            limits the DMA capture length to BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES.
+ * 
+ *      Both wait for a trigger before capturing: the capture starts once 
+ *      (GPLEV0 & trigger_mask) == trigger_value. A trigger_mask of 0 starts immediately.
+ *      The trigger is checked by the CPU, so there are a few samples worth of latency.
+ * 
+ *      Compressed buffer format, one 32 bit word per entry:
+ *          bit 31 clear - a sample, bits 0...30 are the levels of GPIO 0...30
+ *          bit 31 set   - the previous sample repeated (word & 0x7FFFFFFF) more times
+ * 
+ *      GPIO 31 isn't on the header, so its bit is given up to mark the repeats.
+ * 
+ *      Export format, ASCII lines ending in \r\n:
+ *          LA <sample rate in Hz> <pin mask in hex>
+ *          <sample in hex>
+ *          R<repeat count in decimal>
+ *          ...
+ *          END
+ * 
+ * REFERENCES:
+ *      BCM2837-ARM-Peripherals.pdf page 38 (DMA), page 96 (GPLEV), page 138 (PWM)
+ *      VCD format: IEEE 1364-2005 section 18
+ */
+
+#ifndef BSP_LOGIC_ANALYZER_H_INCLUDED
+#define BSP_LOGIC_ANALYZER_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Logic_Analyzer Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES 4096u         // longest DMA capture, 2 control blocks (64 bytes) per sample
+#define BSP_LOGIC_ANALYZER_HEADER_PINS     0x0FFFFFFFu   // GPIO 0...27, the pins on the 40 pin header
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Logic_Analyzer Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Logic_Analyzer_Capture_CPU
+
+Function Description:
+    Wait for the trigger, then fill a buffer with GPLEV0 samples as fast as possible. Turns on
+    the instruction cache (and leaves it on).
+
+Inputs:
+    p_buffer: where to put the samples, one uint32_t per sample
+    num_samples: number of samples to take
+    trigger_mask: pins to trigger on, 0 to start immediately
+    trigger_value: levels of the trigger_mask pins to start on
+
+Returns:
+    uint32_t: the average sample rate in Hz
+
+Error Handling:
+    Never returns if the trigger condition never happens.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Logic_Analyzer_Capture_CPU(uint32_t * p_buffer, uint32_t num_samples, 
+                                        uint32_t trigger_mask, uint32_t trigger_value);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Logic_Analyzer_Start_DMA
+
+Function Description:
+    Set up the PWM pacer and the DMA control blocks, wait for the trigger, then start a DMA 
+    capture into a buffer and return while it runs. Call BSP_Logic_Analyzer_Wait_DMA before
+    using the buffer.
+
+Inputs:
+    p_buffer: where to put the samples, one uint32_t per sample
+    num_samples: number of samples to take, at most BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES
+    sample_rate_hz: requested sample rate, rounded to the nearest whole PWM range
+    trigger_mask: pins to trigger on, 0 to start immediately
+    trigger_value: levels of the trigger_mask pins to start on
+
+Returns:
+    uint32_t: the sample rate in Hz that the pacer was actually set to. The DMA engine can fall
+    behind the pacer at high rates, so check against the time the capture took.
+
+Error Handling:
+    Returns 0 without capturing if num_samples is 0 or more than BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES,
+    or if sample_rate_hz is 0.
+
+    Never returns if the trigger condition never happens.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Logic_Analyzer_Start_DMA(uint32_t * p_buffer, uint32_t num_samples, uint32_t sample_rate_hz,
+                                      uint32_t trigger_mask, uint32_t trigger_value);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Logic_Analyzer_Wait_DMA
+
+Function Description:
+    Wait for a DMA capture to finish, then stop the PWM pacer.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Logic_Analyzer_Wait_DMA(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Logic_Analyzer_Compress
+
+Function Description:
+    Run-length compress a buffer of samples in place, into the compressed format described at
+    the top of this file. Bit 31 (GPIO 31) of every sample is dropped.
+
+Inputs:
+    p_buffer: the samples to compress
+    num_samples: number of samples in the buffer
+
+Returns:
+    uint32_t: number of words of compressed data now at the start of the buffer, never more 
+    than num_samples
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Logic_Analyzer_Compress(uint32_t * p_buffer, uint32_t num_samples);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Logic_Analyzer_Export
+
+Function Description:
+    Send a compressed capture via mini uart Tx in the export format described at the top of
+    this file. The mini uart must already be initialized.
+
+Inputs:
+    p_buffer: the compressed capture
+    num_words: number of words of compressed data
+    sample_rate_hz: sample rate of the capture, for the time scale of the VCD file
+    pin_mask: the pins to show in the VCD file, e.g. BSP_LOGIC_ANALYZER_HEADER_PINS
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Logic_Analyzer_Export(const uint32_t * p_buffer, uint32_t num_words, uint32_t sample_rate_hz, uint32_t pin_mask);
+
+#endif
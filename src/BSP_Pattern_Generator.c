@@ -0,0 +1,160 @@
+
+#include "BSP_Pattern_Generator.h"
+#include "PSP_GPIO.h"
+#include "PSP_DMA.h"
+#include "PSP_PWM.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Pattern_Generator Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PATTERN_DMA_CHANNEL      4u                                        // see the channel list in PSP_DMA.h
+#define PATTERN_PWM_CLOCK_DIV    5u                                        // PLLD / 5, 100MHz on the Pi 1 and 3
+#define PATTERN_PWM_CLOCK_HZ     (PSP_REGS_PLLD_CLOCK_HZ / PATTERN_PWM_CLOCK_DIV)
+#define PATTERN_PWM_MIN_RANGE    2u
+
+#define PATTERN_NUM_PINS         32u                                       // GPIO 0...31, everything GPSET0/GPCLR0 reach
+
+// GPSET0, GPSET1, reserved, GPCLR0 - one 16 byte write covers both masks
+#define PATTERN_GPIO_WRITE_WORDS 4u
+#define PATTERN_SET_WORD         0u
+#define PATTERN_CLEAR_WORD       3u
+
+// 2 words to line the first step up with a tick, then up to 2 control blocks per step
+#define PATTERN_NUM_CONTROL_BLOCKS (1u + (2u * BSP_PATTERN_GENERATOR_MAX_STEPS))
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Pattern_Generator Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static PSP_DMA_Control_Block_t pattern_control_blocks[PATTERN_NUM_CONTROL_BLOCKS];
+
+// the words each step writes to GPSET0...GPCLR0
+static uint32_t pattern_gpio_words[BSP_PATTERN_GENERATOR_MAX_STEPS][PATTERN_GPIO_WRITE_WORDS];
+
+static uint32_t pattern_pwm_range;   // 0 when no pattern is loaded
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_Pattern_Generator Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+uint32_t BSP_Pattern_Generator_Load(const BSP_Pattern_Generator_Step_t * p_steps, uint32_t num_steps,
+                                    uint32_t tick_nSec, uint32_t loop)
+{
+    if ((num_steps == 0u) || (BSP_PATTERN_GENERATOR_MAX_STEPS < num_steps))
+    {
+        return 0u; // nothing to play, or too much
+    }
+
+    // the PWM range (clocks per tick) closest to the requested tick
+    const uint32_t RANGE = (uint32_t)((((uint64_t)tick_nSec * PATTERN_PWM_CLOCK_HZ) + 500000000u) / 1000000000u);
+
+    if (RANGE < PATTERN_PWM_MIN_RANGE)
+    {
+        return 0u; // faster than the pacer can tick
+    }
+
+    for (uint32_t i = 0u; i < num_steps; i++)
+    {
+        if (BSP_PATTERN_GENERATOR_MAX_DELAY_TICKS < p_steps[i].delay_ticks)
+        {
+            return 0u; // more words than one control block can write
+        }
+    }
+
+    BSP_Pattern_Generator_Stop();
+
+    const uint32_t GPSET0_BUS_ADDRESS = PSP_DMA_Peripheral_Bus_Address(PSP_GPIO_GPSET_BANK_A);
+
+    const uint32_t GPIO_TI = PSP_DMA_TI_NO_WIDE_BURSTS | PSP_DMA_TI_WAIT_RESP
+                           | PSP_DMA_TI_SRC_INC | PSP_DMA_TI_DEST_INC;
+
+    uint32_t used_pins = 0u;
+    PSP_DMA_Control_Block_t * p_block = &pattern_control_blocks[0];
+
+    // the pacer starts with an empty FIFO, so the first word goes straight in and the second
+    // waits for a tick, after this every step starts right on a tick
+    PSP_PWM_DMA_Pacer_Fill_Control_Block(p_block, 2u, p_block + 1);
+    p_block++;
+
+    PSP_DMA_Control_Block_t * const P_FIRST_STEP_BLOCK = p_block;
+
+    for (uint32_t i = 0u; i < num_steps; i++)
+    {
+        pattern_gpio_words[i][PATTERN_SET_WORD] = p_steps[i].set_mask;
+        pattern_gpio_words[i][1] = 0u;  // GPSET1, writing 0 changes nothing
+        pattern_gpio_words[i][2] = 0u;  // reserved
+        pattern_gpio_words[i][PATTERN_CLEAR_WORD] = p_steps[i].clear_mask;
+
+        used_pins |= p_steps[i].set_mask | p_steps[i].clear_mask;
+
+        PSP_DMA_Fill_Control_Block(p_block, GPIO_TI, PSP_DMA_Bus_Address(pattern_gpio_words[i]), GPSET0_BUS_ADDRESS,
+                                   PATTERN_GPIO_WRITE_WORDS * sizeof(uint32_t), p_block + 1);
+        p_block++;
+
+        if (p_steps[i].delay_ticks != 0u)
+        {
+            PSP_PWM_DMA_Pacer_Fill_Control_Block(p_block, p_steps[i].delay_ticks, p_block + 1);
+            p_block++;
+        }
+    }
+
+    // p_block is one past the last control block of the last step
+    (p_block - 1)->next_control_block = loop ? PSP_DMA_Bus_Address(P_FIRST_STEP_BLOCK) : 0u;
+
+    for (uint32_t pin = 0u; pin < PATTERN_NUM_PINS; pin++)
+    {
+        if (used_pins & (1u << pin))
+        {
+            PSP_GPIO_Set_Pin_Mode(pin, PSP_GPIO_PINMODE_OUTPUT);
+        }
+    }
+
+    pattern_pwm_range = RANGE;
+
+    return (uint32_t)(((uint64_t)RANGE * 1000000000u) / PATTERN_PWM_CLOCK_HZ);
+}
+
+
+
+void BSP_Pattern_Generator_Start(void)
+{
+    if (pattern_pwm_range == 0u)
+    {
+        return; // nothing loaded
+    }
+
+    PSP_DMA_Channel_Stop(PATTERN_DMA_CHANNEL);
+
+    PSP_PWM_Clock_Init(PSP_PWM_Clock_Source_PLL_D, PATTERN_PWM_CLOCK_DIV);
+    PSP_PWM_DMA_Pacer_Start(pattern_pwm_range);
+
+    PSP_DMA_Channel_Start(PATTERN_DMA_CHANNEL, &pattern_control_blocks[0]);
+}
+
+
+
+uint32_t BSP_Pattern_Generator_Is_Playing(void)
+{
+    return PSP_DMA_Channel_Is_Active(PATTERN_DMA_CHANNEL);
+}
+
+
+
+void BSP_Pattern_Generator_Wait(void)
+{
+    PSP_DMA_Channel_Wait(PATTERN_DMA_CHANNEL);
+    PSP_PWM_DMA_Pacer_Stop();
+}
+
+
+
+void BSP_Pattern_Generator_Stop(void)
+{
+    PSP_DMA_Channel_Stop(PATTERN_DMA_CHANNEL);
+    PSP_PWM_DMA_Pacer_Stop();
+}
@@ -0,0 +1,189 @@
+/**
+ * DESCRIPTION:
+ *      BSP_Pattern_Generator plays back a timeline of GPIO changes with DMA, for bit-banging
+ *      protocols that the hardware peripherals don't cover (shift register chains, parallel LCD
+ *      buses, stepper pulse trains, ...) with tighter, steadier timing than a CPU loop.
+ *
+ * NOTES:
+ *      A pattern is an array of steps. Each step drives its set_mask pins high, then its
+ *      clear_mask pins low, then holds for delay_ticks ticks before the next step. The set and
+ *      clear are separate register writes, so the cleared pins change a few bus cycles after
+ *      the set ones: don't rely on a pin going high and another going low at exactly the same
+ *      instant. BSP_Pattern_Generator_Load compiles the steps into DMA control blocks once, and the
+ *      pattern can then be played as many times as needed, or looped forever, with no CPU
+ *      involvement.
+ *
+ *      Each step becomes at most two control blocks:
+ *          - a 16 byte write of { set_mask, 0, 0, clear_mask } to GPSET0, GPSET1, (reserved)
+ *            and GPCLR0, which are next to each other, so both masks go out with one control
+ *            block load instead of two, though still as separate writes to GPSET0 and GPCLR0
+ *          - if delay_ticks isn't 0, a delay_ticks word write to the PWM FIFO, which the PWM
+ *            DREQ lets through at one word per tick
+ *
+ *      Ticks come from PWM channel 1 used as a pacer (see PSP_PWM_DMA_Pacer_Start), the tick
+ *      length is a whole number of PWM clocks (PLLD / 5, 10nS on the Pi 1 and 3, 6.67nS on the
+ *      Pi 4). Steps land on the tick grid as long as the DMA can write the masks within one
+ *      tick. A delay of 0 runs the next step as soon as the DMA gets to it, which is the
+ *      fastest possible edge rate but isn't on the tick grid. bench_Pattern_Generator measures
+ *      what is achievable.
+ *
+ *      Uses DMA channel 4 and PWM channel 1, so it can't run at the same time as BSP_Soft_PWM or
+ *      a BSP_Logic_Analyzer DMA capture. A BSP_Logic_Analyzer CPU capture works fine, and is a
+ *      good way to check a pattern.
+ *
+ *      Only GPIO 0...31 can be driven, the pins in any set_mask or clear_mask are made outputs
+ *      by BSP_Pattern_Generator_Load.
+ *
+ * REFERENCES:
+ *      BCM2837-ARM-Peripherals.pdf page 38 (DMA), page 90 (GPSET/GPCLR), page 138 (PWM)
+ */
+
+#ifndef BSP_PATTERN_GENERATOR_H_INCLUDED
+#define BSP_PATTERN_GENERATOR_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Pattern_Generator Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_PATTERN_GENERATOR_MAX_STEPS        1024u        // longest pattern, up to 2 control blocks (64 bytes) per step
+#define BSP_PATTERN_GENERATOR_MAX_DELAY_TICKS  0x0FFFFFFFu  // longest delay of one step, the DMA transfer length limit
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Pattern_Generator Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Pattern_Generator_Step_Type
+{
+    uint32_t set_mask;     // GPIO 0...31 pins to drive high, bit n for GPIO n
+    uint32_t clear_mask;   // GPIO 0...31 pins to drive low
+    uint32_t delay_ticks;  // ticks to hold before the next step, 0 for as soon as possible
+} BSP_Pattern_Generator_Step_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Pattern_Generator Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Pattern_Generator_Load
+
+Function Description:
+    Compile a pattern into DMA control blocks and make its pins outputs. Stops a pattern that
+    is already playing. The steps are copied, so the array doesn't need to stay around.
+
+Inputs:
+    p_steps: the steps of the pattern
+    num_steps: number of steps, at most BSP_PATTERN_GENERATOR_MAX_STEPS
+    tick_nSec: requested tick length, rounded to the nearest whole number of PWM clocks
+    loop: 0 to play the pattern once per BSP_Pattern_Generator_Start, anything else to play
+          it over and over until BSP_Pattern_Generator_Stop
+
+Returns:
+    uint32_t: the tick length in nSec that will actually be used
+
+Error Handling:
+    Returns 0 without loading anything if num_steps is 0 or too many, tick_nSec is shorter
+    than 2 PWM clocks, or a step's delay_ticks is more than BSP_PATTERN_GENERATOR_MAX_DELAY_TICKS.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Pattern_Generator_Load(const BSP_Pattern_Generator_Step_t * p_steps, uint32_t num_steps,
+                                    uint32_t tick_nSec, uint32_t loop);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Pattern_Generator_Start
+
+Function Description:
+    Start playing the loaded pattern and return while it plays.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    Does nothing if no pattern is loaded. Restarts the pattern from the first step if it is
+    already playing.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Pattern_Generator_Start(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Pattern_Generator_Is_Playing
+
+Function Description:
+    Check if the pattern is still playing. A looping pattern plays until it is stopped.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: non-zero while playing, 0 when done
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Pattern_Generator_Is_Playing(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Pattern_Generator_Wait
+
+Function Description:
+    Wait for a pattern played once to finish, then stop the PWM pacer.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    Never returns if the pattern loops, use BSP_Pattern_Generator_Stop instead.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Pattern_Generator_Wait(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Pattern_Generator_Stop
+
+Function Description:
+    Stop the pattern wherever it is and stop the PWM pacer. The pins keep their last levels.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Pattern_Generator_Stop(void);
+
+#endif
@@ -0,0 +1,242 @@
+#include "BSP_Profiler.h"
+#include "PSP_IRQ.h"
+#include "PSP_Time.h"
+#include "PSP_Aux_Mini_UART.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Profiler Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PROFILER_SLOT_MASK          (BSP_PROFILER_NUM_SLOTS - 1u)
+#define PROFILER_HASH_MULTIPLIER    0x9E3779B1u     // 2^32 / golden ratio, spreads nearby addresses
+#define PROFILER_MIN_LEAD_uSec      2u              // a compare closer than this may already have passed
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Profiler Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Profiler_Slot_Type
+{
+    uint32_t pc;
+    uint32_t lr;
+    uint32_t count;         // 0 for a free slot
+} Profiler_Slot_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Profiler Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static Profiler_Slot_t profiler_slots[BSP_PROFILER_NUM_SLOTS];
+
+static PSP_Time_Compare_Channel_t profiler_channel;
+static uint32_t profiler_running;
+static uint32_t profiler_period_uSec;
+static uint32_t profiler_next_compare;
+static uint64_t profiler_start_uSec;
+static uint64_t profiler_stop_uSec;
+
+static uint32_t profiler_samples;
+static uint32_t profiler_dropped;
+static uint32_t profiler_missed;
+static uint64_t profiler_total_cycles;
+static uint32_t profiler_max_cycles;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_Profiler Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+static void Profiler_Count(uint32_t pc, uint32_t lr)
+{
+    uint32_t hash = ((pc >> 2u) * PROFILER_HASH_MULTIPLIER) ^ (lr >> 2u);
+
+    hash ^= hash >> 16u;
+
+    for (uint32_t probe = 0u; probe < BSP_PROFILER_MAX_PROBES; probe++)
+    {
+        Profiler_Slot_t * const P_SLOT = &profiler_slots[(hash + probe) & PROFILER_SLOT_MASK];
+
+        if (P_SLOT->count == 0u)
+        {
+            P_SLOT->pc = pc;
+            P_SLOT->lr = lr;
+            P_SLOT->count = 1u;
+            profiler_samples++;
+            return;
+        }
+
+        if ((P_SLOT->pc == pc) && (P_SLOT->lr == lr))
+        {
+            P_SLOT->count++;
+            profiler_samples++;
+            return;
+        }
+    }
+
+    profiler_dropped++;
+}
+
+
+
+/**
+ * Set the next compare a period after the last one, or a period from now if that has passed.
+ */
+static void Profiler_Schedule(void)
+{
+    const uint32_t NOW = (uint32_t)PSP_Time_Get_Ticks();
+
+    profiler_next_compare += profiler_period_uSec;
+
+    if ((int32_t)(profiler_next_compare - NOW) < (int32_t)PROFILER_MIN_LEAD_uSec)
+    {
+        profiler_missed++;
+        profiler_next_compare = NOW + profiler_period_uSec;
+    }
+
+    PSP_Time_Set_Compare(profiler_channel, profiler_next_compare);
+}
+
+
+
+static void Profiler_Handler(void)
+{
+    uint32_t lr;
+    const uint32_t PC = PSP_IRQ_Get_Interrupted(&lr);
+
+    Profiler_Schedule();
+    Profiler_Count(PC, lr);
+
+    const uint32_t CYCLES = PSP_Time_Get_Cycles() - PSP_IRQ_Get_Entry_Cycles();
+
+    profiler_total_cycles += CYCLES;
+
+    if (CYCLES > profiler_max_cycles)
+    {
+        profiler_max_cycles = CYCLES;
+    }
+}
+
+
+
+uint32_t BSP_Profiler_Start(PSP_Time_Compare_Channel_t channel, uint32_t rate_hz)
+{
+    if ((rate_hz == 0u) || (BSP_PROFILER_MAX_RATE_HZ < rate_hz))
+    {
+        return 0u;
+    }
+
+    BSP_Profiler_Stop();
+
+    memset(profiler_slots, 0, sizeof(profiler_slots));
+    profiler_samples = 0u;
+    profiler_dropped = 0u;
+    profiler_missed = 0u;
+    profiler_total_cycles = 0u;
+    profiler_max_cycles = 0u;
+
+    profiler_channel = channel;
+    profiler_period_uSec = 1000000u / rate_hz;
+    profiler_start_uSec = PSP_Time_Get_Ticks();
+    profiler_next_compare = (uint32_t)profiler_start_uSec;
+    profiler_running = 1u;
+
+    // the channel number is its interrupt source too
+    PSP_IRQ_Attach((uint32_t)channel, Profiler_Handler);
+
+    const uint32_t STATE = PSP_IRQ_Disable();
+    Profiler_Schedule();
+    PSP_IRQ_Restore(STATE);
+
+    return profiler_period_uSec;
+}
+
+
+
+void BSP_Profiler_Stop(void)
+{
+    if (!profiler_running)
+    {
+        return;
+    }
+
+    PSP_IRQ_Detach((uint32_t)profiler_channel);
+    PSP_Time_Clear_Compare_Match(profiler_channel);
+
+    profiler_stop_uSec = PSP_Time_Get_Ticks();
+    profiler_running = 0u;
+}
+
+
+
+void BSP_Profiler_Get_Report(BSP_Profiler_Report_t * p_report)
+{
+    const uint32_t STATE = PSP_IRQ_Disable();
+
+    const uint64_t END_uSec = profiler_running ? PSP_Time_Get_Ticks() : profiler_stop_uSec;
+    const uint64_t TOTAL_CYCLES = profiler_total_cycles;
+    const uint32_t TAKEN = profiler_samples + profiler_dropped;
+
+    p_report->samples = profiler_samples;
+    p_report->dropped = profiler_dropped;
+    p_report->missed = profiler_missed;
+    p_report->max_cycles = profiler_max_cycles;
+
+    PSP_IRQ_Restore(STATE);
+
+    const uint64_t RUN_uSec = END_uSec - profiler_start_uSec;
+    const uint64_t RUN_CYCLES = (RUN_uSec * PSP_Time_Get_Cycles_Per_Millisecond()) / 1000u;
+
+    p_report->run_uSec = (uint32_t)RUN_uSec;
+    p_report->average_cycles = (TAKEN == 0u) ? 0u : (uint32_t)(TOTAL_CYCLES / TAKEN);
+    p_report->overhead_ppm = (RUN_CYCLES == 0u) ? 0u : (uint32_t)((TOTAL_CYCLES * 1000000u) / RUN_CYCLES);
+}
+
+
+
+void BSP_Profiler_Dump(void)
+{
+    BSP_Profiler_Report_t report;
+
+    BSP_Profiler_Get_Report(&report);
+
+    PSP_AUX_Mini_Uart_Send_String("PROFILE ");
+    PSP_AUX_Mini_Uart_Send_Decimal((profiler_period_uSec == 0u) ? 0u : (1000000u / profiler_period_uSec));
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.samples);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.dropped);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.missed);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.run_uSec);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.average_cycles);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.max_cycles);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.overhead_ppm);
+    PSP_AUX_Mini_Uart_Send_String("\r\n");
+
+    for (uint32_t slot = 0u; slot < BSP_PROFILER_NUM_SLOTS; slot++)
+    {
+        const Profiler_Slot_t * const P_SLOT = &profiler_slots[slot];
+
+        if (P_SLOT->count != 0u)
+        {
+            PSP_AUX_Mini_Uart_Send_Hex(P_SLOT->pc);
+            PSP_AUX_Mini_Uart_Send_String(" ");
+            PSP_AUX_Mini_Uart_Send_Hex(P_SLOT->lr);
+            PSP_AUX_Mini_Uart_Send_String(" ");
+            PSP_AUX_Mini_Uart_Send_Hex(P_SLOT->count);
+            PSP_AUX_Mini_Uart_Send_String("\r\n");
+        }
+    }
+
+    PSP_AUX_Mini_Uart_Send_String("END\r\n");
+}
@@ -0,0 +1,168 @@
+/**
+ * DESCRIPTION:
+ *      BSP_Profiler is a statistical profiler: a System Timer compare channel interrupts at a
+ *      steady rate and each interrupt counts where it struck. Dumped over the mini uart, the
+ *      counts are symbolized against bin/kernel.elf by tools/profile_report.py, which prints
+ *      flat (which function was running) and caller (who called it) profiles.
+ *
+ * NOTES:
+ *      Samples are counted in a hash table keyed on the interrupted pc and lr, so memory stays
+ *      fixed however long it runs. A pair that finds no slot within BSP_PROFILER_MAX_PROBES
+ *      probes is counted as dropped rather than searched for further, which keeps every
+ *      sample's cost bounded. The cost is measured too, from the IRQ entry to the end of the
+ *      handler, and reported as a share of the run (the IRQ exit, a few instructions, isn't
+ *      included).
+ *
+ *      Compares are scheduled from the last one, not from when the handler ran, so the rate
+ *      doesn't drift. A compare already in the past when it's scheduled (interrupts were masked
+ *      for longer than a period) is counted as missed, and the schedule starts again from now.
+ *
+ *      Things to keep in mind reading a profile:
+ *          - code that runs with IRQs masked (interrupt handlers, PSP_IRQ_Disable sections)
+ *            is never sampled, its samples land on the instruction after IRQs are unmasked
+ *          - the lr is the caller only for leaf functions, or before a function has reused
+ *            it, so the caller profile is a guide and the flat profile is exact
+ *          - a rate that divides a periodic task's rate will alias with it, pick one that
+ *            doesn't, e.g. 9973 rather than 10000 Hz
+ *
+ *      Dump format, the header in decimal, the rest in hex:
+ *          PROFILE <rate Hz> <samples> <dropped> <missed> <run uSec> <average cycles> <max cycles> <overhead ppm>
+ *          <pc> <lr> <count>                   one line per slot in use
+ *          END
+ *
+ *      Needs PSP_IRQ_Init to have run. The compare channel is not available for anything else
+ *      while profiling.
+ *
+ * REFERENCES:
+ *      gprof: https://sourceware.org/binutils/docs/gprof/
+ */
+
+#ifndef BSP_PROFILER_H_INCLUDED
+#define BSP_PROFILER_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+#include "PSP_Time.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Profiler Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_PROFILER_NUM_SLOTS          4096u       // distinct pc/lr pairs, a power of 2, 12 bytes each
+#define BSP_PROFILER_MAX_PROBES         8u          // most slots looked at per sample
+#define BSP_PROFILER_MAX_RATE_HZ        100000u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Profiler Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Profiler_Report_Type
+{
+    uint32_t samples;               // counted in the table
+    uint32_t dropped;               // taken, but no slot free
+    uint32_t missed;                // compares that had already passed when scheduled
+    uint32_t run_uSec;              // since BSP_Profiler_Start, or until BSP_Profiler_Stop
+    uint32_t average_cycles;        // cost of a sample, IRQ entry to the end of the handler
+    uint32_t max_cycles;
+    uint32_t overhead_ppm;          // share of the run spent sampling, parts per million
+} BSP_Profiler_Report_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Profiler Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Profiler_Start
+
+Function Description:
+    Clear the samples and start sampling. If the profiler is already running it is stopped
+    first.
+
+Inputs:
+    channel: the System Timer compare channel to interrupt with
+    rate_hz: samples per second, up to BSP_PROFILER_MAX_RATE_HZ
+
+Returns:
+    uint32_t: the sample period in uSec, 0 if rate_hz is out of range
+
+Error Handling:
+    Nothing is started for a rate of 0 or above BSP_PROFILER_MAX_RATE_HZ.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Profiler_Start(PSP_Time_Compare_Channel_t channel, uint32_t rate_hz);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Profiler_Stop
+
+Function Description:
+    Stop sampling, keeping the samples for BSP_Profiler_Dump.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Profiler_Stop(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Profiler_Get_Report
+
+Function Description:
+    Get the sample counts and what sampling has cost.
+
+Inputs:
+    p_report: where to put them
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Profiler_Get_Report(BSP_Profiler_Report_t * p_report);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Profiler_Dump
+
+Function Description:
+    Send the samples over the mini uart in the format at the top of this file, for
+    tools/profile_report.py. Best done after BSP_Profiler_Stop, a running profiler keeps
+    sampling the dump. The mini uart must be set up.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Profiler_Dump(void);
+
+#endif
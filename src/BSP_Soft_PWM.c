@@ -0,0 +1,210 @@
+
+#include "BSP_Soft_PWM.h"
+#include "PSP_GPIO.h"
+#include "PSP_DMA.h"
+#include "PSP_PWM.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Soft_PWM Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define SOFT_PWM_DMA_CHANNEL      10u                                       // see the channel list in PSP_DMA.h
+#define SOFT_PWM_PWM_CLOCK_DIV    5u                                        // PLLD / 5, 100MHz on the Pi 1 and 3
+#define SOFT_PWM_TICKS_PER_uSec   ((PSP_REGS_PLLD_CLOCK_HZ / SOFT_PWM_PWM_CLOCK_DIV) / 1000000u)
+
+#define SOFT_PWM_NUM_PINS         32u                                       // GPIO 0...31, everything GPSET0/GPCLR0 reach
+
+// control block 0 sets the pins, then every step has a clear block and a pacer block
+#define SOFT_PWM_NUM_CONTROL_BLOCKS (1u + (2u * BSP_SOFT_PWM_MAX_STEPS))
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Soft_PWM Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static PSP_DMA_Control_Block_t soft_pwm_control_blocks[SOFT_PWM_NUM_CONTROL_BLOCKS];
+
+// the words the control blocks copy to GPSET0 and GPCLR0, volatile so that the order of the
+// updates in Soft_PWM_Update_Width is kept
+static volatile uint32_t soft_pwm_set_mask;
+static volatile uint32_t soft_pwm_clear_masks[BSP_SOFT_PWM_MAX_STEPS];
+
+static uint32_t soft_pwm_widths[SOFT_PWM_NUM_PINS];
+static uint32_t soft_pwm_pins;
+static uint32_t soft_pwm_num_steps;
+static uint32_t soft_pwm_step_uSec;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_Soft_PWM Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * A pin with a width w of 1...num_steps-1 is in the set mask and in clear mask w. A width of 0
+ * is only in clear mask 0 (so the pin stays low), and a full width is only in the set mask.
+ *
+ * The new edge is added before the old one is removed, the DMA can read the masks at any point
+ * in between, and seeing both edges for one period just means the shorter pulse.
+ */
+static void Soft_PWM_Update_Width(uint32_t pin_num, uint32_t width_steps)
+{
+    const uint32_t PIN_MASK = 1u << pin_num;
+    const uint32_t OLD_WIDTH = soft_pwm_widths[pin_num];
+
+    if (soft_pwm_num_steps < width_steps)
+    {
+        width_steps = soft_pwm_num_steps;
+    }
+
+    if (width_steps == OLD_WIDTH)
+    {
+        return; // nothing to change
+    }
+
+    if (width_steps < soft_pwm_num_steps)
+    {
+        soft_pwm_clear_masks[width_steps] |= PIN_MASK;
+    }
+
+    if (width_steps == 0u)
+    {
+        soft_pwm_set_mask &= ~PIN_MASK;
+    }
+    else
+    {
+        soft_pwm_set_mask |= PIN_MASK;
+    }
+
+    if (OLD_WIDTH < soft_pwm_num_steps)
+    {
+        soft_pwm_clear_masks[OLD_WIDTH] &= ~PIN_MASK;
+    }
+
+    soft_pwm_widths[pin_num] = width_steps;
+}
+
+
+
+uint32_t BSP_Soft_PWM_Start(uint32_t pin_mask, uint32_t period_uSec, uint32_t step_uSec)
+{
+    if ((pin_mask == 0u) || (step_uSec < BSP_SOFT_PWM_MIN_STEP_uSec))
+    {
+        return 0u; // nothing to drive, or steps the DMA can't keep up with
+    }
+
+    const uint32_t NUM_STEPS = period_uSec / step_uSec;
+
+    if ((NUM_STEPS < 2u) || (BSP_SOFT_PWM_MAX_STEPS < NUM_STEPS))
+    {
+        return 0u; // period too short or too finely divided
+    }
+
+    BSP_Soft_PWM_Stop();
+
+    soft_pwm_pins = pin_mask;
+    soft_pwm_num_steps = NUM_STEPS;
+    soft_pwm_step_uSec = step_uSec;
+
+    // every pin starts at a width of 0, low and cleared at the start of every period
+    soft_pwm_set_mask = 0u;
+    soft_pwm_clear_masks[0] = pin_mask;
+
+    for (uint32_t step = 1u; step < NUM_STEPS; step++)
+    {
+        soft_pwm_clear_masks[step] = 0u;
+    }
+
+    for (uint32_t pin = 0u; pin < SOFT_PWM_NUM_PINS; pin++)
+    {
+        soft_pwm_widths[pin] = 0u;
+
+        if (pin_mask & (1u << pin))
+        {
+            PSP_GPIO_Write_Pin(pin, 0u);
+            PSP_GPIO_Set_Pin_Mode(pin, PSP_GPIO_PINMODE_OUTPUT);
+        }
+    }
+
+    const uint32_t GPSET0_BUS_ADDRESS = PSP_DMA_Peripheral_Bus_Address(PSP_GPIO_GPSET_BANK_A);
+    const uint32_t GPCLR0_BUS_ADDRESS = PSP_DMA_Peripheral_Bus_Address(PSP_GPIO_GPCLR_BANK_A);
+
+    const uint32_t GPIO_TI = PSP_DMA_TI_NO_WIDE_BURSTS | PSP_DMA_TI_WAIT_RESP;
+
+    PSP_DMA_Fill_Control_Block(&soft_pwm_control_blocks[0], GPIO_TI, PSP_DMA_Bus_Address(&soft_pwm_set_mask),
+                               GPSET0_BUS_ADDRESS, sizeof(uint32_t), &soft_pwm_control_blocks[1]);
+
+    for (uint32_t step = 0u; step < NUM_STEPS; step++)
+    {
+        PSP_DMA_Control_Block_t * p_clear_block = &soft_pwm_control_blocks[(2u * step) + 1u];
+        PSP_DMA_Control_Block_t * p_pacer_block = &soft_pwm_control_blocks[(2u * step) + 2u];
+
+        PSP_DMA_Fill_Control_Block(p_clear_block, GPIO_TI, PSP_DMA_Bus_Address(&soft_pwm_clear_masks[step]),
+                                   GPCLR0_BUS_ADDRESS, sizeof(uint32_t), p_pacer_block);
+        PSP_PWM_DMA_Pacer_Fill_Control_Block(p_pacer_block, 1u, p_pacer_block + 1);
+    }
+
+    // loop back to the set block after the last step
+    soft_pwm_control_blocks[2u * NUM_STEPS].next_control_block = PSP_DMA_Bus_Address(&soft_pwm_control_blocks[0]);
+
+    PSP_PWM_Clock_Init(PSP_PWM_Clock_Source_PLL_D, SOFT_PWM_PWM_CLOCK_DIV);
+    PSP_PWM_DMA_Pacer_Start(step_uSec * SOFT_PWM_TICKS_PER_uSec);
+
+    PSP_DMA_Channel_Start(SOFT_PWM_DMA_CHANNEL, &soft_pwm_control_blocks[0]);
+
+    return NUM_STEPS;
+}
+
+
+
+void BSP_Soft_PWM_Stop(void)
+{
+    if (soft_pwm_pins == 0u)
+    {
+        return; // not running
+    }
+
+    PSP_DMA_Channel_Stop(SOFT_PWM_DMA_CHANNEL);
+    PSP_PWM_DMA_Pacer_Stop();
+
+    ((volatile uint32_t *)PSP_GPIO_GPCLR_BANK_A)[0] = soft_pwm_pins;
+
+    soft_pwm_pins = 0u;
+}
+
+
+
+void BSP_Soft_PWM_Set_Width(uint32_t pin_num, uint32_t width_steps)
+{
+    if ((SOFT_PWM_NUM_PINS <= pin_num) || !(soft_pwm_pins & (1u << pin_num)))
+    {
+        return; // not a soft PWM pin
+    }
+
+    Soft_PWM_Update_Width(pin_num, width_steps);
+}
+
+
+
+void BSP_Soft_PWM_Set_Pulse_uSec(uint32_t pin_num, uint32_t pulse_uSec)
+{
+    if (soft_pwm_pins == 0u)
+    {
+        return; // not running, no step size to convert with
+    }
+
+    BSP_Soft_PWM_Set_Width(pin_num, (pulse_uSec + (soft_pwm_step_uSec / 2u)) / soft_pwm_step_uSec);
+}
+
+
+
+void BSP_Soft_PWM_Set_Duty(uint32_t pin_num, uint32_t duty)
+{
+    if (BSP_SOFT_PWM_DUTY_MAX < duty)
+    {
+        duty = BSP_SOFT_PWM_DUTY_MAX;
+    }
+
+    BSP_Soft_PWM_Set_Width(pin_num, ((duty * soft_pwm_num_steps) + (BSP_SOFT_PWM_DUTY_MAX / 2u)) / BSP_SOFT_PWM_DUTY_MAX);
+}
@@ -0,0 +1,182 @@
+/**
+ * DESCRIPTION:
+ *      BSP_Soft_PWM drives PWM on any of GPIO 0...31 at once, for dimming LEDs and driving
+ *      servos on more pins than the two hardware PWM channels can reach. The pulses are made
+ *      entirely by DMA, the CPU only gets involved when a pulse width changes.
+ *
+ * NOTES:
+ *      The PWM period is split into steps. DMA channel 10 runs an endless loop of control
+ *      blocks, one set of blocks per step:
+ *
+ *          start of the period - write the set mask to GPSET0, every pin with a pulse goes high
+ *          every step s        - write clear mask s to GPCLR0, every pin whose pulse is s steps
+ *                                long goes low
+ *                              - write a dummy word to the PWM FIFO, which holds the DMA until
+ *                                the next PWM DREQ, one step later
+ *
+ *      The set mask and clear masks are words in RAM that the control blocks read from, so
+ *      changing a pulse width only rewrites those mask words (at most three of them) and never
+ *      touches the control blocks or stops the DMA. A pulse width change takes effect at the
+ *      next period, and the period the change lands in gets either the old width, the new
+ *      width, or the shorter of the two, never a glitch.
+ *
+ *      Steps are paced with PWM channel 1 (see PSP_PWM_DMA_Pacer_Start), so while soft PWM is
+ *      running the PWM peripheral isn't available for PWM output, and the DMA capture of
+ *      BSP_Logic_Analyzer can't be used (the CPU capture still can).
+ *
+ *      Pins are only touched through GPSET0/GPCLR0, so the edges of every pin that switch on
+ *      the same step happen at the same moment.
+ *
+ *      Typical setups:
+ *          servos - 20000 uSec period, 10 uSec steps: 1000...2000 uSec pulses in 100 positions
+ *          LEDs   - 2000 uSec period, 8 uSec steps: 250 brightness levels at 500Hz
+ *
+ * REFERENCES:
+ *      BCM2837-ARM-Peripherals.pdf page 38 (DMA), page 90 (GPSET/GPCLR), page 138 (PWM)
+ *      pi-blaster, https://github.com/sarfata/pi-blaster
+ */
+
+#ifndef BSP_SOFT_PWM_H_INCLUDED
+#define BSP_SOFT_PWM_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Soft_PWM Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_SOFT_PWM_MAX_STEPS           2048u   // most steps per period, 2 control blocks (64 bytes) per step
+#define BSP_SOFT_PWM_MIN_STEP_uSec       2u      // shortest step, leaves the DMA time for its own control block loads
+#define BSP_SOFT_PWM_DUTY_MAX            1000u   // full scale of BSP_Soft_PWM_Set_Duty, duty is in 0.1% units
+
+#define BSP_SOFT_PWM_SERVO_PERIOD_uSec   20000u  // 50Hz, the period hobby servos expect
+#define BSP_SOFT_PWM_SERVO_STEP_uSec     10u     // 2000 steps per servo period
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Soft_PWM Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Soft_PWM_Start
+
+Function Description:
+    Set the pins in pin_mask to outputs driven low, build the DMA control block loop and start
+    it. Every pin starts with a pulse width of 0. If soft PWM is already running it is stopped
+    first.
+
+Inputs:
+    pin_mask: the GPIO 0...31 pins to drive, bit n for GPIO n
+    period_uSec: length of one PWM period
+    step_uSec: pulse width resolution, at least BSP_SOFT_PWM_MIN_STEP_uSec
+
+Returns:
+    uint32_t: the number of steps in a period, the full scale for BSP_Soft_PWM_Set_Width
+
+Error Handling:
+    Returns 0 without starting if pin_mask is 0, step_uSec is too short, or the period isn't
+    between 2 and BSP_SOFT_PWM_MAX_STEPS steps long.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Soft_PWM_Start(uint32_t pin_mask, uint32_t period_uSec, uint32_t step_uSec);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Soft_PWM_Stop
+
+Function Description:
+    Stop the DMA and the PWM pacer, and drive every soft PWM pin low. The pins are left as
+    outputs.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    Does nothing if soft PWM isn't running.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Soft_PWM_Stop(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Soft_PWM_Set_Width
+
+Function Description:
+    Set the pulse width of one pin in steps. 0 holds the pin low, the number of steps returned
+    by BSP_Soft_PWM_Start (or more) holds it high.
+
+Inputs:
+    pin_num: the pin to change, must have been in the pin_mask given to BSP_Soft_PWM_Start
+    width_steps: the pulse width in steps
+
+Returns:
+    None
+
+Error Handling:
+    Does nothing if the pin isn't one of the soft PWM pins. width_steps is limited to a full
+    period.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Soft_PWM_Set_Width(uint32_t pin_num, uint32_t width_steps);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Soft_PWM_Set_Pulse_uSec
+
+Function Description:
+    Set the pulse width of one pin in microseconds, rounded to the nearest step. Meant for
+    servos, e.g. 1500 uSec for the center position.
+
+Inputs:
+    pin_num: the pin to change, must have been in the pin_mask given to BSP_Soft_PWM_Start
+    pulse_uSec: the pulse width in microseconds
+
+Returns:
+    None
+
+Error Handling:
+    Same as BSP_Soft_PWM_Set_Width.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Soft_PWM_Set_Pulse_uSec(uint32_t pin_num, uint32_t pulse_uSec);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Soft_PWM_Set_Duty
+
+Function Description:
+    Set the duty cycle of one pin, rounded to the nearest step. Meant for LED dimming.
+
+Inputs:
+    pin_num: the pin to change, must have been in the pin_mask given to BSP_Soft_PWM_Start
+    duty: 0 (off) to BSP_SOFT_PWM_DUTY_MAX (always on)
+
+Returns:
+    None
+
+Error Handling:
+    Same as BSP_Soft_PWM_Set_Width.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Soft_PWM_Set_Duty(uint32_t pin_num, uint32_t duty);
+
+#endif
@@ -0,0 +1,315 @@
+
+#include "BSP_TFT.h"
+#include "PSP_GPIO.h"
+#include "PSP_Time.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_TFT Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// commands both controllers share
+#define TFT_CMD_SWRESET         0x01u       // software reset
+#define TFT_CMD_SLPOUT          0x11u       // sleep out
+#define TFT_CMD_NORON           0x13u       // normal display mode on
+#define TFT_CMD_INVOFF          0x20u       // display inversion off
+#define TFT_CMD_INVON           0x21u       // display inversion on
+#define TFT_CMD_DISPON          0x29u       // display on
+#define TFT_CMD_CASET           0x2Au       // column address set
+#define TFT_CMD_RASET           0x2Bu       // row (page) address set
+#define TFT_CMD_RAMWR           0x2Cu       // memory write
+#define TFT_CMD_MADCTL          0x36u       // memory access control (orientation)
+#define TFT_CMD_COLMOD          0x3Au       // pixel format
+
+// ILI9341 only
+#define TFT_CMD_FRMCTR1         0xB1u       // frame rate control
+#define TFT_CMD_PWCTR1          0xC0u       // power control 1
+#define TFT_CMD_PWCTR2          0xC1u       // power control 2
+#define TFT_CMD_VMCTR1          0xC5u       // VCOM control 1
+#define TFT_CMD_VMCTR2          0xC7u       // VCOM control 2
+
+#define TFT_COLMOD_RGB565       0x55u       // 16 bits per pixel on both the RGB and MCU interfaces
+
+#define TFT_MADCTL_MY           0x80u
+#define TFT_MADCTL_MX           0x40u
+#define TFT_MADCTL_MV           0x20u
+#define TFT_MADCTL_BGR          0x08u
+
+#define TFT_CHUNK_PIXELS        8192u       // per DMA transfer, 16kB, well under the 64kB DLEN limit
+#define TFT_uSEC_PER_SECOND     1000000u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_TFT Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// MADCTL for each rotation, the ILI9341 panels are wired BGR and the ST7789 ones RGB
+static const uint8_t tft_madctl[2][4] =
+{
+    { TFT_MADCTL_MX | TFT_MADCTL_BGR, TFT_MADCTL_MV | TFT_MADCTL_BGR, TFT_MADCTL_MY | TFT_MADCTL_BGR, TFT_MADCTL_MX | TFT_MADCTL_MY | TFT_MADCTL_MV | TFT_MADCTL_BGR },
+    { 0u, TFT_MADCTL_MX | TFT_MADCTL_MV, TFT_MADCTL_MX | TFT_MADCTL_MY, TFT_MADCTL_MY | TFT_MADCTL_MV }
+};
+
+static uint32_t tft_pixels[BSP_TFT_MAX_PIXELS];
+
+// one is filled while the DMA sends the other
+static uint16_t tft_staging[2][TFT_CHUNK_PIXELS] __attribute__((aligned(4)));
+static uint32_t tft_next_staging;
+
+static BSP_Graphics_Surface_t tft_surface;
+static BSP_TFT_Config_t tft_config;
+
+static uint64_t tft_fps_start_time;
+static uint32_t tft_fps_frames;
+static uint32_t tft_fps;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_TFT Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * Send a command byte with D/C low, then its parameters with D/C high. D/C can only change
+ * while SPI 0 is idle, so any pixels still going out are waited for first.
+ */
+static void TFT_Command(uint8_t command, const uint8_t * p_parameters, uint32_t num_parameters)
+{
+    PSP_SPI0_DMA_Wait();
+
+    PSP_GPIO_Pin_Low(tft_config.dc_pin);
+    PSP_SPI0_Write_Buffer(&command, 1u);
+    PSP_GPIO_Pin_High(tft_config.dc_pin);
+
+    if (num_parameters != 0u)
+    {
+        PSP_SPI0_Write_Buffer(p_parameters, num_parameters);
+    }
+}
+
+
+
+static void TFT_Command_1(uint8_t command, uint8_t parameter)
+{
+    TFT_Command(command, &parameter, 1u);
+}
+
+
+
+/**
+ * Point the controller's write address at a rectangle and start a memory write, every pixel
+ * sent after this fills the rectangle left to right, top to bottom.
+ */
+static void TFT_Set_Window(const BSP_Graphics_Rect_t * p_rect)
+{
+    const uint32_t X0 = p_rect->x + tft_config.x_offset;
+    const uint32_t X1 = X0 + p_rect->width - 1u;
+    const uint32_t Y0 = p_rect->y + tft_config.y_offset;
+    const uint32_t Y1 = Y0 + p_rect->height - 1u;
+    const uint8_t COLUMNS[4] = { (uint8_t)(X0 >> 8u), (uint8_t)X0, (uint8_t)(X1 >> 8u), (uint8_t)X1 };
+    const uint8_t ROWS[4] = { (uint8_t)(Y0 >> 8u), (uint8_t)Y0, (uint8_t)(Y1 >> 8u), (uint8_t)Y1 };
+
+    TFT_Command(TFT_CMD_CASET, COLUMNS, sizeof(COLUMNS));
+    TFT_Command(TFT_CMD_RASET, ROWS, sizeof(ROWS));
+    TFT_Command(TFT_CMD_RAMWR, 0, 0u);
+}
+
+
+
+/**
+ * 0xAARRGGBB to RGB565, byte swapped so it is big endian in memory, the order the display
+ * wants the bytes in.
+ */
+static inline uint16_t TFT_To_RGB565(uint32_t pixel)
+{
+    const uint32_t RGB565 = ((pixel >> 8u) & 0xF800u) | ((pixel >> 5u) & 0x07E0u) | ((pixel >> 3u) & 0x001Fu);
+
+    return (uint16_t)((RGB565 >> 8u) | (RGB565 << 8u));
+}
+
+
+
+/**
+ * Send a rectangle of the surface, a staging buffer at a time. PSP_SPI0_DMA_Write_Start waits
+ * for the previous buffer to finish, so each buffer is converted while the other is sent.
+ */
+static void TFT_Stream_Rect(const BSP_Graphics_Rect_t * p_rect)
+{
+    uint32_t row = 0u;
+    uint32_t column = 0u;
+
+    TFT_Set_Window(p_rect);
+
+    while (row < p_rect->height)
+    {
+        uint16_t * p_out = tft_staging[tft_next_staging];
+        uint32_t num_pixels = 0u;
+
+        while ((row < p_rect->height) && (num_pixels < TFT_CHUNK_PIXELS))
+        {
+            const uint32_t * p_in = &tft_pixels[((p_rect->y + row) * tft_surface.pitch) + p_rect->x + column];
+            uint32_t count = p_rect->width - column;
+
+            if (count > (TFT_CHUNK_PIXELS - num_pixels))
+            {
+                count = TFT_CHUNK_PIXELS - num_pixels;
+            }
+
+            for (uint32_t i = 0u; i < count; i++)
+            {
+                *p_out++ = TFT_To_RGB565(p_in[i]);
+            }
+
+            num_pixels += count;
+            column += count;
+
+            if (column == p_rect->width)
+            {
+                column = 0u;
+                row++;
+            }
+        }
+
+        PSP_SPI0_DMA_Write_Start((const uint8_t *)tft_staging[tft_next_staging], num_pixels * sizeof(uint16_t));
+        tft_next_staging ^= 1u;
+    }
+}
+
+
+
+uint32_t BSP_TFT_Init(const BSP_TFT_Config_t * p_config)
+{
+    if ((p_config->width * p_config->height) > BSP_TFT_MAX_PIXELS)
+    {
+        return 0u;
+    }
+
+    tft_config = *p_config;
+    tft_config.rotation &= 3u;
+
+    PSP_GPIO_Set_Pin_Mode(tft_config.dc_pin, PSP_GPIO_PINMODE_OUTPUT);
+    PSP_GPIO_Pin_High(tft_config.dc_pin);
+
+    PSP_SPI0_Start();
+    PSP_SPI0_Set_Chip_Select(PSP_SPI_0_Chip_Select_0);
+    PSP_SPI0_Set_Mode(tft_config.spi_mode);
+    PSP_SPI0_Set_Clock_Divider(tft_config.divider);
+
+    if (tft_config.reset_pin != BSP_TFT_NO_PIN)
+    {
+        PSP_GPIO_Set_Pin_Mode(tft_config.reset_pin, PSP_GPIO_PINMODE_OUTPUT);
+        PSP_GPIO_Pin_Low(tft_config.reset_pin);
+        PSP_Time_Delay_Microseconds(20000u);
+        PSP_GPIO_Pin_High(tft_config.reset_pin);
+        PSP_Time_Delay_Microseconds(150000u);
+    }
+
+    TFT_Command(TFT_CMD_SWRESET, 0, 0u);
+    PSP_Time_Delay_Microseconds(150000u);
+
+    if (tft_config.controller == BSP_TFT_Controller_ILI9341)
+    {
+        // the power and VCOM settings most ILI9341 modules are shipped with
+        static const uint8_t VMCTR1[2] = { 0x3Eu, 0x28u };
+        static const uint8_t FRMCTR1[2] = { 0x00u, 0x18u };  // 79Hz refresh
+
+        TFT_Command_1(TFT_CMD_PWCTR1, 0x23u);
+        TFT_Command_1(TFT_CMD_PWCTR2, 0x10u);
+        TFT_Command(TFT_CMD_VMCTR1, VMCTR1, sizeof(VMCTR1));
+        TFT_Command_1(TFT_CMD_VMCTR2, 0x86u);
+        TFT_Command(TFT_CMD_FRMCTR1, FRMCTR1, sizeof(FRMCTR1));
+    }
+
+    TFT_Command(TFT_CMD_SLPOUT, 0, 0u);
+    PSP_Time_Delay_Microseconds(120000u);
+
+    TFT_Command_1(TFT_CMD_COLMOD, TFT_COLMOD_RGB565);
+    TFT_Command_1(TFT_CMD_MADCTL, tft_madctl[tft_config.controller][tft_config.rotation]);
+    TFT_Command(tft_config.invert ? TFT_CMD_INVON : TFT_CMD_INVOFF, 0, 0u);
+    TFT_Command(TFT_CMD_NORON, 0, 0u);
+    TFT_Command(TFT_CMD_DISPON, 0, 0u);
+    PSP_Time_Delay_Microseconds(20000u);
+
+    BSP_Graphics_Init_Surface(&tft_surface, tft_pixels, tft_config.width, tft_config.height, tft_config.width);
+
+    tft_next_staging = 0u;
+    tft_fps_start_time = PSP_Time_Get_Ticks();
+    tft_fps_frames = 0u;
+    tft_fps = 0u;
+
+    // controller RAM is random after a reset
+    BSP_Graphics_Fill(&tft_surface, 0, 0, tft_config.width, tft_config.height, BSP_GRAPHICS_RGB(0u, 0u, 0u));
+    BSP_TFT_Update();
+    BSP_TFT_Wait();
+
+    return 1u;
+}
+
+
+
+BSP_Graphics_Surface_t * BSP_TFT_Get_Surface(void)
+{
+    return &tft_surface;
+}
+
+
+
+void BSP_TFT_Set_Clock_Divider(PSP_SPI_0_Clock_Divider_t divider)
+{
+    PSP_SPI0_DMA_Wait();
+    PSP_SPI0_Set_Clock_Divider(divider);
+    tft_config.divider = divider;
+}
+
+
+
+uint32_t BSP_TFT_Update(void)
+{
+    uint32_t num_sent = 0u;
+
+    for (uint32_t i = 0u; i < tft_surface.num_dirty; i++)
+    {
+        TFT_Stream_Rect(&tft_surface.dirty[i]);
+        num_sent += tft_surface.dirty[i].width * tft_surface.dirty[i].height;
+    }
+
+    tft_surface.num_dirty = 0u;
+
+    if (num_sent != 0u)
+    {
+        const uint64_t NOW = PSP_Time_Get_Ticks();
+        const uint32_t ELAPSED_uSec = (uint32_t)(NOW - tft_fps_start_time);
+
+        tft_fps_frames++;
+
+        if (ELAPSED_uSec >= TFT_uSEC_PER_SECOND)
+        {
+            tft_fps = (uint32_t)(((uint64_t)tft_fps_frames * TFT_uSEC_PER_SECOND) / ELAPSED_uSec);
+            tft_fps_frames = 0u;
+            tft_fps_start_time = NOW;
+        }
+    }
+
+    return num_sent;
+}
+
+
+
+uint32_t BSP_TFT_Is_Busy(void)
+{
+    return PSP_SPI0_DMA_Is_Busy();
+}
+
+
+
+void BSP_TFT_Wait(void)
+{
+    PSP_SPI0_DMA_Wait();
+}
+
+
+
+uint32_t BSP_TFT_Get_Frames_Per_Second(void)
+{
+    return tft_fps;
+}
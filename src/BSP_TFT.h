@@ -0,0 +1,238 @@
+/**
+ * DESCRIPTION:
+ *      BSP_TFT drives a small ILI9341 or ST7789 SPI display on SPI 0, from a BSP_Graphics
+ *      surface in RAM. BSP_TFT_Update sends only the surface's dirty rectangles, each as one
+ *      address window and one stream of RGB565 pixels.
+ *
+ * NOTES:
+ *      Draw on BSP_TFT_Get_Surface with BSP_Graphics, as with the HDMI display, then call
+ *      BSP_TFT_Update. For each dirty rectangle the column and page window are set once
+ *      (CASET, RASET, RAMWR, with the D/C pin low for the command byte only), then the pixels
+ *      go out with the SPI 0 DMA, Tx only. They are converted from 0xAARRGGBB to big endian
+ *      RGB565 into one of two staging buffers while the DMA sends the other, so the CPU work
+ *      overlaps the SPI clock and the SPI never waits for a byte.
+ *
+ *      A full 320x240 frame is 153600 bytes, at the 31.25MHz of divider 8 that is ~39mS on
+ *      the wire, 25 fps. Frames where only a few rectangles change go much faster,
+ *      BSP_TFT_Get_Frames_Per_Second reports what is actually achieved.
+ *
+ *      The fastest stable divider depends on the controller and the wiring: ST7789s are
+ *      usually fine at divider 4 (62.5MHz), ILI9341s at 8 with short wires. bench_TFT
+ *      runs a few dividers in turn, watch the display for garbage to find the limit.
+ *
+ *      The display's CS goes on CE0 (GPIO8), SCK on GPIO11, SDA/MOSI on GPIO10 and D/C on
+ *      any free GPIO. Boards without CS (many 240x240 ST7789s) need spi_mode 3. This takes
+ *      over SPI 0 and its DMA channels, so it can't share them with BSP_WS2812.
+ *
+ * REFERENCES:
+ *      ILI9341 datasheet V1.11, Ilitek
+ *      ST7789V datasheet V1.0, Sitronix
+ *      BCM2837-ARM-Peripherals.pdf page 148
+ */
+
+#ifndef BSP_TFT_H_INCLUDED
+#define BSP_TFT_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+#include "BSP_Graphics.h"
+#include "PSP_SPI_0.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_TFT Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_TFT_MAX_PIXELS      (320u * 240u)   // largest display, the surface is 4 bytes per pixel
+#define BSP_TFT_NO_PIN          0xFFFFFFFFu     // for a reset pin that isn't connected
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_TFT Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum TFT_Controller_Type
+{
+    BSP_TFT_Controller_ILI9341 = 0u,
+    BSP_TFT_Controller_ST7789  = 1u
+} BSP_TFT_Controller_t;
+
+
+
+typedef struct TFT_Config_Type
+{
+    BSP_TFT_Controller_t controller;
+    uint32_t width;                     // after rotation, e.g. 320 x 240 for a landscape ILI9341
+    uint32_t height;
+    uint32_t rotation;                  // 0...3, quarter turns clockwise from the controller's portrait
+    uint32_t x_offset;                  // where the panel starts in controller RAM after rotation, 0
+    uint32_t y_offset;                  // except on panels smaller than 240x320, e.g. 80 for some 240x240s
+    uint32_t invert;                    // 1 for panels that need color inversion (most ST7789s)
+    uint32_t dc_pin;                    // GPIO for data/command
+    uint32_t reset_pin;                 // GPIO for reset, or BSP_TFT_NO_PIN
+    PSP_SPI_0_Mode_t spi_mode;
+    PSP_SPI_0_Clock_Divider_t divider;
+} BSP_TFT_Config_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_TFT Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_TFT_Init
+
+Function Description:
+    Start SPI 0, reset and set up the display for RGB565 in the given orientation, and
+    clear it to black.
+
+Inputs:
+    p_config: the display and how it's wired, copied so it needn't stay around
+
+Returns:
+    uint32_t: 1 on success, 0 if the size is bigger than BSP_TFT_MAX_PIXELS
+
+Error Handling:
+    The display can't be read back, so a miswired one still "succeeds".
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_TFT_Init(const BSP_TFT_Config_t * p_config);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_TFT_Get_Surface
+
+Function Description:
+    Get the surface the display shows. Changes to it go to the display at the next
+    BSP_TFT_Update.
+
+Inputs:
+    None
+
+Returns:
+    BSP_Graphics_Surface_t *: the surface, width x height of 0xAARRGGBB pixels
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+BSP_Graphics_Surface_t * BSP_TFT_Get_Surface(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_TFT_Set_Clock_Divider
+
+Function Description:
+    Change the SPI clock, from the next transfer on.
+
+Inputs:
+    divider: SPI 0 clock divider
+
+Returns:
+    None
+
+Error Handling:
+    Waits for any pixels still being sent.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_TFT_Set_Clock_Divider(PSP_SPI_0_Clock_Divider_t divider);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_TFT_Update
+
+Function Description:
+    Send the surface's dirty rectangles to the display and clear the dirty list. Returns once
+    the last chunk of pixels is handed to the DMA, the surface can be drawn on straight away.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: the number of pixels sent
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_TFT_Update(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_TFT_Is_Busy
+
+Function Description:
+    Check whether the last chunk of an update is still on its way to the display.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 1 if pixels are still being sent, 0 otherwise
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_TFT_Is_Busy(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_TFT_Wait
+
+Function Description:
+    Wait until the display has every pixel sent so far.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_TFT_Wait(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_TFT_Get_Frames_Per_Second
+
+Function Description:
+    Get the number of updates that sent something over the last whole second.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: frames per second, 0 until the first second is up
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_TFT_Get_Frames_Per_Second(void);
+
+#endif
@@ -0,0 +1,375 @@
+#include "BSP_Telemetry.h"
+#include "PSP_Aux_Mini_UART.h"
+#include "PSP_CRC.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Telemetry Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define TELEMETRY_RING_MASK         (BSP_TELEMETRY_TX_BUFFER_SIZE - 1u)
+
+#define TELEMETRY_MAX_VARINT        5u      // bytes for a 32 bit varint
+#define TELEMETRY_CRC_BYTES         4u
+#define TELEMETRY_COBS_MAX_RUN      0xFFu   // a code byte for 254 bytes with no zero after them
+
+// the most a full frame can take in the ring: a code byte per 254 bytes, one to start and the delimiter
+#define TELEMETRY_MAX_WIRE_FRAME    (BSP_TELEMETRY_MAX_FRAME + (BSP_TELEMETRY_MAX_FRAME / 254u) + 2u)
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Telemetry Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Telemetry_Channel_Type
+{
+    const char * p_name;
+    BSP_Telemetry_Type_t type;
+} Telemetry_Channel_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_Telemetry Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// free running indices, masked into the ring
+static uint8_t telemetry_ring[BSP_TELEMETRY_TX_BUFFER_SIZE];
+static uint32_t telemetry_head;             // end of the last finished frame
+static uint32_t telemetry_tail;             // next byte to send
+static uint32_t telemetry_write;            // next byte of the frame being built
+
+// the frame being built
+static uint32_t telemetry_in_frame;
+static uint32_t telemetry_code_index;       // where the current COBS code byte goes
+static uint32_t telemetry_code;             // 1 + bytes since the code byte
+static uint32_t telemetry_crc;
+static uint32_t telemetry_frame_size;       // payload bytes so far
+static uint32_t telemetry_sequence;
+
+static Telemetry_Channel_t telemetry_channels[BSP_TELEMETRY_MAX_CHANNELS];
+static uint32_t telemetry_num_channels;
+
+static BSP_Telemetry_Stats_t telemetry_stats;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_Telemetry Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * COBS encode one byte into the ring: a zero ends the current block, filling in its code
+ * byte, and so does the 254th byte in a row without one.
+ */
+static inline void Telemetry_COBS_Put(uint8_t value)
+{
+    if (value == 0u)
+    {
+        telemetry_ring[telemetry_code_index & TELEMETRY_RING_MASK] = (uint8_t)telemetry_code;
+        telemetry_code_index = telemetry_write++;
+        telemetry_code = 1u;
+        return;
+    }
+
+    telemetry_ring[telemetry_write++ & TELEMETRY_RING_MASK] = value;
+    telemetry_code++;
+
+    if (telemetry_code == TELEMETRY_COBS_MAX_RUN)
+    {
+        telemetry_ring[telemetry_code_index & TELEMETRY_RING_MASK] = (uint8_t)telemetry_code;
+        telemetry_code_index = telemetry_write++;
+        telemetry_code = 1u;
+    }
+}
+
+
+
+/**
+ * Add payload bytes to the frame and its CRC.
+ */
+static void Telemetry_Put(const uint8_t * p_bytes, uint32_t num_bytes)
+{
+    telemetry_crc = PSP_CRC_32C(telemetry_crc, p_bytes, num_bytes);
+    telemetry_frame_size += num_bytes;
+
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        Telemetry_COBS_Put(p_bytes[i]);
+    }
+}
+
+
+
+/**
+ * Write value as a varint into p_bytes, returning how many bytes it took.
+ */
+static inline uint32_t Telemetry_Varint(uint32_t value, uint8_t * p_bytes)
+{
+    uint32_t num_bytes = 0u;
+
+    while (value >= 0x80u)
+    {
+        p_bytes[num_bytes++] = (uint8_t)(value | 0x80u);
+        value >>= 7;
+    }
+
+    p_bytes[num_bytes++] = (uint8_t)value;
+
+    return num_bytes;
+}
+
+
+
+static void Telemetry_Put_Varint(uint32_t value)
+{
+    uint8_t bytes[TELEMETRY_MAX_VARINT];
+
+    Telemetry_Put(bytes, Telemetry_Varint(value, bytes));
+}
+
+
+
+/**
+ * 0, -1, 1, -2, ... as 0, 1, 2, 3, ...
+ */
+static inline uint32_t Telemetry_Zigzag(uint32_t value)
+{
+    return (value << 1) ^ (uint32_t)((int32_t)value >> 31);
+}
+
+
+
+/**
+ * Start a frame of either type, if the ring has room for the largest.
+ */
+static uint32_t Telemetry_Begin(uint8_t type)
+{
+    if (telemetry_in_frame || ((BSP_TELEMETRY_TX_BUFFER_SIZE - (telemetry_head - telemetry_tail)) < TELEMETRY_MAX_WIRE_FRAME))
+    {
+        telemetry_stats.num_dropped++;
+        return 0u;
+    }
+
+    telemetry_in_frame = 1u;
+    telemetry_write = telemetry_head;
+    telemetry_code_index = telemetry_write++;
+    telemetry_code = 1u;
+    telemetry_crc = 0u;
+    telemetry_frame_size = 0u;
+
+    Telemetry_Put(&type, 1u);
+    Telemetry_Put_Varint(telemetry_sequence);
+
+    return 1u;
+}
+
+
+
+/**
+ * Whether a run of num_bytes, at most, can be added to the frame being built.
+ */
+static uint32_t Telemetry_Fits(uint32_t num_bytes)
+{
+    return telemetry_in_frame && (num_bytes <= (BSP_TELEMETRY_MAX_FRAME - TELEMETRY_CRC_BYTES - telemetry_frame_size));
+}
+
+
+
+void BSP_Telemetry_Init(void)
+{
+    PSP_CRC_Init(1u);
+
+    telemetry_head = 0u;
+    telemetry_tail = 0u;
+    telemetry_write = 0u;
+    telemetry_in_frame = 0u;
+    telemetry_sequence = 0u;
+    telemetry_num_channels = 0u;
+
+    telemetry_stats.num_frames = 0u;
+    telemetry_stats.num_dropped = 0u;
+    telemetry_stats.num_payload_bytes = 0u;
+    telemetry_stats.num_wire_bytes = 0u;
+
+    // a delimiter first, so the host doesn't take whatever was sent before as part of a frame
+    telemetry_ring[telemetry_head++] = 0u;
+}
+
+
+
+uint32_t BSP_Telemetry_Add_Channel(const char * p_name, BSP_Telemetry_Type_t type)
+{
+    if (telemetry_num_channels >= BSP_TELEMETRY_MAX_CHANNELS)
+    {
+        return BSP_TELEMETRY_NO_CHANNEL;
+    }
+
+    telemetry_channels[telemetry_num_channels].p_name = p_name;
+    telemetry_channels[telemetry_num_channels].type = type;
+
+    return telemetry_num_channels++;
+}
+
+
+
+uint32_t BSP_Telemetry_Begin_Frame(uint32_t timestamp)
+{
+    if (!Telemetry_Begin(BSP_TELEMETRY_FRAME_SAMPLES))
+    {
+        return 0u;
+    }
+
+    Telemetry_Put_Varint(timestamp);
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_Telemetry_Add_Int32(uint32_t channel, const int32_t * p_samples, uint32_t num_samples)
+{
+    // channel, count and every sample at their longest
+    const uint32_t MAX_BYTES = (2u + num_samples) * TELEMETRY_MAX_VARINT;
+
+    if ((channel >= telemetry_num_channels) || (telemetry_channels[channel].type != BSP_Telemetry_Type_Int32) ||
+        (num_samples == 0u) || (num_samples > BSP_TELEMETRY_MAX_FRAME) || !Telemetry_Fits(MAX_BYTES))
+    {
+        return 0u;
+    }
+
+    Telemetry_Put_Varint(channel);
+    Telemetry_Put_Varint(num_samples);
+
+    uint32_t previous = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        Telemetry_Put_Varint(Telemetry_Zigzag((uint32_t)p_samples[i] - previous));
+        previous = (uint32_t)p_samples[i];
+    }
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_Telemetry_Add_Float(uint32_t channel, const float * p_samples, uint32_t num_samples)
+{
+    const uint32_t MAX_BYTES = (2u * TELEMETRY_MAX_VARINT) + (num_samples * sizeof(float));
+
+    if ((channel >= telemetry_num_channels) || (telemetry_channels[channel].type != BSP_Telemetry_Type_Float) ||
+        (num_samples == 0u) || (num_samples > BSP_TELEMETRY_MAX_FRAME) || !Telemetry_Fits(MAX_BYTES))
+    {
+        return 0u;
+    }
+
+    Telemetry_Put_Varint(channel);
+    Telemetry_Put_Varint(num_samples);
+
+    // the ARM is little endian, so the bytes go as they are
+    Telemetry_Put((const uint8_t *)p_samples, num_samples * sizeof(float));
+
+    return 1u;
+}
+
+
+
+void BSP_Telemetry_End_Frame(void)
+{
+    if (!telemetry_in_frame)
+    {
+        return;
+    }
+
+    const uint32_t CRC = telemetry_crc;
+
+    for (uint32_t i = 0u; i < TELEMETRY_CRC_BYTES; i++)
+    {
+        Telemetry_COBS_Put((uint8_t)(CRC >> (8u * i)));
+    }
+
+    // close the last block, then the delimiter
+    telemetry_ring[telemetry_code_index & TELEMETRY_RING_MASK] = (uint8_t)telemetry_code;
+    telemetry_ring[telemetry_write++ & TELEMETRY_RING_MASK] = 0u;
+
+    telemetry_stats.num_frames++;
+    telemetry_stats.num_payload_bytes += telemetry_frame_size + TELEMETRY_CRC_BYTES;
+    telemetry_stats.num_wire_bytes += telemetry_write - telemetry_head;
+
+    telemetry_head = telemetry_write;
+    telemetry_sequence++;
+    telemetry_in_frame = 0u;
+}
+
+
+
+uint32_t BSP_Telemetry_Send_Channels(void)
+{
+    if (!Telemetry_Begin(BSP_TELEMETRY_FRAME_CHANNELS))
+    {
+        return 0u;
+    }
+
+    for (uint32_t channel = 0u; channel < telemetry_num_channels; channel++)
+    {
+        const char * const P_NAME = telemetry_channels[channel].p_name;
+        uint32_t name_length = 0u;
+
+        while ((name_length < BSP_TELEMETRY_MAX_NAME_LENGTH) && (P_NAME[name_length] != '\0'))
+        {
+            name_length++;
+        }
+
+        // carry on in a new frame when this one is full
+        if (!Telemetry_Fits((2u * TELEMETRY_MAX_VARINT) + 1u + name_length))
+        {
+            BSP_Telemetry_End_Frame();
+
+            if (!Telemetry_Begin(BSP_TELEMETRY_FRAME_CHANNELS))
+            {
+                return 0u;
+            }
+        }
+
+        const uint8_t TYPE = (uint8_t)telemetry_channels[channel].type;
+
+        Telemetry_Put_Varint(channel);
+        Telemetry_Put(&TYPE, 1u);
+        Telemetry_Put_Varint(name_length);
+        Telemetry_Put((const uint8_t *)P_NAME, name_length);
+    }
+
+    BSP_Telemetry_End_Frame();
+
+    return 1u;
+}
+
+
+
+uint32_t BSP_Telemetry_Service(void)
+{
+    while ((telemetry_tail != telemetry_head) && PSP_AUX_Mini_Uart_Try_Send_Byte(telemetry_ring[telemetry_tail & TELEMETRY_RING_MASK]))
+    {
+        telemetry_tail++;
+    }
+
+    return telemetry_head - telemetry_tail;
+}
+
+
+
+void BSP_Telemetry_Flush(void)
+{
+    while (BSP_Telemetry_Service() != 0u)
+    {
+        // the FIFO takes a byte every 87 uSec at 115200 baud
+    }
+}
+
+
+
+void BSP_Telemetry_Get_Stats(BSP_Telemetry_Stats_t * p_stats)
+{
+    *p_stats = telemetry_stats;
+}
@@ -0,0 +1,311 @@
+/**
+ * DESCRIPTION:
+ *      BSP_Telemetry streams sensor samples over the mini uart as compact binary frames in
+ *      place of text: samples go to typed channels, whole numbers are delta and varint
+ *      encoded, and every frame carries a CRC and is COBS framed so a host can find frame
+ *      boundaries and drop damaged frames. tools/telemetry_decode.py decodes the stream on
+ *      the host, either live from the serial port or from a capture, and can be imported as
+ *      a library.
+ *
+ * NOTES:
+ *      Frames are built straight into the transmit ring, COBS encoding each byte as it's
+ *      added, so samples are never copied into a packet buffer first. The ring drains into
+ *      the mini uart's FIFO from BSP_Telemetry_Service, which never waits: call it regularly
+ *      from the main loop, or BSP_Telemetry_Flush to wait for everything to go out.
+ *
+ *          BSP_Telemetry_Begin_Frame(timestamp);
+ *          BSP_Telemetry_Add_Int32(ACCEL_X, p_samples, 16u);
+ *          BSP_Telemetry_Add_Float(TEMPERATURE, &temperature, 1u);
+ *          BSP_Telemetry_End_Frame();
+ *
+ *      A frame starts only if the ring has room for the largest frame, and a sample run is
+ *      added only if it fits in what's left of BSP_TELEMETRY_MAX_FRAME, so nothing is ever
+ *      half written. Everything here is for the main loop only, it isn't interrupt safe.
+ *
+ *      Wire format, little endian throughout:
+ *
+ *          frame:      COBS(payload, CRC-32C of payload), then 0x00
+ *          payload:    type (1 byte), sequence (varint), then by type:
+ *              0x01 samples:   timestamp (varint), then runs of:
+ *                              channel (varint), count (varint), count values
+ *              0x02 channels:  runs of: channel (varint), type (1 byte), name length
+ *                              (varint), name (ASCII)
+ *
+ *          Int32 values:   the first of a run as a zigzag varint, the rest as zigzag varint
+ *                          differences from the one before, modulo 2^32
+ *          Float values:   4 bytes each, as is
+ *
+ *      A varint is 7 bits per byte, least significant first, with the top bit set on every
+ *      byte but the last. Zigzag maps 0, -1, 1, -2, ... to 0, 1, 2, 3, ... so small
+ *      differences either way take one byte. Each run starts from an absolute value, so a
+ *      lost frame never throws off the ones after it, and the sequence number, one per frame
+ *      of either type, shows the host what was lost.
+ *
+ *      A 12 bit ADC reading that moves by less than +-64 between samples takes 1 byte, where
+ *      "1234\r\n" takes 6, which with the per frame overhead (about 12 bytes) is where the
+ *      3 to 5 times gain comes from. bench_Telemetry measures it.
+ *
+ *      BSP_Telemetry_Send_Channels sends the channel names and types, as channels 0x02
+ *      frames. Send it at start and every so often, so a host that starts listening late can
+ *      put names to the numbers.
+ *
+ * REFERENCES:
+ *      S. Cheshire and M. Baker, Consistent Overhead Byte Stuffing, IEEE/ACM Transactions on
+ *      Networking, 1999
+ *      Varints and zigzag: https://protobuf.dev/programming-guides/encoding/
+ */
+
+#ifndef BSP_TELEMETRY_H_INCLUDED
+#define BSP_TELEMETRY_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Telemetry Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_TELEMETRY_TX_BUFFER_SIZE    4096u   // bytes in the transmit ring, a power of 2
+#define BSP_TELEMETRY_MAX_FRAME         1024u   // payload and CRC bytes per frame, before COBS
+#define BSP_TELEMETRY_MAX_CHANNELS      32u
+#define BSP_TELEMETRY_MAX_NAME_LENGTH   31u     // longer names are cut short on the wire
+
+#define BSP_TELEMETRY_NO_CHANNEL        0xFFFFFFFFu
+
+#define BSP_TELEMETRY_FRAME_SAMPLES     0x01u
+#define BSP_TELEMETRY_FRAME_CHANNELS    0x02u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Telemetry Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum Telemetry_Type_Type
+{
+    BSP_Telemetry_Type_Int32 = 0u,      // delta and zigzag varint encoded
+    BSP_Telemetry_Type_Float = 1u       // sent as is
+} BSP_Telemetry_Type_t;
+
+
+
+typedef struct Telemetry_Stats_Type
+{
+    uint32_t num_frames;                // frames ended, of either type
+    uint32_t num_dropped;               // frames that didn't start for lack of room in the ring
+    uint32_t num_payload_bytes;         // before COBS, CRCs included
+    uint32_t num_wire_bytes;            // after COBS, delimiters included
+} BSP_Telemetry_Stats_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_Telemetry Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Init
+
+Function Description:
+    Empty the transmit ring, forget every channel and zero the stats. The mini uart must
+    already be set up with PSP_AUX_Mini_Uart_Init. This also calls PSP_CRC_Init.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Telemetry_Init(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Add_Channel
+
+Function Description:
+    Add a channel. Channels are numbered from 0 in the order they're added.
+
+Inputs:
+    p_name: the channel's name for the host, kept by reference
+    type: what the channel's samples are
+
+Returns:
+    uint32_t: the channel, or BSP_TELEMETRY_NO_CHANNEL if there are already
+              BSP_TELEMETRY_MAX_CHANNELS
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Telemetry_Add_Channel(const char * p_name, BSP_Telemetry_Type_t type);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Begin_Frame
+
+Function Description:
+    Start a samples frame in the transmit ring.
+
+Inputs:
+    timestamp: for the host, e.g. the low 32 bits of PSP_Time_Get_Ticks
+
+Returns:
+    uint32_t: 1 if the frame started, 0 if the ring hasn't room for a whole frame yet
+
+Error Handling:
+    Returns 0 and counts a dropped frame if there isn't room, or if a frame is already
+    being built.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Telemetry_Begin_Frame(uint32_t timestamp);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Add_Int32, BSP_Telemetry_Add_Float
+
+Function Description:
+    Add a run of samples from one channel to the frame being built.
+
+Inputs:
+    channel: from BSP_Telemetry_Add_Channel, of the matching type
+    p_samples: num_samples samples, oldest first
+    num_samples: at least 1
+
+Returns:
+    uint32_t: 1 if they were added, 0 if not
+
+Error Handling:
+    Nothing is added, and 0 returned, if no frame is being built, the channel isn't one of
+    this type, or the run (at its largest) doesn't fit in the rest of the frame.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Telemetry_Add_Int32(uint32_t channel, const int32_t * p_samples, uint32_t num_samples);
+uint32_t BSP_Telemetry_Add_Float(uint32_t channel, const float * p_samples, uint32_t num_samples);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_End_Frame
+
+Function Description:
+    Finish the frame being built, adding its CRC, and hand it over to be sent.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    Does nothing if no frame is being built.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Telemetry_End_Frame(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Send_Channels
+
+Function Description:
+    Send every channel's name and type, in as many channels frames as it takes.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 1 if they all went into the ring, 0 if it ran out of room
+
+Error Handling:
+    Stops at the first frame that doesn't fit, counting it as dropped.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Telemetry_Send_Channels(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Service
+
+Function Description:
+    Move bytes from the transmit ring into the mini uart's FIFO until one or the other runs
+    out. Never waits, call it regularly from the main loop.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: bytes still waiting in the ring
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_Telemetry_Service(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Flush
+
+Function Description:
+    Wait until every finished frame has gone into the mini uart's FIFO.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Telemetry_Flush(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_Telemetry_Get_Stats
+
+Function Description:
+    Get the frame and byte counts since BSP_Telemetry_Init.
+
+Inputs:
+    p_stats: where to put them
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_Telemetry_Get_Stats(BSP_Telemetry_Stats_t * p_stats);
+
+#endif
@@ -0,0 +1,149 @@
+
+#include "BSP_WS2812.h"
+#include "PSP_SPI_0.h"
+#include "PSP_REGS.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_WS2812 Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define WS2812_SPI_CLOCK_HZ     2400000u   // 3 SPI bits per LED bit at 800kHz
+#define WS2812_BYTES_PER_COLOR  3u         // 8 LED bits * 3 SPI bits = 24 SPI bits
+#define WS2812_BYTES_PER_PIXEL  (3u * WS2812_BYTES_PER_COLOR)
+
+#define WS2812_LEAD_BYTES       4u         // a word of low MOSI before the first pixel
+#define WS2812_LATCH_BYTES      92u        // > 300 uSec of low MOSI latches the strip, 92 bytes is 307 uSec
+
+#define WS2812_SPI_BUFFER_SIZE  (WS2812_LEAD_BYTES + (BSP_WS2812_MAX_PIXELS * WS2812_BYTES_PER_PIXEL) + WS2812_LATCH_BYTES + 3u)
+
+#define WS2812_SPI_ZERO_BITS    0b100u     // an LED 0 bit as SPI bits
+#define WS2812_SPI_ONE_BITS     0b110u     // an LED 1 bit as SPI bits
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private BSP_WS2812 Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// the 24 SPI bits for every possible color byte, most significant SPI byte first
+static uint8_t ws2812_encode_table[256][WS2812_BYTES_PER_COLOR];
+
+// lead bytes, encoded pixels, latch bytes, padded to a whole number of words for the DMA
+static uint8_t ws2812_spi_buffer[WS2812_SPI_BUFFER_SIZE] __attribute__((aligned(4)));
+
+static uint32_t ws2812_num_pixels;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    BSP_WS2812 Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * example:
+ *      the color byte 0xA5 = 0b10100101 becomes
+ * 
+ *      110 100 110 100 100 110 100 110 = 0b110100110100100110100110
+ * 
+ *      which is the table entry { 0xD3, 0x49, 0xA6 }
+ */
+static void WS2812_Build_Encode_Table(void)
+{
+    for (uint32_t color = 0u; color < 256u; color++)
+    {
+        uint32_t spi_bits = 0u;
+
+        for (int bit = 7; bit >= 0; bit--)
+        {
+            spi_bits = (spi_bits << 3u) | (((color >> bit) & 1u) ? WS2812_SPI_ONE_BITS : WS2812_SPI_ZERO_BITS);
+        }
+
+        ws2812_encode_table[color][0] = (uint8_t)(spi_bits >> 16u);
+        ws2812_encode_table[color][1] = (uint8_t)(spi_bits >> 8u);
+        ws2812_encode_table[color][2] = (uint8_t)(spi_bits);
+    }
+}
+
+
+
+void BSP_WS2812_Init(uint32_t num_pixels)
+{
+    ws2812_num_pixels = (num_pixels < BSP_WS2812_MAX_PIXELS) ? num_pixels : BSP_WS2812_MAX_PIXELS;
+
+    WS2812_Build_Encode_Table();
+
+    // low lead in and latch, all pixels off
+    for (uint32_t i = 0u; i < WS2812_SPI_BUFFER_SIZE; i++)
+    {
+        ws2812_spi_buffer[i] = 0u;
+    }
+
+    for (uint32_t i = 0u; i < ws2812_num_pixels; i++)
+    {
+        BSP_WS2812_Set_Pixel(i, 0u, 0u, 0u);
+    }
+
+    PSP_SPI0_Start();
+
+    // the divider must be even, (core clock / 2) / 2.4MHz rounded, times 2
+    // 250MHz gives 104 (2.40MHz), 500MHz gives 208 (2.40MHz)
+    const uint32_t DIVIDER = ((PSP_REGS_CORE_CLOCK_HZ / 2u) + (WS2812_SPI_CLOCK_HZ / 2u)) / WS2812_SPI_CLOCK_HZ * 2u;
+
+    PSP_SPI0_Set_Clock_Divider((PSP_SPI_0_Clock_Divider_t)DIVIDER);
+}
+
+
+
+void BSP_WS2812_Set_Pixel(uint32_t index, uint8_t red, uint8_t green, uint8_t blue)
+{
+    if (ws2812_num_pixels <= index)
+    {
+        return; // past the end of the strip, do nothing
+    }
+
+    uint8_t * p_pixel = &ws2812_spi_buffer[WS2812_LEAD_BYTES + (index * WS2812_BYTES_PER_PIXEL)];
+
+    // the strip wants green, then red, then blue, each most significant bit first
+    const uint8_t * p_green = ws2812_encode_table[green];
+    const uint8_t * p_red   = ws2812_encode_table[red];
+    const uint8_t * p_blue  = ws2812_encode_table[blue];
+
+    p_pixel[0] = p_green[0];
+    p_pixel[1] = p_green[1];
+    p_pixel[2] = p_green[2];
+    p_pixel[3] = p_red[0];
+    p_pixel[4] = p_red[1];
+    p_pixel[5] = p_red[2];
+    p_pixel[6] = p_blue[0];
+    p_pixel[7] = p_blue[1];
+    p_pixel[8] = p_blue[2];
+}
+
+
+
+void BSP_WS2812_Set_Pixels(uint32_t first_index, const uint32_t * p_colors, uint32_t count)
+{
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        const uint32_t COLOR = p_colors[i];
+
+        BSP_WS2812_Set_Pixel(first_index + i, (uint8_t)(COLOR >> 16u), (uint8_t)(COLOR >> 8u), (uint8_t)COLOR);
+    }
+}
+
+
+
+void BSP_WS2812_Show(void)
+{
+    // the latch bytes after the last pixel were zeroed by init and are never written
+    const uint32_t NUM_BYTES = WS2812_LEAD_BYTES + (ws2812_num_pixels * WS2812_BYTES_PER_PIXEL) + WS2812_LATCH_BYTES;
+
+    PSP_SPI0_DMA_Write_Start(ws2812_spi_buffer, NUM_BYTES);
+}
+
+
+
+uint32_t BSP_WS2812_Is_Busy(void)
+{
+    return PSP_SPI0_DMA_Is_Busy();
+}
@@ -0,0 +1,156 @@
+/**
+ * DESCRIPTION:
+ *      BSP_WS2812 drives a strip of WS2812/WS2812B ("NeoPixel") addressable LEDs from the
+ *      SPI 0 MOSI pin (GPIO10). Each LED data bit is sent as 3 SPI bits at 2.4MHz, 0b100 for
+ *      a 0 and 0b110 for a 1, which gives the ~400nS/~800nS high times the LEDs expect and
+ *      leaves the timing entirely up to the SPI hardware.
+ * 
+ * NOTES:
+ *      Pixels are encoded into the SPI buffer as they are set, 3 table lookups per pixel and
+ *      no per-bit branching. BSP_WS2812_Show then hands the buffer to the SPI 0 DMA and returns,
+ *      so the CPU is free while the strip updates.
+ * 
+ *      The strip itself sets the frame rate: every LED takes 24 bits at 800kHz (30 uSec), plus
+ *      a 300 uSec latch. 500 LEDs refresh at ~65 fps, 1000 LEDs at ~33 fps.
+ * 
+ *      Don't change pixels while BSP_WS2812_Is_Busy, the DMA is still reading the buffer.
+ * 
+ *      This takes over SPI 0 (and its DMA channels), wire the strip's data in to GPIO10 through
+ *      a 3.3V to 5V level shifter.
+ * 
+ * REFERENCES:
+ *      WS2812B datasheet, Worldsemi
+ *      BCM2837-ARM-Peripherals.pdf page 148
+ */
+
+#ifndef BSP_WS2812_H_INCLUDED
+#define BSP_WS2812_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_WS2812 Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define BSP_WS2812_MAX_PIXELS 1000u  // longest supported strip, 9 bytes of SPI buffer per pixel
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public BSP_WS2812 Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_WS2812_Init
+
+Function Description:
+    Build the encoding table, start SPI 0 at ~2.4MHz and set every pixel to off.
+
+Inputs:
+    num_pixels: the number of pixels on the strip
+
+Returns:
+    None
+
+Error Handling:
+    num_pixels is limited to BSP_WS2812_MAX_PIXELS.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_WS2812_Init(uint32_t num_pixels);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_WS2812_Set_Pixel
+
+Function Description:
+    Set the color of one pixel. Takes effect at the next BSP_WS2812_Show.
+
+Inputs:
+    index: the pixel to set, 0 is the pixel closest to the Pi
+    red, green, blue: the color, 0...255 each
+
+Returns:
+    None
+
+Error Handling:
+    Returns without having any effect if the index is past the end of the strip.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_WS2812_Set_Pixel(uint32_t index, uint8_t red, uint8_t green, uint8_t blue);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_WS2812_Set_Pixels
+
+Function Description:
+    Set the colors of a run of pixels from an array of 0x00RRGGBB values. Takes effect at the
+    next BSP_WS2812_Show.
+
+Inputs:
+    first_index: the first pixel to set
+    p_colors: the colors, one 0x00RRGGBB value per pixel
+    count: the number of pixels to set
+
+Returns:
+    None
+
+Error Handling:
+    Pixels past the end of the strip are ignored.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_WS2812_Set_Pixels(uint32_t first_index, const uint32_t * p_colors, uint32_t count);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_WS2812_Show
+
+Function Description:
+    Start sending the pixels to the strip via DMA and return straight away.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    Waits for the previous frame to finish sending first.
+
+-------------------------------------------------------------------------------------------------*/
+void BSP_WS2812_Show(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    BSP_WS2812_Is_Busy
+
+Function Description:
+    Check if a frame is still being sent to the strip.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 1 if a frame is still being sent, 0 if the pixels can be changed
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t BSP_WS2812_Is_Busy(void);
+
+#endif
@@ -0,0 +1,2290 @@
+/**
+ * DESCRIPTION:
+ *      Benchmarks provides a suite of timing benchmarks for the peripheral modules, the
+ *      counterpart to Hardware_Demos for questions like "how fast can this go".
+ * 
+ * NOTES:
+ *      Like the demos, each benchmark enters an infinite loop and does not return. In main.c,
+ *      uncomment exactly one demo or benchmark function before compiling.
+ * 
+ *      Results are timed with the 1MHz System Timer and printed via mini uart Tx at 115200 baud,
+ *      so attach a serial adapter to pins 14 and 15 (or run under QEMU with make qemu-pi3).
+ * 
+ * REFERENCES:
+ *      Pinouts: https://www.raspberrypi.org/documentation/usage/gpio/
+ */
+
+#ifndef BENCHMARKS_H_INCLUDED
+#define BENCHMARKS_H_INCLUDED
+
+#include "PSP_GPIO.h"
+#include "PSP_Time.h"
+#include "PSP_Aux_Mini_UART.h"
+#include "BSP_Logic_Analyzer.h"
+#include "BSP_WS2812.h"
+#include "BSP_Pattern_Generator.h"
+#include "PSP_RNG.h"
+#include "PSP_Cache.h"
+#include "PSP_EMMC.h"
+#include "BSP_FAT32.h"
+#include "PSP_Framebuffer.h"
+#include "BSP_Graphics.h"
+#include "BSP_TFT.h"
+#include "PSP_I2C.h"
+#include "BSP_Bit_Bang.h"
+#include "PSP_IRQ.h"
+#include "PSP_Trace.h"
+#include "BSP_Profiler.h"
+#include "PSP_Ring.h"
+#include "PSP_Memory.h"
+#include "BSP_DSP.h"
+#include "BSP_FFT.h"
+#include "PSP_CRC.h"
+#include "BSP_Telemetry.h"
+#include "Freestanding.h"
+
+// set by make PROFILE=speed|size|debug, see the Makefile
+#if !defined(PSP_BUILD_PROFILE)
+#define PSP_BUILD_PROFILE   "none"
+#define PSP_BUILD_CPU       "generic"
+#endif
+
+
+
+/**
+ * Prints the build profile and CPU, once, ahead of the first result line, so logs from the
+ * speed, size and debug builds of the same benchmark can be told apart.
+ */
+void bench_Report_Build()
+{
+    static uint32_t reported_build = 0u;
+
+    if (!reported_build)
+    {
+        reported_build = 1u;
+        PSP_AUX_Mini_Uart_Send_String("Build profile: " PSP_BUILD_PROFILE ", CPU: " PSP_BUILD_CPU "\r\n");
+    }
+}
+
+
+
+/**
+ * Prints a benchmark result line in the form "<name>: <value> <units>".
+ */
+void bench_Report(char * name, uint32_t value, char * units)
+{
+    bench_Report_Build();
+    PSP_AUX_Mini_Uart_Send_String(name);
+    PSP_AUX_Mini_Uart_Send_String(": ");
+    PSP_AUX_Mini_Uart_Send_Decimal(value);
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_String(units);
+    PSP_AUX_Mini_Uart_Send_String("\r\n");
+}
+
+
+
+/**
+ * Prints a benchmark result line in the form "<name>: <rate> kHz (<elapsed> us)".
+ * 
+ * num_events is how many times the benchmarked thing happened in elapsed_uSec, it must
+ * be less than 4294967 to avoid overflowing the kHz math.
+ */
+void bench_Report_kHz(char * name, uint32_t num_events, uint32_t elapsed_uSec)
+{
+    if (elapsed_uSec == 0u)
+    {
+        elapsed_uSec = 1u; // too fast to measure, avoid dividing by zero
+    }
+
+    bench_Report_Build();
+    PSP_AUX_Mini_Uart_Send_String(name);
+    PSP_AUX_Mini_Uart_Send_String(": ");
+    PSP_AUX_Mini_Uart_Send_Decimal((num_events * 1000u) / elapsed_uSec);
+    PSP_AUX_Mini_Uart_Send_String(" kHz (");
+    PSP_AUX_Mini_Uart_Send_Decimal(elapsed_uSec);
+    PSP_AUX_Mini_Uart_Send_String(" us)\r\n");
+}
+
+
+
+/**
+ * GPIO toggle frequency benchmark.
+ * 
+ * Generates a square wave on pin 17 as fast as possible, first with the range checked
+ * PSP_GPIO_Write_Pin function, then with the inline PSP_GPIO_Pin_High/Low functions, and
+ * prints the resulting square wave frequency for each.
+ * 
+ * To verify: the printed rates, or put a scope/frequency counter on pin 17.
+ */ 
+void bench_GPIO_Toggle()
+{
+    const uint32_t TOGGLE_PIN = 17u;
+    const uint32_t NUM_PERIODS = 100000u;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+    PSP_GPIO_Set_Pin_Mode(TOGGLE_PIN, PSP_GPIO_PINMODE_OUTPUT);
+
+    while (1)
+    {
+        uint64_t start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < NUM_PERIODS; i++)
+        {
+            PSP_GPIO_Write_Pin(TOGGLE_PIN, PSP_GPIO_PIN_WRITE_HIGH);
+            PSP_GPIO_Write_Pin(TOGGLE_PIN, PSP_GPIO_PIN_WRITE_LOW);
+        }
+
+        bench_Report_kHz("PSP_GPIO_Write_Pin square wave", NUM_PERIODS, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < NUM_PERIODS; i++)
+        {
+            PSP_GPIO_Pin_High(TOGGLE_PIN);
+            PSP_GPIO_Pin_Low(TOGGLE_PIN);
+        }
+
+        bench_Report_kHz("PSP_GPIO_Pin_High/Low square wave", NUM_PERIODS, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * Logic analyzer sample rate benchmark.
+ * 
+ * Captures 4096 samples with the CPU loop, then asks the DMA capture for a 25MHz sample rate,
+ * and prints the sample rate each one actually achieved. The DMA rate is timed over
+ * BSP_Logic_Analyzer_Wait_DMA only, next to the rate the pacer was set to. Building the control
+ * blocks and starting the pacer is printed on its own "DMA capture setup" line.
+ * 
+ * To verify: the printed rates. If the DMA engine can't get through two control blocks per
+ * sample at the pacer rate, the measured DMA rate comes out lower than it and shows its limit.
+ */ 
+void bench_Logic_Analyzer()
+{
+    const uint32_t NUM_SAMPLES = BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES;
+    const uint32_t DMA_REQUESTED_RATE_HZ = 25000000u;
+
+    static uint32_t samples[BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES];
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    while (1)
+    {
+        uint64_t start_time = PSP_Time_Get_Ticks();
+
+        BSP_Logic_Analyzer_Capture_CPU(samples, NUM_SAMPLES, 0u, 0u);
+
+        bench_Report_kHz("Logic analyzer CPU sample rate", NUM_SAMPLES, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        start_time = PSP_Time_Get_Ticks();
+
+        const uint32_t PACER_RATE_HZ = BSP_Logic_Analyzer_Start_DMA(samples, NUM_SAMPLES, DMA_REQUESTED_RATE_HZ, 0u, 0u);
+
+        const uint64_t CAPTURE_START_TIME = PSP_Time_Get_Ticks();
+
+        BSP_Logic_Analyzer_Wait_DMA();
+
+        const uint32_t CAPTURE_USEC = (uint32_t)(PSP_Time_Get_Ticks() - CAPTURE_START_TIME);
+
+        bench_Report("Logic analyzer DMA capture setup", (uint32_t)(CAPTURE_START_TIME - start_time), "us");
+        bench_Report("Logic analyzer DMA pacer rate", PACER_RATE_HZ / 1000u, "kHz");
+        bench_Report_kHz("Logic analyzer DMA sample rate", NUM_SAMPLES, CAPTURE_USEC);
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * WS2812 strip refresh benchmark.
+ * 
+ * Encodes a full 1000 pixel frame, sends it, and prints how long the CPU spent encoding,
+ * how long BSP_WS2812_Show held the CPU, how long the frame took on the wire, and the
+ * resulting frames per second.
+ * 
+ * To verify: the printed times, no strip needed. The CPU times should be a tiny fraction
+ * of the wire time.
+ */ 
+void bench_WS2812()
+{
+    const uint32_t NUM_PIXELS = BSP_WS2812_MAX_PIXELS;
+
+    static uint32_t colors[BSP_WS2812_MAX_PIXELS];
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+    BSP_WS2812_Init(NUM_PIXELS);
+
+    uint32_t frame = 0u;
+
+    while (1)
+    {
+        for (uint32_t i = 0u; i < NUM_PIXELS; i++)
+        {
+            colors[i] = (i + frame) * 0x00010203u;
+        }
+
+        uint64_t start_time = PSP_Time_Get_Ticks();
+        BSP_WS2812_Set_Pixels(0u, colors, NUM_PIXELS);
+        uint64_t encoded_time = PSP_Time_Get_Ticks();
+        BSP_WS2812_Show();
+        uint64_t shown_time = PSP_Time_Get_Ticks();
+
+        while (BSP_WS2812_Is_Busy())
+        {
+            // wait for the frame to go out
+        }
+
+        uint64_t sent_time = PSP_Time_Get_Ticks();
+
+        bench_Report("WS2812 encode 1000 pixels", (uint32_t)(encoded_time - start_time), "us");
+        bench_Report("WS2812 show (CPU)", (uint32_t)(shown_time - encoded_time), "us");
+        bench_Report("WS2812 frame on the wire", (uint32_t)(sent_time - shown_time), "us");
+        bench_Report("WS2812 1000 pixel refresh rate", 1000000u / (uint32_t)(sent_time - start_time), "fps");
+
+        frame++;
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * DMA pattern generator edge rate and jitter benchmark.
+ * 
+ * Loops a square wave on pin 21 (one edge per tick) at shorter and shorter ticks, finishing
+ * with a delay of 0 (as fast as the DMA can go). For each one, pin 21 is captured with the
+ * CPU logic analyzer and the edges counted, then prints:
+ *      - the tick length actually used, in nS
+ *      - the measured edge rate, in kHz (one edge per tick while the DMA keeps up)
+ *      - the jitter, the spread between the shortest and longest high or low time in nS,
+ *        which can't be measured finer than one sample period
+ *      - the sample period, in nS
+ * 
+ * To verify: the printed results, nothing needs to be attached to pin 21. The CPU hammering
+ * GPLEV0 competes with the DMA for the bus, so jitter here is a worst case.
+ */ 
+void bench_Pattern_Generator()
+{
+    const uint32_t PIN = 21u;
+    const uint32_t NUM_SAMPLES = BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES;
+    const uint32_t NUM_TICKS = 7u;
+    const uint32_t TICKS_nSec[7] = { 1000u, 500u, 200u, 100u, 50u, 30u, 0u }; // 0 for no delay
+
+    static uint32_t samples[BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES];
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    while (1)
+    {
+        for (uint32_t t = 0u; t < NUM_TICKS; t++)
+        {
+            const uint32_t DELAY_TICKS = (TICKS_nSec[t] != 0u) ? 1u : 0u;
+
+            BSP_Pattern_Generator_Step_t square_wave[2] =
+            {
+                { 1u << PIN, 0u, DELAY_TICKS },
+                { 0u, 1u << PIN, DELAY_TICKS }
+            };
+
+            // with no delay the tick isn't used, any valid tick will do
+            uint32_t tick_nSec = BSP_Pattern_Generator_Load(square_wave, 2u, (TICKS_nSec[t] != 0u) ? TICKS_nSec[t] : 1000u, 1u);
+
+            BSP_Pattern_Generator_Start();
+
+            uint32_t sample_rate_hz = BSP_Logic_Analyzer_Capture_CPU(samples, NUM_SAMPLES, 0u, 0u);
+
+            BSP_Pattern_Generator_Stop();
+
+            // count the edges and time the runs between them, the first and last runs are
+            // cut off by the capture so they aren't counted
+            uint32_t num_edges = 0u;
+            uint32_t run_length = 0u;
+            uint32_t min_run = 0xFFFFFFFFu;
+            uint32_t max_run = 0u;
+            uint32_t level = (samples[0] >> PIN) & 1u;
+
+            for (uint32_t i = 1u; i < NUM_SAMPLES; i++)
+            {
+                run_length++;
+
+                if (((samples[i] >> PIN) & 1u) != level)
+                {
+                    if (num_edges != 0u)
+                    {
+                        min_run = (run_length < min_run) ? run_length : min_run;
+                        max_run = (max_run < run_length) ? run_length : max_run;
+                    }
+
+                    level ^= 1u;
+                    num_edges++;
+                    run_length = 0u;
+                }
+            }
+
+            const uint32_t SAMPLE_nSec = 1000000000u / sample_rate_hz;
+
+            bench_Report("Pattern generator tick", (TICKS_nSec[t] != 0u) ? tick_nSec : 0u, "ns");
+            bench_Report("    edge rate", (uint32_t)(((uint64_t)num_edges * sample_rate_hz) / (NUM_SAMPLES * 1000u)), "kHz");
+            bench_Report("    jitter", (min_run <= max_run) ? ((max_run - min_run) * SAMPLE_nSec) : 0u, "ns");
+            bench_Report("    sample period", SAMPLE_nSec, "ns");
+        }
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * Random number throughput benchmark.
+ * 
+ * Prints, in kB/s:
+ *      - reading the hardware RNG directly (PSP_RNG_Get_Word with the pool empty)
+ *      - taking words from a full entropy pool
+ *      - xoshiro128** one word at a time (PSP_RNG_Xoshiro_Next)
+ *      - xoshiro128** in bulk (PSP_RNG_Xoshiro_Fill), 4 generators side by side
+ * 
+ * Runs with the instruction cache on, like any real user of the PRNG would.
+ * 
+ * To verify: the printed results, no hardware needed. The hardware rate is the one that 
+ * matters for sizing PSP_RNG_POOL_WORDS against how often PSP_RNG_Service gets called.
+ */ 
+void bench_RNG()
+{
+    const uint32_t NUM_HARDWARE_WORDS = 1024u;
+    const uint32_t NUM_PRNG_WORDS = 65536u;
+
+    static uint32_t words[65536];
+    static PSP_RNG_Xoshiro_t xoshiro;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+    PSP_Cache_Enable_Instruction_Cache();
+    PSP_RNG_Init();
+
+    // the first read waits out the warm up, keep it out of the timing
+    PSP_RNG_Xoshiro_Seed(&xoshiro, ((uint64_t)PSP_RNG_Get_Word() << 32u) | PSP_RNG_Get_Word());
+
+    while (1)
+    {
+        // the pool is empty here, so every word comes straight from the hardware
+        uint64_t start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < NUM_HARDWARE_WORDS; i++)
+        {
+            words[i] = PSP_RNG_Get_Word();
+        }
+
+        uint32_t elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+        bench_Report("Hardware RNG", (NUM_HARDWARE_WORDS * sizeof(uint32_t) * 1000u) / elapsed_uSec, "kB/s");
+
+        while (PSP_RNG_Pool_Level() < PSP_RNG_POOL_WORDS)
+        {
+            PSP_RNG_Service();
+        }
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < PSP_RNG_POOL_WORDS; i++)
+        {
+            PSP_RNG_Try_Get_Word(&words[i]);
+        }
+
+        elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+        bench_Report("RNG entropy pool", (PSP_RNG_POOL_WORDS * sizeof(uint32_t) * 1000u) / ((elapsed_uSec != 0u) ? elapsed_uSec : 1u), "kB/s");
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < NUM_PRNG_WORDS; i++)
+        {
+            words[i] = PSP_RNG_Xoshiro_Next(&xoshiro);
+        }
+
+        elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+        bench_Report("xoshiro128** Next", (NUM_PRNG_WORDS * sizeof(uint32_t) * 1000u) / elapsed_uSec, "kB/s");
+
+        start_time = PSP_Time_Get_Ticks();
+
+        PSP_RNG_Xoshiro_Fill(&xoshiro, words, NUM_PRNG_WORDS);
+
+        elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+        bench_Report("xoshiro128** Fill", (NUM_PRNG_WORDS * sizeof(uint32_t) * 1000u) / elapsed_uSec, "kB/s");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * Sets the direction of the first num_requests requests, queues them all, waits for them and
+ * returns how many failed.
+ */
+uint32_t bench_EMMC_Run(PSP_EMMC_Request_t * p_requests, uint32_t num_requests, PSP_EMMC_Direction_t direction)
+{
+    uint32_t num_errors = 0u;
+
+    for (uint32_t i = 0u; i < num_requests; i++)
+    {
+        p_requests[i].direction = direction;
+        PSP_EMMC_Submit(&p_requests[i]);
+    }
+
+    while (!PSP_EMMC_Is_Idle())
+    {
+        PSP_EMMC_Service();
+    }
+
+    for (uint32_t i = 0u; i < num_requests; i++)
+    {
+        num_errors += (p_requests[i].result != PSP_EMMC_Result_OK) ? 1u : 0u;
+    }
+
+    return num_errors;
+}
+
+
+
+/**
+ * SD card read and write throughput benchmark.
+ * 
+ * Brings up the card and prints its size and bus clock, then prints:
+ *      - sequential read rate in kB/s, 64kB multi-block reads of the first 8MB with two
+ *        requests queued at a time so the card never waits on the CPU
+ *      - sequential write rate in kB/s, 64kB multi-block (CMD25) writes of the last 8MB of
+ *        the card, the scratch range, two requests queued at a time
+ *      - random read rate in kB/s and reads per second, 4kB reads at random 4kB aligned
+ *        places on the card (the same places every run)
+ *      - random write rate in kB/s and writes per second, 4kB writes at random 4kB aligned
+ *        places in the scratch range
+ *      - how many requests failed, each one counted once
+ * 
+ * Every write puts back the data that was just read from the same blocks, and only the writes
+ * are timed. So the card's contents are left as they were, unless the power goes mid-write:
+ * don't run it on a card you can't afford to rewrite.
+ * 
+ * To verify: the printed results. Runs under QEMU too, with make qemu-pi3 SD_IMAGE=<image>.
+ */ 
+void bench_EMMC()
+{
+    const uint32_t SEQUENTIAL_REQUEST_BLOCKS = 128u;    // 64kB
+    const uint32_t SEQUENTIAL_TOTAL_BLOCKS = 16384u;    // 8MB
+    const uint32_t RANDOM_REQUEST_BLOCKS = 8u;          // 4kB
+    const uint32_t NUM_RANDOM_REQUESTS = 256u;
+
+    static uint32_t buffers[2][128u * (PSP_EMMC_BLOCK_SIZE / sizeof(uint32_t))];
+    static PSP_EMMC_Request_t requests[2];
+    static PSP_RNG_Xoshiro_t xoshiro;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_EMMC_Result_t result = PSP_EMMC_Init();
+
+    bench_Report("EMMC init result", result, "(0 is OK)");
+
+    if (result != PSP_EMMC_Result_OK)
+    {
+        while (1)
+        {
+            // nothing to benchmark without a card
+        }
+    }
+
+    const uint32_t NUM_BLOCKS = PSP_EMMC_Get_Num_Blocks();
+    const uint32_t TOTAL_BLOCKS = (NUM_BLOCKS < SEQUENTIAL_TOTAL_BLOCKS) ? (NUM_BLOCKS - (NUM_BLOCKS % SEQUENTIAL_REQUEST_BLOCKS)) : SEQUENTIAL_TOTAL_BLOCKS;
+    const uint32_t SCRATCH_FIRST_BLOCK = (NUM_BLOCKS - TOTAL_BLOCKS) & ~(RANDOM_REQUEST_BLOCKS - 1u);
+
+    bench_Report("EMMC card size", NUM_BLOCKS / 2048u, "MB");
+    bench_Report("EMMC bus clock", PSP_EMMC_Get_Bus_Clock_Hz() / 1000u, "kHz");
+
+    while (1)
+    {
+        uint32_t next_block = 0u;
+        uint32_t num_errors = 0u;
+
+        uint64_t start_time = PSP_Time_Get_Ticks();
+
+        // keep two requests queued, refill each one as soon as it finishes
+        for (uint32_t i = 0u; i < 2u; i++)
+        {
+            requests[i].result = PSP_EMMC_Result_OK;
+        }
+
+        while ((next_block < TOTAL_BLOCKS) || !PSP_EMMC_Is_Idle())
+        {
+            PSP_EMMC_Service();
+
+            for (uint32_t i = 0u; i < 2u; i++)
+            {
+                if ((requests[i].result != PSP_EMMC_Result_Pending) && (next_block < TOTAL_BLOCKS))
+                {
+                    num_errors += (requests[i].result != PSP_EMMC_Result_OK) ? 1u : 0u;
+
+                    requests[i].direction = PSP_EMMC_Direction_Read;
+                    requests[i].first_block = next_block;
+                    requests[i].num_blocks = SEQUENTIAL_REQUEST_BLOCKS;
+                    requests[i].p_buffer = buffers[i];
+                    PSP_EMMC_Submit(&requests[i]);
+
+                    next_block += SEQUENTIAL_REQUEST_BLOCKS;
+                }
+            }
+        }
+
+        uint32_t elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        // the last request on each side finished without being refilled, so isn't counted yet
+        for (uint32_t i = 0u; i < 2u; i++)
+        {
+            num_errors += (requests[i].result != PSP_EMMC_Result_OK) ? 1u : 0u;
+        }
+
+        bench_Report("EMMC sequential read", (uint32_t)(((uint64_t)TOTAL_BLOCKS * PSP_EMMC_BLOCK_SIZE * 1000u) / elapsed_uSec), "kB/s");
+
+        // sequential write, two requests' worth of the scratch range read, then written back
+        uint32_t num_written = 0u;
+
+        elapsed_uSec = 0u;
+
+        for (uint32_t block = 0u; block < TOTAL_BLOCKS; block += 2u * SEQUENTIAL_REQUEST_BLOCKS)
+        {
+            const uint32_t NUM_REQUESTS = ((TOTAL_BLOCKS - block) > SEQUENTIAL_REQUEST_BLOCKS) ? 2u : 1u;
+
+            for (uint32_t i = 0u; i < NUM_REQUESTS; i++)
+            {
+                requests[i].first_block = SCRATCH_FIRST_BLOCK + block + (i * SEQUENTIAL_REQUEST_BLOCKS);
+                requests[i].num_blocks = SEQUENTIAL_REQUEST_BLOCKS;
+                requests[i].p_buffer = buffers[i];
+            }
+
+            const uint32_t READ_ERRORS = bench_EMMC_Run(requests, NUM_REQUESTS, PSP_EMMC_Direction_Read);
+
+            num_errors += READ_ERRORS;
+
+            // never write back a buffer that didn't read
+            if (READ_ERRORS == 0u)
+            {
+                start_time = PSP_Time_Get_Ticks();
+
+                num_errors += bench_EMMC_Run(requests, NUM_REQUESTS, PSP_EMMC_Direction_Write);
+
+                elapsed_uSec += (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+                num_written += NUM_REQUESTS * SEQUENTIAL_REQUEST_BLOCKS;
+            }
+        }
+
+        bench_Report("EMMC sequential write", (elapsed_uSec != 0u) ? (uint32_t)(((uint64_t)num_written * PSP_EMMC_BLOCK_SIZE * 1000u) / elapsed_uSec) : 0u, "kB/s");
+
+        PSP_RNG_Xoshiro_Seed(&xoshiro, 1u);
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < NUM_RANDOM_REQUESTS; i++)
+        {
+            const uint32_t BLOCK = (PSP_RNG_Xoshiro_Next(&xoshiro) % (NUM_BLOCKS / RANDOM_REQUEST_BLOCKS)) * RANDOM_REQUEST_BLOCKS;
+
+            num_errors += (PSP_EMMC_Read_Blocks(BLOCK, RANDOM_REQUEST_BLOCKS, buffers[0]) != PSP_EMMC_Result_OK) ? 1u : 0u;
+        }
+
+        elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        bench_Report("EMMC random 4kB read", (uint32_t)(((uint64_t)NUM_RANDOM_REQUESTS * RANDOM_REQUEST_BLOCKS * PSP_EMMC_BLOCK_SIZE * 1000u) / elapsed_uSec), "kB/s");
+        bench_Report("EMMC random 4kB read", (uint32_t)(((uint64_t)NUM_RANDOM_REQUESTS * 1000000u) / elapsed_uSec), "reads/s");
+
+        // random write, each 4kB read and then written back
+        num_written = 0u;
+        elapsed_uSec = 0u;
+
+        for (uint32_t i = 0u; i < NUM_RANDOM_REQUESTS; i++)
+        {
+            const uint32_t BLOCK = SCRATCH_FIRST_BLOCK + ((PSP_RNG_Xoshiro_Next(&xoshiro) % (TOTAL_BLOCKS / RANDOM_REQUEST_BLOCKS)) * RANDOM_REQUEST_BLOCKS);
+
+            if (PSP_EMMC_Read_Blocks(BLOCK, RANDOM_REQUEST_BLOCKS, buffers[0]) != PSP_EMMC_Result_OK)
+            {
+                num_errors++;
+                continue;
+            }
+
+            start_time = PSP_Time_Get_Ticks();
+
+            num_errors += (PSP_EMMC_Write_Blocks(BLOCK, RANDOM_REQUEST_BLOCKS, buffers[0]) != PSP_EMMC_Result_OK) ? 1u : 0u;
+
+            elapsed_uSec += (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+            num_written++;
+        }
+
+        bench_Report("EMMC random 4kB write", (elapsed_uSec != 0u) ? (uint32_t)(((uint64_t)num_written * RANDOM_REQUEST_BLOCKS * PSP_EMMC_BLOCK_SIZE * 1000u) / elapsed_uSec) : 0u, "kB/s");
+        bench_Report("EMMC random 4kB write", (elapsed_uSec != 0u) ? (uint32_t)(((uint64_t)num_written * 1000000u) / elapsed_uSec) : 0u, "writes/s");
+        bench_Report("EMMC failed requests", num_errors, "");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * FAT32 file read and log append benchmark.
+ * 
+ * Needs BENCH.BIN on the card's FAT32 partition, made by
+ *      tools/fat32_image.py build sd.img --bench-kb 4096
+ * for QEMU (make qemu-pi3 SD_IMAGE=sd.img), or copied from such an image to a real card.
+ * 
+ * Prints:
+ *      - zero copy read rate in kB/s, BENCH.BIN read with BSP_FAT32_Read_Direct and every word
+ *        checked, and how many were wrong
+ *      - copying read rate in kB/s, BENCH.BIN read with BSP_FAT32_Read into a 4kB buffer
+ *      - cache hits, misses and read-aheads over both reads
+ *      - time to append 256 lines to BENCH.LOG and sync it
+ * 
+ * To verify: the printed results, and that tools/fat32_image.py cat sd.img BENCH.LOG shows
+ * the lines afterwards.
+ */ 
+void bench_FAT32()
+{
+    const uint32_t NUM_LOG_LINES = 256u;
+
+    static uint32_t buffer[1024];
+    static BSP_FAT32_File_t file;
+    static BSP_FAT32_File_t log;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    BSP_FAT32_Result_t result = (PSP_EMMC_Init() == PSP_EMMC_Result_OK) ? BSP_FAT32_Mount() : BSP_FAT32_Result_Disk_Error;
+
+    if (result == BSP_FAT32_Result_OK)
+    {
+        result = BSP_FAT32_Open(&file, "BENCH.BIN");
+    }
+
+    if (result == BSP_FAT32_Result_OK)
+    {
+        result = BSP_FAT32_Log_Open(&log, "BENCH.LOG");
+    }
+
+    bench_Report("FAT32 mount and open result", result, "(0 is OK)");
+
+    if (result != BSP_FAT32_Result_OK)
+    {
+        while (1)
+        {
+            // nothing to benchmark without the files
+        }
+    }
+
+    bench_Report("FAT32 BENCH.BIN size", file.size / 1024u, "kB");
+
+    while (1)
+    {
+        BSP_FAT32_Cache_Stats_t stats_before;
+        BSP_FAT32_Cache_Stats_t stats_after;
+        const uint8_t * p_data;
+        uint32_t num_bytes;
+        uint32_t word_index = 0u;
+        uint32_t num_errors = 0u;
+
+        BSP_FAT32_Get_Cache_Stats(&stats_before);
+        BSP_FAT32_Seek(&file, 0u);
+
+        uint64_t start_time = PSP_Time_Get_Ticks();
+
+        do
+        {
+            result = BSP_FAT32_Read_Direct(&file, &p_data, 0xFFFFFFFFu, &num_bytes);
+
+            // lines are whole sectors, so the pointer stays word aligned
+            for (uint32_t i = 0u; i < (num_bytes / sizeof(uint32_t)); i++)
+            {
+                num_errors += (((const uint32_t *)p_data)[i] != word_index++) ? 1u : 0u;
+            }
+        } while ((result == BSP_FAT32_Result_OK) && (num_bytes != 0u));
+
+        uint32_t elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        bench_Report("FAT32 zero copy read", (uint32_t)(((uint64_t)file.size * 1000u) / elapsed_uSec), "kB/s");
+        bench_Report("FAT32 zero copy read bad words", num_errors + ((result != BSP_FAT32_Result_OK) ? 1u : 0u), "");
+
+        BSP_FAT32_Seek(&file, 0u);
+
+        start_time = PSP_Time_Get_Ticks();
+
+        do
+        {
+            result = BSP_FAT32_Read(&file, buffer, sizeof(buffer), &num_bytes);
+        } while ((result == BSP_FAT32_Result_OK) && (num_bytes == sizeof(buffer)));
+
+        elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        BSP_FAT32_Get_Cache_Stats(&stats_after);
+
+        bench_Report("FAT32 copying read", (uint32_t)(((uint64_t)file.size * 1000u) / elapsed_uSec), "kB/s");
+        bench_Report("FAT32 cache hits", stats_after.hits - stats_before.hits, "lines");
+        bench_Report("FAT32 cache misses", stats_after.misses - stats_before.misses, "lines");
+        bench_Report("FAT32 read-aheads", stats_after.read_aheads - stats_before.read_aheads, "lines");
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < NUM_LOG_LINES; i++)
+        {
+            static const char LINE[] = "bench_FAT32 log line, 64 bytes including the line ending......\r\n";
+
+            BSP_FAT32_Log_Append(&log, LINE, sizeof(LINE) - 1u);
+        }
+
+        result = BSP_FAT32_Log_Sync(&log);
+        elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        bench_Report("FAT32 append 16kB and sync", elapsed_uSec, "uS");
+        bench_Report("FAT32 sync result", result, "(0 is OK)");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+/**
+ * Framebuffer drawing and per frame benchmark, at 640x480.
+ * 
+ * Runs on QEMU with make qemu-pi3 QEMU_DISPLAY=gtk, where the frames can be watched too.
+ * Build with NEON=1 as well to compare the vector loops as NEON against plain ARM code.
+ * 
+ * Prints, in microseconds:
+ *      - full screen fill, and full screen copy (a scroll up by one text line)
+ *      - alpha blend of a 128x128 sprite
+ *      - 80 columns of text, with and without a background
+ *      - present after drawing only a status line (what a dashboard frame usually is), and
+ *        after a full screen fill, which is the most Present ever copies
+ *      - a whole status line frame: draw, then present
+ */ 
+void bench_Framebuffer()
+{
+    const uint32_t WIDTH = 640u;
+    const uint32_t HEIGHT = 480u;
+    const uint32_t SPRITE_SIZE = 128u;
+    const uint32_t WHITE = BSP_GRAPHICS_RGB(0xFFu, 0xFFu, 0xFFu);
+    const uint32_t NAVY = BSP_GRAPHICS_RGB(0x00u, 0x00u, 0x40u);
+    static const char LINE[] = "0123456789 The quick brown fox jumps over the lazy dog. 0123456789 ABCDEFGHIJKL";
+
+    static uint32_t sprite_pixels[128u * 128u];
+    static BSP_Graphics_Surface_t sprite;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    const uint32_t READY = BSP_Graphics_Display_Init(WIDTH, HEIGHT);
+
+    bench_Report("Framebuffer init", READY, "(1 is OK)");
+
+    if (!READY)
+    {
+        while (1)
+        {
+            // nothing to draw on
+        }
+    }
+
+    bench_Report("Framebuffer pages", PSP_Framebuffer_Get_Num_Pages(), "");
+
+    // a round sprite, opaque in the middle and fading out to the edges
+    BSP_Graphics_Init_Surface(&sprite, sprite_pixels, SPRITE_SIZE, SPRITE_SIZE, SPRITE_SIZE);
+
+    for (uint32_t y = 0u; y < SPRITE_SIZE; y++)
+    {
+        for (uint32_t x = 0u; x < SPRITE_SIZE; x++)
+        {
+            const int32_t DX = (int32_t)x - (int32_t)(SPRITE_SIZE / 2u);
+            const int32_t DY = (int32_t)y - (int32_t)(SPRITE_SIZE / 2u);
+            const uint32_t DISTANCE_SQUARED = (uint32_t)((DX * DX) + (DY * DY));
+            const uint32_t ALPHA = (DISTANCE_SQUARED >= 4096u) ? 0u : (255u - (DISTANCE_SQUARED / 16u));
+
+            sprite_pixels[(y * SPRITE_SIZE) + x] = BSP_GRAPHICS_ARGB(ALPHA, 0xFFu, x * 2u, y * 2u);
+        }
+    }
+
+    uint32_t frame = 0u;
+
+    while (1)
+    {
+        BSP_Graphics_Surface_t * p_back = BSP_Graphics_Display_Get_Back();
+
+        uint64_t start_time = PSP_Time_Get_Ticks();
+        BSP_Graphics_Fill(p_back, 0, 0, WIDTH, HEIGHT, NAVY);
+        bench_Report("Framebuffer full screen fill", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+        for (uint32_t row = 0u; row < (HEIGHT / BSP_GRAPHICS_FONT_HEIGHT); row++)
+        {
+            BSP_Graphics_Draw_Text(p_back, 0, (int32_t)(row * BSP_GRAPHICS_FONT_HEIGHT), LINE, WHITE, BSP_GRAPHICS_TRANSPARENT);
+        }
+
+        start_time = PSP_Time_Get_Ticks();
+        BSP_Graphics_Copy(p_back, 0, 0, p_back, 0, (int32_t)BSP_GRAPHICS_FONT_HEIGHT, WIDTH, HEIGHT - BSP_GRAPHICS_FONT_HEIGHT);
+        bench_Report("Framebuffer full screen scroll", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+        start_time = PSP_Time_Get_Ticks();
+        BSP_Graphics_Blend(p_back, (int32_t)((frame * 8u) % WIDTH) - (int32_t)(SPRITE_SIZE / 2u), 200, &sprite, 0, 0, SPRITE_SIZE, SPRITE_SIZE);
+        bench_Report("Framebuffer 128x128 blend", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+        start_time = PSP_Time_Get_Ticks();
+        BSP_Graphics_Draw_Text(p_back, 0, 100, LINE, WHITE, NAVY);
+        bench_Report("Framebuffer 80 characters", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+        start_time = PSP_Time_Get_Ticks();
+        BSP_Graphics_Draw_Text(p_back, 0, 120, LINE, WHITE, BSP_GRAPHICS_TRANSPARENT);
+        bench_Report("Framebuffer 80 characters, transparent", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+        start_time = PSP_Time_Get_Ticks();
+        uint32_t num_copied = BSP_Graphics_Display_Present();
+        bench_Report("Framebuffer present, full screen dirty", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+        bench_Report("    pixels copied", num_copied, "");
+
+        // a dashboard frame, only the status line changes
+        p_back = BSP_Graphics_Display_Get_Back();
+        start_time = PSP_Time_Get_Ticks();
+        BSP_Graphics_Draw_Text(p_back, 0, (int32_t)(HEIGHT - BSP_GRAPHICS_FONT_HEIGHT), LINE, WHITE, NAVY);
+        uint64_t drawn_time = PSP_Time_Get_Ticks();
+        num_copied = BSP_Graphics_Display_Present();
+        uint64_t end_time = PSP_Time_Get_Ticks();
+
+        bench_Report("Framebuffer present, status line dirty", (uint32_t)(end_time - drawn_time), "us");
+        bench_Report("    pixels copied", num_copied, "");
+        bench_Report("Framebuffer status line frame", (uint32_t)(end_time - start_time), "us");
+
+        frame++;
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+/**
+ * SPI TFT frame rate benchmark, a 320x240 ILI9341 in landscape.
+ * 
+ * Wiring: CS on GPIO8, SCK GPIO11, MOSI GPIO10, D/C GPIO25, reset GPIO24. For an ST7789,
+ * change the config (controller, size, invert, and spi_mode 3 if it has no CS pin).
+ * 
+ * For each of SPI dividers 16, 8 and 4, runs for 3 seconds each of:
+ *      - full screen frames, the whole surface dirty every frame
+ *      - dashboard frames, just a status line of text redrawn
+ * and prints the frames per second BSP_TFT reports. The display shows garbage at a divider
+ * that is too fast for it, the fastest clean one is the one to use.
+ */ 
+void bench_TFT()
+{
+    const uint32_t RUN_TIME_uSec = 3000000u;  // so at least one of BSP_TFT's 1 second windows is inside each run
+    const uint32_t NUM_DIVIDERS = 3u;
+    const PSP_SPI_0_Clock_Divider_t DIVIDERS[3] = { PSP_SPI0_Clock_Divider_16, PSP_SPI0_Clock_Divider_8, PSP_SPI0_Clock_Divider_4 };
+    const uint32_t WHITE = BSP_GRAPHICS_RGB(0xFFu, 0xFFu, 0xFFu);
+    const uint32_t NAVY = BSP_GRAPHICS_RGB(0x00u, 0x00u, 0x40u);
+
+    BSP_TFT_Config_t config;
+
+    config.controller = BSP_TFT_Controller_ILI9341;
+    config.width = 320u;
+    config.height = 240u;
+    config.rotation = 1u;
+    config.x_offset = 0u;
+    config.y_offset = 0u;
+    config.invert = 0u;
+    config.dc_pin = 25u;
+    config.reset_pin = 24u;
+    config.spi_mode = PSP_SPI_0_Mode_0;
+    config.divider = PSP_SPI0_Clock_Divider_16;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    BSP_TFT_Init(&config);
+
+    BSP_Graphics_Surface_t * p_surface = BSP_TFT_Get_Surface();
+
+    while (1)
+    {
+        for (uint32_t d = 0u; d < NUM_DIVIDERS; d++)
+        {
+            BSP_TFT_Set_Clock_Divider(DIVIDERS[d]);
+            bench_Report("TFT SPI divider", DIVIDERS[d], "");
+
+            uint32_t frame = 0u;
+            uint64_t start_time = PSP_Time_Get_Ticks();
+
+            while ((uint32_t)(PSP_Time_Get_Ticks() - start_time) < RUN_TIME_uSec)
+            {
+                // bands of color that move every frame, so a dropped frame shows
+                for (uint32_t band = 0u; band < 8u; band++)
+                {
+                    const uint32_t SHADE = ((band + frame) & 7u) * 32u;
+
+                    BSP_Graphics_Fill(p_surface, 0, (int32_t)(band * 30u), config.width, 30u, BSP_GRAPHICS_RGB(SHADE, 0xFFu - SHADE, 0x80u));
+                }
+
+                BSP_TFT_Update();
+                frame++;
+            }
+
+            bench_Report("    full screen", BSP_TFT_Get_Frames_Per_Second(), "fps");
+
+            BSP_Graphics_Fill(p_surface, 0, 0, config.width, config.height, NAVY);
+            start_time = PSP_Time_Get_Ticks();
+
+            while ((uint32_t)(PSP_Time_Get_Ticks() - start_time) < RUN_TIME_uSec)
+            {
+                BSP_Graphics_Draw_Text(p_surface, 0, (int32_t)(config.height - BSP_GRAPHICS_FONT_HEIGHT),
+                                       (frame & 1u) ? "status: running  " : "status: RUNNING  ", WHITE, NAVY);
+                BSP_TFT_Update();
+                frame++;
+            }
+
+            bench_Report("    status line", BSP_TFT_Get_Frames_Per_Second(), "fps");
+        }
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+/**
+ * Two I2C buses at once: BSC1 at 100kHz and BSC0 at 400kHz.
+ * 
+ * Wiring: a slow device at SLOW_ADDRESS on GPIO2/3 (BSC1) and a fast mode device at
+ * FAST_ADDRESS on GPIO0/1 (BSC0), e.g. a 24C32 EEPROM at 0x50 and an MPU6050 at 0x68.
+ * Each transfer writes register address 0 and reads 32 bytes back after a repeated start.
+ * 
+ * Prints, in microseconds:
+ *      - each bus's transfer on its own, one after the other
+ *      - both transfers started together and serviced together, which should take about as
+ *        long as the slow bus alone
+ *      - the result of each transfer (0 is OK, 2 means nothing answered at that address)
+ */ 
+void bench_I2C()
+{
+    const uint32_t SLOW_ADDRESS = 0x50u;
+    const uint32_t FAST_ADDRESS = 0x68u;
+    const uint32_t NUM_BYTES = 32u;
+    const uint8_t REGISTER = 0x00u;
+
+    static uint8_t slow_data[32];
+    static uint8_t fast_data[32];
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_I2C_Start(PSP_I2C_Bus_1, 2u);
+    PSP_I2C_Start(PSP_I2C_Bus_0, 0u);
+    bench_Report("I2C bus 1 clock", PSP_I2C_Set_Speed_Hz(PSP_I2C_Bus_1, PSP_I2C_STANDARD_HZ), "Hz");
+    bench_Report("I2C bus 0 clock", PSP_I2C_Set_Speed_Hz(PSP_I2C_Bus_0, PSP_I2C_FAST_HZ), "Hz");
+
+    while (1)
+    {
+        uint64_t start_time = PSP_Time_Get_Ticks();
+        PSP_I2C_Result_t slow_result = PSP_I2C_Transfer(PSP_I2C_Bus_1, SLOW_ADDRESS, &REGISTER, 1u, slow_data, NUM_BYTES);
+        uint64_t slow_time = PSP_Time_Get_Ticks();
+        PSP_I2C_Result_t fast_result = PSP_I2C_Transfer(PSP_I2C_Bus_0, FAST_ADDRESS, &REGISTER, 1u, fast_data, NUM_BYTES);
+        uint64_t end_time = PSP_Time_Get_Ticks();
+
+        bench_Report("I2C 100kHz bus alone", (uint32_t)(slow_time - start_time), "us");
+        bench_Report("    result", slow_result, "(0 is OK)");
+        bench_Report("I2C 400kHz bus alone", (uint32_t)(end_time - slow_time), "us");
+        bench_Report("    result", fast_result, "(0 is OK)");
+        bench_Report("I2C one after the other", (uint32_t)(end_time - start_time), "us");
+
+        start_time = PSP_Time_Get_Ticks();
+        PSP_I2C_Transfer_Start(PSP_I2C_Bus_1, SLOW_ADDRESS, &REGISTER, 1u, slow_data, NUM_BYTES);
+        PSP_I2C_Transfer_Start(PSP_I2C_Bus_0, FAST_ADDRESS, &REGISTER, 1u, fast_data, NUM_BYTES);
+
+        while ((PSP_I2C_Get_Result(PSP_I2C_Bus_1) == PSP_I2C_Result_Busy) || (PSP_I2C_Get_Result(PSP_I2C_Bus_0) == PSP_I2C_Result_Busy))
+        {
+            PSP_I2C_Service();
+        }
+
+        end_time = PSP_Time_Get_Ticks();
+
+        bench_Report("I2C both buses at once", (uint32_t)(end_time - start_time), "us");
+        bench_Report("    100kHz result", PSP_I2C_Get_Result(PSP_I2C_Bus_1), "(0 is OK)");
+        bench_Report("    400kHz result", PSP_I2C_Get_Result(PSP_I2C_Bus_0), "(0 is OK)");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+/**
+ * Bit-banged SPI at 10MHz and I2C at 1MHz on ordinary GPIO pins.
+ * 
+ * Wiring: SPI SCK on GPIO21, MOSI on 20, MISO on 19 and CS on 16, with MOSI wired straight to
+ * MISO for the loopback check. I2C SDA on GPIO23 and SCL on 24, with 1k pull-ups to 3.3V and a
+ * device at I2C_ADDRESS (e.g. a 24C32 EEPROM at 0x50, most are good for 1MHz).
+ * 
+ * Prints:
+ *      - the delay loop calibration, and a 1000 uSec calibrated delay timed by the System Timer
+ *      - the SPI and I2C clocks Init says it reached
+ *      - the SPI bit rate measured over 4096 bytes, sending only and sending plus receiving,
+ *        and the bytes that didn't come back through the loopback wire (0 with it in place)
+ *      - the I2C bit rate over a 32 byte register read (9 bits per byte, with the address
+ *        bytes), when the device answers, and the transfer result (0 is OK)
+ */ 
+void bench_Bit_Bang()
+{
+    const uint32_t SPI_SPEED_HZ = 10000000u;
+    const uint32_t NUM_SPI_BYTES = 4096u;
+    const uint32_t I2C_ADDRESS = 0x50u;
+    const uint32_t NUM_I2C_BYTES = 32u;
+    const uint32_t NUM_I2C_BITS = (NUM_I2C_BYTES + 3u) * 9u; // address, register, address again, data
+    const uint8_t REGISTER = 0x00u;
+
+    static uint8_t spi_out[4096];
+    static uint8_t spi_in[4096];
+    static uint8_t i2c_data[32];
+
+    BSP_Bit_Bang_SPI_t spi;
+    BSP_Bit_Bang_I2C_t i2c;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_Time_Calibrate_Delay();
+    bench_Report("delay loops per mSec", PSP_Time_Get_Loops_Per_Millisecond(), "");
+
+    const uint32_t DELAY_LOOPS = PSP_Time_Nanoseconds_To_Loops(1000000u);
+    uint64_t start_time = PSP_Time_Get_Ticks();
+    PSP_Time_Delay_Loops(DELAY_LOOPS);
+    bench_Report("1000 uSec delay", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+    bench_Report("bit-bang SPI clock", BSP_Bit_Bang_SPI_Init(&spi, 21u, 20u, 19u, 16u, PSP_SPI_0_Mode_0, SPI_SPEED_HZ), "Hz");
+    bench_Report("bit-bang I2C clock", BSP_Bit_Bang_I2C_Init(&i2c, 23u, 24u, PSP_I2C_FAST_PLUS_HZ), "Hz");
+
+    for (uint32_t i = 0u; i < NUM_SPI_BYTES; i++)
+    {
+        spi_out[i] = (uint8_t)((i * 37u) ^ (i >> 8u));
+    }
+
+    while (1)
+    {
+        start_time = PSP_Time_Get_Ticks();
+        BSP_Bit_Bang_SPI_Transfer(&spi, spi_out, 0, NUM_SPI_BYTES);
+        bench_Report_kHz("bit-bang SPI send", NUM_SPI_BYTES * 8u, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        start_time = PSP_Time_Get_Ticks();
+        BSP_Bit_Bang_SPI_Transfer(&spi, spi_out, spi_in, NUM_SPI_BYTES);
+        bench_Report_kHz("bit-bang SPI send and receive", NUM_SPI_BYTES * 8u, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        uint32_t num_errors = 0u;
+
+        for (uint32_t i = 0u; i < NUM_SPI_BYTES; i++)
+        {
+            num_errors += (spi_in[i] != spi_out[i]) ? 1u : 0u;
+        }
+
+        bench_Report("    loopback errors", num_errors, "bytes");
+
+        start_time = PSP_Time_Get_Ticks();
+        PSP_I2C_Result_t result = BSP_Bit_Bang_I2C_Transfer(&i2c, I2C_ADDRESS, &REGISTER, 1u, i2c_data, NUM_I2C_BYTES);
+        const uint32_t I2C_uSec = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        if (result == PSP_I2C_Result_OK)
+        {
+            bench_Report_kHz("bit-bang I2C read", NUM_I2C_BITS, I2C_uSec);
+        }
+
+        bench_Report("    result", result, "(0 is OK)");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+static volatile uint32_t bench_irq_fired;
+
+/**
+ * System Timer channel 1 handler for bench_IRQ_Latency.
+ */
+static void bench_IRQ_Timer_Handler(void)
+{
+    PSP_Time_Clear_Compare_Match(PSP_Time_Compare_Channel_1);
+    bench_irq_fired = 1u;
+}
+
+
+
+/**
+ * Measures interrupt latency: System Timer channel 1 is armed for 100 uSec ahead, over and over,
+ * and PSP_IRQ works out how long after each compare match its IRQ was taken. The first run has
+ * the main loop just waiting. The second has it masking IRQs in critical sections of up to
+ * about 20 uSec, like a driver updating shared state would, to show how they push out the tail.
+ * 
+ * Prints, for each run of 10000 interrupts:
+ *      - the latency min, percentiles, max and jitter, in cycles and nS, with the histogram
+ *      - the longest the handler ran, and the longest critical section with where it was
+ */ 
+void bench_IRQ_Latency()
+{
+    const uint32_t NUM_INTERRUPTS = 10000u;
+    const uint32_t PERIOD_uSec = 100u;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_IRQ_Init();
+    PSP_IRQ_Attach(PSP_IRQ_SOURCE_SYSTEM_TIMER_1, bench_IRQ_Timer_Handler);
+
+    bench_Report("cycles per mSec", PSP_Time_Get_Cycles_Per_Millisecond(), "");
+
+    while (1)
+    {
+        for (uint32_t run = 0u; run < 2u; run++)
+        {
+            uint32_t masked_loops = 0u;
+
+            PSP_IRQ_Reset_Latency(PSP_IRQ_SOURCE_SYSTEM_TIMER_1);
+
+            for (uint32_t i = 0u; i < NUM_INTERRUPTS; i++)
+            {
+                bench_irq_fired = 0u;
+
+                const uint32_t STATE = PSP_IRQ_Disable();
+                PSP_IRQ_Expect(PSP_IRQ_SOURCE_SYSTEM_TIMER_1, PSP_Time_Set_Compare_Synced(PSP_Time_Compare_Channel_1, PERIOD_uSec));
+                PSP_IRQ_Restore(STATE);
+
+                while (!bench_irq_fired)
+                {
+                    if (run == 1u)
+                    {
+                        // 0...20 uSec with IRQs masked, stepping through the range
+                        masked_loops = (masked_loops + PSP_Time_Nanoseconds_To_Loops(1300u)) % PSP_Time_Nanoseconds_To_Loops(20000u);
+
+                        const uint32_t CRITICAL = PSP_IRQ_Disable();
+                        PSP_Time_Delay_Loops(masked_loops + 1u);
+                        PSP_IRQ_Restore(CRITICAL);
+                    }
+                }
+            }
+
+            PSP_IRQ_Print_Latency_Report(PSP_IRQ_SOURCE_SYSTEM_TIMER_1, (run == 0u) ? "idle" : "with critical sections");
+        }
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * Measures what a trace point costs, then traces a little bus traffic and dumps it for
+ * tools/trace_to_json.py. Build with make TRACE=1, without it the drivers' trace points aren't
+ * compiled in and the dump only has the marks made here. Wiring as bench_I2C for bus 1 (a device
+ * at 0x50 on GPIO2/3) and SPI0 on its usual pins, MOSI looped back to MISO or not.
+ * 
+ * Prints:
+ *      - the cost of a trace point in cycles, averaged over 1000 back to back
+ *      - every 5 seconds, a trace dump of a 64 byte SPI0 transfer at 3.9MHz, a DMA SPI0 write,
+ *        a 16 byte I2C register read at 100kHz and a short delay, with marks between them
+ */ 
+void bench_Trace()
+{
+    const uint32_t NUM_TRACE_POINTS = 1000u;
+    const uint32_t NUM_SPI_BYTES = 64u;
+    const uint32_t NUM_I2C_BYTES = 16u;
+    const uint32_t I2C_ADDRESS = 0x50u;
+    const uint8_t REGISTER = 0x00u;
+
+    static uint8_t spi_out[64];
+    static uint8_t spi_in[64];
+    static uint8_t i2c_data[16];
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_SPI0_Start();
+    PSP_SPI0_Set_Clock_Divider(PSP_SPI0_Clock_Divider_64);
+    PSP_I2C_Start(PSP_I2C_Bus_1, 2u);
+    PSP_I2C_Set_Speed_Hz(PSP_I2C_Bus_1, PSP_I2C_STANDARD_HZ);
+
+    PSP_Trace_Init();
+
+    const uint32_t START_CYCLES = PSP_Time_Get_Cycles();
+
+    for (uint32_t i = 0u; i < NUM_TRACE_POINTS; i++)
+    {
+        PSP_Trace_Record(PSP_TRACE_PHASE_INSTANT | PSP_Trace_Event_CPU_Mark, i);
+    }
+
+    bench_Report("trace point", (PSP_Time_Get_Cycles() - START_CYCLES) / NUM_TRACE_POINTS, "cycles");
+
+    for (uint32_t i = 0u; i < NUM_SPI_BYTES; i++)
+    {
+        spi_out[i] = (uint8_t)i;
+    }
+
+    while (1)
+    {
+        PSP_Trace_Clear();
+
+        PSP_Trace_Record(PSP_TRACE_PHASE_INSTANT | PSP_Trace_Event_CPU_Mark, 1u);
+        PSP_SPI0_Buffer_Transfer(spi_out, spi_in, NUM_SPI_BYTES);
+
+        PSP_Trace_Record(PSP_TRACE_PHASE_INSTANT | PSP_Trace_Event_CPU_Mark, 2u);
+        PSP_SPI0_DMA_Write_Start(spi_out, NUM_SPI_BYTES);
+        PSP_SPI0_DMA_Wait();
+
+        PSP_Trace_Record(PSP_TRACE_PHASE_INSTANT | PSP_Trace_Event_CPU_Mark, 3u);
+        PSP_I2C_Transfer(PSP_I2C_Bus_1, I2C_ADDRESS, &REGISTER, 1u, i2c_data, NUM_I2C_BYTES);
+
+        PSP_Trace_Record(PSP_TRACE_PHASE_INSTANT | PSP_Trace_Event_CPU_Mark, 4u);
+        PSP_Time_Delay_Microseconds(100u);
+
+        PSP_Trace_Dump();
+
+        PSP_Time_Delay_Microseconds(5000000u);
+    }
+}
+
+
+
+/**
+ * Busy work for bench_Profiler, kept out of line so each shows up as its own function.
+ */
+__attribute__((noinline)) static uint32_t bench_Profile_Checksum(const uint8_t * p_data, uint32_t num_bytes)
+{
+    uint32_t sum = 0u;
+
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        sum = (sum << 1u) ^ (sum >> 31u) ^ p_data[i];
+    }
+
+    return sum;
+}
+
+
+
+__attribute__((noinline)) static void bench_Profile_Fill(uint8_t * p_data, uint32_t num_bytes, uint32_t seed)
+{
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        p_data[i] = (uint8_t)(seed + i);
+    }
+}
+
+
+
+/**
+ * Profiles a known workload for 2 seconds at 9973 Hz: per pass, fill a 4kB buffer once,
+ * checksum it three times, then sit in a 200 uSec delay. The flat profile from
+ * tools/profile_report.py should split roughly in proportion to the time each takes, with
+ * bench_Profile_Checksum about three times bench_Profile_Fill.
+ * 
+ * Prints:
+ *      - the sample counts and what sampling cost, per sample and as a share of the run
+ *      - the profile dump, every 10 seconds
+ */ 
+void bench_Profiler()
+{
+    const uint32_t RATE_HZ = 9973u;
+    const uint32_t RUN_uSec = 2000000u;
+    const uint32_t NUM_BYTES = 4096u;
+
+    static uint8_t data[4096];
+
+    BSP_Profiler_Report_t report;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_IRQ_Init();
+
+    while (1)
+    {
+        uint32_t checksum = 0u;
+
+        BSP_Profiler_Start(PSP_Time_Compare_Channel_3, RATE_HZ);
+
+        const uint64_t START_TIME = PSP_Time_Get_Ticks();
+
+        while ((PSP_Time_Get_Ticks() - START_TIME) < RUN_uSec)
+        {
+            bench_Profile_Fill(data, NUM_BYTES, checksum);
+
+            for (uint32_t i = 0u; i < 3u; i++)
+            {
+                checksum += bench_Profile_Checksum(data, NUM_BYTES);
+            }
+
+            PSP_Time_Delay_Microseconds(200u);
+        }
+
+        BSP_Profiler_Stop();
+        BSP_Profiler_Get_Report(&report);
+
+        bench_Report("profiler samples", report.samples, "");
+        bench_Report("    dropped", report.dropped, "");
+        bench_Report("    missed", report.missed, "");
+        bench_Report("    cost per sample", report.average_cycles, "cycles");
+        bench_Report("    longest sample", report.max_cycles, "cycles");
+        bench_Report("    overhead", report.overhead_ppm, "ppm");
+        bench_Report("    checksum", checksum, "");
+
+        BSP_Profiler_Dump();
+
+        PSP_Time_Delay_Microseconds(10000000u);
+    }
+}
+
+
+
+#define BENCH_RING_CAPACITY     256u
+#define BENCH_RING_RUN          16u
+#define BENCH_RING_SEQUENCE     0x0FFFFFFFu     // MPMC elements carry the producer above this
+
+static PSP_Ring_SPSC_t bench_spsc;
+static PSP_Ring_MPMC_t bench_mpmc;
+static uint32_t bench_spsc_buffer[BENCH_RING_CAPACITY];
+static uint32_t bench_mpmc_cells[BENCH_RING_CAPACITY * PSP_RING_MPMC_CELL_SIZE(4u) / 4u];
+static uint32_t bench_spsc_sequence;
+static uint32_t bench_mpmc_sequence;
+
+/**
+ * System Timer channel 1 handler for bench_Rings: every 20 uSec, pushes the next 8 numbers of
+ * its sequence into the SPSC ring and queues the next 4 of another as producer 1 of the MPMC
+ * queue, stopping early on full so the sequences stay gapless.
+ */
+static void bench_Rings_Timer_Handler(void)
+{
+    PSP_Time_Set_Compare(PSP_Time_Compare_Channel_1, (uint32_t)PSP_Time_Get_Ticks() + 20u);
+
+    for (uint32_t i = 0u; i < 8u; i++)
+    {
+        if (!PSP_Ring_SPSC_Push(&bench_spsc, &bench_spsc_sequence))
+        {
+            break;
+        }
+
+        bench_spsc_sequence++;
+    }
+
+    for (uint32_t i = 0u; i < 4u; i++)
+    {
+        const uint32_t VALUE = (1u << 28u) | (bench_mpmc_sequence & BENCH_RING_SEQUENCE);
+
+        if (!PSP_Ring_MPMC_Enqueue(&bench_mpmc, &VALUE))
+        {
+            break;
+        }
+
+        bench_mpmc_sequence++;
+    }
+}
+
+
+
+/**
+ * Checks a run of MPMC elements against each producer's next sequence number, returns how many
+ * were out of order.
+ */
+static uint32_t bench_Rings_Check(const uint32_t * p_values, uint32_t num_values, uint32_t * p_next)
+{
+    uint32_t errors = 0u;
+
+    for (uint32_t i = 0u; i < num_values; i++)
+    {
+        const uint32_t PRODUCER = (p_values[i] >> 28u) & 0x1u;
+        const uint32_t SEQUENCE = p_values[i] & BENCH_RING_SEQUENCE;
+
+        if (SEQUENCE != (p_next[PRODUCER] & BENCH_RING_SEQUENCE))
+        {
+            errors++;
+        }
+
+        p_next[PRODUCER] = SEQUENCE + 1u;
+    }
+
+    return errors;
+}
+
+
+
+/**
+ * Measures PSP_Ring throughput, then stresses the interrupt to main handoff. A 256 element
+ * ring of words is filled and emptied 16 times over, one element per call and then 16 per
+ * call, for the SPSC ring and the MPMC queue. Then for 1 second a 20 uSec System Timer
+ * interrupt produces into both while the main loop consumes both, and also produces into the
+ * MPMC queue itself, so the queue sees producers interrupting each other and the consumer.
+ * 
+ * Prints:
+ *      - SPSC and MPMC handoff rates (a push and a pop each), single and bulk
+ *      - for the stress run, how many elements went through each and how many arrived out of
+ *        order or missing, which should be 0
+ */ 
+void bench_Rings()
+{
+    const uint32_t NUM_ROUNDS = 16u;
+    const uint32_t RUN_uSec = 1000000u;
+
+    static uint32_t values[256];
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_IRQ_Init();
+
+    for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i++)
+    {
+        values[i] = i;
+    }
+
+    while (1)
+    {
+        PSP_Ring_SPSC_Init(&bench_spsc, bench_spsc_buffer, BENCH_RING_CAPACITY, sizeof(uint32_t));
+        PSP_Ring_MPMC_Init(&bench_mpmc, bench_mpmc_cells, BENCH_RING_CAPACITY, sizeof(uint32_t));
+
+        uint64_t start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t round = 0u; round < NUM_ROUNDS; round++)
+        {
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i++)
+            {
+                PSP_Ring_SPSC_Push(&bench_spsc, &values[i]);
+            }
+
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i++)
+            {
+                PSP_Ring_SPSC_Pop(&bench_spsc, &values[i]);
+            }
+        }
+
+        bench_Report_kHz("SPSC handoff", NUM_ROUNDS * BENCH_RING_CAPACITY, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t round = 0u; round < NUM_ROUNDS; round++)
+        {
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i += BENCH_RING_RUN)
+            {
+                PSP_Ring_SPSC_Push_Bulk(&bench_spsc, &values[i], BENCH_RING_RUN);
+            }
+
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i += BENCH_RING_RUN)
+            {
+                PSP_Ring_SPSC_Pop_Bulk(&bench_spsc, &values[i], BENCH_RING_RUN);
+            }
+        }
+
+        bench_Report_kHz("SPSC bulk handoff", NUM_ROUNDS * BENCH_RING_CAPACITY, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t round = 0u; round < NUM_ROUNDS; round++)
+        {
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i++)
+            {
+                PSP_Ring_MPMC_Enqueue(&bench_mpmc, &values[i]);
+            }
+
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i++)
+            {
+                PSP_Ring_MPMC_Dequeue(&bench_mpmc, &values[i]);
+            }
+        }
+
+        bench_Report_kHz("MPMC handoff", NUM_ROUNDS * BENCH_RING_CAPACITY, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t round = 0u; round < NUM_ROUNDS; round++)
+        {
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i += BENCH_RING_RUN)
+            {
+                PSP_Ring_MPMC_Enqueue_Bulk(&bench_mpmc, &values[i], BENCH_RING_RUN);
+            }
+
+            for (uint32_t i = 0u; i < BENCH_RING_CAPACITY; i += BENCH_RING_RUN)
+            {
+                PSP_Ring_MPMC_Dequeue_Bulk(&bench_mpmc, &values[i], BENCH_RING_RUN);
+            }
+        }
+
+        bench_Report_kHz("MPMC bulk handoff", NUM_ROUNDS * BENCH_RING_CAPACITY, (uint32_t)(PSP_Time_Get_Ticks() - start_time));
+
+        // stress: the interrupt produces into both, main consumes both and produces into MPMC
+        uint32_t spsc_next = 0u;
+        uint32_t mpmc_next[2] = {0u, 0u};
+        uint32_t main_sequence = 0u;
+        uint32_t spsc_count = 0u;
+        uint32_t mpmc_count = 0u;
+        uint32_t errors = 0u;
+        uint32_t num_values;
+
+        bench_spsc_sequence = 0u;
+        bench_mpmc_sequence = 0u;
+
+        PSP_IRQ_Attach(PSP_IRQ_SOURCE_SYSTEM_TIMER_1, bench_Rings_Timer_Handler);
+        PSP_Time_Set_Compare(PSP_Time_Compare_Channel_1, (uint32_t)PSP_Time_Get_Ticks() + 20u);
+
+        start_time = PSP_Time_Get_Ticks();
+
+        while (1)
+        {
+            const uint32_t RUNNING = ((PSP_Time_Get_Ticks() - start_time) < RUN_uSec);
+
+            if (!RUNNING)
+            {
+                PSP_IRQ_Detach(PSP_IRQ_SOURCE_SYSTEM_TIMER_1);
+                PSP_Time_Clear_Compare_Match(PSP_Time_Compare_Channel_1);
+            }
+            else
+            {
+                const uint32_t VALUE = main_sequence & BENCH_RING_SEQUENCE;
+
+                main_sequence += PSP_Ring_MPMC_Enqueue(&bench_mpmc, &VALUE);
+            }
+
+            num_values = PSP_Ring_SPSC_Pop_Bulk(&bench_spsc, values, BENCH_RING_RUN);
+
+            for (uint32_t i = 0u; i < num_values; i++)
+            {
+                errors += (values[i] != spsc_next++);
+            }
+
+            spsc_count += num_values;
+
+            num_values = PSP_Ring_MPMC_Dequeue_Bulk(&bench_mpmc, values, BENCH_RING_RUN);
+            errors += bench_Rings_Check(values, num_values, mpmc_next);
+            mpmc_count += num_values;
+
+            // drained after the interrupt has stopped
+            if (!RUNNING && (PSP_Ring_SPSC_Count(&bench_spsc) == 0u) && (num_values == 0u))
+            {
+                break;
+            }
+        }
+
+        // everything produced was consumed
+        errors += (spsc_count != bench_spsc_sequence);
+        errors += (mpmc_count != (bench_mpmc_sequence + main_sequence));
+
+        bench_Report("SPSC from interrupt", spsc_count, "elements");
+        bench_Report("MPMC from interrupt and main", mpmc_count, "elements");
+        bench_Report("    errors", errors, "");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+/**
+ * Measures PSP_Memory: sets up the system region, a 64kB arena, a pool of 256 64 byte blocks
+ * and a 4kB DMA region, then over and over allocates every pool block and frees them again,
+ * and fills the arena with 24 byte allocations inside a mark and resets it.
+ * 
+ * Prints:
+ *      - the system region's base and size, from _end to the top of the ARM's RAM
+ *      - the average cycles per pool alloc, pool free and arena alloc
+ *      - the pool's and arena's high-water marks and failed requests (the last alloc of each
+ *        round is meant to fail), the DMA region's misalignment (0 expected) and the system
+ *        region in use
+ */ 
+void bench_Memory()
+{
+    const uint32_t NUM_BLOCKS = 256u;
+    const uint32_t BLOCK_SIZE = 64u;
+    const uint32_t ARENA_SIZE = 65536u;
+    const uint32_t ALLOC_SIZE = 24u;
+
+    static void * blocks[256];
+
+    PSP_Memory_Arena_t arena;
+    PSP_Memory_Pool_t pool;
+    PSP_Memory_Stats_t stats;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_Memory_Init();
+    PSP_Memory_Get_Stats(&stats);
+
+    bench_Report("memory base", stats.base_address, "");
+    bench_Report("memory size", stats.size, "bytes");
+
+    PSP_Memory_Arena_Create(&arena, ARENA_SIZE);
+    PSP_Memory_Pool_Create(&pool, BLOCK_SIZE, NUM_BLOCKS, 0u);
+
+    void * const P_DMA = PSP_Memory_Alloc_DMA(4096u);
+
+    while (1)
+    {
+        uint32_t start_cycles = PSP_Time_Get_Cycles();
+
+        for (uint32_t i = 0u; i < NUM_BLOCKS; i++)
+        {
+            blocks[i] = PSP_Memory_Pool_Alloc(&pool);
+        }
+
+        const uint32_t ALLOC_CYCLES = (PSP_Time_Get_Cycles() - start_cycles) / NUM_BLOCKS;
+
+        PSP_Memory_Pool_Alloc(&pool); // empty by now, counted as failed
+
+        start_cycles = PSP_Time_Get_Cycles();
+
+        for (uint32_t i = 0u; i < NUM_BLOCKS; i++)
+        {
+            PSP_Memory_Pool_Free(&pool, blocks[i]);
+        }
+
+        const uint32_t FREE_CYCLES = (PSP_Time_Get_Cycles() - start_cycles) / NUM_BLOCKS;
+
+        const uint32_t MARK = PSP_Memory_Arena_Mark(&arena);
+        uint32_t num_allocs = 0u;
+
+        start_cycles = PSP_Time_Get_Cycles();
+
+        while (PSP_Memory_Arena_Alloc(&arena, ALLOC_SIZE, 0u) != 0)
+        {
+            num_allocs++;
+        }
+
+        const uint32_t ARENA_CYCLES = (PSP_Time_Get_Cycles() - start_cycles) / (num_allocs + 1u);
+
+        PSP_Memory_Arena_Reset(&arena, MARK);
+        PSP_Memory_Get_Stats(&stats);
+
+        bench_Report("pool alloc", ALLOC_CYCLES, "cycles");
+        bench_Report("pool free", FREE_CYCLES, "cycles");
+        bench_Report("arena alloc", ARENA_CYCLES, "cycles");
+        bench_Report("    pool high-water", pool.high_water, "blocks");
+        bench_Report("    pool failed", pool.num_failed, "");
+        bench_Report("    arena high-water", arena.high_water, "bytes");
+        bench_Report("    arena failed", arena.num_failed, "");
+        bench_Report("    DMA misalignment", (uint32_t)P_DMA % PSP_MEMORY_DMA_ALIGNMENT, "bytes");
+        bench_Report("    system region used", stats.used, "bytes");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+#define BENCH_DSP_SAMPLES       256u
+#define BENCH_DSP_TAPS          32u
+#define BENCH_DSP_FACTOR        4u
+
+/**
+ * Counts the float results further than 1e-5 from the reference, as full scale is 1.0.
+ */
+static uint32_t bench_DSP_Float_Mismatches(const float * p_a, const float * p_b, uint32_t num_samples)
+{
+    uint32_t mismatches = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        const float DIFFERENCE = p_a[i] - p_b[i];
+
+        mismatches += ((DIFFERENCE > 0.00001f) || (DIFFERENCE < -0.00001f));
+    }
+
+    return mismatches;
+}
+
+
+
+static uint32_t bench_DSP_Q15_Mismatches(const int16_t * p_a, const int16_t * p_b, uint32_t num_samples)
+{
+    uint32_t mismatches = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        mismatches += (p_a[i] != p_b[i]);
+    }
+
+    return mismatches;
+}
+
+
+
+static uint32_t bench_DSP_Q31_Mismatches(const int32_t * p_a, const int32_t * p_b, uint32_t num_samples)
+{
+    uint32_t mismatches = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        mismatches += (p_a[i] != p_b[i]);
+    }
+
+    return mismatches;
+}
+
+
+
+/**
+ * Measures the BSP_DSP kernels in cycles per input sample, on 256 samples of noise fed in as
+ * blocks of 64, and checks each against its BSP_DSP_Reference_* version. The FIRs have 32 taps
+ * (a triangle, gain 1), decimation and interpolation are by 4 with the same taps (times 4 to
+ * interpolate), the biquads are 2 stages of a Butterworth low pass at a tenth of the sample
+ * rate, and the moving averages are 16 long. Build with NEON=1 as well to compare NEON against
+ * plain ARM code.
+ * 
+ * Prints:
+ *      - cycles per sample for each kernel, and for the scalar reference FIR for comparison
+ *      - how many outputs differ from the reference: 0 expected, float allowed 1e-5 of rounding
+ */ 
+void bench_DSP()
+{
+    const uint32_t BLOCK = 64u;
+    const uint32_t STAGES = 2u;
+    const uint32_t AVERAGE_LENGTH = 16u;
+
+    // Butterworth low pass at fs / 10, b0 b1 b2 a1 a2, in Q30 and float
+    static const int32_t BIQUAD_Q31[10] = { 72429549, 144859098, 72429549, -1227265970, 443242341,
+                                            72429549, 144859098, 72429549, -1227265970, 443242341 };
+
+    static int16_t taps_q15[32];
+    static int16_t taps_x4_q15[32];
+    static int32_t taps_q31[32];
+    static float taps_f32[32];
+    static float taps_x4_f32[32];
+    static float biquad_f32[10];
+
+    static int16_t in_q15[256];
+    static int32_t in_q31[256];
+    static float in_f32[256 * 4];
+    static int16_t out_q15[256 * 4];
+    static int16_t reference_q15[256 * 4];
+    static int32_t out_q31[256];
+    static int32_t reference_q31[256];
+    static float out_f32[256 * 4];
+    static float reference_f32[256 * 4];
+
+    static int16_t state_q15[BENCH_DSP_TAPS + 64u];
+    static int32_t state_q31[BENCH_DSP_TAPS + 64u];
+    static float state_f32[BENCH_DSP_TAPS + 64u];
+    static int32_t biquad_state_q31[8];
+    static float biquad_state_f32[16];
+    static int16_t history_q15[16];
+    static float history_f32[16];
+
+    BSP_DSP_FIR_Q15_t fir_q15;
+    BSP_DSP_FIR_Q31_t fir_q31;
+    BSP_DSP_FIR_F32_t fir_f32;
+    BSP_DSP_Decimate_Q15_t decimate_q15;
+    BSP_DSP_Decimate_F32_t decimate_f32;
+    BSP_DSP_Interpolate_Q15_t interpolate_q15;
+    BSP_DSP_Interpolate_F32_t interpolate_f32;
+    BSP_DSP_Biquad_Q31_t biquad_q31;
+    BSP_DSP_Biquad_F32_t biquad_f32_filter;
+    BSP_DSP_Moving_Average_Q15_t average_q15;
+    BSP_DSP_Moving_Average_F32_t average_f32;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    // a triangle, 1 2 ... 16 16 ... 2 1, over its sum of 272
+    for (uint32_t i = 0u; i < BENCH_DSP_TAPS; i++)
+    {
+        const int32_t HEIGHT = (i < (BENCH_DSP_TAPS / 2u)) ? (int32_t)(i + 1u) : (int32_t)(BENCH_DSP_TAPS - i);
+
+        taps_q15[i] = (int16_t)((HEIGHT * 32767) / 272);
+        taps_x4_q15[i] = (int16_t)((HEIGHT * 32767 * 4) / 272);
+        taps_q31[i] = (int32_t)(((int64_t)HEIGHT * 2147483647) / 272);
+        taps_f32[i] = (float)HEIGHT / 272.0f;
+        taps_x4_f32[i] = (float)HEIGHT * 4.0f / 272.0f;
+    }
+
+    for (uint32_t i = 0u; i < 10u; i++)
+    {
+        biquad_f32[i] = (float)BIQUAD_Q31[i] / 1073741824.0f;
+    }
+
+    uint32_t seed = 1u;
+
+    for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i++)
+    {
+        seed = (seed * 1664525u) + 1013904223u;
+        in_q15[i] = (int16_t)(seed >> 16u);
+        in_q31[i] = (int32_t)seed;
+        in_f32[i] = (float)in_q15[i] / 32768.0f;
+    }
+
+    while (1)
+    {
+        uint32_t start_cycles;
+        uint32_t num_outputs;
+
+        BSP_DSP_FIR_Q15_Init(&fir_q15, taps_q15, BENCH_DSP_TAPS, state_q15, BLOCK);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_FIR_Q15(&fir_q15, &in_q15[i], &out_q15[i], BLOCK);
+        }
+        bench_Report("FIR Q15 32 taps", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+
+        start_cycles = PSP_Time_Get_Cycles();
+        BSP_DSP_Reference_FIR_Q15(taps_q15, BENCH_DSP_TAPS, in_q15, reference_q15, BENCH_DSP_SAMPLES);
+        bench_Report("    reference", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        bench_Report("    mismatches", bench_DSP_Q15_Mismatches(out_q15, reference_q15, BENCH_DSP_SAMPLES), "");
+
+        BSP_DSP_FIR_Q31_Init(&fir_q31, taps_q31, BENCH_DSP_TAPS, state_q31, BLOCK);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_FIR_Q31(&fir_q31, &in_q31[i], &out_q31[i], BLOCK);
+        }
+        bench_Report("FIR Q31 32 taps", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_FIR_Q31(taps_q31, BENCH_DSP_TAPS, in_q31, reference_q31, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Q31_Mismatches(out_q31, reference_q31, BENCH_DSP_SAMPLES), "");
+
+        BSP_DSP_FIR_F32_Init(&fir_f32, taps_f32, BENCH_DSP_TAPS, state_f32, BLOCK);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_FIR_F32(&fir_f32, &in_f32[i], &out_f32[i], BLOCK);
+        }
+        bench_Report("FIR float 32 taps", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_FIR_F32(taps_f32, BENCH_DSP_TAPS, in_f32, reference_f32, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Float_Mismatches(out_f32, reference_f32, BENCH_DSP_SAMPLES), "");
+
+        BSP_DSP_Decimate_Q15_Init(&decimate_q15, taps_q15, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, state_q15, BLOCK);
+        num_outputs = 0u;
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            num_outputs += BSP_DSP_Decimate_Q15(&decimate_q15, &in_q15[i], &out_q15[num_outputs], BLOCK);
+        }
+        bench_Report("decimate Q15 by 4", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Decimate_Q15(taps_q15, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, in_q15, reference_q15, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Q15_Mismatches(out_q15, reference_q15, num_outputs), "");
+
+        BSP_DSP_Decimate_F32_Init(&decimate_f32, taps_f32, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, state_f32, BLOCK);
+        num_outputs = 0u;
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            num_outputs += BSP_DSP_Decimate_F32(&decimate_f32, &in_f32[i], &out_f32[num_outputs], BLOCK);
+        }
+        bench_Report("decimate float by 4", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Decimate_F32(taps_f32, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, in_f32, reference_f32, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Float_Mismatches(out_f32, reference_f32, num_outputs), "");
+
+        BSP_DSP_Interpolate_Q15_Init(&interpolate_q15, taps_x4_q15, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, state_q15, BLOCK);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_Interpolate_Q15(&interpolate_q15, &in_q15[i], &out_q15[i * BENCH_DSP_FACTOR], BLOCK);
+        }
+        bench_Report("interpolate Q15 by 4", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Interpolate_Q15(taps_x4_q15, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, in_q15, reference_q15, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Q15_Mismatches(out_q15, reference_q15, BENCH_DSP_SAMPLES * BENCH_DSP_FACTOR), "");
+
+        BSP_DSP_Interpolate_F32_Init(&interpolate_f32, taps_x4_f32, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, state_f32, BLOCK);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_Interpolate_F32(&interpolate_f32, &in_f32[i], &out_f32[i * BENCH_DSP_FACTOR], BLOCK);
+        }
+        bench_Report("interpolate float by 4", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Interpolate_F32(taps_x4_f32, BENCH_DSP_TAPS, BENCH_DSP_FACTOR, in_f32, reference_f32, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Float_Mismatches(out_f32, reference_f32, BENCH_DSP_SAMPLES * BENCH_DSP_FACTOR), "");
+
+        BSP_DSP_Biquad_Q31_Init(&biquad_q31, BIQUAD_Q31, STAGES, biquad_state_q31);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_Biquad_Q31(&biquad_q31, &in_q31[i], &out_q31[i], BLOCK);
+        }
+        bench_Report("biquad Q31 2 stages", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Biquad_Q31(BIQUAD_Q31, STAGES, in_q31, reference_q31, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Q31_Mismatches(out_q31, reference_q31, BENCH_DSP_SAMPLES), "");
+
+        BSP_DSP_Biquad_F32_Init(&biquad_f32_filter, biquad_f32, STAGES, biquad_state_f32);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_Biquad_F32(&biquad_f32_filter, &in_f32[i], &out_f32[i], BLOCK);
+        }
+        bench_Report("biquad float 2 stages", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Biquad_F32(biquad_f32, STAGES, in_f32, reference_f32, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Float_Mismatches(out_f32, reference_f32, BENCH_DSP_SAMPLES), "");
+
+        // 4 streams, all the same so the single stream reference still applies
+        for (uint32_t i = BENCH_DSP_SAMPLES; i-- > 0u;)
+        {
+            for (uint32_t stream = 4u; stream-- > 0u;)
+            {
+                in_f32[(i * 4u) + stream] = in_f32[i];
+            }
+        }
+
+        BSP_DSP_Biquad_F32x4_Init(&biquad_f32_filter, biquad_f32, STAGES, biquad_state_f32);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_Biquad_F32x4(&biquad_f32_filter, &in_f32[i * 4u], &out_f32[i * 4u], BLOCK);
+        }
+        bench_Report("biquad float x4 streams", (PSP_Time_Get_Cycles() - start_cycles) / (BENCH_DSP_SAMPLES * 4u), "cycles/sample");
+
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i++)
+        {
+            in_f32[i] = in_f32[i * 4u];
+            out_f32[i] = out_f32[(i * 4u) + 3u];
+        }
+        bench_Report("    mismatches", bench_DSP_Float_Mismatches(out_f32, reference_f32, BENCH_DSP_SAMPLES), "");
+
+        BSP_DSP_Moving_Average_Q15_Init(&average_q15, history_q15, AVERAGE_LENGTH);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_Moving_Average_Q15(&average_q15, &in_q15[i], &out_q15[i], BLOCK);
+        }
+        bench_Report("moving average Q15 16", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Moving_Average_Q15(AVERAGE_LENGTH, in_q15, reference_q15, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Q15_Mismatches(out_q15, reference_q15, BENCH_DSP_SAMPLES), "");
+
+        BSP_DSP_Moving_Average_F32_Init(&average_f32, history_f32, AVERAGE_LENGTH);
+        start_cycles = PSP_Time_Get_Cycles();
+        for (uint32_t i = 0u; i < BENCH_DSP_SAMPLES; i += BLOCK)
+        {
+            BSP_DSP_Moving_Average_F32(&average_f32, &in_f32[i], &out_f32[i], BLOCK);
+        }
+        bench_Report("moving average float 16", (PSP_Time_Get_Cycles() - start_cycles) / BENCH_DSP_SAMPLES, "cycles/sample");
+        BSP_DSP_Reference_Moving_Average_F32(AVERAGE_LENGTH, in_f32, reference_f32, BENCH_DSP_SAMPLES);
+        bench_Report("    mismatches", bench_DSP_Float_Mismatches(out_f32, reference_f32, BENCH_DSP_SAMPLES), "");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+#define BENCH_FFT_CHECK_POINTS  256u
+
+/**
+ * FFT benchmark.
+ * 
+ * Times the float and Q15, complex and real transforms at every size from 64 to 4096 points
+ * on noise, then checks the 256 point ones against BSP_FFT_Reference_DFT_F32. Build with
+ * NEON=1 as well to compare NEON against plain ARM code.
+ * 
+ * Prints:
+ *      - microseconds per transform, per size
+ *      - how many bins are off from the reference: 0 expected, with float allowed 1e-3 and
+ *        Q15 (scaled by 1 / 256) 4 LSBs
+ */ 
+void bench_FFT()
+{
+    static float input_f32[2u * BSP_FFT_MAX_POINTS];
+    static float data_f32[2u * BSP_FFT_MAX_POINTS];
+    static float reference_f32[2u * BENCH_FFT_CHECK_POINTS];
+    static float twiddles_f32[BSP_FFT_TWIDDLE_SIZE(BSP_FFT_MAX_POINTS)];
+    static int16_t input_q15[2u * BSP_FFT_MAX_POINTS];
+    static int16_t data_q15[2u * BSP_FFT_MAX_POINTS];
+    static int16_t twiddles_q15[BSP_FFT_TWIDDLE_SIZE(BSP_FFT_MAX_POINTS)];
+
+    BSP_FFT_F32_t fft_f32;
+    BSP_FFT_Q15_t fft_q15;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    // complex noise inside the unit circle, the same in both formats
+    uint32_t seed = 1u;
+
+    for (uint32_t i = 0u; i < (2u * BSP_FFT_MAX_POINTS); i++)
+    {
+        seed = (seed * 1664525u) + 1013904223u;
+        input_q15[i] = (int16_t)((int32_t)(seed >> 16u) - 32768) / 2;
+        input_f32[i] = (float)input_q15[i] / 32768.0f;
+    }
+
+    while (1)
+    {
+        for (uint32_t num_points = BSP_FFT_MIN_POINTS; num_points <= BSP_FFT_MAX_POINTS; num_points *= 2u)
+        {
+            uint64_t start_time;
+
+            BSP_FFT_F32_Init(&fft_f32, num_points, twiddles_f32);
+            BSP_FFT_Q15_Init(&fft_q15, num_points, twiddles_q15);
+
+            PSP_AUX_Mini_Uart_Send_String("FFT points: ");
+            PSP_AUX_Mini_Uart_Send_Decimal(num_points);
+            PSP_AUX_Mini_Uart_Send_String("\r\n");
+
+            // a fresh copy of the input each time, as the transforms work in place
+            memcpy(data_f32, input_f32, 2u * num_points * sizeof(float));
+            start_time = PSP_Time_Get_Ticks();
+            BSP_FFT_F32_Complex(&fft_f32, data_f32);
+            bench_Report("    float complex", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+            memcpy(data_f32, input_f32, num_points * sizeof(float));
+            start_time = PSP_Time_Get_Ticks();
+            BSP_FFT_F32_Real(&fft_f32, data_f32);
+            bench_Report("    float real", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+            memcpy(data_q15, input_q15, 2u * num_points * sizeof(int16_t));
+            start_time = PSP_Time_Get_Ticks();
+            BSP_FFT_Q15_Complex(&fft_q15, data_q15);
+            bench_Report("    Q15 complex", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+
+            memcpy(data_q15, input_q15, num_points * sizeof(int16_t));
+            start_time = PSP_Time_Get_Ticks();
+            BSP_FFT_Q15_Real(&fft_q15, data_q15);
+            bench_Report("    Q15 real", (uint32_t)(PSP_Time_Get_Ticks() - start_time), "us");
+        }
+
+        const uint32_t N = BENCH_FFT_CHECK_POINTS;
+        uint32_t mismatches = 0u;
+
+        BSP_FFT_F32_Init(&fft_f32, N, twiddles_f32);
+        BSP_FFT_Q15_Init(&fft_q15, N, twiddles_q15);
+
+        BSP_FFT_Reference_DFT_F32(&fft_f32, input_f32, reference_f32);
+        memcpy(data_f32, input_f32, 2u * N * sizeof(float));
+        BSP_FFT_F32_Complex(&fft_f32, data_f32);
+        memcpy(data_q15, input_q15, 2u * N * sizeof(int16_t));
+        BSP_FFT_Q15_Complex(&fft_q15, data_q15);
+
+        for (uint32_t i = 0u; i < (2u * N); i++)
+        {
+            const float ERROR_F32 = data_f32[i] - reference_f32[i];
+            const float ERROR_Q15 = (float)data_q15[i] - ((reference_f32[i] * 32768.0f) / (float)N);
+
+            mismatches += ((ERROR_F32 > 0.001f) || (ERROR_F32 < -0.001f) || (ERROR_Q15 > 4.0f) || (ERROR_Q15 < -4.0f));
+        }
+
+        bench_Report("256 point complex mismatches", mismatches, "");
+
+        // the same real samples as a complex input with no imaginary part, for the reference
+        for (uint32_t i = 0u; i < N; i++)
+        {
+            data_f32[2u * i] = input_f32[i];
+            data_f32[(2u * i) + 1u] = 0.0f;
+        }
+
+        BSP_FFT_Reference_DFT_F32(&fft_f32, data_f32, reference_f32);
+        memcpy(data_f32, input_f32, N * sizeof(float));
+        BSP_FFT_F32_Real(&fft_f32, data_f32);
+        memcpy(data_q15, input_q15, N * sizeof(int16_t));
+        BSP_FFT_Q15_Real(&fft_q15, data_q15);
+
+        // DC's pair holds Nyquist's real part in place of its imaginary one
+        reference_f32[1] = reference_f32[N];
+        mismatches = 0u;
+
+        for (uint32_t i = 0u; i < N; i++)
+        {
+            const float ERROR_F32 = data_f32[i] - reference_f32[i];
+            const float ERROR_Q15 = (float)data_q15[i] - ((reference_f32[i] * 32768.0f) / (float)N);
+
+            mismatches += ((ERROR_F32 > 0.001f) || (ERROR_F32 < -0.001f) || (ERROR_Q15 > 4.0f) || (ERROR_Q15 < -4.0f));
+        }
+
+        bench_Report("256 point real mismatches", mismatches, "");
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+#define BENCH_CRC_BYTES     65536u
+
+/**
+ * Checks a CRC function against its check value and against itself fed in uneven pieces,
+ * and times it over the bench_CRC buffer, printing both.
+ */
+static void bench_CRC_Run(char * name, uint32_t (*p_crc)(uint32_t, const void *, uint32_t), uint32_t check_value, const uint8_t * p_buffer)
+{
+    const uint32_t NUM_PASSES = 16u;
+
+    uint32_t mismatches = (p_crc(0u, "123456789", 9u) != check_value);
+
+    // one go against 1, 2, 3, ... bytes at a time, starting off a word boundary
+    const uint32_t WHOLE = p_crc(0u, &p_buffer[1], BENCH_CRC_BYTES - 1u);
+    uint32_t crc = 0u;
+    uint32_t offset = 1u;
+
+    for (uint32_t size = 1u; offset < BENCH_CRC_BYTES; size++)
+    {
+        const uint32_t SIZE = ((BENCH_CRC_BYTES - offset) < size) ? (BENCH_CRC_BYTES - offset) : size;
+
+        crc = p_crc(crc, &p_buffer[offset], SIZE);
+        offset += SIZE;
+    }
+
+    mismatches += (crc != WHOLE);
+
+    const uint64_t START_TIME = PSP_Time_Get_Ticks();
+
+    for (uint32_t pass = 0u; pass < NUM_PASSES; pass++)
+    {
+        crc = p_crc(crc, p_buffer, BENCH_CRC_BYTES);
+    }
+
+    uint32_t elapsed_uSec = (uint32_t)(PSP_Time_Get_Ticks() - START_TIME);
+
+    if (elapsed_uSec == 0u)
+    {
+        elapsed_uSec = 1u;
+    }
+
+    PSP_AUX_Mini_Uart_Send_String(name);
+    PSP_AUX_Mini_Uart_Send_String("\r\n");
+    bench_Report("    throughput", (NUM_PASSES * BENCH_CRC_BYTES) / elapsed_uSec, "MB/s");
+    bench_Report("    mismatches", mismatches, "");
+}
+
+
+
+/**
+ * CRC benchmark.
+ * 
+ * Runs CRC-32 and CRC-32C over 64 KB of noise, first with the slice-by-8 tables and then,
+ * on cores that have them, with the CRC32 instructions. Throughput is in MB/s (bytes per
+ * microsecond), as GB/s is well out of reach with the data cache off.
+ * 
+ * Prints:
+ *      - whether the CRC32 instructions are there
+ *      - MB/s for each CRC and method
+ *      - mismatches: the check value of "123456789" and the CRC of the buffer fed in
+ *        pieces against fed in one go, 0 expected
+ */ 
+void bench_CRC()
+{
+    static uint8_t buffer[BENCH_CRC_BYTES];
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    uint32_t seed = 1u;
+
+    for (uint32_t i = 0u; i < BENCH_CRC_BYTES; i++)
+    {
+        seed = (seed * 1664525u) + 1013904223u;
+        buffer[i] = (uint8_t)(seed >> 24u);
+    }
+
+    while (1)
+    {
+        PSP_CRC_Init(0u);
+        bench_CRC_Run("CRC-32 tables", PSP_CRC_32, 0xCBF43926u, buffer);
+        bench_CRC_Run("CRC-32C tables", PSP_CRC_32C, 0xE3069283u, buffer);
+
+        const uint32_t HAVE_INSTRUCTIONS = PSP_CRC_Init(1u);
+
+        bench_Report("CRC32 instructions", HAVE_INSTRUCTIONS, "(1 if present)");
+
+        if (HAVE_INSTRUCTIONS)
+        {
+            bench_CRC_Run("CRC-32 instructions", PSP_CRC_32, 0xCBF43926u, buffer);
+            bench_CRC_Run("CRC-32C instructions", PSP_CRC_32C, 0xE3069283u, buffer);
+        }
+
+        PSP_Time_Delay_Microseconds(1000000u);
+    }
+}
+
+
+
+#define BENCH_TELEMETRY_CHANNELS    4u
+#define BENCH_TELEMETRY_SAMPLES     256u    // per channel
+#define BENCH_TELEMETRY_RUN         32u     // samples per channel per frame
+
+/**
+ * Telemetry benchmark.
+ * 
+ * Sends the same 4 channels of 256 samples of 12 bit ADC-like readings (a random walk of up
+ * to +-20 a step) first as text lines, "adc0: 2048", and then as BSP_Telemetry frames of 32
+ * samples a channel, and compares how long each takes over the 115200 baud mini uart. Save
+ * the terminal's output to a file and tools/telemetry_decode.py decodes the frames from it.
+ * 
+ * Prints (after the text lines and the binary frames):
+ *      - bytes sent and samples per second for each
+ *      - the telemetry's speed as a percentage of the text's, 300 to 500 expected
+ */ 
+void bench_Telemetry()
+{
+    static int32_t samples[BENCH_TELEMETRY_CHANNELS][BENCH_TELEMETRY_SAMPLES];
+    static char * const NAMES[BENCH_TELEMETRY_CHANNELS] = { "adc0", "adc1", "adc2", "adc3" };
+
+    const uint32_t NUM_SAMPLES = BENCH_TELEMETRY_CHANNELS * BENCH_TELEMETRY_SAMPLES;
+
+    uint32_t channels[BENCH_TELEMETRY_CHANNELS];
+    uint32_t seed = 1u;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    for (uint32_t channel = 0u; channel < BENCH_TELEMETRY_CHANNELS; channel++)
+    {
+        int32_t value = 2048;
+
+        for (uint32_t i = 0u; i < BENCH_TELEMETRY_SAMPLES; i++)
+        {
+            seed = (seed * 1664525u) + 1013904223u;
+            value += (int32_t)((seed >> 24u) % 41u) - 20;
+            value = (value < 0) ? 0 : ((value > 4095) ? 4095 : value);
+            samples[channel][i] = value;
+        }
+    }
+
+    while (1)
+    {
+        // text, a line per sample
+        uint32_t text_bytes = 0u;
+        uint64_t start_time = PSP_Time_Get_Ticks();
+
+        for (uint32_t i = 0u; i < BENCH_TELEMETRY_SAMPLES; i++)
+        {
+            for (uint32_t channel = 0u; channel < BENCH_TELEMETRY_CHANNELS; channel++)
+            {
+                const uint32_t VALUE = (uint32_t)samples[channel][i];
+
+                PSP_AUX_Mini_Uart_Send_String(NAMES[channel]);
+                PSP_AUX_Mini_Uart_Send_String(": ");
+                PSP_AUX_Mini_Uart_Send_Decimal(VALUE);
+                PSP_AUX_Mini_Uart_Send_String("\r\n");
+
+                text_bytes += 8u + (VALUE >= 10u) + (VALUE >= 100u) + (VALUE >= 1000u);
+            }
+        }
+
+        const uint32_t TEXT_USEC = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        // telemetry, the same samples
+        BSP_Telemetry_Init();
+
+        for (uint32_t channel = 0u; channel < BENCH_TELEMETRY_CHANNELS; channel++)
+        {
+            channels[channel] = BSP_Telemetry_Add_Channel(NAMES[channel], BSP_Telemetry_Type_Int32);
+        }
+
+        start_time = PSP_Time_Get_Ticks();
+
+        BSP_Telemetry_Send_Channels();
+
+        for (uint32_t i = 0u; i < BENCH_TELEMETRY_SAMPLES; i += BENCH_TELEMETRY_RUN)
+        {
+            // wait for room rather than drop, as every frame is counted
+            while (!BSP_Telemetry_Begin_Frame((uint32_t)PSP_Time_Get_Ticks()))
+            {
+                BSP_Telemetry_Service();
+            }
+
+            for (uint32_t channel = 0u; channel < BENCH_TELEMETRY_CHANNELS; channel++)
+            {
+                BSP_Telemetry_Add_Int32(channels[channel], &samples[channel][i], BENCH_TELEMETRY_RUN);
+            }
+
+            BSP_Telemetry_End_Frame();
+            BSP_Telemetry_Service();
+        }
+
+        BSP_Telemetry_Flush();
+
+        const uint32_t TELEMETRY_USEC = (uint32_t)(PSP_Time_Get_Ticks() - start_time);
+
+        BSP_Telemetry_Stats_t stats;
+
+        BSP_Telemetry_Get_Stats(&stats);
+
+        PSP_AUX_Mini_Uart_Send_String("\r\n");
+        bench_Report("Text bytes", text_bytes, "");
+        bench_Report_kHz("Text samples", NUM_SAMPLES, TEXT_USEC);
+        bench_Report("Telemetry bytes", stats.num_wire_bytes, "");
+        bench_Report_kHz("Telemetry samples", NUM_SAMPLES, TELEMETRY_USEC);
+        bench_Report("Telemetry speed vs text", (TELEMETRY_USEC != 0u) ? ((TEXT_USEC * 100u) / TELEMETRY_USEC) : 0u, "%");
+
+        PSP_Time_Delay_Microseconds(5000000u);
+    }
+}
+
+#endif
@@ -4,7 +4,8 @@
  *      integer types.
  * 
  * NOTES:
- *      Assumes the Raspberry Pi is operating in 32 bit mode.
+ *      Assumes the Raspberry Pi is operating in 32 bit mode. The host tests (make test) build
+ *      with PSP_HOST_BUILD defined and take the host C library's types instead.
  * 
  * REFERENCES:
  *      https://raspberry-projects.com/pi/programming-in-c/memory/variables
@@ -14,6 +15,9 @@
 #ifndef FIXED_WIDTH_INTS_H_INCLUDED
 #define FIXED_WIDTH_INTS_H_INCLUDED
 
+#if defined(PSP_HOST_BUILD)
+#include <stdint.h>
+#else
 typedef signed char          int8_t; // -128 to 127
 typedef unsigned char       uint8_t; // 0 to 255
 typedef short int           int16_t; // -32768 to 32767
@@ -22,5 +26,7 @@ typedef int                 int32_t; // -2147483648 to 2147483647
 typedef unsigned int       uint32_t; // 0 to 4294967295
 typedef long long           int64_t; // −9,223,372,036,854,775,808 to 9,223,372,036,854,775,807
 typedef unsigned long long uint64_t; // 0 to 18,446,744,073,709,551,615
+typedef unsigned int      uintptr_t; // a pointer as an integer, for alignment checks
+#endif
 
 #endif
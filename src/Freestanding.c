@@ -0,0 +1,124 @@
+
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private Freestanding Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// stop GCC from recognizing the loops below as memset/memcpy and calling themselves
+#define FREESTANDING_NO_LIBCALLS __attribute__((optimize("no-tree-loop-distribute-patterns")))
+
+#define WORD_ALIGNED(p) ((((uint32_t)(p)) & 3u) == 0u)
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Freestanding Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+FREESTANDING_NO_LIBCALLS
+void * memset(void * p_dest, int value, uint32_t num_bytes)
+{
+    uint8_t * p_byte = (uint8_t *)p_dest;
+
+    // bytes until the destination is word aligned, then whole words, then the leftover bytes
+    while ((num_bytes > 0u) && !WORD_ALIGNED(p_byte))
+    {
+        *p_byte++ = (uint8_t)value;
+        num_bytes--;
+    }
+
+    uint32_t * p_word = (uint32_t *)p_byte;
+    const uint32_t WORD_VALUE = (uint8_t)value * 0x01010101u;
+
+    while (num_bytes >= sizeof(uint32_t))
+    {
+        *p_word++ = WORD_VALUE;
+        num_bytes -= sizeof(uint32_t);
+    }
+
+    p_byte = (uint8_t *)p_word;
+
+    while (num_bytes > 0u)
+    {
+        *p_byte++ = (uint8_t)value;
+        num_bytes--;
+    }
+
+    return p_dest;
+}
+
+
+
+FREESTANDING_NO_LIBCALLS
+void * memcpy(void * p_dest, const void * p_src, uint32_t num_bytes)
+{
+    uint8_t * p_dest_byte = (uint8_t *)p_dest;
+    const uint8_t * p_src_byte = (const uint8_t *)p_src;
+
+    // whole words if both sides are word aligned, otherwise byte at a time
+    if (WORD_ALIGNED(p_dest_byte) && WORD_ALIGNED(p_src_byte))
+    {
+        uint32_t * p_dest_word = (uint32_t *)p_dest_byte;
+        const uint32_t * p_src_word = (const uint32_t *)p_src_byte;
+
+        while (num_bytes >= sizeof(uint32_t))
+        {
+            *p_dest_word++ = *p_src_word++;
+            num_bytes -= sizeof(uint32_t);
+        }
+
+        p_dest_byte = (uint8_t *)p_dest_word;
+        p_src_byte = (const uint8_t *)p_src_word;
+    }
+
+    while (num_bytes > 0u)
+    {
+        *p_dest_byte++ = *p_src_byte++;
+        num_bytes--;
+    }
+
+    return p_dest;
+}
+
+
+
+FREESTANDING_NO_LIBCALLS
+void * memmove(void * p_dest, const void * p_src, uint32_t num_bytes)
+{
+    uint8_t * p_dest_byte = (uint8_t *)p_dest;
+    const uint8_t * p_src_byte = (const uint8_t *)p_src;
+
+    if ((p_dest_byte <= p_src_byte) || (p_dest_byte >= (p_src_byte + num_bytes)))
+    {
+        return memcpy(p_dest, p_src, num_bytes); // no overlap that a forward copy would trip over
+    }
+
+    // the destination overlaps the end of the source, copy backwards
+    while (num_bytes > 0u)
+    {
+        num_bytes--;
+        p_dest_byte[num_bytes] = p_src_byte[num_bytes];
+    }
+
+    return p_dest;
+}
+
+
+
+FREESTANDING_NO_LIBCALLS
+int memcmp(const void * p_a, const void * p_b, uint32_t num_bytes)
+{
+    const uint8_t * p_a_byte = (const uint8_t *)p_a;
+    const uint8_t * p_b_byte = (const uint8_t *)p_b;
+
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        if (p_a_byte[i] != p_b_byte[i])
+        {
+            return (int)p_a_byte[i] - (int)p_b_byte[i];
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,39 @@
+/**
+ * DESCRIPTION:
+ *      Freestanding provides the handful of C library memory functions that GCC expects to
+ *      exist even in a -ffreestanding build.
+ * 
+ * NOTES:
+ *      GCC is allowed to turn struct copies and fill/copy loops into calls to memset, memcpy,
+ *      memmove and memcmp, and there is no C library to supply them here. These are simple 
+ *      byte/word loops, good enough for zeroing buffers and copying blocks around.
+ *
+ *      The host tests (make test) build with PSP_HOST_BUILD defined and use the host C
+ *      library's instead.
+ * 
+ * REFERENCES:
+ *      https://gcc.gnu.org/onlinedocs/gcc/Standards.html
+ */
+
+#ifndef FREESTANDING_H_INCLUDED
+#define FREESTANDING_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+#if defined(PSP_HOST_BUILD)
+#include <string.h>
+#else
+
+/*-----------------------------------------------------------------------------------------------
+    Public Freestanding Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+// these follow the C standard library definitions, size_t is always 32 bits here
+void * memset(void * p_dest, int value, uint32_t num_bytes);
+void * memcpy(void * p_dest, const void * p_src, uint32_t num_bytes);
+void * memmove(void * p_dest, const void * p_src, uint32_t num_bytes);
+int memcmp(const void * p_a, const void * p_b, uint32_t num_bytes);
+
+#endif
+
+#endif
@@ -19,11 +19,18 @@
 #define HARDWARE_DEMOS_H_INCLUDED
 
 #include "PSP_GPIO.h"
+#include "PSP_GPIO_Debounce.h"
+#include "PSP_IRQ.h"
 #include "PSP_Time.h"
 #include "PSP_PWM.h"
 #include "PSP_SPI_0.h"
 #include "PSP_I2C.h"
+#include "PSP_BSC_Slave.h"
 #include "PSP_Aux_Mini_UART.h"
+#include "BSP_Logic_Analyzer.h"
+#include "BSP_WS2812.h"
+#include "BSP_Soft_PWM.h"
+#include "BSP_Pattern_Generator.h"
 
 
 
@@ -32,7 +39,8 @@
  * 
  * Reads a switch and blinks a LED if the switch is HIGH.
  * 
- * To verify: attach a switch to pin 21 and a LED to pin 17.
+ * To verify: attach a switch between pin 21 and 3.3V and a LED to pin 17. The internal
+ * pull-down holds pin 21 LOW while the switch is open, no external resistor needed.
  */ 
 void demo_GPIO()
 {
@@ -42,6 +50,7 @@ void demo_GPIO()
 
     PSP_GPIO_Set_Pin_Mode(LED_PIN, PSP_GPIO_PINMODE_OUTPUT);
     PSP_GPIO_Set_Pin_Mode(SWITCH_PIN, PSP_GPIO_PINMODE_INPUT);
+    PSP_GPIO_Set_Pin_Pull(SWITCH_PIN, PSP_GPIO_Pull_Down);
 
     while(1)
     {
@@ -58,6 +67,45 @@ void demo_GPIO()
 
 
 
+/**
+ * Simple demo of the GPIO debouncer.
+ * 
+ * Toggles a LED each time a switch is pressed, bouncy contacts and all.
+ * 
+ * To verify: attach a switch between pin 21 and ground and a LED to pin 17. The internal pull-up
+ * holds pin 21 HIGH while the switch is open. Each press should toggle the LED exactly once, try
+ * the same thing with PSP_GPIO_Read_Pin to see the difference.
+ */ 
+void demo_GPIO_Debounce()
+{
+    const uint32_t LED_PIN  = 17u;
+    const uint32_t SWITCH_PIN = 21u;
+
+    uint32_t led_value = PSP_GPIO_PIN_WRITE_LOW;
+
+    PSP_GPIO_Set_Pin_Mode(LED_PIN, PSP_GPIO_PINMODE_OUTPUT);
+    PSP_GPIO_Set_Pin_Mode(SWITCH_PIN, PSP_GPIO_PINMODE_INPUT);
+    PSP_GPIO_Set_Pin_Pull(SWITCH_PIN, PSP_GPIO_Pull_Up);
+
+    PSP_GPIO_Debounce_Start(PSP_GPIO_DEBOUNCE_DEFAULT_PERIOD_uSec);
+
+    while(1)
+    {
+        PSP_GPIO_Debounce_Service();
+
+        // the switch pulls the pin LOW when pressed, so look for falling edges
+        uint32_t changes = PSP_GPIO_Debounce_Take_Changes(0u);
+
+        if (changes & ~PSP_GPIO_Debounce_Read_Bank(0u) & PSP_GPIO_PIN_MASK(SWITCH_PIN))
+        {
+            led_value = !led_value;
+            PSP_GPIO_Write_Pin(LED_PIN, led_value);
+        }
+    }
+}
+
+
+
 /**
  * Simple demo of hardware PWM.
  * 
@@ -145,16 +193,16 @@ void demo_I2C()
 
     const uint32_t SLAVE_ADDRESS = 0x27u;
 
-    PSP_I2C_Start();
-    // use default divider for ~100kHz clock speed
-    PSP_I2C_Set_Slave_Address(SLAVE_ADDRESS);
+    // BSC1 on GPIO2/3, starts at 100kHz
+    PSP_I2C_Start(PSP_I2C_Bus_1, 2u);
+    PSP_I2C_Set_Slave_Address(PSP_I2C_Bus_1, SLAVE_ADDRESS);
 
     while (1)
     {
-        PSP_I2C_Write_Byte(0xFEu);
-        PSP_I2C_Write_Byte(0xEDu);
-        PSP_I2C_Write_Byte(0xFAu);
-        PSP_I2C_Write_Byte(0xCEu);
+        PSP_I2C_Write_Byte(PSP_I2C_Bus_1, 0xFEu);
+        PSP_I2C_Write_Byte(PSP_I2C_Bus_1, 0xEDu);
+        PSP_I2C_Write_Byte(PSP_I2C_Bus_1, 0xFAu);
+        PSP_I2C_Write_Byte(PSP_I2C_Bus_1, 0xCEu);
 
         PSP_Time_Delay_Microseconds(DELAY_TIME_uSec);    
     }
@@ -184,4 +232,296 @@ void demo_Mini_Uart()
     }
 }
 
+
+
+/**
+ * Simple demo of the logic analyzer.
+ * 
+ * Captures the SPI 0 pins with DMA while sending the same secret message as demo_SPI_0,
+ * then dumps the capture via mini uart Tx at 115200 baud.
+ * 
+ * To verify: log the serial output to a file, run tools/la_to_vcd.py on it and open the
+ * VCD file in GTKWave or PulseView. No scope needed, nothing needs to be attached to the
+ * SPI pins.
+ */ 
+void demo_Logic_Analyzer()
+{
+    const uint32_t DELAY_TIME_uSec = 1000000u;
+    const uint32_t NUM_SAMPLES = BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES;
+    const uint32_t SAMPLE_RATE_HZ = 1000000u;
+    const uint32_t SPI_PINS = 0x00000F80u; // GPIO 7...11
+    const uint32_t SPI_BUFFER_SIZE = 5u;
+
+    static uint32_t samples[BSP_LOGIC_ANALYZER_DMA_MAX_SAMPLES];
+
+    uint8_t spi_data_out[SPI_BUFFER_SIZE];
+    uint8_t spi_data_in[SPI_BUFFER_SIZE];
+
+    spi_data_out[0] = 0xDAu;
+    spi_data_out[1] = 0xDBu;
+    spi_data_out[2] = 0x0Du;
+    spi_data_out[3] = 0xBEu;
+    spi_data_out[4] = 0xEFu;
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+
+    PSP_SPI0_Start();
+    PSP_SPI0_Set_Clock_Divider(PSP_SPI0_Clock_Divider_1024);
+
+    while (1)
+    {
+        // no trigger, start capturing straight away and send while the DMA samples
+        uint32_t sample_rate_hz = BSP_Logic_Analyzer_Start_DMA(samples, NUM_SAMPLES, SAMPLE_RATE_HZ, 0u, 0u);
+
+        PSP_SPI0_Buffer_Transfer(spi_data_out, spi_data_in, SPI_BUFFER_SIZE);
+
+        BSP_Logic_Analyzer_Wait_DMA();
+
+        uint32_t num_words = BSP_Logic_Analyzer_Compress(samples, NUM_SAMPLES);
+        BSP_Logic_Analyzer_Export(samples, num_words, sample_rate_hz, SPI_PINS);
+
+        PSP_Time_Delay_Microseconds(DELAY_TIME_uSec);
+    }
+}
+
+
+
+/**
+ * Simple demo of a WS2812/NeoPixel strip.
+ * 
+ * Chases a red, green and blue pixel down a 60 pixel strip.
+ * 
+ * To verify: attach the strip's data in to pin 10 (through a level shifter), and give the
+ * strip its own 5V supply with a ground shared with the Pi.
+ */ 
+void demo_WS2812()
+{
+    const uint32_t DELAY_TIME_uSec = 20000u;
+    const uint32_t NUM_PIXELS = 60u;
+
+    BSP_WS2812_Init(NUM_PIXELS);
+
+    uint32_t position = 0u;
+
+    while (1)
+    {
+        while (BSP_WS2812_Is_Busy())
+        {
+            // the DMA is still reading the last frame out of the pixel buffer
+        }
+
+        // turn off the trailing pixel, light up the next three
+        BSP_WS2812_Set_Pixel(position, 0u, 0u, 0u);
+
+        position = (position + 1u) % NUM_PIXELS;
+
+        BSP_WS2812_Set_Pixel(position, 64u, 0u, 0u);
+        BSP_WS2812_Set_Pixel((position + 1u) % NUM_PIXELS, 0u, 64u, 0u);
+        BSP_WS2812_Set_Pixel((position + 2u) % NUM_PIXELS, 0u, 0u, 64u);
+
+        BSP_WS2812_Show();
+
+        PSP_Time_Delay_Microseconds(DELAY_TIME_uSec);
+    }
+}
+
+
+
+/**
+ * Simple demo of DMA software PWM.
+ * 
+ * Breathes 8 LEDs on pins 20...27, each a little behind the one before, and sweeps a servo
+ * on pin 4 back and forth. The CPU only wakes up every 10 mSec to change the pulse widths.
+ * 
+ * To verify: attach LEDs (with resistors) to pins 20...27 and a hobby servo's signal wire to
+ * pin 4. Give the servo its own 5V supply with a ground shared with the Pi.
+ * 
+ * LEDs and the servo share one period here, 20 mSec with 10 uSec steps, which is slow enough
+ * that the LEDs may flicker a little. LEDs on their own would use a shorter period.
+ */ 
+void demo_Soft_PWM()
+{
+    const uint32_t DELAY_TIME_uSec = 10000u;
+    const uint32_t SERVO_PIN = 4u;
+    const uint32_t FIRST_LED_PIN = 20u;
+    const uint32_t NUM_LEDS = 8u;
+    const uint32_t SERVO_MIN_uSec = 1000u;
+    const uint32_t SERVO_MAX_uSec = 2000u;
+
+    uint32_t pin_mask = 1u << SERVO_PIN;
+
+    for (uint32_t led = 0u; led < NUM_LEDS; led++)
+    {
+        pin_mask |= 1u << (FIRST_LED_PIN + led);
+    }
+
+    BSP_Soft_PWM_Start(pin_mask, BSP_SOFT_PWM_SERVO_PERIOD_uSec, BSP_SOFT_PWM_SERVO_STEP_uSec);
+
+    uint32_t phase = 0u;
+    uint32_t servo_uSec = SERVO_MIN_uSec;
+    int32_t servo_direction = 10;
+
+    while (1)
+    {
+        for (uint32_t led = 0u; led < NUM_LEDS; led++)
+        {
+            // triangle wave, 0 up to full duty and back down over 2 * BSP_SOFT_PWM_DUTY_MAX
+            uint32_t led_phase = (phase + (led * (BSP_SOFT_PWM_DUTY_MAX / 4u))) % (2u * BSP_SOFT_PWM_DUTY_MAX);
+
+            if (BSP_SOFT_PWM_DUTY_MAX < led_phase)
+            {
+                led_phase = (2u * BSP_SOFT_PWM_DUTY_MAX) - led_phase;
+            }
+
+            // squared, so the brightness looks like it changes evenly
+            BSP_Soft_PWM_Set_Duty(FIRST_LED_PIN + led, (led_phase * led_phase) / BSP_SOFT_PWM_DUTY_MAX);
+        }
+
+        phase = (phase + 10u) % (2u * BSP_SOFT_PWM_DUTY_MAX);
+
+        servo_uSec += servo_direction;
+
+        if ((servo_uSec <= SERVO_MIN_uSec) || (SERVO_MAX_uSec <= servo_uSec))
+        {
+            servo_direction = -servo_direction;
+        }
+
+        BSP_Soft_PWM_Set_Pulse_uSec(SERVO_PIN, servo_uSec);
+
+        PSP_Time_Delay_Microseconds(DELAY_TIME_uSec);
+    }
+}
+
+
+
+/**
+ * Simple demo of the DMA pattern generator.
+ * 
+ * Shifts an 8 bit counter into a 74HC595 shift register chain, one byte every 100 mSec, with
+ * the whole SPI-like bit-bang done by DMA at a 1uSec tick.
+ * 
+ * To verify: wire pin 22 to the 595's SER (data), pin 23 to SRCLK (shift clock) and pin 24 to
+ * RCLK (latch), with LEDs on the 595's outputs. The LEDs should count up in binary. Or watch
+ * pins 22...24 with the logic analyzer.
+ */ 
+void demo_Pattern_Generator()
+{
+    const uint32_t DELAY_TIME_uSec = 100000u;
+    const uint32_t DATA_PIN_MASK = 1u << 22u;
+    const uint32_t CLOCK_PIN_MASK = 1u << 23u;
+    const uint32_t LATCH_PIN_MASK = 1u << 24u;
+    const uint32_t TICK_nSec = 1000u;
+
+    // per bit: data and clock low, then clock high. then a latch pulse at the end
+    BSP_Pattern_Generator_Step_t steps[(2u * 8u) + 2u];
+
+    uint32_t count = 0u;
+
+    while (1)
+    {
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            // most significant bit first
+            const uint32_t DATA_MASK = ((count >> (7u - bit)) & 1u) ? DATA_PIN_MASK : 0u;
+
+            steps[2u * bit].set_mask = DATA_MASK;
+            steps[2u * bit].clear_mask = CLOCK_PIN_MASK | LATCH_PIN_MASK | (DATA_PIN_MASK & ~DATA_MASK);
+            steps[2u * bit].delay_ticks = 1u;
+
+            steps[(2u * bit) + 1u].set_mask = CLOCK_PIN_MASK;
+            steps[(2u * bit) + 1u].clear_mask = 0u;
+            steps[(2u * bit) + 1u].delay_ticks = 1u;
+        }
+
+        steps[16].set_mask = LATCH_PIN_MASK;
+        steps[16].clear_mask = CLOCK_PIN_MASK;
+        steps[16].delay_ticks = 1u;
+
+        steps[17].set_mask = 0u;
+        steps[17].clear_mask = LATCH_PIN_MASK;
+        steps[17].delay_ticks = 0u;
+
+        BSP_Pattern_Generator_Load(steps, 18u, TICK_nSec, 0u);
+        BSP_Pattern_Generator_Start();
+        BSP_Pattern_Generator_Wait();
+
+        count++;
+
+        PSP_Time_Delay_Microseconds(DELAY_TIME_uSec);
+    }
+}
+
+
+/**
+ * Simple demo of the BSC slave.
+ * 
+ * The Pi becomes I2C device 0x42. Registers 0...3 hold the uptime in mSec (little endian) and
+ * register 4 the number of publishes so far, republished every 10 mSec. Whatever the host writes
+ * is echoed via mini uart Tx at 115200 baud, as the register number and the new value.
+ * 
+ * To verify: wire a second Pi or a USB-I2C adapter to GPIO18 (SDA) and 19 (SCL), with pull-ups,
+ * GPIO10/11 on a Pi 4. Then e.g. "i2ctransfer -y 1 w1@0x42 0x00 r5" should show the uptime
+ * counting up, and "i2cset -y 1 0x42 0x10 0x5A" should print 10 5A.
+ */ 
+void demo_BSC_Slave()
+{
+    const uint32_t SLAVE_ADDRESS = 0x42u;
+    const uint64_t PUBLISH_TIME_uSec = 10000u;
+
+    uint8_t host_writes[PSP_BSC_SLAVE_NUM_REGISTERS];
+    uint8_t last_host_writes[PSP_BSC_SLAVE_NUM_REGISTERS];
+    uint32_t num_host_writes = 0u;
+    uint32_t num_publishes = 0u;
+    uint64_t next_publish = PSP_Time_Get_Ticks();
+
+    PSP_AUX_Mini_Uart_Init(PSP_AUX_Mini_Uart_Baud_Rate_115200);
+    PSP_IRQ_Init();
+    PSP_BSC_Slave_Start(PSP_BSC_Slave_Mode_I2C, SLAVE_ADDRESS);
+
+    PSP_BSC_Slave_Get_Host_Writes(last_host_writes);
+
+    while (1)
+    {
+        // the interrupt does the rest, this catches a lone register byte before a read
+        PSP_BSC_Slave_Service();
+
+        if (PSP_Time_Get_Ticks() >= next_publish)
+        {
+            uint8_t * p_registers = PSP_BSC_Slave_Get_Back_Registers();
+            const uint32_t UPTIME_mSec = (uint32_t)(PSP_Time_Get_Ticks() / 1000u);
+
+            p_registers[0] = (uint8_t)UPTIME_mSec;
+            p_registers[1] = (uint8_t)(UPTIME_mSec >> 8u);
+            p_registers[2] = (uint8_t)(UPTIME_mSec >> 16u);
+            p_registers[3] = (uint8_t)(UPTIME_mSec >> 24u);
+            p_registers[4] = (uint8_t)num_publishes;
+
+            // if the host is busy, try again on the next pass
+            if (PSP_BSC_Slave_Publish())
+            {
+                num_publishes++;
+                next_publish += PUBLISH_TIME_uSec;
+            }
+        }
+
+        if (PSP_BSC_Slave_Get_Host_Writes(host_writes) != num_host_writes)
+        {
+            num_host_writes = PSP_BSC_Slave_Get_Host_Writes(host_writes);
+
+            for (uint32_t reg = 0u; reg < PSP_BSC_SLAVE_NUM_REGISTERS; reg++)
+            {
+                if (host_writes[reg] != last_host_writes[reg])
+                {
+                    PSP_AUX_Mini_Uart_Send_Hex(reg);
+                    PSP_AUX_Mini_Uart_Send_Byte(' ');
+                    PSP_AUX_Mini_Uart_Send_Hex(host_writes[reg]);
+                    PSP_AUX_Mini_Uart_Send_String("\r\n");
+
+                    last_host_writes[reg] = host_writes[reg];
+                }
+            }
+        }
+    }
+}
+
 #endif
@@ -2,6 +2,7 @@
 #include "PSP_Aux_Mini_UART.h"
 #include "PSP_REGS.h"
 #include "PSP_GPIO.h"
+#include "PSP_Trace.h"
 
 /*------------------------------------------------------------------------------------------------
     Private PSP_Aux_Mini_UART Defines
@@ -151,11 +152,72 @@ void PSP_AUX_Mini_Uart_Send_Byte(uint8_t value)
 
 
 
+uint32_t PSP_AUX_Mini_Uart_Try_Send_Byte(uint8_t value)
+{
+    if (!(PSP_AUX_MU_LSR_REG_R & AUX_MU_LSR_TRANSMITTER_EMPTY))
+    {
+        return 0u;
+    }
+
+    PSP_AUX_MU_IO_REG_R = value;
+
+    return 1u;
+}
+
+
+
 void PSP_AUX_Mini_Uart_Send_String(char * c_string)
 {
-    
-    for (int i = 0u; c_string[i] != '\0'; i++)
+    int i;
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_UART_Send, 0u);
+
+    for (i = 0; c_string[i] != '\0'; i++)
     {
         PSP_AUX_Mini_Uart_Send_Byte(c_string[i]);
     }
+
+    PSP_TRACE_END(PSP_Trace_Event_UART_Send, i);
+}
+
+
+
+void PSP_AUX_Mini_Uart_Send_Decimal(uint32_t value)
+{
+    // a uint32_t is at most 10 decimal digits, build them backwards from the ones place
+    char digits[10];
+    int num_digits = 0;
+
+    do
+    {
+        digits[num_digits] = '0' + (value % 10u);
+        value /= 10u;
+        num_digits++;
+    } while (value != 0u);
+
+    while (num_digits > 0)
+    {
+        num_digits--;
+        PSP_AUX_Mini_Uart_Send_Byte(digits[num_digits]);
+    }
+}
+
+
+
+void PSP_AUX_Mini_Uart_Send_Hex(uint32_t value)
+{
+    static const char HEX_DIGITS[] = "0123456789abcdef";
+
+    // skip leading zero nibbles, but always send at least one digit
+    int shift = 28;
+
+    while ((shift > 0) && ((value >> shift) == 0u))
+    {
+        shift -= 4;
+    }
+
+    for (; shift >= 0; shift -= 4)
+    {
+        PSP_AUX_Mini_Uart_Send_Byte(HEX_DIGITS[(value >> shift) & 0xFu]);
+    }
 }
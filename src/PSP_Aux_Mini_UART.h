@@ -18,6 +18,7 @@
 #define PSP_AUX_MINI_UART_H_INCLUDED
 
 #include "Fixed_Width_Ints.h"
+#include "PSP_REGS.h"
 
 
 
@@ -29,6 +30,10 @@
 #define PSP_AUX_MINI_UART_TX_PIN 14u
 #define PSP_AUX_MINI_UART_RX_PIN 15u
 
+// baud rate register value for a given baud rate, rounded to nearest, the mini uart is clocked from the core clock
+// e.g. 250MHz / (8 * 9600) - 1 = 3254
+#define PSP_AUX_MINI_UART_BAUD_REG(baud) (((PSP_REGS_CORE_CLOCK_HZ + (4u * (baud))) / (8u * (baud))) - 1u)
+
 
 
 /*-----------------------------------------------------------------------------------------------
@@ -37,14 +42,14 @@
 
 typedef enum Mini_Uart_Baud_Rate_Type
 {
-    PSP_AUX_Mini_Uart_Baud_Rate_9600   = 3254u, // sets the mini uart baud rate to 9600
-    PSP_AUX_Mini_Uart_Baud_Rate_14400  = 2169u, // sets the mini uart baud rate to 14400
-    PSP_AUX_Mini_Uart_Baud_Rate_19200  = 1627u, // sets the mini uart baud rate to 19200
-    PSP_AUX_Mini_Uart_Baud_Rate_28800  = 1084u, // sets the mini uart baud rate to 28800
-    PSP_AUX_Mini_Uart_Baud_Rate_38400  = 813u,  // sets the mini uart baud rate to 38400
-    PSP_AUX_Mini_Uart_Baud_Rate_56000  = 557u,  // sets the mini uart baud rate to 56000
-    PSP_AUX_Mini_Uart_Baud_Rate_57600  = 542u,  // sets the mini uart baud rate to 57600
-    PSP_AUX_Mini_Uart_Baud_Rate_115200 = 270u   // sets the mini uart baud rate to 115200
+    PSP_AUX_Mini_Uart_Baud_Rate_9600   = PSP_AUX_MINI_UART_BAUD_REG(9600u),   // sets the mini uart baud rate to 9600
+    PSP_AUX_Mini_Uart_Baud_Rate_14400  = PSP_AUX_MINI_UART_BAUD_REG(14400u),  // sets the mini uart baud rate to 14400
+    PSP_AUX_Mini_Uart_Baud_Rate_19200  = PSP_AUX_MINI_UART_BAUD_REG(19200u),  // sets the mini uart baud rate to 19200
+    PSP_AUX_Mini_Uart_Baud_Rate_28800  = PSP_AUX_MINI_UART_BAUD_REG(28800u),  // sets the mini uart baud rate to 28800
+    PSP_AUX_Mini_Uart_Baud_Rate_38400  = PSP_AUX_MINI_UART_BAUD_REG(38400u),  // sets the mini uart baud rate to 38400
+    PSP_AUX_Mini_Uart_Baud_Rate_56000  = PSP_AUX_MINI_UART_BAUD_REG(56000u),  // sets the mini uart baud rate to 56000
+    PSP_AUX_Mini_Uart_Baud_Rate_57600  = PSP_AUX_MINI_UART_BAUD_REG(57600u),  // sets the mini uart baud rate to 57600
+    PSP_AUX_Mini_Uart_Baud_Rate_115200 = PSP_AUX_MINI_UART_BAUD_REG(115200u)  // sets the mini uart baud rate to 115200
 } PSP_AUX_Mini_Uart_Baud_Rate_t;
 
 
@@ -89,7 +94,7 @@ Inputs:
     baud_rate_enum: baud rate enum to use. 
     
     The formula used for baud rate is : baudrate = system_clock_freq / (8 * ( baudrate_reg + 1 )) 
-    where system_clock_freq is 250MHz.
+    where system_clock_freq is PSP_REGS_CORE_CLOCK_HZ (250MHz on the Pi 1 and 3, 500MHz on the Pi 4).
 
     The provided enums are precomputed to deliver the correct baud rate setting for typical baud rates.
 
@@ -126,6 +131,29 @@ void PSP_AUX_Mini_Uart_Send_Byte(uint8_t value);
 
 
 
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_AUX_Mini_Uart_Try_Send_Byte
+
+Function Description:
+    Send a byte of data via mini uart Tx if the transmit FIFO has room for it, without
+    waiting.
+
+Inputs:
+    value: the value of the byte to send.
+
+Returns:
+    uint32_t: 1 if the byte was sent, 0 if the FIFO is full.
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_AUX_Mini_Uart_Try_Send_Byte(uint8_t value);
+
+
+
 /*-----------------------------------------------------------------------------------------------
 
 Function Name:
@@ -148,4 +176,49 @@ void PSP_AUX_Mini_Uart_Send_String(char* c_string);
 
 
 
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_AUX_Mini_Uart_Send_Decimal
+
+Function Description:
+    Send an unsigned value as decimal ASCII text via mini uart Tx, with no leading zeros.
+
+Inputs:
+    value: the value to send.
+
+Returns:
+    None.
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_AUX_Mini_Uart_Send_Decimal(uint32_t value);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_AUX_Mini_Uart_Send_Hex
+
+Function Description:
+    Send an unsigned value as lower case hexadecimal ASCII text via mini uart Tx, with no
+    leading zeros and no 0x prefix.
+
+Inputs:
+    value: the value to send.
+
+Returns:
+    None.
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_AUX_Mini_Uart_Send_Hex(uint32_t value);
+
+
+
 #endif
@@ -0,0 +1,412 @@
+
+#include "PSP_BSC_Slave.h"
+#include "PSP_GPIO.h"
+#include "PSP_IRQ.h"
+#include "PSP_REGS.h"
+#include "PSP_Trace.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_BSC_Slave Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// BSC/SPI Slave Register Addresses
+#define PSP_BSC_SLAVE_BASE_A    (PSP_REGS_BSC_SLAVE_BASE_ADDRESS)
+#define PSP_BSC_SLAVE_DR_A      (PSP_BSC_SLAVE_BASE_A | 0x00000000u)          // Data address
+#define PSP_BSC_SLAVE_RSR_A     (PSP_BSC_SLAVE_BASE_A | 0x00000004u)          // Operation status and error clear address
+#define PSP_BSC_SLAVE_SLV_A     (PSP_BSC_SLAVE_BASE_A | 0x00000008u)          // I2C slave address address
+#define PSP_BSC_SLAVE_CR_A      (PSP_BSC_SLAVE_BASE_A | 0x0000000Cu)          // Control address
+#define PSP_BSC_SLAVE_FR_A      (PSP_BSC_SLAVE_BASE_A | 0x00000010u)          // Flag address
+#define PSP_BSC_SLAVE_IFLS_A    (PSP_BSC_SLAVE_BASE_A | 0x00000014u)          // Interrupt FIFO level select address
+#define PSP_BSC_SLAVE_IMSC_A    (PSP_BSC_SLAVE_BASE_A | 0x00000018u)          // Interrupt mask set clear address
+
+// BSC/SPI Slave Register Pointers
+#define PSP_BSC_SLAVE_DR_R      (*((volatile uint32_t *)PSP_BSC_SLAVE_DR_A))   // Data register
+#define PSP_BSC_SLAVE_RSR_R     (*((volatile uint32_t *)PSP_BSC_SLAVE_RSR_A))  // Operation status and error clear register
+#define PSP_BSC_SLAVE_SLV_R     (*((volatile uint32_t *)PSP_BSC_SLAVE_SLV_A))  // I2C slave address register
+#define PSP_BSC_SLAVE_CR_R      (*((volatile uint32_t *)PSP_BSC_SLAVE_CR_A))   // Control register
+#define PSP_BSC_SLAVE_FR_R      (*((volatile uint32_t *)PSP_BSC_SLAVE_FR_A))   // Flag register
+#define PSP_BSC_SLAVE_IFLS_R    (*((volatile uint32_t *)PSP_BSC_SLAVE_IFLS_A)) // Interrupt FIFO level select register
+#define PSP_BSC_SLAVE_IMSC_R    (*((volatile uint32_t *)PSP_BSC_SLAVE_IMSC_A)) // Interrupt mask set clear register
+
+// Control Register Masks
+#define BSC_SLAVE_CR_RXE        0x00000200u // Receive enable
+#define BSC_SLAVE_CR_TXE        0x00000100u // Transmit enable
+#define BSC_SLAVE_CR_BRK        0x00000080u // Stop the current operation and clear the FIFOs
+#define BSC_SLAVE_CR_I2C        0x00000004u // I2C mode
+#define BSC_SLAVE_CR_SPI        0x00000002u // SPI mode
+#define BSC_SLAVE_CR_EN         0x00000001u // Enable the device
+
+// Status and Error Register Masks, write 0 to clear
+#define BSC_SLAVE_RSR_UE        0x00000002u // Tx underrun
+#define BSC_SLAVE_RSR_OE        0x00000001u // Rx overrun
+
+// Flag Register Masks
+#define BSC_SLAVE_FR_TXFLEVEL(fr) (((fr) >> 6u) & 0x1Fu) // bytes in the Tx FIFO
+#define BSC_SLAVE_FR_RXBUSY     0x00000020u // Receive in progress
+#define BSC_SLAVE_FR_TXFE       0x00000010u // Tx FIFO empty
+#define BSC_SLAVE_FR_RXFF       0x00000008u // Rx FIFO full
+#define BSC_SLAVE_FR_TXFF       0x00000004u // Tx FIFO full
+#define BSC_SLAVE_FR_RXFE       0x00000002u // Rx FIFO empty
+#define BSC_SLAVE_FR_TXBUSY     0x00000001u // Transmit in progress
+
+// Interrupt FIFO Level Select Register Masks
+#define BSC_SLAVE_IFLS_RX_1_8   0x00000000u // Rx interrupt once the Rx FIFO is 1/8 full, the lowest level
+#define BSC_SLAVE_IFLS_TX_1_2   0x00000002u // Tx interrupt once the Tx FIFO is down to 1/2 full
+
+// Interrupt Mask Set Clear Register Masks
+#define BSC_SLAVE_IMSC_TXIM     0x00000002u // Tx FIFO level interrupt
+#define BSC_SLAVE_IMSC_RXIM     0x00000001u // Rx FIFO level interrupt
+
+#define BSC_SLAVE_DR_DATA       0x000000FFu
+
+#define BSC_SLAVE_FIFO_SIZE     16u
+#define BSC_SLAVE_SPI_WRITE     0x80u       // SPI command byte bit for a write
+
+// Pins, all alt function 3
+#if defined(PSP_BOARD_PI4)
+#define BSC_SLAVE_SDA_MOSI_PIN  10u
+#define BSC_SLAVE_SCL_SCLK_PIN  11u
+#define BSC_SLAVE_MISO_PIN      9u
+#define BSC_SLAVE_CE_PIN        8u
+#else
+#define BSC_SLAVE_SDA_MOSI_PIN  18u
+#define BSC_SLAVE_SCL_SCLK_PIN  19u
+#define BSC_SLAVE_MISO_PIN      20u
+#define BSC_SLAVE_CE_PIN        21u
+#endif
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_BSC_Slave Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static PSP_BSC_Slave_Mode_t slave_mode;
+
+static uint8_t slave_banks[2][PSP_BSC_SLAVE_NUM_REGISTERS];
+static uint32_t slave_front;                // the bank the host reads
+
+static uint8_t slave_host_writes[PSP_BSC_SLAVE_NUM_REGISTERS];
+
+// the current transfer's writes, held back until it is over
+static uint8_t slave_pending[PSP_BSC_SLAVE_NUM_REGISTERS];
+static uint32_t slave_pending_mask[PSP_BSC_SLAVE_NUM_REGISTERS / 32u];
+static uint32_t slave_num_pending;
+
+static uint32_t slave_num_received;         // bytes received in the current transfer
+static uint32_t slave_write_register;       // where the next written byte goes
+static uint32_t slave_spi_writing;
+
+// what has been loaded into the Tx FIFO: registers tx_start onwards of the front bank
+static uint32_t slave_tx_active;
+static uint32_t slave_tx_start;
+static uint32_t slave_tx_loaded;
+
+static PSP_BSC_Slave_Stats_t slave_stats;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_BSC_Slave Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * Empty both FIFOs, only safe once the Rx FIFO has been read.
+ */
+static void BSC_Slave_Flush(void)
+{
+    PSP_BSC_SLAVE_CR_R |= BSC_SLAVE_CR_BRK;
+    PSP_BSC_SLAVE_CR_R &= ~BSC_SLAVE_CR_BRK;
+
+    // an empty Tx FIFO with nothing to load would interrupt nonstop
+    PSP_BSC_SLAVE_IMSC_R &= ~BSC_SLAVE_IMSC_TXIM;
+    slave_tx_active = 0u;
+}
+
+
+
+static void BSC_Slave_Top_Up(void)
+{
+    if (!slave_tx_active)
+    {
+        return;
+    }
+
+    while (!(PSP_BSC_SLAVE_FR_R & BSC_SLAVE_FR_TXFF))
+    {
+        PSP_BSC_SLAVE_DR_R = slave_banks[slave_front][(slave_tx_start + slave_tx_loaded) % PSP_BSC_SLAVE_NUM_REGISTERS];
+        slave_tx_loaded++;
+    }
+}
+
+
+
+static void BSC_Slave_Load(uint32_t first_register)
+{
+    slave_tx_active = 1u;
+    slave_tx_start = first_register;
+    slave_tx_loaded = 0u;
+
+    BSC_Slave_Top_Up();
+    PSP_BSC_SLAVE_IMSC_R |= BSC_SLAVE_IMSC_TXIM;
+}
+
+
+
+/**
+ * Bytes the host has clocked out of the Tx FIFO since it was loaded.
+ */
+static uint32_t BSC_Slave_Num_Sent(uint32_t flags)
+{
+    return slave_tx_active ? (slave_tx_loaded - BSC_SLAVE_FR_TXFLEVEL(flags)) : 0u;
+}
+
+
+
+static void BSC_Slave_Receive(uint8_t byte)
+{
+    if (slave_num_received++ == 0u)
+    {
+        // the first byte of a transfer picks the register
+        if (slave_mode == PSP_BSC_Slave_Mode_I2C)
+        {
+            if (slave_tx_active)
+            {
+                BSC_Slave_Flush(); // loaded for an earlier register the host never read
+            }
+
+            slave_write_register = byte % PSP_BSC_SLAVE_NUM_REGISTERS;
+            BSC_Slave_Load(slave_write_register);
+        }
+        else
+        {
+            slave_spi_writing = byte & BSC_SLAVE_SPI_WRITE;
+            slave_write_register = (byte & ~BSC_SLAVE_SPI_WRITE) % PSP_BSC_SLAVE_NUM_REGISTERS;
+        }
+
+        return;
+    }
+
+    if ((slave_mode == PSP_BSC_Slave_Mode_SPI) && !slave_spi_writing)
+    {
+        return; // the MOSI bytes of a read
+    }
+
+    slave_pending[slave_write_register] = byte;
+    slave_pending_mask[slave_write_register / 32u] |= 1u << (slave_write_register % 32u);
+    slave_num_pending++;
+    slave_write_register = (slave_write_register + 1u) % PSP_BSC_SLAVE_NUM_REGISTERS;
+}
+
+
+
+static void BSC_Slave_End_Transfer(uint32_t flags)
+{
+    const uint32_t NUM_SENT = BSC_Slave_Num_Sent(flags);
+
+    if (NUM_SENT != 0u)
+    {
+        slave_stats.host_reads++;
+    }
+
+    if (slave_num_pending != 0u)
+    {
+        for (uint32_t reg = 0u; reg < PSP_BSC_SLAVE_NUM_REGISTERS; reg++)
+        {
+            if (slave_pending_mask[reg / 32u] & (1u << (reg % 32u)))
+            {
+                slave_host_writes[reg] = slave_pending[reg];
+                slave_banks[0][reg] = slave_pending[reg];
+                slave_banks[1][reg] = slave_pending[reg];
+            }
+        }
+
+        memset(slave_pending_mask, 0, sizeof(slave_pending_mask));
+        slave_stats.host_writes++;
+    }
+
+    if (slave_mode == PSP_BSC_Slave_Mode_SPI)
+    {
+        // MISO always starts again from register 0
+        BSC_Slave_Flush();
+        BSC_Slave_Load(0u);
+    }
+    else if ((NUM_SENT != 0u) || (slave_num_pending != 0u))
+    {
+        // leftovers, or loaded from registers that have just changed
+        BSC_Slave_Flush();
+    }
+
+    // otherwise it was just the register byte, keep what is loaded for the read to come
+
+    slave_num_pending = 0u;
+    slave_num_received = 0u;
+}
+
+
+
+void PSP_BSC_Slave_Start(PSP_BSC_Slave_Mode_t mode, uint32_t address)
+{
+    slave_mode = mode;
+    slave_front = 0u;
+    slave_num_pending = 0u;
+    slave_num_received = 0u;
+    slave_tx_active = 0u;
+
+    memset(slave_banks, 0, sizeof(slave_banks));
+    memset(slave_host_writes, 0, sizeof(slave_host_writes));
+    memset(slave_pending_mask, 0, sizeof(slave_pending_mask));
+    memset(&slave_stats, 0, sizeof(slave_stats));
+
+    PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_SDA_MOSI_PIN, PSP_GPIO_PINMODE_ALT3);
+    PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_SCL_SCLK_PIN, PSP_GPIO_PINMODE_ALT3);
+
+    if (mode == PSP_BSC_Slave_Mode_SPI)
+    {
+        PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_MISO_PIN, PSP_GPIO_PINMODE_ALT3);
+        PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_CE_PIN, PSP_GPIO_PINMODE_ALT3);
+    }
+
+    PSP_BSC_SLAVE_CR_R = 0u;
+    PSP_BSC_SLAVE_IMSC_R = 0u;
+    PSP_BSC_SLAVE_RSR_R = 0u;
+    PSP_BSC_SLAVE_SLV_R = address & 0x7Fu;
+    PSP_BSC_SLAVE_IFLS_R = BSC_SLAVE_IFLS_RX_1_8 | BSC_SLAVE_IFLS_TX_1_2;
+    BSC_Slave_Flush();
+
+    PSP_BSC_SLAVE_CR_R = BSC_SLAVE_CR_EN | BSC_SLAVE_CR_TXE | BSC_SLAVE_CR_RXE |
+                         ((mode == PSP_BSC_Slave_Mode_SPI) ? BSC_SLAVE_CR_SPI : BSC_SLAVE_CR_I2C);
+
+    if (mode == PSP_BSC_Slave_Mode_SPI)
+    {
+        BSC_Slave_Load(0u);
+    }
+
+    PSP_IRQ_Attach(PSP_IRQ_SOURCE_BSC_SLAVE, PSP_BSC_Slave_Service);
+    PSP_BSC_SLAVE_IMSC_R |= BSC_SLAVE_IMSC_RXIM;
+}
+
+
+
+void PSP_BSC_Slave_Stop(void)
+{
+    PSP_BSC_SLAVE_IMSC_R = 0u;
+    PSP_IRQ_Detach(PSP_IRQ_SOURCE_BSC_SLAVE);
+    PSP_BSC_SLAVE_CR_R = 0u;
+
+    PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_SDA_MOSI_PIN, PSP_GPIO_PINMODE_INPUT);
+    PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_SCL_SCLK_PIN, PSP_GPIO_PINMODE_INPUT);
+
+    if (slave_mode == PSP_BSC_Slave_Mode_SPI)
+    {
+        PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_MISO_PIN, PSP_GPIO_PINMODE_INPUT);
+        PSP_GPIO_Set_Pin_Mode(BSC_SLAVE_CE_PIN, PSP_GPIO_PINMODE_INPUT);
+    }
+}
+
+
+
+void PSP_BSC_Slave_Service(void)
+{
+    // the interrupt handler and the main loop both get here
+    const uint32_t STATE = PSP_IRQ_Disable();
+    const uint32_t ERRORS = PSP_BSC_SLAVE_RSR_R;
+
+    if (ERRORS & (BSC_SLAVE_RSR_OE | BSC_SLAVE_RSR_UE))
+    {
+        slave_stats.overruns += (ERRORS & BSC_SLAVE_RSR_OE) ? 1u : 0u;
+        slave_stats.underruns += (ERRORS & BSC_SLAVE_RSR_UE) ? 1u : 0u;
+        PSP_BSC_SLAVE_RSR_R = 0u;
+    }
+
+    while (!(PSP_BSC_SLAVE_FR_R & BSC_SLAVE_FR_RXFE))
+    {
+        BSC_Slave_Receive((uint8_t)(PSP_BSC_SLAVE_DR_R & BSC_SLAVE_DR_DATA));
+    }
+
+    BSC_Slave_Top_Up();
+
+    const uint32_t FLAGS = PSP_BSC_SLAVE_FR_R;
+    const uint32_t IDLE = !(FLAGS & (BSC_SLAVE_FR_TXBUSY | BSC_SLAVE_FR_RXBUSY)) && (FLAGS & BSC_SLAVE_FR_RXFE);
+
+    if (IDLE && ((slave_num_received != 0u) || (BSC_Slave_Num_Sent(FLAGS) != 0u)))
+    {
+        PSP_TRACE_INSTANT(PSP_Trace_Event_BSC_Slave_Transfer, slave_num_received);
+        BSC_Slave_End_Transfer(FLAGS);
+    }
+
+    PSP_IRQ_Restore(STATE);
+}
+
+
+
+uint8_t * PSP_BSC_Slave_Get_Back_Registers(void)
+{
+    return slave_banks[slave_front ^ 1u];
+}
+
+
+
+uint32_t PSP_BSC_Slave_Publish(void)
+{
+    const uint32_t STATE = PSP_IRQ_Disable();
+
+    // settle anything that has just finished first
+    PSP_BSC_Slave_Service();
+
+    const uint32_t FLAGS = PSP_BSC_SLAVE_FR_R;
+
+    if ((FLAGS & (BSC_SLAVE_FR_TXBUSY | BSC_SLAVE_FR_RXBUSY)) || !(FLAGS & BSC_SLAVE_FR_RXFE) ||
+        (slave_num_received != 0u) || (BSC_Slave_Num_Sent(FLAGS) != 0u))
+    {
+        PSP_IRQ_Restore(STATE);
+        PSP_TRACE_INSTANT(PSP_Trace_Event_BSC_Slave_Publish, 0u);
+        return 0u; // the host is mid transfer
+    }
+
+    slave_front ^= 1u;
+    memcpy(slave_banks[slave_front ^ 1u], slave_banks[slave_front], PSP_BSC_SLAVE_NUM_REGISTERS);
+    slave_stats.publishes++;
+
+    PSP_TRACE_INSTANT(PSP_Trace_Event_BSC_Slave_Publish, 1u);
+
+    // anything already in the Tx FIFO came from the old bank
+    if (slave_tx_active)
+    {
+        const uint32_t FIRST_REGISTER = slave_tx_start;
+
+        BSC_Slave_Flush();
+        BSC_Slave_Load(FIRST_REGISTER);
+    }
+
+    PSP_IRQ_Restore(STATE);
+
+    return 1u;
+}
+
+
+
+uint32_t PSP_BSC_Slave_Get_Host_Writes(uint8_t * p_registers)
+{
+    const uint32_t STATE = PSP_IRQ_Disable();
+
+    // a write the host has just finished only lands once it is noticed
+    PSP_BSC_Slave_Service();
+
+    memcpy(p_registers, slave_host_writes, PSP_BSC_SLAVE_NUM_REGISTERS);
+    const uint32_t HOST_WRITES = slave_stats.host_writes;
+
+    PSP_IRQ_Restore(STATE);
+
+    return HOST_WRITES;
+}
+
+
+
+void PSP_BSC_Slave_Get_Stats(PSP_BSC_Slave_Stats_t * p_stats)
+{
+    const uint32_t STATE = PSP_IRQ_Disable();
+    *p_stats = slave_stats;
+    PSP_IRQ_Restore(STATE);
+}
@@ -0,0 +1,254 @@
+/**
+ * DESCRIPTION:
+ *      PSP_BSC_Slave makes the Pi an I2C or SPI device, using the BSC/SPI slave block. A
+ *      host MCU sees a map of PSP_BSC_SLAVE_NUM_REGISTERS byte registers: what it reads
+ *      comes from values the Pi publishes, and what it writes is handed to the Pi whole.
+ *
+ * NOTES:
+ *      The register map is double buffered. The Pi fills in the back bank at its own pace
+ *      (PSP_BSC_Slave_Get_Back_Registers), then PSP_BSC_Slave_Publish makes it the bank the
+ *      host reads from. A publish only happens between host transfers, so every transfer
+ *      reads from one bank start to finish and the host never sees half an update. The
+ *      publish doesn't wait: if the host is in the middle of a transfer it returns 0, and
+ *      the Pi carries on and tries again later. Afterwards the new back bank is a copy of
+ *      what was published, so only changed registers need writing next time.
+ *
+ *      Host writes are collected per transfer and land in the map at the end of it, in both
+ *      banks (so the host reads back what it wrote) and in the host write copy that
+ *      PSP_BSC_Slave_Get_Host_Writes hands to the Pi.
+ *
+ *      I2C protocol, at the address given to PSP_BSC_Slave_Start:
+ *          write:  [register] [data] [data] ...    data goes to register, register + 1, ...
+ *          read:   [register], repeated start (or stop, start), then read as many bytes
+ *                  as wanted from register, register + 1, ...
+ *      Every read must be preceded by the register write, the Tx FIFO is loaded from the
+ *      register as soon as it arrives. The slave can't stretch the clock, so the host gets
+ *      whatever is in the FIFO, PSP_BSC_Slave_Service has to run within about 2 bit times
+ *      of the register byte (5uS at 400kHz) or the first read bytes underrun. See below for
+ *      when the interrupt alone doesn't manage that.
+ *
+ *      SPI protocol (mode 0), a transfer is CE low to CE high:
+ *          MISO:   register 0, 1, 2, ... of the published bank, always
+ *          MOSI:   [0x80 | register] [data] ... writes from register on, anything with
+ *                  bit 7 clear is a read and the rest of the MOSI bytes are ignored
+ *      so a read of the first N registers is an N byte transfer of 0x00s. The BCM283x SPI
+ *      slave is known to be flaky, I2C is the mode to rely on.
+ *
+ *      Pins, alt function 3: Pi 1 to 3 SDA/MOSI on GPIO18, SCL/SCLK 19, MISO 20, CE 21.
+ *      Pi 4 SDA/MOSI on GPIO10, SCL/SCLK 11, MISO 9, CE 8.
+ *
+ *      PSP_BSC_Slave_Service is the slave's interrupt handler: it drains the Rx FIFO, keeps
+ *      the Tx FIFO topped up and notices the ends of transfers. PSP_BSC_Slave_Start attaches
+ *      it, so PSP_IRQ_Init must have run first. It is raised by the Rx FIFO level (1/8 full,
+ *      the lowest the block offers) and, while something is loaded, by the Tx FIFO falling
+ *      to half full. The block has no end of transfer interrupt, and a lone byte may sit
+ *      below the Rx level, so PSP_BSC_Slave_Publish and PSP_BSC_Slave_Get_Host_Writes settle
+ *      things themselves first. A main loop that must answer an I2C read straight after a
+ *      single register byte can still call PSP_BSC_Slave_Service as often as it likes, it
+ *      is cheap when there is nothing to do and safe alongside the interrupt.
+ *
+ * REFERENCES:
+ *      BCM2835-ARM-Peripherals.pdf section 11, SPI/BSC Slave
+ */
+
+#ifndef PSP_BSC_SLAVE_H_INCLUDED
+#define PSP_BSC_SLAVE_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_BSC_Slave Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_BSC_SLAVE_NUM_REGISTERS     128u    // register numbers wrap around at the end
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_BSC_Slave Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum BSC_Slave_Mode_Type
+{
+    PSP_BSC_Slave_Mode_I2C = 0u,
+    PSP_BSC_Slave_Mode_SPI = 1u
+} PSP_BSC_Slave_Mode_t;
+
+
+
+typedef struct BSC_Slave_Stats_Type
+{
+    uint32_t host_reads;        // transfers in which the host read at least one byte
+    uint32_t host_writes;       // transfers in which the host wrote at least one register
+    uint32_t overruns;          // times bytes were lost because the Rx FIFO was full
+    uint32_t underruns;         // times the host read from an empty Tx FIFO
+    uint32_t publishes;
+} PSP_BSC_Slave_Stats_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_BSC_Slave Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_BSC_Slave_Start
+
+Function Description:
+    Set up the pins and the slave block, with every register 0, and attach the slave's
+    interrupt. Needs PSP_IRQ_Init to have run.
+
+Inputs:
+    mode: I2C or SPI
+    address: the 7 bit I2C address to answer to, ignored for SPI
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_BSC_Slave_Start(PSP_BSC_Slave_Mode_t mode, uint32_t address);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_BSC_Slave_Stop
+
+Function Description:
+    Detach the slave's interrupt, disable the slave block and set its pins back to inputs.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_BSC_Slave_Stop(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_BSC_Slave_Service
+
+Function Description:
+    The slave's interrupt handler, also fine to call from the main loop. Handle whatever
+    the host has done since the last call: take in written bytes, feed the Tx FIFO, and
+    finish off transfers that are over.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    Overruns and underruns are counted in the stats.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_BSC_Slave_Service(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_BSC_Slave_Get_Back_Registers
+
+Function Description:
+    Get the register bank the Pi fills in, the host sees it after PSP_BSC_Slave_Publish.
+
+Inputs:
+    None
+
+Returns:
+    uint8_t *: PSP_BSC_SLAVE_NUM_REGISTERS registers. Changes with every publish, so get it
+               again afterwards.
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint8_t * PSP_BSC_Slave_Get_Back_Registers(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_BSC_Slave_Publish
+
+Function Description:
+    Swap the register banks, if the host isn't in the middle of a transfer.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 1 if the back bank is now what the host reads, 0 if the host is busy and
+              nothing changed
+
+Error Handling:
+    On 0, carry on and call again later, the back bank can still be written meanwhile.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_BSC_Slave_Publish(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_BSC_Slave_Get_Host_Writes
+
+Function Description:
+    Copy out every register as the host last wrote it (0 for registers it never wrote).
+    Only whole host transfers are ever included.
+
+Inputs:
+    p_registers: where to copy PSP_BSC_SLAVE_NUM_REGISTERS bytes to
+
+Returns:
+    uint32_t: the number of host write transfers so far, so a change means new data
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_BSC_Slave_Get_Host_Writes(uint8_t * p_registers);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_BSC_Slave_Get_Stats
+
+Function Description:
+    Get the transfer and error counts since PSP_BSC_Slave_Start.
+
+Inputs:
+    p_stats: where to put them
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_BSC_Slave_Get_Stats(PSP_BSC_Slave_Stats_t * p_stats);
+
+#endif
@@ -0,0 +1,231 @@
+#include "PSP_CRC.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_CRC Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// the Pi 1's ARM1176 has neither them nor ID_ISAR5, and the host tests run the tables
+#if !defined(PSP_BOARD_PI1) && !defined(PSP_HOST_BUILD)
+#define CRC_HAVE_INSTRUCTIONS
+#endif
+
+#define CRC_SLICES                  8u
+#define CRC_ID_ISAR5_CRC32          0x000F0000u     // CRC32 instructions field, 1 if present
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_CRC Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// table[k][n] is the CRC of byte n followed by k zero bytes
+static uint32_t crc_32_table[CRC_SLICES][256];
+static uint32_t crc_32c_table[CRC_SLICES][256];
+
+static uint32_t crc_use_instructions;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_CRC Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+static void CRC_Build_Table(uint32_t table[CRC_SLICES][256], uint32_t polynomial)
+{
+    for (uint32_t n = 0u; n < 256u; n++)
+    {
+        uint32_t crc = n;
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1u) ? polynomial : 0u);
+        }
+
+        table[0][n] = crc;
+    }
+
+    for (uint32_t slice = 1u; slice < CRC_SLICES; slice++)
+    {
+        for (uint32_t n = 0u; n < 256u; n++)
+        {
+            const uint32_t PREVIOUS = table[slice - 1u][n];
+
+            table[slice][n] = (PREVIOUS >> 8) ^ table[0][PREVIOUS & 0xFFu];
+        }
+    }
+}
+
+
+
+/**
+ * Slice-by-8 on an inverted CRC: bytes up to a word boundary, then 8 bytes with 8 lookups,
+ * then what's left.
+ */
+static uint32_t CRC_Tables(const uint32_t table[CRC_SLICES][256], uint32_t crc, const uint8_t * p_bytes, uint32_t num_bytes)
+{
+    while ((num_bytes != 0u) && ((uintptr_t)p_bytes & 0x3u))
+    {
+        crc = (crc >> 8) ^ table[0][(crc ^ *p_bytes++) & 0xFFu];
+        num_bytes--;
+    }
+
+    for (; num_bytes >= 8u; num_bytes -= 8u)
+    {
+        const uint32_t LOW = ((const uint32_t *)p_bytes)[0] ^ crc;
+        const uint32_t HIGH = ((const uint32_t *)p_bytes)[1];
+
+        crc = table[7][LOW & 0xFFu] ^ table[6][(LOW >> 8) & 0xFFu] ^ table[5][(LOW >> 16) & 0xFFu] ^ table[4][LOW >> 24] ^
+              table[3][HIGH & 0xFFu] ^ table[2][(HIGH >> 8) & 0xFFu] ^ table[1][(HIGH >> 16) & 0xFFu] ^ table[0][HIGH >> 24];
+
+        p_bytes += 8u;
+    }
+
+    while (num_bytes != 0u)
+    {
+        crc = (crc >> 8) ^ table[0][(crc ^ *p_bytes++) & 0xFFu];
+        num_bytes--;
+    }
+
+    return crc;
+}
+
+
+
+#if defined(CRC_HAVE_INSTRUCTIONS)
+
+/**
+ * CRC32B/CRC32W (or the C versions with castagnoli set) of one byte or word into an inverted
+ * CRC. Fixed registers, as the instructions are spelt out for the default -march.
+ */
+static inline uint32_t CRC_Byte_Instruction(uint32_t crc, uint32_t byte, uint32_t castagnoli)
+{
+    register uint32_t r0 __asm__ ("r0") = crc;
+    register uint32_t r1 __asm__ ("r1") = byte;
+
+    if (castagnoli)
+    {
+        __asm__ (".word 0xE1000241" : "+r" (r0) : "r" (r1)); // crc32cb r0, r0, r1
+    }
+    else
+    {
+        __asm__ (".word 0xE1000041" : "+r" (r0) : "r" (r1)); // crc32b r0, r0, r1
+    }
+
+    return r0;
+}
+
+
+
+static inline uint32_t CRC_Word_Instruction(uint32_t crc, uint32_t word, uint32_t castagnoli)
+{
+    register uint32_t r0 __asm__ ("r0") = crc;
+    register uint32_t r1 __asm__ ("r1") = word;
+
+    if (castagnoli)
+    {
+        __asm__ (".word 0xE1400241" : "+r" (r0) : "r" (r1)); // crc32cw r0, r0, r1
+    }
+    else
+    {
+        __asm__ (".word 0xE1400041" : "+r" (r0) : "r" (r1)); // crc32w r0, r0, r1
+    }
+
+    return r0;
+}
+
+
+
+/**
+ * As CRC_Tables with the CRC32 instructions, 4 words per loop. Each one depends on the last,
+ * so the unrolling only saves the loop overhead.
+ */
+static inline uint32_t CRC_Instructions(uint32_t crc, const uint8_t * p_bytes, uint32_t num_bytes, uint32_t castagnoli)
+{
+    while ((num_bytes != 0u) && ((uintptr_t)p_bytes & 0x3u))
+    {
+        crc = CRC_Byte_Instruction(crc, *p_bytes++, castagnoli);
+        num_bytes--;
+    }
+
+    const uint32_t * p_words = (const uint32_t *)p_bytes;
+
+    for (; num_bytes >= 16u; num_bytes -= 16u)
+    {
+        crc = CRC_Word_Instruction(crc, p_words[0], castagnoli);
+        crc = CRC_Word_Instruction(crc, p_words[1], castagnoli);
+        crc = CRC_Word_Instruction(crc, p_words[2], castagnoli);
+        crc = CRC_Word_Instruction(crc, p_words[3], castagnoli);
+        p_words += 4u;
+    }
+
+    for (; num_bytes >= 4u; num_bytes -= 4u)
+    {
+        crc = CRC_Word_Instruction(crc, *p_words++, castagnoli);
+    }
+
+    p_bytes = (const uint8_t *)p_words;
+
+    while (num_bytes != 0u)
+    {
+        crc = CRC_Byte_Instruction(crc, *p_bytes++, castagnoli);
+        num_bytes--;
+    }
+
+    return crc;
+}
+
+#endif
+
+
+
+uint32_t PSP_CRC_Init(uint32_t use_instructions)
+{
+    CRC_Build_Table(crc_32_table, PSP_CRC_32_POLYNOMIAL);
+    CRC_Build_Table(crc_32c_table, PSP_CRC_32C_POLYNOMIAL);
+
+    crc_use_instructions = 0u;
+
+#if defined(CRC_HAVE_INSTRUCTIONS)
+    if (use_instructions)
+    {
+        uint32_t id_isar5;
+
+        // ID_ISAR5 is reserved, reading as 0, on the ARMv7 cores
+        __asm__ volatile ("mrc p15, 0, %0, c0, c2, 5" : "=r" (id_isar5));
+
+        crc_use_instructions = (id_isar5 & CRC_ID_ISAR5_CRC32) ? 1u : 0u;
+    }
+#else
+    (void)use_instructions;
+#endif
+
+    return crc_use_instructions;
+}
+
+
+
+uint32_t PSP_CRC_32(uint32_t crc, const void * p_data, uint32_t num_bytes)
+{
+#if defined(CRC_HAVE_INSTRUCTIONS)
+    if (crc_use_instructions)
+    {
+        return ~CRC_Instructions(~crc, (const uint8_t *)p_data, num_bytes, 0u);
+    }
+#endif
+
+    return ~CRC_Tables(crc_32_table, ~crc, (const uint8_t *)p_data, num_bytes);
+}
+
+
+
+uint32_t PSP_CRC_32C(uint32_t crc, const void * p_data, uint32_t num_bytes)
+{
+#if defined(CRC_HAVE_INSTRUCTIONS)
+    if (crc_use_instructions)
+    {
+        return ~CRC_Instructions(~crc, (const uint8_t *)p_data, num_bytes, 1u);
+    }
+#endif
+
+    return ~CRC_Tables(crc_32c_table, ~crc, (const uint8_t *)p_data, num_bytes);
+}
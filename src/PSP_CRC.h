@@ -0,0 +1,99 @@
+/**
+ * DESCRIPTION:
+ *      PSP_CRC computes CRC-32 (the Ethernet, zip and PNG one) and CRC-32C (Castagnoli, the
+ *      iSCSI and ext4 one) checksums, for framing serial protocols and checking images such as
+ *      kernel.img as they arrive. Both can be fed a block at a time.
+ *
+ * NOTES:
+ *      The Cortex-A53 (Pi 3) and A72 (Pi 4) have ARMv8's CRC32 instructions, a word per
+ *      instruction. The pi3 build also runs on the Pi 2, whose Cortex-A7 lacks them, so
+ *      PSP_CRC_Init checks ID_ISAR5 before using them. The Pi 1, and the Pi 2, use
+ *      slice-by-8 tables instead: 8 lookups per 8 bytes, from 8 KB of tables per polynomial
+ *      built by PSP_CRC_Init.
+ *
+ *      The instructions are spelt out as .words so the default -march (ARMv7 for the pi3
+ *      build, as it has to run on the Pi 2) can still assemble them.
+ *
+ *      Both CRCs are the reflected (LSB first) kind, start from all 1s and are inverted at the
+ *      end. The update functions take care of both ends, zlib's crc32() style: start with 0,
+ *      pass each block along with the result of the last, and the result is always the CRC of
+ *      everything so far:
+ *
+ *          crc = PSP_CRC_32(0u, p_first_block, first_size);
+ *          crc = PSP_CRC_32(crc, p_next_block, next_size);
+ *
+ *      Check values, the CRC of the ASCII "123456789": CRC-32 0xCBF43926, CRC-32C 0xE3069283.
+ *
+ * REFERENCES:
+ *      ARM Architecture Reference Manual ARMv8, A32 CRC32/CRC32C and ID_ISAR5
+ *      R. Williams, A Painless Guide to CRC Error Detection Algorithms
+ *      Intel, Slicing-by-8 (M. Kounavis and F. Berry, High Performance Table-Based CRC Algorithms)
+ */
+
+#ifndef PSP_CRC_H_INCLUDED
+#define PSP_CRC_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_CRC Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_CRC_32_POLYNOMIAL       0xEDB88320u     // reflected 0x04C11DB7
+#define PSP_CRC_32C_POLYNOMIAL      0x82F63B78u     // reflected 0x1EDC6F41
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_CRC Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_CRC_Init
+
+Function Description:
+    Build the slice-by-8 tables, and pick the CRC32 instructions if asked for and the core
+    has them. Call before anything else here, and again to switch.
+
+Inputs:
+    use_instructions: 1 to use the CRC32 instructions where the core has them, 0 to always
+                      use the tables (e.g. to compare the two)
+
+Returns:
+    uint32_t: 1 if the CRC32 instructions are in use, 0 if the tables are
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_CRC_Init(uint32_t use_instructions);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_CRC_32, PSP_CRC_32C
+
+Function Description:
+    Add a block to a CRC-32 or CRC-32C.
+
+Inputs:
+    crc: 0 to start, or what the last call on the earlier blocks returned
+    p_data: the block, any alignment
+    num_bytes: bytes in the block, may be 0
+
+Returns:
+    uint32_t: the CRC of everything so far
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_CRC_32(uint32_t crc, const void * p_data, uint32_t num_bytes);
+uint32_t PSP_CRC_32C(uint32_t crc, const void * p_data, uint32_t num_bytes);
+
+#endif
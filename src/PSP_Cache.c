@@ -0,0 +1,59 @@
+
+#include "PSP_Cache.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Cache Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// System Control Register (SCTLR) Masks
+#define SCTLR_I              0x00001000u // Instruction cache enable
+#define SCTLR_Z              0x00000800u // Branch prediction enable
+
+// the ARMv7+ barrier instruction doesn't exist on the Pi 1, it has the CP15 equivalent instead
+#if defined(__ARM_ARCH) && (__ARM_ARCH >= 7)
+#define CACHE_ISB()          __asm__ volatile ("isb" ::: "memory")
+#else
+#define CACHE_ISB()          __asm__ volatile ("mcr p15, 0, %0, c7, c5, 4" :: "r" (0u) : "memory")
+#endif
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_Cache Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+static uint32_t Cache_Read_SCTLR(void)
+{
+    uint32_t sctlr;
+
+    __asm__ volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (sctlr));
+
+    return sctlr;
+}
+
+
+
+static void Cache_Write_SCTLR(uint32_t sctlr)
+{
+    __asm__ volatile ("mcr p15, 0, %0, c1, c0, 0" :: "r" (sctlr) : "memory");
+
+    CACHE_ISB();
+}
+
+
+
+void PSP_Cache_Enable_Instruction_Cache(void)
+{
+    // invalidate the whole instruction cache (and branch predictor) so no stale lines get used
+    __asm__ volatile ("mcr p15, 0, %0, c7, c5, 0" :: "r" (0u) : "memory");
+    CACHE_ISB();
+
+    Cache_Write_SCTLR(Cache_Read_SCTLR() | SCTLR_I | SCTLR_Z);
+}
+
+
+
+void PSP_Cache_Disable_Instruction_Cache(void)
+{
+    Cache_Write_SCTLR(Cache_Read_SCTLR() & ~(SCTLR_I | SCTLR_Z));
+}
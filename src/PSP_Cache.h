@@ -0,0 +1,70 @@
+/**
+ * DESCRIPTION:
+ *      PSP_Cache turns the instruction cache and branch prediction on and off.
+ * 
+ * NOTES:
+ *      Out of reset (and as the firmware hands over to kernel.img) the caches are off, so
+ *      every instruction fetch goes out to RAM. Enabling the instruction cache makes tight
+ *      loops run several times faster.
+ * 
+ *      The data cache can't be enabled without the MMU, which this repo doesn't set up, so 
+ *      data accesses stay uncached. That keeps DMA simple, nothing ever needs to be flushed.
+ * 
+ * REFERENCES:
+ *      ARM1176JZF-S Technical Reference Manual, section 3.2.7 (c1, Control Register)
+ *      Cortex-A53 Technical Reference Manual, SCTLR (AArch32)
+ */
+
+#ifndef PSP_CACHE_H_INCLUDED
+#define PSP_CACHE_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Cache Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Cache_Enable_Instruction_Cache
+
+Function Description:
+    Invalidate, then enable, the instruction cache and branch prediction.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Cache_Enable_Instruction_Cache(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Cache_Disable_Instruction_Cache
+
+Function Description:
+    Disable the instruction cache and branch prediction.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Cache_Disable_Instruction_Cache(void);
+
+#endif
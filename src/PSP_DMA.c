@@ -0,0 +1,166 @@
+
+#include "PSP_DMA.h"
+#include "PSP_REGS.h"
+#include "PSP_Trace.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_DMA Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// DMA Register Addresses, each channel has its own block of registers 0x100 apart
+#define PSP_DMA_BASE_ADDRESS      (PSP_REGS_DMA_BASE_ADDRESS)
+
+#define PSP_DMA_CS_A(n)           (PSP_DMA_BASE_ADDRESS + ((n) << 8u) + 0x00000000u) // Channel n Control and Status address
+#define PSP_DMA_CONBLK_AD_A(n)    (PSP_DMA_BASE_ADDRESS + ((n) << 8u) + 0x00000004u) // Channel n Control Block Address address
+#define PSP_DMA_TXFR_LEN_A(n)     (PSP_DMA_BASE_ADDRESS + ((n) << 8u) + 0x00000014u) // Channel n Transfer Length address
+#define PSP_DMA_DEBUG_A(n)        (PSP_DMA_BASE_ADDRESS + ((n) << 8u) + 0x00000020u) // Channel n Debug address
+
+#define PSP_DMA_INT_STATUS_A      (PSP_DMA_BASE_ADDRESS | 0x00000FE0u)               // Interrupt status of each channel address
+#define PSP_DMA_ENABLE_A          (PSP_DMA_BASE_ADDRESS | 0x00000FF0u)               // Global enable bits for each channel address
+
+// DMA Register Pointers
+#define PSP_DMA_CS_R(n)           (*((volatile uint32_t *)PSP_DMA_CS_A(n)))          // Channel n Control and Status register
+#define PSP_DMA_CONBLK_AD_R(n)    (*((volatile uint32_t *)PSP_DMA_CONBLK_AD_A(n)))   // Channel n Control Block Address register
+#define PSP_DMA_TXFR_LEN_R(n)     (*((volatile uint32_t *)PSP_DMA_TXFR_LEN_A(n)))    // Channel n Transfer Length register
+#define PSP_DMA_DEBUG_R(n)        (*((volatile uint32_t *)PSP_DMA_DEBUG_A(n)))       // Channel n Debug register
+
+#define PSP_DMA_INT_STATUS_R      (*((volatile uint32_t *)PSP_DMA_INT_STATUS_A))     // Interrupt status of each channel register
+#define PSP_DMA_ENABLE_R          (*((volatile uint32_t *)PSP_DMA_ENABLE_A))         // Global enable bits for each channel register
+
+// DMA Control and Status Register Masks
+#define DMA_CS_RESET              0x80000000u // Reset the channel
+#define DMA_CS_ABORT              0x40000000u // Abort the current control block
+#define DMA_CS_DISDEBUG           0x20000000u // Don't stop when the debug pause signal is asserted
+#define DMA_CS_WAIT_FOR_WRITES    0x10000000u // Wait for outstanding writes before finishing a control block
+#define DMA_CS_PANIC_PRIORITY(n)  (((n) & 0x0Fu) << 20u) // AXI priority when the peripheral is panicking
+#define DMA_CS_PRIORITY(n)        (((n) & 0x0Fu) << 16u) // AXI priority normally
+#define DMA_CS_ERROR              0x00000100u // The channel has hit an error
+#define DMA_CS_WAITING_FOR_WRITES 0x00000040u // The channel is waiting for outstanding writes
+#define DMA_CS_DREQ_STOPS_DMA     0x00000020u // The channel is paused by DREQ
+#define DMA_CS_PAUSED             0x00000010u // The channel is paused
+#define DMA_CS_DREQ               0x00000008u // The selected DREQ is asserted
+#define DMA_CS_INT                0x00000004u // Interrupt status, write 1 to clear
+#define DMA_CS_END                0x00000002u // Transfer complete, write 1 to clear
+#define DMA_CS_ACTIVE             0x00000001u // Activate the channel / the channel is active
+
+// DMA Debug Register Masks, all write 1 to clear
+#define DMA_DEBUG_READ_ERROR      0x00000004u // Slave read response error
+#define DMA_DEBUG_FIFO_ERROR      0x00000002u // FIFO error
+#define DMA_DEBUG_READ_LAST_NOT_SET_ERROR 0x00000001u // Read last not set error
+
+#define DMA_DEFAULT_PRIORITY      8u          // middle of the road AXI priority for normal and panic
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_DMA Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+uint32_t PSP_DMA_Bus_Address(const volatile void * p_ram)
+{
+    return PSP_REGS_RAM_TO_BUS((uint32_t)p_ram);
+}
+
+
+
+uint32_t PSP_DMA_Peripheral_Bus_Address(uint32_t register_address)
+{
+    return PSP_REGS_PERIPHERAL_TO_BUS(register_address);
+}
+
+
+
+void PSP_DMA_Fill_Control_Block(PSP_DMA_Control_Block_t * p_block, uint32_t transfer_info,
+                                uint32_t source_bus_address, uint32_t dest_bus_address,
+                                uint32_t transfer_length, const PSP_DMA_Control_Block_t * p_next)
+{
+    p_block->transfer_info = transfer_info;
+    p_block->source_address = source_bus_address;
+    p_block->dest_address = dest_bus_address;
+    p_block->transfer_length = transfer_length;
+    p_block->stride = 0u;
+    p_block->next_control_block = p_next ? PSP_DMA_Bus_Address(p_next) : 0u;
+    p_block->reserved[0] = 0u;
+    p_block->reserved[1] = 0u;
+}
+
+
+
+void PSP_DMA_Channel_Start(uint32_t channel, PSP_DMA_Control_Block_t * p_control_block)
+{
+    if (PSP_DMA_NUM_CHANNELS <= channel)
+    {
+        return; // invalid channel, do nothing
+    }
+
+    // turn the channel on, then reset it so no state from an old transfer is left over
+    PSP_DMA_ENABLE_R |= (1u << channel);
+    PSP_DMA_CS_R(channel) = DMA_CS_RESET;
+
+    // clear any leftover end/interrupt flags and error bits (write 1 to clear)
+    PSP_DMA_CS_R(channel) = DMA_CS_END | DMA_CS_INT;
+    PSP_DMA_DEBUG_R(channel) = DMA_DEBUG_READ_ERROR | DMA_DEBUG_FIFO_ERROR | DMA_DEBUG_READ_LAST_NOT_SET_ERROR;
+
+    // point the channel at the first control block and go
+    PSP_DMA_CONBLK_AD_R(channel) = PSP_DMA_Bus_Address(p_control_block);
+
+    PSP_DMA_CS_R(channel) = DMA_CS_WAIT_FOR_WRITES 
+                          | DMA_CS_PANIC_PRIORITY(DMA_DEFAULT_PRIORITY)
+                          | DMA_CS_PRIORITY(DMA_DEFAULT_PRIORITY)
+                          | DMA_CS_ACTIVE;
+
+    PSP_TRACE_INSTANT(PSP_Trace_Event_DMA_Start, channel);
+}
+
+
+
+void PSP_DMA_Channel_Stop(uint32_t channel)
+{
+    if (PSP_DMA_NUM_CHANNELS <= channel)
+    {
+        return; // invalid channel, do nothing
+    }
+
+    // pause the channel, abort the control block it is on, then reset it
+    PSP_DMA_CS_R(channel) &= ~DMA_CS_ACTIVE;
+    PSP_DMA_CS_R(channel) |= DMA_CS_ABORT;
+    PSP_DMA_CS_R(channel) = DMA_CS_RESET;
+}
+
+
+
+uint32_t PSP_DMA_Channel_Is_Active(uint32_t channel)
+{
+    if (PSP_DMA_NUM_CHANNELS <= channel)
+    {
+        return 0u; // invalid channel, never active
+    }
+
+    return PSP_DMA_CS_R(channel) & DMA_CS_ACTIVE;
+}
+
+
+
+void PSP_DMA_Channel_Wait(uint32_t channel)
+{
+    PSP_TRACE_BEGIN(PSP_Trace_Event_CPU_Wait_DMA, channel);
+
+    while (PSP_DMA_Channel_Is_Active(channel))
+    {
+        // wait for the channel to reach the end of its control blocks
+    }
+
+    PSP_TRACE_END(PSP_Trace_Event_CPU_Wait_DMA, channel);
+}
+
+
+
+uint32_t PSP_DMA_Channel_Get_Control_Block(uint32_t channel)
+{
+    if (PSP_DMA_NUM_CHANNELS <= channel)
+    {
+        return 0u; // invalid channel
+    }
+
+    return PSP_DMA_CONBLK_AD_R(channel);
+}
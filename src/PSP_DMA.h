@@ -0,0 +1,291 @@
+/**
+ * DESCRIPTION:
+ *      PSP_DMA provides an interface for the DMA controller. Transfers are described by
+ *      chains of control blocks in RAM, a channel is started by pointing it at the first
+ *      control block and then runs without the CPU until the chain ends.
+ * 
+ * NOTES:
+ *      Control blocks and the addresses in them are bus addresses, not ARM addresses. Use
+ *      PSP_DMA_Bus_Address for anything in RAM and PSP_DMA_Peripheral_Bus_Address for registers.
+ *      RAM addresses are mapped through PSP_REGS_BUS_RAM_ALIAS, the same path the ARM takes, and
+ *      the data cache is not enabled in this repo, so no cache maintenance is needed before or
+ *      after a transfer.
+ * 
+ *      The firmware uses some of the channels itself, channels 0, 2, 4, 5 and 8...14 are the ones
+ *      it leaves to the ARM. Channels 7 and up are "lite" channels with half the bandwidth and no
+ *      2D mode. To keep modules from stepping on each other, channels are handed out like this:
+ * 
+ *          channel 2  - PSP_EMMC
+ *          channel 4  - BSP_Pattern_Generator
+ *          channel 5  - BSP_Logic_Analyzer
+ *          channel 8  - PSP_SPI_0 DMA Tx
+ *          channel 9  - PSP_SPI_0 DMA Rx
+ *          channel 10 - BSP_Soft_PWM
+ * 
+ *      The modules above poll for completion with PSP_DMA_Channel_Is_Active or
+ *      PSP_DMA_Channel_Wait, none of them use the DMA interrupts. A control block with
+ *      PSP_DMA_TI_INTEN set raises PSP_IRQ_SOURCE_DMA(channel) when it completes; the handler
+ *      attached with PSP_IRQ_Attach then has to clear the channel's INT flag itself.
+ * 
+ * REFERENCES:
+ *      BCM2837-ARM-Peripherals.pdf page 38
+ */
+
+#ifndef PSP_DMA_H_INCLUDED
+#define PSP_DMA_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+#include "PSP_REGS.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_DMA Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// Transfer Information (control block word 0) masks
+#define PSP_DMA_TI_NO_WIDE_BURSTS   0x04000000u // Don't do wide writes as a 2 beat burst
+#define PSP_DMA_TI_WAITS(n)         (((n) & 0x1Fu) << 21u) // Add n wait cycles after each read/write
+#define PSP_DMA_TI_PERMAP(n)        (((n) & 0x1Fu) << 16u) // Peripheral whose DREQ paces the transfer
+#define PSP_DMA_TI_BURST_LENGTH(n)  (((n) & 0x0Fu) << 12u) // Burst transfer length
+#define PSP_DMA_TI_SRC_IGNORE       0x00000800u // Don't perform source reads
+#define PSP_DMA_TI_SRC_DREQ         0x00000400u // DREQ selected by PERMAP gates the source reads
+#define PSP_DMA_TI_SRC_WIDTH        0x00000200u // Use 128 bit source reads
+#define PSP_DMA_TI_SRC_INC          0x00000100u // Increment the source address after each read
+#define PSP_DMA_TI_DEST_IGNORE      0x00000080u // Don't perform destination writes
+#define PSP_DMA_TI_DEST_DREQ        0x00000040u // DREQ selected by PERMAP gates the destination writes
+#define PSP_DMA_TI_DEST_WIDTH       0x00000020u // Use 128 bit destination writes
+#define PSP_DMA_TI_DEST_INC         0x00000010u // Increment the destination address after each write
+#define PSP_DMA_TI_WAIT_RESP        0x00000008u // Wait for a write response before the next write
+#define PSP_DMA_TI_TDMODE           0x00000002u // 2D mode, TXFR_LEN is YLENGTH << 16 | XLENGTH
+#define PSP_DMA_TI_INTEN            0x00000001u // Interrupt when this control block completes
+
+#define PSP_DMA_NUM_CHANNELS        15u         // channels 0...14, channel 15 lives elsewhere and isn't supported
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_DMA Types
+ -------------------------------------------------------------------------------------------------*/
+
+// peripherals that can pace a transfer, for PSP_DMA_TI_PERMAP
+typedef enum DMA_DREQ_Type
+{
+    PSP_DMA_DREQ_None        = 0u,  // no pacing, the transfer runs flat out
+    PSP_DMA_DREQ_PCM_TX      = 2u,
+    PSP_DMA_DREQ_PCM_RX      = 3u,
+    PSP_DMA_DREQ_PWM         = 5u,
+    PSP_DMA_DREQ_SPI_TX      = 6u,
+    PSP_DMA_DREQ_SPI_RX      = 7u,
+    PSP_DMA_DREQ_BSC_SPI_TX  = 8u,  // BSC/SPI slave
+    PSP_DMA_DREQ_BSC_SPI_RX  = 9u,  // BSC/SPI slave
+    PSP_DMA_DREQ_EMMC        = 11u
+} PSP_DMA_DREQ_t;
+
+
+
+// a DMA control block, must be 32 byte aligned. all addresses are bus addresses.
+typedef struct DMA_Control_Block_Type
+{
+    uint32_t transfer_info;       // PSP_DMA_TI_* flags
+    uint32_t source_address;      // bus address to read from
+    uint32_t dest_address;        // bus address to write to
+    uint32_t transfer_length;     // bytes to transfer (or YLENGTH << 16 | XLENGTH in 2D mode)
+    uint32_t stride;              // 2D mode strides, D_STRIDE << 16 | S_STRIDE
+    uint32_t next_control_block;  // bus address of the next control block, 0 to stop
+    uint32_t reserved[2];         // must be 0
+} __attribute__((aligned(32))) PSP_DMA_Control_Block_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_DMA Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Bus_Address
+
+Function Description:
+    Translate a pointer to something in RAM (a buffer or a control block) into the bus address
+    the DMA engine uses to reach it.
+
+Inputs:
+    p_ram: pointer to translate
+
+Returns:
+    uint32_t: the bus address
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_DMA_Bus_Address(const volatile void * p_ram);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Peripheral_Bus_Address
+
+Function Description:
+    Translate the ARM address of a peripheral register (e.g. a PSP_*_A define) into the bus
+    address the DMA engine uses to reach it.
+
+Inputs:
+    register_address: ARM physical address of the register
+
+Returns:
+    uint32_t: the bus address
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_DMA_Peripheral_Bus_Address(uint32_t register_address);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Fill_Control_Block
+
+Function Description:
+    Fill in every field of a control block, with no stride and the reserved words zeroed.
+
+Inputs:
+    p_block: control block to fill
+    transfer_info: PSP_DMA_TI_* flags
+    source_bus_address: bus address to read from, see PSP_DMA_Bus_Address and 
+                        PSP_DMA_Peripheral_Bus_Address
+    dest_bus_address: bus address to write to
+    transfer_length: bytes to transfer
+    p_next: control block to run after this one, 0 to stop
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_DMA_Fill_Control_Block(PSP_DMA_Control_Block_t * p_block, uint32_t transfer_info,
+                                uint32_t source_bus_address, uint32_t dest_bus_address,
+                                uint32_t transfer_length, const PSP_DMA_Control_Block_t * p_next);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Channel_Start
+
+Function Description:
+    Enable and reset a DMA channel, then start it on a chain of control blocks. Returns as soon
+    as the channel is running.
+
+Inputs:
+    channel: DMA channel number, 0...14
+    p_control_block: first control block of the chain
+
+Returns:
+    None
+
+Error Handling:
+    Returns without having any effect if the channel number is out of range.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_DMA_Channel_Start(uint32_t channel, PSP_DMA_Control_Block_t * p_control_block);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Channel_Stop
+
+Function Description:
+    Abort whatever a DMA channel is doing and reset it.
+
+Inputs:
+    channel: DMA channel number, 0...14
+
+Returns:
+    None
+
+Error Handling:
+    Returns without having any effect if the channel number is out of range.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_DMA_Channel_Stop(uint32_t channel);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Channel_Is_Active
+
+Function Description:
+    Check if a DMA channel is still working through its control blocks.
+
+Inputs:
+    channel: DMA channel number, 0...14
+
+Returns:
+    uint32_t: 1 if the channel is active, 0 if it has finished (or was never started)
+
+Error Handling:
+    Returns 0 if the channel number is out of range.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_DMA_Channel_Is_Active(uint32_t channel);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Channel_Wait
+
+Function Description:
+    Wait for a DMA channel to finish its chain of control blocks.
+
+Inputs:
+    channel: DMA channel number, 0...14
+
+Returns:
+    None
+
+Error Handling:
+    Never returns if the chain loops back on itself.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_DMA_Channel_Wait(uint32_t channel);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_DMA_Channel_Get_Control_Block
+
+Function Description:
+    Get the bus address of the control block a DMA channel is currently working on, useful for
+    tracking how far along a long chain the channel has got.
+
+Inputs:
+    channel: DMA channel number, 0...14
+
+Returns:
+    uint32_t: bus address of the current control block, 0 if the channel has finished
+
+Error Handling:
+    Returns 0 if the channel number is out of range.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_DMA_Channel_Get_Control_Block(uint32_t channel);
+
+#endif
@@ -0,0 +1,826 @@
+
+#include "PSP_EMMC.h"
+#include "PSP_GPIO.h"
+#include "PSP_DMA.h"
+#include "PSP_Time.h"
+#include "PSP_Mailbox.h"
+
+#include "PSP_REGS.h"
+#include "PSP_Trace.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_EMMC Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// EMMC Register Addresses
+#define PSP_EMMC_BASE_A         (PSP_REGS_EMMC_BASE_ADDRESS)
+#define PSP_EMMC_BLKSIZECNT_A   (PSP_EMMC_BASE_A | 0x00000004u)              // Block Size and Count address
+#define PSP_EMMC_ARG1_A         (PSP_EMMC_BASE_A | 0x00000008u)              // Argument address
+#define PSP_EMMC_CMDTM_A        (PSP_EMMC_BASE_A | 0x0000000Cu)              // Command and Transfer Mode address
+#define PSP_EMMC_RESP0_A        (PSP_EMMC_BASE_A | 0x00000010u)              // Response bits 31:0 address
+#define PSP_EMMC_RESP1_A        (PSP_EMMC_BASE_A | 0x00000014u)              // Response bits 63:32 address
+#define PSP_EMMC_RESP2_A        (PSP_EMMC_BASE_A | 0x00000018u)              // Response bits 95:64 address
+#define PSP_EMMC_RESP3_A        (PSP_EMMC_BASE_A | 0x0000001Cu)              // Response bits 127:96 address
+#define PSP_EMMC_DATA_A         (PSP_EMMC_BASE_A | 0x00000020u)              // Data address
+#define PSP_EMMC_STATUS_A       (PSP_EMMC_BASE_A | 0x00000024u)              // Status address
+#define PSP_EMMC_CONTROL0_A     (PSP_EMMC_BASE_A | 0x00000028u)              // Host Configuration 0 address
+#define PSP_EMMC_CONTROL1_A     (PSP_EMMC_BASE_A | 0x0000002Cu)              // Host Configuration 1 address
+#define PSP_EMMC_INTERRUPT_A    (PSP_EMMC_BASE_A | 0x00000030u)              // Interrupt Flags address
+#define PSP_EMMC_IRPT_MASK_A    (PSP_EMMC_BASE_A | 0x00000034u)              // Interrupt Flag Enable address
+#define PSP_EMMC_IRPT_EN_A      (PSP_EMMC_BASE_A | 0x00000038u)              // Interrupt Generation Enable address
+#define PSP_EMMC_CONTROL2_A     (PSP_EMMC_BASE_A | 0x0000003Cu)              // Host Configuration 2 address
+
+// EMMC Register Pointers
+#define PSP_EMMC_BLKSIZECNT_R   (*((volatile uint32_t *)PSP_EMMC_BLKSIZECNT_A)) // Block Size and Count register
+#define PSP_EMMC_ARG1_R         (*((volatile uint32_t *)PSP_EMMC_ARG1_A))       // Argument register
+#define PSP_EMMC_CMDTM_R        (*((volatile uint32_t *)PSP_EMMC_CMDTM_A))      // Command and Transfer Mode register
+#define PSP_EMMC_RESP0_R        (*((volatile uint32_t *)PSP_EMMC_RESP0_A))      // Response bits 31:0 register
+#define PSP_EMMC_RESP1_R        (*((volatile uint32_t *)PSP_EMMC_RESP1_A))      // Response bits 63:32 register
+#define PSP_EMMC_RESP2_R        (*((volatile uint32_t *)PSP_EMMC_RESP2_A))      // Response bits 95:64 register
+#define PSP_EMMC_RESP3_R        (*((volatile uint32_t *)PSP_EMMC_RESP3_A))      // Response bits 127:96 register
+#define PSP_EMMC_DATA_R         (*((volatile uint32_t *)PSP_EMMC_DATA_A))       // Data register
+#define PSP_EMMC_STATUS_R       (*((volatile uint32_t *)PSP_EMMC_STATUS_A))     // Status register
+#define PSP_EMMC_CONTROL0_R     (*((volatile uint32_t *)PSP_EMMC_CONTROL0_A))   // Host Configuration 0 register
+#define PSP_EMMC_CONTROL1_R     (*((volatile uint32_t *)PSP_EMMC_CONTROL1_A))   // Host Configuration 1 register
+#define PSP_EMMC_INTERRUPT_R    (*((volatile uint32_t *)PSP_EMMC_INTERRUPT_A))  // Interrupt Flags register
+#define PSP_EMMC_IRPT_MASK_R    (*((volatile uint32_t *)PSP_EMMC_IRPT_MASK_A))  // Interrupt Flag Enable register
+#define PSP_EMMC_IRPT_EN_R      (*((volatile uint32_t *)PSP_EMMC_IRPT_EN_A))    // Interrupt Generation Enable register
+#define PSP_EMMC_CONTROL2_R     (*((volatile uint32_t *)PSP_EMMC_CONTROL2_A))   // Host Configuration 2 register
+
+// EMMC Command and Transfer Mode Register Masks
+#define EMMC_CMD_INDEX(n)       (((n) & 0x3Fu) << 24u) // Command index
+#define EMMC_CMD_ISDATA         0x00200000u // Command involves a data transfer
+#define EMMC_CMD_IXCHK_EN       0x00100000u // Check the response has the same index as the command
+#define EMMC_CMD_CRCCHK_EN      0x00080000u // Check the response CRC
+#define EMMC_CMD_RSPNS_NONE     0x00000000u // No response
+#define EMMC_CMD_RSPNS_136      0x00010000u // 136 bit response
+#define EMMC_CMD_RSPNS_48       0x00020000u // 48 bit response
+#define EMMC_CMD_RSPNS_48_BUSY  0x00030000u // 48 bit response using busy
+#define EMMC_TM_MULTI_BLOCK     0x00000020u // Multiple block transfer
+#define EMMC_TM_DAT_DIR_READ    0x00000010u // Card to host
+#define EMMC_TM_AUTO_CMD12      0x00000004u // Send CMD12 automatically after the last block
+#define EMMC_TM_BLKCNT_EN       0x00000002u // Use the block counter
+
+// EMMC Status Register Masks
+#define EMMC_STATUS_DAT_INHIBIT 0x00000002u // Data lines still in use
+#define EMMC_STATUS_CMD_INHIBIT 0x00000001u // Command line still in use
+
+// EMMC Host Configuration 0 Register Masks
+#define EMMC_CONTROL0_POWER_3V3 0x00000F00u // SD bus power on at 3.3V (needed by the SDHCI standard EMMC2)
+#define EMMC_CONTROL0_HS_EN     0x00000004u // High speed mode
+#define EMMC_CONTROL0_DWIDTH    0x00000002u // 4 bit data bus
+
+// EMMC Host Configuration 1 Register Masks
+#define EMMC_CONTROL1_SRST_DATA 0x04000000u // Reset the data handling circuit
+#define EMMC_CONTROL1_SRST_CMD  0x02000000u // Reset the command handling circuit
+#define EMMC_CONTROL1_SRST_HC   0x01000000u // Reset the complete host circuit
+#define EMMC_CONTROL1_DATA_TOUNIT(n) (((n) & 0x0Fu) << 16u) // Data timeout, TMCLK * 2^(n+13)
+#define EMMC_CONTROL1_CLK_FREQ8(n)   (((n) & 0xFFu) << 8u)  // SD clock divider bits 7:0
+#define EMMC_CONTROL1_CLK_FREQ_MS2(n) (((n) & 0x03u) << 6u) // SD clock divider bits 9:8
+#define EMMC_CONTROL1_CLK_MASK  0x000FFFE7u // Every clock and timeout field
+#define EMMC_CONTROL1_CLK_EN    0x00000004u // SD clock on
+#define EMMC_CONTROL1_CLK_STABLE 0x00000002u // SD clock stable
+#define EMMC_CONTROL1_CLK_INTLEN 0x00000001u // Internal clock on
+
+// EMMC Interrupt Flag Register Masks
+#define EMMC_INT_DTO_ERR        0x00100000u // Data timeout
+#define EMMC_INT_CTO_ERR        0x00010000u // Command timeout
+#define EMMC_INT_ERR_MASK       0xFFFF8000u // Any error
+#define EMMC_INT_READ_RDY       0x00000020u // Data register has data to read
+#define EMMC_INT_WRITE_RDY      0x00000010u // Data register has room to write
+#define EMMC_INT_DATA_DONE      0x00000002u // Data transfer finished
+#define EMMC_INT_CMD_DONE       0x00000001u // Command finished
+#define EMMC_INT_ALL            0xFFFFFFFFu
+
+// SD Commands, with their response types
+#define EMMC_R1                 (EMMC_CMD_RSPNS_48 | EMMC_CMD_CRCCHK_EN | EMMC_CMD_IXCHK_EN)
+#define EMMC_R1B                (EMMC_CMD_RSPNS_48_BUSY | EMMC_CMD_CRCCHK_EN | EMMC_CMD_IXCHK_EN)
+#define EMMC_R2                 (EMMC_CMD_RSPNS_136 | EMMC_CMD_CRCCHK_EN)
+#define EMMC_R3                 (EMMC_CMD_RSPNS_48)
+#define EMMC_DATA_READ          (EMMC_CMD_ISDATA | EMMC_TM_DAT_DIR_READ)
+#define EMMC_DATA_MULTI         (EMMC_TM_MULTI_BLOCK | EMMC_TM_BLKCNT_EN | EMMC_TM_AUTO_CMD12)
+
+#define EMMC_GO_IDLE_STATE      (EMMC_CMD_INDEX(0u) | EMMC_CMD_RSPNS_NONE)
+#define EMMC_ALL_SEND_CID       (EMMC_CMD_INDEX(2u) | EMMC_R2)
+#define EMMC_SEND_RELATIVE_ADDR (EMMC_CMD_INDEX(3u) | EMMC_R1)
+#define EMMC_SWITCH_FUNC        (EMMC_CMD_INDEX(6u) | EMMC_R1 | EMMC_DATA_READ)
+#define EMMC_SELECT_CARD        (EMMC_CMD_INDEX(7u) | EMMC_R1B)
+#define EMMC_SEND_IF_COND       (EMMC_CMD_INDEX(8u) | EMMC_R1)
+#define EMMC_SEND_CSD           (EMMC_CMD_INDEX(9u) | EMMC_R2)
+#define EMMC_SET_BLOCKLEN       (EMMC_CMD_INDEX(16u) | EMMC_R1)
+#define EMMC_READ_SINGLE_BLOCK  (EMMC_CMD_INDEX(17u) | EMMC_R1 | EMMC_DATA_READ)
+#define EMMC_READ_MULTIPLE_BLOCK (EMMC_CMD_INDEX(18u) | EMMC_R1 | EMMC_DATA_READ | EMMC_DATA_MULTI)
+#define EMMC_WRITE_BLOCK        (EMMC_CMD_INDEX(24u) | EMMC_R1 | EMMC_CMD_ISDATA)
+#define EMMC_WRITE_MULTIPLE_BLOCK (EMMC_CMD_INDEX(25u) | EMMC_R1 | EMMC_CMD_ISDATA | EMMC_DATA_MULTI)
+#define EMMC_APP_CMD            (EMMC_CMD_INDEX(55u) | EMMC_R1)
+#define EMMC_SET_BUS_WIDTH      (EMMC_CMD_INDEX(6u) | EMMC_R1)     // after EMMC_APP_CMD
+#define EMMC_SD_SEND_OP_COND    (EMMC_CMD_INDEX(41u) | EMMC_R3)    // after EMMC_APP_CMD
+
+// SD Command Arguments and Responses
+#define EMMC_IF_COND_3V3        0x000001AAu // 2.7-3.6V and a check pattern
+#define EMMC_OCR_BUSY           0x80000000u // Card finished powering up (active low busy)
+#define EMMC_OCR_HCS            0x40000000u // Host/card supports high capacity (SDHC/SDXC)
+#define EMMC_OCR_3V2_3V4        0x00300000u // Voltage window
+#define EMMC_BUS_WIDTH_4        0x00000002u // ACMD6 argument for 4 bits
+#define EMMC_SWITCH_HIGH_SPEED  0x80FFFFF1u // CMD6 argument, switch function group 1 to high speed
+#define EMMC_SWITCH_STATUS_BYTES 64u        // CMD6 answers with a 512 bit status
+
+// Clocks
+#define EMMC_DEFAULT_BASE_CLOCK_HZ 200000000u // if the firmware won't say
+#define EMMC_IDENT_CLOCK_HZ     400000u     // card identification
+#define EMMC_DEFAULT_CLOCK_HZ   25000000u   // default speed
+#define EMMC_HIGH_SPEED_CLOCK_HZ 50000000u  // high speed
+#define EMMC_MAX_DIVIDER        0x3FFu      // 10 bit divided clock
+
+// Timeouts
+#define EMMC_RESET_TIMEOUT_uSec     100000u
+#define EMMC_COMMAND_TIMEOUT_uSec   100000u
+#define EMMC_OP_COND_TIMEOUT_uSec   1000000u // ACMD41 may take up to 1 second
+#define EMMC_DATA_TIMEOUT_uSec      250000u  // plus EMMC_BLOCK_TIMEOUT_uSec per block
+#define EMMC_BLOCK_TIMEOUT_uSec     1000u
+
+#define EMMC_DMA_CHANNEL        2u           // see the channel list in PSP_DMA.h
+
+#define EMMC_FIRST_SD_PIN       48u          // GPIO 48...53 are CLK, CMD and DAT0...3
+#define EMMC_SD_PINS_BANK_1     0x003F0000u  // GPIO 48...53 in bank 1
+#define EMMC_SD_PULL_UPS_BANK_1 0x003E0000u  // GPIO 49...53, CMD and DAT0...3
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_EMMC Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static PSP_DMA_Control_Block_t emmc_control_block;
+
+static uint32_t emmc_base_clock_hz;
+static uint32_t emmc_bus_clock_hz;
+static uint32_t emmc_write_delay_uSec;       // the controller drops writes less than 2 SD clocks apart
+static uint32_t emmc_rca;                    // relative card address, shifted into place for commands
+static uint32_t emmc_high_capacity;          // SDHC/SDXC cards are addressed by block, SDSC by byte
+static uint32_t emmc_num_blocks;             // 0 until PSP_EMMC_Init succeeds
+
+// the request queue, the head is the request in progress once emmc_active is set
+static PSP_EMMC_Request_t * emmc_queue_head;
+static PSP_EMMC_Request_t * emmc_queue_tail;
+static uint32_t emmc_active;
+static uint64_t emmc_active_deadline;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_EMMC Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * waits until all of the mask bits read as the wanted value, or the timeout runs out
+ */
+static uint32_t EMMC_Wait_For(volatile uint32_t * p_register, uint32_t mask, uint32_t value, uint32_t timeout_uSec)
+{
+    const uint64_t DEADLINE = PSP_Time_Get_Ticks() + timeout_uSec;
+
+    while ((*p_register & mask) != value)
+    {
+        if (PSP_Time_Get_Ticks() > DEADLINE)
+        {
+            return 0u;
+        }
+    }
+
+    return 1u;
+}
+
+
+
+/**
+ * waits for any of the flags or an error to show up in the INTERRUPT register, returns the
+ * INTERRUPT register, or 0 if the timeout runs out
+ */
+static uint32_t EMMC_Wait_For_Interrupt(uint32_t flags, uint32_t timeout_uSec)
+{
+    const uint64_t DEADLINE = PSP_Time_Get_Ticks() + timeout_uSec;
+    uint32_t interrupt_flags;
+
+    while (!((interrupt_flags = PSP_EMMC_INTERRUPT_R) & (flags | EMMC_INT_ERR_MASK)))
+    {
+        if (PSP_Time_Get_Ticks() > DEADLINE)
+        {
+            return 0u;
+        }
+    }
+
+    return interrupt_flags;
+}
+
+
+
+static void EMMC_Reset_Lines(uint32_t reset_mask)
+{
+    PSP_EMMC_CONTROL1_R |= reset_mask;
+    EMMC_Wait_For(&PSP_EMMC_CONTROL1_R, reset_mask, 0u, EMMC_RESET_TIMEOUT_uSec);
+}
+
+
+
+static PSP_EMMC_Result_t EMMC_Interrupt_Error(uint32_t interrupt_flags)
+{
+    return (interrupt_flags & (EMMC_INT_CTO_ERR | EMMC_INT_DTO_ERR)) ? PSP_EMMC_Result_Timeout : PSP_EMMC_Result_Error;
+}
+
+
+
+static PSP_EMMC_Result_t EMMC_Send_Command(uint32_t command, uint32_t argument)
+{
+    const uint32_t INHIBIT_MASK = (command & EMMC_CMD_ISDATA) ? (EMMC_STATUS_CMD_INHIBIT | EMMC_STATUS_DAT_INHIBIT)
+                                                              : EMMC_STATUS_CMD_INHIBIT;
+
+    if (!EMMC_Wait_For(&PSP_EMMC_STATUS_R, INHIBIT_MASK, 0u, EMMC_COMMAND_TIMEOUT_uSec))
+    {
+        return PSP_EMMC_Result_Timeout;
+    }
+
+    PSP_EMMC_INTERRUPT_R = EMMC_INT_ALL;
+    PSP_Time_Delay_Microseconds(emmc_write_delay_uSec);
+    PSP_EMMC_ARG1_R = argument;
+    PSP_Time_Delay_Microseconds(emmc_write_delay_uSec);
+    PSP_EMMC_CMDTM_R = command;
+
+    const uint32_t INTERRUPT_FLAGS = EMMC_Wait_For_Interrupt(EMMC_INT_CMD_DONE, EMMC_COMMAND_TIMEOUT_uSec);
+
+    if (INTERRUPT_FLAGS == 0u)
+    {
+        EMMC_Reset_Lines(EMMC_CONTROL1_SRST_CMD);
+        return PSP_EMMC_Result_Timeout;
+    }
+
+    if (INTERRUPT_FLAGS & EMMC_INT_ERR_MASK)
+    {
+        PSP_EMMC_INTERRUPT_R = EMMC_INT_ALL;
+        EMMC_Reset_Lines(EMMC_CONTROL1_SRST_CMD);
+        return EMMC_Interrupt_Error(INTERRUPT_FLAGS);
+    }
+
+    PSP_EMMC_INTERRUPT_R = EMMC_INT_CMD_DONE;
+
+    return PSP_EMMC_Result_OK;
+}
+
+
+
+static PSP_EMMC_Result_t EMMC_Send_App_Command(uint32_t command, uint32_t argument)
+{
+    PSP_EMMC_Result_t result = EMMC_Send_Command(EMMC_APP_CMD, emmc_rca);
+
+    if (result != PSP_EMMC_Result_OK)
+    {
+        return result;
+    }
+
+    return EMMC_Send_Command(command, argument);
+}
+
+
+
+/**
+ * SDHCI v3 10 bit divided clock, SD clock = base clock / (2 * divider), or the base clock
+ * itself for a divider of 0. Rounds the divider up so the card is never clocked too fast.
+ */
+static uint32_t EMMC_Set_Clock(uint32_t clock_hz)
+{
+    EMMC_Wait_For(&PSP_EMMC_STATUS_R, EMMC_STATUS_CMD_INHIBIT | EMMC_STATUS_DAT_INHIBIT, 0u, EMMC_COMMAND_TIMEOUT_uSec);
+
+    PSP_EMMC_CONTROL1_R &= ~EMMC_CONTROL1_CLK_EN;
+    PSP_Time_Delay_Microseconds(10u);
+
+    uint32_t divider = (emmc_base_clock_hz + (2u * clock_hz) - 1u) / (2u * clock_hz);
+
+    if (EMMC_MAX_DIVIDER < divider)
+    {
+        divider = EMMC_MAX_DIVIDER;
+    }
+
+    PSP_EMMC_CONTROL1_R = (PSP_EMMC_CONTROL1_R & ~EMMC_CONTROL1_CLK_MASK)
+                        | EMMC_CONTROL1_CLK_FREQ8(divider) | EMMC_CONTROL1_CLK_FREQ_MS2(divider >> 8u)
+                        | EMMC_CONTROL1_DATA_TOUNIT(0xEu) | EMMC_CONTROL1_CLK_INTLEN;
+
+    if (!EMMC_Wait_For(&PSP_EMMC_CONTROL1_R, EMMC_CONTROL1_CLK_STABLE, EMMC_CONTROL1_CLK_STABLE, EMMC_RESET_TIMEOUT_uSec))
+    {
+        return 0u;
+    }
+
+    PSP_EMMC_CONTROL1_R |= EMMC_CONTROL1_CLK_EN;
+    PSP_Time_Delay_Microseconds(10u);
+
+    emmc_bus_clock_hz = (divider != 0u) ? (emmc_base_clock_hz / (2u * divider)) : emmc_base_clock_hz;
+    emmc_write_delay_uSec = 2000000u / emmc_bus_clock_hz;
+
+    return 1u;
+}
+
+
+
+/**
+ * moves the data of a data command that has already been sent, one word at a time
+ */
+static PSP_EMMC_Result_t EMMC_PIO_Transfer(PSP_EMMC_Direction_t direction, uint32_t * p_words,
+                                           uint32_t num_blocks, uint32_t block_size)
+{
+    const uint32_t READY_FLAG = (direction == PSP_EMMC_Direction_Read) ? EMMC_INT_READ_RDY : EMMC_INT_WRITE_RDY;
+    const uint32_t TIMEOUT_uSec = EMMC_DATA_TIMEOUT_uSec + (num_blocks * EMMC_BLOCK_TIMEOUT_uSec);
+    const uint32_t WORDS_PER_BLOCK = block_size / sizeof(uint32_t);
+
+    uint32_t interrupt_flags;
+
+    for (uint32_t block = 0u; block < num_blocks; block++)
+    {
+        interrupt_flags = EMMC_Wait_For_Interrupt(READY_FLAG, TIMEOUT_uSec);
+
+        if (interrupt_flags == 0u)
+        {
+            return PSP_EMMC_Result_Timeout;
+        }
+
+        if (interrupt_flags & EMMC_INT_ERR_MASK)
+        {
+            return EMMC_Interrupt_Error(interrupt_flags);
+        }
+
+        PSP_EMMC_INTERRUPT_R = READY_FLAG;
+
+        for (uint32_t word = 0u; word < WORDS_PER_BLOCK; word++)
+        {
+            if (direction == PSP_EMMC_Direction_Read)
+            {
+                *p_words = PSP_EMMC_DATA_R;
+            }
+            else
+            {
+                PSP_EMMC_DATA_R = *p_words;
+            }
+
+            p_words++;
+        }
+    }
+
+    interrupt_flags = EMMC_Wait_For_Interrupt(EMMC_INT_DATA_DONE, TIMEOUT_uSec);
+
+    if (interrupt_flags == 0u)
+    {
+        return PSP_EMMC_Result_Timeout;
+    }
+
+    return (interrupt_flags & EMMC_INT_ERR_MASK) ? EMMC_Interrupt_Error(interrupt_flags) : PSP_EMMC_Result_OK;
+}
+
+
+
+/**
+ * sends the read/write command and gets the data moving. returns PSP_EMMC_Result_Pending
+ * while the DMA works, or the result if the request is already over
+ */
+static PSP_EMMC_Result_t EMMC_Start_Request(PSP_EMMC_Request_t * p_request)
+{
+    const uint32_t IS_READ = (p_request->direction == PSP_EMMC_Direction_Read);
+    const uint32_t IS_MULTI = (p_request->num_blocks > 1u);
+    const uint32_t ADDRESS = emmc_high_capacity ? p_request->first_block : (p_request->first_block * PSP_EMMC_BLOCK_SIZE);
+
+    uint32_t command;
+
+    if (IS_READ)
+    {
+        command = IS_MULTI ? EMMC_READ_MULTIPLE_BLOCK : EMMC_READ_SINGLE_BLOCK;
+    }
+    else
+    {
+        command = IS_MULTI ? EMMC_WRITE_MULTIPLE_BLOCK : EMMC_WRITE_BLOCK;
+    }
+
+    PSP_TRACE_BEGIN(IS_READ ? PSP_Trace_Event_EMMC_Read : PSP_Trace_Event_EMMC_Write, p_request->num_blocks);
+
+    PSP_EMMC_BLKSIZECNT_R = (p_request->num_blocks << 16u) | PSP_EMMC_BLOCK_SIZE;
+    PSP_Time_Delay_Microseconds(emmc_write_delay_uSec);
+
+    PSP_EMMC_Result_t result = EMMC_Send_Command(command, ADDRESS);
+
+    if (result != PSP_EMMC_Result_OK)
+    {
+        return result;
+    }
+
+#if defined(PSP_BOARD_PI4)
+
+    // EMMC2 has no DREQ, move the data with the CPU
+    return EMMC_PIO_Transfer(p_request->direction, (uint32_t *)p_request->p_buffer, p_request->num_blocks, PSP_EMMC_BLOCK_SIZE);
+
+#else
+
+    const uint32_t DATA_BUS_ADDRESS = PSP_DMA_Peripheral_Bus_Address(PSP_EMMC_DATA_A);
+    const uint32_t BUFFER_BUS_ADDRESS = PSP_DMA_Bus_Address(p_request->p_buffer);
+
+    if (IS_READ)
+    {
+        emmc_control_block.transfer_info = PSP_DMA_TI_WAIT_RESP | PSP_DMA_TI_SRC_DREQ | PSP_DMA_TI_DEST_INC
+                                         | PSP_DMA_TI_PERMAP(PSP_DMA_DREQ_EMMC);
+        emmc_control_block.source_address = DATA_BUS_ADDRESS;
+        emmc_control_block.dest_address = BUFFER_BUS_ADDRESS;
+    }
+    else
+    {
+        emmc_control_block.transfer_info = PSP_DMA_TI_WAIT_RESP | PSP_DMA_TI_DEST_DREQ | PSP_DMA_TI_SRC_INC
+                                         | PSP_DMA_TI_PERMAP(PSP_DMA_DREQ_EMMC);
+        emmc_control_block.source_address = BUFFER_BUS_ADDRESS;
+        emmc_control_block.dest_address = DATA_BUS_ADDRESS;
+    }
+
+    emmc_control_block.transfer_length = p_request->num_blocks * PSP_EMMC_BLOCK_SIZE;
+    emmc_control_block.stride = 0u;
+    emmc_control_block.next_control_block = 0u;
+    emmc_control_block.reserved[0] = 0u;
+    emmc_control_block.reserved[1] = 0u;
+
+    PSP_DMA_Channel_Start(EMMC_DMA_CHANNEL, &emmc_control_block);
+
+    emmc_active_deadline = PSP_Time_Get_Ticks() + EMMC_DATA_TIMEOUT_uSec + (p_request->num_blocks * EMMC_BLOCK_TIMEOUT_uSec);
+
+    return PSP_EMMC_Result_Pending;
+
+#endif
+}
+
+
+
+static void EMMC_Finish_Request(PSP_EMMC_Result_t result)
+{
+    PSP_EMMC_Request_t * const P_REQUEST = emmc_queue_head;
+
+    if (result != PSP_EMMC_Result_OK)
+    {
+        // leave the controller ready for the next request
+        PSP_DMA_Channel_Stop(EMMC_DMA_CHANNEL);
+        EMMC_Reset_Lines(EMMC_CONTROL1_SRST_CMD | EMMC_CONTROL1_SRST_DATA);
+    }
+
+    PSP_EMMC_INTERRUPT_R = EMMC_INT_ALL;
+
+    emmc_queue_head = P_REQUEST->p_next;
+
+    if (emmc_queue_head == 0)
+    {
+        emmc_queue_tail = 0;
+    }
+
+    emmc_active = 0u;
+
+    PSP_TRACE_END((P_REQUEST->direction == PSP_EMMC_Direction_Read) ? PSP_Trace_Event_EMMC_Read : PSP_Trace_Event_EMMC_Write, result);
+
+    // last, once the request is out of the queue the caller is free to reuse it
+    P_REQUEST->result = result;
+}
+
+
+
+/**
+ * the CSD register comes back with its CRC stripped, so CSD bit n is response bit n - 8
+ */
+static uint32_t EMMC_Num_Blocks_From_CSD(void)
+{
+    const uint32_t RESP1 = PSP_EMMC_RESP1_R;
+    const uint32_t RESP2 = PSP_EMMC_RESP2_R;
+    const uint32_t RESP3 = PSP_EMMC_RESP3_R;
+
+    const uint32_t CSD_STRUCTURE = (RESP3 >> 22u) & 0x3u;     // CSD bits 127:126
+
+    if (CSD_STRUCTURE == 1u)
+    {
+        // CSD version 2, SDHC/SDXC, C_SIZE is CSD bits 69:48 and counts 512kB units
+        const uint32_t C_SIZE = (RESP1 >> 8u) & 0x3FFFFFu;
+
+        return (C_SIZE + 1u) * 1024u;
+    }
+
+    // CSD version 1, SDSC
+    const uint32_t C_SIZE = (RESP1 >> 22u) | ((RESP2 & 0x3u) << 10u);   // CSD bits 73:62
+    const uint32_t C_SIZE_MULT = (RESP1 >> 7u) & 0x7u;                  // CSD bits 49:47
+    const uint32_t READ_BL_LEN = (RESP2 >> 8u) & 0xFu;                  // CSD bits 83:80
+
+    return ((C_SIZE + 1u) << (C_SIZE_MULT + 2u)) << (READ_BL_LEN - 9u);
+}
+
+
+
+/**
+ * CMD6 mode 1 asks to switch function group 1 to high speed, the 512 bit status that comes
+ * back has the function group 1 result in bits 379:376, the low nibble of byte 16
+ */
+static uint32_t EMMC_Switch_To_High_Speed(void)
+{
+    uint32_t switch_status[EMMC_SWITCH_STATUS_BYTES / sizeof(uint32_t)];
+
+    PSP_EMMC_BLKSIZECNT_R = (1u << 16u) | EMMC_SWITCH_STATUS_BYTES;
+    PSP_Time_Delay_Microseconds(emmc_write_delay_uSec);
+
+    if ((EMMC_Send_Command(EMMC_SWITCH_FUNC, EMMC_SWITCH_HIGH_SPEED) != PSP_EMMC_Result_OK) ||
+        (EMMC_PIO_Transfer(PSP_EMMC_Direction_Read, switch_status, 1u, EMMC_SWITCH_STATUS_BYTES) != PSP_EMMC_Result_OK))
+    {
+        EMMC_Reset_Lines(EMMC_CONTROL1_SRST_CMD | EMMC_CONTROL1_SRST_DATA);
+        PSP_EMMC_INTERRUPT_R = EMMC_INT_ALL;
+        return 0u;
+    }
+
+    PSP_EMMC_INTERRUPT_R = EMMC_INT_ALL;
+
+    return ((switch_status[4] & 0xFu) == 1u) ? 1u : 0u;
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Init(void)
+{
+    PSP_EMMC_Result_t result;
+
+    emmc_num_blocks = 0u;
+    emmc_queue_head = 0;
+    emmc_queue_tail = 0;
+    emmc_active = 0u;
+    emmc_rca = 0u;
+
+#if defined(PSP_BOARD_PI4)
+
+    emmc_base_clock_hz = PSP_Mailbox_Get_Clock_Rate(PSP_Mailbox_Clock_EMMC2);
+
+#else
+
+    PSP_DMA_Channel_Stop(EMMC_DMA_CHANNEL);
+
+    // take the SD card slot over from the SDHOST controller
+    for (uint32_t pin = EMMC_FIRST_SD_PIN; pin < (EMMC_FIRST_SD_PIN + 6u); pin++)
+    {
+        PSP_GPIO_Set_Pin_Mode(pin, PSP_GPIO_PINMODE_ALT3);
+    }
+
+    PSP_GPIO_Set_Pull(0u, EMMC_SD_PULL_UPS_BANK_1, PSP_GPIO_Pull_Up);
+
+    emmc_base_clock_hz = PSP_Mailbox_Get_Clock_Rate(PSP_Mailbox_Clock_EMMC);
+
+#endif
+
+    if (emmc_base_clock_hz == 0u)
+    {
+        emmc_base_clock_hz = EMMC_DEFAULT_BASE_CLOCK_HZ;
+    }
+
+    // slow register writes until the clock is known
+    emmc_write_delay_uSec = 10u;
+
+    PSP_EMMC_CONTROL0_R = 0u;
+    PSP_EMMC_CONTROL1_R = EMMC_CONTROL1_SRST_HC;
+
+    if (!EMMC_Wait_For(&PSP_EMMC_CONTROL1_R, EMMC_CONTROL1_SRST_HC, 0u, EMMC_RESET_TIMEOUT_uSec))
+    {
+        return PSP_EMMC_Result_Timeout;
+    }
+
+    PSP_EMMC_CONTROL2_R = 0u;
+    PSP_EMMC_CONTROL0_R = EMMC_CONTROL0_POWER_3V3;
+
+    if (!EMMC_Set_Clock(EMMC_IDENT_CLOCK_HZ))
+    {
+        return PSP_EMMC_Result_Timeout;
+    }
+
+    // the EMMC interrupt stays off, every flag is still visible in the INTERRUPT register for polling
+    PSP_EMMC_IRPT_EN_R = 0u;
+    PSP_EMMC_IRPT_MASK_R = EMMC_INT_ALL;
+    PSP_EMMC_INTERRUPT_R = EMMC_INT_ALL;
+
+    if (EMMC_Send_Command(EMMC_GO_IDLE_STATE, 0u) != PSP_EMMC_Result_OK)
+    {
+        return PSP_EMMC_Result_No_Card;
+    }
+
+    // version 2 cards answer CMD8, version 1 cards time out
+    result = EMMC_Send_Command(EMMC_SEND_IF_COND, EMMC_IF_COND_3V3);
+
+    const uint32_t IS_VERSION_2 = (result == PSP_EMMC_Result_OK);
+
+    if (IS_VERSION_2 && ((PSP_EMMC_RESP0_R & 0xFFFu) != EMMC_IF_COND_3V3))
+    {
+        return PSP_EMMC_Result_Error; // the card doesn't like 3.3V
+    }
+    else if ((result != PSP_EMMC_Result_OK) && (result != PSP_EMMC_Result_Timeout))
+    {
+        return result;
+    }
+
+    // repeat ACMD41 until the card has finished powering up
+    const uint64_t OP_COND_DEADLINE = PSP_Time_Get_Ticks() + EMMC_OP_COND_TIMEOUT_uSec;
+
+    while (1)
+    {
+        result = EMMC_Send_App_Command(EMMC_SD_SEND_OP_COND, EMMC_OCR_3V2_3V4 | (IS_VERSION_2 ? EMMC_OCR_HCS : 0u));
+
+        if (result != PSP_EMMC_Result_OK)
+        {
+            return PSP_EMMC_Result_No_Card;
+        }
+
+        if (PSP_EMMC_RESP0_R & EMMC_OCR_BUSY)
+        {
+            break;
+        }
+
+        if (PSP_Time_Get_Ticks() > OP_COND_DEADLINE)
+        {
+            return PSP_EMMC_Result_Timeout;
+        }
+
+        PSP_Time_Delay_Microseconds(10000u);
+    }
+
+    emmc_high_capacity = PSP_EMMC_RESP0_R & EMMC_OCR_HCS;
+
+    if (((result = EMMC_Send_Command(EMMC_ALL_SEND_CID, 0u)) != PSP_EMMC_Result_OK) ||
+        ((result = EMMC_Send_Command(EMMC_SEND_RELATIVE_ADDR, 0u)) != PSP_EMMC_Result_OK))
+    {
+        return result;
+    }
+
+    emmc_rca = PSP_EMMC_RESP0_R & 0xFFFF0000u;
+
+    if ((result = EMMC_Send_Command(EMMC_SEND_CSD, emmc_rca)) != PSP_EMMC_Result_OK)
+    {
+        return result;
+    }
+
+    const uint32_t NUM_BLOCKS = EMMC_Num_Blocks_From_CSD();
+
+    if (((result = EMMC_Send_Command(EMMC_SELECT_CARD, emmc_rca)) != PSP_EMMC_Result_OK) ||
+        ((result = EMMC_Send_App_Command(EMMC_SET_BUS_WIDTH, EMMC_BUS_WIDTH_4)) != PSP_EMMC_Result_OK))
+    {
+        return result;
+    }
+
+    // every SD card supports the 4 bit bus
+    PSP_EMMC_CONTROL0_R |= EMMC_CONTROL0_DWIDTH;
+
+    if (!emmc_high_capacity && ((result = EMMC_Send_Command(EMMC_SET_BLOCKLEN, PSP_EMMC_BLOCK_SIZE)) != PSP_EMMC_Result_OK))
+    {
+        return result;
+    }
+
+    // CMD6 arrived with version 1.10 of the spec, only ask version 2 cards
+    if (IS_VERSION_2 && EMMC_Switch_To_High_Speed())
+    {
+        PSP_EMMC_CONTROL0_R |= EMMC_CONTROL0_HS_EN;
+        PSP_Time_Delay_Microseconds(emmc_write_delay_uSec);
+
+        if (!EMMC_Set_Clock(EMMC_HIGH_SPEED_CLOCK_HZ))
+        {
+            return PSP_EMMC_Result_Timeout;
+        }
+    }
+    else if (!EMMC_Set_Clock(EMMC_DEFAULT_CLOCK_HZ))
+    {
+        return PSP_EMMC_Result_Timeout;
+    }
+
+    emmc_num_blocks = NUM_BLOCKS;
+
+    return PSP_EMMC_Result_OK;
+}
+
+
+
+uint32_t PSP_EMMC_Get_Num_Blocks(void)
+{
+    return emmc_num_blocks;
+}
+
+
+
+uint32_t PSP_EMMC_Get_Bus_Clock_Hz(void)
+{
+    return emmc_bus_clock_hz;
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Submit(PSP_EMMC_Request_t * p_request)
+{
+    if ((emmc_num_blocks == 0u) ||
+        (p_request->num_blocks == 0u) || (PSP_EMMC_MAX_BLOCKS_PER_REQUEST < p_request->num_blocks) ||
+        (emmc_num_blocks <= p_request->first_block) || ((emmc_num_blocks - p_request->first_block) < p_request->num_blocks) ||
+        ((uint32_t)p_request->p_buffer & 0x3u))
+    {
+        p_request->result = PSP_EMMC_Result_Bad_Request;
+        return PSP_EMMC_Result_Bad_Request;
+    }
+
+    p_request->p_next = 0;
+    p_request->result = PSP_EMMC_Result_Pending;
+
+    if (emmc_queue_tail != 0)
+    {
+        emmc_queue_tail->p_next = p_request;
+    }
+    else
+    {
+        emmc_queue_head = p_request;
+    }
+
+    emmc_queue_tail = p_request;
+
+    PSP_EMMC_Service();
+
+    return PSP_EMMC_Result_Pending;
+}
+
+
+
+void PSP_EMMC_Service(void)
+{
+    if (emmc_active)
+    {
+        const uint32_t INTERRUPT_FLAGS = PSP_EMMC_INTERRUPT_R;
+
+        if (INTERRUPT_FLAGS & EMMC_INT_ERR_MASK)
+        {
+            EMMC_Finish_Request(EMMC_Interrupt_Error(INTERRUPT_FLAGS));
+        }
+        else if ((INTERRUPT_FLAGS & EMMC_INT_DATA_DONE) && !PSP_DMA_Channel_Is_Active(EMMC_DMA_CHANNEL))
+        {
+            EMMC_Finish_Request(PSP_EMMC_Result_OK);
+        }
+        else if (PSP_Time_Get_Ticks() > emmc_active_deadline)
+        {
+            EMMC_Finish_Request(PSP_EMMC_Result_Timeout);
+        }
+        else
+        {
+            return; // still going
+        }
+    }
+
+    // start the next request, requests that finish (or fail) straight away don't hold up the rest
+    while (!emmc_active && (emmc_queue_head != 0))
+    {
+        const PSP_EMMC_Result_t RESULT = EMMC_Start_Request(emmc_queue_head);
+
+        if (RESULT == PSP_EMMC_Result_Pending)
+        {
+            emmc_active = 1u;
+        }
+        else
+        {
+            EMMC_Finish_Request(RESULT);
+        }
+    }
+}
+
+
+
+uint32_t PSP_EMMC_Is_Idle(void)
+{
+    return (emmc_queue_head == 0) ? 1u : 0u;
+}
+
+
+
+static PSP_EMMC_Result_t EMMC_Transfer_And_Wait(PSP_EMMC_Direction_t direction, uint32_t first_block,
+                                                uint32_t num_blocks, void * p_buffer)
+{
+    PSP_EMMC_Request_t request;
+
+    request.direction = direction;
+    request.first_block = first_block;
+    request.num_blocks = num_blocks;
+    request.p_buffer = p_buffer;
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_CPU_Wait_EMMC, num_blocks);
+
+    PSP_EMMC_Submit(&request);
+
+    while (request.result == PSP_EMMC_Result_Pending)
+    {
+        PSP_EMMC_Service();
+    }
+
+    PSP_TRACE_END(PSP_Trace_Event_CPU_Wait_EMMC, num_blocks);
+
+    return request.result;
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Read_Blocks(uint32_t first_block, uint32_t num_blocks, void * p_buffer)
+{
+    return EMMC_Transfer_And_Wait(PSP_EMMC_Direction_Read, first_block, num_blocks, p_buffer);
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Write_Blocks(uint32_t first_block, uint32_t num_blocks, const void * p_buffer)
+{
+    // the buffer is only read for a write
+    return EMMC_Transfer_And_Wait(PSP_EMMC_Direction_Write, first_block, num_blocks, (void *)p_buffer);
+}
@@ -0,0 +1,277 @@
+/**
+ * DESCRIPTION:
+ *      PSP_EMMC provides an interface for the EMMC (SD host) controller, and through it the SD
+ *      card the Pi boots from. Reads and writes are whole 512 byte blocks, queued as requests
+ *      and moved by DMA, so the CPU is free while the card works.
+ *
+ * NOTES:
+ *      PSP_EMMC_Init takes the card through identification at 400kHz, switches it to the 4 bit
+ *      bus, and then to high speed (50MHz) if the card supports it, or default speed (25MHz)
+ *      otherwise. SDSC, SDHC and SDXC cards are supported, MMC cards aren't.
+ *
+ *      Requests are PSP_EMMC_Request_t structs owned by the caller, linked into a queue by
+ *      PSP_EMMC_Submit (no memory is allocated) and served in order. Requests of more than one
+ *      block use CMD18/CMD25 with an automatic CMD12, so a request of any size costs a single
+ *      command. The EMMC interrupt isn't used, the queue is polled: PSP_EMMC_Service must be
+ *      called regularly to finish a request and start the next, a request's result stays
+ *      PSP_EMMC_Result_Pending until then. PSP_EMMC_Read_Blocks and PSP_EMMC_Write_Blocks
+ *      wrap all of that up for code that just wants to wait.
+ *
+ *      The data moves on DMA channel 2, paced by the EMMC DREQ. Buffers must be word aligned.
+ *
+ *      On the Pi 1 and 3 the Arasan EMMC is connected to the SD card slot by setting GPIO
+ *      48...53 to ALT3 (the firmware leaves them on the SDHOST controller). On the Pi 4 the
+ *      slot is wired to EMMC2 instead, which has no DREQ on the legacy DMA controller, so the
+ *      Pi 4 build moves the data with the CPU while the request starts, the queue still works
+ *      the same.
+ *
+ *      Under QEMU, give the machine a card with make qemu SD_IMAGE=<raw disk image>.
+ *
+ * REFERENCES:
+ *      SD Specifications Part 1 Physical Layer Simplified Specification
+ *      SD Host Controller Simplified Specification (the EMMC is an SDHCI v3 controller)
+ *      BCM2835-ARM-Peripherals.pdf page 65 (EMMC)
+ */
+
+#ifndef PSP_EMMC_H_INCLUDED
+#define PSP_EMMC_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_EMMC Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_EMMC_BLOCK_SIZE              512u     // bytes per block, fixed for SDHC/SDXC and set for SDSC
+#define PSP_EMMC_MAX_BLOCKS_PER_REQUEST  65535u   // the controller's block count limit
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_EMMC Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum EMMC_Result_Type
+{
+    PSP_EMMC_Result_OK = 0u,
+    PSP_EMMC_Result_Pending,        // queued or in progress
+    PSP_EMMC_Result_No_Card,        // the card didn't answer during PSP_EMMC_Init
+    PSP_EMMC_Result_Timeout,        // a command or data transfer took too long
+    PSP_EMMC_Result_Error,          // the controller reported a CRC, end bit or index error
+    PSP_EMMC_Result_Bad_Request     // not initialized, out of range or unaligned buffer
+} PSP_EMMC_Result_t;
+
+
+
+typedef enum EMMC_Direction_Type
+{
+    PSP_EMMC_Direction_Read,        // card to buffer
+    PSP_EMMC_Direction_Write        // buffer to card
+} PSP_EMMC_Direction_t;
+
+
+
+typedef struct EMMC_Request_Type
+{
+    PSP_EMMC_Direction_t direction;
+    uint32_t first_block;                 // block number on the card
+    uint32_t num_blocks;                  // 1...PSP_EMMC_MAX_BLOCKS_PER_REQUEST
+    void * p_buffer;                      // num_blocks * PSP_EMMC_BLOCK_SIZE bytes, word aligned
+    volatile PSP_EMMC_Result_t result;    // PSP_EMMC_Result_Pending until the request is finished
+    struct EMMC_Request_Type * p_next;    // used by the queue
+} PSP_EMMC_Request_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_EMMC Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Init
+
+Function Description:
+    Reset the controller, identify the card, and bring it up on the 4 bit bus at the fastest
+    speed it supports. Throws away any queued requests.
+
+Inputs:
+    None
+
+Returns:
+    PSP_EMMC_Result_t: PSP_EMMC_Result_OK if the card is ready to use
+
+Error Handling:
+    Returns PSP_EMMC_Result_No_Card if nothing answers, or the error of the command that
+    failed. Every other function returns PSP_EMMC_Result_Bad_Request until an init succeeds.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_EMMC_Result_t PSP_EMMC_Init(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Get_Num_Blocks
+
+Function Description:
+    Get the size of the card.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: the number of PSP_EMMC_BLOCK_SIZE blocks on the card, 0 if not initialized
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_EMMC_Get_Num_Blocks(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Get_Bus_Clock_Hz
+
+Function Description:
+    Get the SD bus clock the card is running at.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: the SD clock in Hz
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_EMMC_Get_Bus_Clock_Hz(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Submit
+
+Function Description:
+    Add a request to the end of the queue, and start it straight away if the controller is
+    idle. The request (and its buffer) must stay put until its result isn't
+    PSP_EMMC_Result_Pending.
+
+Inputs:
+    p_request: the request, with direction, first_block, num_blocks and p_buffer filled in
+
+Returns:
+    PSP_EMMC_Result_t: PSP_EMMC_Result_Pending if queued, also written to p_request->result
+
+Error Handling:
+    Returns PSP_EMMC_Result_Bad_Request without queuing if the card isn't initialized, the
+    blocks run past the end of the card, num_blocks is out of range or the buffer isn't
+    word aligned.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_EMMC_Result_t PSP_EMMC_Submit(PSP_EMMC_Request_t * p_request);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Service
+
+Function Description:
+    Finish the request in progress if the card is done with it, and start the next request
+    in the queue. Never waits on the card. Call this regularly from the main loop while
+    requests are queued.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    A failed request gets its error as its result, and the queue moves on to the next one.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_EMMC_Service(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Is_Idle
+
+Function Description:
+    Check if there is nothing in progress and nothing queued.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: non-zero if idle
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_EMMC_Is_Idle(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Read_Blocks
+
+Function Description:
+    Read blocks from the card and wait for them, queued behind any requests already submitted.
+
+Inputs:
+    first_block: first block to read
+    num_blocks: number of blocks to read
+    p_buffer: where to put them, num_blocks * PSP_EMMC_BLOCK_SIZE bytes, word aligned
+
+Returns:
+    PSP_EMMC_Result_t: PSP_EMMC_Result_OK on success
+
+Error Handling:
+    Same as PSP_EMMC_Submit, plus any error from the transfer.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_EMMC_Result_t PSP_EMMC_Read_Blocks(uint32_t first_block, uint32_t num_blocks, void * p_buffer);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_EMMC_Write_Blocks
+
+Function Description:
+    Write blocks to the card and wait for them, queued behind any requests already submitted.
+
+Inputs:
+    first_block: first block to write
+    num_blocks: number of blocks to write
+    p_buffer: the data, num_blocks * PSP_EMMC_BLOCK_SIZE bytes, word aligned
+
+Returns:
+    PSP_EMMC_Result_t: PSP_EMMC_Result_OK on success
+
+Error Handling:
+    Same as PSP_EMMC_Submit, plus any error from the transfer.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_EMMC_Result_t PSP_EMMC_Write_Blocks(uint32_t first_block, uint32_t num_blocks, const void * p_buffer);
+
+#endif
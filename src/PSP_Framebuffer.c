@@ -0,0 +1,186 @@
+
+#include "PSP_Framebuffer.h"
+#include "PSP_Mailbox.h"
+#include "PSP_REGS.h"
+#include "PSP_Trace.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Framebuffer Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define FRAMEBUFFER_DEPTH           32u
+#define FRAMEBUFFER_PIXEL_ORDER     0u      // BGR, words are 0xAARRGGBB
+#define FRAMEBUFFER_ALPHA_IGNORED   2u
+#define FRAMEBUFFER_ALIGNMENT       16u     // bytes, so pages start on a NEON friendly boundary
+#define FRAMEBUFFER_NUM_PAGES       2u
+
+#define MAILBOX_TAG_REQUEST         0x00000000u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Framebuffer Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static volatile uint32_t framebuffer_message[40] __attribute__((aligned(16)));
+
+static uint32_t * framebuffer_p_pixels;
+static uint32_t framebuffer_width;
+static uint32_t framebuffer_height;
+static uint32_t framebuffer_pitch;
+static uint32_t framebuffer_num_pages;
+static uint32_t framebuffer_shown_page;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_Framebuffer Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * Add a tag to framebuffer_message at *p_index, with num_values value words of which the
+ * first num_inputs come from p_inputs and the rest are 0. Returns the index of the tag's
+ * first value word, for reading the answer.
+ */
+static uint32_t Framebuffer_Add_Tag(uint32_t * p_index, uint32_t tag, uint32_t num_values,
+                                    const uint32_t * p_inputs, uint32_t num_inputs)
+{
+    uint32_t index = *p_index;
+
+    framebuffer_message[index++] = tag;
+    framebuffer_message[index++] = num_values * sizeof(uint32_t);
+    framebuffer_message[index++] = MAILBOX_TAG_REQUEST;
+
+    const uint32_t VALUES = index;
+
+    for (uint32_t i = 0u; i < num_values; i++)
+    {
+        framebuffer_message[index++] = (i < num_inputs) ? p_inputs[i] : 0u;
+    }
+
+    *p_index = index;
+
+    return VALUES;
+}
+
+
+
+uint32_t PSP_Framebuffer_Init(uint32_t width, uint32_t height)
+{
+    const uint32_t PHYSICAL_SIZE[2] = { width, height };
+    const uint32_t VIRTUAL_SIZE[2] = { width, height * FRAMEBUFFER_NUM_PAGES };
+    const uint32_t DEPTH = FRAMEBUFFER_DEPTH;
+    const uint32_t PIXEL_ORDER = FRAMEBUFFER_PIXEL_ORDER;
+    const uint32_t ALPHA_MODE = FRAMEBUFFER_ALPHA_IGNORED;
+    const uint32_t ALIGNMENT = FRAMEBUFFER_ALIGNMENT;
+    uint32_t index = 2u;
+
+    framebuffer_num_pages = 0u;
+
+    // everything in one call, the firmware sets up the framebuffer once for all of it
+    Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_SET_PHYSICAL_SIZE, 2u, PHYSICAL_SIZE, 2u);
+    const uint32_t VIRTUAL = Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_SET_VIRTUAL_SIZE, 2u, VIRTUAL_SIZE, 2u);
+    Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_SET_VIRTUAL_OFFSET, 2u, 0, 0u);
+    const uint32_t DEPTH_ANSWER = Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_SET_DEPTH, 1u, &DEPTH, 1u);
+    Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_SET_PIXEL_ORDER, 1u, &PIXEL_ORDER, 1u);
+    Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_SET_ALPHA_MODE, 1u, &ALPHA_MODE, 1u);
+    const uint32_t BUFFER = Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_ALLOCATE_BUFFER, 2u, &ALIGNMENT, 1u);
+    const uint32_t PITCH = Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_GET_PITCH, 1u, 0, 0u);
+
+    framebuffer_message[index++] = PSP_MAILBOX_TAG_END;
+    framebuffer_message[0] = index * sizeof(uint32_t);
+    framebuffer_message[1] = PSP_MAILBOX_REQUEST;
+
+    if (!PSP_Mailbox_Property_Call(framebuffer_message) || (framebuffer_message[BUFFER] == 0u) ||
+        (framebuffer_message[DEPTH_ANSWER] != FRAMEBUFFER_DEPTH) || (framebuffer_message[VIRTUAL] != width) ||
+        (framebuffer_message[VIRTUAL + 1u] < height))
+    {
+        return 0u;
+    }
+
+    framebuffer_p_pixels = (uint32_t *)PSP_REGS_BUS_TO_RAM(framebuffer_message[BUFFER]);
+    framebuffer_width = width;
+    framebuffer_height = height;
+    framebuffer_pitch = framebuffer_message[PITCH];
+    framebuffer_num_pages = (framebuffer_message[VIRTUAL + 1u] >= (height * FRAMEBUFFER_NUM_PAGES)) ? FRAMEBUFFER_NUM_PAGES : 1u;
+    framebuffer_shown_page = 0u;
+
+    return 1u;
+}
+
+
+
+uint32_t * PSP_Framebuffer_Get_Page(uint32_t page)
+{
+    if (page >= framebuffer_num_pages)
+    {
+        return 0;
+    }
+
+    return (uint32_t *)((uint8_t *)framebuffer_p_pixels + (page * framebuffer_height * framebuffer_pitch));
+}
+
+
+
+uint32_t PSP_Framebuffer_Show_Page(uint32_t page)
+{
+    const uint32_t OFFSET[2] = { 0u, page * framebuffer_height };
+    uint32_t index = 2u;
+
+    if (page >= framebuffer_num_pages)
+    {
+        return 0u;
+    }
+
+    const uint32_t ANSWER = Framebuffer_Add_Tag(&index, PSP_MAILBOX_TAG_SET_VIRTUAL_OFFSET, 2u, OFFSET, 2u);
+
+    framebuffer_message[index++] = PSP_MAILBOX_TAG_END;
+    framebuffer_message[0] = index * sizeof(uint32_t);
+    framebuffer_message[1] = PSP_MAILBOX_REQUEST;
+
+    if (!PSP_Mailbox_Property_Call(framebuffer_message) || (framebuffer_message[ANSWER + 1u] != OFFSET[1]))
+    {
+        return 0u;
+    }
+
+    framebuffer_shown_page = page;
+
+    PSP_TRACE_INSTANT(PSP_Trace_Event_Framebuffer_Flip, page);
+
+    return 1u;
+}
+
+
+
+uint32_t PSP_Framebuffer_Get_Shown_Page(void)
+{
+    return framebuffer_shown_page;
+}
+
+
+
+uint32_t PSP_Framebuffer_Get_Num_Pages(void)
+{
+    return framebuffer_num_pages;
+}
+
+
+
+uint32_t PSP_Framebuffer_Get_Width(void)
+{
+    return framebuffer_width;
+}
+
+
+
+uint32_t PSP_Framebuffer_Get_Height(void)
+{
+    return framebuffer_height;
+}
+
+
+
+uint32_t PSP_Framebuffer_Get_Pitch(void)
+{
+    return framebuffer_pitch;
+}
@@ -0,0 +1,215 @@
+/**
+ * DESCRIPTION:
+ *      PSP_Framebuffer gets a framebuffer for the HDMI output from the GPU firmware, with two
+ *      pages that can be flipped between, so a frame can be drawn out of sight and shown all
+ *      at once.
+ *
+ * NOTES:
+ *      The framebuffer is asked for through the mailbox property channel as 32 bits per pixel,
+ *      with a virtual height of twice the display height. Page 0 is the top half and page 1
+ *      the bottom half, PSP_Framebuffer_Show_Page moves the display's virtual offset between
+ *      them, which is a single mailbox call with no copying. If the firmware won't make the
+ *      virtual height that big there is only one page, and PSP_Framebuffer_Get_Num_Pages says so.
+ *
+ *      Pixels are 32 bit words 0xAARRGGBB (the firmware calls that BGR order, because of the
+ *      order of the bytes in memory). The alpha byte is ignored by the display.
+ *
+ *      Lines are PSP_Framebuffer_Get_Pitch bytes apart, which may be more than 4 * width.
+ *
+ *      Drawing, and keeping the two pages in step, is up to BSP_Graphics.
+ *
+ *      QEMU's raspi machines have the framebuffer too, run with make qemu QEMU_DISPLAY=gtk (or
+ *      sdl) to see it.
+ *
+ * REFERENCES:
+ *      https://github.com/raspberrypi/firmware/wiki/Mailbox-property-interface (Frame Buffer)
+ */
+
+#ifndef PSP_FRAMEBUFFER_H_INCLUDED
+#define PSP_FRAMEBUFFER_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Framebuffer Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Init
+
+Function Description:
+    Ask the firmware for a two page framebuffer of the given size, and show page 0.
+
+Inputs:
+    width: display width in pixels, e.g. 640
+    height: display height in pixels, e.g. 480
+
+Returns:
+    uint32_t: 1 if there is a framebuffer to draw on, 0 otherwise
+
+Error Handling:
+    Returns 0 if the firmware doesn't answer, or answers with anything other than a 32 bit
+    per pixel framebuffer of the given size. Falls back to one page if it can't make two.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Framebuffer_Init(uint32_t width, uint32_t height);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Get_Page
+
+Function Description:
+    Get the pixels of a page.
+
+Inputs:
+    page: 0 or 1
+
+Returns:
+    uint32_t *: the top left pixel of the page, 0 if there is no such page
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t * PSP_Framebuffer_Get_Page(uint32_t page);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Show_Page
+
+Function Description:
+    Show a page on the display by moving the virtual offset to it. The firmware switches at
+    the next vertical blank.
+
+Inputs:
+    page: 0 or 1
+
+Returns:
+    uint32_t: 1 on success, 0 if the firmware didn't take it or there is no such page
+
+Error Handling:
+    The shown page doesn't change on failure.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Framebuffer_Show_Page(uint32_t page);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Get_Shown_Page
+
+Function Description:
+    Get the page on the display.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 0 or 1
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Framebuffer_Get_Shown_Page(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Get_Num_Pages
+
+Function Description:
+    Get the number of pages, 2 normally.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 0 before PSP_Framebuffer_Init succeeds, then 1 or 2
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Framebuffer_Get_Num_Pages(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Get_Width
+
+Function Description:
+    Get the width of the display.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: width in pixels
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Framebuffer_Get_Width(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Get_Height
+
+Function Description:
+    Get the height of the display, which is the height of one page.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: height in pixels
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Framebuffer_Get_Height(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Framebuffer_Get_Pitch
+
+Function Description:
+    Get the distance between the starts of two lines.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: pitch in bytes, a multiple of 4
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Framebuffer_Get_Pitch(void);
+
+#endif
@@ -51,6 +51,8 @@
 #define PSP_GPIO_GPPUDCLK0_A (GPIO_BASE_ADDRESS | 0x00000098u)  // GPIO Pin Pull-up/down Enable Clock 0 address
 #define PSP_GPIO_GPPUDCLK1_A (GPIO_BASE_ADDRESS | 0x0000009Cu)  // GPIO Pin Pull-up/down Enable Clock 1 address
 
+#define PSP_GPIO_PUP_PDN_CNTRL0_A (GPIO_BASE_ADDRESS | 0x000000E4u) // GPIO Pull-up/down Control 0 address (Pi 4 only)
+
 // Register Pointers
 #define PSP_GPIO_GPFSEL0_R   (*((volatile uint32_t *)PSP_GPIO_GPFSEL0_A))   // GPIO Function Select 0 register
 #define PSP_GPIO_GPFSEL1_R   (*((volatile uint32_t *)PSP_GPIO_GPFSEL1_A))   // GPIO Function Select 1 register
@@ -94,6 +96,8 @@
 #define PSP_GPIO_GPPUDCLK0_R (*((volatile uint32_t *)PSP_GPIO_GPPUDCLK0_A)) // GPIO Pin Pull-up/down Enable Clock 0 register
 #define PSP_GPIO_GPPUDCLK1_R (*((volatile uint32_t *)PSP_GPIO_GPPUDCLK1_A)) // GPIO Pin Pull-up/down Enable Clock 1 register
 
+#define PSP_GPIO_GPPUD_SETUP_CYCLES 150u // the datasheet asks for 150 cycles of setup and hold around GPPUDCLK
+
 #define PSP_GPIO_NUM_GPIO_PINS  54u
 #define PSP_GPIO_MAX_PINMODE_VALUE 0b111u
 
@@ -263,3 +267,95 @@ uint32_t PSP_GPIO_Read_Pin(uint32_t pin_num)
 
     return result;
 }
+
+
+
+/**
+ * wait at least the given number of cycles, the loop overhead only makes it longer,
+ * which is fine since the GPPUD sequence only asks for a minimum
+ */
+static void GPIO_Delay_Cycles(uint32_t num_cycles)
+{
+    while (num_cycles > 0u)
+    {
+        __asm__ volatile ("nop");
+        num_cycles--;
+    }
+}
+
+
+
+#if defined(PSP_BOARD_PI4)
+
+/**
+ * the Pi 4 dropped the GPPUD/GPPUDCLK sequence, each pin has 2 bits in one of the
+ * GPIO_PUP_PDN_CNTRL registers (16 pins per register), 0b00 = none, 0b01 = up, 0b10 = down
+ */
+void PSP_GPIO_Set_Pull(uint32_t bank_0_pins, uint32_t bank_1_pins, PSP_GPIO_Pull_t pull)
+{
+    const uint32_t PUP_PDN_VALUE = (pull == PSP_GPIO_Pull_Up) ? 0b01u : ((pull == PSP_GPIO_Pull_Down) ? 0b10u : 0b00u);
+
+    bank_1_pins &= PSP_GPIO_BANK_1_ALL_PINS;
+
+    for (uint32_t pin_num = 0u; pin_num < PSP_GPIO_NUM_GPIO_PINS; pin_num++)
+    {
+        const uint32_t BANK_PINS = PSP_GPIO_PIN_BANK(pin_num) ? bank_1_pins : bank_0_pins;
+
+        if (BANK_PINS & PSP_GPIO_PIN_MASK(pin_num))
+        {
+            volatile uint32_t * PUP_PDN_CNTRL_n = (volatile uint32_t *)PSP_GPIO_PUP_PDN_CNTRL0_A + (pin_num >> 4u);
+            const uint32_t PIN_POSITION = (pin_num & 15u) << 1u;
+
+            *PUP_PDN_CNTRL_n = (*PUP_PDN_CNTRL_n & ~(0b11u << PIN_POSITION)) | (PUP_PDN_VALUE << PIN_POSITION);
+        }
+    }
+}
+
+#else
+
+/**
+ * the pull-up/down sequence from the datasheet, page 101. all of the masked pins
+ * are clocked in at the same time, so setting 54 pins costs the same as setting 1
+ */
+void PSP_GPIO_Set_Pull(uint32_t bank_0_pins, uint32_t bank_1_pins, PSP_GPIO_Pull_t pull)
+{
+    // 1) write the desired control signal to GPPUD
+    PSP_GPIO_GPPUD_R = pull;
+
+    // 2) wait 150 cycles, this provides the required set-up time for the control signal
+    GPIO_Delay_Cycles(PSP_GPIO_GPPUD_SETUP_CYCLES);
+
+    // 3) write to GPPUDCLK0/1 to clock the control signal into the pins to be modified
+    PSP_GPIO_GPPUDCLK0_R = bank_0_pins;
+    PSP_GPIO_GPPUDCLK1_R = bank_1_pins & PSP_GPIO_BANK_1_ALL_PINS;
+
+    // 4) wait 150 cycles, this provides the required hold time for the control signal
+    GPIO_Delay_Cycles(PSP_GPIO_GPPUD_SETUP_CYCLES);
+
+    // 5) write to GPPUD to remove the control signal
+    PSP_GPIO_GPPUD_R = PSP_GPIO_Pull_None;
+
+    // 6) write to GPPUDCLK0/1 to remove the clock
+    PSP_GPIO_GPPUDCLK0_R = 0u;
+    PSP_GPIO_GPPUDCLK1_R = 0u;
+}
+
+#endif
+
+
+
+void PSP_GPIO_Set_Pin_Pull(uint32_t pin_num, PSP_GPIO_Pull_t pull)
+{
+    if (PSP_GPIO_NUM_GPIO_PINS <= pin_num)
+    {
+        return; // invalid pin number, do nothing
+    }
+    else if (pin_num <= HIGHEST_BIT_POSITION_IN_A_REGISTER)
+    {
+        PSP_GPIO_Set_Pull(PSP_GPIO_PIN_MASK(pin_num), 0u, pull);
+    }
+    else
+    {
+        PSP_GPIO_Set_Pull(0u, PSP_GPIO_PIN_MASK(pin_num), pull);
+    }
+}
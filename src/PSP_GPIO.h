@@ -8,6 +8,11 @@
  * NOTES:
  *      TODO: Add edge detection functionality.
  * 
+ *      The PSP_GPIO_Set_Pin_Mode/Write_Pin/Read_Pin functions range check the pin and work out
+ *      the register and bit position at runtime on every call. For pins that are known at compile
+ *      time (LED_PIN = 17u and so on) use the inline PSP_GPIO_Pin_* functions at the bottom of this
+ *      file instead, a constant pin number folds down to a single load or store of the right register.
+ * 
  * REFERENCES:
  *      BCM2837-ARM-Peripherals.pdf page 89
  */
@@ -16,6 +21,7 @@
 #define PSP_GPIO_H_INCLUDED
 
 #include "Fixed_Width_Ints.h"
+#include "PSP_REGS.h"
 
 /*-----------------------------------------------------------------------------------------------
     Public PSP_GPIO Definitions
@@ -34,6 +40,34 @@
 #define PSP_GPIO_PIN_WRITE_HIGH 1u
 #define PSP_GPIO_PIN_WRITE_LOW  0u
 
+// Pull-up/down bank masks, bank 0 is pins 0...31 and bank 1 is pins 32...53
+#define PSP_GPIO_BANK_0_ALL_PINS 0xFFFFFFFFu
+#define PSP_GPIO_BANK_1_ALL_PINS 0x003FFFFFu
+
+// Register bank addresses used by the inline pin functions, the second register of each bank
+// (GPFSEL1..5, GPSET1, GPCLR1, GPLEV1) follows at 4 byte steps
+#define PSP_GPIO_GPFSEL_BANK_A  (PSP_REGS_GPIO_BASE_ADDRESS | 0x00000000u)  // GPIO Function Select 0 address
+#define PSP_GPIO_GPSET_BANK_A   (PSP_REGS_GPIO_BASE_ADDRESS | 0x0000001Cu)  // GPIO Pin Output Set 0 address
+#define PSP_GPIO_GPCLR_BANK_A   (PSP_REGS_GPIO_BASE_ADDRESS | 0x00000028u)  // GPIO Pin Output Clear 0 address
+#define PSP_GPIO_GPLEV_BANK_A   (PSP_REGS_GPIO_BASE_ADDRESS | 0x00000034u)  // GPIO Pin Level 0 address
+
+// which 32 pin bank (0 or 1) a pin lives in, and its bit within that bank
+#define PSP_GPIO_PIN_BANK(pin)  ((pin) >> 5u)
+#define PSP_GPIO_PIN_MASK(pin)  (1u << ((pin) & 31u))
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_GPIO Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum GPIO_Pull_Type
+{
+    PSP_GPIO_Pull_None = 0u, // no pull resistor, the pin floats if nothing drives it
+    PSP_GPIO_Pull_Down = 1u, // ~50k pull-down to ground
+    PSP_GPIO_Pull_Up   = 2u  // ~50k pull-up to 3.3V
+} PSP_GPIO_Pull_t;
+
+
 
 /*-----------------------------------------------------------------------------------------------
     Public PSP_GPIO Function Declarations
@@ -119,4 +153,111 @@ Error Handling:
 -------------------------------------------------------------------------------------------------*/
 uint32_t PSP_GPIO_Read_Pin(uint32_t pin_num);
 
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Set_Pull
+
+Function Description:
+    Set the internal pull-up/pull-down resistor of many GPIO pins at once.
+
+    On the Pi 1 and 3 this runs the GPPUD/GPPUDCLK sequence from the datasheet once for all
+    of the given pins: write GPPUD, wait 150 cycles, clock the pins in with GPPUDCLK0/1, wait
+    150 cycles, then remove GPPUD and GPPUDCLK0/1. On the Pi 4 the pull of each pin is written
+    directly into the GPIO_PUP_PDN_CNTRL registers.
+
+    The pull setting is retained by the pins even when the GPIO block is powered down.
+
+Inputs:
+    bank_0_pins: mask of pins 0...31 to set, bit n is GPIO n
+    bank_1_pins: mask of pins 32...53 to set, bit n is GPIO (32 + n)
+    pull: the pull to apply to all of the masked pins, none, down, or up
+
+Returns:
+    None
+
+Error Handling:
+    Pins outside of the 54 GPIO pins (bits 22...31 of bank_1_pins) are ignored.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_GPIO_Set_Pull(uint32_t bank_0_pins, uint32_t bank_1_pins, PSP_GPIO_Pull_t pull);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Set_Pin_Pull
+
+Function Description:
+    Set the internal pull-up/pull-down resistor of a single GPIO pin. Shorthand for
+    PSP_GPIO_Set_Pull with a single bit set.
+
+Inputs:
+    pin_num: the GPIO pin to set the pull of
+    pull: none, down, or up
+
+Returns:
+    None
+
+Error Handling:
+    Returns without having any effect if the pin number is out of range.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_GPIO_Set_Pin_Pull(uint32_t pin_num, PSP_GPIO_Pull_t pull);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_GPIO Inline Pin Functions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * These do the same job as the functions above, but are inline and do no range checking, so the
+ * pin number MUST be less than 54. When the pin number (and value) is a compile time constant all
+ * of the bank/bit math is done by the compiler, for example:
+ * 
+ *      PSP_GPIO_Pin_High(17u);
+ * 
+ * becomes a single store of 0x00020000 to GPSET0, no call, no divide, no branch.
+ */
+
+static inline void PSP_GPIO_Pin_Set_Mode(uint32_t pin_num, uint32_t pin_mode)
+{
+    // 10 pins per GPFSEL register, 3 bits per pin
+    volatile uint32_t * GPFSEL_n = (volatile uint32_t *)PSP_GPIO_GPFSEL_BANK_A + (pin_num / 10u);
+    const uint32_t PIN_POSITION = (pin_num % 10u) * 3u;
+
+    *GPFSEL_n = (*GPFSEL_n & ~(0b111u << PIN_POSITION)) | (pin_mode << PIN_POSITION);
+}
+
+static inline void PSP_GPIO_Pin_High(uint32_t pin_num)
+{
+    ((volatile uint32_t *)PSP_GPIO_GPSET_BANK_A)[PSP_GPIO_PIN_BANK(pin_num)] = PSP_GPIO_PIN_MASK(pin_num);
+}
+
+static inline void PSP_GPIO_Pin_Low(uint32_t pin_num)
+{
+    ((volatile uint32_t *)PSP_GPIO_GPCLR_BANK_A)[PSP_GPIO_PIN_BANK(pin_num)] = PSP_GPIO_PIN_MASK(pin_num);
+}
+
+static inline void PSP_GPIO_Pin_Write(uint32_t pin_num, uint32_t value)
+{
+    if (value)
+    {
+        PSP_GPIO_Pin_High(pin_num);
+    }
+    else
+    {
+        PSP_GPIO_Pin_Low(pin_num);
+    }
+}
+
+static inline uint32_t PSP_GPIO_Pin_Read(uint32_t pin_num)
+{
+    return (((volatile uint32_t *)PSP_GPIO_GPLEV_BANK_A)[PSP_GPIO_PIN_BANK(pin_num)] >> (pin_num & 31u)) & 1u;
+}
+
 #endif
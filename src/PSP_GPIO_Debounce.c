@@ -0,0 +1,151 @@
+
+#include "PSP_GPIO_Debounce.h"
+#include "PSP_GPIO.h"
+#include "PSP_Time.h"
+#include "PSP_Trace.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_GPIO_Debounce Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define DEBOUNCE_NUM_BANKS    2u
+#define DEBOUNCE_TIMER        PSP_Time_Compare_Channel_3
+
+// Register Pointers
+#define DEBOUNCE_GPLEV_R(n)   (((volatile uint32_t *)PSP_GPIO_GPLEV_BANK_A)[(n)]) // GPIO Pin Level n register
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_GPIO_Debounce Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static uint32_t debounce_period_uSec;
+static uint32_t debounce_next_sample;
+
+// one bit per pin in each word, so every operation below works on 32 pins at once
+static uint32_t debounced_state[DEBOUNCE_NUM_BANKS];  // the debounced level of every pin
+static uint32_t counter_bit_0[DEBOUNCE_NUM_BANKS];    // low bit of each pin's 2 bit counter
+static uint32_t counter_bit_1[DEBOUNCE_NUM_BANKS];    // high bit of each pin's 2 bit counter
+static uint32_t pending_changes[DEBOUNCE_NUM_BANKS];  // pins that changed since the last Take_Changes
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_GPIO_Debounce Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+void PSP_GPIO_Debounce_Start(uint32_t sample_period_uSec)
+{
+    for (uint32_t bank = 0u; bank < DEBOUNCE_NUM_BANKS; bank++)
+    {
+        debounced_state[bank] = DEBOUNCE_GPLEV_R(bank);
+        counter_bit_0[bank] = 0xFFFFFFFFu; // counters idle at 0b11
+        counter_bit_1[bank] = 0xFFFFFFFFu;
+        pending_changes[bank] = 0u;
+    }
+
+    debounce_period_uSec = sample_period_uSec;
+    debounce_next_sample = (uint32_t)PSP_Time_Get_Ticks() + debounce_period_uSec;
+
+    PSP_Time_Set_Compare(DEBOUNCE_TIMER, debounce_next_sample);
+}
+
+
+
+void PSP_GPIO_Debounce_Service(void)
+{
+    if (PSP_Time_Compare_Matched(DEBOUNCE_TIMER))
+    {
+        // schedule off the last compare value rather than now, so the sample rate doesn't drift
+        debounce_next_sample += debounce_period_uSec;
+
+        // if we're so late the next sample time has already passed, start over from now
+        if ((int32_t)(debounce_next_sample - (uint32_t)PSP_Time_Get_Ticks()) <= 0)
+        {
+            debounce_next_sample = (uint32_t)PSP_Time_Get_Ticks() + debounce_period_uSec;
+        }
+
+        PSP_Time_Set_Compare(DEBOUNCE_TIMER, debounce_next_sample);
+
+        PSP_GPIO_Debounce_Sample();
+    }
+}
+
+
+
+/**
+ * Each pin has a 2 bit counter, stored "vertically" with bit 0 of every pin's counter in
+ * counter_bit_0 and bit 1 in counter_bit_1. 
+ * 
+ * For pins whose raw level matches their debounced level, the counter is reset to 0b11.
+ * For pins whose raw level differs, the counter counts down 0b11 -> 0b10 -> 0b01 -> 0b00 -> 0b11,
+ * and when it wraps back around to 0b11 the pin has differed for 4 samples in a row, so its 
+ * debounced level is flipped.
+ * 
+ * example, a single pin whose debounced level is 0 and now reads 1 (delta = 1):
+ * 
+ *      sample 1: bit_0 = ~(1 & 1) = 0, bit_1 = 0 ^ (1 & 1) = 1  -> 0b10, no flip
+ *      sample 2: bit_0 = ~(0 & 1) = 1, bit_1 = 1 ^ (1 & 1) = 0  -> 0b01, no flip
+ *      sample 3: bit_0 = ~(1 & 1) = 0, bit_1 = 0 ^ (0 & 1) = 0  -> 0b00, no flip
+ *      sample 4: bit_0 = ~(0 & 1) = 1, bit_1 = 1 ^ (0 & 1) = 1  -> 0b11, flip, debounced level is now 1
+ * 
+ * if the pin reads 0 again at any point before sample 4, delta is 0 and the counter resets.
+ */
+void PSP_GPIO_Debounce_Sample(void)
+{
+    for (uint32_t bank = 0u; bank < DEBOUNCE_NUM_BANKS; bank++)
+    {
+        // pins whose raw level differs from their debounced level
+        uint32_t delta = DEBOUNCE_GPLEV_R(bank) ^ debounced_state[bank];
+
+        counter_bit_0[bank] = ~(counter_bit_0[bank] & delta);
+        counter_bit_1[bank] = counter_bit_0[bank] ^ (counter_bit_1[bank] & delta);
+
+        // pins that differed and whose counter just wrapped around to 0b11
+        delta &= counter_bit_0[bank] & counter_bit_1[bank];
+
+        debounced_state[bank] ^= delta;
+        pending_changes[bank] |= delta;
+
+        if (delta != 0u)
+        {
+            // every pin that changed, one event per bank
+            PSP_TRACE_INSTANT(PSP_Trace_Event_GPIO_Debounce_Change + bank, delta);
+        }
+    }
+}
+
+
+
+uint32_t PSP_GPIO_Debounce_Read_Pin(uint32_t pin_num)
+{
+    if (pin_num >= 54u)
+    {
+        return 0u; // invalid pin number, return 0
+    }
+
+    return (debounced_state[PSP_GPIO_PIN_BANK(pin_num)] >> (pin_num & 31u)) & 1u;
+}
+
+
+
+uint32_t PSP_GPIO_Debounce_Read_Bank(uint32_t bank)
+{
+    return (bank < DEBOUNCE_NUM_BANKS) ? debounced_state[bank] : 0u;
+}
+
+
+
+uint32_t PSP_GPIO_Debounce_Take_Changes(uint32_t bank)
+{
+    uint32_t changes = 0u;
+
+    if (bank < DEBOUNCE_NUM_BANKS)
+    {
+        changes = pending_changes[bank];
+        pending_changes[bank] = 0u;
+    }
+
+    return changes;
+}
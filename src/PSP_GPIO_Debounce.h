@@ -0,0 +1,179 @@
+/**
+ * DESCRIPTION:
+ *      PSP_GPIO_Debounce provides debounced levels for all 54 GPIO pins at once. The GPLEV
+ *      banks are sampled at a fixed rate paced by System Timer compare channel 3, and each 
+ *      sample runs a 2 bit vertical counter over every pin in parallel with a handful of 
+ *      bitwise operations per bank.
+ * 
+ * NOTES:
+ *      A pin's debounced level only changes after it has read the same new level on 4 
+ *      consecutive samples, so with a 5000 uSec sample period a switch has to settle for
+ *      20 mSec before the change is seen.
+ * 
+ *      The compare channel's interrupt isn't used, PSP_GPIO_Debounce_Service polls it and
+ *      must be called regularly from the main loop (more often than the sample period). It
+ *      only reads the banks when the timer compare has matched, so calling it often is cheap.
+ * 
+ *      Uses System Timer compare channel 3.
+ * 
+ * REFERENCES:
+ *      BCM2837-ARM-Peripherals.pdf page 96 (GPLEV) and page 172 (System Timer)
+ *      https://www.compuphase.com/electronics/debouncing.htm (vertical counters)
+ */
+
+#ifndef PSP_GPIO_DEBOUNCE_H_INCLUDED
+#define PSP_GPIO_DEBOUNCE_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_GPIO_Debounce Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_GPIO_DEBOUNCE_DEFAULT_PERIOD_uSec 5000u // sample every 5 mSec, 20 mSec to settle
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_GPIO_Debounce Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Debounce_Start
+
+Function Description:
+    Start the debouncer. The debounced levels are seeded with the current raw levels, all
+    pending changes are cleared, and the first sample is scheduled on System Timer compare 3.
+
+Inputs:
+    sample_period_uSec: time between samples of the GPLEV banks
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_GPIO_Debounce_Start(uint32_t sample_period_uSec);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Debounce_Service
+
+Function Description:
+    Run a debounce sample if the sample period has elapsed, otherwise return straight away.
+    Call this regularly from the main loop.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    If the service is called late enough to miss a whole sample period, the next sample is
+    scheduled from the current time rather than trying to catch up.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_GPIO_Debounce_Service(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Debounce_Sample
+
+Function Description:
+    Unconditionally read both GPLEV banks and advance the vertical counters of every pin by one
+    sample. PSP_GPIO_Debounce_Service calls this, it is public so that it can be driven from
+    some other periodic source instead.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_GPIO_Debounce_Sample(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Debounce_Read_Pin
+
+Function Description:
+    Read the debounced level of a GPIO pin.
+
+Inputs:
+    pin_num: GPIO pin number to read
+
+Returns:
+    The debounced value of the GPIO pin (0 or 1)
+
+Error Handling:
+    Returns 0 if the pin number is out of range
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_GPIO_Debounce_Read_Pin(uint32_t pin_num);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Debounce_Read_Bank
+
+Function Description:
+    Read the debounced levels of a whole bank of pins.
+
+Inputs:
+    bank: 0 for pins 0...31, 1 for pins 32...53
+
+Returns:
+    uint32_t: the debounced levels, bit n is pin (32 * bank + n)
+
+Error Handling:
+    Returns 0 if the bank is out of range
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_GPIO_Debounce_Read_Bank(uint32_t bank);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_GPIO_Debounce_Take_Changes
+
+Function Description:
+    Get every pin of a bank whose debounced level has changed since the last call, and clear
+    them. AND the result with PSP_GPIO_Debounce_Read_Bank for rising edges, or with its inverse
+    for falling edges.
+
+Inputs:
+    bank: 0 for pins 0...31, 1 for pins 32...53
+
+Returns:
+    uint32_t: mask of pins that changed, bit n is pin (32 * bank + n)
+
+Error Handling:
+    Returns 0 if the bank is out of range
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_GPIO_Debounce_Take_Changes(uint32_t bank);
+
+#endif
@@ -1,32 +1,31 @@
-
 #include "PSP_I2C.h"
 #include "PSP_GPIO.h"
 #include "PSP_REGS.h"
+#include "PSP_Trace.h"
 
 /*-----------------------------------------------------------------------------------------------
     Private PSP_I2C Defines
  -------------------------------------------------------------------------------------------------*/
 
-// I2C Register Addresses
-#define PSP_I2C_BASE_A     (PSP_REGS_I2C_BASE_ADDRESS)
-#define PSP_I2C_C_A        (PSP_I2C_BASE_A | 0x00000000u)           // control register address
-#define PSP_I2C_S_A        (PSP_I2C_BASE_A | 0x00000004u)           // status register address
-#define PSP_I2C_DLEN_A     (PSP_I2C_BASE_A | 0x00000008u)           // data length register address
-#define PSP_I2C_SA_A       (PSP_I2C_BASE_A | 0x0000000Cu)           // slave address register address
-#define PSP_I2C_FIFO_A     (PSP_I2C_BASE_A | 0x00000010u)           // data FIFO register address
-#define PSP_I2C_DIV_A      (PSP_I2C_BASE_A | 0x00000014u)           // clock divider register address
-#define PSP_I2C_DEL_A      (PSP_I2C_BASE_A | 0x00000018u)           // data delay register address
-#define PSP_I2C_CLKT_A     (PSP_I2C_BASE_A | 0x0000001Cu)           // clock stretch timeout register address
+// I2C Register Addresses, bus n's block of registers is at i2c_base_addresses[n]
+#define PSP_I2C_C_A(n)     (i2c_base_addresses[n] | 0x00000000u)           // control register address
+#define PSP_I2C_S_A(n)     (i2c_base_addresses[n] | 0x00000004u)           // status register address
+#define PSP_I2C_DLEN_A(n)  (i2c_base_addresses[n] | 0x00000008u)           // data length register address
+#define PSP_I2C_SA_A(n)    (i2c_base_addresses[n] | 0x0000000Cu)           // slave address register address
+#define PSP_I2C_FIFO_A(n)  (i2c_base_addresses[n] | 0x00000010u)           // data FIFO register address
+#define PSP_I2C_DIV_A(n)   (i2c_base_addresses[n] | 0x00000014u)           // clock divider register address
+#define PSP_I2C_DEL_A(n)   (i2c_base_addresses[n] | 0x00000018u)           // data delay register address
+#define PSP_I2C_CLKT_A(n)  (i2c_base_addresses[n] | 0x0000001Cu)           // clock stretch timeout register address
 
 // I2C Register Pointers
-#define PSP_I2C_C_R        (*((volatile uint32_t *)PSP_I2C_C_A))    // control register
-#define PSP_I2C_S_R        (*((volatile uint32_t *)PSP_I2C_S_A))    // status register
-#define PSP_I2C_DLEN_R     (*((volatile uint32_t *)PSP_I2C_DLEN_A)) // data length register
-#define PSP_I2C_SA_R       (*((volatile uint32_t *)PSP_I2C_SA_A))   // slave address register
-#define PSP_I2C_FIFO_R     (*((volatile uint32_t *)PSP_I2C_FIFO_A)) // data FIFO register
-#define PSP_I2C_DIV_R      (*((volatile uint32_t *)PSP_I2C_DIV_A))  // clock divider register
-#define PSP_I2C_DEL_R      (*((volatile uint32_t *)PSP_I2C_DEL_A))  // data delay register
-#define PSP_I2C_CLKT_R     (*((volatile uint32_t *)PSP_I2C_CLKT_A)) // clock stretch timeout register
+#define PSP_I2C_C_R(n)     (*((volatile uint32_t *)PSP_I2C_C_A(n)))    // control register
+#define PSP_I2C_S_R(n)     (*((volatile uint32_t *)PSP_I2C_S_A(n)))    // status register
+#define PSP_I2C_DLEN_R(n)  (*((volatile uint32_t *)PSP_I2C_DLEN_A(n))) // data length register
+#define PSP_I2C_SA_R(n)    (*((volatile uint32_t *)PSP_I2C_SA_A(n)))   // slave address register
+#define PSP_I2C_FIFO_R(n)  (*((volatile uint32_t *)PSP_I2C_FIFO_A(n))) // data FIFO register
+#define PSP_I2C_DIV_R(n)   (*((volatile uint32_t *)PSP_I2C_DIV_A(n)))  // clock divider register
+#define PSP_I2C_DEL_R(n)   (*((volatile uint32_t *)PSP_I2C_DEL_A(n)))  // data delay register
+#define PSP_I2C_CLKT_R(n)  (*((volatile uint32_t *)PSP_I2C_CLKT_A(n))) // clock stretch timeout register
 
 // masks for I2C control register
 #define I2C_C_I2CEN        0x00008000u // I2C Enable, 0 = disabled, 1 = enabled
@@ -50,66 +49,342 @@
 #define I2C_S_DONE         0x00000002u // Transfer DONE
 #define I2C_S_TA           0x00000001u // Transfer Active
 
+#define I2C_MAX_LENGTH     0xFFFFu     // DLEN is 16 bits
+#define I2C_MAX_DIVIDER    0xFFFEu     // even, and 0 would mean 32768
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_I2C Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct I2C_Bus_State_Type
+{
+    const uint8_t * p_write;
+    uint32_t num_write;
+    uint32_t num_written;
+    uint8_t * p_read;
+    uint32_t num_read;
+    uint32_t num_received;
+    uint32_t reading;               // the read half has been started
+    uint32_t sda_pin;
+    uint32_t started;
+    PSP_I2C_Result_t result;
+} I2C_Bus_State_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_I2C Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static const uint32_t i2c_base_addresses[PSP_I2C_NUM_BUSES] =
+{
+    PSP_REGS_I2C_0_BASE_ADDRESS,
+    PSP_REGS_I2C_1_BASE_ADDRESS,
+    PSP_REGS_I2C_2_BASE_ADDRESS
+};
+
+static I2C_Bus_State_t i2c_buses[PSP_I2C_NUM_BUSES];
+
 
 
 /*-----------------------------------------------------------------------------------------------
     PSP_I2C Function Definitions
  -------------------------------------------------------------------------------------------------*/
 
+/**
+ * The alt mode that puts sda_pin (and the pin after it) on the bus, 0 if they don't go
+ * together.
+ */
+static uint32_t I2C_Pin_Mode(PSP_I2C_Bus_t bus, uint32_t sda_pin)
+{
+    switch (bus)
+    {
+        case PSP_I2C_Bus_0:
+            return ((sda_pin == 0u) || (sda_pin == 28u)) ? PSP_GPIO_PINMODE_ALT0 :
+                   (sda_pin == 44u) ? PSP_GPIO_PINMODE_ALT1 : 0u;
+
+        case PSP_I2C_Bus_1:
+            return (sda_pin == 2u) ? PSP_GPIO_PINMODE_ALT0 :
+                   (sda_pin == 44u) ? PSP_GPIO_PINMODE_ALT2 : 0u;
+
+        default:
+            return 0u;
+    }
+}
+
+
+
+static void I2C_Finish(PSP_I2C_Bus_t bus, PSP_I2C_Result_t result)
+{
+    // clear the flags (they clear by writing a 1) and anything left in the fifo
+    PSP_I2C_S_R(bus) = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    PSP_I2C_C_R(bus) = I2C_C_I2CEN | I2C_C_CLEAR_1;
+
+    i2c_buses[bus].result = result;
+
+    PSP_TRACE_END(PSP_Trace_Event_I2C0_Transfer + bus, result);
+}
+
+
+
+static void I2C_Service_Bus(PSP_I2C_Bus_t bus)
+{
+    I2C_Bus_State_t * p_state = &i2c_buses[bus];
+    uint32_t status = PSP_I2C_S_R(bus);
+
+    if (status & (I2C_S_ERR | I2C_S_CLKT))
+    {
+        I2C_Finish(bus, (status & I2C_S_ERR) ? PSP_I2C_Result_Nack : PSP_I2C_Result_Clock_Timeout);
+        return;
+    }
+
+    if (!p_state->reading)
+    {
+        while ((status & I2C_S_TXD) && (p_state->num_written < p_state->num_write))
+        {
+            PSP_I2C_FIFO_R(bus) = p_state->p_write[p_state->num_written++];
+            status = PSP_I2C_S_R(bus);
+        }
+
+        if (p_state->num_written < p_state->num_write)
+        {
+            return; // more to write
+        }
+
+        if (p_state->num_read == 0u)
+        {
+            if (status & I2C_S_DONE)
+            {
+                I2C_Finish(bus, PSP_I2C_Result_OK);
+            }
+
+            return;
+        }
+
+        // queueing the read while the write is still active makes it a repeated start,
+        // but not before the write has actually started
+        if (!(status & (I2C_S_TA | I2C_S_DONE)))
+        {
+            return;
+        }
+
+        PSP_I2C_S_R(bus) = I2C_S_DONE;
+        PSP_I2C_DLEN_R(bus) = p_state->num_read;
+        PSP_I2C_C_R(bus) = I2C_C_I2CEN | I2C_C_ST | I2C_C_READ;
+        p_state->reading = 1u;
+        status = PSP_I2C_S_R(bus);
+    }
+
+    while ((status & I2C_S_RXD) && (p_state->num_received < p_state->num_read))
+    {
+        p_state->p_read[p_state->num_received++] = (uint8_t)PSP_I2C_FIFO_R(bus);
+        status = PSP_I2C_S_R(bus);
+    }
+
+    if ((p_state->num_received == p_state->num_read) && (status & I2C_S_DONE) && !(status & I2C_S_TA))
+    {
+        I2C_Finish(bus, PSP_I2C_Result_OK);
+    }
+}
+
+
+
+uint32_t PSP_I2C_Start(PSP_I2C_Bus_t bus, uint32_t sda_pin)
+{
+    if (bus >= PSP_I2C_NUM_BUSES)
+    {
+        return 0u;
+    }
+
+    if (sda_pin != PSP_I2C_NO_PINS)
+    {
+        const uint32_t PIN_MODE = I2C_Pin_Mode(bus, sda_pin);
+
+        if (PIN_MODE == 0u)
+        {
+            return 0u;
+        }
+
+        PSP_GPIO_Set_Pin_Mode(sda_pin, PIN_MODE);
+        PSP_GPIO_Set_Pin_Mode(sda_pin + 1u, PIN_MODE);
+        PSP_GPIO_Set_Pin_Pull(sda_pin, PSP_GPIO_Pull_Up);
+        PSP_GPIO_Set_Pin_Pull(sda_pin + 1u, PSP_GPIO_Pull_Up);
+    }
+    else if (bus != PSP_I2C_Bus_2)
+    {
+        return 0u;
+    }
+
+    i2c_buses[bus].sda_pin = sda_pin;
+    i2c_buses[bus].started = 1u;
+    i2c_buses[bus].result = PSP_I2C_Result_OK;
+
+    PSP_I2C_S_R(bus) = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    PSP_I2C_C_R(bus) = I2C_C_I2CEN | I2C_C_CLEAR_1;
+    PSP_I2C_Set_Speed_Hz(bus, PSP_I2C_STANDARD_HZ);
+
+    return 1u;
+}
+
+
+
+void PSP_I2C_End(PSP_I2C_Bus_t bus)
+{
+    if ((bus >= PSP_I2C_NUM_BUSES) || !i2c_buses[bus].started)
+    {
+        return;
+    }
+
+    PSP_I2C_C_R(bus) = I2C_C_CLEAR_1;
+
+    if (i2c_buses[bus].sda_pin != PSP_I2C_NO_PINS)
+    {
+        PSP_GPIO_Set_Pin_Mode(i2c_buses[bus].sda_pin, PSP_GPIO_PINMODE_INPUT);
+        PSP_GPIO_Set_Pin_Mode(i2c_buses[bus].sda_pin + 1u, PSP_GPIO_PINMODE_INPUT);
+    }
+
+    i2c_buses[bus].started = 0u;
+    i2c_buses[bus].result = PSP_I2C_Result_OK;
+}
+
+
+
+void PSP_I2C_Set_Clock_Divider(PSP_I2C_Bus_t bus, uint32_t divider)
+{
+    PSP_I2C_DIV_R(bus) = divider;
+}
+
+
+
+uint32_t PSP_I2C_Set_Speed_Hz(PSP_I2C_Bus_t bus, uint32_t speed_hz)
+{
+    uint32_t divider = (speed_hz == 0u) ? I2C_MAX_DIVIDER : ((PSP_REGS_CORE_CLOCK_HZ + speed_hz - 1u) / speed_hz);
+
+    // round up to even, so the speed never comes out faster than asked for
+    divider = (divider + 1u) & ~1u;
+
+    if (divider > I2C_MAX_DIVIDER)
+    {
+        divider = I2C_MAX_DIVIDER;
+    }
+
+    PSP_I2C_Set_Clock_Divider(bus, divider);
+
+    return PSP_REGS_CORE_CLOCK_HZ / divider;
+}
+
+
+
+void PSP_I2C_Set_Slave_Address(PSP_I2C_Bus_t bus, uint32_t address)
+{
+    PSP_I2C_SA_R(bus) = address;
+}
+
+
 
-void PSP_I2C_Start(void)
+PSP_I2C_Result_t PSP_I2C_Write_Byte(PSP_I2C_Bus_t bus, uint8_t val)
 {
-    PSP_GPIO_Set_Pin_Mode(I2C_SDA_PIN, PSP_GPIO_PINMODE_ALT0);
-    PSP_GPIO_Set_Pin_Mode(I2C_SCL_PIN, PSP_GPIO_PINMODE_ALT0);
+    return PSP_I2C_Transfer(bus, PSP_I2C_SA_R(bus), &val, 1u, 0, 0u);
 }
 
 
 
- void PSP_I2C_End(void)
- {
-    PSP_GPIO_Set_Pin_Mode(I2C_SDA_PIN, PSP_GPIO_PINMODE_INPUT);
-    PSP_GPIO_Set_Pin_Mode(I2C_SCL_PIN, PSP_GPIO_PINMODE_INPUT);
- }
+PSP_I2C_Result_t PSP_I2C_Transfer_Start(PSP_I2C_Bus_t bus, uint32_t address, const uint8_t * p_write,
+                                        uint32_t num_write, uint8_t * p_read, uint32_t num_read)
+{
+    if ((bus >= PSP_I2C_NUM_BUSES) || ((num_write == 0u) && (num_read == 0u)) ||
+        (num_write > I2C_MAX_LENGTH) || (num_read > I2C_MAX_LENGTH))
+    {
+        return PSP_I2C_Result_Bad_Request;
+    }
+
+    I2C_Bus_State_t * p_state = &i2c_buses[bus];
+
+    if (p_state->result == PSP_I2C_Result_Busy)
+    {
+        return PSP_I2C_Result_Busy;
+    }
+
+    p_state->p_write = p_write;
+    p_state->num_write = num_write;
+    p_state->num_written = 0u;
+    p_state->p_read = p_read;
+    p_state->num_read = num_read;
+    p_state->num_received = 0u;
+    p_state->reading = (num_write == 0u) ? 1u : 0u;
+    p_state->result = PSP_I2C_Result_Busy;
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_I2C0_Transfer + bus, num_write + num_read);
+
+    // clear the fifo and the clock stretch timeout, no acknowledge error, and transfer done
+    // status flags, note that these flags are cleared by writing a 1
+    PSP_I2C_C_R(bus) = I2C_C_I2CEN | I2C_C_CLEAR_1;
+    PSP_I2C_S_R(bus) = I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
+    PSP_I2C_SA_R(bus) = address;
+
+    if (num_write != 0u)
+    {
+        PSP_I2C_DLEN_R(bus) = num_write;
+
+        // prime the fifo so the first bytes are ready as soon as the address is acknowledged
+        while ((PSP_I2C_S_R(bus) & I2C_S_TXD) && (p_state->num_written < num_write))
+        {
+            PSP_I2C_FIFO_R(bus) = p_write[p_state->num_written++];
+        }
+
+        PSP_I2C_C_R(bus) = I2C_C_I2CEN | I2C_C_ST;
+    }
+    else
+    {
+        PSP_I2C_DLEN_R(bus) = num_read;
+        PSP_I2C_C_R(bus) = I2C_C_I2CEN | I2C_C_ST | I2C_C_READ;
+    }
+
+    return PSP_I2C_Result_OK;
+}
 
 
 
-void PSP_I2C_Set_Clock_Divider(uint32_t divider)
+void PSP_I2C_Service(void)
 {
-    PSP_I2C_DIV_R = divider;
+    for (uint32_t bus = 0u; bus < PSP_I2C_NUM_BUSES; bus++)
+    {
+        if (i2c_buses[bus].result == PSP_I2C_Result_Busy)
+        {
+            I2C_Service_Bus((PSP_I2C_Bus_t)bus);
+        }
+    }
 }
 
 
 
-void PSP_I2C_Set_Slave_Address(uint32_t address)
+PSP_I2C_Result_t PSP_I2C_Get_Result(PSP_I2C_Bus_t bus)
 {
-    PSP_I2C_SA_R = address;
+    return (bus < PSP_I2C_NUM_BUSES) ? i2c_buses[bus].result : PSP_I2C_Result_Bad_Request;
 }
 
 
 
-void PSP_I2C_Write_Byte(uint8_t val)
+PSP_I2C_Result_t PSP_I2C_Transfer(PSP_I2C_Bus_t bus, uint32_t address, const uint8_t * p_write,
+                                  uint32_t num_write, uint8_t * p_read, uint32_t num_read)
 {
-    // clear the fifo
-    PSP_I2C_C_R |= I2C_C_CLEAR_1;
+    PSP_I2C_Result_t result = PSP_I2C_Transfer_Start(bus, address, p_write, num_write, p_read, num_read);
 
-    // clear the clock stretch timeout, no acknowledge error, and transfer done status flags 
-    // note that these flags are cleared by writing a 1
-    PSP_I2C_S_R |= I2C_S_CLKT | I2C_S_ERR | I2C_S_DONE;
-    
-    // set data length to 1 byte
-    PSP_I2C_DLEN_R = 1u;
+    if (result != PSP_I2C_Result_OK)
+    {
+        return result;
+    }
 
-    // write the value to the fifo
-    PSP_I2C_FIFO_R = val;
-    
-    // enable device and start transfer
-    PSP_I2C_C_R |= I2C_C_I2CEN | I2C_C_ST;
+    PSP_TRACE_BEGIN(PSP_Trace_Event_CPU_Wait_I2C, bus);
 
-    while (!(PSP_I2C_S_R & I2C_S_DONE))
+    while ((result = PSP_I2C_Get_Result(bus)) == PSP_I2C_Result_Busy)
     {
-        // wait for transfer to complete
+        PSP_I2C_Service();
     }
 
-    // set the done flag inorder to clear it and end the transfer
-    PSP_I2C_S_R |= I2C_S_DONE;
+    PSP_TRACE_END(PSP_Trace_Event_CPU_Wait_I2C, bus);
+
+    return result;
 }
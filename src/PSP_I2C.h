@@ -1,14 +1,31 @@
 /**
  * DESCRIPTION:
- *      PSP_I2C provides an interface for using I2C.
- * 
+ *      PSP_I2C provides an interface for using the BSC (I2C master) controllers, each bus
+ *      with its own pins and clock speed, and transfers that run on several buses at once.
+ *
  * NOTES:
- *      TODO: Writing data has been tested, but reading data has not. To do so,
- *      I'll need to set up some I2C device to talk back to the Pi and run some
- *      tests. Until then, consider reading data to be broken.
- * 
- *      TODO: Add functions to read/write more than one byte at a time.
- * 
+ *      The buses:
+ *          PSP_I2C_Bus_0   BSC0, on GPIO0/1 (the HAT ID EEPROM pins), GPIO28/29 or GPIO44/45
+ *          PSP_I2C_Bus_1   BSC1, on GPIO2/3 (the usual header I2C pins, 1.8k pull-ups on board)
+ *                          or GPIO44/45
+ *          PSP_I2C_Bus_2   BSC2, wired to the HDMI connector's DDC pins only, usable to read
+ *                          a monitor's EDID at 0x50 and nothing else
+ *      GPIO28/29 and 44/45 only reach a header on the compute modules and early Pi 1s.
+ *
+ *      Every bus has its own controller, so a slow 100kHz sensor bus and a 400kHz or 1MHz
+ *      fast mode bus don't wait on each other: start a transfer on each with
+ *      PSP_I2C_Transfer_Start, then call PSP_I2C_Service (which looks after every bus) until
+ *      they are all done. The controllers have 16 byte FIFOs, PSP_I2C_Service keeps them
+ *      topped up and drained, so transfers can be any length as long as it is called often
+ *      enough. PSP_I2C_Transfer does the same for one bus and waits.
+ *
+ *      A write followed by a read (a register address, then the register) is sent with a
+ *      repeated start, no stop in between, as long as PSP_I2C_Service gets to queue the read
+ *      before the write is over, which it always does when the write fits the FIFO.
+ *      Otherwise the read follows after a stop, which nearly every device accepts too.
+ *
+ *      TODO: reading has been tested less than writing, as there has been less to read from.
+ *
  * REFERENCES:
  *      BCM2837-ARM-Peripherals.pdf page 28
  */
@@ -22,9 +39,37 @@
     Public PSP_I2C Defines
  -------------------------------------------------------------------------------------------------*/
 
-// pin constants for I2C
-#define I2C_SDA_PIN        2u
-#define I2C_SCL_PIN        3u
+#define PSP_I2C_NUM_BUSES       3u
+#define PSP_I2C_NO_PINS         0xFFFFFFFFu     // for PSP_I2C_Bus_2, which has no GPIO pins
+#define PSP_I2C_FIFO_SIZE       16u             // bytes
+
+#define PSP_I2C_STANDARD_HZ     100000u
+#define PSP_I2C_FAST_HZ         400000u
+#define PSP_I2C_FAST_PLUS_HZ    1000000u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_I2C Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef enum I2C_Bus_Type
+{
+    PSP_I2C_Bus_0 = 0u,
+    PSP_I2C_Bus_1 = 1u,
+    PSP_I2C_Bus_2 = 2u
+} PSP_I2C_Bus_t;
+
+
+
+typedef enum I2C_Result_Type
+{
+    PSP_I2C_Result_OK            = 0u,
+    PSP_I2C_Result_Busy          = 1u,  // a transfer is still going
+    PSP_I2C_Result_Nack          = 2u,  // nothing acknowledged the address
+    PSP_I2C_Result_Clock_Timeout = 3u,  // the slave held SCL low for too long
+    PSP_I2C_Result_Bad_Request   = 4u   // no such bus, or nothing to transfer
+} PSP_I2C_Result_t;
 
 
 
@@ -39,19 +84,22 @@ Function Name:
     PSP_I2C_Start
 
 Function Description:
-    Initialize I2C by setting GPIO pins 2 and 3 to alt mode 0.
+    Initialize a bus: set its SDA and SCL pins to the BSC alt mode with pull-ups, enable the
+    controller and set it to 100kHz.
 
 Inputs:
-    None
+    bus: the controller
+    sda_pin: the bus's SDA pin, SCL is the next pin up (see the NOTES for which go with which
+             bus), or PSP_I2C_NO_PINS for PSP_I2C_Bus_2
 
 Returns:
-    None
+    uint32_t: 1 on success, 0 if the pins don't belong to the bus
 
 Error Handling:
-    None
+    Nothing is changed on failure.
 
 -------------------------------------------------------------------------------------------------*/
-void PSP_I2C_Start(void);
+uint32_t PSP_I2C_Start(PSP_I2C_Bus_t bus, uint32_t sda_pin);
 
 
 
@@ -61,19 +109,19 @@ Function Name:
     PSP_I2C_End
 
 Function Description:
-    Shut down I2C by setting GPIO pins 2 and 3 to inputs.
+    Shut down a bus by disabling the controller and setting its pins back to inputs.
 
 Inputs:
-    None
+    bus: the controller
 
 Returns:
     None
 
 Error Handling:
-    None
+    Does nothing for a bus that wasn't started.
 
 -------------------------------------------------------------------------------------------------*/
-void PSP_I2C_End(void);
+void PSP_I2C_End(PSP_I2C_Bus_t bus);
 
 
 
@@ -83,14 +131,13 @@ Function Name:
     PSP_I2C_Set_Clock_Divider
 
 Function Description:
-    Sets the clock divider for I2C. This sets the clock speed.
+    Sets the clock divider for a bus. This sets the clock speed.
 
 Inputs:
-    divider: This must be a power of 2. Only the lower 16 bits are used. Odd number are rounded down.
-
-    SCL = core_clock / divider Where core_clock is nominally 150 MHz. If divider is set to 0, the divisor is 32768. 
-    divider is always rounded down to an even number. The default value should result in a 100 kHz I2C clock
-    frequency.
+    bus: the controller
+    divider: SCL = core clock / divider, with the core clock PSP_REGS_CORE_CLOCK_HZ. Only the
+             lower 16 bits are used and odd numbers are rounded down. If divider is set to 0,
+             the divisor is 32768.
 
 Returns:
     None
@@ -99,7 +146,30 @@ Error Handling:
     None
 
 -------------------------------------------------------------------------------------------------*/
-void PSP_I2C_Set_Clock_Divider(uint32_t divider);
+void PSP_I2C_Set_Clock_Divider(PSP_I2C_Bus_t bus, uint32_t divider);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_I2C_Set_Speed_Hz
+
+Function Description:
+    Sets the clock speed of a bus, rounding down to the nearest the divider can make.
+
+Inputs:
+    bus: the controller
+    speed_hz: SCL frequency, e.g. PSP_I2C_FAST_HZ
+
+Returns:
+    uint32_t: the SCL frequency actually set, in Hz
+
+Error Handling:
+    Speeds too slow for the divider get the slowest it can do, about 7.6kHz.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_I2C_Set_Speed_Hz(PSP_I2C_Bus_t bus, uint32_t speed_hz);
 
 
 
@@ -109,10 +179,11 @@ Function Name:
     PSP_I2C_Set_Slave_Address
 
 Function Description:
-    Sets the I2C slave device address.
+    Sets the slave address PSP_I2C_Write_Byte talks to.
 
 Inputs:
-    r0: address, the 7 bit address of the device to communicate with. Uses only bits [0, 6].
+    bus: the controller
+    address: the 7 bit address of the device to communicate with. Uses only bits [0, 6].
 
 Returns:
     None
@@ -121,7 +192,7 @@ Error Handling:
     None
 
 -------------------------------------------------------------------------------------------------*/
-void PSP_I2C_Set_Slave_Address(uint32_t address);
+void PSP_I2C_Set_Slave_Address(PSP_I2C_Bus_t bus, uint32_t address);
 
 
 
@@ -131,19 +202,124 @@ Function Name:
     PSP_I2C_Write_Byte
 
 Function Description:
-    Writes a single byte to the address in the I2C address register.
+    Writes a single byte to the slave address set with PSP_I2C_Set_Slave_Address, and waits
+    for it to go.
 
 Inputs:
+    bus: the controller
     val: the byte to write.
 
 Returns:
-    None (TODO: this should return some error/ok code in the future that specifies if the transmission was succesful)
+    PSP_I2C_Result_t: PSP_I2C_Result_OK if the byte was acknowledged
+
+Error Handling:
+    See PSP_I2C_Transfer.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_I2C_Result_t PSP_I2C_Write_Byte(PSP_I2C_Bus_t bus, uint8_t val);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_I2C_Transfer_Start
+
+Function Description:
+    Start writing and/or reading on a bus, and return straight away. With both, the write
+    comes first and the read follows it with a repeated start. PSP_I2C_Service moves it
+    along, PSP_I2C_Get_Result says when it is over.
+
+Inputs:
+    bus: the controller
+    address: the 7 bit slave address
+    p_write: the bytes to write, they must stay put until the transfer is over
+    num_write: the number of bytes to write, 0 for a read only
+    p_read: where the bytes read go
+    num_read: the number of bytes to read, 0 for a write only
+
+Returns:
+    PSP_I2C_Result_t: PSP_I2C_Result_OK if the transfer has started
+
+Error Handling:
+    Returns PSP_I2C_Result_Busy if the bus already has a transfer going, and
+    PSP_I2C_Result_Bad_Request for a bus that doesn't exist or a transfer of nothing (or
+    more than 65535 bytes either way).
+
+-------------------------------------------------------------------------------------------------*/
+PSP_I2C_Result_t PSP_I2C_Transfer_Start(PSP_I2C_Bus_t bus, uint32_t address, const uint8_t * p_write,
+                                        uint32_t num_write, uint8_t * p_read, uint32_t num_read);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_I2C_Service
+
+Function Description:
+    Move the transfers on every bus along: fill the Tx FIFOs, empty the Rx FIFOs, start the
+    read half of a write then read, and notice transfers finishing or failing. Call it often
+    while transfers are going, a FIFO lasts 16 bytes, 160uSec at 1MHz.
+
+Inputs:
+    None
+
+Returns:
+    None
 
 Error Handling:
     None
 
 -------------------------------------------------------------------------------------------------*/
-void PSP_I2C_Write_Byte(uint8_t val);
+void PSP_I2C_Service(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_I2C_Get_Result
+
+Function Description:
+    Get the state of the last transfer on a bus.
+
+Inputs:
+    bus: the controller
+
+Returns:
+    PSP_I2C_Result_t: PSP_I2C_Result_Busy while it is going, then how it went
+
+Error Handling:
+    On a Nack or Clock_Timeout, any bytes already read are in the read buffer, the rest is
+    untouched.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_I2C_Result_t PSP_I2C_Get_Result(PSP_I2C_Bus_t bus);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_I2C_Transfer
+
+Function Description:
+    PSP_I2C_Transfer_Start, then PSP_I2C_Service until the transfer is over. Transfers
+    started on other buses carry on meanwhile.
+
+Inputs:
+    See PSP_I2C_Transfer_Start
+
+Returns:
+    PSP_I2C_Result_t: how the transfer went
+
+Error Handling:
+    See PSP_I2C_Transfer_Start and PSP_I2C_Get_Result.
+
+-------------------------------------------------------------------------------------------------*/
+PSP_I2C_Result_t PSP_I2C_Transfer(PSP_I2C_Bus_t bus, uint32_t address, const uint8_t * p_write,
+                                  uint32_t num_write, uint8_t * p_read, uint32_t num_read);
 
 
 
@@ -0,0 +1,640 @@
+#include "PSP_IRQ.h"
+#include "PSP_REGS.h"
+#include "PSP_Time.h"
+#include "PSP_Aux_Mini_UART.h"
+#include "PSP_Trace.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_IRQ Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#if defined(PSP_REGS_HAS_GIC_400)
+
+// GIC Distributor Register Addresses
+#define PSP_IRQ_GICD_CTLR_A         (PSP_REGS_GIC_DIST_BASE_ADDRESS | 0x00000000u)  // Distributor control address
+#define PSP_IRQ_GICD_ISENABLER_A    (PSP_REGS_GIC_DIST_BASE_ADDRESS | 0x00000100u)  // Set enable, 32 interrupts per register
+#define PSP_IRQ_GICD_ICENABLER_A    (PSP_REGS_GIC_DIST_BASE_ADDRESS | 0x00000180u)  // Clear enable, 32 interrupts per register
+#define PSP_IRQ_GICD_ICPENDR_A      (PSP_REGS_GIC_DIST_BASE_ADDRESS | 0x00000280u)  // Clear pending, 32 interrupts per register
+#define PSP_IRQ_GICD_IPRIORITYR_A   (PSP_REGS_GIC_DIST_BASE_ADDRESS | 0x00000400u)  // Priority, a byte per interrupt
+#define PSP_IRQ_GICD_ITARGETSR_A    (PSP_REGS_GIC_DIST_BASE_ADDRESS | 0x00000800u)  // Target CPUs, a byte per interrupt
+
+// GIC CPU Interface Register Addresses
+#define PSP_IRQ_GICC_CTLR_A         (PSP_REGS_GIC_CPU_BASE_ADDRESS | 0x00000000u)   // CPU interface control address
+#define PSP_IRQ_GICC_PMR_A          (PSP_REGS_GIC_CPU_BASE_ADDRESS | 0x00000004u)   // Priority mask address
+#define PSP_IRQ_GICC_IAR_A          (PSP_REGS_GIC_CPU_BASE_ADDRESS | 0x0000000Cu)   // Interrupt acknowledge address
+#define PSP_IRQ_GICC_EOIR_A         (PSP_REGS_GIC_CPU_BASE_ADDRESS | 0x00000010u)   // End of interrupt address
+
+// GIC Register Pointers
+#define PSP_IRQ_GICD_CTLR_R         (*((volatile uint32_t *)PSP_IRQ_GICD_CTLR_A))   // Distributor control register
+#define PSP_IRQ_GICD_ISENABLER_P    ((volatile uint32_t *)PSP_IRQ_GICD_ISENABLER_A)
+#define PSP_IRQ_GICD_ICENABLER_P    ((volatile uint32_t *)PSP_IRQ_GICD_ICENABLER_A)
+#define PSP_IRQ_GICD_ICPENDR_P      ((volatile uint32_t *)PSP_IRQ_GICD_ICPENDR_A)
+#define PSP_IRQ_GICD_IPRIORITYR_P   ((volatile uint8_t *)PSP_IRQ_GICD_IPRIORITYR_A)
+#define PSP_IRQ_GICD_ITARGETSR_P    ((volatile uint8_t *)PSP_IRQ_GICD_ITARGETSR_A)
+#define PSP_IRQ_GICC_CTLR_R         (*((volatile uint32_t *)PSP_IRQ_GICC_CTLR_A))   // CPU interface control register
+#define PSP_IRQ_GICC_PMR_R          (*((volatile uint32_t *)PSP_IRQ_GICC_PMR_A))    // Priority mask register
+#define PSP_IRQ_GICC_IAR_R          (*((volatile uint32_t *)PSP_IRQ_GICC_IAR_A))    // Interrupt acknowledge register
+#define PSP_IRQ_GICC_EOIR_R         (*((volatile uint32_t *)PSP_IRQ_GICC_EOIR_A))   // End of interrupt register
+
+#define IRQ_GIC_NUM_INTERRUPTS      256u        // BCM2711
+#define IRQ_GIC_FIRST_SOURCE        96u         // VideoCore interrupt 0
+#define IRQ_GIC_INTID_MASK          0x000003FFu
+#define IRQ_GIC_SPURIOUS            1023u
+#define IRQ_GIC_PRIORITY            0xA0u       // all the same, so none preempts another
+#define IRQ_GIC_PRIORITY_MASK       0xF0u       // let every priority above through
+#define IRQ_GIC_TARGET_CPU_0        0x01u
+#define IRQ_GIC_ENABLE              0x00000001u
+
+#else
+
+// Interrupt Controller Register Addresses
+#define PSP_IRQ_PENDING_1_A         (PSP_REGS_IRQ_BASE_ADDRESS | 0x00000004u)   // Pending sources 0...31 address
+#define PSP_IRQ_PENDING_2_A         (PSP_REGS_IRQ_BASE_ADDRESS | 0x00000008u)   // Pending sources 32...63 address
+#define PSP_IRQ_FIQ_CONTROL_A       (PSP_REGS_IRQ_BASE_ADDRESS | 0x0000000Cu)   // FIQ control address
+#define PSP_IRQ_ENABLE_1_A          (PSP_REGS_IRQ_BASE_ADDRESS | 0x00000010u)   // Enable sources 0...31 address
+#define PSP_IRQ_ENABLE_2_A          (PSP_REGS_IRQ_BASE_ADDRESS | 0x00000014u)   // Enable sources 32...63 address
+#define PSP_IRQ_DISABLE_1_A         (PSP_REGS_IRQ_BASE_ADDRESS | 0x0000001Cu)   // Disable sources 0...31 address
+#define PSP_IRQ_DISABLE_2_A         (PSP_REGS_IRQ_BASE_ADDRESS | 0x00000020u)   // Disable sources 32...63 address
+#define PSP_IRQ_DISABLE_BASIC_A     (PSP_REGS_IRQ_BASE_ADDRESS | 0x00000024u)   // Disable ARM local sources address
+
+// Interrupt Controller Register Pointers
+#define PSP_IRQ_PENDING_1_R         (*((volatile uint32_t *)PSP_IRQ_PENDING_1_A))       // Pending sources 0...31 register
+#define PSP_IRQ_PENDING_2_R         (*((volatile uint32_t *)PSP_IRQ_PENDING_2_A))       // Pending sources 32...63 register
+#define PSP_IRQ_FIQ_CONTROL_R       (*((volatile uint32_t *)PSP_IRQ_FIQ_CONTROL_A))     // FIQ control register
+#define PSP_IRQ_ENABLE_P            ((volatile uint32_t *)PSP_IRQ_ENABLE_1_A)           // Enable 1 and 2
+#define PSP_IRQ_DISABLE_P           ((volatile uint32_t *)PSP_IRQ_DISABLE_1_A)          // Disable 1 and 2
+#define PSP_IRQ_DISABLE_BASIC_R     (*((volatile uint32_t *)PSP_IRQ_DISABLE_BASIC_A))   // Disable ARM local sources register
+
+#endif
+
+#define IRQ_CPSR_I                  0x00000080u // CPSR IRQ mask bit
+#define IRQ_SCTLR_V                 0x00002000u // SCTLR high vectors (0xFFFF0000)
+
+#define IRQ_FRAME_LR                5u          // word offsets into the frame irq_entry saves
+#define IRQ_FRAME_RETURN            6u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_IRQ Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct IRQ_Latency_Type
+{
+    uint32_t expected_cycles;
+    uint32_t expecting;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint32_t longest_handler;
+    uint32_t buckets[PSP_IRQ_LATENCY_BUCKETS];
+} IRQ_Latency_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_IRQ Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static PSP_IRQ_Handler_t irq_handlers[PSP_IRQ_NUM_SOURCES];
+
+static IRQ_Latency_t irq_latency[PSP_IRQ_NUM_SOURCES];
+
+#if !defined(PSP_REGS_HAS_GIC_400)
+static uint32_t irq_enabled[2];     // what PSP_IRQ_Attach unmasked, the pending registers show the rest too
+#endif
+
+// the interrupt being handled, for PSP_IRQ_Get_Interrupted and PSP_IRQ_Get_Entry_Cycles
+static const uint32_t * irq_frame;
+static uint32_t irq_entry_cycles;
+
+static uint32_t irq_masked_start;
+static uint32_t irq_masked_caller;
+static uint32_t irq_longest_masked;
+static uint32_t irq_longest_masked_caller;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Exception Vectors and IRQ Entry
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * Only IRQs are handled, any other exception hangs where it can be found with a debugger.
+ *
+ * The IRQ entry runs on the SVC stack, so IRQ mode needs no stack of its own: srsdb puts the
+ * return address and the interrupted CPSR there, cps moves to SVC mode (IRQs stay masked), and
+ * rfeia returns through them at the end. The ARMv6 instructions are spelt out, as the default
+ * -march may not know them. The cycle counter is read straight after the first push, so every
+ * latency includes the same few instructions. IRQ_Dispatch gets it and the frame the entry
+ * built: r0-r3, r12 and the interrupted lr, then the return address and SPSR from srsdb.
+ */
+__asm__ (
+"    .pushsection .text.irq_vectors, \"ax\"             \n"
+"    .balign 32                                         \n"
+"irq_vectors:                                           \n"
+"    b       .                                          \n" // reset
+"    b       .                                          \n" // undefined instruction
+"    b       .                                          \n" // supervisor call
+"    b       .                                          \n" // prefetch abort
+"    b       .                                          \n" // data abort
+"    b       .                                          \n" // unused
+"    b       irq_entry                                  \n" // IRQ
+"    b       .                                          \n" // FIQ
+"                                                       \n"
+"irq_entry:                                             \n"
+"    sub     lr, lr, #4                                 \n"
+"    .word   0xF96D0513                                 \n" // srsdb sp!, #0x13
+"    .word   0xF1020013                                 \n" // cps #0x13
+"    push    {r0-r3, r12, lr}                           \n"
+#if defined(PSP_BOARD_PI1)
+"    mrc     p15, 0, r0, c15, c12, 1                    \n" // CCNT
+#else
+"    mrc     p15, 0, r0, c9, c13, 0                     \n" // PMCCNTR
+#endif
+"    mov     r1, sp                                     \n" // the saved registers, return address and SPSR
+"    and     r2, sp, #4                                 \n" // the AAPCS wants an 8 byte aligned stack
+"    sub     sp, sp, r2                                 \n"
+#if defined(__ARM_FP)
+"    vmrs    r3, fpscr                                  \n"
+"    push    {r2, r3}                                   \n"
+"    vpush   {d0-d7}                                    \n"
+#if defined(__ARM_NEON__)
+"    vpush   {d16-d31}                                  \n"
+#endif
+#else
+"    push    {r2, r3}                                   \n"
+#endif
+"    bl      IRQ_Dispatch                               \n"
+#if defined(__ARM_FP)
+#if defined(__ARM_NEON__)
+"    vpop    {d16-d31}                                  \n"
+#endif
+"    vpop    {d0-d7}                                    \n"
+"    pop     {r2, r3}                                   \n"
+"    vmsr    fpscr, r3                                  \n"
+#else
+"    pop     {r2, r3}                                   \n"
+#endif
+"    add     sp, sp, r2                                 \n"
+"    pop     {r0-r3, r12, lr}                           \n"
+"    .word   0xF8BD0A00                                 \n" // rfeia sp!
+"    .popsection                                        \n"
+);
+
+extern const uint32_t irq_vectors[];
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_IRQ Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * Histogram bucket for a latency: exact below 4 cycles, then 4 buckets per power of 2.
+ */
+static uint32_t IRQ_Bucket(uint32_t cycles)
+{
+    if (cycles < 4u)
+    {
+        return cycles;
+    }
+
+    const uint32_t MSB = 31u - (uint32_t)__builtin_clz(cycles);
+
+    return (4u * (MSB - 1u)) + ((cycles >> (MSB - 2u)) & 3u);
+}
+
+
+
+/**
+ * The largest latency that lands in a bucket.
+ */
+static uint32_t IRQ_Bucket_Top(uint32_t bucket)
+{
+    if (bucket < 4u)
+    {
+        return bucket;
+    }
+
+    const uint32_t SHIFT = (bucket / 4u) - 1u;
+    const uint32_t BOTTOM = (4u + (bucket % 4u)) << SHIFT;
+
+    return BOTTOM + ((1u << SHIFT) - 1u); // the top bucket's is 0xFFFFFFFF
+}
+
+
+
+static void IRQ_Handle(uint32_t source, uint32_t entry_cycles)
+{
+    IRQ_Latency_t * const P_LATENCY = &irq_latency[source];
+
+    if (P_LATENCY->expecting)
+    {
+        int32_t latency = (int32_t)(entry_cycles - P_LATENCY->expected_cycles);
+
+        if (latency < 0)
+        {
+            latency = 0; // within the error of working out when the event was due
+        }
+
+        P_LATENCY->buckets[IRQ_Bucket((uint32_t)latency)]++;
+        P_LATENCY->min = ((P_LATENCY->count == 0u) || ((uint32_t)latency < P_LATENCY->min)) ? (uint32_t)latency : P_LATENCY->min;
+        P_LATENCY->max = ((uint32_t)latency > P_LATENCY->max) ? (uint32_t)latency : P_LATENCY->max;
+        P_LATENCY->count++;
+        P_LATENCY->expecting = 0u;
+    }
+
+    if (irq_handlers[source] == 0)
+    {
+        PSP_IRQ_Detach(source); // nothing to clear it, it would fire forever
+        return;
+    }
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_IRQ_Handler, source);
+
+    const uint32_t START_CYCLES = PSP_Time_Get_Cycles();
+
+    irq_handlers[source]();
+
+    const uint32_t HANDLER_CYCLES = PSP_Time_Get_Cycles() - START_CYCLES;
+
+    PSP_TRACE_END(PSP_Trace_Event_IRQ_Handler, source);
+
+    if (HANDLER_CYCLES > P_LATENCY->longest_handler)
+    {
+        P_LATENCY->longest_handler = HANDLER_CYCLES;
+    }
+}
+
+
+
+/**
+ * Called from irq_entry with the cycle counter as it was on entry, and the saved registers.
+ */
+__attribute__((used, hot)) static void IRQ_Dispatch(uint32_t entry_cycles, const uint32_t * p_frame)
+{
+    irq_frame = p_frame;
+    irq_entry_cycles = entry_cycles;
+
+#if defined(PSP_REGS_HAS_GIC_400)
+    const uint32_t IAR = PSP_IRQ_GICC_IAR_R;
+    const uint32_t INTID = IAR & IRQ_GIC_INTID_MASK;
+
+    if (INTID == IRQ_GIC_SPURIOUS)
+    {
+        return;
+    }
+
+    if ((INTID >= IRQ_GIC_FIRST_SOURCE) && (INTID < (IRQ_GIC_FIRST_SOURCE + PSP_IRQ_NUM_SOURCES)))
+    {
+        IRQ_Handle(INTID - IRQ_GIC_FIRST_SOURCE, entry_cycles);
+    }
+
+    PSP_IRQ_GICC_EOIR_R = IAR;
+#else
+    uint32_t pending[2];
+
+    pending[0] = PSP_IRQ_PENDING_1_R & irq_enabled[0];
+    pending[1] = PSP_IRQ_PENDING_2_R & irq_enabled[1];
+
+    for (uint32_t bank = 0u; bank < 2u; bank++)
+    {
+        while (pending[bank] != 0u)
+        {
+            const uint32_t BIT = (uint32_t)__builtin_ctz(pending[bank]);
+
+            pending[bank] &= pending[bank] - 1u;
+
+            IRQ_Handle((32u * bank) + BIT, entry_cycles);
+        }
+    }
+#endif
+}
+
+
+
+void PSP_IRQ_Init(void)
+{
+    uint32_t cpsr;
+
+    __asm__ volatile ("mrs %0, cpsr" : "=r" (cpsr));
+    __asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr | IRQ_CPSR_I) : "memory");
+
+#if defined(PSP_REGS_HAS_GIC_400)
+    PSP_IRQ_GICD_CTLR_R = 0u;
+
+    for (uint32_t i = 0u; i < (IRQ_GIC_NUM_INTERRUPTS / 32u); i++)
+    {
+        PSP_IRQ_GICD_ICENABLER_P[i] = 0xFFFFFFFFu;
+        PSP_IRQ_GICD_ICPENDR_P[i] = 0xFFFFFFFFu;
+    }
+
+    for (uint32_t intid = IRQ_GIC_FIRST_SOURCE; intid < (IRQ_GIC_FIRST_SOURCE + PSP_IRQ_NUM_SOURCES); intid++)
+    {
+        PSP_IRQ_GICD_IPRIORITYR_P[intid] = IRQ_GIC_PRIORITY;
+        PSP_IRQ_GICD_ITARGETSR_P[intid] = IRQ_GIC_TARGET_CPU_0;
+    }
+
+    PSP_IRQ_GICD_CTLR_R = IRQ_GIC_ENABLE;
+    PSP_IRQ_GICC_PMR_R = IRQ_GIC_PRIORITY_MASK;
+    PSP_IRQ_GICC_CTLR_R = IRQ_GIC_ENABLE;
+#else
+    PSP_IRQ_FIQ_CONTROL_R = 0u;
+    PSP_IRQ_DISABLE_P[0] = 0xFFFFFFFFu;
+    PSP_IRQ_DISABLE_P[1] = 0xFFFFFFFFu;
+    PSP_IRQ_DISABLE_BASIC_R = 0xFFFFFFFFu;
+    irq_enabled[0] = 0u;
+    irq_enabled[1] = 0u;
+#endif
+
+    memset(irq_handlers, 0, sizeof(irq_handlers));
+    memset(irq_latency, 0, sizeof(irq_latency));
+    irq_longest_masked = 0u;
+    irq_longest_masked_caller = 0u;
+
+    if (PSP_Time_Get_Cycles_Per_Millisecond() == 0u)
+    {
+        PSP_Time_Calibrate_Delay();
+    }
+    else
+    {
+        PSP_Time_Enable_Cycle_Counter();
+    }
+
+    // low vectors, moved to irq_vectors
+    uint32_t sctlr;
+
+    __asm__ volatile ("mrc p15, 0, %0, c1, c0, 0" : "=r" (sctlr));
+    __asm__ volatile ("mcr p15, 0, %0, c1, c0, 0" : : "r" (sctlr & ~IRQ_SCTLR_V));
+    __asm__ volatile ("mcr p15, 0, %0, c12, c0, 0" : : "r" (irq_vectors) : "memory");
+
+    __asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr & ~IRQ_CPSR_I) : "memory");
+}
+
+
+
+uint32_t PSP_IRQ_Attach(uint32_t source, PSP_IRQ_Handler_t handler)
+{
+    if (source >= PSP_IRQ_NUM_SOURCES)
+    {
+        return 0u;
+    }
+
+    irq_handlers[source] = handler;
+
+    // the handler must be in place before the source can fire
+    __asm__ volatile ("" : : : "memory");
+
+#if defined(PSP_REGS_HAS_GIC_400)
+    PSP_IRQ_GICD_ISENABLER_P[(IRQ_GIC_FIRST_SOURCE + source) / 32u] = 1u << (source % 32u);
+#else
+    irq_enabled[source / 32u] |= 1u << (source % 32u);
+    PSP_IRQ_ENABLE_P[source / 32u] = 1u << (source % 32u);
+#endif
+
+    return 1u;
+}
+
+
+
+void PSP_IRQ_Detach(uint32_t source)
+{
+    if (source >= PSP_IRQ_NUM_SOURCES)
+    {
+        return;
+    }
+
+#if defined(PSP_REGS_HAS_GIC_400)
+    PSP_IRQ_GICD_ICENABLER_P[(IRQ_GIC_FIRST_SOURCE + source) / 32u] = 1u << (source % 32u);
+#else
+    PSP_IRQ_DISABLE_P[source / 32u] = 1u << (source % 32u);
+    irq_enabled[source / 32u] &= ~(1u << (source % 32u));
+#endif
+
+    __asm__ volatile ("" : : : "memory");
+
+    irq_handlers[source] = 0;
+}
+
+
+
+uint32_t PSP_IRQ_Disable(void)
+{
+    uint32_t cpsr;
+
+    __asm__ volatile ("mrs %0, cpsr" : "=r" (cpsr));
+    __asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr | IRQ_CPSR_I) : "memory");
+
+    if (!(cpsr & IRQ_CPSR_I))
+    {
+        irq_masked_caller = (uint32_t)__builtin_return_address(0);
+        irq_masked_start = PSP_Time_Get_Cycles();
+    }
+
+    return cpsr & IRQ_CPSR_I;
+}
+
+
+
+void PSP_IRQ_Restore(uint32_t state)
+{
+    if (state & IRQ_CPSR_I)
+    {
+        return; // nested, the outermost section is still going
+    }
+
+    const uint32_t MASKED_CYCLES = PSP_Time_Get_Cycles() - irq_masked_start;
+
+    if (MASKED_CYCLES > irq_longest_masked)
+    {
+        irq_longest_masked = MASKED_CYCLES;
+        irq_longest_masked_caller = irq_masked_caller;
+    }
+
+    uint32_t cpsr;
+
+    __asm__ volatile ("mrs %0, cpsr" : "=r" (cpsr));
+    __asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr & ~IRQ_CPSR_I) : "memory");
+}
+
+
+
+void PSP_IRQ_Expect(uint32_t source, uint32_t event_cycles)
+{
+    if (source < PSP_IRQ_NUM_SOURCES)
+    {
+        irq_latency[source].expected_cycles = event_cycles;
+
+        __asm__ volatile ("" : : : "memory");
+
+        irq_latency[source].expecting = 1u;
+    }
+}
+
+
+
+void PSP_IRQ_Get_Latency_Report(uint32_t source, PSP_IRQ_Latency_Report_t * p_report)
+{
+    static const uint32_t PERMILLES[4] = { 500u, 900u, 990u, 999u };
+
+    uint32_t * const P_PERCENTILES[4] = { &p_report->p50, &p_report->p90, &p_report->p99, &p_report->p999 };
+
+    memset(p_report, 0, sizeof(*p_report));
+
+    if (source >= PSP_IRQ_NUM_SOURCES)
+    {
+        return;
+    }
+
+    static IRQ_Latency_t latency;
+
+    // a copy, so the walk through it isn't disturbed by interrupts landing meanwhile
+    const uint32_t STATE = PSP_IRQ_Disable();
+    latency = irq_latency[source];
+    PSP_IRQ_Restore(STATE);
+
+    p_report->count = latency.count;
+    p_report->min = latency.min;
+    p_report->max = latency.max;
+    p_report->longest_handler = latency.longest_handler;
+
+    if (latency.count == 0u)
+    {
+        return;
+    }
+
+    uint32_t bucket = 0u;
+    uint32_t cumulative = latency.buckets[0];
+
+    for (uint32_t i = 0u; i < 4u; i++)
+    {
+        // the smallest count that reaches the percentile, rounded up
+        const uint32_t RANK = (uint32_t)((((uint64_t)latency.count * PERMILLES[i]) + 999u) / 1000u);
+
+        while ((cumulative < RANK) && (bucket < (PSP_IRQ_LATENCY_BUCKETS - 1u)))
+        {
+            bucket++;
+            cumulative += latency.buckets[bucket];
+        }
+
+        const uint32_t TOP = IRQ_Bucket_Top(bucket);
+
+        *P_PERCENTILES[i] = (TOP > latency.max) ? latency.max : TOP;
+    }
+}
+
+
+
+/**
+ * "<label>: <cycles> cycles (<nSec> ns)"
+ */
+static void IRQ_Print_Cycles(char * p_label, uint32_t cycles)
+{
+    const uint32_t CYCLES_PER_MS = PSP_Time_Get_Cycles_Per_Millisecond();
+
+    PSP_AUX_Mini_Uart_Send_String(p_label);
+    PSP_AUX_Mini_Uart_Send_String(": ");
+    PSP_AUX_Mini_Uart_Send_Decimal(cycles);
+    PSP_AUX_Mini_Uart_Send_String(" cycles (");
+    PSP_AUX_Mini_Uart_Send_Decimal((CYCLES_PER_MS == 0u) ? 0u : (uint32_t)(((uint64_t)cycles * 1000000u) / CYCLES_PER_MS));
+    PSP_AUX_Mini_Uart_Send_String(" ns)\r\n");
+}
+
+
+
+void PSP_IRQ_Print_Latency_Report(uint32_t source, char * p_name)
+{
+    PSP_IRQ_Latency_Report_t report;
+
+    PSP_IRQ_Get_Latency_Report(source, &report);
+
+    PSP_AUX_Mini_Uart_Send_String(p_name);
+    PSP_AUX_Mini_Uart_Send_String(" IRQ latency over ");
+    PSP_AUX_Mini_Uart_Send_Decimal(report.count);
+    PSP_AUX_Mini_Uart_Send_String(" interrupts\r\n");
+
+    IRQ_Print_Cycles("    min", report.min);
+    IRQ_Print_Cycles("    50%", report.p50);
+    IRQ_Print_Cycles("    90%", report.p90);
+    IRQ_Print_Cycles("    99%", report.p99);
+    IRQ_Print_Cycles("    99.9%", report.p999);
+    IRQ_Print_Cycles("    max", report.max);
+    IRQ_Print_Cycles("    jitter (max - min)", report.max - report.min);
+    IRQ_Print_Cycles("    longest handler", report.longest_handler);
+
+    if (source < PSP_IRQ_NUM_SOURCES)
+    {
+        PSP_AUX_Mini_Uart_Send_String("    histogram, up to cycles: interrupts\r\n");
+
+        for (uint32_t bucket = 0u; bucket < PSP_IRQ_LATENCY_BUCKETS; bucket++)
+        {
+            const uint32_t COUNT = irq_latency[source].buckets[bucket];
+
+            if (COUNT != 0u)
+            {
+                PSP_AUX_Mini_Uart_Send_String("        ");
+                PSP_AUX_Mini_Uart_Send_Decimal(IRQ_Bucket_Top(bucket));
+                PSP_AUX_Mini_Uart_Send_String(": ");
+                PSP_AUX_Mini_Uart_Send_Decimal(COUNT);
+                PSP_AUX_Mini_Uart_Send_String("\r\n");
+            }
+        }
+    }
+
+    uint32_t caller = 0u;
+
+    IRQ_Print_Cycles("longest IRQs masked", PSP_IRQ_Get_Longest_Masked(&caller));
+    PSP_AUX_Mini_Uart_Send_String("    from ");
+    PSP_AUX_Mini_Uart_Send_Hex(caller);
+    PSP_AUX_Mini_Uart_Send_String("\r\n");
+}
+
+
+
+void PSP_IRQ_Reset_Latency(uint32_t source)
+{
+    const uint32_t STATE = PSP_IRQ_Disable();
+
+    if (source < PSP_IRQ_NUM_SOURCES)
+    {
+        memset(&irq_latency[source], 0, sizeof(irq_latency[source]));
+    }
+
+    irq_longest_masked = 0u;
+    irq_longest_masked_caller = 0u;
+
+    PSP_IRQ_Restore(STATE);
+}
+
+
+
+uint32_t PSP_IRQ_Get_Interrupted(uint32_t * p_lr)
+{
+    if (p_lr)
+    {
+        *p_lr = irq_frame[IRQ_FRAME_LR];
+    }
+
+    return irq_frame[IRQ_FRAME_RETURN];
+}
+
+
+
+uint32_t PSP_IRQ_Get_Entry_Cycles(void)
+{
+    return irq_entry_cycles;
+}
+
+
+
+uint32_t PSP_IRQ_Get_Longest_Masked(uint32_t * p_address)
+{
+    if (p_address)
+    {
+        *p_address = irq_longest_masked_caller;
+    }
+
+    return irq_longest_masked;
+}
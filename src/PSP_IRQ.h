@@ -0,0 +1,373 @@
+/**
+ * DESCRIPTION:
+ *      PSP_IRQ sets up interrupts: the exception vectors, the interrupt controller and a
+ *      handler per peripheral interrupt. It also measures them: how long after the event each
+ *      interrupt is taken (latency and jitter, as histograms per source), how long handlers
+ *      run and the longest stretch with interrupts masked.
+ *
+ * NOTES:
+ *      Sources are the VideoCore peripheral interrupt numbers 0...63 (PSP_IRQ_SOURCE_*). On the
+ *      Pi 1 to 3 they go through the legacy ARM interrupt controller, on the Pi 4 through the
+ *      GIC-400, where source n is shared peripheral interrupt 96 + n. Handlers run in SVC mode on
+ *      the main stack with interrupts masked, one at a time, and must clear their peripheral's
+ *      interrupt flag before returning or it fires again straight away.
+ *
+ *      The IRQ entry saves r0-r3, r12 and lr, which is all the AAPCS lets C code clobber. In
+ *      NEON=1 builds GCC may use d0-d7 and d16-d31 (and FPSCR) in any function too, so those are
+ *      saved as well, otherwise an interrupt landing in a vector loop would corrupt it. Plain
+ *      builds never touch the VFP registers, so they don't pay for the save.
+ *
+ *      Latency: whoever sets up an event says when it is due on the cycle counter with
+ *      PSP_IRQ_Expect (for System Timer compares, PSP_Time_Set_Compare_Synced works it out). The
+ *      entry code reads the cycle counter as its first few instructions, and the difference is
+ *      added to that source's histogram. The histograms are log-linear, 4 buckets per power of
+ *      2, so percentiles come out within 25% at any scale, with the exact min and max kept
+ *      alongside. What is measured is the interrupt controller, the pipeline and the entry code
+ *      up to the cycle counter read, plus whatever had interrupts masked at the time.
+ *
+ *      Critical sections: PSP_IRQ_Disable and PSP_IRQ_Restore mask and unmask interrupts around
+ *      code that mustn't be interrupted, and nest. The outermost pair is timed, and the longest
+ *      is kept with the address it was called from, so the worst offender can be looked up in
+ *      the map file. That is the floor under worst case latency.
+ *
+ *      The firmware starts ARMv7 cores in HYP mode, where IRQs can't be taken in the usual way,
+ *      so start.s drops to SVC mode first.
+ *
+ * REFERENCES:
+ *      BCM2835-ARM-Peripherals.pdf section 7, Interrupts
+ *      ARM Generic Interrupt Controller Architecture Specification v2
+ *      ARM Architecture Reference Manual ARMv7-A, B1.8 (exception handling)
+ */
+
+#ifndef PSP_IRQ_H_INCLUDED
+#define PSP_IRQ_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_IRQ Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_IRQ_NUM_SOURCES             64u
+
+// VideoCore peripheral interrupt numbers
+#define PSP_IRQ_SOURCE_SYSTEM_TIMER_1   1u
+#define PSP_IRQ_SOURCE_SYSTEM_TIMER_3   3u
+#define PSP_IRQ_SOURCE_DMA(channel)     (16u + (channel))   // channels 0...12
+#define PSP_IRQ_SOURCE_AUX              29u                 // mini uart and the aux SPIs
+#define PSP_IRQ_SOURCE_BSC_SLAVE        43u
+#define PSP_IRQ_SOURCE_GPIO_BANK_0      49u
+#define PSP_IRQ_SOURCE_GPIO_BANK_1      50u
+#define PSP_IRQ_SOURCE_I2C              53u                 // every BSC master
+#define PSP_IRQ_SOURCE_SPI              54u
+#define PSP_IRQ_SOURCE_PCM              55u
+#define PSP_IRQ_SOURCE_UART             57u
+#define PSP_IRQ_SOURCE_EMMC             62u
+
+#define PSP_IRQ_LATENCY_BUCKETS         124u                // 0...3 cycles, then 4 per power of 2 up to 2^32
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_IRQ Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef void (*PSP_IRQ_Handler_t)(void);
+
+
+
+// every figure in cycles, see PSP_Time_Get_Cycles_Per_Millisecond
+typedef struct IRQ_Latency_Report_Type
+{
+    uint32_t count;             // interrupts measured
+    uint32_t min;
+    uint32_t max;
+    uint32_t p50;               // percentiles, the top of the histogram bucket they fall in
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t p999;
+    uint32_t longest_handler;   // longest the handler itself has run
+} PSP_IRQ_Latency_Report_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_IRQ Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Init
+
+Function Description:
+    Point the exception vectors at this module, mask every source at the interrupt controller,
+    clear the statistics and unmask IRQs at the CPU. Starts the cycle counter if need be.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_IRQ_Init(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Attach
+
+Function Description:
+    Set the handler for a source and unmask it at the interrupt controller. The peripheral
+    still has to be told to raise the interrupt.
+
+Inputs:
+    source: PSP_IRQ_SOURCE_*
+    handler: called for every interrupt from the source
+
+Returns:
+    uint32_t: 1 on success, 0 for a source that doesn't exist
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_IRQ_Attach(uint32_t source, PSP_IRQ_Handler_t handler);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Detach
+
+Function Description:
+    Mask a source at the interrupt controller and forget its handler.
+
+Inputs:
+    source: PSP_IRQ_SOURCE_*
+
+Returns:
+    None
+
+Error Handling:
+    Sources that don't exist are ignored.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_IRQ_Detach(uint32_t source);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Disable
+
+Function Description:
+    Mask IRQs at the CPU, for a critical section. If they were unmasked, the critical
+    section's timing starts here.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: the previous state, for PSP_IRQ_Restore
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_IRQ_Disable(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Restore
+
+Function Description:
+    End a critical section: put IRQ masking back as PSP_IRQ_Disable found it. For the
+    outermost section this unmasks them and records how long they were masked.
+
+Inputs:
+    state: what PSP_IRQ_Disable returned
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_IRQ_Restore(uint32_t state);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Expect
+
+Function Description:
+    Say when the next interrupt from a source is due, so its latency can be measured.
+
+Inputs:
+    source: PSP_IRQ_SOURCE_*
+    event_cycles: the cycle counter value at the event, e.g. from PSP_Time_Set_Compare_Synced
+
+Returns:
+    None
+
+Error Handling:
+    Interrupts with nothing expected aren't measured, but their handler time still is.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_IRQ_Expect(uint32_t source, uint32_t event_cycles);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Get_Latency_Report
+
+Function Description:
+    Summarize a source's latency histogram.
+
+Inputs:
+    source: PSP_IRQ_SOURCE_*
+    p_report: where to put the summary
+
+Returns:
+    None
+
+Error Handling:
+    All zeros for a source with nothing measured.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_IRQ_Get_Latency_Report(uint32_t source, PSP_IRQ_Latency_Report_t * p_report);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Print_Latency_Report
+
+Function Description:
+    Send a source's latency summary and the non-empty histogram buckets over the mini uart,
+    in cycles and nS, along with the longest critical section. The mini uart must be set up.
+
+Inputs:
+    source: PSP_IRQ_SOURCE_*
+    p_name: what to call the source
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_IRQ_Print_Latency_Report(uint32_t source, char * p_name);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Reset_Latency
+
+Function Description:
+    Clear a source's histogram, min/max and handler time, and the longest critical section.
+
+Inputs:
+    source: PSP_IRQ_SOURCE_*
+
+Returns:
+    None
+
+Error Handling:
+    Sources that don't exist are ignored, the critical section is cleared anyway.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_IRQ_Reset_Latency(uint32_t source);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Get_Interrupted
+
+Function Description:
+    From inside a handler: where the interrupt struck, the address the interrupted code will
+    carry on from and its lr. The lr is the return address of the interrupted function only
+    if that is a leaf, or hasn't reused lr yet, see BSP_Profiler.
+
+Inputs:
+    p_lr: where to put the interrupted lr, or 0
+
+Returns:
+    uint32_t: the interrupted pc
+
+Error Handling:
+    Only meaningful while a handler runs.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_IRQ_Get_Interrupted(uint32_t * p_lr);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Get_Entry_Cycles
+
+Function Description:
+    From inside a handler: the cycle counter when the IRQ entry started, so a handler can
+    measure the whole cost of its interrupt.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: see PSP_Time_Get_Cycles
+
+Error Handling:
+    Only meaningful while a handler runs.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_IRQ_Get_Entry_Cycles(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_IRQ_Get_Longest_Masked
+
+Function Description:
+    Get the longest critical section since PSP_IRQ_Init or PSP_IRQ_Reset_Latency.
+
+Inputs:
+    p_address: where to put the address PSP_IRQ_Disable was called from, or 0
+
+Returns:
+    uint32_t: how long interrupts were masked, in cycles
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_IRQ_Get_Longest_Masked(uint32_t * p_address);
+
+#endif
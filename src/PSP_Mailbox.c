@@ -0,0 +1,129 @@
+
+#include "PSP_Mailbox.h"
+#include "PSP_REGS.h"
+#include "PSP_Trace.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Mailbox Defines
+ -------------------------------------------------------------------------------------------------*/
+
+// Mailbox Register Addresses, mailbox 0 is GPU to ARM and mailbox 1 is ARM to GPU
+#define PSP_MAILBOX_BASE_A      (PSP_REGS_MAILBOX_BASE_ADDRESS)
+#define PSP_MAILBOX_READ_A      (PSP_MAILBOX_BASE_A | 0x00000000u)            // Mailbox 0 Read address
+#define PSP_MAILBOX_STATUS_A    (PSP_MAILBOX_BASE_A | 0x00000018u)            // Mailbox 0 Status address
+#define PSP_MAILBOX_WRITE_A     (PSP_MAILBOX_BASE_A | 0x00000020u)            // Mailbox 1 Write address
+#define PSP_MAILBOX_1_STATUS_A  (PSP_MAILBOX_BASE_A | 0x00000038u)            // Mailbox 1 Status address
+
+// Mailbox Register Pointers
+#define PSP_MAILBOX_READ_R      (*((volatile uint32_t *)PSP_MAILBOX_READ_A))     // Mailbox 0 Read register
+#define PSP_MAILBOX_STATUS_R    (*((volatile uint32_t *)PSP_MAILBOX_STATUS_A))   // Mailbox 0 Status register
+#define PSP_MAILBOX_WRITE_R     (*((volatile uint32_t *)PSP_MAILBOX_WRITE_A))    // Mailbox 1 Write register
+#define PSP_MAILBOX_1_STATUS_R  (*((volatile uint32_t *)PSP_MAILBOX_1_STATUS_A)) // Mailbox 1 Status register
+
+// Mailbox Status Register Masks
+#define MAILBOX_STATUS_FULL     0x80000000u // No room to write
+#define MAILBOX_STATUS_EMPTY    0x40000000u // Nothing to read
+
+#define MAILBOX_CHANNEL_MASK    0x0000000Fu // the low 4 bits of a mailbox word are the channel
+#define MAILBOX_CHANNEL_PROPERTY 8u         // ARM to VideoCore property channel
+
+#define MAILBOX_TAG_REQUEST     0x00000000u // tag request code
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Mailbox Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// message buffer for the helper functions
+static volatile uint32_t mailbox_message[8] __attribute__((aligned(16)));
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_Mailbox Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+uint32_t PSP_Mailbox_Property_Call(volatile uint32_t * p_message)
+{
+    const uint32_t MESSAGE_ADDRESS = (uint32_t)p_message;
+
+    if (MESSAGE_ADDRESS & MAILBOX_CHANNEL_MASK)
+    {
+        return 0u; // the low 4 bits are needed for the channel
+    }
+
+    const uint32_t MAILBOX_WORD = PSP_REGS_RAM_TO_BUS(MESSAGE_ADDRESS) | MAILBOX_CHANNEL_PROPERTY;
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_Mailbox_Call, p_message[2]);
+
+    while (PSP_MAILBOX_1_STATUS_R & MAILBOX_STATUS_FULL)
+    {
+        // wait for room to write
+    }
+
+    PSP_MAILBOX_WRITE_R = MAILBOX_WORD;
+
+    // other channels may answer too, wait for the answer to this message
+    while (1)
+    {
+        while (PSP_MAILBOX_STATUS_R & MAILBOX_STATUS_EMPTY)
+        {
+            // wait for an answer
+        }
+
+        if (PSP_MAILBOX_READ_R == MAILBOX_WORD)
+        {
+            const uint32_t SUCCESS = (p_message[1] == PSP_MAILBOX_RESPONSE_SUCCESS) ? 1u : 0u;
+
+            PSP_TRACE_END(PSP_Trace_Event_Mailbox_Call, SUCCESS);
+
+            return SUCCESS;
+        }
+    }
+}
+
+
+
+uint32_t PSP_Mailbox_Get_Clock_Rate(PSP_Mailbox_Clock_t clock)
+{
+    mailbox_message[0] = 8u * sizeof(uint32_t);
+    mailbox_message[1] = PSP_MAILBOX_REQUEST;
+    mailbox_message[2] = PSP_MAILBOX_TAG_GET_CLOCK_RATE;
+    mailbox_message[3] = 2u * sizeof(uint32_t);  // clock id in, clock id and rate out
+    mailbox_message[4] = MAILBOX_TAG_REQUEST;
+    mailbox_message[5] = clock;
+    mailbox_message[6] = 0u;
+    mailbox_message[7] = PSP_MAILBOX_TAG_END;
+
+    if (!PSP_Mailbox_Property_Call(mailbox_message))
+    {
+        return 0u;
+    }
+
+    return mailbox_message[6];
+}
+
+
+
+uint32_t PSP_Mailbox_Get_ARM_Memory(uint32_t * p_base_address, uint32_t * p_size)
+{
+    mailbox_message[0] = 8u * sizeof(uint32_t);
+    mailbox_message[1] = PSP_MAILBOX_REQUEST;
+    mailbox_message[2] = PSP_MAILBOX_TAG_GET_ARM_MEMORY;
+    mailbox_message[3] = 2u * sizeof(uint32_t);  // nothing in, base address and size out
+    mailbox_message[4] = MAILBOX_TAG_REQUEST;
+    mailbox_message[5] = 0u;
+    mailbox_message[6] = 0u;
+    mailbox_message[7] = PSP_MAILBOX_TAG_END;
+
+    if (!PSP_Mailbox_Property_Call(mailbox_message))
+    {
+        return 0u;
+    }
+
+    *p_base_address = mailbox_message[5];
+    *p_size = mailbox_message[6];
+
+    return 1u;
+}
@@ -0,0 +1,148 @@
+/**
+ * DESCRIPTION:
+ *      PSP_Mailbox provides an interface for the VideoCore mailbox property channel, the way
+ *      the ARM asks the GPU firmware about (and changes) things the firmware owns: clock
+ *      rates, how RAM is split between the ARM and the GPU, the framebuffer, and so on.
+ *
+ * NOTES:
+ *      A property call is a message buffer of tags, each tag is
+ *          { tag id, value buffer size in bytes, request/response code, value buffer... }
+ *      and the whole message is
+ *          { message size in bytes, request code (0), tags..., end tag (0) }
+ *
+ *      The firmware writes its answers back into the same buffer. The buffer must be 16 byte
+ *      aligned and it is handed to the GPU as a bus address, like a DMA buffer.
+ *
+ *      The helpers here (PSP_Mailbox_Get_Clock_Rate etc.) build their own messages, use
+ *      PSP_Mailbox_Property_Call directly for anything else.
+ *
+ * REFERENCES:
+ *      https://github.com/raspberrypi/firmware/wiki/Mailbox-property-interface
+ *      https://github.com/raspberrypi/firmware/wiki/Accessing-mailboxes
+ */
+
+#ifndef PSP_MAILBOX_H_INCLUDED
+#define PSP_MAILBOX_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Mailbox Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_MAILBOX_REQUEST             0x00000000u  // message code for a request
+#define PSP_MAILBOX_RESPONSE_SUCCESS    0x80000000u  // message code the firmware answers with on success
+#define PSP_MAILBOX_TAG_END             0x00000000u  // ends the list of tags
+
+// Property Tags
+#define PSP_MAILBOX_TAG_GET_ARM_MEMORY  0x00010005u  // base address and size of the ARM's share of RAM
+#define PSP_MAILBOX_TAG_GET_CLOCK_RATE  0x00030002u  // clock rate in Hz of a PSP_Mailbox_Clock_t
+
+// Framebuffer Property Tags
+#define PSP_MAILBOX_TAG_ALLOCATE_BUFFER     0x00040001u  // alignment in, bus address and size of the framebuffer out
+#define PSP_MAILBOX_TAG_GET_PITCH           0x00040008u  // bytes per framebuffer line
+#define PSP_MAILBOX_TAG_SET_PHYSICAL_SIZE   0x00048003u  // width and height of the display in pixels
+#define PSP_MAILBOX_TAG_SET_VIRTUAL_SIZE    0x00048004u  // width and height of the framebuffer in pixels
+#define PSP_MAILBOX_TAG_SET_DEPTH           0x00048005u  // bits per pixel
+#define PSP_MAILBOX_TAG_SET_PIXEL_ORDER     0x00048006u  // 0 is BGR, 1 is RGB
+#define PSP_MAILBOX_TAG_SET_ALPHA_MODE      0x00048007u  // 0 alpha enabled, 1 reversed, 2 ignored
+#define PSP_MAILBOX_TAG_SET_VIRTUAL_OFFSET  0x00048009u  // x and y of the framebuffer pixel shown top left
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Mailbox Types
+ -------------------------------------------------------------------------------------------------*/
+
+// clock ids for PSP_MAILBOX_TAG_GET_CLOCK_RATE
+typedef enum Mailbox_Clock_Type
+{
+    PSP_Mailbox_Clock_EMMC  = 1u,
+    PSP_Mailbox_Clock_UART  = 2u,
+    PSP_Mailbox_Clock_ARM   = 3u,
+    PSP_Mailbox_Clock_CORE  = 4u,
+    PSP_Mailbox_Clock_V3D   = 5u,
+    PSP_Mailbox_Clock_H264  = 6u,
+    PSP_Mailbox_Clock_ISP   = 7u,
+    PSP_Mailbox_Clock_SDRAM = 8u,
+    PSP_Mailbox_Clock_PIXEL = 9u,
+    PSP_Mailbox_Clock_PWM   = 10u,
+    PSP_Mailbox_Clock_HEVC  = 11u,
+    PSP_Mailbox_Clock_EMMC2 = 12u   // Pi 4 only
+} PSP_Mailbox_Clock_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Mailbox Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Mailbox_Property_Call
+
+Function Description:
+    Send a property message to the firmware and wait for the answer, which is written back
+    into the message.
+
+Inputs:
+    p_message: the message, laid out as described at the top of this file, 16 byte aligned
+
+Returns:
+    uint32_t: 1 if the firmware answered with PSP_MAILBOX_RESPONSE_SUCCESS, 0 otherwise
+
+Error Handling:
+    Returns 0 without sending anything if p_message isn't 16 byte aligned. Individual tags
+    can still fail on a successful call, their response codes have bit 31 set when answered.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Mailbox_Property_Call(volatile uint32_t * p_message);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Mailbox_Get_Clock_Rate
+
+Function Description:
+    Ask the firmware for the current rate of one of its clocks.
+
+Inputs:
+    clock: the clock to ask about
+
+Returns:
+    uint32_t: the clock rate in Hz
+
+Error Handling:
+    Returns 0 if the call fails or the clock doesn't exist on this board.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Mailbox_Get_Clock_Rate(PSP_Mailbox_Clock_t clock);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Mailbox_Get_ARM_Memory
+
+Function Description:
+    Ask the firmware which part of RAM belongs to the ARM, the rest is the GPU's.
+
+Inputs:
+    p_base_address: where to put the ARM physical address the ARM's RAM starts at
+    p_size: where to put the size of the ARM's RAM in bytes
+
+Returns:
+    uint32_t: 1 on success, 0 if the call fails
+
+Error Handling:
+    *p_base_address and *p_size are left alone if the call fails.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Mailbox_Get_ARM_Memory(uint32_t * p_base_address, uint32_t * p_size);
+
+#endif
@@ -0,0 +1,292 @@
+#include "PSP_Memory.h"
+#include "PSP_Mailbox.h"
+#include "PSP_IRQ.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Memory Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define MEMORY_ALIGN_UP(value, alignment)   (((value) + ((alignment) - 1u)) & ~((alignment) - 1u))
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Memory Variables
+ -------------------------------------------------------------------------------------------------*/
+
+extern uint8_t _end[]; // from linker.ld, the end of .bss
+
+static uint32_t memory_base;
+static uint32_t memory_size;
+static uint32_t memory_used;
+static uint32_t memory_num_failed;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_Memory Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * The alignment to use, 0 if it isn't a power of 2.
+ */
+static uint32_t Memory_Alignment(uint32_t alignment)
+{
+    if (alignment == 0u)
+    {
+        return PSP_MEMORY_DEFAULT_ALIGNMENT;
+    }
+
+    return (alignment & (alignment - 1u)) ? 0u : alignment;
+}
+
+
+
+uint32_t PSP_Memory_Init(void)
+{
+    uint32_t arm_base;
+    uint32_t arm_size;
+
+    memory_base = MEMORY_ALIGN_UP((uint32_t)_end, PSP_MEMORY_DMA_ALIGNMENT);
+    memory_size = 0u;
+    memory_used = 0u;
+    memory_num_failed = 0u;
+
+    if (!PSP_Mailbox_Get_ARM_Memory(&arm_base, &arm_size))
+    {
+        return 0u;
+    }
+
+    const uint32_t TOP = arm_base + arm_size;
+
+    if (TOP > memory_base)
+    {
+        memory_size = TOP - memory_base;
+    }
+
+    return memory_size;
+}
+
+
+
+void * PSP_Memory_Alloc(uint32_t num_bytes, uint32_t alignment)
+{
+    const uint32_t ALIGNMENT = Memory_Alignment(alignment);
+
+    if (ALIGNMENT != 0u)
+    {
+        const uint32_t START = MEMORY_ALIGN_UP(memory_base + memory_used, ALIGNMENT) - memory_base;
+
+        // written so that neither side can wrap
+        if ((START <= memory_size) && (num_bytes <= (memory_size - START)))
+        {
+            memory_used = START + num_bytes;
+
+            return (void *)(memory_base + START);
+        }
+    }
+
+    memory_num_failed++;
+
+    return 0;
+}
+
+
+
+void * PSP_Memory_Alloc_DMA(uint32_t num_bytes)
+{
+    const uint32_t SIZE = MEMORY_ALIGN_UP(num_bytes, PSP_MEMORY_DMA_ALIGNMENT);
+
+    if (SIZE < num_bytes)
+    {
+        memory_num_failed++;
+
+        return 0;
+    }
+
+    void * const P_REGION = PSP_Memory_Alloc(SIZE, PSP_MEMORY_DMA_ALIGNMENT);
+
+    if (P_REGION != 0)
+    {
+        memset(P_REGION, 0, SIZE);
+    }
+
+    return P_REGION;
+}
+
+
+
+void PSP_Memory_Get_Stats(PSP_Memory_Stats_t * p_stats)
+{
+    p_stats->base_address = memory_base;
+    p_stats->size = memory_size;
+    p_stats->used = memory_used;
+    p_stats->num_failed = memory_num_failed;
+}
+
+
+
+uint32_t PSP_Memory_Arena_Create(PSP_Memory_Arena_t * p_arena, uint32_t size)
+{
+    p_arena->p_base = (uint8_t *)PSP_Memory_Alloc(size, PSP_MEMORY_DMA_ALIGNMENT);
+    p_arena->size = (p_arena->p_base != 0) ? size : 0u;
+    p_arena->used = 0u;
+    p_arena->high_water = 0u;
+    p_arena->num_failed = 0u;
+
+    return (p_arena->p_base != 0) ? 1u : 0u;
+}
+
+
+
+void * PSP_Memory_Arena_Alloc(PSP_Memory_Arena_t * p_arena, uint32_t num_bytes, uint32_t alignment)
+{
+    const uint32_t ALIGNMENT = Memory_Alignment(alignment);
+
+    if (ALIGNMENT != 0u)
+    {
+        const uint32_t BASE = (uint32_t)p_arena->p_base;
+        const uint32_t START = MEMORY_ALIGN_UP(BASE + p_arena->used, ALIGNMENT) - BASE;
+
+        if ((START <= p_arena->size) && (num_bytes <= (p_arena->size - START)))
+        {
+            p_arena->used = START + num_bytes;
+
+            if (p_arena->used > p_arena->high_water)
+            {
+                p_arena->high_water = p_arena->used;
+            }
+
+            return p_arena->p_base + START;
+        }
+    }
+
+    p_arena->num_failed++;
+
+    return 0;
+}
+
+
+
+uint32_t PSP_Memory_Arena_Mark(const PSP_Memory_Arena_t * p_arena)
+{
+    return p_arena->used;
+}
+
+
+
+void PSP_Memory_Arena_Reset(PSP_Memory_Arena_t * p_arena, uint32_t mark)
+{
+    if (mark <= p_arena->used)
+    {
+        p_arena->used = mark;
+    }
+}
+
+
+
+uint32_t PSP_Memory_Pool_Create(PSP_Memory_Pool_t * p_pool, uint32_t block_size, uint32_t num_blocks, uint32_t alignment)
+{
+    uint32_t block_alignment = Memory_Alignment(alignment);
+
+    p_pool->p_blocks = 0;
+    p_pool->p_free = 0;
+    p_pool->block_size = 0u;
+    p_pool->num_blocks = 0u;
+    p_pool->num_free = 0u;
+    p_pool->high_water = 0u;
+    p_pool->num_failed = 0u;
+
+    if ((block_alignment == 0u) || (block_size == 0u) || (num_blocks == 0u))
+    {
+        return 0u;
+    }
+
+    // the free list link lives in the block's first word
+    if (block_alignment < sizeof(uint32_t))
+    {
+        block_alignment = sizeof(uint32_t);
+    }
+
+    const uint32_t BLOCK_SIZE = MEMORY_ALIGN_UP(block_size, block_alignment);
+
+    if ((BLOCK_SIZE < block_size) || (num_blocks > (0xFFFFFFFFu / BLOCK_SIZE)))
+    {
+        return 0u;
+    }
+
+    uint8_t * const P_BLOCKS = (uint8_t *)PSP_Memory_Alloc(BLOCK_SIZE * num_blocks, block_alignment);
+
+    if (P_BLOCKS == 0)
+    {
+        return 0u;
+    }
+
+    // link every block to the next, the last to nothing
+    for (uint32_t block = 0u; block < num_blocks; block++)
+    {
+        *(void **)(P_BLOCKS + (block * BLOCK_SIZE)) = ((block + 1u) < num_blocks) ? (P_BLOCKS + ((block + 1u) * BLOCK_SIZE)) : 0;
+    }
+
+    p_pool->p_blocks = P_BLOCKS;
+    p_pool->p_free = P_BLOCKS;
+    p_pool->block_size = BLOCK_SIZE;
+    p_pool->num_blocks = num_blocks;
+    p_pool->num_free = num_blocks;
+
+    return 1u;
+}
+
+
+
+void * PSP_Memory_Pool_Alloc(PSP_Memory_Pool_t * p_pool)
+{
+    const uint32_t STATE = PSP_IRQ_Disable();
+
+    void * const P_BLOCK = p_pool->p_free;
+
+    if (P_BLOCK != 0)
+    {
+        p_pool->p_free = *(void **)P_BLOCK;
+        p_pool->num_free--;
+
+        const uint32_t IN_USE = p_pool->num_blocks - p_pool->num_free;
+
+        if (IN_USE > p_pool->high_water)
+        {
+            p_pool->high_water = IN_USE;
+        }
+    }
+    else
+    {
+        p_pool->num_failed++;
+    }
+
+    PSP_IRQ_Restore(STATE);
+
+    return P_BLOCK;
+}
+
+
+
+uint32_t PSP_Memory_Pool_Free(PSP_Memory_Pool_t * p_pool, void * p_block)
+{
+    const uint32_t OFFSET = (uint32_t)p_block - (uint32_t)p_pool->p_blocks;
+
+    // below the pool wraps to a big offset, so one compare covers both ends
+    if ((p_block == 0) || (OFFSET >= (p_pool->block_size * p_pool->num_blocks)) || ((OFFSET % p_pool->block_size) != 0u))
+    {
+        return 0u;
+    }
+
+    const uint32_t STATE = PSP_IRQ_Disable();
+
+    *(void **)p_block = p_pool->p_free;
+    p_pool->p_free = p_block;
+    p_pool->num_free++;
+
+    PSP_IRQ_Restore(STATE);
+
+    return 1u;
+}
@@ -0,0 +1,348 @@
+/**
+ * DESCRIPTION:
+ *      PSP_Memory hands out the RAM the kernel image doesn't use: from _end (the end of .bss,
+ *      from linker.ld) to the top of the ARM's share of RAM, as the firmware reports it. On top
+ *      of that it offers bump arenas that are freed all at once with mark/reset, pools of fixed
+ *      size blocks with O(1) alloc and free, and aligned regions for DMA buffers.
+ *
+ * NOTES:
+ *      Memory taken from the system region is never given back, it's meant for what lives as
+ *      long as the program: arenas, pools, DMA buffers and the like, set up at start. Arenas
+ *      and pools then recycle their own memory as often as needed.
+ *
+ *      Arenas: an allocation bumps a single offset, freeing is putting the offset back to a
+ *      mark taken earlier, which frees everything allocated since at once. Good for scratch
+ *      memory per frame, per transfer or per command. Arenas are not interrupt safe, use one
+ *      per context.
+ *
+ *      Pools: blocks of one size, with the free ones linked through their first word, so alloc
+ *      and free are a few instructions each with IRQs masked around them. They are interrupt
+ *      safe, and PSP_Memory_Pool_Free checks the block belongs to the pool.
+ *
+ *      DMA regions start and end on a PSP_MEMORY_DMA_ALIGNMENT boundary, which covers control
+ *      blocks (32 bytes) and keeps them off cache lines shared with anything else for when the
+ *      data cache gets enabled. Pass the pointer through PSP_DMA_Bus_Address as usual.
+ *
+ *      Every allocator keeps its high-water mark and a count of the requests it turned down,
+ *      so the sizes picked at start can be checked against a real run.
+ *
+ *      The stack is below the kernel at 0x8000 and grows down, so nothing here is in its way.
+ *
+ * REFERENCES:
+ *      https://github.com/raspberrypi/firmware/wiki/Mailbox-property-interface (Get ARM memory)
+ */
+
+#ifndef PSP_MEMORY_H_INCLUDED
+#define PSP_MEMORY_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Memory Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_MEMORY_DEFAULT_ALIGNMENT    8u      // the AAPCS alignment, good for any C type
+#define PSP_MEMORY_DMA_ALIGNMENT        64u     // control blocks need 32, cache lines are up to 64
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Memory Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Memory_Stats_Type
+{
+    uint32_t base_address;          // start of the system region, just past the kernel image
+    uint32_t size;                  // bytes in the system region
+    uint32_t used;                  // bytes handed out, including alignment padding
+    uint32_t num_failed;            // requests that didn't fit
+} PSP_Memory_Stats_t;
+
+
+
+typedef struct Memory_Arena_Type
+{
+    uint8_t * p_base;
+    uint32_t size;
+    uint32_t used;                  // also the mark for PSP_Memory_Arena_Reset
+    uint32_t high_water;            // most used at once
+    uint32_t num_failed;
+} PSP_Memory_Arena_t;
+
+
+
+typedef struct Memory_Pool_Type
+{
+    uint8_t * p_blocks;
+    void * p_free;                  // first free block, each links to the next
+    uint32_t block_size;            // rounded up to the alignment
+    uint32_t num_blocks;
+    uint32_t num_free;
+    uint32_t high_water;            // most blocks in use at once
+    uint32_t num_failed;
+} PSP_Memory_Pool_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Memory Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Init
+
+Function Description:
+    Ask the firmware where the ARM's RAM ends and make everything from the end of the kernel
+    image up to there the system region. Anything allocated before is forgotten, so call it
+    once at start.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: bytes in the system region, 0 if the mailbox call failed
+
+Error Handling:
+    The system region is left empty if the mailbox call fails, so every allocation fails.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Memory_Init(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Alloc
+
+Function Description:
+    Take memory from the system region for good.
+
+Inputs:
+    num_bytes: bytes wanted
+    alignment: a power of 2, 0 for PSP_MEMORY_DEFAULT_ALIGNMENT
+
+Returns:
+    void *: the memory, not cleared, or 0 if it doesn't fit
+
+Error Handling:
+    Returns 0 and counts a failure if the request doesn't fit or the alignment isn't a power
+    of 2.
+
+-------------------------------------------------------------------------------------------------*/
+void * PSP_Memory_Alloc(uint32_t num_bytes, uint32_t alignment);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Alloc_DMA
+
+Function Description:
+    Take a region for DMA from the system region for good: it starts and ends on a
+    PSP_MEMORY_DMA_ALIGNMENT boundary so it shares no cache line with anything else, and is
+    cleared.
+
+Inputs:
+    num_bytes: bytes wanted
+
+Returns:
+    void *: the region, or 0 if it doesn't fit
+
+Error Handling:
+    Returns 0 and counts a failure if the request doesn't fit.
+
+-------------------------------------------------------------------------------------------------*/
+void * PSP_Memory_Alloc_DMA(uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Get_Stats
+
+Function Description:
+    Get how much of the system region is in use.
+
+Inputs:
+    p_stats: where to put them
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Memory_Get_Stats(PSP_Memory_Stats_t * p_stats);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Arena_Create
+
+Function Description:
+    Take size bytes from the system region for an empty arena.
+
+Inputs:
+    p_arena: the arena
+    size: bytes in the arena
+
+Returns:
+    uint32_t: 1 on success, 0 if the system region is out of memory
+
+Error Handling:
+    The arena is left empty, with a size of 0, if it fails.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Memory_Arena_Create(PSP_Memory_Arena_t * p_arena, uint32_t size);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Arena_Alloc
+
+Function Description:
+    Take memory from an arena, until the arena is reset past it.
+
+Inputs:
+    p_arena: the arena
+    num_bytes: bytes wanted
+    alignment: a power of 2, 0 for PSP_MEMORY_DEFAULT_ALIGNMENT
+
+Returns:
+    void *: the memory, not cleared, or 0 if it doesn't fit
+
+Error Handling:
+    Returns 0 and counts a failure if the request doesn't fit or the alignment isn't a power
+    of 2.
+
+-------------------------------------------------------------------------------------------------*/
+void * PSP_Memory_Arena_Alloc(PSP_Memory_Arena_t * p_arena, uint32_t num_bytes, uint32_t alignment);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Arena_Mark
+
+Function Description:
+    Get a mark to reset an arena back to, freeing whatever is allocated after it.
+
+Inputs:
+    p_arena: the arena
+
+Returns:
+    uint32_t: the mark
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Memory_Arena_Mark(const PSP_Memory_Arena_t * p_arena);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Arena_Reset
+
+Function Description:
+    Free everything allocated from an arena since a mark was taken. A mark of 0 empties it.
+
+Inputs:
+    p_arena: the arena
+    mark: from PSP_Memory_Arena_Mark
+
+Returns:
+    None
+
+Error Handling:
+    A mark past the arena's current use is ignored.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Memory_Arena_Reset(PSP_Memory_Arena_t * p_arena, uint32_t mark);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Pool_Create
+
+Function Description:
+    Take num_blocks blocks from the system region for a pool, all free.
+
+Inputs:
+    p_pool: the pool
+    block_size: bytes per block, rounded up to the alignment and to at least a word
+    num_blocks: blocks in the pool
+    alignment: of every block, a power of 2, 0 for PSP_MEMORY_DEFAULT_ALIGNMENT
+
+Returns:
+    uint32_t: 1 on success, 0 if the system region is out of memory or an input is bad
+
+Error Handling:
+    The pool is left with no blocks if it fails.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Memory_Pool_Create(PSP_Memory_Pool_t * p_pool, uint32_t block_size, uint32_t num_blocks, uint32_t alignment);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Pool_Alloc
+
+Function Description:
+    Take a block from a pool. Interrupt safe.
+
+Inputs:
+    p_pool: the pool
+
+Returns:
+    void *: the block, not cleared, or 0 if none are free
+
+Error Handling:
+    Returns 0 and counts a failure if the pool is empty.
+
+-------------------------------------------------------------------------------------------------*/
+void * PSP_Memory_Pool_Alloc(PSP_Memory_Pool_t * p_pool);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Memory_Pool_Free
+
+Function Description:
+    Give a block back to its pool. Interrupt safe.
+
+Inputs:
+    p_pool: the pool
+    p_block: from PSP_Memory_Pool_Alloc on the same pool
+
+Returns:
+    uint32_t: 1 if it was freed, 0 if it isn't one of the pool's blocks
+
+Error Handling:
+    A pointer outside the pool, or not at the start of a block, is left alone and 0 returned.
+    Freeing a block twice isn't caught.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Memory_Pool_Free(PSP_Memory_Pool_t * p_pool, void * p_block);
+
+#endif
@@ -2,6 +2,7 @@
 #include "PSP_PWM.h"
 #include "PSP_REGS.h"
 #include "PSP_GPIO.h"
+#include "PSP_Trace.h"
 
 /*------------------------------------------------------------------------------------------------
     Private PSP_PWM Defines
@@ -66,8 +67,13 @@
 #define PWM_STA_EMPT1        0x00000002u                               // Fifo Empty Flag
 #define PWM_STA_FULL1        0x00000001u                               // Fifo Full Flag
 
+// PWM DMA Configuration Register Masks
+#define PWM_DMAC_ENAB        0x80000000u                               // DMA Enable
+#define PWM_DMAC_PANIC(n)    (((n) & 0xFFu) << 8u)                     // DMA Threshold for PANIC signal
+#define PWM_DMAC_DREQ(n)     ((n) & 0xFFu)                             // DMA Threshold for DREQ signal
+
 // PWM Clock Control Register Addresses
-#define CM_BASE_ADDRESS      (0x3F1010A0u)
+#define CM_BASE_ADDRESS      (PSP_REGS_CM_BASE_ADDRESS | 0x000000A0u)
 #define PSP_CM_PWMCTL_A      (CM_BASE_ADDRESS | 0x00000000u)           // PWM clock control register address
 #define PSP_CM_PWMDIV_A      (CM_BASE_ADDRESS | 0x00000004u)           // PWM clock divider register address
 
@@ -82,6 +88,15 @@
 #define CM_PWMCTL_USE_OSC    0x00000001u                               // CM PWMCTL use internal oscillator
 
 
+/*------------------------------------------------------------------------------------------------
+    Private PSP_PWM Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// the dummy word every pacer control block feeds to the FIFO, its value doesn't matter
+static uint32_t pwm_pacer_word;
+
+
+
 /*------------------------------------------------------------------------------------------------
     PSP_PWM Function Definitions
  -------------------------------------------------------------------------------------------------*/
@@ -178,3 +193,55 @@ void PSP_PWM_Ch2_Set_GPIO19_To_PWM_Mode(void)
 {
     PSP_GPIO_Set_Pin_Mode(19u, PSP_GPIO_PINMODE_ALT5); 
 }
+
+
+
+/**
+ * The PWM is used here purely as a metronome, channel 1 runs in serializer mode reading from
+ * the FIFO, and every range clocks it pulls one word from the FIFO. The FIFO asks for more
+ * data with its DREQ, so a DMA transfer that writes to PSP_PWM_FIFO_ADDRESS with DEST_DREQ and
+ * PERMAP = PWM is held to one write every range clocks.
+ * 
+ * A DREQ threshold of 1 keeps the FIFO nearly empty, so only the first word or two of a
+ * transfer go through before the pacing kicks in.
+ */
+void PSP_PWM_DMA_Pacer_Start(uint32_t range)
+{
+    // stop both channels and empty the FIFO
+    PSP_PWM_CTL_R = 0u;
+    PSP_PWM_CTL_R = PWM_CTL_CLRF1;
+
+    PSP_PWM_RNG1_R = range;
+
+    PSP_PWM_DMAC_R = PWM_DMAC_ENAB | PWM_DMAC_PANIC(1u) | PWM_DMAC_DREQ(1u);
+
+    // channel 1, serializer mode, fed from the FIFO
+    PSP_PWM_CTL_R = PWM_CTL_USEF1 | PWM_CTL_MODE1 | PWM_CTL_PWEN1;
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_PWM_Pacer, range);
+}
+
+
+
+void PSP_PWM_DMA_Pacer_Fill_Control_Block(PSP_DMA_Control_Block_t * p_block, uint32_t num_ticks,
+                                          const PSP_DMA_Control_Block_t * p_next)
+{
+    // the source doesn't increment, so every tick rereads the same dummy word
+    const uint32_t PACER_TI = PSP_DMA_TI_NO_WIDE_BURSTS | PSP_DMA_TI_WAIT_RESP
+                            | PSP_DMA_TI_DEST_DREQ | PSP_DMA_TI_PERMAP(PSP_DMA_DREQ_PWM);
+
+    PSP_DMA_Fill_Control_Block(p_block, PACER_TI, PSP_DMA_Bus_Address(&pwm_pacer_word),
+                               PSP_DMA_Peripheral_Bus_Address(PSP_PWM_FIFO_ADDRESS),
+                               num_ticks * sizeof(uint32_t), p_next);
+}
+
+
+
+void PSP_PWM_DMA_Pacer_Stop(void)
+{
+    PSP_PWM_CTL_R = 0u;
+    PSP_PWM_DMAC_R = 0u;
+    PSP_PWM_CTL_R = PWM_CTL_CLRF1;
+
+    PSP_TRACE_END(PSP_Trace_Event_PWM_Pacer, 0u);
+}
@@ -15,6 +15,8 @@
 #define PSP_PWM_H_INCLUDED
 
 #include "Fixed_Width_Ints.h"
+#include "PSP_REGS.h"
+#include "PSP_DMA.h"
 
 /*------------------------------------------------------------------------------------------------
     Public PSP_PWM Defines
@@ -25,6 +27,9 @@
 #define PWM_DEFAULT_CLOCK    PSP_PWM_Clock_Source_OSCILLATOR           // default clock source, 19.2MHz internal osc
 #define PWM_DEFAULT_DIV      4u                                        // default clock divider, divide 19.2MHz clock by 4 = 4.8MHz
 
+// PWM FIFO address, the destination for DMA transfers paced by the PWM DREQ
+#define PSP_PWM_FIFO_ADDRESS (PSP_REGS_PWM_BASE_ADDRESS | 0x00000018u)
+
 
 
 /*------------------------------------------------------------------------------------------------
@@ -285,4 +290,86 @@ void PSP_PWM_Ch2_Set_GPIO19_To_PWM_Mode(void);
 
 
 
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_PWM_DMA_Pacer_Start
+
+Function Description:
+    Use PWM channel 1 as a DMA pacer instead of an output. Channel 1 is put in serializer mode
+    reading from the FIFO and the PWM DREQ is enabled, so a DMA transfer that writes to 
+    PSP_PWM_FIFO_ADDRESS with PSP_DMA_TI_DEST_DREQ and PSP_DMA_DREQ_PWM runs at one word every 
+    range PWM clocks.
+
+    A clock init function must be called first, the pacing rate is pwm_clock / range.
+
+    Channel 1 can't be used for PWM output while pacing, nothing is driven on any pin unless
+    GPIO12 or GPIO18 has been set to PWM mode.
+
+Inputs:
+    range: number of PWM clocks per DMA write, at least 2
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_PWM_DMA_Pacer_Start(uint32_t range);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_PWM_DMA_Pacer_Fill_Control_Block
+
+Function Description:
+    Fill in a control block that holds a DMA chain for a number of pacer ticks, by writing a
+    dummy word to the PWM FIFO once per tick. Every pacer block in every chain reads the same
+    dummy word, its value doesn't matter.
+
+    The pacer starts with an empty FIFO, so the first word of the first pacer block after
+    PSP_PWM_DMA_Pacer_Start goes straight in without waiting for a tick.
+
+Inputs:
+    p_block: control block to fill
+    num_ticks: number of ticks to wait, at least 1
+    p_next: control block to run after this one, 0 to stop
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_PWM_DMA_Pacer_Fill_Control_Block(PSP_DMA_Control_Block_t * p_block, uint32_t num_ticks,
+                                          const PSP_DMA_Control_Block_t * p_next);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_PWM_DMA_Pacer_Stop
+
+Function Description:
+    Stop pacing, disable the PWM DREQ and empty the FIFO.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_PWM_DMA_Pacer_Stop(void);
+
+
+
 #endif
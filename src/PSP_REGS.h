@@ -1,31 +1,103 @@
 /**
  * DESCRIPTION:
  *      PSP_REGS simply keeps a publicly available list of register addresses,
- *      as well as the peripheral base address.
+ *      as well as the peripheral base address for the board being built.
  * 
  * NOTES:
- *      TODO: For now this only works with the Raspberry Pi 3b+ and other Pis with 
- *      0x3F000000u as their peripheral base address. Add #ifdef statements
- *      so that it can work with other hardware.
+ *      The board is selected at compile time by defining exactly one of the following
+ *      (the Makefile does this from BOARD=pi1|pi3|pi4):
+ * 
+ *          PSP_BOARD_PI1 - BCM2835, Raspberry Pi 1 and Zero, peripherals at 0x20000000
+ *          PSP_BOARD_PI3 - BCM2836/7, Raspberry Pi 2 and 3,  peripherals at 0x3F000000
+ *          PSP_BOARD_PI4 - BCM2711, Raspberry Pi 4 (low peripheral mode), peripherals at 0xFE000000
+ * 
+ *      If no board is defined the Pi 3 settings are used, as that is what this repo started on.
+ * 
+ *      Every PSP module derives its addresses from PSP_REGS_PERIPHERAL_BASE_ADDRESS, so nothing
+ *      else should ever hard code a 0x3Fxxxxxx style address.
  * 
  * REFERENCES:
  *      BCM2837-ARM-Peripherals.pdf 
+ *      BCM2835-ARM-Peripherals.pdf
+ *      bcm2711-peripherals.pdf
  */
 
 #ifndef PSP_REGS_H_INCLUDED
 #define PSP_REGS_H_INCLUDED
 
+/*------------------------------------------------------------------------------------------------
+    Board Selection
+ -------------------------------------------------------------------------------------------------*/
+
+#if !defined(PSP_BOARD_PI1) && !defined(PSP_BOARD_PI3) && !defined(PSP_BOARD_PI4)
+#define PSP_BOARD_PI3
+#endif
+
+#if (defined(PSP_BOARD_PI1) + defined(PSP_BOARD_PI3) + defined(PSP_BOARD_PI4)) > 1
+#error "PSP_REGS: define only one of PSP_BOARD_PI1, PSP_BOARD_PI3 or PSP_BOARD_PI4"
+#endif
+
+
+
 /*------------------------------------------------------------------------------------------------
     Public PSP_REGS Defines
  -------------------------------------------------------------------------------------------------*/
 
-// Register Base Addresses
+#if defined(PSP_BOARD_PI1)
+
+#define PSP_REGS_BOARD_NAME              "pi1"
+#define PSP_REGS_PERIPHERAL_BASE_ADDRESS (0x20000000u)
+#define PSP_REGS_CORE_CLOCK_HZ           (250000000u)   // VPU core clock, feeds the mini uart, SPI and BSC dividers
+#define PSP_REGS_PLLD_CLOCK_HZ           (500000000u)   // PLLD, the usual clock manager source for PWM/PCM pacing
+#define PSP_REGS_BUS_RAM_ALIAS           (0x40000000u)  // L2 cached alias of RAM, the same path the ARM takes on the Pi 1
+#define PSP_REGS_EMMC_BASE_ADDRESS       (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00300000u)  // Arasan EMMC, wired to the SD card slot through GPIO 48...53
+
+#elif defined(PSP_BOARD_PI4)
+
+#define PSP_REGS_BOARD_NAME              "pi4"
+#define PSP_REGS_PERIPHERAL_BASE_ADDRESS (0xFE000000u)
+#define PSP_REGS_CORE_CLOCK_HZ           (500000000u)   // VPU core clock, feeds the mini uart, SPI and BSC dividers
+#define PSP_REGS_PLLD_CLOCK_HZ           (750000000u)   // PLLD, the usual clock manager source for PWM/PCM pacing
+#define PSP_REGS_BUS_RAM_ALIAS           (0xC0000000u)  // uncached alias of RAM, so DMA and the ARM agree without cache maintenance
+#define PSP_REGS_EMMC_BASE_ADDRESS       (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00340000u)  // EMMC2, the SD card slot (the Arasan EMMC is for WiFi)
+
+// the Pi 4 replaces the legacy ARM interrupt controller with a GIC-400
+#define PSP_REGS_HAS_GIC_400
+#define PSP_REGS_GIC_BASE_ADDRESS        (0xFF840000u)
+#define PSP_REGS_GIC_DIST_BASE_ADDRESS   (PSP_REGS_GIC_BASE_ADDRESS | 0x00001000u)  // GIC distributor
+#define PSP_REGS_GIC_CPU_BASE_ADDRESS    (PSP_REGS_GIC_BASE_ADDRESS | 0x00002000u)  // GIC CPU interface
+
+#else
+
+#define PSP_REGS_BOARD_NAME              "pi3"
 #define PSP_REGS_PERIPHERAL_BASE_ADDRESS (0x3F000000u)
+#define PSP_REGS_CORE_CLOCK_HZ           (250000000u)   // VPU core clock, feeds the mini uart, SPI and BSC dividers
+#define PSP_REGS_PLLD_CLOCK_HZ           (500000000u)   // PLLD, the usual clock manager source for PWM/PCM pacing
+#define PSP_REGS_BUS_RAM_ALIAS           (0xC0000000u)  // uncached alias of RAM, so DMA and the ARM agree without cache maintenance
+#define PSP_REGS_EMMC_BASE_ADDRESS       (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00300000u)  // Arasan EMMC, wired to the SD card slot through GPIO 48...53
+
+#endif
 
+// Bus Addresses, what the DMA engine (and the GPU) see instead of ARM physical addresses
+#define PSP_REGS_BUS_PERIPHERAL_BASE     (0x7E000000u)  // peripherals on the bus, on every board
+
+#define PSP_REGS_PERIPHERAL_TO_BUS(addr) (((addr) - PSP_REGS_PERIPHERAL_BASE_ADDRESS) + PSP_REGS_BUS_PERIPHERAL_BASE)
+#define PSP_REGS_RAM_TO_BUS(addr)        ((addr) | PSP_REGS_BUS_RAM_ALIAS)
+#define PSP_REGS_BUS_TO_RAM(addr)        ((addr) & 0x3FFFFFFFu)         // strips whichever alias the GPU handed out
+
+// Register Base Addresses
 #define PSP_REGS_GPIO_BASE_ADDRESS       (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00200000u)
 #define PSP_REGS_SYSCLK_BASE_ADDRESS     (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00003000u)
+#define PSP_REGS_CM_BASE_ADDRESS         (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00101000u)
 #define PSP_REGS_PWM_BASE_ADDRESS        (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x0020C000u) 
 #define PSP_REGS_SPI_0_BASE_ADDRESS      (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00204000u)
-#define PSP_REGS_I2C_BASE_ADDRESS        (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00804000u)
+#define PSP_REGS_I2C_0_BASE_ADDRESS      (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00205000u)  // BSC0
+#define PSP_REGS_I2C_1_BASE_ADDRESS      (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00804000u)  // BSC1
+#define PSP_REGS_I2C_2_BASE_ADDRESS      (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00805000u)  // BSC2, the HDMI DDC bus
 #define PSP_REGS_AUX_BASE_ADDRESS        (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00215000u)
+#define PSP_REGS_DMA_BASE_ADDRESS        (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00007000u)
+#define PSP_REGS_RNG_BASE_ADDRESS        (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00104000u)
+#define PSP_REGS_MAILBOX_BASE_ADDRESS    (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x0000B880u)
+#define PSP_REGS_IRQ_BASE_ADDRESS        (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x0000B200u)  // legacy ARM interrupt controller, unused with the GIC-400
+#define PSP_REGS_BSC_SLAVE_BASE_ADDRESS  (PSP_REGS_PERIPHERAL_BASE_ADDRESS | 0x00214000u)
 #endif
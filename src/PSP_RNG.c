@@ -0,0 +1,351 @@
+
+#include "PSP_RNG.h"
+#include "PSP_REGS.h"
+#include "PSP_Trace.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_RNG Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define RNG_BASE_ADDRESS          (PSP_REGS_RNG_BASE_ADDRESS)
+
+#define RNG_WARMUP_BITS           0x00040000u // bits thrown away after the generator is started
+
+#if defined(PSP_BOARD_PI4)
+
+// RNG200 Register Addresses
+#define PSP_RNG_CTRL_A                     (RNG_BASE_ADDRESS | 0x00000000u) // Control address
+#define PSP_RNG_SOFT_RESET_A               (RNG_BASE_ADDRESS | 0x00000004u) // RNG Soft Reset address
+#define PSP_RNG_RBG_SOFT_RESET_A           (RNG_BASE_ADDRESS | 0x00000008u) // RBG Soft Reset address
+#define PSP_RNG_TOTAL_BIT_COUNT_THRESHOLD_A (RNG_BASE_ADDRESS | 0x00000010u) // Warm up bit count address
+#define PSP_RNG_FIFO_DATA_A                (RNG_BASE_ADDRESS | 0x00000020u) // FIFO Data address
+#define PSP_RNG_FIFO_COUNT_A               (RNG_BASE_ADDRESS | 0x00000024u) // FIFO Count address
+
+// RNG200 Register Pointers
+#define PSP_RNG_CTRL_R                     (*((volatile uint32_t *)PSP_RNG_CTRL_A))                      // Control register
+#define PSP_RNG_SOFT_RESET_R               (*((volatile uint32_t *)PSP_RNG_SOFT_RESET_A))                // RNG Soft Reset register
+#define PSP_RNG_RBG_SOFT_RESET_R           (*((volatile uint32_t *)PSP_RNG_RBG_SOFT_RESET_A))            // RBG Soft Reset register
+#define PSP_RNG_TOTAL_BIT_COUNT_THRESHOLD_R (*((volatile uint32_t *)PSP_RNG_TOTAL_BIT_COUNT_THRESHOLD_A)) // Warm up bit count register
+#define PSP_RNG_FIFO_DATA_R                (*((volatile uint32_t *)PSP_RNG_FIFO_DATA_A))                 // FIFO Data register
+#define PSP_RNG_FIFO_COUNT_R               (*((volatile uint32_t *)PSP_RNG_FIFO_COUNT_A))                // FIFO Count register
+
+// RNG200 Register Masks
+#define RNG_CTRL_RBGEN_MASK       0x00001FFFu // Random bit generator enable field
+#define RNG_CTRL_RBGEN_ENABLE     0x00000001u // Random bit generator on
+#define RNG_SOFT_RESET            0x00000001u // Hold in reset
+#define RNG_FIFO_COUNT_MASK       0x000000FFu // Words ready in the FIFO
+#define RNG_FIFO_THRESHOLD(n)     (((n) & 0xFFu) << 8u) // FIFO level for the full interrupt
+
+#else
+
+// RNG Register Addresses
+#define PSP_RNG_CTRL_A            (RNG_BASE_ADDRESS | 0x00000000u) // Control address
+#define PSP_RNG_STATUS_A          (RNG_BASE_ADDRESS | 0x00000004u) // Status address
+#define PSP_RNG_DATA_A            (RNG_BASE_ADDRESS | 0x00000008u) // Data address
+#define PSP_RNG_INT_MASK_A        (RNG_BASE_ADDRESS | 0x00000010u) // Interrupt Mask address
+
+// RNG Register Pointers
+#define PSP_RNG_CTRL_R            (*((volatile uint32_t *)PSP_RNG_CTRL_A))     // Control register
+#define PSP_RNG_STATUS_R          (*((volatile uint32_t *)PSP_RNG_STATUS_A))   // Status register
+#define PSP_RNG_DATA_R            (*((volatile uint32_t *)PSP_RNG_DATA_A))     // Data register
+#define PSP_RNG_INT_MASK_R        (*((volatile uint32_t *)PSP_RNG_INT_MASK_A)) // Interrupt Mask register
+
+// RNG Register Masks
+#define RNG_CTRL_RBGEN            0x00000001u // Random bit generator on
+#define RNG_STATUS_WORDS_SHIFT    24u         // Words ready in the FIFO are STATUS[31:24]
+#define RNG_INT_MASK_INT_OFF      0x00000001u // Interrupt off
+
+#endif
+
+#define RNG_POOL_INDEX_MASK       (PSP_RNG_POOL_WORDS - 1u)
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_RNG Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// the entropy pool, a ring buffer. the indexes only ever count up and wrap at 2^32, which
+// works out since the pool size is a power of 2
+static uint32_t rng_pool[PSP_RNG_POOL_WORDS];
+static uint32_t rng_pool_head;   // words put in
+static uint32_t rng_pool_tail;   // words taken out
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_RNG Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+#if defined(PSP_BOARD_PI4)
+
+static void RNG_Hardware_Start(void)
+{
+    PSP_RNG_CTRL_R &= ~RNG_CTRL_RBGEN_MASK;
+
+    // reset both halves of the RNG200
+    PSP_RNG_RBG_SOFT_RESET_R = RNG_SOFT_RESET;
+    PSP_RNG_SOFT_RESET_R = RNG_SOFT_RESET;
+    PSP_RNG_SOFT_RESET_R = 0u;
+    PSP_RNG_RBG_SOFT_RESET_R = 0u;
+
+    PSP_RNG_TOTAL_BIT_COUNT_THRESHOLD_R = RNG_WARMUP_BITS;
+    PSP_RNG_FIFO_COUNT_R = RNG_FIFO_THRESHOLD(2u);
+
+    PSP_RNG_CTRL_R = (PSP_RNG_CTRL_R & ~RNG_CTRL_RBGEN_MASK) | RNG_CTRL_RBGEN_ENABLE;
+}
+
+
+
+static uint32_t RNG_Hardware_Words_Ready(void)
+{
+    return PSP_RNG_FIFO_COUNT_R & RNG_FIFO_COUNT_MASK;
+}
+
+
+
+static uint32_t RNG_Hardware_Read(void)
+{
+    return PSP_RNG_FIFO_DATA_R;
+}
+
+#else
+
+static void RNG_Hardware_Start(void)
+{
+    // the generator throws away this many bits before filling the FIFO
+    PSP_RNG_STATUS_R = RNG_WARMUP_BITS;
+
+    // the pool is filled by polling, see PSP_RNG.h
+    PSP_RNG_INT_MASK_R |= RNG_INT_MASK_INT_OFF;
+
+    PSP_RNG_CTRL_R |= RNG_CTRL_RBGEN;
+}
+
+
+
+static uint32_t RNG_Hardware_Words_Ready(void)
+{
+    return PSP_RNG_STATUS_R >> RNG_STATUS_WORDS_SHIFT;
+}
+
+
+
+static uint32_t RNG_Hardware_Read(void)
+{
+    return PSP_RNG_DATA_R;
+}
+
+#endif
+
+
+
+void PSP_RNG_Init(void)
+{
+    rng_pool_head = 0u;
+    rng_pool_tail = 0u;
+
+    RNG_Hardware_Start();
+}
+
+
+
+void PSP_RNG_Service(void)
+{
+    uint32_t words_ready = RNG_Hardware_Words_Ready();
+    const uint32_t START_HEAD = rng_pool_head;
+
+    while ((words_ready > 0u) && ((rng_pool_head - rng_pool_tail) < PSP_RNG_POOL_WORDS))
+    {
+        rng_pool[rng_pool_head & RNG_POOL_INDEX_MASK] = RNG_Hardware_Read();
+        rng_pool_head++;
+        words_ready--;
+    }
+
+    if (rng_pool_head != START_HEAD)
+    {
+        PSP_TRACE_INSTANT(PSP_Trace_Event_RNG_Refill, rng_pool_head - START_HEAD);
+    }
+}
+
+
+
+uint32_t PSP_RNG_Pool_Level(void)
+{
+    return rng_pool_head - rng_pool_tail;
+}
+
+
+
+uint32_t PSP_RNG_Try_Get_Word(uint32_t * p_word)
+{
+    if (rng_pool_head == rng_pool_tail)
+    {
+        return 0u; // pool is empty
+    }
+
+    *p_word = rng_pool[rng_pool_tail & RNG_POOL_INDEX_MASK];
+    rng_pool_tail++;
+
+    return 1u;
+}
+
+
+
+uint32_t PSP_RNG_Get_Word(void)
+{
+    uint32_t word;
+
+    if (PSP_RNG_Try_Get_Word(&word))
+    {
+        return word;
+    }
+
+    while (RNG_Hardware_Words_Ready() == 0u)
+    {
+        // wait for the hardware to make a word
+    }
+
+    return RNG_Hardware_Read();
+}
+
+
+
+void PSP_RNG_Get_Bytes(uint8_t * p_buffer, uint32_t num_bytes)
+{
+    while (num_bytes > 0u)
+    {
+        uint32_t word = PSP_RNG_Get_Word();
+
+        for (uint32_t i = 0u; (i < sizeof(uint32_t)) && (num_bytes > 0u); i++)
+        {
+            *p_buffer = (uint8_t)word;
+            p_buffer++;
+            word >>= 8u;
+            num_bytes--;
+        }
+    }
+}
+
+
+
+static uint64_t RNG_Splitmix64(uint64_t * p_state)
+{
+    uint64_t z = (*p_state += 0x9E3779B97F4A7C15ull);
+
+    z = (z ^ (z >> 30u)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27u)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31u);
+}
+
+
+
+void PSP_RNG_Xoshiro_Seed(PSP_RNG_Xoshiro_t * p_xoshiro, uint64_t seed)
+{
+    for (uint32_t lane = 0u; lane < PSP_RNG_XOSHIRO_LANES; lane++)
+    {
+        for (uint32_t word = 0u; word < 4u; word += 2u)
+        {
+            const uint64_t SPLIT = RNG_Splitmix64(&seed);
+
+            p_xoshiro->state[word][lane] = (uint32_t)SPLIT;
+            p_xoshiro->state[word + 1u][lane] = (uint32_t)(SPLIT >> 32u);
+        }
+
+        // an all zero state only ever makes zeros, splitmix64 can't really give one but be sure
+        if ((p_xoshiro->state[0][lane] | p_xoshiro->state[1][lane] | p_xoshiro->state[2][lane] | p_xoshiro->state[3][lane]) == 0u)
+        {
+            p_xoshiro->state[0][lane] = 1u;
+        }
+    }
+
+    p_xoshiro->output_index = PSP_RNG_XOSHIRO_LANES; // nothing made yet
+}
+
+
+
+/**
+ * one step of xoshiro128** on every lane at once. the vector types make GCC emit NEON
+ * (vmul, vshl, vsri, veor) when NEON is enabled, and 4 copies of the scalar code otherwise
+ */
+static inline PSP_RNG_Lanes_t RNG_Xoshiro_Step(PSP_RNG_Xoshiro_t * p_xoshiro)
+{
+    PSP_RNG_Lanes_t s0 = p_xoshiro->state[0];
+    PSP_RNG_Lanes_t s1 = p_xoshiro->state[1];
+    PSP_RNG_Lanes_t s2 = p_xoshiro->state[2];
+    PSP_RNG_Lanes_t s3 = p_xoshiro->state[3];
+
+    const PSP_RNG_Lanes_t S1_TIMES_5 = s1 * 5u;
+    const PSP_RNG_Lanes_t RESULT = ((S1_TIMES_5 << 7u) | (S1_TIMES_5 >> 25u)) * 9u;
+    const PSP_RNG_Lanes_t T = s1 << 9u;
+
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= T;
+    s3 = (s3 << 11u) | (s3 >> 21u);
+
+    p_xoshiro->state[0] = s0;
+    p_xoshiro->state[1] = s1;
+    p_xoshiro->state[2] = s2;
+    p_xoshiro->state[3] = s3;
+
+    return RESULT;
+}
+
+
+
+uint32_t PSP_RNG_Xoshiro_Next(PSP_RNG_Xoshiro_t * p_xoshiro)
+{
+    if (p_xoshiro->output_index >= PSP_RNG_XOSHIRO_LANES)
+    {
+        const PSP_RNG_Lanes_t RESULT = RNG_Xoshiro_Step(p_xoshiro);
+
+        for (uint32_t lane = 0u; lane < PSP_RNG_XOSHIRO_LANES; lane++)
+        {
+            p_xoshiro->output[lane] = RESULT[lane];
+        }
+
+        p_xoshiro->output_index = 0u;
+    }
+
+    const uint32_t WORD = p_xoshiro->output[p_xoshiro->output_index];
+    p_xoshiro->output_index++;
+
+    return WORD;
+}
+
+
+
+void PSP_RNG_Xoshiro_Fill(PSP_RNG_Xoshiro_t * p_xoshiro, uint32_t * p_buffer, uint32_t num_words)
+{
+    // hand out anything left over from PSP_RNG_Xoshiro_Next first, so the sequence is the same
+    while ((num_words > 0u) && (p_xoshiro->output_index < PSP_RNG_XOSHIRO_LANES))
+    {
+        *p_buffer = PSP_RNG_Xoshiro_Next(p_xoshiro);
+        p_buffer++;
+        num_words--;
+    }
+
+    while (num_words >= PSP_RNG_XOSHIRO_LANES)
+    {
+        const PSP_RNG_Lanes_t RESULT = RNG_Xoshiro_Step(p_xoshiro);
+
+        p_buffer[0] = RESULT[0];
+        p_buffer[1] = RESULT[1];
+        p_buffer[2] = RESULT[2];
+        p_buffer[3] = RESULT[3];
+
+        p_buffer += PSP_RNG_XOSHIRO_LANES;
+        num_words -= PSP_RNG_XOSHIRO_LANES;
+    }
+
+    while (num_words > 0u)
+    {
+        *p_buffer = PSP_RNG_Xoshiro_Next(p_xoshiro);
+        p_buffer++;
+        num_words--;
+    }
+}
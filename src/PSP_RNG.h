@@ -0,0 +1,280 @@
+/**
+ * DESCRIPTION:
+ *      PSP_RNG provides an interface for the hardware random number generator, and a fast
+ *      seeded pseudo random number generator (xoshiro128**) for bulk random numbers.
+ *
+ * NOTES:
+ *      The hardware RNG is slow (a few hundred kB/s at best) and reading it when its FIFO is
+ *      empty stalls the CPU until it has made another word. To avoid the stalls, words are
+ *      moved from the hardware FIFO into an entropy pool in the background, and served from
+ *      the pool:
+ *
+ *          PSP_RNG_Service       - call regularly from the main loop, tops up the pool with
+ *                                  whatever the hardware has ready, never waits
+ *          PSP_RNG_Try_Get_Word  - a word from the pool, or nothing if the pool is empty
+ *          PSP_RNG_Get_Word      - a word from the pool, or straight from the hardware (and
+ *                                  possibly stalling) if the pool is empty
+ *
+ *      The RNG interrupt is left masked, the pool is only filled when PSP_RNG_Service (or a
+ *      get that finds it empty) polls the hardware.
+ *
+ *      The first 0x40000 bits out of the hardware are thrown away while it warms up, so the
+ *      pool takes a little while to start filling after PSP_RNG_Init.
+ *
+ *      The Pi 4 has a different RNG block (the RNG200) at the same address, the functions
+ *      here work the same on every board.
+ *
+ *      Hardware words are for nonces, keys and seeds. For simulations and anything else that
+ *      needs lots of random numbers quickly, seed a PSP_RNG_Xoshiro_t from the hardware and
+ *      use that. It runs 4 independent xoshiro128** generators side by side with GCC vector
+ *      types, so it compiles to NEON when NEON is enabled and to plain ARM code otherwise.
+ *      It is NOT cryptographically secure.
+ *
+ * REFERENCES:
+ *      There is no datasheet for the RNG, the registers come from the Linux drivers
+ *      drivers/char/hw_random/bcm2835-rng.c and iproc-rng200.c
+ *      xoshiro128**: https://prng.di.unimi.it/ (Blackman and Vigna)
+ */
+
+#ifndef PSP_RNG_H_INCLUDED
+#define PSP_RNG_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_RNG Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_RNG_POOL_WORDS    256u  // size of the entropy pool, must be a power of 2
+#define PSP_RNG_XOSHIRO_LANES 4u    // generators run side by side in a PSP_RNG_Xoshiro_t
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_RNG Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef uint32_t PSP_RNG_Lanes_t __attribute__((vector_size(16)));
+
+
+
+// 4 xoshiro128** generators, state[n] holds word n of every generator's state
+typedef struct RNG_Xoshiro_Type
+{
+    PSP_RNG_Lanes_t state[4];
+    uint32_t output[PSP_RNG_XOSHIRO_LANES];  // words made but not yet handed out by PSP_RNG_Xoshiro_Next
+    uint32_t output_index;                   // next word of output to hand out
+} PSP_RNG_Xoshiro_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_RNG Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Init
+
+Function Description:
+    Start the hardware RNG with a warm up period, and empty the entropy pool.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_RNG_Init(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Service
+
+Function Description:
+    Move any words the hardware RNG has ready into the entropy pool, until the pool is full.
+    Never waits on the hardware. Call this regularly from the main loop.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_RNG_Service(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Pool_Level
+
+Function Description:
+    Get the number of words waiting in the entropy pool.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 0...PSP_RNG_POOL_WORDS
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_RNG_Pool_Level(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Try_Get_Word
+
+Function Description:
+    Take a word from the entropy pool without waiting.
+
+Inputs:
+    p_word: where to put the word
+
+Returns:
+    uint32_t: 1 if a word was taken, 0 if the pool was empty
+
+Error Handling:
+    *p_word is left alone if the pool is empty.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_RNG_Try_Get_Word(uint32_t * p_word);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Get_Word
+
+Function Description:
+    Take a word from the entropy pool, or read one from the hardware RNG if the pool is empty.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: a hardware random word
+
+Error Handling:
+    Waits for the hardware if the pool is empty, which includes the warm up after PSP_RNG_Init.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_RNG_Get_Word(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Get_Bytes
+
+Function Description:
+    Fill a buffer with hardware random bytes, using PSP_RNG_Get_Word.
+
+Inputs:
+    p_buffer: where to put the bytes
+    num_bytes: number of bytes to fill
+
+Returns:
+    None
+
+Error Handling:
+    Same as PSP_RNG_Get_Word.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_RNG_Get_Bytes(uint8_t * p_buffer, uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Xoshiro_Seed
+
+Function Description:
+    Seed all 4 generators of a PSP_RNG_Xoshiro_t from one 64 bit seed, with splitmix64 as the
+    xoshiro authors recommend. The same seed always gives the same sequence, use
+    PSP_RNG_Get_Word for a seed that is different every time.
+
+Inputs:
+    p_xoshiro: the generators to seed
+    seed: any value, including 0
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_RNG_Xoshiro_Seed(PSP_RNG_Xoshiro_t * p_xoshiro, uint64_t seed);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Xoshiro_Next
+
+Function Description:
+    Get the next pseudo random word. Steps all 4 generators once every 4 words.
+
+Inputs:
+    p_xoshiro: seeded generators
+
+Returns:
+    uint32_t: the next word
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_RNG_Xoshiro_Next(PSP_RNG_Xoshiro_t * p_xoshiro);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_RNG_Xoshiro_Fill
+
+Function Description:
+    Fill a buffer with pseudo random words, 4 at a time. Gives the same words as calling
+    PSP_RNG_Xoshiro_Next num_words times, only faster.
+
+Inputs:
+    p_xoshiro: seeded generators
+    p_buffer: where to put the words
+    num_words: number of words to fill
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_RNG_Xoshiro_Fill(PSP_RNG_Xoshiro_t * p_xoshiro, uint32_t * p_buffer, uint32_t num_words);
+
+#endif
@@ -0,0 +1,387 @@
+#include "PSP_Ring.h"
+#include "PSP_IRQ.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Ring Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#if defined(PSP_BOARD_PI1) || defined(PSP_RING_SMP)
+#define RING_USE_EXCLUSIVES
+#endif
+
+#define RING_CELL_DATA      4u              // bytes from the start of an MPMC cell to its element
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_Ring Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * Data memory barrier: every access before it is seen, by every core, before any after it.
+ */
+static inline void Ring_Barrier(void)
+{
+#if defined(PSP_HOST_BUILD)
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#elif defined(PSP_BOARD_PI1)
+    __asm__ volatile ("mcr p15, 0, %0, c7, c10, 5" : : "r" (0u) : "memory");
+#else
+    __asm__ volatile (".word 0xF57FF05B" : : : "memory"); // dmb ish
+#endif
+}
+
+
+
+/**
+ * Set *p_value to desired if it is expected, atomically. Returns 1 if it was set.
+ */
+static inline uint32_t Ring_Compare_And_Swap(volatile uint32_t * p_value, uint32_t expected, uint32_t desired)
+{
+#if defined(PSP_HOST_BUILD)
+    return __sync_bool_compare_and_swap(p_value, expected, desired) ? 1u : 0u;
+#elif defined(RING_USE_EXCLUSIVES)
+    // fixed registers, as the instructions are spelt out for the default -march
+    register volatile uint32_t * p_r0 __asm__ ("r0") = p_value;
+    register uint32_t r1 __asm__ ("r1") = expected;
+    register uint32_t r2 __asm__ ("r2") = desired;
+    register uint32_t r3 __asm__ ("r3");
+
+    __asm__ volatile (
+        "1:  .word   0xE1903F9F      \n" // ldrex r3, [r0]
+        "    cmp     r3, r1          \n"
+        "    bne     2f              \n"
+        "    .word   0xE180CF92      \n" // strex r12, r2, [r0]
+        "    cmp     r12, #0         \n"
+        "    bne     1b              \n"
+        "    b       3f              \n"
+        "2:  .word   0xF57FF01F      \n" // clrex
+        "3:                          \n"
+        : "=&r" (r3)
+        : "r" (p_r0), "r" (r1), "r" (r2)
+        : "r12", "cc", "memory");
+
+    return (r3 == expected) ? 1u : 0u;
+#else
+    // atomic against interrupts on this core only, see the notes in PSP_Ring.h
+    const uint32_t STATE = PSP_IRQ_Disable();
+    const uint32_t OLD = *p_value;
+
+    if (OLD == expected)
+    {
+        *p_value = desired;
+    }
+
+    PSP_IRQ_Restore(STATE);
+
+    return (OLD == expected) ? 1u : 0u;
+#endif
+}
+
+
+
+uint32_t PSP_Ring_SPSC_Init(PSP_Ring_SPSC_t * p_ring, void * p_buffer, uint32_t capacity, uint32_t element_size)
+{
+    if ((capacity == 0u) || (capacity & (capacity - 1u)) || (element_size == 0u))
+    {
+        return 0u;
+    }
+
+    p_ring->head = 0u;
+    p_ring->tail_copy = 0u;
+    p_ring->tail = 0u;
+    p_ring->head_copy = 0u;
+    p_ring->p_buffer = (uint8_t *)p_buffer;
+    p_ring->capacity = capacity;
+    p_ring->element_size = element_size;
+
+    return 1u;
+}
+
+
+
+uint32_t PSP_Ring_SPSC_Push(PSP_Ring_SPSC_t * p_ring, const void * p_element)
+{
+    return PSP_Ring_SPSC_Push_Bulk(p_ring, p_element, 1u);
+}
+
+
+
+uint32_t PSP_Ring_SPSC_Pop(PSP_Ring_SPSC_t * p_ring, void * p_element)
+{
+    return PSP_Ring_SPSC_Pop_Bulk(p_ring, p_element, 1u);
+}
+
+
+
+uint32_t PSP_Ring_SPSC_Push_Bulk(PSP_Ring_SPSC_t * p_ring, const void * p_elements, uint32_t num_elements)
+{
+    const uint32_t HEAD = p_ring->head;
+    const uint32_t CAPACITY = p_ring->capacity;
+    uint32_t num_free = CAPACITY - (HEAD - p_ring->tail_copy);
+
+    if (num_free < num_elements)
+    {
+        p_ring->tail_copy = p_ring->tail;
+
+        // the consumer is done reading what it freed before it gets written over
+        Ring_Barrier();
+
+        num_free = CAPACITY - (HEAD - p_ring->tail_copy);
+    }
+
+    const uint32_t COUNT = (num_elements < num_free) ? num_elements : num_free;
+
+    if (COUNT == 0u)
+    {
+        return 0u;
+    }
+
+    const uint32_t SIZE = p_ring->element_size;
+    const uint32_t INDEX = HEAD & (CAPACITY - 1u);
+    const uint32_t FIRST = ((CAPACITY - INDEX) < COUNT) ? (CAPACITY - INDEX) : COUNT;
+
+    memcpy(p_ring->p_buffer + (INDEX * SIZE), p_elements, FIRST * SIZE);
+    memcpy(p_ring->p_buffer, (const uint8_t *)p_elements + (FIRST * SIZE), (COUNT - FIRST) * SIZE);
+
+    // the elements land before the head that publishes them
+    Ring_Barrier();
+
+    p_ring->head = HEAD + COUNT;
+
+    return COUNT;
+}
+
+
+
+uint32_t PSP_Ring_SPSC_Pop_Bulk(PSP_Ring_SPSC_t * p_ring, void * p_elements, uint32_t max_elements)
+{
+    const uint32_t TAIL = p_ring->tail;
+    const uint32_t CAPACITY = p_ring->capacity;
+    uint32_t num_ready = p_ring->head_copy - TAIL;
+
+    if (num_ready < max_elements)
+    {
+        p_ring->head_copy = p_ring->head;
+
+        // the elements are read after the head that published them
+        Ring_Barrier();
+
+        num_ready = p_ring->head_copy - TAIL;
+    }
+
+    const uint32_t COUNT = (max_elements < num_ready) ? max_elements : num_ready;
+
+    if (COUNT == 0u)
+    {
+        return 0u;
+    }
+
+    const uint32_t SIZE = p_ring->element_size;
+    const uint32_t INDEX = TAIL & (CAPACITY - 1u);
+    const uint32_t FIRST = ((CAPACITY - INDEX) < COUNT) ? (CAPACITY - INDEX) : COUNT;
+
+    memcpy(p_elements, p_ring->p_buffer + (INDEX * SIZE), FIRST * SIZE);
+    memcpy((uint8_t *)p_elements + (FIRST * SIZE), p_ring->p_buffer, (COUNT - FIRST) * SIZE);
+
+    // done reading before the space is handed back
+    Ring_Barrier();
+
+    p_ring->tail = TAIL + COUNT;
+
+    return COUNT;
+}
+
+
+
+uint32_t PSP_Ring_SPSC_Count(const PSP_Ring_SPSC_t * p_ring)
+{
+    return p_ring->head - p_ring->tail;
+}
+
+
+
+/**
+ * The sequence word of the cell for a position, its element follows it.
+ */
+static inline volatile uint32_t * Ring_Cell(const PSP_Ring_MPMC_t * p_queue, uint32_t position)
+{
+    return (volatile uint32_t *)(p_queue->p_cells + ((position & (p_queue->capacity - 1u)) * p_queue->cell_size));
+}
+
+
+
+uint32_t PSP_Ring_MPMC_Init(PSP_Ring_MPMC_t * p_queue, void * p_cells, uint32_t capacity, uint32_t element_size)
+{
+    if ((capacity < 2u) || (capacity & (capacity - 1u)) || (element_size == 0u) || ((uintptr_t)p_cells & 0x3u))
+    {
+        return 0u;
+    }
+
+    p_queue->p_cells = (uint8_t *)p_cells;
+    p_queue->capacity = capacity;
+    p_queue->element_size = element_size;
+    p_queue->cell_size = PSP_RING_MPMC_CELL_SIZE(element_size);
+
+    // cell n is free for position n
+    for (uint32_t position = 0u; position < capacity; position++)
+    {
+        *Ring_Cell(p_queue, position) = position;
+    }
+
+    p_queue->enqueue_position = 0u;
+    p_queue->dequeue_position = 0u;
+
+    Ring_Barrier();
+
+    return 1u;
+}
+
+
+
+uint32_t PSP_Ring_MPMC_Enqueue(PSP_Ring_MPMC_t * p_queue, const void * p_element)
+{
+    return PSP_Ring_MPMC_Enqueue_Bulk(p_queue, p_element, 1u);
+}
+
+
+
+uint32_t PSP_Ring_MPMC_Dequeue(PSP_Ring_MPMC_t * p_queue, void * p_element)
+{
+    return PSP_Ring_MPMC_Dequeue_Bulk(p_queue, p_element, 1u);
+}
+
+
+
+uint32_t PSP_Ring_MPMC_Enqueue_Bulk(PSP_Ring_MPMC_t * p_queue, const void * p_elements, uint32_t num_elements)
+{
+    uint32_t position;
+    uint32_t count;
+
+    if (num_elements == 0u)
+    {
+        return 0u;
+    }
+
+    while (1)
+    {
+        int32_t lap = 0;
+
+        position = p_queue->enqueue_position;
+        count = 0u;
+
+        // a cell whose sequence is its position is free, behind it is still full from the
+        // last lap, ahead of it another producer has already claimed the position
+        while (count < num_elements)
+        {
+            lap = (int32_t)(*Ring_Cell(p_queue, position + count) - (position + count));
+
+            if (lap != 0)
+            {
+                break;
+            }
+
+            count++;
+        }
+
+        if (count != 0u)
+        {
+            if (Ring_Compare_And_Swap(&p_queue->enqueue_position, position, position + count))
+            {
+                break;
+            }
+        }
+        else if (lap < 0)
+        {
+            return 0u; // full
+        }
+    }
+
+    Ring_Barrier();
+
+    const uint32_t SIZE = p_queue->element_size;
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        memcpy((uint8_t *)Ring_Cell(p_queue, position + i) + RING_CELL_DATA, (const uint8_t *)p_elements + (i * SIZE), SIZE);
+    }
+
+    // the elements land before the sequences that publish them
+    Ring_Barrier();
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        *Ring_Cell(p_queue, position + i) = position + i + 1u;
+    }
+
+    return count;
+}
+
+
+
+uint32_t PSP_Ring_MPMC_Dequeue_Bulk(PSP_Ring_MPMC_t * p_queue, void * p_elements, uint32_t max_elements)
+{
+    uint32_t position;
+    uint32_t count;
+
+    if (max_elements == 0u)
+    {
+        return 0u;
+    }
+
+    while (1)
+    {
+        int32_t lap = 0;
+
+        position = p_queue->dequeue_position;
+        count = 0u;
+
+        // a cell whose sequence is one past its position holds an element, behind that it
+        // hasn't been published yet, ahead of it another consumer has already claimed it
+        while (count < max_elements)
+        {
+            lap = (int32_t)(*Ring_Cell(p_queue, position + count) - (position + count + 1u));
+
+            if (lap != 0)
+            {
+                break;
+            }
+
+            count++;
+        }
+
+        if (count != 0u)
+        {
+            if (Ring_Compare_And_Swap(&p_queue->dequeue_position, position, position + count))
+            {
+                break;
+            }
+        }
+        else if (lap < 0)
+        {
+            return 0u; // empty, or the next element is still being written
+        }
+    }
+
+    // the elements are read after the sequences that published them
+    Ring_Barrier();
+
+    const uint32_t SIZE = p_queue->element_size;
+    const uint32_t CAPACITY = p_queue->capacity;
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        memcpy((uint8_t *)p_elements + (i * SIZE), (const uint8_t *)Ring_Cell(p_queue, position + i) + RING_CELL_DATA, SIZE);
+    }
+
+    // done reading before the cells are handed to the next lap's producers
+    Ring_Barrier();
+
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        *Ring_Cell(p_queue, position + i) = position + i + CAPACITY;
+    }
+
+    return count;
+}
@@ -0,0 +1,364 @@
+/**
+ * DESCRIPTION:
+ *      PSP_Ring provides ring buffers for handing data between an interrupt handler and the
+ *      main loop, or between cores: a wait-free single producer/single consumer ring, and a
+ *      bounded multi producer/multi consumer queue. Both move elements of any size, one at a
+ *      time or in runs with a single index update per run.
+ *
+ * NOTES:
+ *      Capacities are powers of 2, and the indices run freely and wrap at 2^32, so a ring can
+ *      hold all capacity elements. The caller provides the storage. The indices each producer
+ *      and consumer writes are on cache lines of their own, so with the data cache on they
+ *      don't bounce between cores.
+ *
+ *      SPSC: only the producer writes head and only the consumer writes tail, so neither side
+ *      ever waits or retries. A barrier (dmb) orders the element copy before the index that
+ *      publishes it. Each side keeps a copy of the other's index and only rereads it when the
+ *      copy says full (or empty), which keeps the shared cache line mostly still. Bulk pushes
+ *      and pops are at most two memcpys, either side of the wrap.
+ *
+ *      MPMC: each cell carries a sequence number saying whose turn it is (D. Vyukov's bounded
+ *      queue). Producers claim positions with a compare and swap on the enqueue position and
+ *      publish each cell through its sequence, consumers likewise. A producer interrupted
+ *      between claiming and publishing holds up only that cell: consumers see the queue as
+ *      empty there, nobody spins on it, so an interrupt handler can use the queue while main
+ *      is in the middle of it. Bulk operations claim the longest run that is ready, up to the
+ *      number asked for, with one compare and swap.
+ *
+ *      Compare and swap is LDREX/STREX on the Pi 1, and in builds that define PSP_RING_SMP. On
+ *      the Cortex-A cores exclusives only work on cacheable memory, and with the MMU off (as
+ *      it is in this tree) STREX never succeeds. So on the Pi 2 to 4 without PSP_RING_SMP the
+ *      compare and swap is a PSP_IRQ_Disable/PSP_IRQ_Restore critical section instead (and
+ *      shows up in PSP_IRQ's longest masked time). That is atomic against interrupts on the
+ *      calling core and nothing else: it is not lock-free, and the MPMC queue is NOT safe
+ *      between cores in such a build. MPMC is only safe across cores with PSP_RING_SMP
+ *      defined and the queue in cacheable memory, i.e. once the MMU and data cache are on.
+ *      SPSC needs no compare and swap and only relies on the barriers.
+ *
+ *      make test builds this module for the host with PSP_HOST_BUILD, where the barrier and
+ *      compare and swap are GCC's __atomic/__sync builtins, and stress tests both rings with
+ *      threads (tests/Test_Rings.c).
+ *
+ * REFERENCES:
+ *      ARM Architecture Reference Manual ARMv7-A, A3.4 (synchronization and semaphores)
+ *      Bounded MPMC queue: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ */
+
+#ifndef PSP_RING_H_INCLUDED
+#define PSP_RING_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Ring Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define PSP_RING_CACHE_LINE                     64u     // the Cortex-A53/A72 line, a multiple of the others'
+
+// bytes per MPMC cell, a sequence word then the element rounded up to whole words
+#define PSP_RING_MPMC_CELL_SIZE(element_size)   (4u + (((element_size) + 3u) & ~3u))
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Ring Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Ring_SPSC_Type
+{
+    volatile uint32_t head __attribute__((aligned(PSP_RING_CACHE_LINE)));     // producer's
+    uint32_t tail_copy;
+
+    volatile uint32_t tail __attribute__((aligned(PSP_RING_CACHE_LINE)));     // consumer's
+    uint32_t head_copy;
+
+    uint8_t * p_buffer __attribute__((aligned(PSP_RING_CACHE_LINE)));         // set by Init only
+    uint32_t capacity;
+    uint32_t element_size;
+} PSP_Ring_SPSC_t;
+
+
+
+typedef struct Ring_MPMC_Type
+{
+    volatile uint32_t enqueue_position __attribute__((aligned(PSP_RING_CACHE_LINE)));
+    volatile uint32_t dequeue_position __attribute__((aligned(PSP_RING_CACHE_LINE)));
+
+    uint8_t * p_cells __attribute__((aligned(PSP_RING_CACHE_LINE)));          // set by Init only
+    uint32_t capacity;
+    uint32_t element_size;
+    uint32_t cell_size;
+} PSP_Ring_MPMC_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Ring Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_SPSC_Init
+
+Function Description:
+    Set up an empty single producer/single consumer ring.
+
+Inputs:
+    p_ring: the ring
+    p_buffer: capacity * element_size bytes of storage
+    capacity: elements, a power of 2
+    element_size: bytes per element
+
+Returns:
+    uint32_t: 1 on success, 0 if capacity isn't a power of 2 or element_size is 0
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_SPSC_Init(PSP_Ring_SPSC_t * p_ring, void * p_buffer, uint32_t capacity, uint32_t element_size);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_SPSC_Push
+
+Function Description:
+    Producer side: copy an element into the ring.
+
+Inputs:
+    p_ring: the ring
+    p_element: element_size bytes
+
+Returns:
+    uint32_t: 1 if it was pushed, 0 if the ring is full
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_SPSC_Push(PSP_Ring_SPSC_t * p_ring, const void * p_element);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_SPSC_Pop
+
+Function Description:
+    Consumer side: copy the oldest element out of the ring.
+
+Inputs:
+    p_ring: the ring
+    p_element: where to put element_size bytes
+
+Returns:
+    uint32_t: 1 if an element was popped, 0 if the ring is empty
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_SPSC_Pop(PSP_Ring_SPSC_t * p_ring, void * p_element);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_SPSC_Push_Bulk
+
+Function Description:
+    Producer side: copy as many of a run of elements into the ring as fit, publishing them
+    all at once.
+
+Inputs:
+    p_ring: the ring
+    p_elements: num_elements * element_size bytes
+    num_elements: elements to push
+
+Returns:
+    uint32_t: how many were pushed, from the start of the run
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_SPSC_Push_Bulk(PSP_Ring_SPSC_t * p_ring, const void * p_elements, uint32_t num_elements);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_SPSC_Pop_Bulk
+
+Function Description:
+    Consumer side: copy up to max_elements of the oldest elements out of the ring, freeing
+    their space all at once.
+
+Inputs:
+    p_ring: the ring
+    p_elements: room for max_elements * element_size bytes
+    max_elements: most elements to pop
+
+Returns:
+    uint32_t: how many were popped
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_SPSC_Pop_Bulk(PSP_Ring_SPSC_t * p_ring, void * p_elements, uint32_t max_elements);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_SPSC_Count
+
+Function Description:
+    Get how many elements are in the ring. Either side may call it, the answer is only a
+    snapshot to the other.
+
+Inputs:
+    p_ring: the ring
+
+Returns:
+    uint32_t: elements in the ring
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_SPSC_Count(const PSP_Ring_SPSC_t * p_ring);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_MPMC_Init
+
+Function Description:
+    Set up an empty multi producer/multi consumer queue.
+
+Inputs:
+    p_queue: the queue
+    p_cells: capacity * PSP_RING_MPMC_CELL_SIZE(element_size) bytes of word aligned storage
+    capacity: elements, a power of 2, at least 2
+    element_size: bytes per element
+
+Returns:
+    uint32_t: 1 on success, 0 for a bad capacity, element_size or alignment
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_MPMC_Init(PSP_Ring_MPMC_t * p_queue, void * p_cells, uint32_t capacity, uint32_t element_size);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_MPMC_Enqueue
+
+Function Description:
+    Copy an element into the queue. Any core or interrupt handler may call it.
+
+Inputs:
+    p_queue: the queue
+    p_element: element_size bytes
+
+Returns:
+    uint32_t: 1 if it was queued, 0 if the queue is full
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_MPMC_Enqueue(PSP_Ring_MPMC_t * p_queue, const void * p_element);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_MPMC_Dequeue
+
+Function Description:
+    Copy the oldest ready element out of the queue. Any core or interrupt handler may call
+    it.
+
+Inputs:
+    p_queue: the queue
+    p_element: where to put element_size bytes
+
+Returns:
+    uint32_t: 1 if an element was dequeued, 0 if none is ready
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_MPMC_Dequeue(PSP_Ring_MPMC_t * p_queue, void * p_element);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_MPMC_Enqueue_Bulk
+
+Function Description:
+    Queue as many of a run of elements as there are free cells for in a row, claiming them
+    with one compare and swap. The run stays together in the queue.
+
+Inputs:
+    p_queue: the queue
+    p_elements: num_elements * element_size bytes
+    num_elements: elements to queue
+
+Returns:
+    uint32_t: how many were queued, from the start of the run
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_MPMC_Enqueue_Bulk(PSP_Ring_MPMC_t * p_queue, const void * p_elements, uint32_t num_elements);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Ring_MPMC_Dequeue_Bulk
+
+Function Description:
+    Dequeue the longest run of ready elements, up to max_elements, claiming them with one
+    compare and swap.
+
+Inputs:
+    p_queue: the queue
+    p_elements: room for max_elements * element_size bytes
+    max_elements: most elements to dequeue
+
+Returns:
+    uint32_t: how many were dequeued
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Ring_MPMC_Dequeue_Bulk(PSP_Ring_MPMC_t * p_queue, void * p_elements, uint32_t max_elements);
+
+#endif
@@ -1,8 +1,10 @@
 
 #include "PSP_SPI_0.h"
 #include "PSP_GPIO.h"
+#include "PSP_DMA.h"
 
 #include "PSP_REGS.h"
+#include "PSP_Trace.h"
 
 
 /*-----------------------------------------------------------------------------------------------
@@ -54,6 +56,23 @@
 #define SPI_0_CS_CS1        0x00000002u  // Chip Select 1
 #define SPI_0_CS_CS2        0x00000001u  // Chip Select 2
 
+#define SPI_0_MAX_DMA_BYTES 0xFFFFu      // DLEN is 16 bits
+#define SPI_0_DMA_TX_CHANNEL 8u          // see the channel list in PSP_DMA.h
+#define SPI_0_DMA_RX_CHANNEL 9u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_SPI_0 Variables
+ -------------------------------------------------------------------------------------------------*/
+
+// Tx control blocks: the DLEN/CS header word, then the data. Rx control block: drain the Rx FIFO.
+static PSP_DMA_Control_Block_t spi_0_dma_tx_blocks[2];
+static PSP_DMA_Control_Block_t spi_0_dma_rx_block;
+
+static uint32_t spi_0_dma_header_word;
+static uint32_t spi_0_dma_in_progress = 0u;
+
 
 
 /*-----------------------------------------------------------------------------------------------
@@ -176,6 +195,8 @@ void PSP_SPI0_Buffer_Transfer(uint8_t *p_Tx_buffer, uint8_t *p_Rx_buffer, uint32
     uint32_t num_bytes_written = 0u;
     uint32_t num_bytes_read = 0u;
 
+    PSP_TRACE_BEGIN(PSP_Trace_Event_SPI0_Transfer, num_bytes);
+
     // clear the fifo
     PSP_SPI_0_CS_R |= SPI_0_CS_CLEAR1 | SPI_0_CS_CLEAR2;
 
@@ -207,6 +228,8 @@ void PSP_SPI0_Buffer_Transfer(uint8_t *p_Tx_buffer, uint8_t *p_Rx_buffer, uint32
 
     // set transfer active low to end the transfer
     PSP_SPI_0_CS_R &= ~(SPI_0_CS_TA);
+
+    PSP_TRACE_END(PSP_Trace_Event_SPI0_Transfer, num_bytes);
 }
 
 
@@ -215,3 +238,158 @@ void PSP_SPI0_Set_Chip_Select(PSP_SPI_0_Chip_Select_t chip_select)
 {
     PSP_SPI_0_CS_R = (PSP_SPI_0_CS_R & 0xFFFFFFFCu) | chip_select;
 }
+
+
+
+void PSP_SPI0_Set_Mode(PSP_SPI_0_Mode_t mode)
+{
+    // mode bit 1 is CPOL and bit 0 is CPHA, the same order as in the CS register
+    PSP_SPI_0_CS_R = (PSP_SPI_0_CS_R & ~(SPI_0_CS_CPOL | SPI_0_CS_CPHA)) | ((uint32_t)mode << 2u);
+}
+
+
+
+void PSP_SPI0_Write_Buffer(const uint8_t *p_Tx_buffer, uint32_t num_bytes)
+{
+    uint32_t num_bytes_written = 0u;
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_SPI0_Write, num_bytes);
+
+    // clear the fifo
+    PSP_SPI_0_CS_R |= SPI_0_CS_CLEAR1 | SPI_0_CS_CLEAR2;
+
+    // set Transfer Active high to enable transfer
+    PSP_SPI_0_CS_R |= SPI_0_CS_TA;
+
+    while (num_bytes_written < num_bytes)
+    { 
+        // the Tx fifo can accept data and there is data to write
+        while ((PSP_SPI_0_CS_R & SPI_0_CS_TXD) && (num_bytes_written < num_bytes))
+        {
+            PSP_SPI_0_FIFO_R = p_Tx_buffer[num_bytes_written];
+            num_bytes_written++;
+        }
+
+        // the transfer stalls if the Rx fifo fills up, so keep emptying it
+        while (PSP_SPI_0_CS_R & SPI_0_CS_RXD)
+        {
+            (void)PSP_SPI_0_FIFO_R;
+        }
+    }
+
+    while (!(PSP_SPI_0_CS_R & SPI_0_CS_DONE))
+    {
+        // wait for the transfer to complete, still emptying the Rx fifo
+        while (PSP_SPI_0_CS_R & SPI_0_CS_RXD)
+        {
+            (void)PSP_SPI_0_FIFO_R;
+        }
+    }
+
+    // set transfer active low to end the transfer
+    PSP_SPI_0_CS_R &= ~(SPI_0_CS_TA);
+
+    PSP_TRACE_END(PSP_Trace_Event_SPI0_Write, num_bytes);
+}
+
+
+
+/**
+ * DMA transfers as described in section 10.6.3 of the datasheet:
+ * 
+ * 1) set DMAEN and ADCS in the CS register, with TA clear
+ * 2) the Tx DMA channel writes a header word into the FIFO, DLEN in the top 16 bits and 
+ *    CS register bits [7:0] (TA, chip select, CPOL, CPHA) in the bottom 8 bits, which starts
+ *    the transfer, then writes the data a word (4 bytes) at a time
+ * 3) the Rx DMA channel reads the Rx FIFO a word at a time, here straight into the bit bucket,
+ *    when it finishes the transfer is done
+ * 
+ * both channels are paced by the SPI DREQs, so the CPU never has to touch the FIFO
+ */
+void PSP_SPI0_DMA_Write_Start(const uint8_t *p_Tx_buffer, uint32_t num_bytes)
+{
+    if ((num_bytes == 0u) || (SPI_0_MAX_DMA_BYTES < num_bytes))
+    {
+        return; // DLEN can't describe this transfer, do nothing
+    }
+
+    PSP_SPI0_DMA_Wait();
+
+    PSP_TRACE_BEGIN(PSP_Trace_Event_SPI0_DMA_Write, num_bytes);
+
+    const uint32_t NUM_WORDS_IN_BYTES = (num_bytes + 3u) & ~3u;
+    const uint32_t FIFO_BUS_ADDRESS = PSP_DMA_Peripheral_Bus_Address(PSP_SPI_0_FIFO_A);
+
+    // DLEN, then the current chip select/polarity/phase settings with TA set
+    spi_0_dma_header_word = (num_bytes << 16u) | (PSP_SPI_0_CS_R & 0x0000007Fu) | SPI_0_CS_TA;
+
+    spi_0_dma_tx_blocks[0].transfer_info = PSP_DMA_TI_WAIT_RESP | PSP_DMA_TI_DEST_DREQ | PSP_DMA_TI_PERMAP(PSP_DMA_DREQ_SPI_TX);
+    spi_0_dma_tx_blocks[0].source_address = PSP_DMA_Bus_Address(&spi_0_dma_header_word);
+    spi_0_dma_tx_blocks[0].dest_address = FIFO_BUS_ADDRESS;
+    spi_0_dma_tx_blocks[0].transfer_length = sizeof(uint32_t);
+    spi_0_dma_tx_blocks[0].stride = 0u;
+    spi_0_dma_tx_blocks[0].next_control_block = PSP_DMA_Bus_Address(&spi_0_dma_tx_blocks[1]);
+    spi_0_dma_tx_blocks[0].reserved[0] = 0u;
+    spi_0_dma_tx_blocks[0].reserved[1] = 0u;
+
+    spi_0_dma_tx_blocks[1].transfer_info = PSP_DMA_TI_WAIT_RESP | PSP_DMA_TI_SRC_INC | PSP_DMA_TI_DEST_DREQ | PSP_DMA_TI_PERMAP(PSP_DMA_DREQ_SPI_TX);
+    spi_0_dma_tx_blocks[1].source_address = PSP_DMA_Bus_Address(p_Tx_buffer);
+    spi_0_dma_tx_blocks[1].dest_address = FIFO_BUS_ADDRESS;
+    spi_0_dma_tx_blocks[1].transfer_length = NUM_WORDS_IN_BYTES;
+    spi_0_dma_tx_blocks[1].stride = 0u;
+    spi_0_dma_tx_blocks[1].next_control_block = 0u;
+    spi_0_dma_tx_blocks[1].reserved[0] = 0u;
+    spi_0_dma_tx_blocks[1].reserved[1] = 0u;
+
+    spi_0_dma_rx_block.transfer_info = PSP_DMA_TI_SRC_DREQ | PSP_DMA_TI_DEST_IGNORE | PSP_DMA_TI_PERMAP(PSP_DMA_DREQ_SPI_RX);
+    spi_0_dma_rx_block.source_address = FIFO_BUS_ADDRESS;
+    spi_0_dma_rx_block.dest_address = 0u;
+    spi_0_dma_rx_block.transfer_length = NUM_WORDS_IN_BYTES;
+    spi_0_dma_rx_block.stride = 0u;
+    spi_0_dma_rx_block.next_control_block = 0u;
+    spi_0_dma_rx_block.reserved[0] = 0u;
+    spi_0_dma_rx_block.reserved[1] = 0u;
+
+    // clear the fifo, then hand the FIFO over to the DMA, TA stays low until the header word arrives
+    PSP_SPI_0_CS_R = (PSP_SPI_0_CS_R & ~SPI_0_CS_TA) | SPI_0_CS_CLEAR1 | SPI_0_CS_CLEAR2;
+    PSP_SPI_0_CS_R |= SPI_0_CS_DMAEN | SPI_0_CS_ADCS;
+
+    spi_0_dma_in_progress = 1u;
+
+    // start Rx first so it is ready to drain the FIFO as soon as data starts moving
+    PSP_DMA_Channel_Start(SPI_0_DMA_RX_CHANNEL, &spi_0_dma_rx_block);
+    PSP_DMA_Channel_Start(SPI_0_DMA_TX_CHANNEL, &spi_0_dma_tx_blocks[0]);
+}
+
+
+
+uint32_t PSP_SPI0_DMA_Is_Busy(void)
+{
+    // the Rx channel is the last to finish, once it has read every word the transfer is over
+    return spi_0_dma_in_progress && PSP_DMA_Channel_Is_Active(SPI_0_DMA_RX_CHANNEL);
+}
+
+
+
+void PSP_SPI0_DMA_Wait(void)
+{
+    if (!spi_0_dma_in_progress)
+    {
+        return; // nothing to wait for
+    }
+
+    PSP_DMA_Channel_Wait(SPI_0_DMA_RX_CHANNEL);
+    PSP_DMA_Channel_Wait(SPI_0_DMA_TX_CHANNEL);
+
+    while (!(PSP_SPI_0_CS_R & SPI_0_CS_DONE))
+    {
+        // wait for the last bits to leave the shift register
+    }
+
+    // back to polled mode, with TA low and empty fifos
+    PSP_SPI_0_CS_R = (PSP_SPI_0_CS_R & ~(SPI_0_CS_DMAEN | SPI_0_CS_ADCS | SPI_0_CS_TA)) | SPI_0_CS_CLEAR1 | SPI_0_CS_CLEAR2;
+
+    spi_0_dma_in_progress = 0u;
+
+    PSP_TRACE_END(PSP_Trace_Event_SPI0_DMA_Write, 0u);
+}
@@ -7,6 +7,12 @@
  *      I'll need to set up some SPI device to talk back to the Pi and run some
  *      tests. Until then, consider reading data to be broken.
  * 
+ *      Write-only transfers (PSP_SPI0_Write_Buffer and the DMA functions) throw away whatever
+ *      comes back on MISO, which saves supplying an Rx buffer for devices that never talk back,
+ *      such as LED strips and displays.
+ * 
+ *      The DMA functions use DMA channels 8 (Tx) and 9 (Rx).
+ * 
  * REFERENCES:
  *      BCM2837-ARM-Peripherals.pdf page 148
  */
@@ -61,6 +67,15 @@ typedef enum SPI_0_Chip_Select_Type
 } PSP_SPI_0_Chip_Select_t;
 
 
+typedef enum SPI_0_Mode_Type
+{
+    PSP_SPI_0_Mode_0 = 0u, // clock idles low, data sampled on the rising edge
+    PSP_SPI_0_Mode_1 = 1u, // clock idles low, data sampled on the falling edge
+    PSP_SPI_0_Mode_2 = 2u, // clock idles high, data sampled on the falling edge
+    PSP_SPI_0_Mode_3 = 3u  // clock idles high, data sampled on the rising edge
+} PSP_SPI_0_Mode_t;
+
+
 
 /*-----------------------------------------------------------------------------------------------
     Public PSP_SPI_0 Function Declarations
@@ -148,6 +163,8 @@ Inputs:
 
     (note that the fastest three speeds may not work, experimentation needed)
 
+    (speeds are for the 250MHz core clock of the Pi 1 and 3, they double on the Pi 4)
+
 Returns:
     None
 
@@ -251,4 +268,125 @@ void PSP_SPI0_Set_Chip_Select(PSP_SPI_0_Chip_Select_t chip_select);
 
 
 
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_SPI0_Set_Mode
+
+Function Description:
+    Set the clock polarity and phase. SPI 0 starts in mode 0.
+
+Inputs:
+    mode: the SPI mode, 0...3
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_SPI0_Set_Mode(PSP_SPI_0_Mode_t mode);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_SPI0_Write_Buffer
+
+Function Description:
+    Write a given number of bytes via the Tx FIFO, keeping the FIFO topped up for the whole
+    transfer. Whatever is received is discarded.
+
+Inputs:
+    p_Tx_buffer: pointer to the buffer of bytes to write out via SPI 0.
+    num_bytes: the number of bytes to write.
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_SPI0_Write_Buffer(const uint8_t *p_Tx_buffer, uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_SPI0_DMA_Write_Start
+
+Function Description:
+    Start writing a given number of bytes via DMA and return straight away, the transfer runs
+    without the CPU. Whatever is received is discarded. Use PSP_SPI0_DMA_Is_Busy or 
+    PSP_SPI0_DMA_Wait to find out when it's done.
+
+Inputs:
+    p_Tx_buffer: pointer to the buffer of bytes to write out via SPI 0. Must be 4 byte aligned and
+    must not change until the transfer is done. The DMA reads in whole words, so up to 3 bytes 
+    past the end of the buffer are read (but not sent).
+
+    num_bytes: the number of bytes to write, 1 to 65535.
+
+Returns:
+    None
+
+Error Handling:
+    Waits for any previous DMA transfer to finish first.
+
+    Returns without having any effect if num_bytes is 0 or more than 65535.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_SPI0_DMA_Write_Start(const uint8_t *p_Tx_buffer, uint32_t num_bytes);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_SPI0_DMA_Is_Busy
+
+Function Description:
+    Check if a DMA transfer started by PSP_SPI0_DMA_Write_Start is still running.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: 1 if the transfer is still running, 0 if it is done
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_SPI0_DMA_Is_Busy(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_SPI0_DMA_Wait
+
+Function Description:
+    Wait for a DMA transfer started by PSP_SPI0_DMA_Write_Start to finish, then take SPI 0 back
+    out of DMA mode.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    Returns straight away if no DMA transfer was started.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_SPI0_DMA_Wait(void);
+
+
+
 #endif
@@ -1,6 +1,8 @@
 
 #include "PSP_Time.h"
 #include "PSP_REGS.h"
+#include "PSP_Cache.h"
+#include "PSP_Trace.h"
 
 /*-----------------------------------------------------------------------------------------------
     Private PSP_Time Defines
@@ -26,6 +28,34 @@
 #define PSP_Time_C2_R         (*((volatile uint32_t *)PSP_Time_C2_A))  // System Timer Compare 2 register
 #define PSP_Time_C3_R         (*((volatile uint32_t *)PSP_Time_C3_A))  // System Timer Compare 3 register
 
+// System Timer Control/Status Register Masks
+#define TIME_CS_M3            0x00000008u                              // System Timer Match 3
+#define TIME_CS_M2            0x00000004u                              // System Timer Match 2
+#define TIME_CS_M1            0x00000002u                              // System Timer Match 1
+#define TIME_CS_M0            0x00000001u                              // System Timer Match 0
+
+// Cycle Counter Masks
+#if defined(PSP_BOARD_PI1)
+#define TIME_PMNC_ENABLE             0x00000001u                       // ARM1176 PMNC, enable all counters
+#else
+#define TIME_PMCR_ENABLE             0x00000001u                       // PMCR, enable all counters
+#define TIME_PMCR_DIVIDE_BY_64       0x00000008u                       // PMCR, cycle counter counts every 64th cycle
+#define TIME_PMCNTENSET_CYCLES       0x80000000u                       // PMCNTENSET, cycle counter enable
+#endif
+
+#define TIME_CALIBRATION_FIRST_LOOPS 100000u                           // a rough first run, to size the real one
+#define TIME_CALIBRATION_uSec        5000u                             // length of the real run, 1uS of error in 5mS is 0.02%
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Time Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static uint32_t time_loops_per_ms;
+static uint32_t time_cycles_per_ms;
+
+
 
 /*-----------------------------------------------------------------------------------------------
     PSP_Time Function Definitions
@@ -52,8 +82,174 @@ void PSP_Time_Delay_Microseconds(uint32_t delay_time_uSec)
 {
     uint64_t start_time = PSP_Time_Get_Ticks();
 
+    PSP_TRACE_BEGIN(PSP_Trace_Event_CPU_Delay, delay_time_uSec);
+
     while (PSP_Time_Get_Ticks() < (start_time + delay_time_uSec))
     {
         // wait
     }
+
+    PSP_TRACE_END(PSP_Trace_Event_CPU_Delay, delay_time_uSec);
+}
+
+
+
+void PSP_Time_Set_Compare(PSP_Time_Compare_Channel_t channel, uint32_t compare_value)
+{
+    // the compare registers are 4 bytes apart, starting at C0
+    volatile uint32_t * Cn_REG = (volatile uint32_t *)PSP_Time_C0_A + channel;
+
+    // clear the old match first so it can't be mistaken for the new one
+    PSP_Time_Clear_Compare_Match(channel);
+
+    *Cn_REG = compare_value;
+}
+
+
+
+uint32_t PSP_Time_Compare_Matched(PSP_Time_Compare_Channel_t channel)
+{
+    return (PSP_Time_CS_R >> channel) & 1u;
+}
+
+
+
+void PSP_Time_Clear_Compare_Match(PSP_Time_Compare_Channel_t channel)
+{
+    // match flags are cleared by writing a 1, writing 0 to the other flags leaves them alone
+    PSP_Time_CS_R = (TIME_CS_M0 << channel);
+}
+
+
+
+/**
+ * Wait for the System Timer to tick over, returning the new count and the cycle counter just
+ * before the read that saw it.
+ */
+static uint32_t Time_Wait_For_Tick(uint32_t * p_cycles)
+{
+    const uint32_t TICK = PSP_Time_CLO_R;
+    uint32_t now;
+
+    do
+    {
+        *p_cycles = PSP_Time_Get_Cycles();
+        now = PSP_Time_CLO_R;
+    } while (now == TICK);
+
+    return now;
+}
+
+
+
+/**
+ * Time num_loops delay loops in uSec, starting right on a tick so only the end is uncertain.
+ * The cycle counter is timed too, from that tick to the first one after the loops, so it has
+ * no rounding at either end.
+ */
+static uint32_t Time_Measure_Loops(uint32_t num_loops)
+{
+    uint32_t start_cycles;
+    uint32_t end_cycles;
+
+    const uint32_t START_TIME = Time_Wait_For_Tick(&start_cycles);
+
+    PSP_Time_Delay_Loops(num_loops);
+
+    const uint32_t ELAPSED_uSec = PSP_Time_CLO_R - START_TIME;
+    const uint32_t END_TIME = Time_Wait_For_Tick(&end_cycles);
+
+    time_cycles_per_ms = (uint32_t)(((uint64_t)(end_cycles - start_cycles) * 1000u) / (END_TIME - START_TIME));
+
+    return ELAPSED_uSec;
+}
+
+
+
+void PSP_Time_Calibrate_Delay(void)
+{
+    PSP_Cache_Enable_Instruction_Cache();
+    PSP_Time_Enable_Cycle_Counter();
+
+    uint32_t elapsed_uSec = Time_Measure_Loops(TIME_CALIBRATION_FIRST_LOOPS);
+
+    if (elapsed_uSec == 0u)
+    {
+        elapsed_uSec = 1u;
+    }
+
+    uint64_t num_loops = ((uint64_t)TIME_CALIBRATION_FIRST_LOOPS * TIME_CALIBRATION_uSec) / elapsed_uSec;
+
+    if (num_loops > 0xFFFFFFFFu)
+    {
+        num_loops = 0xFFFFFFFFu;
+    }
+
+    elapsed_uSec = Time_Measure_Loops((uint32_t)num_loops);
+
+    time_loops_per_ms = (uint32_t)((num_loops * 1000u) / elapsed_uSec);
+}
+
+
+
+uint32_t PSP_Time_Get_Loops_Per_Millisecond(void)
+{
+    return time_loops_per_ms;
+}
+
+
+
+uint32_t PSP_Time_Nanoseconds_To_Loops(uint32_t delay_time_nSec)
+{
+    if (time_loops_per_ms == 0u)
+    {
+        PSP_Time_Calibrate_Delay();
+    }
+
+    return (uint32_t)((((uint64_t)delay_time_nSec * time_loops_per_ms) + 500000u) / 1000000u);
+}
+
+
+
+void PSP_Time_Delay_Nanoseconds(uint32_t delay_time_nSec)
+{
+    PSP_Time_Delay_Loops(PSP_Time_Nanoseconds_To_Loops(delay_time_nSec));
+}
+
+
+
+void PSP_Time_Enable_Cycle_Counter(void)
+{
+#if defined(PSP_BOARD_PI1)
+    // ARM1176 PMNC: enable the counters, without resetting them
+    __asm__ volatile ("mcr p15, 0, %0, c15, c12, 0" : : "r" (TIME_PMNC_ENABLE));
+#else
+    uint32_t pmcr;
+
+    // PMCR: enable, counting every cycle rather than every 64th, then switch the cycle counter on
+    __asm__ volatile ("mrc p15, 0, %0, c9, c12, 0" : "=r" (pmcr));
+    pmcr = (pmcr | TIME_PMCR_ENABLE) & ~TIME_PMCR_DIVIDE_BY_64;
+    __asm__ volatile ("mcr p15, 0, %0, c9, c12, 0" : : "r" (pmcr));
+    __asm__ volatile ("mcr p15, 0, %0, c9, c12, 1" : : "r" (TIME_PMCNTENSET_CYCLES));
+#endif
+}
+
+
+
+uint32_t PSP_Time_Get_Cycles_Per_Millisecond(void)
+{
+    return time_cycles_per_ms;
+}
+
+
+
+uint32_t PSP_Time_Set_Compare_Synced(PSP_Time_Compare_Channel_t channel, uint32_t delay_time_uSec)
+{
+    uint32_t cycles;
+
+    const uint32_t NOW = Time_Wait_For_Tick(&cycles);
+
+    PSP_Time_Set_Compare(channel, NOW + delay_time_uSec);
+
+    return cycles + (uint32_t)(((uint64_t)delay_time_uSec * time_cycles_per_ms) / 1000u);
 }
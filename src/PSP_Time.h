@@ -7,6 +7,20 @@
  * NOTES:
  *      TODO: Add milliseconds get/delay functions (only has microseconds for now)
  * 
+ *      The System Timer ticks at 1MHz, too coarse for bit-banged buses. For shorter waits
+ *      there is a delay loop calibrated against the System Timer: PSP_Time_Calibrate_Delay
+ *      (run at boot by main) measures how many loops run per millisecond, then
+ *      PSP_Time_Nanoseconds_To_Loops turns a time into a loop count once, up front, and the
+ *      inline PSP_Time_Delay_Loops spins for it. A loop is a subtract and a branch, a CPU
+ *      cycle or two, so the resolution is a few nS. The calibration holds only while the ARM
+ *      clock stays put: the firmware lowers it when the chip is hot or the supply sags, so
+ *      calibrate again if that matters.
+ * 
+ *      The calibration also starts the ARM's cycle counter (the PMU's PMCCNTR, CCNT on the
+ *      ARM1176) and measures it against the System Timer. PSP_Time_Get_Cycles reads it in one
+ *      instruction, for timestamps finer than 1uS. It is 32 bits, so it wraps every few
+ *      seconds, differences of up to that long still come out right.
+ * 
  * REFERENCES:
  *      BCM2837-ARM-Peripherals.pdf page 172
  */
@@ -15,6 +29,20 @@
 #define PSP_TIME_H_INCLUDED
 
 #include "Fixed_Width_Ints.h"
+#include "PSP_REGS.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Time Types
+ -------------------------------------------------------------------------------------------------*/
+
+// compare channels 0 and 2 are used by the GPU, only 1 and 3 are free for the ARM
+typedef enum Time_Compare_Channel_Type
+{
+    PSP_Time_Compare_Channel_1 = 1u,
+    PSP_Time_Compare_Channel_3 = 3u
+} PSP_Time_Compare_Channel_t;
+
+
 
 /*-----------------------------------------------------------------------------------------------
     Public PSP_Time Function Declarations
@@ -67,4 +95,276 @@ Error Handling:
 -------------------------------------------------------------------------------------------------*/
 void PSP_Time_Delay_Microseconds(uint32_t delay_time_uSec);
 
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Set_Compare
+
+Function Description:
+    Clear any pending match on a System Timer compare channel and load a new compare value.
+    The channel matches when the lower 32 bits of the System Timer Counter equal compare_value.
+
+Inputs:
+    channel: the compare channel to use, 1 or 3
+
+    compare_value: the lower 32 bits of the tick count to match on, usually 
+    (uint32_t)PSP_Time_Get_Ticks() + some period in uSec
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Time_Set_Compare(PSP_Time_Compare_Channel_t channel, uint32_t compare_value);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Compare_Matched
+
+Function Description:
+    Check if a System Timer compare channel has matched since it was last set or cleared.
+
+Inputs:
+    channel: the compare channel to check, 1 or 3
+
+Returns:
+    uint32_t: 1 if the channel has matched, 0 if not
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Time_Compare_Matched(PSP_Time_Compare_Channel_t channel);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Clear_Compare_Match
+
+Function Description:
+    Clear the match flag of a System Timer compare channel (this also clears the interrupt
+    request of that channel).
+
+Inputs:
+    channel: the compare channel to clear, 1 or 3
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Time_Clear_Compare_Match(PSP_Time_Compare_Channel_t channel);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Calibrate_Delay
+
+Function Description:
+    Enable the instruction cache (the loop runs at a steady rate only from the cache) and
+    measure PSP_Time_Delay_Loops against the System Timer. Takes about 6 mSec.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Time_Calibrate_Delay(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Get_Loops_Per_Millisecond
+
+Function Description:
+    Get the result of the last PSP_Time_Calibrate_Delay.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: PSP_Time_Delay_Loops loops per millisecond, 0 if never calibrated
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Time_Get_Loops_Per_Millisecond(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Nanoseconds_To_Loops
+
+Function Description:
+    Convert a time to the PSP_Time_Delay_Loops count that takes that long, rounded to the
+    nearest loop. Meant to be done once when setting up, not on every delay.
+
+Inputs:
+    delay_time_nSec: time in nSec
+
+Returns:
+    uint32_t: loop count, can be 0 for very short times
+
+Error Handling:
+    Calibrates first if PSP_Time_Calibrate_Delay has never run.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Time_Nanoseconds_To_Loops(uint32_t delay_time_nSec);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Delay_Nanoseconds
+
+Function Description:
+    Wait for a specified number of nanoseconds, with the calibrated delay loop.
+
+Inputs:
+    delay_time_nSec: time in nSec to wait
+
+Returns:
+    None
+
+Error Handling:
+    The conversion (a 64 bit divide) and the call add their own ~100nS, for anything
+    shorter convert once with PSP_Time_Nanoseconds_To_Loops and use PSP_Time_Delay_Loops.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Time_Delay_Nanoseconds(uint32_t delay_time_nSec);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Enable_Cycle_Counter
+
+Function Description:
+    Start the ARM cycle counter counting every CPU cycle, without resetting it.
+    PSP_Time_Calibrate_Delay does this already.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Time_Enable_Cycle_Counter(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Get_Cycles_Per_Millisecond
+
+Function Description:
+    Get the ARM clock as measured by the last PSP_Time_Calibrate_Delay.
+
+Inputs:
+    None
+
+Returns:
+    uint32_t: cycle counter counts per millisecond, 0 if never calibrated
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Time_Get_Cycles_Per_Millisecond(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Time_Set_Compare_Synced
+
+Function Description:
+    Wait for the next System Timer tick, then set a compare channel to match delay_time_uSec
+    ticks after it, and work out when that will be on the cycle counter. For measuring how
+    long the match takes to be noticed, e.g. interrupt latency. Waits up to 1 uSec.
+
+Inputs:
+    channel: the compare channel to use, 1 or 3
+    delay_time_uSec: ticks from now to the match, at least 2
+
+Returns:
+    uint32_t: the cycle counter value at the match, to within one System Timer read (~50nS)
+
+Error Handling:
+    Needs PSP_Time_Calibrate_Delay to have run.
+
+-------------------------------------------------------------------------------------------------*/
+uint32_t PSP_Time_Set_Compare_Synced(PSP_Time_Compare_Channel_t channel, uint32_t delay_time_uSec);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Time Inline Functions
+ -------------------------------------------------------------------------------------------------*/
+
+/**
+ * Spin for num_loops loops of the calibrated delay loop, see PSP_Time_Nanoseconds_To_Loops.
+ * Written in assembly so that the loop is the same two instructions whatever the compiler
+ * does with the code around it, or the calibration wouldn't carry over.
+ */
+static inline void PSP_Time_Delay_Loops(uint32_t num_loops)
+{
+    if (num_loops != 0u)
+    {
+        __asm__ volatile ("1:  subs %0, %0, #1 \n"
+                          "    bne  1b        \n"
+                          : "+r" (num_loops)
+                          :
+                          : "cc");
+    }
+}
+
+/**
+ * Read the ARM cycle counter, see PSP_Time_Enable_Cycle_Counter.
+ */
+static inline uint32_t PSP_Time_Get_Cycles(void)
+{
+    uint32_t cycles;
+
+#if defined(PSP_BOARD_PI1)
+    __asm__ volatile ("mrc p15, 0, %0, c15, c12, 1" : "=r" (cycles));
+#else
+    __asm__ volatile ("mrc p15, 0, %0, c9, c13, 0" : "=r" (cycles));
+#endif
+
+    return cycles;
+}
+
 #endif
@@ -0,0 +1,213 @@
+#include "PSP_Trace.h"
+#include "PSP_Time.h"
+#include "PSP_Aux_Mini_UART.h"
+#include "Freestanding.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Trace Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#define TRACE_INDEX_MASK        (PSP_TRACE_RING_RECORDS - 1u)
+#define TRACE_CPSR_I            0x00000080u     // CPSR IRQ mask bit
+#define TRACE_MPIDR_CPU_MASK    0x00000003u
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Trace Types
+ -------------------------------------------------------------------------------------------------*/
+
+typedef struct Trace_Ring_Type
+{
+    uint32_t head;          // free running, records ever written
+    PSP_Trace_Record_t records[PSP_TRACE_RING_RECORDS];
+} Trace_Ring_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Private PSP_Trace Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static Trace_Ring_t trace_rings[PSP_TRACE_NUM_CORES];
+
+static volatile uint32_t trace_enabled;
+
+// in PSP_Trace_Event_t order, the first word is the timeline track
+static char * const trace_event_names[PSP_Trace_Event_Count] =
+{
+    "SPI0 transfer",
+    "SPI0 write",
+    "SPI0 DMA write",
+    "I2C0 transfer",
+    "I2C1 transfer",
+    "I2C2 transfer",
+    "CPU wait I2C",
+    "UART send",
+    "DMA start",
+    "CPU wait DMA",
+    "EMMC read",
+    "EMMC write",
+    "CPU wait EMMC",
+    "Mailbox call",
+    "Framebuffer flip",
+    "CPU delay",
+    "IRQ handler",
+    "BSC_Slave transfer",
+    "BSC_Slave publish",
+    "GPIO_Debounce change",
+    "GPIO_Debounce change 32+",
+    "RNG refill",
+    "PWM pacer",
+    "CPU mark"
+};
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    PSP_Trace Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+static inline uint32_t Trace_Core(void)
+{
+#if (PSP_TRACE_NUM_CORES > 1u)
+    uint32_t mpidr;
+
+    __asm__ volatile ("mrc p15, 0, %0, c0, c0, 5" : "=r" (mpidr));
+
+    return mpidr & TRACE_MPIDR_CPU_MASK;
+#else
+    return 0u;
+#endif
+}
+
+
+
+/**
+ * Send value as exactly num_digits upper case hex digits.
+ */
+static void Trace_Send_Hex(uint32_t value, uint32_t num_digits)
+{
+    while (num_digits-- > 0u)
+    {
+        PSP_AUX_Mini_Uart_Send_Byte("0123456789ABCDEF"[(value >> (4u * num_digits)) & 0xFu]);
+    }
+}
+
+
+
+void PSP_Trace_Init(void)
+{
+    trace_enabled = 0u;
+
+    if (PSP_Time_Get_Cycles_Per_Millisecond() == 0u)
+    {
+        PSP_Time_Calibrate_Delay();
+    }
+    else
+    {
+        PSP_Time_Enable_Cycle_Counter();
+    }
+
+    PSP_Trace_Clear();
+
+    trace_enabled = 1u;
+}
+
+
+
+void PSP_Trace_Record(uint32_t event, uint32_t arg)
+{
+    if (!trace_enabled)
+    {
+        return;
+    }
+
+    Trace_Ring_t * const P_RING = &trace_rings[Trace_Core()];
+    uint32_t cpsr;
+
+    // an interrupt between taking the slot and filling it would leave its record out of order
+    __asm__ volatile ("mrs %0, cpsr" : "=r" (cpsr));
+    __asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr | TRACE_CPSR_I) : "memory");
+
+    PSP_Trace_Record_t * const P_RECORD = &P_RING->records[P_RING->head & TRACE_INDEX_MASK];
+
+    P_RECORD->cycles = PSP_Time_Get_Cycles();
+    P_RECORD->event = (uint16_t)event;
+    P_RECORD->arg = (uint16_t)arg;
+    P_RING->head++;
+
+    __asm__ volatile ("msr cpsr_c, %0" : : "r" (cpsr) : "memory");
+}
+
+
+
+void PSP_Trace_Clear(void)
+{
+    const uint32_t WAS_ENABLED = trace_enabled;
+
+    trace_enabled = 0u;
+
+    for (uint32_t core = 0u; core < PSP_TRACE_NUM_CORES; core++)
+    {
+        trace_rings[core].head = 0u;
+    }
+
+    trace_enabled = WAS_ENABLED;
+}
+
+
+
+void PSP_Trace_Dump(void)
+{
+    const uint32_t WAS_ENABLED = trace_enabled;
+
+    // the mini uart is traced too, and would overwrite the records as they were sent
+    trace_enabled = 0u;
+
+    PSP_AUX_Mini_Uart_Send_String("TRACE ");
+    PSP_AUX_Mini_Uart_Send_Decimal(PSP_Time_Get_Cycles_Per_Millisecond());
+    PSP_AUX_Mini_Uart_Send_String(" ");
+    PSP_AUX_Mini_Uart_Send_Decimal(PSP_TRACE_NUM_CORES);
+    PSP_AUX_Mini_Uart_Send_String("\r\n");
+
+    for (uint32_t event = 0u; event < PSP_Trace_Event_Count; event++)
+    {
+        PSP_AUX_Mini_Uart_Send_String("N ");
+        Trace_Send_Hex(event, 4u);
+        PSP_AUX_Mini_Uart_Send_String(" ");
+        PSP_AUX_Mini_Uart_Send_String(trace_event_names[event]);
+        PSP_AUX_Mini_Uart_Send_String("\r\n");
+    }
+
+    for (uint32_t core = 0u; core < PSP_TRACE_NUM_CORES; core++)
+    {
+        const Trace_Ring_t * const P_RING = &trace_rings[core];
+        const uint32_t HEAD = P_RING->head;
+        const uint32_t NUM_RECORDS = (HEAD < PSP_TRACE_RING_RECORDS) ? HEAD : PSP_TRACE_RING_RECORDS;
+
+        PSP_AUX_Mini_Uart_Send_String("C ");
+        Trace_Send_Hex(core, 1u);
+        PSP_AUX_Mini_Uart_Send_String(" ");
+        Trace_Send_Hex(NUM_RECORDS, 8u);
+        PSP_AUX_Mini_Uart_Send_String(" ");
+        Trace_Send_Hex(HEAD - NUM_RECORDS, 8u);
+        PSP_AUX_Mini_Uart_Send_String("\r\n");
+
+        for (uint32_t index = HEAD - NUM_RECORDS; index != HEAD; index++)
+        {
+            const PSP_Trace_Record_t * const P_RECORD = &P_RING->records[index & TRACE_INDEX_MASK];
+
+            Trace_Send_Hex(P_RECORD->cycles, 8u);
+            PSP_AUX_Mini_Uart_Send_String(" ");
+            Trace_Send_Hex(P_RECORD->event, 4u);
+            PSP_AUX_Mini_Uart_Send_String(" ");
+            Trace_Send_Hex(P_RECORD->arg, 4u);
+            PSP_AUX_Mini_Uart_Send_String("\r\n");
+        }
+    }
+
+    PSP_AUX_Mini_Uart_Send_String("END\r\n");
+
+    trace_enabled = WAS_ENABLED;
+}
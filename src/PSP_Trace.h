@@ -0,0 +1,213 @@
+/**
+ * DESCRIPTION:
+ *      PSP_Trace records what the drivers are doing over time: timestamped begin, end and
+ *      instant events written into a ring buffer in RAM, dumped over the mini uart afterwards
+ *      and turned into a Chrome/Perfetto timeline by tools/trace_to_json.py.
+ *
+ * NOTES:
+ *      A record is 8 bytes, {cycle counter, event, arg}. The event's top two bits say whether
+ *      it begins a span, ends one or is an instant, the rest index the PSP_Trace_Event_t list.
+ *      Args are cut to 16 bits (byte counts, bus numbers, results).
+ *
+ *      The trace points in the PSP modules are the PSP_TRACE_* macros, which only exist in
+ *      make TRACE=1 builds, so normal builds don't pay for them at all. In a TRACE=1 build a
+ *      trace point is a call to PSP_Trace_Record: a check, IRQs masked around the 3 stores (an
+ *      interrupt handler may trace too, and LDREX/STREX aren't dependable with the MMU off),
+ *      and a cycle counter read, a few tens of cycles. Nothing is recorded until
+ *      PSP_Trace_Init, or while PSP_Trace_Dump is sending.
+ *
+ *      Each core writes only its own ring, picked by MPIDR, so the cores never contend. Only
+ *      core 0 runs code in this tree, the rest are there for when the others are woken up.
+ *      The rings are flight recorders: once full, new records overwrite the oldest, so a dump
+ *      shows the last PSP_TRACE_RING_RECORDS events, and how many were lost before them.
+ *
+ *      Dump format, everything but the names in hex:
+ *          TRACE <cycles per mSec, decimal> <number of cores, decimal>
+ *          N <event> <name>                        one per event, the track is the first word
+ *          C <core> <records> <records lost>       then that many records, oldest first
+ *          <cycles> <event with phase> <arg>
+ *          END
+ *
+ * REFERENCES:
+ *      Trace Event Format: https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+ */
+
+#ifndef PSP_TRACE_H_INCLUDED
+#define PSP_TRACE_H_INCLUDED
+
+#include "Fixed_Width_Ints.h"
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Trace Defines
+ -------------------------------------------------------------------------------------------------*/
+
+#if defined(PSP_BOARD_PI1)
+#define PSP_TRACE_NUM_CORES             1u
+#else
+#define PSP_TRACE_NUM_CORES             4u
+#endif
+
+#define PSP_TRACE_RING_RECORDS          4096u       // per core, a power of 2
+
+#define PSP_TRACE_PHASE_INSTANT         0x0000u
+#define PSP_TRACE_PHASE_BEGIN           0x4000u
+#define PSP_TRACE_PHASE_END             0x8000u
+#define PSP_TRACE_PHASE_MASK            0xC000u
+#define PSP_TRACE_EVENT_MASK            0x3FFFu
+
+// trace points, compiled in by make TRACE=1
+#if defined(PSP_TRACE_ENABLED)
+#define PSP_TRACE_BEGIN(event, arg)     PSP_Trace_Record(PSP_TRACE_PHASE_BEGIN | (uint32_t)(event), (uint32_t)(arg))
+#define PSP_TRACE_END(event, arg)       PSP_Trace_Record(PSP_TRACE_PHASE_END | (uint32_t)(event), (uint32_t)(arg))
+#define PSP_TRACE_INSTANT(event, arg)   PSP_Trace_Record(PSP_TRACE_PHASE_INSTANT | (uint32_t)(event), (uint32_t)(arg))
+#else
+#define PSP_TRACE_BEGIN(event, arg)     ((void)0)
+#define PSP_TRACE_END(event, arg)       ((void)0)
+#define PSP_TRACE_INSTANT(event, arg)   ((void)0)
+#endif
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Trace Types
+ -------------------------------------------------------------------------------------------------*/
+
+// keep in step with the names in PSP_Trace.c
+typedef enum Trace_Event_Type
+{
+    PSP_Trace_Event_SPI0_Transfer = 0u,     // arg: bytes
+    PSP_Trace_Event_SPI0_Write,             // arg: bytes
+    PSP_Trace_Event_SPI0_DMA_Write,         // arg: bytes
+    PSP_Trace_Event_I2C0_Transfer,          // begin arg: bytes to write and read, end arg: PSP_I2C_Result_t
+    PSP_Trace_Event_I2C1_Transfer,
+    PSP_Trace_Event_I2C2_Transfer,
+    PSP_Trace_Event_CPU_Wait_I2C,           // arg: bus
+    PSP_Trace_Event_UART_Send,              // end arg: bytes
+    PSP_Trace_Event_DMA_Start,              // arg: channel
+    PSP_Trace_Event_CPU_Wait_DMA,           // arg: channel
+    PSP_Trace_Event_EMMC_Read,              // begin arg: blocks, end arg: PSP_EMMC_Result_t
+    PSP_Trace_Event_EMMC_Write,             // begin arg: blocks, end arg: PSP_EMMC_Result_t
+    PSP_Trace_Event_CPU_Wait_EMMC,          // arg: blocks
+    PSP_Trace_Event_Mailbox_Call,           // begin arg: low half of the first tag, end arg: 1 on success
+    PSP_Trace_Event_Framebuffer_Flip,       // arg: page
+    PSP_Trace_Event_CPU_Delay,              // arg: uSec
+    PSP_Trace_Event_IRQ_Handler,            // arg: PSP_IRQ_SOURCE_*
+    PSP_Trace_Event_BSC_Slave_Transfer,     // arg: bytes written by the host
+    PSP_Trace_Event_BSC_Slave_Publish,      // arg: 1 if published
+    PSP_Trace_Event_GPIO_Debounce_Change,   // arg: mask of the pins 0...31 that changed
+    PSP_Trace_Event_GPIO_Debounce_Change_High, // arg: mask of the pins 32...53 that changed, bit 0 is pin 32
+    PSP_Trace_Event_RNG_Refill,             // arg: words
+    PSP_Trace_Event_PWM_Pacer,              // begin arg: range
+    PSP_Trace_Event_CPU_Mark,               // for application code, arg is up to the caller
+    PSP_Trace_Event_Count
+} PSP_Trace_Event_t;
+
+
+
+typedef struct Trace_Record_Type
+{
+    uint32_t cycles;        // PSP_Time_Get_Cycles
+    uint16_t event;         // PSP_TRACE_PHASE_* | PSP_Trace_Event_t
+    uint16_t arg;
+} PSP_Trace_Record_t;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Public PSP_Trace Function Declarations
+ -------------------------------------------------------------------------------------------------*/
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Trace_Init
+
+Function Description:
+    Empty every core's ring, start the cycle counter (calibrating it if that hasn't been done)
+    and start recording.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Trace_Init(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Trace_Record
+
+Function Description:
+    Add a record to the calling core's ring. Normally called through the PSP_TRACE_* macros.
+    Safe from interrupt handlers.
+
+Inputs:
+    event: PSP_TRACE_PHASE_* | PSP_Trace_Event_t
+    arg: kept to 16 bits
+
+Returns:
+    None
+
+Error Handling:
+    Ignored before PSP_Trace_Init and while dumping.
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Trace_Record(uint32_t event, uint32_t arg);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Trace_Clear
+
+Function Description:
+    Empty every core's ring.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Trace_Clear(void);
+
+
+
+/*-----------------------------------------------------------------------------------------------
+
+Function Name:
+    PSP_Trace_Dump
+
+Function Description:
+    Send every core's ring over the mini uart in the format at the top of this file, for
+    tools/trace_to_json.py. Recording pauses while it sends, and the rings are left as they
+    are. The mini uart must be set up.
+
+Inputs:
+    None
+
+Returns:
+    None
+
+Error Handling:
+    None
+
+-------------------------------------------------------------------------------------------------*/
+void PSP_Trace_Dump(void);
+
+#endif
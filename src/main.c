@@ -1,16 +1,48 @@
 
 #include "Hardware_Demos.h"
+#include "Benchmarks.h"
+#include "PSP_Time.h"
 
 int main()
 {
-    // choose one feature to demo by uncommenting one of the demo functions
-    // all demos enter an infinite loop and do not return.
+    // choose one feature to demo by uncommenting one of the demo or benchmark functions
+    // all demos and benchmarks enter an infinite loop and do not return.
+
+    // short delays (PSP_Time_Delay_Loops, the bit-banged buses) are timed against this
+    PSP_Time_Calibrate_Delay();
 
     // demo_GPIO();
+    // demo_GPIO_Debounce();
     // demo_PWM();
     // demo_SPI_0();
     // demo_I2C();
     demo_Mini_Uart();
+    // demo_Logic_Analyzer();
+    // demo_WS2812();
+    // demo_Soft_PWM();
+    // demo_Pattern_Generator();
+    // demo_BSC_Slave();
+
+    // bench_GPIO_Toggle();
+    // bench_Logic_Analyzer();
+    // bench_WS2812();
+    // bench_Pattern_Generator();
+    // bench_RNG();
+    // bench_EMMC();
+    // bench_FAT32();
+    // bench_Framebuffer();
+    // bench_TFT();
+    // bench_I2C();
+    // bench_Bit_Bang();
+    // bench_IRQ_Latency();
+    // bench_Trace();
+    // bench_Profiler();
+    // bench_Rings();
+    // bench_Memory();
+    // bench_DSP();
+    // bench_FFT();
+    // bench_CRC();
+    // bench_Telemetry();
 
     return 0;
 }
@@ -4,7 +4,17 @@
  *      main c function.
  * 
  * NOTES:
- *      None.
+ *      The .bss section is NOLOAD, so it is whatever was left in RAM when the firmware
+ *      loaded kernel.img. It is zeroed here, so C globals without an initializer (and 
+ *      those initialized to 0) really do start at 0.
+ *
+ *      The VFP/NEON unit is switched on before any C runs: full access to coprocessors 10
+ *      and 11 in CPACR, then FPEXC.EN. With it off, the first floating point or NEON
+ *      instruction (which GCC emits for vector types with make NEON=1) is undefined.
+ *
+ *      The firmware starts ARMv7 cores in HYP mode, where IRQs are taken to HYP mode
+ *      instead of through the usual vectors, so the first thing done is an exception
+ *      return to SVC mode with IRQs and FIQs masked. Earlier cores already start in SVC.
  * 
  * REFERENCES:
  *      None
@@ -15,7 +25,40 @@
 .global _start
 
 _start:
+// drop from HYP to SVC mode, IRQs and FIQs masked
+mrs     r0,     cpsr
+and     r1,     r0,     #0x1F
+cmp     r1,     #0x1A
+bne     in_svc_mode
+bic     r0,     r0,     #0x1F
+orr     r0,     r0,     #0xD3
+msr     spsr_cxsf,      r0
+ldr     r0,     =in_svc_mode
+.word   0xE12EF300                                  // msr elr_hyp, r0
+.word   0xE160006E                                  // eret
+
+in_svc_mode:
 mov     sp,     #0x8000
+
+// zero .bss, a word at a time, __bss_start and __bss_end come from linker.ld
+ldr     r0,     =__bss_start
+ldr     r1,     =__bss_end
+mov     r2,     #0
+
+bss_clear_loop:
+cmp     r0,     r1
+strlo   r2,     [r0],   #4
+blo     bss_clear_loop
+
+// enable VFP/NEON, CPACR full access for cp10 and cp11, then FPEXC.EN
+mrc     p15,    0,      r0,     c1,     c0,     2
+orr     r0,     r0,     #(0xF << 20)
+mcr     p15,    0,      r0,     c1,     c0,     2
+mov     r0,     #0
+mcr     p15,    0,      r0,     c7,     c5,     4   // prefetch flush, so the CPACR change is seen
+mov     r0,     #0x40000000
+.word   0xEEE80A10                                  // vmsr fpexc, r0 (spelt out, the default -mfpu may not know it)
+
 bl      main
 
 empty_loop:
@@ -0,0 +1,205 @@
+#include "Host_EMMC.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+/*-----------------------------------------------------------------------------------------------
+    Private Host_EMMC Variables
+ -------------------------------------------------------------------------------------------------*/
+
+static FILE * host_emmc_file;
+static uint32_t host_emmc_num_blocks;
+
+static PSP_EMMC_Request_t * host_emmc_queue_head;
+static PSP_EMMC_Request_t * host_emmc_queue_tail;
+static uint32_t host_emmc_num_queued;
+
+static Host_EMMC_Stats_t host_emmc_stats;
+
+
+
+/*-----------------------------------------------------------------------------------------------
+    Host_EMMC Function Definitions
+ -------------------------------------------------------------------------------------------------*/
+
+uint32_t Host_EMMC_Open(const char * p_path)
+{
+    Host_EMMC_Close();
+
+    host_emmc_file = fopen(p_path, "r+b");
+
+    if (host_emmc_file == 0)
+    {
+        return 0u;
+    }
+
+    fseek(host_emmc_file, 0, SEEK_END);
+    host_emmc_num_blocks = (uint32_t)(ftell(host_emmc_file) / PSP_EMMC_BLOCK_SIZE);
+
+    host_emmc_stats = (Host_EMMC_Stats_t){ 0u };
+
+    return 1u;
+}
+
+
+
+void Host_EMMC_Close(void)
+{
+    if (host_emmc_file != 0)
+    {
+        fclose(host_emmc_file);
+    }
+
+    host_emmc_file = 0;
+    host_emmc_num_blocks = 0u;
+    host_emmc_queue_head = 0;
+    host_emmc_queue_tail = 0;
+    host_emmc_num_queued = 0u;
+}
+
+
+
+void Host_EMMC_Get_Stats(Host_EMMC_Stats_t * p_stats)
+{
+    *p_stats = host_emmc_stats;
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Init(void)
+{
+    return (host_emmc_file != 0) ? PSP_EMMC_Result_OK : PSP_EMMC_Result_No_Card;
+}
+
+
+
+uint32_t PSP_EMMC_Get_Num_Blocks(void)
+{
+    return host_emmc_num_blocks;
+}
+
+
+
+uint32_t PSP_EMMC_Get_Bus_Clock_Hz(void)
+{
+    return 50000000u;
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Submit(PSP_EMMC_Request_t * p_request)
+{
+    // the same checks as the real one, alignment included
+    if ((host_emmc_num_blocks == 0u) ||
+        (p_request->num_blocks == 0u) || (PSP_EMMC_MAX_BLOCKS_PER_REQUEST < p_request->num_blocks) ||
+        (host_emmc_num_blocks <= p_request->first_block) || ((host_emmc_num_blocks - p_request->first_block) < p_request->num_blocks) ||
+        ((uintptr_t)p_request->p_buffer & 0x3u))
+    {
+        p_request->result = PSP_EMMC_Result_Bad_Request;
+        return PSP_EMMC_Result_Bad_Request;
+    }
+
+    p_request->p_next = 0;
+    p_request->result = PSP_EMMC_Result_Pending;
+
+    if (host_emmc_queue_tail != 0)
+    {
+        host_emmc_queue_tail->p_next = p_request;
+    }
+    else
+    {
+        host_emmc_queue_head = p_request;
+    }
+
+    host_emmc_queue_tail = p_request;
+    host_emmc_num_queued++;
+
+    host_emmc_stats.num_requests++;
+
+    if (host_emmc_num_queued > host_emmc_stats.most_queued)
+    {
+        host_emmc_stats.most_queued = host_emmc_num_queued;
+    }
+
+    return PSP_EMMC_Result_Pending;
+}
+
+
+
+void PSP_EMMC_Service(void)
+{
+    PSP_EMMC_Request_t * const P_REQUEST = host_emmc_queue_head;
+
+    if (P_REQUEST == 0)
+    {
+        return;
+    }
+
+    host_emmc_queue_head = P_REQUEST->p_next;
+    host_emmc_num_queued--;
+
+    if (host_emmc_queue_head == 0)
+    {
+        host_emmc_queue_tail = 0;
+    }
+
+    const size_t NUM_BYTES = (size_t)P_REQUEST->num_blocks * PSP_EMMC_BLOCK_SIZE;
+    size_t num_done;
+
+    fseek(host_emmc_file, (long)P_REQUEST->first_block * PSP_EMMC_BLOCK_SIZE, SEEK_SET);
+
+    if (P_REQUEST->direction == PSP_EMMC_Direction_Read)
+    {
+        num_done = fread(P_REQUEST->p_buffer, 1u, NUM_BYTES, host_emmc_file);
+        host_emmc_stats.num_blocks_read += P_REQUEST->num_blocks;
+    }
+    else
+    {
+        num_done = fwrite(P_REQUEST->p_buffer, 1u, NUM_BYTES, host_emmc_file);
+        host_emmc_stats.num_blocks_written += P_REQUEST->num_blocks;
+    }
+
+    P_REQUEST->result = (num_done == NUM_BYTES) ? PSP_EMMC_Result_OK : PSP_EMMC_Result_Error;
+}
+
+
+
+uint32_t PSP_EMMC_Is_Idle(void)
+{
+    return (host_emmc_queue_head == 0) ? 1u : 0u;
+}
+
+
+
+static PSP_EMMC_Result_t Host_EMMC_Transfer_And_Wait(PSP_EMMC_Direction_t direction, uint32_t first_block,
+                                                     uint32_t num_blocks, void * p_buffer)
+{
+    PSP_EMMC_Request_t request = { direction, first_block, num_blocks, p_buffer, PSP_EMMC_Result_OK, 0 };
+
+    if (PSP_EMMC_Submit(&request) != PSP_EMMC_Result_Pending)
+    {
+        return request.result;
+    }
+
+    // behind whatever is already queued, as on the Pi
+    while (request.result == PSP_EMMC_Result_Pending)
+    {
+        PSP_EMMC_Service();
+    }
+
+    return request.result;
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Read_Blocks(uint32_t first_block, uint32_t num_blocks, void * p_buffer)
+{
+    return Host_EMMC_Transfer_And_Wait(PSP_EMMC_Direction_Read, first_block, num_blocks, p_buffer);
+}
+
+
+
+PSP_EMMC_Result_t PSP_EMMC_Write_Blocks(uint32_t first_block, uint32_t num_blocks, const void * p_buffer)
+{
+    return Host_EMMC_Transfer_And_Wait(PSP_EMMC_Direction_Write, first_block, num_blocks, (void *)p_buffer);
+}
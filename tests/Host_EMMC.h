@@ -0,0 +1,40 @@
+/**
+ * DESCRIPTION:
+ *      Host_EMMC stands in for PSP_EMMC in the host tests: the "card" is a disk image file,
+ *      such as one made by tools/fat32_image.py.
+ *
+ * NOTES:
+ *      Requests queue up just as on the Pi and PSP_EMMC_Service finishes one per call, so
+ *      requests stay pending for a while and read-ahead really does run ahead of the reader.
+ *      Writes go straight to the file.
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#ifndef HOST_EMMC_H_INCLUDED
+#define HOST_EMMC_H_INCLUDED
+
+#include "PSP_EMMC.h"
+
+typedef struct Host_EMMC_Stats_Type
+{
+    uint32_t num_requests;          // submitted, including those from Read_Blocks/Write_Blocks
+    uint32_t num_blocks_read;
+    uint32_t num_blocks_written;
+    uint32_t most_queued;           // the longest the queue got
+} Host_EMMC_Stats_t;
+
+
+
+/**
+ * Use the image at p_path as the card, as if PSP_EMMC_Init had found it. Returns 1 if it
+ * could be opened for reading and writing.
+ */
+uint32_t Host_EMMC_Open(const char * p_path);
+
+void Host_EMMC_Close(void);
+
+void Host_EMMC_Get_Stats(Host_EMMC_Stats_t * p_stats);
+
+#endif
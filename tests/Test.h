@@ -0,0 +1,48 @@
+/**
+ * DESCRIPTION:
+ *      Test provides the checks shared by the host tests in this directory, which build the
+ *      portable modules in src/ with the host's own compiler (make test).
+ *
+ * NOTES:
+ *      A failed TEST_CHECK prints where it was and carries on, so one run shows every
+ *      failure. Test_Finish prints the total and gives the exit code for main.
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#ifndef TEST_H_INCLUDED
+#define TEST_H_INCLUDED
+
+#include <stdio.h>
+
+#define TEST_CHECK(condition)   Test_Check((condition) ? 1 : 0, #condition, __FILE__, __LINE__)
+
+static unsigned int test_num_checks;
+static unsigned int test_num_failures;
+
+
+
+static inline int Test_Check(int passed, const char * p_condition, const char * p_file, int line)
+{
+    test_num_checks++;
+
+    if (!passed)
+    {
+        test_num_failures++;
+        printf("%s:%d: FAILED: %s\n", p_file, line, p_condition);
+    }
+
+    return passed;
+}
+
+
+
+static inline int Test_Finish(const char * p_name)
+{
+    printf("%s: %u checks, %u failed\n", p_name, test_num_checks, test_num_failures);
+
+    return (test_num_failures == 0u) ? 0 : 1;
+}
+
+#endif
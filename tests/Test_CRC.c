@@ -0,0 +1,207 @@
+/**
+ * DESCRIPTION:
+ *      Host test of PSP_CRC: CRC-32 and CRC-32C from the slice-by-8 tables against the check
+ *      values and a bit at a time reference, in one go and a block at a time.
+ *
+ * NOTES:
+ *      usage: Test_CRC
+ *
+ *      The host build has no CRC32 instructions (PSP_HOST_BUILD leaves them out), so this
+ *      tests the tables the Pi 1 and Pi 2 use. The instructions are only checked on a Pi 3
+ *      or 4, by bench_CRC.
+ *
+ *      Every length up to TEST_SHORT_LENGTH is run at every alignment, which covers each mix
+ *      of leading bytes, 8 byte steps and trailing bytes, then random lengths and alignments
+ *      up to TEST_BUFFER_SIZE. Streaming splits one message at every offset, and also feeds
+ *      it a byte at a time, and the result must equal the one-shot CRC.
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#include "Test.h"
+#include "PSP_CRC.h"
+
+#define TEST_BUFFER_SIZE        4096u       // bytes of random data
+#define TEST_ALIGNMENTS         8u          // start offsets, one slice-by-8 step
+#define TEST_SHORT_LENGTH       64u         // every length up to here, at every alignment
+#define TEST_NUM_RANDOM         2000u       // random lengths and alignments
+#define TEST_STREAM_LENGTH      300u        // message split at every offset
+#define TEST_STREAM_ALIGNMENT   3u          // so the split blocks start at every alignment
+
+typedef uint32_t (* Test_CRC_Function_t)(uint32_t crc, const void * p_data, uint32_t num_bytes);
+
+typedef struct
+{
+    const char * p_name;
+    Test_CRC_Function_t function;
+    uint32_t polynomial;
+    uint32_t check_value;
+} Test_CRC_t;
+
+static const Test_CRC_t test_crcs[] =
+{
+    { "CRC-32", PSP_CRC_32, PSP_CRC_32_POLYNOMIAL, 0xCBF43926u },
+    { "CRC-32C", PSP_CRC_32C, PSP_CRC_32C_POLYNOMIAL, 0xE3069283u }
+};
+
+static uint32_t test_random_state = 0x12345678u;
+
+static uint8_t test_data[TEST_BUFFER_SIZE + TEST_ALIGNMENTS];
+
+
+
+/**
+ * xorshift32, the same numbers every run.
+ */
+static uint32_t Test_Random(void)
+{
+    test_random_state ^= test_random_state << 13u;
+    test_random_state ^= test_random_state >> 17u;
+    test_random_state ^= test_random_state << 5u;
+
+    return test_random_state;
+}
+
+
+
+/**
+ * A bit at a time, straight from the definition: reflected, start from all 1s, inverted at the end.
+ */
+static uint32_t Test_Bitwise_CRC(uint32_t polynomial, const uint8_t * p_bytes, uint32_t num_bytes)
+{
+    uint32_t crc = 0xFFFFFFFFu;
+
+    for (uint32_t i = 0u; i < num_bytes; i++)
+    {
+        crc ^= p_bytes[i];
+
+        for (uint32_t bit = 0u; bit < 8u; bit++)
+        {
+            crc = (crc >> 1) ^ ((crc & 1u) ? polynomial : 0u);
+        }
+    }
+
+    return ~crc;
+}
+
+
+
+static void Test_Check_Values(const Test_CRC_t * p_crc)
+{
+    static const char CHECK[] = "123456789";
+
+    const uint32_t CRC = p_crc->function(0u, CHECK, sizeof(CHECK) - 1u);
+
+    if (!TEST_CHECK(CRC == p_crc->check_value))
+    {
+        printf("    %s of \"%s\" is 0x%08X, expected 0x%08X\n", p_crc->p_name, CHECK, CRC, p_crc->check_value);
+    }
+
+    if (!TEST_CHECK(p_crc->function(0u, CHECK, 0u) == 0u))
+    {
+        printf("    %s of nothing isn't 0\n", p_crc->p_name);
+    }
+}
+
+
+
+/**
+ * Every short length at every alignment, then random ones, against the bitwise CRC.
+ */
+static void Test_Against_Bitwise(const Test_CRC_t * p_crc)
+{
+    uint32_t num_wrong = 0u;
+    uint32_t first_offset = 0u;
+    uint32_t first_length = 0u;
+
+    for (uint32_t i = 0u; i < ((TEST_ALIGNMENTS * (TEST_SHORT_LENGTH + 1u)) + TEST_NUM_RANDOM); i++)
+    {
+        uint32_t offset = i % TEST_ALIGNMENTS;
+        uint32_t length = i / TEST_ALIGNMENTS;
+
+        if (length > TEST_SHORT_LENGTH)
+        {
+            offset = Test_Random() % TEST_ALIGNMENTS;
+            length = Test_Random() % (TEST_BUFFER_SIZE + 1u);
+        }
+
+        if (p_crc->function(0u, &test_data[offset], length) != Test_Bitwise_CRC(p_crc->polynomial, &test_data[offset], length))
+        {
+            first_offset = (num_wrong == 0u) ? offset : first_offset;
+            first_length = (num_wrong == 0u) ? length : first_length;
+            num_wrong++;
+        }
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    %s: %u blocks differ from the bitwise CRC, the first %u bytes at offset %u\n", p_crc->p_name,
+               num_wrong, first_length, first_offset);
+    }
+}
+
+
+
+/**
+ * One message split in two at every offset, and a byte at a time, against the one-shot CRC.
+ */
+static void Test_Streaming(const Test_CRC_t * p_crc)
+{
+    const uint8_t * const P_MESSAGE = &test_data[TEST_STREAM_ALIGNMENT];
+    const uint32_t ONE_SHOT = p_crc->function(0u, P_MESSAGE, TEST_STREAM_LENGTH);
+    uint32_t num_wrong = 0u;
+    uint32_t first_split = 0u;
+
+    for (uint32_t split = 0u; split <= TEST_STREAM_LENGTH; split++)
+    {
+        uint32_t crc = p_crc->function(0u, P_MESSAGE, split);
+
+        crc = p_crc->function(crc, &P_MESSAGE[split], TEST_STREAM_LENGTH - split);
+
+        if (crc != ONE_SHOT)
+        {
+            first_split = (num_wrong == 0u) ? split : first_split;
+            num_wrong++;
+        }
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    %s: %u splits differ from the one-shot CRC, the first at %u\n", p_crc->p_name, num_wrong, first_split);
+    }
+
+    uint32_t crc = 0u;
+
+    for (uint32_t i = 0u; i < TEST_STREAM_LENGTH; i++)
+    {
+        crc = p_crc->function(crc, &P_MESSAGE[i], 1u);
+    }
+
+    if (!TEST_CHECK(crc == ONE_SHOT))
+    {
+        printf("    %s: a byte at a time gives 0x%08X, one-shot 0x%08X\n", p_crc->p_name, crc, ONE_SHOT);
+    }
+}
+
+
+
+int main(void)
+{
+    for (uint32_t i = 0u; i < sizeof(test_data); i++)
+    {
+        test_data[i] = (uint8_t)(Test_Random() >> 24u);
+    }
+
+    // there are no CRC32 instructions to pick on the host
+    TEST_CHECK(PSP_CRC_Init(1u) == 0u);
+
+    for (uint32_t i = 0u; i < (sizeof(test_crcs) / sizeof(test_crcs[0])); i++)
+    {
+        Test_Check_Values(&test_crcs[i]);
+        Test_Against_Bitwise(&test_crcs[i]);
+        Test_Streaming(&test_crcs[i]);
+    }
+
+    return Test_Finish("Test_CRC");
+}
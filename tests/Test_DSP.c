@@ -0,0 +1,707 @@
+/**
+ * DESCRIPTION:
+ *      Host test of BSP_DSP: every FIR, decimation, interpolation, biquad and moving average
+ *      kernel against its BSP_DSP_Reference_* version.
+ *
+ * NOTES:
+ *      usage: Test_DSP
+ *
+ *      Each kernel filters a TEST_LENGTH sample signal in blocks whose sizes cycle through
+ *      test_block_sizes (1, 3, 5 and 7 leave the 4 lane loops a remainder every time), every
+ *      other block in place where the kernel allows it. The output must match the reference
+ *      run over the whole signal in one go: exactly for Q15 and Q31, to within rounding for
+ *      float.
+ *
+ *      Every kernel gets a random signal and a full scale square wave (-1.0 and just under
+ *      1.0, so Q15 -32768/32767). The Q15 and Q31 filters have gains well over 1, so the
+ *      square wave drives them into saturation, and the test checks that it did.
+ *
+ *      Tap counts include 1 and odd counts either side of a multiple of 4. Taps are random
+ *      and asymmetric, so a kernel that used them in the wrong order would be caught.
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#include "Test.h"
+#include "BSP_DSP.h"
+
+#include <math.h>
+#include <string.h>
+
+#define TEST_LENGTH             2400u       // samples, a multiple of every decimation factor
+#define TEST_MAX_BLOCK_UNITS    200u        // the largest entry in test_block_sizes
+#define TEST_MAX_FACTOR         5u
+#define TEST_MAX_BLOCK          (TEST_MAX_BLOCK_UNITS * TEST_MAX_FACTOR)
+#define TEST_MAX_TAPS           33u
+#define TEST_MAX_STAGES         3u
+#define TEST_MAX_AVERAGE        100u
+#define TEST_LANES              4u          // streams in BSP_DSP_Biquad_F32x4
+#define TEST_SQUARE_HALF_PERIOD 37u         // samples, not a multiple of any block size
+
+#define TEST_F32_TOLERANCE      1e-5f       // of the signal's scale, for the feed forward kernels
+#define TEST_F32_BIQUAD_TOLERANCE 1e-4f     // biquads feed rounding back, and the reference is direct form I
+
+typedef enum
+{
+    Test_Signal_Random,
+    Test_Signal_Square,
+    Test_Signal_Count
+} Test_Signal_t;
+
+static const char * const test_signal_names[Test_Signal_Count] = { "random", "square" };
+
+static const uint32_t test_block_sizes[] = { 1u, 3u, 5u, 7u, 64u, 200u, 2u, 13u };
+
+static uint32_t test_random_state = 0x12345678u;
+
+static int16_t test_q15_in[Test_Signal_Count][TEST_LENGTH];
+static int32_t test_q31_in[Test_Signal_Count][TEST_LENGTH];
+static float test_f32_in[Test_Signal_Count][TEST_LENGTH];
+
+static int16_t test_q15_out[TEST_LENGTH * TEST_MAX_FACTOR];
+static int16_t test_q15_expected[TEST_LENGTH * TEST_MAX_FACTOR];
+static int32_t test_q31_out[TEST_LENGTH];
+static int32_t test_q31_expected[TEST_LENGTH];
+static float test_f32_out[TEST_LENGTH * TEST_MAX_FACTOR];
+static float test_f32_expected[TEST_LENGTH * TEST_MAX_FACTOR];
+
+static int16_t test_q15_state[BSP_DSP_FIR_STATE_SIZE(TEST_MAX_TAPS, TEST_MAX_BLOCK)];
+static int32_t test_q31_state[BSP_DSP_FIR_STATE_SIZE(TEST_MAX_TAPS, TEST_MAX_BLOCK)];
+static float test_f32_state[BSP_DSP_FIR_STATE_SIZE(TEST_MAX_TAPS, TEST_MAX_BLOCK)];
+
+
+
+/**
+ * xorshift32, the same numbers every run.
+ */
+static uint32_t Test_Random(void)
+{
+    test_random_state ^= test_random_state << 13u;
+    test_random_state ^= test_random_state >> 17u;
+    test_random_state ^= test_random_state << 5u;
+
+    return test_random_state;
+}
+
+
+
+/**
+ * Uniform in [minimum, maximum).
+ */
+static float Test_Random_Float(float minimum, float maximum)
+{
+    return minimum + ((maximum - minimum) * (float)(Test_Random() >> 8u) / 16777216.0f);
+}
+
+
+
+static int16_t Test_To_Q15(float value)
+{
+    const float SCALED = roundf(value * 32768.0f);
+
+    return (int16_t)((SCALED > 32767.0f) ? 32767.0f : ((SCALED < -32768.0f) ? -32768.0f : SCALED));
+}
+
+
+
+static int32_t Test_To_Q(double value, double one)
+{
+    const double SCALED = round(value * one);
+
+    return (int32_t)((SCALED > 2147483647.0) ? 2147483647.0 : ((SCALED < -2147483648.0) ? -2147483648.0 : SCALED));
+}
+
+
+
+/**
+ * The test signals, the same in every format.
+ */
+static void Test_Make_Signals(void)
+{
+    for (uint32_t i = 0u; i < TEST_LENGTH; i++)
+    {
+        const int32_t RANDOM = (int32_t)Test_Random();
+
+        const int32_t SQUARE = ((i / TEST_SQUARE_HALF_PERIOD) & 1u) ? INT32_MIN : INT32_MAX;
+
+        test_q31_in[Test_Signal_Random][i] = RANDOM;
+        test_q31_in[Test_Signal_Square][i] = SQUARE;
+        test_q15_in[Test_Signal_Random][i] = (int16_t)(RANDOM >> 16);
+        test_q15_in[Test_Signal_Square][i] = (int16_t)(SQUARE >> 16);
+
+        for (uint32_t signal = 0u; signal < Test_Signal_Count; signal++)
+        {
+            test_f32_in[signal][i] = (float)test_q15_in[signal][i] / 32768.0f;
+        }
+    }
+}
+
+
+
+/**
+ * The F32x4 input for a signal, {lane 0, 1, 2, 3, lane 0, ...}, into p_interleaved. Every
+ * lane is a different stream: lane k is the signal k samples on, times 1 - k / 8.
+ */
+static void Test_Interleave(uint32_t signal, float * p_interleaved)
+{
+    for (uint32_t n = 0u; n < TEST_LENGTH; n++)
+    {
+        for (uint32_t lane = 0u; lane < TEST_LANES; lane++)
+        {
+            const float SAMPLE = test_f32_in[signal][(n + lane) % TEST_LENGTH];
+
+            p_interleaved[(n * TEST_LANES) + lane] = SAMPLE * (1.0f - ((float)lane / 8.0f));
+        }
+    }
+}
+
+
+
+/**
+ * Random asymmetric taps, mostly positive, scaled so their magnitudes add up to sum. With
+ * factor over 1, each polyphase branch (taps a multiple of factor apart) is scaled to sum.
+ */
+static void Test_Make_Taps(float * p_taps, uint32_t num_taps, uint32_t factor, float sum)
+{
+    for (uint32_t i = 0u; i < num_taps; i++)
+    {
+        p_taps[i] = Test_Random_Float(-0.3f, 1.0f);
+    }
+
+    for (uint32_t phase = 0u; phase < factor; phase++)
+    {
+        float magnitude = 0.0f;
+
+        for (uint32_t i = phase; i < num_taps; i += factor)
+        {
+            magnitude += fabsf(p_taps[i]);
+        }
+
+        for (uint32_t i = phase; i < num_taps; i += factor)
+        {
+            p_taps[i] *= sum / magnitude;
+
+            // a single Q15 tap can't reach 1.0
+            p_taps[i] = (p_taps[i] > 0.99f) ? 0.99f : p_taps[i];
+        }
+    }
+}
+
+
+
+/**
+ * The size of the next block: units times the next entry in test_block_sizes, or what is left.
+ */
+static uint32_t Test_Next_Block(uint32_t * p_turn, uint32_t left, uint32_t units)
+{
+    const uint32_t SIZE = test_block_sizes[*p_turn % (sizeof(test_block_sizes) / sizeof(test_block_sizes[0]))] * units;
+
+    (*p_turn)++;
+
+    return (SIZE < left) ? SIZE : left;
+}
+
+
+
+static void Test_Compare_Q15(const char * p_what, uint32_t signal, const int16_t * p_out, const int16_t * p_expected, uint32_t num_samples)
+{
+    uint32_t num_wrong = 0u;
+    uint32_t first_wrong = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        if (p_out[i] != p_expected[i])
+        {
+            first_wrong = (num_wrong == 0u) ? i : first_wrong;
+            num_wrong++;
+        }
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    %s, %s: %u of %u wrong, the first [%u] is %d, expected %d\n", p_what, test_signal_names[signal],
+               num_wrong, num_samples, first_wrong, p_out[first_wrong], p_expected[first_wrong]);
+    }
+}
+
+
+
+static void Test_Compare_Q31(const char * p_what, uint32_t signal, const int32_t * p_out, const int32_t * p_expected, uint32_t num_samples)
+{
+    uint32_t num_wrong = 0u;
+    uint32_t first_wrong = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        if (p_out[i] != p_expected[i])
+        {
+            first_wrong = (num_wrong == 0u) ? i : first_wrong;
+            num_wrong++;
+        }
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    %s, %s: %u of %u wrong, the first [%u] is %d, expected %d\n", p_what, test_signal_names[signal],
+               num_wrong, num_samples, first_wrong, p_out[first_wrong], p_expected[first_wrong]);
+    }
+}
+
+
+
+/**
+ * stride and offset pick one lane out of interleaved outputs, 1 and 0 otherwise.
+ */
+static void Test_Compare_F32(const char * p_what, uint32_t signal, const float * p_out, uint32_t stride, uint32_t offset,
+                             const float * p_expected, uint32_t num_samples, float tolerance)
+{
+    uint32_t num_wrong = 0u;
+    uint32_t first_wrong = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        if (!(fabsf(p_out[(i * stride) + offset] - p_expected[i]) <= tolerance))
+        {
+            first_wrong = (num_wrong == 0u) ? i : first_wrong;
+            num_wrong++;
+        }
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    %s, %s: %u of %u out by more than %g, the first [%u] is %g, expected %g\n", p_what,
+               test_signal_names[signal], num_wrong, num_samples, tolerance, first_wrong,
+               p_out[(first_wrong * stride) + offset], p_expected[first_wrong]);
+    }
+}
+
+
+
+/**
+ * Check the square wave really did saturate the reference.
+ */
+static void Test_Check_Saturated(const char * p_what, uint32_t signal, uint32_t num_saturated)
+{
+    if ((signal == Test_Signal_Square) && !TEST_CHECK(num_saturated != 0u))
+    {
+        printf("    %s: the square wave never saturated\n", p_what);
+    }
+}
+
+
+
+static uint32_t Test_Count_Saturated_Q15(const int16_t * p_samples, uint32_t num_samples)
+{
+    uint32_t count = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        count += ((p_samples[i] == INT16_MAX) || (p_samples[i] == INT16_MIN)) ? 1u : 0u;
+    }
+
+    return count;
+}
+
+
+
+static uint32_t Test_Count_Saturated_Q31(const int32_t * p_samples, uint32_t num_samples)
+{
+    uint32_t count = 0u;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        count += ((p_samples[i] == INT32_MAX) || (p_samples[i] == INT32_MIN)) ? 1u : 0u;
+    }
+
+    return count;
+}
+
+
+
+/**
+ * The largest magnitude in a float signal, at least 1, to scale the tolerance by.
+ */
+static float Test_Scale_F32(const float * p_samples, uint32_t num_samples)
+{
+    float scale = 1.0f;
+
+    for (uint32_t i = 0u; i < num_samples; i++)
+    {
+        scale = (fabsf(p_samples[i]) > scale) ? fabsf(p_samples[i]) : scale;
+    }
+
+    return scale;
+}
+
+
+
+static void Test_FIR(uint32_t num_taps)
+{
+    float taps[TEST_MAX_TAPS];
+    int16_t q15_taps[TEST_MAX_TAPS];
+    int32_t q31_taps[TEST_MAX_TAPS];
+    char what[64];
+
+    // Q15 taps must add up to under 2.0, Q31 has 64 bit accumulators and more headroom
+    Test_Make_Taps(taps, num_taps, 1u, 1.9f);
+
+    for (uint32_t i = 0u; i < num_taps; i++)
+    {
+        q15_taps[i] = Test_To_Q15(taps[i]);
+        q31_taps[i] = Test_To_Q(taps[i], 2147483648.0);
+    }
+
+    for (uint32_t signal = 0u; signal < Test_Signal_Count; signal++)
+    {
+        BSP_DSP_FIR_Q15_t fir_q15;
+        BSP_DSP_FIR_Q31_t fir_q31;
+        BSP_DSP_FIR_F32_t fir_f32;
+        uint32_t turn = 0u;
+
+        TEST_CHECK(BSP_DSP_FIR_Q15_Init(&fir_q15, q15_taps, num_taps, test_q15_state, TEST_MAX_BLOCK));
+        TEST_CHECK(BSP_DSP_FIR_Q31_Init(&fir_q31, q31_taps, num_taps, test_q31_state, TEST_MAX_BLOCK));
+        TEST_CHECK(BSP_DSP_FIR_F32_Init(&fir_f32, taps, num_taps, test_f32_state, TEST_MAX_BLOCK));
+
+        // odd blocks run in place on a copy of the input
+        memcpy(test_q15_out, test_q15_in[signal], TEST_LENGTH * sizeof(int16_t));
+        memcpy(test_q31_out, test_q31_in[signal], TEST_LENGTH * sizeof(int32_t));
+        memcpy(test_f32_out, test_f32_in[signal], TEST_LENGTH * sizeof(float));
+
+        for (uint32_t done = 0u; done < TEST_LENGTH; )
+        {
+            const uint32_t IN_PLACE = turn & 1u;
+            const uint32_t COUNT = Test_Next_Block(&turn, TEST_LENGTH - done, 1u);
+
+            BSP_DSP_FIR_Q15(&fir_q15, IN_PLACE ? &test_q15_out[done] : &test_q15_in[signal][done], &test_q15_out[done], COUNT);
+            BSP_DSP_FIR_Q31(&fir_q31, IN_PLACE ? &test_q31_out[done] : &test_q31_in[signal][done], &test_q31_out[done], COUNT);
+            BSP_DSP_FIR_F32(&fir_f32, IN_PLACE ? &test_f32_out[done] : &test_f32_in[signal][done], &test_f32_out[done], COUNT);
+            done += COUNT;
+        }
+
+        snprintf(what, sizeof(what), "FIR Q15, %u taps", num_taps);
+        BSP_DSP_Reference_FIR_Q15(q15_taps, num_taps, test_q15_in[signal], test_q15_expected, TEST_LENGTH);
+        Test_Compare_Q15(what, signal, test_q15_out, test_q15_expected, TEST_LENGTH);
+        Test_Check_Saturated(what, signal, (num_taps > 1u) ? Test_Count_Saturated_Q15(test_q15_expected, TEST_LENGTH) : 1u);
+
+        snprintf(what, sizeof(what), "FIR Q31, %u taps", num_taps);
+        BSP_DSP_Reference_FIR_Q31(q31_taps, num_taps, test_q31_in[signal], test_q31_expected, TEST_LENGTH);
+        Test_Compare_Q31(what, signal, test_q31_out, test_q31_expected, TEST_LENGTH);
+        Test_Check_Saturated(what, signal, (num_taps > 1u) ? Test_Count_Saturated_Q31(test_q31_expected, TEST_LENGTH) : 1u);
+
+        snprintf(what, sizeof(what), "FIR F32, %u taps", num_taps);
+        BSP_DSP_Reference_FIR_F32(taps, num_taps, test_f32_in[signal], test_f32_expected, TEST_LENGTH);
+        Test_Compare_F32(what, signal, test_f32_out, 1u, 0u, test_f32_expected, TEST_LENGTH,
+                         TEST_F32_TOLERANCE * Test_Scale_F32(test_f32_expected, TEST_LENGTH));
+    }
+}
+
+
+
+static void Test_Decimate(uint32_t num_taps, uint32_t factor)
+{
+    float taps[TEST_MAX_TAPS];
+    int16_t q15_taps[TEST_MAX_TAPS];
+    char what[64];
+
+    Test_Make_Taps(taps, num_taps, 1u, 1.9f);
+
+    for (uint32_t i = 0u; i < num_taps; i++)
+    {
+        q15_taps[i] = Test_To_Q15(taps[i]);
+    }
+
+    for (uint32_t signal = 0u; signal < Test_Signal_Count; signal++)
+    {
+        BSP_DSP_Decimate_Q15_t decimate_q15;
+        BSP_DSP_Decimate_F32_t decimate_f32;
+        uint32_t turn = 0u;
+        uint32_t num_q15 = 0u;
+        uint32_t num_f32 = 0u;
+
+        TEST_CHECK(BSP_DSP_Decimate_Q15_Init(&decimate_q15, q15_taps, num_taps, factor, test_q15_state, TEST_MAX_BLOCK));
+        TEST_CHECK(BSP_DSP_Decimate_F32_Init(&decimate_f32, taps, num_taps, factor, test_f32_state, TEST_MAX_BLOCK));
+
+        // a block that isn't a multiple of the factor is refused whole
+        if (factor > 1u)
+        {
+            TEST_CHECK(BSP_DSP_Decimate_Q15(&decimate_q15, test_q15_in[signal], test_q15_out, factor + 1u) == 0u);
+        }
+
+        for (uint32_t done = 0u; done < TEST_LENGTH; )
+        {
+            const uint32_t COUNT = Test_Next_Block(&turn, TEST_LENGTH - done, factor);
+
+            num_q15 += BSP_DSP_Decimate_Q15(&decimate_q15, &test_q15_in[signal][done], &test_q15_out[num_q15], COUNT);
+            num_f32 += BSP_DSP_Decimate_F32(&decimate_f32, &test_f32_in[signal][done], &test_f32_out[num_f32], COUNT);
+            done += COUNT;
+        }
+
+        TEST_CHECK(num_q15 == (TEST_LENGTH / factor));
+        TEST_CHECK(num_f32 == (TEST_LENGTH / factor));
+
+        snprintf(what, sizeof(what), "Decimate Q15, %u taps, by %u", num_taps, factor);
+        BSP_DSP_Reference_Decimate_Q15(q15_taps, num_taps, factor, test_q15_in[signal], test_q15_expected, TEST_LENGTH);
+        Test_Compare_Q15(what, signal, test_q15_out, test_q15_expected, TEST_LENGTH / factor);
+        Test_Check_Saturated(what, signal, Test_Count_Saturated_Q15(test_q15_expected, TEST_LENGTH / factor));
+
+        snprintf(what, sizeof(what), "Decimate F32, %u taps, by %u", num_taps, factor);
+        BSP_DSP_Reference_Decimate_F32(taps, num_taps, factor, test_f32_in[signal], test_f32_expected, TEST_LENGTH);
+        Test_Compare_F32(what, signal, test_f32_out, 1u, 0u, test_f32_expected, TEST_LENGTH / factor,
+                         TEST_F32_TOLERANCE * Test_Scale_F32(test_f32_expected, TEST_LENGTH / factor));
+    }
+}
+
+
+
+static void Test_Interpolate(uint32_t num_taps, uint32_t factor)
+{
+    float taps[TEST_MAX_TAPS];
+    int16_t q15_taps[TEST_MAX_TAPS];
+    char what[64];
+
+    // each output comes from one branch, which carries a gain of about 1.9
+    Test_Make_Taps(taps, num_taps, factor, 1.9f);
+
+    for (uint32_t i = 0u; i < num_taps; i++)
+    {
+        q15_taps[i] = Test_To_Q15(taps[i]);
+    }
+
+    for (uint32_t signal = 0u; signal < Test_Signal_Count; signal++)
+    {
+        BSP_DSP_Interpolate_Q15_t interpolate_q15;
+        BSP_DSP_Interpolate_F32_t interpolate_f32;
+        uint32_t turn = 0u;
+        uint32_t num_q15 = 0u;
+        uint32_t num_f32 = 0u;
+
+        TEST_CHECK(BSP_DSP_Interpolate_Q15_Init(&interpolate_q15, q15_taps, num_taps, factor, test_q15_state, TEST_MAX_BLOCK_UNITS));
+        TEST_CHECK(BSP_DSP_Interpolate_F32_Init(&interpolate_f32, taps, num_taps, factor, test_f32_state, TEST_MAX_BLOCK_UNITS));
+
+        for (uint32_t done = 0u; done < TEST_LENGTH; )
+        {
+            const uint32_t COUNT = Test_Next_Block(&turn, TEST_LENGTH - done, 1u);
+
+            num_q15 += BSP_DSP_Interpolate_Q15(&interpolate_q15, &test_q15_in[signal][done], &test_q15_out[num_q15], COUNT);
+            num_f32 += BSP_DSP_Interpolate_F32(&interpolate_f32, &test_f32_in[signal][done], &test_f32_out[num_f32], COUNT);
+            done += COUNT;
+        }
+
+        TEST_CHECK(num_q15 == (TEST_LENGTH * factor));
+        TEST_CHECK(num_f32 == (TEST_LENGTH * factor));
+
+        snprintf(what, sizeof(what), "Interpolate Q15, %u taps, by %u", num_taps, factor);
+        BSP_DSP_Reference_Interpolate_Q15(q15_taps, num_taps, factor, test_q15_in[signal], test_q15_expected, TEST_LENGTH);
+        Test_Compare_Q15(what, signal, test_q15_out, test_q15_expected, TEST_LENGTH * factor);
+        Test_Check_Saturated(what, signal, Test_Count_Saturated_Q15(test_q15_expected, TEST_LENGTH * factor));
+
+        snprintf(what, sizeof(what), "Interpolate F32, %u taps, by %u", num_taps, factor);
+        BSP_DSP_Reference_Interpolate_F32(taps, num_taps, factor, test_f32_in[signal], test_f32_expected, TEST_LENGTH);
+        Test_Compare_F32(what, signal, test_f32_out, 1u, 0u, test_f32_expected, TEST_LENGTH * factor,
+                         TEST_F32_TOLERANCE * Test_Scale_F32(test_f32_expected, TEST_LENGTH * factor));
+    }
+}
+
+
+
+/**
+ * RBJ cookbook biquads, normalised to a0 = 1: a peaking stage with gain_dB at frequency
+ * (a fraction of the sample rate), or a low pass for gain_dB 0.
+ */
+static void Test_Make_Biquad(double * p_coefficients, double frequency, double q, double gain_dB)
+{
+    const double W = 2.0 * 3.14159265358979323846 * frequency;
+    const double ALPHA = sin(W) / (2.0 * q);
+    const double A = pow(10.0, gain_dB / 40.0);
+    double b[3];
+    double a[3];
+
+    if (gain_dB == 0.0)
+    {
+        b[0] = (1.0 - cos(W)) / 2.0;
+        b[1] = 1.0 - cos(W);
+        b[2] = b[0];
+        a[0] = 1.0 + ALPHA;
+        a[1] = -2.0 * cos(W);
+        a[2] = 1.0 - ALPHA;
+    }
+    else
+    {
+        b[0] = 1.0 + (ALPHA * A);
+        b[1] = -2.0 * cos(W);
+        b[2] = 1.0 - (ALPHA * A);
+        a[0] = 1.0 + (ALPHA / A);
+        a[1] = -2.0 * cos(W);
+        a[2] = 1.0 - (ALPHA / A);
+    }
+
+    p_coefficients[0] = b[0] / a[0];
+    p_coefficients[1] = b[1] / a[0];
+    p_coefficients[2] = b[2] / a[0];
+    p_coefficients[3] = a[1] / a[0];
+    p_coefficients[4] = a[2] / a[0];
+}
+
+
+
+static void Test_Biquad(uint32_t num_stages)
+{
+    double coefficients[TEST_MAX_STAGES * BSP_DSP_BIQUAD_COEFFICIENTS];
+    int32_t q30_coefficients[TEST_MAX_STAGES * BSP_DSP_BIQUAD_COEFFICIENTS];
+    float f32_coefficients[TEST_MAX_STAGES * BSP_DSP_BIQUAD_COEFFICIENTS];
+    int32_t q31_state[BSP_DSP_BIQUAD_Q31_STATE_SIZE(TEST_MAX_STAGES)];
+    float f32_state[BSP_DSP_BIQUAD_F32_STATE_SIZE(TEST_MAX_STAGES)];
+    float f32x4_state[BSP_DSP_BIQUAD_F32X4_STATE_SIZE(TEST_MAX_STAGES)];
+    static float f32x4_in[TEST_LENGTH * TEST_LANES];
+    static float f32x4_out[TEST_LENGTH * TEST_LANES];
+    char what[64];
+
+    // a 12 dB peak first, so the square wave saturates, then low passes
+    for (uint32_t stage = 0u; stage < num_stages; stage++)
+    {
+        Test_Make_Biquad(&coefficients[stage * BSP_DSP_BIQUAD_COEFFICIENTS], (stage == 0u) ? 0.02 : (0.1 * stage),
+                         (stage == 0u) ? 2.0 : 0.7071, (stage == 0u) ? 12.0 : 0.0);
+    }
+
+    for (uint32_t i = 0u; i < (num_stages * BSP_DSP_BIQUAD_COEFFICIENTS); i++)
+    {
+        q30_coefficients[i] = Test_To_Q(coefficients[i], 1073741824.0);
+        f32_coefficients[i] = (float)coefficients[i];
+    }
+
+    for (uint32_t signal = 0u; signal < Test_Signal_Count; signal++)
+    {
+        BSP_DSP_Biquad_Q31_t biquad_q31;
+        BSP_DSP_Biquad_F32_t biquad_f32;
+        BSP_DSP_Biquad_F32_t biquad_f32x4;
+        uint32_t turn = 0u;
+
+        TEST_CHECK(BSP_DSP_Biquad_Q31_Init(&biquad_q31, q30_coefficients, num_stages, q31_state));
+        TEST_CHECK(BSP_DSP_Biquad_F32_Init(&biquad_f32, f32_coefficients, num_stages, f32_state));
+        TEST_CHECK(BSP_DSP_Biquad_F32x4_Init(&biquad_f32x4, f32_coefficients, num_stages, f32x4_state));
+
+        memcpy(test_q31_out, test_q31_in[signal], TEST_LENGTH * sizeof(int32_t));
+        memcpy(test_f32_out, test_f32_in[signal], TEST_LENGTH * sizeof(float));
+        Test_Interleave(signal, f32x4_in);
+        memcpy(f32x4_out, f32x4_in, sizeof(f32x4_out));
+
+        for (uint32_t done = 0u; done < TEST_LENGTH; )
+        {
+            const uint32_t IN_PLACE = turn & 1u;
+            const uint32_t COUNT = Test_Next_Block(&turn, TEST_LENGTH - done, 1u);
+
+            BSP_DSP_Biquad_Q31(&biquad_q31, IN_PLACE ? &test_q31_out[done] : &test_q31_in[signal][done], &test_q31_out[done], COUNT);
+            BSP_DSP_Biquad_F32(&biquad_f32, IN_PLACE ? &test_f32_out[done] : &test_f32_in[signal][done], &test_f32_out[done], COUNT);
+            BSP_DSP_Biquad_F32x4(&biquad_f32x4, IN_PLACE ? &f32x4_out[done * TEST_LANES] : &f32x4_in[done * TEST_LANES],
+                                 &f32x4_out[done * TEST_LANES], COUNT);
+            done += COUNT;
+        }
+
+        snprintf(what, sizeof(what), "Biquad Q31, %u stages", num_stages);
+        BSP_DSP_Reference_Biquad_Q31(q30_coefficients, num_stages, test_q31_in[signal], test_q31_expected, TEST_LENGTH);
+        Test_Compare_Q31(what, signal, test_q31_out, test_q31_expected, TEST_LENGTH);
+        Test_Check_Saturated(what, signal, Test_Count_Saturated_Q31(test_q31_expected, TEST_LENGTH));
+
+        snprintf(what, sizeof(what), "Biquad F32, %u stages", num_stages);
+        BSP_DSP_Reference_Biquad_F32(f32_coefficients, num_stages, test_f32_in[signal], test_f32_expected, TEST_LENGTH);
+        Test_Compare_F32(what, signal, test_f32_out, 1u, 0u, test_f32_expected, TEST_LENGTH,
+                         TEST_F32_BIQUAD_TOLERANCE * Test_Scale_F32(test_f32_expected, TEST_LENGTH));
+
+        // each lane against the reference on its own stream
+        for (uint32_t lane = 0u; lane < TEST_LANES; lane++)
+        {
+            for (uint32_t n = 0u; n < TEST_LENGTH; n++)
+            {
+                test_f32_out[n] = f32x4_in[(n * TEST_LANES) + lane];
+            }
+
+            snprintf(what, sizeof(what), "Biquad F32x4, %u stages, lane %u", num_stages, lane);
+            BSP_DSP_Reference_Biquad_F32(f32_coefficients, num_stages, test_f32_out, test_f32_expected, TEST_LENGTH);
+            Test_Compare_F32(what, signal, f32x4_out, TEST_LANES, lane, test_f32_expected, TEST_LENGTH,
+                             TEST_F32_BIQUAD_TOLERANCE * Test_Scale_F32(test_f32_expected, TEST_LENGTH));
+        }
+    }
+}
+
+
+
+static void Test_Moving_Average(uint32_t length)
+{
+    int16_t q15_history[TEST_MAX_AVERAGE];
+    float f32_history[TEST_MAX_AVERAGE];
+    char what[64];
+
+    for (uint32_t signal = 0u; signal < Test_Signal_Count; signal++)
+    {
+        BSP_DSP_Moving_Average_Q15_t average_q15;
+        BSP_DSP_Moving_Average_F32_t average_f32;
+        uint32_t turn = 0u;
+
+        TEST_CHECK(BSP_DSP_Moving_Average_Q15_Init(&average_q15, q15_history, length));
+        TEST_CHECK(BSP_DSP_Moving_Average_F32_Init(&average_f32, f32_history, length));
+
+        memcpy(test_q15_out, test_q15_in[signal], TEST_LENGTH * sizeof(int16_t));
+        memcpy(test_f32_out, test_f32_in[signal], TEST_LENGTH * sizeof(float));
+
+        for (uint32_t done = 0u; done < TEST_LENGTH; )
+        {
+            const uint32_t IN_PLACE = turn & 1u;
+            const uint32_t COUNT = Test_Next_Block(&turn, TEST_LENGTH - done, 1u);
+
+            BSP_DSP_Moving_Average_Q15(&average_q15, IN_PLACE ? &test_q15_out[done] : &test_q15_in[signal][done], &test_q15_out[done], COUNT);
+            BSP_DSP_Moving_Average_F32(&average_f32, IN_PLACE ? &test_f32_out[done] : &test_f32_in[signal][done], &test_f32_out[done], COUNT);
+            done += COUNT;
+        }
+
+        // an average can't go past its inputs, but the square wave checks the extremes come out
+        // exact, as long as the average fits in a half period
+        snprintf(what, sizeof(what), "Moving average Q15, length %u", length);
+        BSP_DSP_Reference_Moving_Average_Q15(length, test_q15_in[signal], test_q15_expected, TEST_LENGTH);
+        Test_Compare_Q15(what, signal, test_q15_out, test_q15_expected, TEST_LENGTH);
+        Test_Check_Saturated(what, signal, (length <= TEST_SQUARE_HALF_PERIOD) ? Test_Count_Saturated_Q15(test_q15_expected, TEST_LENGTH) : 1u);
+
+        snprintf(what, sizeof(what), "Moving average F32, length %u", length);
+        BSP_DSP_Reference_Moving_Average_F32(length, test_f32_in[signal], test_f32_expected, TEST_LENGTH);
+        Test_Compare_F32(what, signal, test_f32_out, 1u, 0u, test_f32_expected, TEST_LENGTH,
+                         TEST_F32_TOLERANCE * Test_Scale_F32(test_f32_expected, TEST_LENGTH));
+    }
+}
+
+
+
+int main(void)
+{
+    static const uint32_t NUM_TAPS[] = { 1u, 3u, 4u, 7u, 16u, 31u, 33u };
+    static const uint32_t FACTORS[] = { 1u, 2u, 3u, 5u };
+    static const uint32_t AVERAGE_LENGTHS[] = { 1u, 2u, 5u, 16u, 100u };
+
+    Test_Make_Signals();
+
+    for (uint32_t i = 0u; i < (sizeof(NUM_TAPS) / sizeof(NUM_TAPS[0])); i++)
+    {
+        Test_FIR(NUM_TAPS[i]);
+    }
+
+    for (uint32_t i = 0u; i < (sizeof(FACTORS) / sizeof(FACTORS[0])); i++)
+    {
+        Test_Decimate(7u, FACTORS[i]);
+        Test_Decimate(31u, FACTORS[i]);
+
+        // interpolation taps are a multiple of the factor
+        Test_Interpolate(FACTORS[i] * 3u, FACTORS[i]);
+        Test_Interpolate(FACTORS[i] * 5u, FACTORS[i]);
+    }
+
+    for (uint32_t stages = 1u; stages <= TEST_MAX_STAGES; stages++)
+    {
+        Test_Biquad(stages);
+    }
+
+    for (uint32_t i = 0u; i < (sizeof(AVERAGE_LENGTHS) / sizeof(AVERAGE_LENGTHS[0])); i++)
+    {
+        Test_Moving_Average(AVERAGE_LENGTHS[i]);
+    }
+
+    return Test_Finish("Test_DSP");
+}
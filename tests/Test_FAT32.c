@@ -0,0 +1,374 @@
+/**
+ * DESCRIPTION:
+ *      Host test of BSP_FAT32 against a disk image made by tools/fat32_image.py, through the
+ *      file backed PSP_EMMC in Host_EMMC.c.
+ *
+ * NOTES:
+ *      usage: Test_FAT32 <image> <readme> <log out> <fragmented 0|1>
+ *
+ *      The image must hold BENCH.BIN (--bench-kb) and <readme> copied to docs/readme.txt.
+ *      Checks cluster chain reads, the extent table (one extent, or more than
+ *      BSP_FAT32_MAX_EXTENTS for a --fragment image), read-ahead, Read_Direct, Seek, and log
+ *      appends, which are read back after a remount, and that both FAT copies still match.
+ *      The log is also written to <log out> so make test can compare it with what
+ *      tools/fat32_image.py cat reads from the image.
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#include "Test.h"
+#include "Host_EMMC.h"
+#include "BSP_FAT32.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_LOG_LINES      3000u
+#define TEST_MAX_LOG        (TEST_LOG_LINES * 64u)
+
+
+
+/**
+ * The byte at position in BENCH.BIN, whose words count up from 0.
+ */
+static uint8_t Test_Bench_Byte(uint32_t position)
+{
+    return (uint8_t)((position / 4u) >> (8u * (position % 4u)));
+}
+
+
+
+/**
+ * Read all of BENCH.BIN with Read_Direct, checking every byte, and check read-ahead kept
+ * requests queued ahead of the reader.
+ */
+static void Test_Read_Direct(uint32_t fragmented)
+{
+    BSP_FAT32_File_t file;
+    BSP_FAT32_Cache_Stats_t stats;
+    Host_EMMC_Stats_t emmc_stats;
+
+    TEST_CHECK(BSP_FAT32_Open(&file, "BENCH.BIN") == BSP_FAT32_Result_OK);
+    TEST_CHECK(file.size != 0u);
+
+    if (fragmented)
+    {
+        // more fragments than extents, so reads slide the extent window along
+        TEST_CHECK(file.num_extents == BSP_FAT32_MAX_EXTENTS);
+    }
+    else
+    {
+        TEST_CHECK(file.num_extents == 1u);
+    }
+
+    uint32_t position = 0u;
+    uint32_t num_bad = 0u;
+    uint32_t num_reads = 0u;
+    BSP_FAT32_Result_t result;
+
+    while (1)
+    {
+        const uint8_t * p_data = 0;
+        uint32_t num_bytes = 0u;
+
+        result = BSP_FAT32_Read_Direct(&file, &p_data, 0xFFFFFFFFu, &num_bytes);
+
+        if ((result != BSP_FAT32_Result_OK) || (num_bytes == 0u))
+        {
+            break;
+        }
+
+        // never more than one cache line at a time
+        TEST_CHECK(num_bytes <= (BSP_FAT32_LINE_SECTORS * BSP_FAT32_SECTOR_SIZE));
+
+        for (uint32_t i = 0u; i < num_bytes; i++)
+        {
+            num_bad += (p_data[i] != Test_Bench_Byte(position + i)) ? 1u : 0u;
+        }
+
+        position += num_bytes;
+        num_reads++;
+    }
+
+    TEST_CHECK(result == BSP_FAT32_Result_OK);
+    TEST_CHECK(position == file.size);
+    TEST_CHECK(num_bad == 0u);
+    TEST_CHECK(num_reads > 1u);
+
+    BSP_FAT32_Get_Cache_Stats(&stats);
+    Host_EMMC_Get_Stats(&emmc_stats);
+
+    TEST_CHECK(stats.read_aheads > 0u);
+    TEST_CHECK(stats.hits > stats.misses);
+    TEST_CHECK(emmc_stats.most_queued > 1u);
+}
+
+
+
+/**
+ * Seek around BENCH.BIN and read odd sized pieces with the copying read, across line and
+ * cluster boundaries.
+ */
+static void Test_Seek_And_Read(void)
+{
+    static uint8_t buffer[5000];
+    BSP_FAT32_File_t file;
+    uint32_t seed = 12345u;
+    uint32_t num_bad = 0u;
+
+    TEST_CHECK(BSP_FAT32_Open(&file, "bench.bin") == BSP_FAT32_Result_OK);
+
+    for (uint32_t i = 0u; i < 500u; i++)
+    {
+        seed = (seed * 1664525u) + 1013904223u;
+
+        const uint32_t POSITION = seed % file.size;
+        const uint32_t WANTED = 1u + ((seed >> 8) % sizeof(buffer));
+        const uint32_t EXPECTED = ((file.size - POSITION) < WANTED) ? (file.size - POSITION) : WANTED;
+        uint32_t num_read = 0u;
+
+        TEST_CHECK(BSP_FAT32_Seek(&file, POSITION) == BSP_FAT32_Result_OK);
+        TEST_CHECK(BSP_FAT32_Read(&file, buffer, WANTED, &num_read) == BSP_FAT32_Result_OK);
+        TEST_CHECK(num_read == EXPECTED);
+
+        for (uint32_t j = 0u; j < num_read; j++)
+        {
+            num_bad += (buffer[j] != Test_Bench_Byte(POSITION + j)) ? 1u : 0u;
+        }
+    }
+
+    TEST_CHECK(num_bad == 0u);
+
+    // up to the end is fine, past it isn't
+    TEST_CHECK(BSP_FAT32_Seek(&file, file.size) == BSP_FAT32_Result_OK);
+    TEST_CHECK(BSP_FAT32_Seek(&file, file.size + 1u) == BSP_FAT32_Result_Bad_Request);
+}
+
+
+
+/**
+ * Read docs/readme.txt, a file in a directory, and compare it with the host's copy.
+ */
+static void Test_Directory_File(const char * p_readme)
+{
+    static uint8_t expected[1u << 20];
+    static uint8_t buffer[1u << 20];
+    BSP_FAT32_File_t file;
+
+    FILE * const P_FILE = fopen(p_readme, "rb");
+
+    if (!TEST_CHECK(P_FILE != 0))
+    {
+        return;
+    }
+
+    const uint32_t EXPECTED_SIZE = (uint32_t)fread(expected, 1u, sizeof(expected), P_FILE);
+
+    fclose(P_FILE);
+
+    TEST_CHECK(BSP_FAT32_Open(&file, "DOCS/README.TXT") == BSP_FAT32_Result_OK);
+    TEST_CHECK(file.size == EXPECTED_SIZE);
+
+    uint32_t total = 0u;
+    uint32_t num_read;
+
+    // 100 bytes at a time, so reads straddle sectors
+    do
+    {
+        num_read = 0u;
+        TEST_CHECK(BSP_FAT32_Read(&file, &buffer[total], 100u, &num_read) == BSP_FAT32_Result_OK);
+        total += num_read;
+    } while ((num_read != 0u) && (total < sizeof(buffer) - 100u));
+
+    TEST_CHECK(total == EXPECTED_SIZE);
+    TEST_CHECK(memcmp(buffer, expected, EXPECTED_SIZE) == 0);
+
+    TEST_CHECK(BSP_FAT32_Open(&file, "docs/missing.txt") == BSP_FAT32_Result_Not_Found);
+    TEST_CHECK(BSP_FAT32_Open(&file, "nodir/readme.txt") == BSP_FAT32_Result_Not_Found);
+    TEST_CHECK(BSP_FAT32_Open(&file, "docs") == BSP_FAT32_Result_Bad_Request);
+}
+
+
+
+/**
+ * Append to a new log in two sessions, syncing part way, then remount and read it back.
+ * Returns the log's size, its bytes are in p_expected.
+ */
+static uint32_t Test_Log(uint8_t * p_expected)
+{
+    static uint8_t buffer[TEST_MAX_LOG];
+    BSP_FAT32_File_t file;
+    uint32_t size = 0u;
+
+    for (uint32_t session = 0u; session < 2u; session++)
+    {
+        TEST_CHECK(BSP_FAT32_Log_Open(&file, "TEST.LOG") == BSP_FAT32_Result_OK);
+        TEST_CHECK(file.position == size);
+
+        for (uint32_t line = 0u; line < (TEST_LOG_LINES / 2u); line++)
+        {
+            char text[64];
+
+            // lines of different lengths, so appends straddle sectors and clusters anywhere
+            const int LENGTH = snprintf(text, sizeof(text), "session %u line %u %.*s\n", session, line,
+                                        (int)(line % 23u), "abcdefghijklmnopqrstuvw");
+
+            TEST_CHECK(BSP_FAT32_Log_Append(&file, text, (uint32_t)LENGTH) == BSP_FAT32_Result_OK);
+
+            memcpy(&p_expected[size], text, (size_t)LENGTH);
+            size += (uint32_t)LENGTH;
+
+            if (line == 700u)
+            {
+                TEST_CHECK(BSP_FAT32_Log_Sync(&file) == BSP_FAT32_Result_OK);
+            }
+        }
+
+        TEST_CHECK(BSP_FAT32_Log_Sync(&file) == BSP_FAT32_Result_OK);
+    }
+
+    // a log in a directory, which needs a new entry there
+    TEST_CHECK(BSP_FAT32_Log_Open(&file, "docs/app.log") == BSP_FAT32_Result_OK);
+    TEST_CHECK(BSP_FAT32_Log_Append(&file, "hello\n", 6u) == BSP_FAT32_Result_OK);
+    TEST_CHECK(BSP_FAT32_Log_Sync(&file) == BSP_FAT32_Result_OK);
+
+    // reads can't append
+    TEST_CHECK(BSP_FAT32_Open(&file, "TEST.LOG") == BSP_FAT32_Result_OK);
+    TEST_CHECK(BSP_FAT32_Log_Append(&file, "x", 1u) == BSP_FAT32_Result_Bad_Request);
+
+    // from the image, not the cache
+    TEST_CHECK(BSP_FAT32_Mount() == BSP_FAT32_Result_OK);
+    TEST_CHECK(BSP_FAT32_Open(&file, "TEST.LOG") == BSP_FAT32_Result_OK);
+    TEST_CHECK(file.size == size);
+
+    uint32_t num_read = 0u;
+
+    TEST_CHECK(BSP_FAT32_Read(&file, buffer, sizeof(buffer), &num_read) == BSP_FAT32_Result_OK);
+    TEST_CHECK(num_read == size);
+    TEST_CHECK(memcmp(buffer, p_expected, size) == 0);
+
+    TEST_CHECK(BSP_FAT32_Open(&file, "DOCS/APP.LOG") == BSP_FAT32_Result_OK);
+    TEST_CHECK(file.size == 6u);
+
+    return size;
+}
+
+
+
+/**
+ * Little endian fields of a sector.
+ */
+static uint32_t Test_U16(const uint8_t * p_bytes)
+{
+    return (uint32_t)p_bytes[0] | ((uint32_t)p_bytes[1] << 8);
+}
+
+
+
+static uint32_t Test_U32(const uint8_t * p_bytes)
+{
+    return Test_U16(p_bytes) | (Test_U16(&p_bytes[2]) << 16);
+}
+
+
+
+/**
+ * Log_Sync keeps both FATs up to date, so after the appends they must still be the same.
+ */
+static void Test_FAT_Copies(const char * p_image)
+{
+    uint8_t sector[BSP_FAT32_SECTOR_SIZE];
+    uint32_t volume_start = 0u;
+
+    FILE * const P_FILE = fopen(p_image, "rb");
+
+    if (!TEST_CHECK(P_FILE != 0))
+    {
+        return;
+    }
+
+    TEST_CHECK(fread(sector, 1u, sizeof(sector), P_FILE) == sizeof(sector));
+
+    // a volume at sector 0 has a jump and 512 byte sectors, otherwise find the FAT32 partition
+    if (!(((sector[0] == 0xEBu) || (sector[0] == 0xE9u)) && (Test_U16(&sector[11]) == BSP_FAT32_SECTOR_SIZE)))
+    {
+        for (uint32_t i = 0u; i < 4u; i++)
+        {
+            const uint8_t * const P_ENTRY = &sector[0x1BEu + (16u * i)];
+
+            if ((P_ENTRY[4] == 0x0Bu) || (P_ENTRY[4] == 0x0Cu))
+            {
+                volume_start = Test_U32(&P_ENTRY[8]);
+                break;
+            }
+        }
+    }
+
+    fseek(P_FILE, (long)volume_start * BSP_FAT32_SECTOR_SIZE, SEEK_SET);
+    TEST_CHECK(fread(sector, 1u, sizeof(sector), P_FILE) == sizeof(sector));
+
+    const uint32_t RESERVED_SECTORS = Test_U16(&sector[14]);
+    const uint32_t NUM_FATS = sector[16];
+    const uint32_t FAT_BYTES = Test_U32(&sector[36]) * BSP_FAT32_SECTOR_SIZE;
+
+    uint8_t * const P_FATS = malloc((size_t)FAT_BYTES * 2u);
+
+    TEST_CHECK(NUM_FATS == 2u);
+
+    if ((NUM_FATS == 2u) && (P_FATS != 0))
+    {
+        fseek(P_FILE, (long)(volume_start + RESERVED_SECTORS) * BSP_FAT32_SECTOR_SIZE, SEEK_SET);
+        TEST_CHECK(fread(P_FATS, 1u, (size_t)FAT_BYTES * 2u, P_FILE) == (size_t)FAT_BYTES * 2u);
+        TEST_CHECK(memcmp(P_FATS, &P_FATS[FAT_BYTES], FAT_BYTES) == 0);
+    }
+
+    free(P_FATS);
+    fclose(P_FILE);
+}
+
+
+
+int main(int argc, char ** argv)
+{
+    static uint8_t log[TEST_MAX_LOG];
+
+    if (argc != 5)
+    {
+        printf("usage: Test_FAT32 <image> <readme> <log out> <fragmented 0|1>\n");
+        return 2;
+    }
+
+    const uint32_t FRAGMENTED = (uint32_t)atoi(argv[4]);
+
+    if (!TEST_CHECK(Host_EMMC_Open(argv[1])))
+    {
+        return Test_Finish(argv[1]);
+    }
+
+    TEST_CHECK(BSP_FAT32_Mount() == BSP_FAT32_Result_OK);
+
+    Test_Read_Direct(FRAGMENTED);
+    Test_Seek_And_Read();
+    Test_Directory_File(argv[2]);
+
+    const uint32_t LOG_SIZE = Test_Log(log);
+
+    // appending mustn't have touched anything else
+    Test_Seek_And_Read();
+
+    Host_EMMC_Close();
+
+    Test_FAT_Copies(argv[1]);
+
+    FILE * const P_LOG = fopen(argv[3], "wb");
+
+    if (TEST_CHECK(P_LOG != 0))
+    {
+        fwrite(log, 1u, LOG_SIZE, P_LOG);
+        fclose(P_LOG);
+    }
+
+    return Test_Finish(argv[1]);
+}
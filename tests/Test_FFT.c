@@ -0,0 +1,484 @@
+/**
+ * DESCRIPTION:
+ *      Host test of BSP_FFT: the complex and real transforms in Q15 and float at every
+ *      supported size against a DFT done in double, the power spectra, and the windows.
+ *
+ * NOTES:
+ *      usage: Test_FFT
+ *
+ *      Every size from BSP_FFT_MIN_POINTS to BSP_FFT_MAX_POINTS gets two signals. The random
+ *      one is uniform, inside the unit circle for the complex transforms and over the whole
+ *      Q15 range, -32768 included, for the real ones. The full scale one is the worst case
+ *      the header allows: a complex tone on the edge of the unit circle, which puts all of its
+ *      energy in one bin, and a -32768/32767 square wave for the real transforms.
+ *
+ *      The reference DFT works from the same Q15 samples as the transforms, in double with
+ *      the C library's cos and sin, so it shares nothing with BSP_FFT. Float results must be
+ *      within TEST_F32_TOLERANCE of the largest possible output (num_points for these inputs).
+ *      Q15 results must be the reference scaled by 1 / num_points to within the bounds in
+ *      BSP_FFT.h, 2 LSBs for complex and 3 for real, and the largest errors seen are printed.
+ *
+ *      Windows are checked against the periodic formula, coefficient by coefficient, and
+ *      applying one against a plain multiply, at lengths that leave the vector loops a
+ *      remainder.
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#include "Test.h"
+#include "BSP_FFT.h"
+
+#include <math.h>
+#include <string.h>
+
+#define TEST_PI                 3.14159265358979323846
+#define TEST_COMPLEX_LIMIT      23170       // Q15 parts of a random complex sample, 23170 * sqrt(2) < 32768
+#define TEST_TONE_BIN           5u          // bin of the full scale complex tone
+#define TEST_TONE_AMPLITUDE     32767.0     // on the unit circle, as far as Q15 goes
+#define TEST_SQUARE_HALF_PERIOD 37u         // samples, not a factor of any size
+
+#define TEST_F32_TOLERANCE      1e-6        // of num_points, the largest output these inputs can give
+#define TEST_Q15_COMPLEX_ERROR  2.0         // LSBs, see the NOTES in BSP_FFT.h
+#define TEST_Q15_REAL_ERROR     3.0         // LSBs, the real transforms round once more
+#define TEST_WINDOW_TOLERANCE   1e-6        // float window coefficients
+
+typedef enum
+{
+    Test_Signal_Random,
+    Test_Signal_Full_Scale,
+    Test_Signal_Count
+} Test_Signal_t;
+
+static const char * const test_signal_names[Test_Signal_Count] = { "random", "full scale" };
+
+static uint32_t test_random_state = 0x12345678u;
+
+static float test_f32_twiddles[BSP_FFT_TWIDDLE_SIZE(BSP_FFT_MAX_POINTS)];
+static int16_t test_q15_twiddles[BSP_FFT_TWIDDLE_SIZE(BSP_FFT_MAX_POINTS)];
+
+// the cos and sin of 2 pi i / num_points for the size under test
+static double test_cos[BSP_FFT_MAX_POINTS];
+static double test_sin[BSP_FFT_MAX_POINTS];
+
+static int16_t test_q15_in[2u * BSP_FFT_MAX_POINTS];
+static int16_t test_q15_out[2u * BSP_FFT_MAX_POINTS];
+static float test_f32_out[2u * BSP_FFT_MAX_POINTS];
+static float test_f32_reference[2u * BSP_FFT_MAX_POINTS];
+static double test_in[2u * BSP_FFT_MAX_POINTS];
+static double test_expected[2u * BSP_FFT_MAX_POINTS];
+
+static uint32_t test_q15_power[(BSP_FFT_MAX_POINTS / 2u) + 1u];
+static float test_f32_power[(BSP_FFT_MAX_POINTS / 2u) + 1u];
+
+static double test_q15_worst_complex_error;
+static double test_q15_worst_real_error;
+
+
+
+/**
+ * xorshift32, the same numbers every run.
+ */
+static uint32_t Test_Random(void)
+{
+    test_random_state ^= test_random_state << 13u;
+    test_random_state ^= test_random_state >> 17u;
+    test_random_state ^= test_random_state << 5u;
+
+    return test_random_state;
+}
+
+
+
+/**
+ * Uniform in [-limit, limit].
+ */
+static int16_t Test_Random_Q15(int32_t limit)
+{
+    return (int16_t)((int32_t)(Test_Random() % (uint32_t)((2 * limit) + 1)) - limit);
+}
+
+
+
+static void Test_Make_Table(uint32_t num_points)
+{
+    for (uint32_t i = 0u; i < num_points; i++)
+    {
+        test_cos[i] = cos((2.0 * TEST_PI * (double)i) / (double)num_points);
+        test_sin[i] = sin((2.0 * TEST_PI * (double)i) / (double)num_points);
+    }
+}
+
+
+
+/**
+ * X[k] = sum of x[n] * e^(-2 pi i k n / N), interleaved complex in and out.
+ */
+static void Test_DFT(const double * p_in, double * p_out, uint32_t num_points)
+{
+    for (uint32_t k = 0u; k < num_points; k++)
+    {
+        double sum_re = 0.0;
+        double sum_im = 0.0;
+
+        for (uint32_t n = 0u; n < num_points; n++)
+        {
+            const uint32_t INDEX = (k * n) & (num_points - 1u);
+
+            sum_re += (p_in[2u * n] * test_cos[INDEX]) + (p_in[(2u * n) + 1u] * test_sin[INDEX]);
+            sum_im += (p_in[(2u * n) + 1u] * test_cos[INDEX]) - (p_in[2u * n] * test_sin[INDEX]);
+        }
+
+        p_out[2u * k] = sum_re;
+        p_out[(2u * k) + 1u] = sum_im;
+    }
+}
+
+
+
+/**
+ * Pack the first half of a full complex spectrum the way the real transforms do.
+ */
+static void Test_Pack_Real(double * p_spectrum, uint32_t num_points)
+{
+    p_spectrum[1] = p_spectrum[num_points];
+}
+
+
+
+static void Test_Scale(double * p_values, uint32_t num_values, double scale)
+{
+    for (uint32_t i = 0u; i < num_values; i++)
+    {
+        p_values[i] *= scale;
+    }
+}
+
+
+
+static void Test_Compare_F32(const char * p_what, uint32_t num_points, uint32_t signal, const float * p_out,
+                             const double * p_expected, uint32_t num_values)
+{
+    const double TOLERANCE = TEST_F32_TOLERANCE * (double)num_points;
+    uint32_t num_wrong = 0u;
+    uint32_t first_wrong = 0u;
+
+    for (uint32_t i = 0u; i < num_values; i++)
+    {
+        if (!(fabs((double)p_out[i] - p_expected[i]) <= TOLERANCE))
+        {
+            first_wrong = (num_wrong == 0u) ? i : first_wrong;
+            num_wrong++;
+        }
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    %s %u, %s: %u of %u out by more than %g, the first [%u] is %g, expected %g\n", p_what, num_points,
+               test_signal_names[signal], num_wrong, num_values, TOLERANCE, first_wrong, p_out[first_wrong],
+               p_expected[first_wrong]);
+    }
+}
+
+
+
+/**
+ * p_expected is in LSBs, already scaled by 1 / num_points. Keeps the largest error in *p_worst_error.
+ */
+static void Test_Compare_Q15(const char * p_what, uint32_t num_points, uint32_t signal, const int16_t * p_out,
+                             const double * p_expected, uint32_t num_values, double max_error, double * p_worst_error)
+{
+    uint32_t num_wrong = 0u;
+    uint32_t first_wrong = 0u;
+
+    for (uint32_t i = 0u; i < num_values; i++)
+    {
+        const double ERROR = fabs((double)p_out[i] - p_expected[i]);
+
+        *p_worst_error = (ERROR > *p_worst_error) ? ERROR : *p_worst_error;
+
+        if (!(ERROR <= max_error))
+        {
+            first_wrong = (num_wrong == 0u) ? i : first_wrong;
+            num_wrong++;
+        }
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    %s %u, %s: %u of %u out by more than %g LSBs, the first [%u] is %d, expected %.2f\n", p_what,
+               num_points, test_signal_names[signal], num_wrong, num_values, max_error, first_wrong,
+               p_out[first_wrong], p_expected[first_wrong]);
+    }
+}
+
+
+
+/**
+ * The powers of a packed real spectrum: exact for Q15, to float rounding for float.
+ */
+static void Test_Power_Spectra(uint32_t num_points, uint32_t signal)
+{
+    const uint32_t HALF = num_points / 2u;
+    uint32_t num_wrong = 0u;
+
+    BSP_FFT_Q15_Power_Spectrum(test_q15_out, test_q15_power, num_points);
+    BSP_FFT_F32_Power_Spectrum(test_f32_out, test_f32_power, num_points);
+
+    for (uint32_t k = 0u; k <= HALF; k++)
+    {
+        const double Q15_RE = (k == HALF) ? test_q15_out[1] : test_q15_out[2u * k];
+        const double Q15_IM = ((k == 0u) || (k == HALF)) ? 0.0 : test_q15_out[(2u * k) + 1u];
+        const double F32_RE = (k == HALF) ? test_f32_out[1] : test_f32_out[2u * k];
+        const double F32_IM = ((k == 0u) || (k == HALF)) ? 0.0 : test_f32_out[(2u * k) + 1u];
+        const double F32_POWER = (F32_RE * F32_RE) + (F32_IM * F32_IM);
+
+        num_wrong += ((double)test_q15_power[k] != ((Q15_RE * Q15_RE) + (Q15_IM * Q15_IM))) ? 1u : 0u;
+        num_wrong += (fabs((double)test_f32_power[k] - F32_POWER) > (1e-6 * (F32_POWER + 1.0))) ? 1u : 0u;
+    }
+
+    if (!TEST_CHECK(num_wrong == 0u))
+    {
+        printf("    Power spectra %u, %s: %u bins wrong\n", num_points, test_signal_names[signal], num_wrong);
+    }
+}
+
+
+
+static void Test_Complex(const BSP_FFT_F32_t * p_f32, const BSP_FFT_Q15_t * p_q15, uint32_t signal)
+{
+    const uint32_t N = p_f32->num_points;
+
+    for (uint32_t n = 0u; n < N; n++)
+    {
+        if (signal == Test_Signal_Random)
+        {
+            test_q15_in[2u * n] = Test_Random_Q15(TEST_COMPLEX_LIMIT);
+            test_q15_in[(2u * n) + 1u] = Test_Random_Q15(TEST_COMPLEX_LIMIT);
+        }
+        else
+        {
+            const uint32_t INDEX = (TEST_TONE_BIN * n) & (N - 1u);
+
+            test_q15_in[2u * n] = (int16_t)lround(TEST_TONE_AMPLITUDE * test_cos[INDEX]);
+            test_q15_in[(2u * n) + 1u] = (int16_t)lround(TEST_TONE_AMPLITUDE * test_sin[INDEX]);
+        }
+    }
+
+    for (uint32_t i = 0u; i < (2u * N); i++)
+    {
+        test_in[i] = (double)test_q15_in[i] / 32768.0;
+        test_f32_out[i] = (float)test_in[i];
+    }
+
+    Test_DFT(test_in, test_expected, N);
+
+    // the library's own reference, on the same input
+    if (signal == Test_Signal_Random)
+    {
+        BSP_FFT_Reference_DFT_F32(p_f32, test_f32_out, test_f32_reference);
+
+        for (uint32_t i = 0u; i < (2u * N); i++)
+        {
+            test_f32_out[i] = test_f32_reference[i];
+        }
+
+        Test_Compare_F32("Reference DFT F32", N, signal, test_f32_out, test_expected, 2u * N);
+
+        for (uint32_t i = 0u; i < (2u * N); i++)
+        {
+            test_f32_out[i] = (float)test_in[i];
+        }
+    }
+
+    BSP_FFT_F32_Complex(p_f32, test_f32_out);
+    Test_Compare_F32("Complex F32", N, signal, test_f32_out, test_expected, 2u * N);
+
+    memcpy(test_q15_out, test_q15_in, 2u * N * sizeof(int16_t));
+    BSP_FFT_Q15_Complex(p_q15, test_q15_out);
+    Test_Scale(test_expected, 2u * N, 32768.0 / (double)N);
+    Test_Compare_Q15("Complex Q15", N, signal, test_q15_out, test_expected, 2u * N,
+                     TEST_Q15_COMPLEX_ERROR, &test_q15_worst_complex_error);
+
+    // the tone must come out at full scale in its bin, and nowhere else
+    if (signal == Test_Signal_Full_Scale)
+    {
+        TEST_CHECK(test_q15_out[2u * TEST_TONE_BIN] >= (int16_t)(TEST_TONE_AMPLITUDE - TEST_Q15_COMPLEX_ERROR));
+    }
+}
+
+
+
+static void Test_Real(const BSP_FFT_F32_t * p_f32, const BSP_FFT_Q15_t * p_q15, uint32_t signal)
+{
+    const uint32_t N = p_f32->num_points;
+
+    for (uint32_t n = 0u; n < N; n++)
+    {
+        if (signal == Test_Signal_Random)
+        {
+            test_q15_in[n] = (int16_t)(Test_Random() >> 16u);
+        }
+        else
+        {
+            test_q15_in[n] = ((n / TEST_SQUARE_HALF_PERIOD) & 1u) ? INT16_MIN : INT16_MAX;
+        }
+
+        test_in[2u * n] = (double)test_q15_in[n] / 32768.0;
+        test_in[(2u * n) + 1u] = 0.0;
+        test_f32_out[n] = (float)test_in[2u * n];
+    }
+
+    Test_DFT(test_in, test_expected, N);
+    Test_Pack_Real(test_expected, N);
+
+    BSP_FFT_F32_Real(p_f32, test_f32_out);
+    Test_Compare_F32("Real F32", N, signal, test_f32_out, test_expected, N);
+
+    memcpy(test_q15_out, test_q15_in, N * sizeof(int16_t));
+    BSP_FFT_Q15_Real(p_q15, test_q15_out);
+    Test_Scale(test_expected, N, 32768.0 / (double)N);
+    Test_Compare_Q15("Real Q15", N, signal, test_q15_out, test_expected, N,
+                     TEST_Q15_REAL_ERROR, &test_q15_worst_real_error);
+
+    Test_Power_Spectra(N, signal);
+}
+
+
+
+static void Test_Size(uint32_t num_points)
+{
+    BSP_FFT_F32_t fft_f32;
+    BSP_FFT_Q15_t fft_q15;
+
+    if (!TEST_CHECK(BSP_FFT_F32_Init(&fft_f32, num_points, test_f32_twiddles) == 1u) ||
+        !TEST_CHECK(BSP_FFT_Q15_Init(&fft_q15, num_points, test_q15_twiddles) == 1u))
+    {
+        printf("    Init %u: rejected a supported size\n", num_points);
+        return;
+    }
+
+    Test_Make_Table(num_points);
+
+    for (uint32_t signal = 0u; signal < Test_Signal_Count; signal++)
+    {
+        Test_Complex(&fft_f32, &fft_q15, signal);
+        Test_Real(&fft_f32, &fft_q15, signal);
+    }
+}
+
+
+
+/**
+ * Unsupported sizes are refused and leave the twiddle table alone.
+ */
+static void Test_Unsupported_Sizes(void)
+{
+    static const uint32_t SIZES[] = { 0u, 1u, 32u, 48u, 100u, 4095u, 8192u };
+
+    BSP_FFT_F32_t fft_f32;
+    BSP_FFT_Q15_t fft_q15;
+
+    for (uint32_t i = 0u; i < (sizeof(SIZES) / sizeof(SIZES[0])); i++)
+    {
+        test_f32_twiddles[0] = 123.0f;
+        test_q15_twiddles[0] = 123;
+
+        if (!TEST_CHECK(BSP_FFT_F32_Init(&fft_f32, SIZES[i], test_f32_twiddles) == 0u) ||
+            !TEST_CHECK(BSP_FFT_Q15_Init(&fft_q15, SIZES[i], test_q15_twiddles) == 0u) ||
+            !TEST_CHECK((test_f32_twiddles[0] == 123.0f) && (test_q15_twiddles[0] == 123)))
+        {
+            printf("    Init %u: took an unsupported size\n", SIZES[i]);
+        }
+    }
+}
+
+
+
+/**
+ * Each window against a0 - a1 cos(2 pi n / N) + a2 cos(4 pi n / N), the periodic form, and
+ * applying it against a plain multiply.
+ */
+static void Test_Windows(void)
+{
+    static const char * const NAMES[] = { "Hann", "Hamming", "Blackman" };
+    static const double COEFFICIENTS[][3] = { { 0.5, 0.5, 0.0 }, { 0.54, 0.46, 0.0 }, { 0.42, 0.5, 0.08 } };
+    static const uint32_t LENGTHS[] = { 1u, 7u, 64u, 1000u, BSP_FFT_MAX_POINTS };
+
+    static float window_f32[BSP_FFT_MAX_POINTS];
+    static int16_t window_q15[BSP_FFT_MAX_POINTS];
+    static float samples_f32[BSP_FFT_MAX_POINTS];
+    static int16_t samples_q15[BSP_FFT_MAX_POINTS];
+
+    for (uint32_t window = BSP_FFT_Window_Hann; window <= BSP_FFT_Window_Blackman; window++)
+    {
+        for (uint32_t i = 0u; i < (sizeof(LENGTHS) / sizeof(LENGTHS[0])); i++)
+        {
+            const uint32_t N = LENGTHS[i];
+            uint32_t num_wrong = 0u;
+
+            BSP_FFT_F32_Make_Window(window_f32, N, (BSP_FFT_Window_t)window);
+            BSP_FFT_Q15_Make_Window(window_q15, N, (BSP_FFT_Window_t)window);
+
+            for (uint32_t n = 0u; n < N; n++)
+            {
+                const double ANGLE = (2.0 * TEST_PI * (double)n) / (double)N;
+                const double EXPECTED = COEFFICIENTS[window][0] - (COEFFICIENTS[window][1] * cos(ANGLE))
+                                      + (COEFFICIENTS[window][2] * cos(2.0 * ANGLE));
+                const double EXPECTED_Q15 = fmin(round(EXPECTED * 32768.0), 32767.0);
+
+                num_wrong += (fabs((double)window_f32[n] - EXPECTED) > TEST_WINDOW_TOLERANCE) ? 1u : 0u;
+                num_wrong += ((double)window_q15[n] != EXPECTED_Q15) ? 1u : 0u;
+            }
+
+            if (!TEST_CHECK(num_wrong == 0u))
+            {
+                printf("    %s window %u: %u coefficients wrong\n", NAMES[window], N, num_wrong);
+            }
+
+            for (uint32_t n = 0u; n < N; n++)
+            {
+                samples_q15[n] = (n == 0u) ? INT16_MIN : (int16_t)(Test_Random() >> 16u);
+                samples_f32[n] = (float)samples_q15[n] / 32768.0f;
+            }
+
+            memcpy(test_q15_in, samples_q15, N * sizeof(int16_t));
+            BSP_FFT_Q15_Apply_Window(samples_q15, window_q15, N);
+            BSP_FFT_F32_Apply_Window(samples_f32, window_f32, N);
+
+            num_wrong = 0u;
+
+            for (uint32_t n = 0u; n < N; n++)
+            {
+                const int16_t EXPECTED_Q15 = (int16_t)((((int32_t)test_q15_in[n] * window_q15[n]) + 0x4000) >> 15);
+                const float EXPECTED_F32 = ((float)test_q15_in[n] / 32768.0f) * window_f32[n];
+
+                num_wrong += (samples_q15[n] != EXPECTED_Q15) ? 1u : 0u;
+                num_wrong += (samples_f32[n] != EXPECTED_F32) ? 1u : 0u;
+            }
+
+            if (!TEST_CHECK(num_wrong == 0u))
+            {
+                printf("    Apply %s window %u: %u samples wrong\n", NAMES[window], N, num_wrong);
+            }
+        }
+    }
+}
+
+
+
+int main(void)
+{
+    Test_Unsupported_Sizes();
+
+    for (uint32_t num_points = BSP_FFT_MIN_POINTS; num_points <= BSP_FFT_MAX_POINTS; num_points *= 2u)
+    {
+        Test_Size(num_points);
+    }
+
+    Test_Windows();
+
+    printf("Q15 worst error: %.2f LSBs complex, %.2f LSBs real\n", test_q15_worst_complex_error, test_q15_worst_real_error);
+
+    return Test_Finish("Test_FFT");
+}
@@ -0,0 +1,385 @@
+/**
+ * DESCRIPTION:
+ *      Host stress test of PSP_Ring: SPSC and MPMC rings hammered by threads, checking that
+ *      no element is lost, duplicated, reordered or torn, and reporting the throughput.
+ *
+ * NOTES:
+ *      usage: Test_Rings [elements per producer]
+ *
+ *      PSP_HOST_BUILD turns the ring barriers and compare and swap into GCC's __atomic/__sync
+ *      builtins, the ring code itself is what runs on the Pi. Pushes and pops use bulk sizes
+ *      that cycle through 1...TEST_MAX_BULK so runs straddle the wrap in every way. Threads
+ *      yield when their ring is full or empty, so the test also works on a single core, where
+ *      preemption in the middle of an operation is what gets tested.
+ *
+ *      The throughput depends on the host and how many cores it has, it is a sanity check of
+ *      the bulk paths rather than a benchmark (bench_Rings is the one for the Pi).
+ *
+ * REFERENCES:
+ *      None
+ */
+
+#include "Test.h"
+#include "PSP_Ring.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define TEST_DEFAULT_ELEMENTS   2000000u    // per producer
+#define TEST_MAX_BULK           37u         // prime, so bulk sizes and ring wraps don't line up
+
+#define TEST_SPSC_CAPACITY      1024u
+
+#define TEST_MPMC_CAPACITY      256u
+#define TEST_MPMC_PRODUCERS     4u
+#define TEST_MPMC_CONSUMERS     4u
+
+// 12 bytes, so a run is split by the wrap at a byte count that isn't a power of 2
+typedef struct
+{
+    uint32_t sequence;
+    uint32_t inverse;       // ~sequence, catches a torn copy
+    uint32_t producer;
+} Test_Element_t;
+
+typedef struct
+{
+    pthread_t thread;
+    uint32_t id;
+    uint32_t num_elements;
+    uint32_t num_errors;    // written by the thread, checked by main afterwards
+} Test_Worker_t;
+
+static PSP_Ring_SPSC_t test_spsc;
+static Test_Element_t test_spsc_buffer[TEST_SPSC_CAPACITY];
+
+static PSP_Ring_MPMC_t test_mpmc;
+static uint32_t test_mpmc_cells[TEST_MPMC_CAPACITY * PSP_RING_MPMC_CELL_SIZE(sizeof(Test_Element_t)) / 4u];
+
+static uint32_t test_num_consumed;          // MPMC elements taken, by every consumer
+static uint8_t * test_seen;                 // MPMC times each (producer, sequence) was taken
+
+
+
+/**
+ * Seconds on the monotonic clock.
+ */
+static double Test_Seconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)now.tv_sec + ((double)now.tv_nsec / 1e9);
+}
+
+
+
+static void Test_Fill(Test_Element_t * p_elements, uint32_t producer, uint32_t first_sequence, uint32_t count)
+{
+    for (uint32_t i = 0u; i < count; i++)
+    {
+        p_elements[i].sequence = first_sequence + i;
+        p_elements[i].inverse = ~(first_sequence + i);
+        p_elements[i].producer = producer;
+    }
+}
+
+
+
+static void * Test_SPSC_Producer(void * p_argument)
+{
+    Test_Worker_t * const P_WORKER = (Test_Worker_t *)p_argument;
+    Test_Element_t elements[TEST_MAX_BULK];
+    uint32_t sent = 0u;
+    uint32_t bulk = 1u;
+
+    while (sent < P_WORKER->num_elements)
+    {
+        const uint32_t LEFT = P_WORKER->num_elements - sent;
+        const uint32_t WANTED = (bulk < LEFT) ? bulk : LEFT;
+
+        Test_Fill(elements, 0u, sent, WANTED);
+
+        const uint32_t PUSHED = (WANTED == 1u) ? PSP_Ring_SPSC_Push(&test_spsc, elements) :
+                                                 PSP_Ring_SPSC_Push_Bulk(&test_spsc, elements, WANTED);
+
+        if (PUSHED == 0u)
+        {
+            sched_yield();
+        }
+
+        sent += PUSHED;
+        bulk = (bulk % TEST_MAX_BULK) + 1u;
+    }
+
+    return 0;
+}
+
+
+
+static void * Test_SPSC_Consumer(void * p_argument)
+{
+    Test_Worker_t * const P_WORKER = (Test_Worker_t *)p_argument;
+    Test_Element_t elements[TEST_MAX_BULK];
+    uint32_t received = 0u;
+    uint32_t bulk = TEST_MAX_BULK;
+
+    while (received < P_WORKER->num_elements)
+    {
+        const uint32_t POPPED = (bulk == 1u) ? PSP_Ring_SPSC_Pop(&test_spsc, elements) :
+                                               PSP_Ring_SPSC_Pop_Bulk(&test_spsc, elements, bulk);
+
+        if (POPPED == 0u)
+        {
+            sched_yield();
+        }
+
+        // one producer, so every element must be the next in sequence
+        for (uint32_t i = 0u; i < POPPED; i++)
+        {
+            if ((elements[i].sequence != received) || (elements[i].inverse != ~received))
+            {
+                P_WORKER->num_errors++;
+            }
+
+            received++;
+        }
+
+        bulk = (bulk == 1u) ? TEST_MAX_BULK : (bulk - 1u);
+    }
+
+    return 0;
+}
+
+
+
+static void Test_SPSC(uint32_t num_elements)
+{
+    Test_Element_t element;
+    Test_Worker_t producer = { .id = 0u, .num_elements = num_elements };
+    Test_Worker_t consumer = { .id = 0u, .num_elements = num_elements };
+
+    TEST_CHECK(!PSP_Ring_SPSC_Init(&test_spsc, test_spsc_buffer, 1000u, sizeof(Test_Element_t)));
+    TEST_CHECK(PSP_Ring_SPSC_Init(&test_spsc, test_spsc_buffer, TEST_SPSC_CAPACITY, sizeof(Test_Element_t)));
+
+    // a full ring holds every slot and takes no more
+    for (uint32_t i = 0u; i < TEST_SPSC_CAPACITY; i++)
+    {
+        Test_Fill(&element, 0u, i, 1u);
+        TEST_CHECK(PSP_Ring_SPSC_Push(&test_spsc, &element) == 1u);
+    }
+
+    TEST_CHECK(PSP_Ring_SPSC_Push(&test_spsc, &element) == 0u);
+    TEST_CHECK(PSP_Ring_SPSC_Count(&test_spsc) == TEST_SPSC_CAPACITY);
+
+    for (uint32_t i = 0u; i < TEST_SPSC_CAPACITY; i++)
+    {
+        TEST_CHECK(PSP_Ring_SPSC_Pop(&test_spsc, &element) == 1u);
+        TEST_CHECK(element.sequence == i);
+    }
+
+    TEST_CHECK(PSP_Ring_SPSC_Pop(&test_spsc, &element) == 0u);
+
+    // and again with threads, from wherever the indices are now
+    const double START = Test_Seconds();
+
+    pthread_create(&consumer.thread, 0, Test_SPSC_Consumer, &consumer);
+    pthread_create(&producer.thread, 0, Test_SPSC_Producer, &producer);
+    pthread_join(producer.thread, 0);
+    pthread_join(consumer.thread, 0);
+
+    const double SECONDS = Test_Seconds() - START;
+
+    TEST_CHECK(consumer.num_errors == 0u);
+    TEST_CHECK(PSP_Ring_SPSC_Count(&test_spsc) == 0u);
+
+    printf("SPSC: %u elements, 1 producer, 1 consumer, %.3f s, %.1f M elements/s\n",
+           num_elements, SECONDS, (double)num_elements / SECONDS / 1e6);
+}
+
+
+
+static void * Test_MPMC_Producer(void * p_argument)
+{
+    Test_Worker_t * const P_WORKER = (Test_Worker_t *)p_argument;
+    Test_Element_t elements[TEST_MAX_BULK];
+    uint32_t sent = 0u;
+    uint32_t bulk = 1u + P_WORKER->id;
+
+    while (sent < P_WORKER->num_elements)
+    {
+        const uint32_t LEFT = P_WORKER->num_elements - sent;
+        const uint32_t WANTED = (bulk < LEFT) ? bulk : LEFT;
+
+        Test_Fill(elements, P_WORKER->id, sent, WANTED);
+
+        // a bulk enqueue may take only the first part of the run, the rest goes again
+        const uint32_t ENQUEUED = (WANTED == 1u) ? PSP_Ring_MPMC_Enqueue(&test_mpmc, elements) :
+                                                   PSP_Ring_MPMC_Enqueue_Bulk(&test_mpmc, elements, WANTED);
+
+        if (ENQUEUED == 0u)
+        {
+            sched_yield();
+        }
+
+        sent += ENQUEUED;
+        bulk = (bulk % TEST_MAX_BULK) + 1u;
+    }
+
+    return 0;
+}
+
+
+
+static void * Test_MPMC_Consumer(void * p_argument)
+{
+    Test_Worker_t * const P_WORKER = (Test_Worker_t *)p_argument;
+    const uint32_t TOTAL = P_WORKER->num_elements * TEST_MPMC_PRODUCERS;
+    Test_Element_t elements[TEST_MAX_BULK];
+    uint32_t next_sequence[TEST_MPMC_PRODUCERS] = { 0u };
+    uint32_t bulk = 1u + P_WORKER->id;
+
+    while (__atomic_load_n(&test_num_consumed, __ATOMIC_RELAXED) < TOTAL)
+    {
+        const uint32_t DEQUEUED = (bulk == 1u) ? PSP_Ring_MPMC_Dequeue(&test_mpmc, elements) :
+                                                 PSP_Ring_MPMC_Dequeue_Bulk(&test_mpmc, elements, bulk);
+
+        if (DEQUEUED == 0u)
+        {
+            sched_yield();
+        }
+
+        for (uint32_t i = 0u; i < DEQUEUED; i++)
+        {
+            const Test_Element_t * const P_ELEMENT = &elements[i];
+
+            if ((P_ELEMENT->producer >= TEST_MPMC_PRODUCERS) ||
+                (P_ELEMENT->sequence >= P_WORKER->num_elements) ||
+                (P_ELEMENT->inverse != ~P_ELEMENT->sequence))
+            {
+                P_WORKER->num_errors++;
+                continue;
+            }
+
+            // the queue is FIFO, so one consumer sees each producer's elements in order
+            if (P_ELEMENT->sequence < next_sequence[P_ELEMENT->producer])
+            {
+                P_WORKER->num_errors++;
+            }
+
+            next_sequence[P_ELEMENT->producer] = P_ELEMENT->sequence + 1u;
+
+            __atomic_add_fetch(&test_seen[(P_ELEMENT->producer * P_WORKER->num_elements) + P_ELEMENT->sequence],
+                               1u, __ATOMIC_RELAXED);
+        }
+
+        __atomic_add_fetch(&test_num_consumed, DEQUEUED, __ATOMIC_RELAXED);
+        bulk = (bulk % TEST_MAX_BULK) + 1u;
+    }
+
+    return 0;
+}
+
+
+
+static void Test_MPMC(uint32_t num_elements)
+{
+    const uint32_t TOTAL = num_elements * TEST_MPMC_PRODUCERS;
+    Test_Element_t element;
+    Test_Worker_t producers[TEST_MPMC_PRODUCERS];
+    Test_Worker_t consumers[TEST_MPMC_CONSUMERS];
+
+    TEST_CHECK(!PSP_Ring_MPMC_Init(&test_mpmc, test_mpmc_cells, 1u, sizeof(Test_Element_t)));
+    TEST_CHECK(!PSP_Ring_MPMC_Init(&test_mpmc, (uint8_t *)test_mpmc_cells + 2, TEST_MPMC_CAPACITY, sizeof(Test_Element_t)));
+    TEST_CHECK(PSP_Ring_MPMC_Init(&test_mpmc, test_mpmc_cells, TEST_MPMC_CAPACITY, sizeof(Test_Element_t)));
+
+    for (uint32_t i = 0u; i < TEST_MPMC_CAPACITY; i++)
+    {
+        Test_Fill(&element, 0u, i, 1u);
+        TEST_CHECK(PSP_Ring_MPMC_Enqueue(&test_mpmc, &element) == 1u);
+    }
+
+    TEST_CHECK(PSP_Ring_MPMC_Enqueue(&test_mpmc, &element) == 0u);
+
+    for (uint32_t i = 0u; i < TEST_MPMC_CAPACITY; i++)
+    {
+        TEST_CHECK(PSP_Ring_MPMC_Dequeue(&test_mpmc, &element) == 1u);
+        TEST_CHECK(element.sequence == i);
+    }
+
+    TEST_CHECK(PSP_Ring_MPMC_Dequeue(&test_mpmc, &element) == 0u);
+
+    test_seen = (uint8_t *)calloc(TOTAL, 1u);
+
+    if (!TEST_CHECK(test_seen != 0))
+    {
+        return;
+    }
+
+    test_num_consumed = 0u;
+
+    const double START = Test_Seconds();
+
+    for (uint32_t i = 0u; i < TEST_MPMC_CONSUMERS; i++)
+    {
+        consumers[i] = (Test_Worker_t){ .id = i, .num_elements = num_elements };
+        pthread_create(&consumers[i].thread, 0, Test_MPMC_Consumer, &consumers[i]);
+    }
+
+    for (uint32_t i = 0u; i < TEST_MPMC_PRODUCERS; i++)
+    {
+        producers[i] = (Test_Worker_t){ .id = i, .num_elements = num_elements };
+        pthread_create(&producers[i].thread, 0, Test_MPMC_Producer, &producers[i]);
+    }
+
+    uint32_t num_errors = 0u;
+
+    for (uint32_t i = 0u; i < TEST_MPMC_PRODUCERS; i++)
+    {
+        pthread_join(producers[i].thread, 0);
+    }
+
+    for (uint32_t i = 0u; i < TEST_MPMC_CONSUMERS; i++)
+    {
+        pthread_join(consumers[i].thread, 0);
+        num_errors += consumers[i].num_errors;
+    }
+
+    const double SECONDS = Test_Seconds() - START;
+
+    // every element taken exactly once: none lost, none twice
+    uint32_t num_lost = 0u;
+    uint32_t num_duplicated = 0u;
+
+    for (uint32_t i = 0u; i < TOTAL; i++)
+    {
+        num_lost += (test_seen[i] == 0u) ? 1u : 0u;
+        num_duplicated += (test_seen[i] > 1u) ? 1u : 0u;
+    }
+
+    TEST_CHECK(num_errors == 0u);
+    TEST_CHECK(num_lost == 0u);
+    TEST_CHECK(num_duplicated == 0u);
+    TEST_CHECK(test_num_consumed == TOTAL);
+    TEST_CHECK(PSP_Ring_MPMC_Dequeue(&test_mpmc, &element) == 0u);
+
+    free(test_seen);
+
+    printf("MPMC: %u elements, %u producers, %u consumers, %.3f s, %.1f M elements/s\n",
+           TOTAL, TEST_MPMC_PRODUCERS, TEST_MPMC_CONSUMERS, SECONDS, (double)TOTAL / SECONDS / 1e6);
+}
+
+
+
+int main(int argc, char ** argv)
+{
+    const uint32_t NUM_ELEMENTS = (argc > 1) ? (uint32_t)strtoul(argv[1], 0, 0) : TEST_DEFAULT_ELEMENTS;
+
+    Test_SPSC(NUM_ELEMENTS);
+    Test_MPMC(NUM_ELEMENTS);
+
+    return Test_Finish("Test_Rings");
+}
@@ -0,0 +1,293 @@
+#!/usr/bin/env python3
+"""
+Build FAT32 SD card images for testing BSP_FAT32, and read files back out of them.
+
+usage:
+    fat32_image.py build sd.img [options] [SRC[=DEST] ...]
+        --size-mb N      image size, default 512 (QEMU wants a power of 2)
+        --cluster-kb N   cluster size, default 4
+        --no-mbr         put the volume at sector 0 instead of in an MBR partition
+        --fragment       interleave the clusters of the files so they are fragmented
+        --bench-kb N     add BENCH.BIN, N kB of little endian words counting up from 0,
+                         which bench_FAT32 reads and checks
+
+        each SRC is a host file, copied to DEST (default: its name) in the image, DEST
+        can be in directories ("assets/font.bin"), which are made as needed, every part
+        must be a short 8.3 name
+
+    fat32_image.py ls sd.img
+        list every file with its size and how many fragments it is in
+
+    fat32_image.py cat sd.img PATH
+        write a file from the image to stdout, e.g. to read back a log bench_FAT32 wrote
+
+Pure python, so it doesn't need mkfs.fat or mtools.
+"""
+
+import os
+import struct
+import sys
+
+SECTOR = 512
+END_OF_CHAIN = 0x0FFFFFFF
+RESERVED_SECTORS = 32
+NUM_FATS = 2
+MBR_START = 2048
+DATE_2000_01_01 = 0x2821
+
+
+def short_name(part):
+    """'boot.txt' -> b'BOOT    TXT'"""
+    name, _, ext = part.upper().partition(".")
+    if not name or len(name) > 8 or len(ext) > 3 or "." in ext or " " in part:
+        raise SystemExit(f"'{part}' isn't a short 8.3 name")
+    return name.ljust(8).encode() + ext.ljust(3).encode()
+
+
+def dir_entry(name, attributes, cluster, size):
+    return struct.pack("<11sBBBHHHHHHHI", name, attributes, 0, 0, 0, DATE_2000_01_01, DATE_2000_01_01,
+                       cluster >> 16, 0, DATE_2000_01_01, cluster & 0xFFFF, size)
+
+
+class Builder:
+    def __init__(self, size_mb, cluster_kb, mbr):
+        self.total_sectors = size_mb * 2048
+        self.start = MBR_START if mbr else 0
+        self.volume_sectors = self.total_sectors - self.start
+        self.sectors_per_cluster = cluster_kb * 2
+        self.cluster_bytes = self.sectors_per_cluster * SECTOR
+
+        # the FAT has to cover the clusters that are left after the FATs
+        self.fat_sectors = 1
+        while True:
+            clusters = (self.volume_sectors - RESERVED_SECTORS - NUM_FATS * self.fat_sectors) // self.sectors_per_cluster
+            needed = ((clusters + 2) * 4 + SECTOR - 1) // SECTOR
+            if needed <= self.fat_sectors:
+                break
+            self.fat_sectors = needed
+
+        self.num_clusters = clusters
+        if clusters < 65525:
+            print(f"warning: {clusters} clusters is too few for FAT32 by the spec, other systems may "
+                  f"not mount it (BSP_FAT32 will)", file=sys.stderr)
+
+        self.fat = [0x0FFFFFF8, END_OF_CHAIN] + [0] * clusters
+        self.data = {}              # cluster -> bytes
+        self.next_free = 2
+        self.root = self.new_dir(None)
+
+    def allocate(self):
+        cluster = self.next_free
+        self.next_free += 1
+        if cluster >= self.num_clusters + 2:
+            raise SystemExit("image is full")
+        self.fat[cluster] = END_OF_CHAIN
+        return cluster
+
+    def write_chain(self, clusters, content):
+        for i, cluster in enumerate(clusters):
+            self.fat[cluster] = clusters[i + 1] if i + 1 < len(clusters) else END_OF_CHAIN
+            self.data[cluster] = content[i * self.cluster_bytes:(i + 1) * self.cluster_bytes]
+
+    def new_dir(self, parent):
+        d = {"clusters": [self.allocate()], "entries": [], "children": {}, "parent": parent}
+        if parent is not None:
+            d["entries"].append([b".          ", 0x10, d["clusters"][0], 0])
+            parent_cluster = 0 if parent["parent"] is None else parent["clusters"][0]  # 0 is the root
+            d["entries"].append([b"..         ", 0x10, parent_cluster, 0])
+        return d
+
+    def find_dir(self, parts):
+        d = self.root
+        for part in parts:
+            name = short_name(part)
+            if name not in d["children"]:
+                child = self.new_dir(d)
+                d["children"][name] = child
+                d["entries"].append([name, 0x10, child["clusters"][0], 0])
+            d = d["children"][name]
+        return d
+
+    def add_files(self, files, fragment):
+        """files is [(dest, content)], clusters are allocated round robin if fragment"""
+        pending = []
+        for dest, content in files:
+            parts = dest.strip("/").split("/")
+            d = self.find_dir(parts[:-1])
+            entry = [short_name(parts[-1]), 0x20, 0, len(content)]
+            d["entries"].append(entry)
+            num_clusters = (len(content) + self.cluster_bytes - 1) // self.cluster_bytes
+            pending.append((entry, content, num_clusters, []))
+
+        if fragment:
+            while any(len(c) < n for _, _, n, c in pending):
+                for _, _, n, c in pending:
+                    if len(c) < n:
+                        c.append(self.allocate())
+        else:
+            for _, _, n, c in pending:
+                c.extend(self.allocate() for _ in range(n))
+
+        for entry, content, _, clusters in pending:
+            entry[2] = clusters[0] if clusters else 0
+            self.write_chain(clusters, content)
+
+    def finish_dir(self, d):
+        for child in d["children"].values():
+            self.finish_dir(child)
+        content = b"".join(dir_entry(*e) for e in d["entries"])
+        while len(d["clusters"]) * self.cluster_bytes < len(content) + 32:
+            d["clusters"].append(self.allocate())
+        self.write_chain(d["clusters"], content)
+
+    def write(self, path):
+        self.finish_dir(self.root)
+        free = sum(1 for v in self.fat[2:] if v == 0)
+
+        with open(path, "wb") as f:
+            f.truncate(self.total_sectors * SECTOR)
+
+            if self.start:
+                mbr = bytearray(SECTOR)
+                mbr[0x1BE:0x1CE] = struct.pack("<B3sB3sII", 0, b"\xfe\xff\xff", 0x0C, b"\xfe\xff\xff",
+                                               self.start, self.volume_sectors)
+                mbr[510:512] = b"\x55\xaa"
+                f.seek(0)
+                f.write(mbr)
+
+            boot = bytearray(SECTOR)
+            boot[0:3] = b"\xeb\x58\x90"
+            boot[3:11] = b"PSPFAT32"
+            struct.pack_into("<HBHBHHBHHHII", boot, 11, SECTOR, self.sectors_per_cluster, RESERVED_SECTORS,
+                             NUM_FATS, 0, 0, 0xF8, 0, 63, 255, self.start, self.volume_sectors)
+            struct.pack_into("<IHHIHH12xBBBI11s8s", boot, 36, self.fat_sectors, 0, 0, self.root["clusters"][0],
+                             1, 6, 0x80, 0, 0x29, 0x12345678, b"PSP        ", b"FAT32   ")
+            boot[510:512] = b"\x55\xaa"
+
+            fsinfo = bytearray(SECTOR)
+            struct.pack_into("<I", fsinfo, 0, 0x41615252)
+            struct.pack_into("<III", fsinfo, 484, 0x61417272, free, self.next_free)
+            fsinfo[510:512] = b"\x55\xaa"
+
+            for sector, content in ((0, boot), (1, fsinfo), (6, boot), (7, fsinfo)):
+                f.seek((self.start + sector) * SECTOR)
+                f.write(content)
+
+            fat_bytes = struct.pack(f"<{len(self.fat)}I", *self.fat)
+            for i in range(NUM_FATS):
+                f.seek((self.start + RESERVED_SECTORS + i * self.fat_sectors) * SECTOR)
+                f.write(fat_bytes)
+
+            data_start = self.start + RESERVED_SECTORS + NUM_FATS * self.fat_sectors
+            for cluster, content in self.data.items():
+                f.seek((data_start + (cluster - 2) * self.sectors_per_cluster) * SECTOR)
+                f.write(content)
+
+
+class Reader:
+    def __init__(self, path):
+        self.f = open(path, "rb")
+        sector0 = self.read_sectors(0, 1)
+        self.start = 0
+        if struct.unpack_from("<H", sector0, 22)[0] != 0 or sector0[0] not in (0xEB, 0xE9):
+            for i in range(4):
+                kind, first = struct.unpack_from("<4xB3xI", sector0, 0x1BE + 16 * i)
+                if kind in (0x0B, 0x0C):
+                    self.start = first
+                    break
+            else:
+                raise SystemExit("no FAT32 partition")
+        boot = self.read_sectors(self.start, 1)
+        (self.sectors_per_cluster, reserved, num_fats) = struct.unpack_from("<BHB", boot, 13)
+        (self.fat_sectors, _, _, self.root_cluster) = struct.unpack_from("<IHHI", boot, 36)
+        self.fat_start = self.start + reserved
+        self.data_start = self.fat_start + num_fats * self.fat_sectors
+        self.fat = struct.unpack(f"<{self.fat_sectors * 128}I", self.read_sectors(self.fat_start, self.fat_sectors))
+
+    def read_sectors(self, first, count):
+        self.f.seek(first * SECTOR)
+        return self.f.read(count * SECTOR)
+
+    def chain(self, cluster):
+        clusters = []
+        while 2 <= cluster < 0x0FFFFFF8 and len(clusters) < len(self.fat):
+            clusters.append(cluster)
+            cluster = self.fat[cluster] & 0x0FFFFFFF
+        return clusters
+
+    def read_chain(self, cluster):
+        spc = self.sectors_per_cluster
+        return b"".join(self.read_sectors(self.data_start + (c - 2) * spc, spc) for c in self.chain(cluster))
+
+    def entries(self, cluster):
+        data = self.read_chain(cluster)
+        for offset in range(0, len(data), 32):
+            name, attributes = data[offset:offset + 11], data[offset + 11]
+            if name[0] == 0:
+                break
+            if name[0] == 0xE5 or attributes & 0x0F == 0x0F or attributes & 0x08 or name[0] == ord("."):
+                continue
+            high, low, size = struct.unpack_from("<H4xHI", data, offset + 20)
+            pretty = name[:8].decode().rstrip() + ("." + name[8:].decode().rstrip() if name[8:].strip() else "")
+            yield pretty, attributes, (high << 16) | low, size
+
+    def find(self, path):
+        cluster, attributes, size = self.root_cluster, 0x10, 0
+        for part in path.strip("/").split("/"):
+            for name, attributes, cluster, size in self.entries(cluster):
+                if name.upper() == part.upper():
+                    break
+            else:
+                raise SystemExit(f"{path} not found")
+        return attributes, cluster, size
+
+    def walk(self, cluster, prefix=""):
+        for name, attributes, first, size in self.entries(cluster):
+            if attributes & 0x10:
+                yield from self.walk(first, prefix + name + "/")
+            else:
+                clusters = self.chain(first)
+                fragments = sum(1 for a, b in zip(clusters, clusters[1:]) if b != a + 1) + (1 if clusters else 0)
+                yield prefix + name, size, fragments
+
+
+def main(argv):
+    if len(argv) >= 2 and argv[0] == "build":
+        options = {"--size-mb": 512, "--cluster-kb": 4, "--bench-kb": 0}
+        mbr, fragment, files = True, False, []
+        args = iter(argv[2:])
+        for arg in args:
+            if arg in options:
+                options[arg] = int(next(args))
+            elif arg == "--no-mbr":
+                mbr = False
+            elif arg == "--fragment":
+                fragment = True
+            else:
+                src, _, dest = arg.partition("=")
+                with open(src, "rb") as f:
+                    files.append((dest or os.path.basename(src), f.read()))
+        if options["--bench-kb"]:
+            words = options["--bench-kb"] * 256
+            files.append(("BENCH.BIN", struct.pack(f"<{words}I", *range(words))))
+        builder = Builder(options["--size-mb"], options["--cluster-kb"], mbr)
+        builder.add_files(files, fragment)
+        builder.write(argv[1])
+    elif len(argv) == 2 and argv[0] == "ls":
+        reader = Reader(argv[1])
+        for path, size, fragments in reader.walk(reader.root_cluster):
+            print(f"{size:>10}  {fragments:>4} fragment(s)  {path}")
+    elif len(argv) == 3 and argv[0] == "cat":
+        reader = Reader(argv[1])
+        attributes, cluster, size = reader.find(argv[2])
+        if attributes & 0x10:
+            raise SystemExit(f"{argv[2]} is a directory")
+        sys.stdout.buffer.write(reader.read_chain(cluster)[:size])
+    else:
+        print(__doc__, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
@@ -0,0 +1,84 @@
+#!/usr/bin/env python3
+"""
+Convert a BSP_Logic_Analyzer_Export dump into a VCD file.
+
+usage: la_to_vcd.py capture.txt capture.vcd
+
+capture.txt is whatever the serial terminal logged, lines before the "LA" header and
+after "END" are ignored, so the log doesn't have to be trimmed by hand. See the top
+of src/BSP_Logic_Analyzer.h for the format.
+"""
+
+import sys
+
+
+def read_capture(lines):
+    """returns (sample_rate_hz, pin_mask, [(sample_index, levels), ...], num_samples)"""
+    sample_rate_hz = None
+    pin_mask = 0
+    changes = []
+    sample_index = 0
+    last_levels = None
+
+    for line in lines:
+        line = line.strip()
+
+        if sample_rate_hz is None:
+            if line.startswith("LA "):
+                _, rate, mask = line.split()
+                sample_rate_hz = int(rate)
+                pin_mask = int(mask, 16)
+            continue
+
+        if line == "END":
+            break
+        elif line.startswith("R"):
+            sample_index += int(line[1:])
+        elif line:
+            levels = int(line, 16)
+            if levels != last_levels:
+                changes.append((sample_index, levels))
+                last_levels = levels
+            sample_index += 1
+
+    if sample_rate_hz is None:
+        raise ValueError("no 'LA' header found")
+
+    return sample_rate_hz, pin_mask, changes, sample_index
+
+
+def write_vcd(out, sample_rate_hz, pin_mask, changes, num_samples):
+    pins = [pin for pin in range(31) if pin_mask & (1 << pin)]
+    ids = {pin: chr(33 + pin) for pin in pins}
+
+    out.write("$timescale 1ns $end\n")
+    out.write("$scope module pi $end\n")
+    for pin in pins:
+        out.write("$var wire 1 %s GPIO%d $end\n" % (ids[pin], pin))
+    out.write("$upscope $end\n$enddefinitions $end\n")
+
+    last_levels = None
+    for sample_index, levels in changes:
+        out.write("#%d\n" % (sample_index * 1000000000 // sample_rate_hz))
+        for pin in pins:
+            bit = (levels >> pin) & 1
+            if last_levels is None or bit != ((last_levels >> pin) & 1):
+                out.write("%d%s\n" % (bit, ids[pin]))
+        last_levels = levels
+
+    out.write("#%d\n" % (num_samples * 1000000000 // sample_rate_hz))
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    with open(sys.argv[1], errors="replace") as capture:
+        sample_rate_hz, pin_mask, changes, num_samples = read_capture(capture)
+
+    with open(sys.argv[2], "w") as vcd:
+        write_vcd(vcd, sample_rate_hz, pin_mask, changes, num_samples)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""
+Symbolize a BSP_Profiler_Dump against the kernel ELF and print flat and caller profiles.
+
+usage: profile_report.py profile.txt [kernel.elf]
+
+kernel.elf defaults to bin/kernel.elf, and must be the build that was profiled. Symbols
+come from $(ARMGNU)-nm, ARMGNU defaults to arm-none-eabi as in the Makefile. profile.txt
+is whatever the serial terminal logged, lines before the "PROFILE" header and after "END"
+are ignored. See the top of src/BSP_Profiler.h for the format.
+
+The flat profile counts where each sample's pc was. The caller profile attributes each
+sample to the function its lr points into, which is only the real caller for leaf
+functions (and non-leaf ones that haven't reused lr yet), so read it as a guide.
+"""
+
+import bisect
+import os
+import subprocess
+import sys
+from collections import defaultdict
+
+
+def read_profile(lines):
+    """returns (header dict, [(pc, lr, count), ...])"""
+    header = None
+    samples = []
+
+    for line in lines:
+        line = line.strip()
+
+        if header is None:
+            if line.startswith("PROFILE "):
+                fields = [int(field) for field in line.split()[1:]]
+                names = ["rate_hz", "samples", "dropped", "missed", "run_us",
+                         "average_cycles", "max_cycles", "overhead_ppm"]
+                header = dict(zip(names, fields))
+            continue
+
+        if line == "END":
+            break
+        elif line:
+            pc, lr, count = (int(field, 16) for field in line.split())
+            samples.append((pc, lr, count))
+
+    if header is None:
+        raise ValueError("no 'PROFILE' header found")
+
+    return header, samples
+
+
+class Symbols:
+    def __init__(self, elf):
+        nm = os.environ.get("ARMGNU", "arm-none-eabi") + "-nm"
+        output = subprocess.run([nm, "-n", "-S", "--defined-only", elf],
+                                check=True, capture_output=True, text=True).stdout
+        self.starts = []
+        self.ends = []
+        self.names = []
+
+        for line in output.splitlines():
+            fields = line.split()
+            if len(fields) == 4:
+                address, size, kind, name = fields
+                end = int(address, 16) + int(size, 16)
+            elif len(fields) == 3:
+                address, kind, name = fields
+                end = None
+            else:
+                continue
+            # functions only, and not the $a/$d mapping symbols
+            if kind not in "tTwW" or name.startswith("$"):
+                continue
+            self.starts.append(int(address, 16))
+            self.ends.append(end)
+            self.names.append(name)
+
+        # without a size, a symbol runs to the next one
+        for i, end in enumerate(self.ends):
+            if end is None:
+                self.ends[i] = self.starts[i + 1] if i + 1 < len(self.starts) else self.starts[i] + 4
+
+    def lookup(self, address):
+        i = bisect.bisect_right(self.starts, address) - 1
+        if i >= 0 and address < self.ends[i]:
+            return self.names[i]
+        return "0x%08x" % address
+
+
+def percent(count, total):
+    return 100.0 * count / total if total else 0.0
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit(__doc__)
+
+    with open(sys.argv[1], errors="replace") as profile:
+        header, samples = read_profile(profile)
+
+    symbols = Symbols(sys.argv[2] if len(sys.argv) == 3 else "bin/kernel.elf")
+
+    total = sum(count for _, _, count in samples)
+    flat = defaultdict(int)
+    callers = defaultdict(lambda: defaultdict(int))
+
+    for pc, lr, count in samples:
+        function = symbols.lookup(pc)
+        flat[function] += count
+        # lr is the return address, the call itself is the instruction before it
+        callers[function][symbols.lookup(lr - 4 if lr >= 4 else lr)] += count
+
+    print("%(samples)d samples at %(rate_hz)d Hz over %(run_us)d uSec, "
+          "%(dropped)d dropped (table full), %(missed)d missed (IRQs masked too long)" % header)
+    print("sampling cost: %(average_cycles)d cycles average, %(max_cycles)d max, "
+          "%(overhead_ppm)d ppm of the run" % header)
+    print()
+
+    print("flat profile")
+    print("  %6s  %8s  %s" % ("%", "samples", "function"))
+    for function, count in sorted(flat.items(), key=lambda item: -item[1]):
+        print("  %6.2f  %8d  %s" % (percent(count, total), count, function))
+    print()
+
+    print("caller profile, from lr")
+    for function, count in sorted(flat.items(), key=lambda item: -item[1]):
+        print("  %6.2f  %8d  %s" % (percent(count, total), count, function))
+        for caller, caller_count in sorted(callers[function].items(), key=lambda item: -item[1]):
+            print("          %8d      <- %s" % (caller_count, caller))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,216 @@
+#!/usr/bin/env python3
+"""
+Decode a BSP_Telemetry stream into CSV.
+
+usage: telemetry_decode.py capture.bin|/dev/ttyUSB0 [samples.csv]
+
+The input is a raw capture of the mini uart, or the serial port itself, which is set to
+115200 baud raw and read until Ctrl-C. The CSV (stdout if not given) has a row per sample:
+sequence, timestamp, channel, name, index in its run, value. Text the Pi printed between
+frames fails the CRC and is skipped, so expect a bad frame or two where the two mix. Frame
+counts, bad frames and frames lost (gaps in the sequence numbers) go to stderr at the end.
+See the top of src/BSP_Telemetry.h for the format.
+
+As a library:
+
+    decoder = TelemetryDecoder()
+    for sample in decoder.feed(data):
+        ...     # Sample(sequence, timestamp, channel, name, index, value)
+"""
+
+import collections
+import os
+import struct
+import sys
+
+FRAME_SAMPLES = 0x01
+FRAME_CHANNELS = 0x02
+
+TYPE_INT32 = 0
+TYPE_FLOAT = 1
+
+Sample = collections.namedtuple("Sample", "sequence timestamp channel name index value")
+
+
+def make_crc32c_table():
+    table = []
+    for n in range(256):
+        crc = n
+        for _ in range(8):
+            crc = (crc >> 1) ^ (0x82F63B78 if crc & 1 else 0)
+        table.append(crc)
+    return table
+
+
+CRC32C_TABLE = make_crc32c_table()
+
+
+def crc32c(data):
+    crc = 0xFFFFFFFF
+    for byte in data:
+        crc = (crc >> 8) ^ CRC32C_TABLE[(crc ^ byte) & 0xFF]
+    return crc ^ 0xFFFFFFFF
+
+
+def cobs_decode(frame):
+    """frame without its 0x00 delimiter, returns the bytes or None if it's malformed"""
+    out = bytearray()
+    i = 0
+
+    while i < len(frame):
+        code = frame[i]
+        if code == 0 or i + code > len(frame):
+            return None
+        out += frame[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(frame):
+            out.append(0)
+
+    return bytes(out)
+
+
+def read_varint(data, offset):
+    """returns (value, next offset), raises IndexError if it runs off the end"""
+    value = 0
+    shift = 0
+
+    while True:
+        byte = data[offset]
+        offset += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value & 0xFFFFFFFF, offset
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def to_int32(value):
+    value &= 0xFFFFFFFF
+    return value - 0x100000000 if value & 0x80000000 else value
+
+
+class TelemetryDecoder:
+    """feed it bytes as they arrive, it gives back the samples of every good frame"""
+
+    def __init__(self):
+        self.channels = {}          # channel: (type, name)
+        self.pending = bytearray()
+        self.num_frames = 0
+        self.num_bad = 0            # failed COBS, CRC or parsing
+        self.num_lost = 0           # sequence numbers skipped
+        self.last_sequence = None
+
+    def feed(self, data):
+        samples = []
+        self.pending += data
+
+        while True:
+            end = self.pending.find(0)
+            if end < 0:
+                return samples
+            frame = bytes(self.pending[:end])
+            del self.pending[:end + 1]
+            if frame:
+                samples += self.decode_frame(frame)
+
+    def decode_frame(self, frame):
+        payload = cobs_decode(frame)
+
+        if payload is None or len(payload) < 5 or crc32c(payload[:-4]) != struct.unpack("<I", payload[-4:])[0]:
+            self.num_bad += 1
+            return []
+
+        try:
+            samples = self.parse(payload[:-4])
+        except (IndexError, struct.error):
+            self.num_bad += 1
+            return []
+
+        self.num_frames += 1
+        return samples
+
+    def parse(self, payload):
+        frame_type = payload[0]
+        sequence, offset = read_varint(payload, 1)
+
+        if self.last_sequence is not None:
+            self.num_lost += (sequence - self.last_sequence - 1) & 0xFFFFFFFF
+        self.last_sequence = sequence
+
+        samples = []
+
+        if frame_type == FRAME_CHANNELS:
+            while offset < len(payload):
+                channel, offset = read_varint(payload, offset)
+                channel_type = payload[offset]
+                length, offset = read_varint(payload, offset + 1)
+                self.channels[channel] = (channel_type, payload[offset:offset + length].decode("ascii", "replace"))
+                offset += length
+
+        elif frame_type == FRAME_SAMPLES:
+            timestamp, offset = read_varint(payload, offset)
+            while offset < len(payload):
+                channel, offset = read_varint(payload, offset)
+                count, offset = read_varint(payload, offset)
+                # channels not announced yet are taken as Int32, the usual kind
+                channel_type, name = self.channels.get(channel, (TYPE_INT32, "channel%d" % channel))
+                value = 0
+                for index in range(count):
+                    if channel_type == TYPE_FLOAT:
+                        sample = struct.unpack_from("<f", payload, offset)[0]
+                        offset += 4
+                    else:
+                        difference, offset = read_varint(payload, offset)
+                        value = (value + unzigzag(difference)) & 0xFFFFFFFF
+                        sample = to_int32(value)
+                    samples.append(Sample(sequence, timestamp, channel, name, index, sample))
+
+        return samples
+
+
+def open_input(path):
+    """a file, or a tty set to 115200 baud raw"""
+    if path.startswith("/dev/"):
+        import termios
+        import tty
+
+        fd = os.open(path, os.O_RDONLY | os.O_NOCTTY)
+        tty.setraw(fd)
+        attributes = termios.tcgetattr(fd)
+        attributes[4] = attributes[5] = termios.B115200
+        termios.tcsetattr(fd, termios.TCSANOW, attributes)
+        return os.fdopen(fd, "rb", buffering=0)
+
+    return open(path, "rb")
+
+
+def main():
+    if len(sys.argv) not in (2, 3):
+        sys.exit(__doc__)
+
+    decoder = TelemetryDecoder()
+    out = open(sys.argv[2], "w") if len(sys.argv) == 3 else sys.stdout
+    out.write("sequence,timestamp,channel,name,index,value\n")
+
+    try:
+        with open_input(sys.argv[1]) as source:
+            while True:
+                data = source.read(4096)
+                if not data:
+                    break
+                for sample in decoder.feed(data):
+                    out.write("%d,%d,%d,%s,%d,%r\n" % sample)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        if out is not sys.stdout:
+            out.close()
+
+    sys.stderr.write("%d frames, %d bad, %d lost\n" % (decoder.num_frames, decoder.num_bad, decoder.num_lost))
+
+
+if __name__ == "__main__":
+    main()
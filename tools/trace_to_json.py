@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""
+Convert a PSP_Trace_Dump into Chrome trace event JSON, for chrome://tracing or
+ui.perfetto.dev.
+
+usage: trace_to_json.py trace.txt trace.json
+
+trace.txt is whatever the serial terminal logged, lines before the "TRACE" header and
+after "END" are ignored, so the log doesn't have to be trimmed by hand. See the top
+of src/PSP_Trace.h for the format.
+
+Each core is a process, and each core's events are split into tracks (threads) by the
+first word of the event name, so every bus gets its own row and the CPU's waits are on
+a row of their own. Spans whose begin was overwritten in the ring are dropped, spans
+still open at the end are closed at the last timestamp.
+"""
+
+import json
+import sys
+
+PHASE_BEGIN = 0x4000
+PHASE_END = 0x8000
+PHASE_MASK = 0xC000
+EVENT_MASK = 0x3FFF
+
+
+def read_trace(lines):
+    """returns (cycles_per_ms, names, {core: (lost, [(cycles, event, arg), ...])})"""
+    cycles_per_ms = None
+    names = {}
+    cores = {}
+    records = None
+
+    for line in lines:
+        line = line.strip()
+
+        if cycles_per_ms is None:
+            if line.startswith("TRACE "):
+                cycles_per_ms = int(line.split()[1])
+            continue
+
+        if line == "END":
+            break
+        elif line.startswith("N "):
+            _, event, name = line.split(" ", 2)
+            names[int(event, 16)] = name
+        elif line.startswith("C "):
+            _, core, _, lost = line.split()
+            records = []
+            cores[int(core, 16)] = (int(lost, 16), records)
+        elif line and records is not None:
+            cycles, event, arg = line.split()
+            records.append((int(cycles, 16), int(event, 16), int(arg, 16)))
+
+    if cycles_per_ms is None:
+        raise ValueError("no 'TRACE' header found")
+    if cycles_per_ms == 0:
+        raise ValueError("the cycle counter wasn't calibrated")
+
+    return cycles_per_ms, names, cores
+
+
+def unwrap(records):
+    """the cycle counter is 32 bits, records are in order, so each wrap shows as a step back"""
+    high = 0
+    last = None
+    for cycles, event, arg in records:
+        if last is not None and cycles < last:
+            high += 1 << 32
+        last = cycles
+        yield high + cycles, event, arg
+
+
+def to_events(cycles_per_ms, names, cores):
+    events = []
+    tids = {}
+
+    for core, (lost, records) in sorted(cores.items()):
+        events.append({"ph": "M", "name": "process_name", "pid": core, "tid": 0,
+                       "args": {"name": "core %d (%d records lost)" % (core, lost)}})
+        open_spans = {}
+        start = None
+        last_us = 0.0
+
+        for cycles, event, arg in unwrap(records):
+            if start is None:
+                start = cycles
+            last_us = (cycles - start) * 1000.0 / cycles_per_ms
+
+            name = names.get(event & EVENT_MASK, "event %d" % (event & EVENT_MASK))
+            track = name.split()[0]
+
+            if (core, track) not in tids:
+                tids[(core, track)] = len(tids) + 1
+                events.append({"ph": "M", "name": "thread_name", "pid": core,
+                               "tid": tids[(core, track)], "args": {"name": track}})
+
+            tid = tids[(core, track)]
+            entry = {"name": name, "pid": core, "tid": tid, "ts": last_us, "args": {"arg": arg}}
+            phase = event & PHASE_MASK
+
+            if phase == PHASE_BEGIN:
+                entry["ph"] = "B"
+                open_spans[tid] = open_spans.get(tid, 0) + 1
+            elif phase == PHASE_END:
+                if not open_spans.get(tid):
+                    continue
+                entry["ph"] = "E"
+                open_spans[tid] -= 1
+            else:
+                entry["ph"] = "i"
+                entry["s"] = "t"
+
+            events.append(entry)
+
+        for tid, depth in open_spans.items():
+            for _ in range(depth):
+                events.append({"ph": "E", "pid": core, "tid": tid, "ts": last_us})
+
+    return events
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+
+    with open(sys.argv[1], errors="replace") as trace:
+        cycles_per_ms, names, cores = read_trace(trace)
+
+    with open(sys.argv[2], "w") as out:
+        json.dump({"traceEvents": to_events(cycles_per_ms, names, cores),
+                   "displayTimeUnit": "ns"}, out)
+
+
+if __name__ == "__main__":
+    main()